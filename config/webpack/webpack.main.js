@@ -42,6 +42,9 @@ module.exports = merge(common, {
     // Native modules should be externalized (macOS)
     './mouse_tracker_darwin.node': 'commonjs ./mouse_tracker_darwin.node',
     './drag_monitor_darwin.node': 'commonjs ./drag_monitor_darwin.node',
+    './file_ops_darwin.node': 'commonjs ./file_ops_darwin.node',
+    './thumbnails_darwin.node': 'commonjs ./thumbnails_darwin.node',
+    './shelf_search_darwin.node': 'commonjs ./shelf_search_darwin.node',
     // Native modules should be externalized (Windows)
     './mouse_tracker_win.node': 'commonjs ./mouse_tracker_win.node',
     './drag_monitor_win.node': 'commonjs ./drag_monitor_win.node',
@@ -86,6 +89,21 @@ module.exports = merge(common, {
           to: path.join(projectRoot, 'dist/main/drag_monitor_darwin.node'),
           noErrorOnMissing: true
         },
+        {
+          from: path.join(projectRoot, 'src/native/file-ops/build/Release/file_ops_darwin.node'),
+          to: path.join(projectRoot, 'dist/main/file_ops_darwin.node'),
+          noErrorOnMissing: true
+        },
+        {
+          from: path.join(projectRoot, 'src/native/thumbnails/build/Release/thumbnails_darwin.node'),
+          to: path.join(projectRoot, 'dist/main/thumbnails_darwin.node'),
+          noErrorOnMissing: true
+        },
+        {
+          from: path.join(projectRoot, 'src/native/shelf-search/build/Release/shelf_search_darwin.node'),
+          to: path.join(projectRoot, 'dist/main/shelf_search_darwin.node'),
+          noErrorOnMissing: true
+        },
         // Copy all native modules built by centralized build system (Windows)
         {
           from: path.join(projectRoot, 'src/native/mouse-tracker/build/Release/mouse_tracker_win.node'),
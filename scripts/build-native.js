@@ -26,7 +26,7 @@ const isVerbose = args.includes('--verbose');
  */
 function getModuleNames() {
   if (platform === 'darwin') {
-    return 'mouse_tracker_darwin,drag_monitor_darwin';
+    return 'mouse_tracker_darwin,drag_monitor_darwin,file_ops_darwin,thumbnails_darwin,shelf_search_darwin';
   } else if (platform === 'win32') {
     return 'mouse_tracker_win,drag_monitor_win';
   } else {
@@ -102,6 +102,22 @@ function validateBuild() {
     }
   ];
 
+  // file-ops, thumbnails and shelf-search have no Windows build yet; their wrappers fall back there
+  if (platform === 'darwin') {
+    modules.push({
+      name: 'file_ops',
+      paths: [path.join(projectRoot, 'src/native/file-ops/build/Release/file_ops_darwin.node')]
+    });
+    modules.push({
+      name: 'thumbnails',
+      paths: [path.join(projectRoot, 'src/native/thumbnails/build/Release/thumbnails_darwin.node')]
+    });
+    modules.push({
+      name: 'shelf_search',
+      paths: [path.join(projectRoot, 'src/native/shelf-search/build/Release/shelf_search_darwin.node')]
+    });
+  }
+
   console.log('\nValidating build...');
 
   for (const module of modules) {
@@ -71,6 +71,33 @@ export const NATIVE_MODULES: NativeModuleConfig[] = [
       // Copy built module to expected location for webpack
       'cp build/Release/*.node ../../'
     ]
+  },
+  {
+    name: 'file-ops',
+    displayName: 'File Operations',
+    platforms: ['darwin'], // Linux builds for tests only; Windows uses the fs.promises fallback
+    buildPath: path.join(NATIVE_ROOT, 'file-ops'),
+    binding: 'binding.gyp',
+    targetName: 'file_ops_darwin',
+    buildArgs: ['--release', '--verbose']
+  },
+  {
+    name: 'thumbnails',
+    displayName: 'Thumbnails',
+    platforms: ['darwin'], // Linux builds for tests only; other platforms show file-type icons
+    buildPath: path.join(NATIVE_ROOT, 'thumbnails'),
+    binding: 'binding.gyp',
+    targetName: 'thumbnails_darwin',
+    buildArgs: ['--release', '--verbose']
+  },
+  {
+    name: 'shelf-search',
+    displayName: 'Shelf Search',
+    platforms: ['darwin'], // Linux builds for tests only; other platforms match in JavaScript
+    buildPath: path.join(NATIVE_ROOT, 'shelf-search'),
+    binding: 'binding.gyp',
+    targetName: 'shelf_search_darwin',
+    buildArgs: ['--release', '--verbose']
   }
 ];
 
@@ -20,7 +20,17 @@ import { LogEntry } from '@shared/logger';
 import { securityConfig } from './modules/config';
 import { ShelfConfig, ShelfItem } from '@shared/types';
 import { SHELF_CONSTANTS } from '@shared/constants';
+import { encodeFileList } from '@shared/fileListPayload';
 import { destroyGlobalTimerManager } from './modules/utils';
+import {
+  createZipArchive,
+  renamePaths,
+  transferFiles,
+  TransferHandle,
+  TransferItem,
+  TransferOptions,
+  ZipHandle,
+} from '@native/file-ops';
 
 // Handle creating/removing shortcuts on Windows when installing/uninstalling.
 if (require('electron-squirrel-startup')) {
@@ -33,6 +43,8 @@ class FileCatalogerApp {
   private tray: Tray | null = null;
   private isQuitting: boolean = false;
   private logger: Logger;
+  private activeTransfers = new Map<string, TransferHandle>();
+  private activeZipExports = new Map<string, ZipHandle>();
 
   constructor() {
     // Initialize logger first
@@ -249,6 +261,37 @@ class FileCatalogerApp {
             }
           },
         },
+        {
+          label: 'Log Native Allocations (Debug)',
+          click: () => {
+            if (!this.applicationController) {
+              this.logger.warn('ApplicationController not initialized yet');
+              return;
+            }
+            // Rates are per second since the previous click
+            this.logger.info(
+              'Native allocations:',
+              this.applicationController.getNativeAllocations()
+            );
+          },
+        },
+        {
+          label: 'Profile Native Threads (Debug)',
+          click: async () => {
+            if (!this.applicationController) {
+              this.logger.warn('ApplicationController not initialized yet');
+              return;
+            }
+            // Folded stacks for 5 seconds, next to the log files
+            try {
+              await this.applicationController.profileNativeThreads(
+                this.logger.getConfig().logDirectory
+              );
+            } catch (error) {
+              this.logger.error('❌ Native profile failed:', error);
+            }
+          },
+        },
         { type: 'separator' },
         {
           label: 'Quit FileCataloger',
@@ -398,6 +441,15 @@ class FileCatalogerApp {
         this.logger.error('Failed to register file metadata handlers:', error);
       });
 
+    // Register thumbnail handlers
+    import('./ipc/thumbnail_handlers')
+      .then(({ registerThumbnailHandlers }) => {
+        registerThumbnailHandlers();
+      })
+      .catch(error => {
+        this.logger.error('Failed to register thumbnail handlers:', error);
+      });
+
     // Get application status
     ipcMain.handle('app:get-status', () => {
       if (!this.applicationController) {
@@ -517,6 +569,101 @@ class FileCatalogerApp {
       }
     });
 
+    // Rank shelf items by fuzzy name match; resolves to item ids, best first
+    ipcMain.handle(
+      'shelf:search-items',
+      async (event, shelfId: string, query: string, limit?: number) => {
+        try {
+          if (!this.applicationController) {
+            this.logger.error('📡 ApplicationController not initialized');
+            return [];
+          }
+          return this.applicationController.searchShelfItems(shelfId, query, limit);
+        } catch (error) {
+          this.logger.error('📡 Error in shelf:search-items handler:', error);
+          return [];
+        }
+      }
+    );
+
+    // Reorder shelf items by name, numbers by value; the new order arrives as shelf:config
+    ipcMain.handle('shelf:sort-items-by-name', async (event, shelfId: string) => {
+      try {
+        if (!this.applicationController) {
+          this.logger.error('📡 ApplicationController not initialized');
+          return false;
+        }
+        return this.applicationController.sortShelfItemsByName(shelfId);
+      } catch (error) {
+        this.logger.error('📡 Error in shelf:sort-items-by-name handler:', error);
+        return false;
+      }
+    });
+
+    // Zip a shelf's files and folders; asks where to save when no path is given
+    ipcMain.handle(
+      'shelf:export-zip',
+      async (event, shelfId: string, exportId: string, outputPath?: string) => {
+        try {
+          if (!this.applicationController) {
+            this.logger.error('📡 ApplicationController not initialized');
+            return { success: false, error: 'Application not initialized' };
+          }
+          const sources = this.applicationController.getShelfZipSources(shelfId);
+          if (sources.length === 0) {
+            return { success: false, error: 'Shelf has no files to export' };
+          }
+
+          if (!outputPath) {
+            const senderWindow = BrowserWindow.fromWebContents(event.sender);
+            const dialogOptions = {
+              defaultPath: path.join(app.getPath('downloads'), 'Shelf.zip'),
+              filters: [{ name: 'ZIP Archive', extensions: ['zip'] }],
+              title: 'Export Shelf as ZIP',
+            };
+            const result = senderWindow
+              ? await dialog.showSaveDialog(senderWindow, dialogOptions)
+              : await dialog.showSaveDialog(dialogOptions);
+            if (result.canceled || !result.filePath) {
+              return { success: false, cancelled: true };
+            }
+            outputPath = result.filePath;
+          }
+
+          const zip = createZipArchive(sources, outputPath, {}, progress => {
+            if (!event.sender.isDestroyed()) {
+              event.sender.send('shelf:export-zip-progress', { exportId, progress });
+            }
+          });
+          this.activeZipExports.set(exportId, zip);
+          const summary = await zip.done.finally(() => this.activeZipExports.delete(exportId));
+          this.logger.info(
+            `✅ Exported ${summary.entries} entries to ${outputPath}: ` +
+              `${summary.bytesIn} -> ${summary.bytesOut} bytes in ${Math.round(summary.durationMs)}ms`
+          );
+          return {
+            success: !summary.cancelled,
+            cancelled: summary.cancelled,
+            outputPath,
+            entries: summary.entries,
+            bytes: summary.bytesOut,
+            skipped: summary.skipped.map(error => error.path),
+          };
+        } catch (error) {
+          this.logger.error('❌ Failed to export shelf as ZIP:', error);
+          return {
+            success: false,
+            error: error instanceof Error ? error.message : 'Unknown error',
+          };
+        }
+      }
+    );
+
+    ipcMain.handle('shelf:cancel-export-zip', async (event, exportId: string) => {
+      this.activeZipExports.get(exportId)?.cancel();
+      return { success: true };
+    });
+
     // Handle shelf visibility
     ipcMain.handle('shelf:show', async (event, shelfId: string) => {
       this.logger.debug('📡 Received shelf:show IPC:', { shelfId });
@@ -760,10 +907,16 @@ class FileCatalogerApp {
       return nativeFiles;
     });
 
+    // Same list as one file-list payload, read in place by FileListView
+    ipcMain.handle('drag:get-native-files-payload', async () => {
+      const nativeFiles = this.applicationController?.getNativeDraggedFiles() ?? [];
+      return encodeFileList(nativeFiles);
+    });
+
     // Handle single file rename
     ipcMain.handle('fs:rename-file', async (event, oldPath: string, newPath: string) => {
       try {
-        await fs.promises.rename(oldPath, newPath);
+        await this.renameAcrossDevices(oldPath, newPath);
         this.logger.info(`✅ File renamed: ${path.basename(oldPath)} → ${path.basename(newPath)}`);
         return { success: true };
       } catch (error) {
@@ -779,27 +932,125 @@ class FileCatalogerApp {
     ipcMain.handle(
       'fs:rename-files',
       async (event, operations: Array<{ oldPath: string; newPath: string }>) => {
+        // One native batch for the whole list; only renames across volumes
+        // (EXDEV) go through the copy-and-delete path one by one. A batch
+        // that must run in order stops at its EXDEV, so the rest is renamed
+        // again after that move.
         const results = [];
-        for (const op of operations) {
+        let next = 0;
+        while (next < operations.length) {
+          const offset = next;
+          const batch = operations.slice(offset);
+          let errors: (NodeJS.ErrnoException | null)[];
           try {
-            await fs.promises.rename(op.oldPath, op.newPath);
-            this.logger.info(
-              `✅ File renamed: ${path.basename(op.oldPath)} → ${path.basename(op.newPath)}`
+            errors = await renamePaths(
+              batch.map(op => op.oldPath),
+              batch.map(op => op.newPath)
             );
-            results.push({ success: true, oldPath: op.oldPath, newPath: op.newPath });
           } catch (error) {
-            this.logger.error(`❌ Failed to rename ${op.oldPath}:`, error);
-            results.push({
-              success: false,
-              oldPath: op.oldPath,
-              newPath: op.newPath,
-              error: error instanceof Error ? error.message : 'Unknown error',
-            });
+            // The batch never ran: its operations fail, as the loop would report
+            this.logger.error('❌ Failed to run rename batch:', error);
+            for (const op of batch) {
+              results.push({
+                success: false,
+                oldPath: op.oldPath,
+                newPath: op.newPath,
+                error: error instanceof Error ? error.message : 'Unknown error',
+              });
+            }
+            break;
+          }
+          next = operations.length;
+          for (const [index, op] of batch.entries()) {
+            const error = errors[index];
+            if (error?.code === 'ECANCELED' && errors[index - 1]?.code === 'EXDEV') {
+              // Stopped behind the move just made; the rest goes in a new batch
+              next = offset + index;
+              break;
+            }
+            try {
+              if (error?.code === 'EXDEV') {
+                await this.renameAcrossDevices(op.oldPath, op.newPath);
+              } else if (error) {
+                throw error;
+              }
+              this.logger.info(
+                `✅ File renamed: ${path.basename(op.oldPath)} → ${path.basename(op.newPath)}`
+              );
+              results.push({ success: true, oldPath: op.oldPath, newPath: op.newPath });
+            } catch (error) {
+              this.logger.error(`❌ Failed to rename ${op.oldPath}:`, error);
+              results.push({
+                success: false,
+                oldPath: op.oldPath,
+                newPath: op.newPath,
+                error: error instanceof Error ? error.message : 'Unknown error',
+              });
+            }
           }
         }
         return { success: true, results };
       }
     );
+
+    // Copy or move files and folders; progress is sent as fs:transfer-progress
+    ipcMain.handle(
+      'fs:transfer-files',
+      async (event, transferId: string, items: TransferItem[], options: TransferOptions) => {
+        try {
+          const transfer = transferFiles(items, options, progress => {
+            if (!event.sender.isDestroyed()) {
+              event.sender.send('fs:transfer-progress', { transferId, progress });
+            }
+          });
+          this.activeTransfers.set(transferId, transfer);
+          const summary = await transfer.done.finally(() => this.activeTransfers.delete(transferId));
+          this.logger.info(
+            `✅ Transferred ${summary.items - summary.failed}/${summary.items} item(s), ` +
+              `${summary.bytes} bytes in ${Math.round(summary.durationMs)}ms`
+          );
+          return {
+            success: summary.failed === 0 && !summary.cancelled,
+            cancelled: summary.cancelled,
+            results: summary.results.map(result => ({
+              source: result.source,
+              destination: result.destination,
+              method: result.method,
+              success: !result.error,
+              error: result.error?.message,
+            })),
+          };
+        } catch (error) {
+          this.logger.error('❌ Failed to transfer files:', error);
+          return {
+            success: false,
+            error: error instanceof Error ? error.message : 'Unknown error',
+          };
+        }
+      }
+    );
+
+    ipcMain.handle('fs:cancel-transfer', async (event, transferId: string) => {
+      this.activeTransfers.get(transferId)?.cancel();
+      return { success: true };
+    });
+  }
+
+  /**
+   * rename(), falling back to a native copy and delete when the paths are on
+   * different volumes (EXDEV)
+   */
+  private async renameAcrossDevices(oldPath: string, newPath: string): Promise<void> {
+    try {
+      await fs.promises.rename(oldPath, newPath);
+    } catch (error) {
+      if ((error as NodeJS.ErrnoException).code !== 'EXDEV') throw error;
+      const summary = await transferFiles([{ source: oldPath, destination: newPath }], {
+        mode: 'move',
+      }).done;
+      const failure = summary.results[0]?.error;
+      if (failure) throw failure;
+    }
   }
 
   public getMainWindow(): BrowserWindow | null {
@@ -860,6 +1111,11 @@ class FileCatalogerApp {
           await this.applicationController.destroy();
         }
 
+        // Stop thumbnail workers
+        this.logger.info('Stopping thumbnail service...');
+        const { shutdownThumbnailHandlers } = await import('./ipc/thumbnail_handlers');
+        shutdownThumbnailHandlers();
+
         // Destroy global timer manager (cleans up all timers)
         this.logger.info('Destroying global timer manager...');
         destroyGlobalTimerManager();
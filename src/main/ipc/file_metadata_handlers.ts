@@ -1,6 +1,8 @@
 import { ipcMain } from 'electron';
 import { promises as fs } from 'fs';
 import { extname } from 'path';
+import { contentTypeInfo, extractMediaMetadata, sniffContentTypes } from '@native/file-ops';
+import type { MediaMetadata } from '@native/file-ops';
 import { logger } from '../modules/utils/logger';
 
 // IPC Response type for consistent error handling
@@ -16,6 +18,15 @@ interface FileMetadata {
   birthtime?: number;
   mtime?: number;
   atime?: number;
+  contentType?: string;
+  detectedExtension?: string;
+  // From photo and video headers
+  captureTime?: number;
+  cameraMake?: string;
+  cameraModel?: string;
+  duration?: number;
+  width?: number;
+  height?: number;
 }
 
 // Helper function to create response
@@ -68,6 +79,15 @@ async function extractFileMetadata(filePath: string): Promise<FileMetadata> {
   return metadata;
 }
 
+/**
+ * Copy capture date, camera, duration and dimensions into the metadata
+ */
+function applyMediaMetadata(metadata: FileMetadata, media: MediaMetadata | null): void {
+  if (media) {
+    Object.assign(metadata, media);
+  }
+}
+
 /**
  * Register file metadata IPC handlers
  */
@@ -81,7 +101,12 @@ export function registerFileMetadataHandlers(): void {
           throw new Error('File path is required');
         }
 
-        return await extractFileMetadata(filePath);
+        const [metadata, [media]] = await Promise.all([
+          extractFileMetadata(filePath),
+          extractMediaMetadata([filePath]),
+        ]);
+        applyMediaMetadata(metadata, media);
+        return metadata;
       }, 'file:get-metadata');
     }
   );
@@ -97,9 +122,12 @@ export function registerFileMetadataHandlers(): void {
 
         const results: Record<string, FileMetadata> = {};
 
-        // Process files in parallel for better performance
-        await Promise.all(
-          filePaths.map(async filePath => {
+        // Types and media headers for the whole batch come from one native call
+        // each, in parallel with the stats
+        const [codes, media] = await Promise.all([
+          sniffContentTypes(filePaths),
+          extractMediaMetadata(filePaths),
+          ...filePaths.map(async filePath => {
             try {
               results[filePath] = await extractFileMetadata(filePath);
             } catch (error) {
@@ -107,8 +135,17 @@ export function registerFileMetadataHandlers(): void {
               // Still include in results with empty metadata
               results[filePath] = {};
             }
-          })
-        );
+          }),
+        ]);
+
+        filePaths.forEach((filePath, index) => {
+          const info = contentTypeInfo(codes[index]);
+          if (info) {
+            results[filePath].contentType = info.mime;
+            results[filePath].detectedExtension = info.extension || undefined;
+          }
+          applyMediaMetadata(results[filePath], media[index]);
+        });
 
         return results;
       }, 'file:get-metadata-batch');
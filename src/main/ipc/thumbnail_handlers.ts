@@ -0,0 +1,68 @@
+import { app, ipcMain } from 'electron';
+import * as path from 'path';
+import {
+  configureThumbnails,
+  prioritizeThumbnails,
+  requestThumbnail,
+  shutdownThumbnails,
+} from '@native/thumbnails';
+import type { ThumbnailImage, ThumbnailViewport } from '@native/thumbnails';
+import { logger } from '../modules/utils/logger';
+
+// IPC Response type for consistent error handling
+interface IPCResponse<T = unknown> {
+  success: boolean;
+  data?: T;
+  error?: string;
+}
+
+// Shelf rows show a 24px icon; 64px keeps it sharp on 2x displays and each
+// buffer sent to the renderer at 16KB
+const SHELF_THUMBNAIL_SIZE = 64;
+
+/**
+ * Register thumbnail IPC handlers
+ */
+export function registerThumbnailHandlers(): void {
+  configureThumbnails({
+    cacheDir: path.join(app.getPath('userData'), 'thumbnails'),
+    maxSize: SHELF_THUMBNAIL_SIZE,
+  });
+
+  // Thumbnail for one image item; data is null when none can be made
+  // (cancelled, dropped from a full queue, or no native module)
+  ipcMain.handle(
+    'thumbnail:get',
+    async (
+      event,
+      filePath: string,
+      visible: boolean = true
+    ): Promise<IPCResponse<ThumbnailImage | null>> => {
+      if (!filePath) {
+        return { success: false, error: 'File path is required' };
+      }
+      try {
+        const image = await requestThumbnail(filePath, { visible }).image;
+        return { success: true, data: image };
+      } catch (error) {
+        // Unreadable, unsupported or corrupt files keep their file-type icon
+        logger.debug(`No thumbnail for ${filePath}:`, error);
+        return { success: false, error: error instanceof Error ? error.message : 'Unknown error' };
+      }
+    }
+  );
+
+  // Viewport of the shelf list: re-ranks everything still queued
+  ipcMain.on('thumbnail:prioritize', (event, viewport: ThumbnailViewport) => {
+    prioritizeThumbnails(viewport ?? {});
+  });
+
+  logger.info('Thumbnail IPC handlers registered successfully');
+}
+
+/**
+ * Stop the thumbnail workers; requests still waiting resolve to null
+ */
+export function shutdownThumbnailHandlers(): void {
+  shutdownThumbnails();
+}
@@ -1,9 +1,17 @@
 import { EventEmitter } from 'events';
+import * as path from 'path';
 import { createMouseTracker } from '@native/mouse-tracker';
 import { DragShakeDetector } from '../input';
 import { ShelfManager } from '../window/shelf_manager';
 import { PreferencesManager } from '../config/preferences_manager';
-import { MouseTracker, ShelfConfig, ShelfItem } from '@shared/types';
+import {
+  MouseTracker,
+  NativeAllocationStats,
+  NativeAllocationTag,
+  NativeProfileResult,
+  ShelfConfig,
+  ShelfItem,
+} from '@shared/types';
 import { Logger, createLogger } from '../utils/logger';
 import { DragShelfStateMachine } from '../state/drag_shelf_state_machine';
 import { keyboardManager } from '../input/keyboard_manager';
@@ -38,6 +46,10 @@ export class ApplicationController extends EventEmitter {
   // Core modules
   private mouseTracker!: MouseTracker;
   private dragShakeDetector: DragShakeDetector;
+  private lastAllocationRead: {
+    at: number;
+    totals: Partial<Record<NativeAllocationTag, { allocations: number; bytes: number }>>;
+  } | null = null;
   private shelfManager: ShelfManager;
   private preferencesManager: PreferencesManager;
   private stateMachine: DragShelfStateMachine;
@@ -401,6 +413,27 @@ export class ApplicationController extends EventEmitter {
     }
   }
 
+  /**
+   * Search shelf items by name
+   */
+  public searchShelfItems(shelfId: string, query: string, limit?: number): string[] {
+    return this.shelfManager.searchShelfItems(shelfId, query, limit);
+  }
+
+  /**
+   * Sort shelf items by name in natural order
+   */
+  public sortShelfItemsByName(shelfId: string): boolean {
+    return this.shelfManager.sortShelfItemsByName(shelfId);
+  }
+
+  /**
+   * Files and folders on a shelf, named uniquely for a ZIP archive
+   */
+  public getShelfZipSources(shelfId: string): Array<{ path: string; name: string }> {
+    return this.shelfManager.getShelfZipSources(shelfId);
+  }
+
   /**
    * Handle drop start on shelf
    */
@@ -429,6 +462,74 @@ export class ApplicationController extends EventEmitter {
     return this.dragDropCoordinator.getNativeDraggedFiles();
   }
 
+  /**
+   * Native bytes held per subsystem by the input modules, with allocation
+   * rates since the previous call
+   */
+  public getNativeAllocations(): {
+    mouseTracker: NativeAllocationStats | null;
+    dragMonitor: NativeAllocationStats | null;
+    rates: Partial<Record<NativeAllocationTag, { allocationsPerSec: number; bytesPerSec: number }>>;
+  } {
+    const mouseTracker = this.mouseTracker?.getNativeAllocations?.() ?? null;
+    const dragMonitor = this.dragShakeDetector?.getNativeAllocations() ?? null;
+    const now = Date.now();
+
+    // Each module charges its own tags, so the totals add up without overlap
+    const totals: Partial<Record<NativeAllocationTag, { allocations: number; bytes: number }>> = {};
+    for (const stats of [mouseTracker, dragMonitor]) {
+      if (!stats) continue;
+      for (const tag of Object.keys(stats) as NativeAllocationTag[]) {
+        const total = totals[tag] ?? { allocations: 0, bytes: 0 };
+        total.allocations += stats[tag].allocations;
+        total.bytes += stats[tag].bytesAllocated;
+        totals[tag] = total;
+      }
+    }
+
+    const rates: Partial<
+      Record<NativeAllocationTag, { allocationsPerSec: number; bytesPerSec: number }>
+    > = {};
+    const previous = this.lastAllocationRead;
+    if (previous && now > previous.at) {
+      const seconds = (now - previous.at) / 1000;
+      for (const tag of Object.keys(totals) as NativeAllocationTag[]) {
+        const before = previous.totals[tag] ?? { allocations: 0, bytes: 0 };
+        const after = totals[tag]!;
+        rates[tag] = {
+          allocationsPerSec: (after.allocations - before.allocations) / seconds,
+          bytesPerSec: (after.bytes - before.bytes) / seconds,
+        };
+      }
+    }
+    this.lastAllocationRead = { at: now, totals };
+
+    return { mouseTracker, dragMonitor, rates };
+  }
+
+  /**
+   * Sample the input modules' native threads for durationMs and write one
+   * folded-stack file per module into outputDir, for flamegraph tools
+   */
+  public async profileNativeThreads(
+    outputDir: string,
+    durationMs = 5000
+  ): Promise<{ mouseTracker: NativeProfileResult | null; dragMonitor: NativeProfileResult | null }> {
+    const stamp = new Date().toISOString().replace(/[:.]/g, '-');
+    const outputPath = (module: string) => path.join(outputDir, `native-${module}-${stamp}.folded`);
+
+    const [mouseTracker, dragMonitor] = await Promise.all([
+      this.mouseTracker?.startProfiling?.({ durationMs, outputPath: outputPath('mouse-tracker') }) ??
+        null,
+      this.dragShakeDetector?.startNativeProfiling({
+        durationMs,
+        outputPath: outputPath('drag-monitor'),
+      }) ?? null,
+    ]);
+    this.logger.info('Native profile written:', { mouseTracker, dragMonitor });
+    return { mouseTracker, dragMonitor };
+  }
+
   /**
    * Update configuration
    */
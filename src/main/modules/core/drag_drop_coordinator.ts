@@ -448,7 +448,7 @@ export class DragDropCoordinator extends EventEmitter {
 
       if (!this.mouseTracker.isTracking()) {
         await new Promise(resolve => setTimeout(resolve, 100));
-        this.mouseTracker.start();
+        this.startMouseTracker();
       }
 
       if (this.dragShakeDetector) {
@@ -499,12 +499,27 @@ export class DragDropCoordinator extends EventEmitter {
    */
   public start(): void {
     if (!this.mouseTracker.isTracking()) {
-      this.mouseTracker.start();
+      this.startMouseTracker();
     }
     this.dragShakeDetector.start();
     this.logger.info('✅ DragDropCoordinator started');
   }
 
+  /**
+   * Prefer the background start, which keeps the permission probe and event
+   * tap creation off the main thread during launch
+   */
+  private startMouseTracker(): void {
+    if (!this.mouseTracker.startAsync) {
+      this.mouseTracker.start();
+      return;
+    }
+    this.mouseTracker.startAsync().then(
+      timings => this.logger.info('Mouse tracker ready', timings),
+      error => this.logger.error('Mouse tracker failed to start:', error)
+    );
+  }
+
   /**
    * Stop drag and drop tracking
    */
@@ -0,0 +1,117 @@
+/**
+ * @file drag_shake_detector.test.ts
+ * @description Unit tests for DragShakeDetector start/stop ordering
+ */
+
+import { EventEmitter } from 'events';
+import { describe, it, expect, vi, beforeEach, afterEach } from 'vitest';
+import type { NativeStartupTimings } from '@shared/types';
+
+const native = vi.hoisted(() => ({ monitor: null as unknown }));
+
+vi.mock('../../utils/logger', () => {
+  const logger = { debug: () => {}, info: () => {}, warn: () => {}, error: () => {} };
+  return { createLogger: () => logger };
+});
+
+vi.mock('@native/drag-monitor', () => ({
+  createDragMonitor: () => native.monitor,
+}));
+
+import { DragShakeDetector } from '../drag_shake_detector';
+
+/** A drag monitor whose startAsync() settles only when the test says so */
+class FakeDragMonitor extends EventEmitter {
+  public starts = 0;
+  public stop = vi.fn(() => true);
+  private settle: ((ok: boolean) => void) | null = null;
+
+  public start(): boolean {
+    return true;
+  }
+
+  public startAsync(): Promise<NativeStartupTimings> {
+    this.starts++;
+    return new Promise((resolve, reject) => {
+      this.settle = ok => (ok ? resolve({} as NativeStartupTimings) : reject(new Error('denied')));
+    });
+  }
+
+  public finishStart(ok: boolean): void {
+    this.settle?.(ok);
+  }
+
+  public isDragging(): boolean {
+    return false;
+  }
+
+  public isMonitoring(): boolean {
+    return false;
+  }
+
+  public getDraggedItems(): [] {
+    return [];
+  }
+
+  public destroy(): void {}
+}
+
+describe('DragShakeDetector', () => {
+  const platform = process.platform;
+  let monitor: FakeDragMonitor;
+  let detector: DragShakeDetector;
+
+  beforeEach(() => {
+    Object.defineProperty(process, 'platform', { value: 'darwin' });
+    monitor = new FakeDragMonitor();
+    native.monitor = monitor;
+    detector = new DragShakeDetector();
+  });
+
+  afterEach(() => {
+    detector.destroy();
+    Object.defineProperty(process, 'platform', { value: platform });
+  });
+
+  it('stops the drag monitor when stop() runs during a pending start()', async () => {
+    const started = vi.fn();
+    detector.on('started', started);
+
+    const pending = detector.start();
+    expect(detector.isActive()).toBe(true);
+
+    detector.stop();
+    expect(monitor.stop).toHaveBeenCalledTimes(1);
+    expect(detector.isActive()).toBe(false);
+
+    monitor.finishStart(true);
+    await pending;
+    expect(detector.isActive()).toBe(false);
+    expect(started).not.toHaveBeenCalled();
+  });
+
+  it('runs startup once when start() is called again while pending', async () => {
+    const first = detector.start();
+    const second = detector.start();
+    expect(second).toBe(first);
+
+    monitor.finishStart(true);
+    await first;
+    expect(monitor.starts).toBe(1);
+    expect(detector.isActive()).toBe(true);
+  });
+
+  it('is not running after the drag monitor fails to start', async () => {
+    const pending = detector.start();
+    monitor.finishStart(false);
+    await pending;
+    expect(detector.isActive()).toBe(false);
+
+    // And can be started again
+    const retry = detector.start();
+    monitor.finishStart(true);
+    await retry;
+    expect(monitor.starts).toBe(2);
+    expect(detector.isActive()).toBe(true);
+  });
+});
@@ -1,7 +1,12 @@
 import { EventEmitter } from 'events';
 import { AdvancedShakeDetector } from './shake_detector';
 import { createLogger, Logger } from '../utils/logger';
-import { MousePosition } from '@shared/types';
+import {
+  MousePosition,
+  NativeAllocationStats,
+  NativeProfileOptions,
+  NativeProfileResult,
+} from '@shared/types';
 import {
   DragMonitor,
   createDragMonitor,
@@ -58,6 +63,9 @@ export class DragShakeDetector extends EventEmitter {
   private lastDragShakeTime: number = 0;
   private dragShakeDebounce: number = 400; // ms - much longer to prevent multiple shelves
   private isRunning: boolean = false;
+  private pendingStart: Promise<void> | null = null;
+  // Bumped by every start() and stop(), so a start that was stopped mid-way can tell
+  private startGeneration: number = 0;
 
   constructor() {
     super();
@@ -271,12 +279,28 @@ export class DragShakeDetector extends EventEmitter {
     this.emit('drag-end');
   }
 
-  public async start(): Promise<void> {
+  public start(): Promise<void> {
+    if (this.pendingStart) {
+      return this.pendingStart;
+    }
     if (this.isRunning) {
       this.logger.warn('DragShakeDetector is already running');
-      return;
+      return Promise.resolve();
     }
 
+    // Running from here, so stop() works mid-start; undone if startup fails
+    this.isRunning = true;
+    const generation = ++this.startGeneration;
+    const pending = this.runStart(generation).finally(() => {
+      if (this.pendingStart === pending) {
+        this.pendingStart = null;
+      }
+    });
+    this.pendingStart = pending;
+    return pending;
+  }
+
+  private async runStart(generation: number): Promise<void> {
     this.logger.info('Starting native drag-shake detector');
 
     // Start mouse batcher
@@ -287,12 +311,14 @@ export class DragShakeDetector extends EventEmitter {
     this.logger.info('✅ Shake detector initialized (will start on drag)');
 
     // Start native drag monitor
+    let success = false;
     if (this.dragMonitor) {
-      this.logger.debug('🔧 DEBUG: About to call dragMonitor.start()');
-      const success = this.dragMonitor.start();
-      this.logger.debug(`🔧 DEBUG: dragMonitor.start() returned: ${success}`);
+      success = await this.startDragMonitor(this.dragMonitor);
+      if (generation !== this.startGeneration) {
+        // stop() ran while the monitor was starting and has already stopped it
+        return;
+      }
       if (success) {
-        this.isRunning = true;
         this.logger.info('✅ System ready');
         this.logger.info('📝 Instructions:');
         this.logger.info('   1. Drag files from Finder');
@@ -305,9 +331,32 @@ export class DragShakeDetector extends EventEmitter {
       this.logger.error('❌ No drag monitor available!');
     }
 
+    if (!success) {
+      this.mouseBatcher.stop();
+      this.isRunning = false;
+    }
+
     this.emit('started');
   }
 
+  /**
+   * Prefer the background start; hook setup then runs on the native thread
+   * and only this promise waits for it
+   */
+  private async startDragMonitor(dragMonitor: DragMonitor): Promise<boolean> {
+    try {
+      if (!dragMonitor.startAsync) {
+        return dragMonitor.start();
+      }
+      const timings = await dragMonitor.startAsync();
+      this.logger.info('Drag monitor ready', timings);
+      return true;
+    } catch (error) {
+      this.logger.error('Drag monitor failed to start:', error);
+      return false;
+    }
+  }
+
   public stop(): void {
     if (!this.isRunning) {
       return;
@@ -315,6 +364,10 @@ export class DragShakeDetector extends EventEmitter {
 
     this.logger.info('Stopping drag-shake detector');
 
+    // A start still in progress finds it was stopped and returns quietly
+    this.startGeneration++;
+    this.pendingStart = null;
+
     this.mouseBatcher.stop();
 
     // PERFORMANCE OPTIMIZATION: Ensure shake detector is stopped
@@ -337,6 +390,20 @@ export class DragShakeDetector extends EventEmitter {
     return this.isRunning;
   }
 
+  /**
+   * Native bytes held by the drag monitor, or null where it has none
+   */
+  public getNativeAllocations(): NativeAllocationStats | null {
+    return this.dragMonitor?.getNativeAllocations?.() ?? null;
+  }
+
+  /**
+   * Profile the drag monitor's native threads, or null where it cannot
+   */
+  public startNativeProfiling(options: NativeProfileOptions): Promise<NativeProfileResult> | null {
+    return this.dragMonitor?.startProfiling?.(options) ?? null;
+  }
+
   public processPosition(position: MousePosition): void {
     // PERFORMANCE OPTIMIZATION: Only process positions during drag operations
     if (!this.isDragging) {
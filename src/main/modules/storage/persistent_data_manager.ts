@@ -1,10 +1,16 @@
 import { app } from 'electron';
 import Store from 'electron-store';
 import Database from 'better-sqlite3';
+import * as fs from 'fs';
 import * as path from 'path';
 import { z } from 'zod';
+import { openSessionStore } from '@native/file-ops';
+import type { SessionStore } from '@native/file-ops';
+import type { ShelfConfig } from '@shared/types';
 import { logger } from '../utils/logger';
 
+const MAX_RECENT_FILES = 50;
+
 // For simple key-value storage
 interface SessionData {
   lastShelfPosition: { x: number; y: number };
@@ -15,6 +21,7 @@ interface SessionData {
     filesDropped: number;
     lastUsed: number;
   };
+  shelfSessions: Record<string, ShelfConfig>;
 }
 
 // Schema for session data validation
@@ -42,13 +49,17 @@ const sessionDataSchema = z.object({
     filesDropped: z.number(),
     lastUsed: z.number(),
   }),
+  // Shelf configs are written by this app and restored as they are
+  shelfSessions: z.record(z.string(), z.any()).optional(),
 });
 
 export class PersistentDataManager {
   private static instance: PersistentDataManager;
 
-  // Simple key-value store for session data
-  private sessionStore!: Store<SessionData>;
+  // Binary snapshot with a delta log (session.fcs), mapped at startup.
+  // The electron-store JSON file is only used without the native module.
+  private nativeSession: SessionStore | null = null;
+  private jsonSessionStore: Store<SessionData> | null = null;
 
   // SQLite for complex queries and file history
   private db: Database.Database | null = null;
@@ -69,7 +80,39 @@ export class PersistentDataManager {
   }
 
   private initializeSessionStore(): void {
-    this.sessionStore = new Store<SessionData>({
+    try {
+      this.nativeSession = openSessionStore(path.join(app.getPath('userData'), 'session.fcs'));
+    } catch (error) {
+      logger.error('Failed to open session snapshot, using JSON session store:', error);
+    }
+
+    if (!this.nativeSession) {
+      this.jsonSessionStore = this.createJsonSessionStore();
+      return;
+    }
+
+    // One-time migration; the JSON file is left in place for a downgrade
+    const legacyPath = path.join(app.getPath('userData'), 'session.json');
+    if (this.nativeSession.isEmpty() && fs.existsSync(legacyPath)) {
+      const legacy = this.createJsonSessionStore();
+      this.writeSessionData(legacy.store);
+      this.nativeSession.compact();
+      logger.info('Migrated session data to binary snapshot');
+    }
+  }
+
+  /**
+   * The JSON session store, for callers that found no native session
+   */
+  private get sessionStore(): Store<SessionData> {
+    if (!this.jsonSessionStore) {
+      throw new Error('JSON session store is not initialized');
+    }
+    return this.jsonSessionStore;
+  }
+
+  private createJsonSessionStore(): Store<SessionData> {
+    return new Store<SessionData>({
       name: 'session',
       defaults: {
         lastShelfPosition: { x: 0, y: 0 },
@@ -80,6 +123,7 @@ export class PersistentDataManager {
           filesDropped: 0,
           lastUsed: Date.now(),
         },
+        shelfSessions: {},
       },
 
       // Clear old data automatically
@@ -206,14 +250,26 @@ export class PersistentDataManager {
   // Session data methods
 
   public updateLastShelfPosition(x: number, y: number): void {
+    if (this.nativeSession) {
+      this.nativeSession.setLastShelfPosition(x, y);
+      return;
+    }
     this.sessionStore.set('lastShelfPosition', { x, y });
   }
 
   public getLastShelfPosition(): { x: number; y: number } {
+    if (this.nativeSession) {
+      return this.nativeSession.getLastShelfPosition() ?? { x: 0, y: 0 };
+    }
     return this.sessionStore.get('lastShelfPosition');
   }
 
   public addRecentFile(filePath: string): void {
+    if (this.nativeSession) {
+      this.nativeSession.addRecentFile(filePath, Date.now(), MAX_RECENT_FILES);
+      return;
+    }
+
     const recentFiles = this.sessionStore.get('recentFiles');
 
     // Remove if already exists
@@ -224,20 +280,25 @@ export class PersistentDataManager {
     // Add to beginning
     filtered.unshift({ path: filePath, timestamp: Date.now() });
 
-    // Keep only last 50
-    if (filtered.length > 50) {
-      filtered.splice(50);
+    // Keep only the most recent
+    if (filtered.length > MAX_RECENT_FILES) {
+      filtered.splice(MAX_RECENT_FILES);
     }
 
     this.sessionStore.set('recentFiles', filtered);
   }
 
   public getRecentFiles(limit: number = 10): Array<{ path: string; timestamp: number }> {
+    if (this.nativeSession) {
+      return this.nativeSession.getRecentFiles(limit);
+    }
     return this.sessionStore.get('recentFiles').slice(0, limit);
   }
 
   public updateUsageStats(type: 'shelfCreation' | 'fileDropped'): void {
-    const stats = this.sessionStore.get('usageStats');
+    const stats = this.nativeSession
+      ? (this.nativeSession.getUsageStats() ?? { shelfCreations: 0, filesDropped: 0, lastUsed: 0 })
+      : this.sessionStore.get('usageStats');
 
     if (type === 'shelfCreation') {
       stats.shelfCreations++;
@@ -246,7 +307,102 @@ export class PersistentDataManager {
     }
 
     stats.lastUsed = Date.now();
-    this.sessionStore.set('usageStats', stats);
+    if (this.nativeSession) {
+      this.nativeSession.setUsageStats(stats);
+    } else {
+      this.sessionStore.set('usageStats', stats);
+    }
+  }
+
+  // Shelf sessions: one record per shelf, so restoring the first visible
+  // shelf decodes only that shelf
+
+  public saveShelfSession(config: ShelfConfig): void {
+    if (this.nativeSession) {
+      this.nativeSession.setShelf(config.id, config);
+      return;
+    }
+    const shelfSessions = this.sessionStore.get('shelfSessions') ?? {};
+    this.sessionStore.set('shelfSessions', { ...shelfSessions, [config.id]: config });
+  }
+
+  public getShelfSessionIds(): string[] {
+    if (this.nativeSession) {
+      return this.nativeSession.shelfIds();
+    }
+    return Object.keys(this.sessionStore.get('shelfSessions') ?? {});
+  }
+
+  public loadShelfSession(shelfId: string): ShelfConfig | null {
+    if (this.nativeSession) {
+      return this.nativeSession.getShelf<ShelfConfig>(shelfId);
+    }
+    return this.sessionStore.get('shelfSessions')?.[shelfId] ?? null;
+  }
+
+  public removeShelfSession(shelfId: string): void {
+    if (this.nativeSession) {
+      this.nativeSession.deleteShelf(shelfId);
+      return;
+    }
+    const { [shelfId]: _removed, ...shelfSessions } = this.sessionStore.get('shelfSessions') ?? {};
+    this.sessionStore.set('shelfSessions', shelfSessions);
+  }
+
+  private readSessionData(): SessionData {
+    if (!this.nativeSession) {
+      return this.sessionStore.store;
+    }
+    const session = this.nativeSession;
+    const windowStates: SessionData['windowStates'] = {};
+    for (const windowId of session.windowIds()) {
+      const bounds = session.getWindowBounds(windowId);
+      if (bounds) windowStates[windowId] = { bounds };
+    }
+    const shelfSessions: SessionData['shelfSessions'] = {};
+    for (const shelfId of session.shelfIds()) {
+      const shelf = session.getShelf<ShelfConfig>(shelfId);
+      if (shelf) shelfSessions[shelfId] = shelf;
+    }
+    return {
+      lastShelfPosition: session.getLastShelfPosition() ?? { x: 0, y: 0 },
+      recentFiles: session.getRecentFiles(),
+      windowStates,
+      usageStats: session.getUsageStats() ?? {
+        shelfCreations: 0,
+        filesDropped: 0,
+        lastUsed: Date.now(),
+      },
+      shelfSessions,
+    };
+  }
+
+  private writeSessionData(data: Partial<SessionData>): void {
+    if (!this.nativeSession) {
+      this.sessionStore.clear();
+      Object.entries(data).forEach(([key, value]) => {
+        this.sessionStore.set(key as keyof SessionData, value);
+      });
+      return;
+    }
+    const session = this.nativeSession;
+    session.clear();
+    if (data.lastShelfPosition) {
+      session.setLastShelfPosition(data.lastShelfPosition.x, data.lastShelfPosition.y);
+    }
+    // Oldest first, so the cap keeps the newest
+    for (const file of [...(data.recentFiles ?? [])].reverse()) {
+      session.addRecentFile(file.path, file.timestamp, MAX_RECENT_FILES);
+    }
+    for (const [windowId, state] of Object.entries(data.windowStates ?? {})) {
+      session.setWindowBounds(windowId, state.bounds);
+    }
+    if (data.usageStats) {
+      session.setUsageStats(data.usageStats);
+    }
+    for (const [shelfId, shelf] of Object.entries(data.shelfSessions ?? {})) {
+      session.setShelf(shelfId, shelf);
+    }
   }
 
   // Database methods for complex data
@@ -357,6 +513,14 @@ export class PersistentDataManager {
   }
 
   public close(): void {
+    if (this.nativeSession) {
+      // The next start maps one snapshot and replays nothing
+      try {
+        this.nativeSession.compact();
+      } catch (error) {
+        logger.error('Failed to compact session snapshot:', error);
+      }
+    }
     if (this.db) {
       this.db.close();
       this.db = null;
@@ -367,7 +531,7 @@ export class PersistentDataManager {
 
   public async exportData(): Promise<string> {
     const data = {
-      session: this.sessionStore.store,
+      session: this.readSessionData(),
       database: this.db ? await this.exportDatabase() : null,
       version: '1.0.0',
       exportDate: new Date().toISOString(),
@@ -394,10 +558,7 @@ export class PersistentDataManager {
       if (data.session) {
         const validated = sessionDataSchema.parse(data.session);
         // Clear existing data and set new data
-        this.sessionStore.clear();
-        Object.entries(validated).forEach(([key, value]) => {
-          this.sessionStore.set(key as keyof SessionData, value);
-        });
+        this.writeSessionData(validated as SessionData);
       }
 
       // Import database data if available
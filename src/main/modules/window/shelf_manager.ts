@@ -7,6 +7,7 @@ import { createLogger } from '../utils/logger';
 import { globalIPCRateLimiter } from '../utils/ipc_rate_limiter';
 import { AdvancedWindowPool } from './advanced_window_pool';
 import { AsyncMutex } from '../utils/async_mutex';
+import { NameIndex, naturalSortOrder } from '@native/shelf-search';
 
 /**
  * Advanced shelf window management system
@@ -28,6 +29,10 @@ export class ShelfManager extends EventEmitter {
   // Mutex to prevent concurrent shelf creation race condition
   private shelfCreationMutex = new AsyncMutex();
 
+  // Name indexes for search, built on first search and kept in step with
+  // appended items; any other change to a shelf's items drops its index
+  private nameIndexes = new Map<string, { index: NameIndex; items: ShelfItem[]; count: number }>();
+
   // Configuration
   private readonly DEFAULT_SHELF_SIZE = {
     width: SHELF_CONSTANTS.DEFAULT_WIDTH,
@@ -591,6 +596,7 @@ export class ShelfManager extends EventEmitter {
       const index = config.items.findIndex(item => item.id === itemId);
       if (index > -1) {
         const removedItem = config.items.splice(index, 1)[0];
+        this.nameIndexes.delete(shelfId);
 
         // Add debug logging for item removal
         this.logger.debug(`🗑️ ShelfManager: Removed item ${itemId} from shelf ${shelfId}`);
@@ -612,6 +618,78 @@ export class ShelfManager extends EventEmitter {
     return false;
   }
 
+  /**
+   * Fuzzy-search a shelf's items by name; returns item ids, best match first
+   */
+  public searchShelfItems(shelfId: string, query: string, limit: number = 0): string[] {
+    const config = this.shelfConfigs.get(shelfId);
+    if (!config) {
+      return [];
+    }
+
+    let entry = this.nameIndexes.get(shelfId);
+    if (!entry || entry.items !== config.items || entry.count > config.items.length) {
+      entry = { index: new NameIndex(), items: config.items, count: 0 };
+      this.nameIndexes.set(shelfId, entry);
+    }
+    if (entry.count < config.items.length) {
+      entry.index.append(config.items.slice(entry.count).map(item => item.name));
+      entry.count = config.items.length;
+    }
+
+    const { indices } = entry.index.search(query, { limit });
+    return Array.from(indices, index => config.items[index].id);
+  }
+
+  /**
+   * Reorder a shelf's items by name in natural order ("img2" before
+   * "img10"), so counter-based renames number them the way they read
+   */
+  public sortShelfItemsByName(shelfId: string): boolean {
+    const config = this.shelfConfigs.get(shelfId);
+    if (!config) {
+      return false;
+    }
+
+    const order = naturalSortOrder(config.items.map(item => item.name));
+    config.items = Array.from(order, index => config.items[index]);
+    this.nameIndexes.delete(shelfId);
+
+    const window = this.shelves.get(shelfId);
+    if (window && !window.isDestroyed()) {
+      window.webContents.send('shelf:config', config);
+    }
+    return true;
+  }
+
+  /**
+   * Files and folders on a shelf as ZIP sources, in shelf order. Items
+   * without a path (text, URLs) are left out, and names that repeat get a
+   * " (2)" suffix before the extension, the way Finder names copies.
+   */
+  public getShelfZipSources(shelfId: string): Array<{ path: string; name: string }> {
+    const config = this.shelfConfigs.get(shelfId);
+    if (!config) {
+      return [];
+    }
+
+    const used = new Set<string>();
+    const sources: Array<{ path: string; name: string }> = [];
+    for (const item of config.items) {
+      if (!item.path) continue;
+      const base = path.basename(item.path);
+      const extension = path.extname(base);
+      const stem = base.slice(0, base.length - extension.length);
+      let name = base;
+      for (let copy = 2; used.has(name.toLowerCase()); copy++) {
+        name = `${stem} (${copy})${extension}`;
+      }
+      used.add(name.toLowerCase());
+      sources.push({ path: item.path, name });
+    }
+    return sources;
+  }
+
   /**
    * Update shelf configuration
    */
@@ -676,6 +754,7 @@ export class ShelfManager extends EventEmitter {
       // Clean up tracking
       this.shelves.delete(shelfId);
       this.shelfConfigs.delete(shelfId);
+      this.nameIndexes.delete(shelfId);
       this.activeShelves.delete(shelfId);
 
       this.emit('shelf-destroyed', shelfId);
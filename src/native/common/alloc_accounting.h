@@ -0,0 +1,111 @@
+/**
+ * @file alloc_accounting.h
+ * @brief Live bytes, peak and allocation totals per native subsystem
+ *
+ * Memory a module holds is charged to one of a few tags by the code that
+ * owns it: BatchedDispatcher charges its queued items to EventQueue and
+ * each drained batch to NapiPayload, DragSession charges the arena bytes it
+ * uses to Trajectory, Analysis and Paths, and ArenaChunkCache charges the
+ * chunks it keeps for the next session to ArenaCache. Sessions take their
+ * bytes out of chunks, so the tags do not overlap.
+ *
+ * The counters are relaxed atomics, shared by every thread of the module
+ * (each .node has its own copy). Charging costs two or three uncontended
+ * atomic adds, so it stays on. Allocation rates are derived by the reader
+ * from two reads of the totals.
+ */
+
+#ifndef NATIVE_COMMON_ALLOC_ACCOUNTING_H
+#define NATIVE_COMMON_ALLOC_ACCOUNTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace FileCataloger {
+
+enum class AllocTag : uint8_t {
+    EventQueue,    // items waiting in a BatchedDispatcher lane
+    Trajectory,    // trajectory rings of drag sessions
+    Paths,         // dragged file paths and their index
+    Analysis,      // trajectory snapshots for the analysis thread
+    NapiPayload,   // batches being handed to JS
+    ArenaCache,    // arena chunks parked between sessions
+    Count
+};
+
+inline const char* AllocTagName(AllocTag tag) {
+    switch (tag) {
+        case AllocTag::EventQueue: return "eventQueue";
+        case AllocTag::Trajectory: return "trajectory";
+        case AllocTag::Paths: return "paths";
+        case AllocTag::Analysis: return "analysis";
+        case AllocTag::NapiPayload: return "napiPayload";
+        case AllocTag::ArenaCache: return "arenaCache";
+        case AllocTag::Count: break;
+    }
+    return "unknown";
+}
+
+struct AllocTagStats {
+    int64_t liveBytes = 0;
+    int64_t peakBytes = 0;
+    uint64_t allocations = 0;     // charges since start
+    uint64_t bytesAllocated = 0;  // bytes charged since start
+};
+
+class AllocAccounting {
+public:
+    static void Charge(AllocTag tag, size_t bytes) {
+        Counters& counters = Of(tag);
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+        int64_t live = counters.liveBytes.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) +
+                       static_cast<int64_t>(bytes);
+        int64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+        while (live > peak &&
+               !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void Credit(AllocTag tag, size_t bytes) {
+        Of(tag).liveBytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    static AllocTagStats Read(AllocTag tag) {
+        const Counters& counters = Of(tag);
+        AllocTagStats stats;
+        stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+        stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+        stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+        stats.bytesAllocated = counters.bytesAllocated.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // Restart peaks from the current live bytes, e.g. per measurement window
+    static void ResetPeaks() {
+        for (size_t i = 0; i < static_cast<size_t>(AllocTag::Count); i++) {
+            Counters& counters = Of(static_cast<AllocTag>(i));
+            counters.peakBytes.store(counters.liveBytes.load(std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
+        }
+    }
+
+private:
+    // One cache line per tag so threads charging different tags do not share
+    struct alignas(64) Counters {
+        std::atomic<int64_t> liveBytes{0};
+        std::atomic<int64_t> peakBytes{0};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> bytesAllocated{0};
+    };
+
+    static Counters& Of(AllocTag tag) {
+        static Counters counters[static_cast<size_t>(AllocTag::Count)];
+        return counters[static_cast<size_t>(tag)];
+    }
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_ALLOC_ACCOUNTING_H
@@ -0,0 +1,148 @@
+/**
+ * @file async_startup.h
+ * @brief Promise-returning start for native input modules
+ *
+ * Starting an input module probes the accessibility permission (which may
+ * show a prompt), creates an event tap and its run loop source, and spins
+ * up a thread. Inside start(), all of that blocks the JS thread while the
+ * app launches. AsyncStartup lets startAsync() return a promise instead: the
+ * module's own event thread runs those phases, fills a StartupReport with
+ * their timings and calls Complete() once. The promise resolves with the
+ * timings, or rejects with an Error carrying the code, message and the
+ * timings gathered up to the failure.
+ */
+
+#ifndef NATIVE_COMMON_ASYNC_STARTUP_H
+#define NATIVE_COMMON_ASYNC_STARTUP_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <node_api.h>
+
+namespace FileCataloger {
+
+/**
+ * Outcome of one asynchronous start, all times in ms
+ */
+struct StartupReport {
+    int code = 0;               // module error code; 0 resolves the promise
+    std::string message;
+    double threadSpawnMs = 0;   // startAsync() until the event thread ran
+    double permissionMs = 0;    // accessibility probe, including any prompt
+    double hookMs = 0;          // event tap, run loop source and timers
+    double totalMs = 0;         // startAsync() until events can flow
+};
+
+class AsyncStartup : public std::enable_shared_from_this<AsyncStartup> {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Create the promise on the JS thread. Returns nullptr with a pending
+     * exception on failure; the name labels the threadsafe function.
+     */
+    static std::shared_ptr<AsyncStartup> Create(napi_env env, const char* name, napi_value* promise) {
+        std::shared_ptr<AsyncStartup> startup(new AsyncStartup());
+
+        napi_value resourceName;
+        if (napi_create_promise(env, &startup->deferred_, promise) != napi_ok ||
+            napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resourceName) != napi_ok ||
+            napi_create_threadsafe_function(env, nullptr, nullptr, resourceName, 0, 1,
+                                            nullptr, nullptr, nullptr, CallJs,
+                                            &startup->tsfn_) != napi_ok) {
+            // A promise already created stays pending and is dropped
+            napi_throw_error(env, nullptr, "Failed to create startup promise");
+            return nullptr;
+        }
+        return startup;
+    }
+
+    // A startup dropped without Complete() leaves its promise pending but
+    // must not hold the event loop open
+    ~AsyncStartup() {
+        if (!completed_.load() && tsfn_ != nullptr) {
+            napi_release_threadsafe_function(tsfn_, napi_tsfn_release);
+        }
+    }
+
+    AsyncStartup(const AsyncStartup&) = delete;
+    AsyncStartup& operator=(const AsyncStartup&) = delete;
+
+    static double MsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double MsSinceRequest() const { return MsSince(requested_); }
+
+    // JS thread, before startAsync() returns; reported as blockingMs
+    void SetBlockingMs(double ms) { blockingMs_ = ms; }
+
+    /**
+     * Settle the promise from any thread. Only the first call counts, so a
+     * start that races a stop cannot settle it twice.
+     */
+    void Complete(StartupReport report) {
+        if (completed_.exchange(true)) return;
+
+        auto* delivery = new Delivery{shared_from_this(), std::move(report)};
+        if (napi_call_threadsafe_function(tsfn_, delivery, napi_tsfn_blocking) != napi_ok) {
+            delete delivery;
+        }
+        napi_release_threadsafe_function(tsfn_, napi_tsfn_release);
+    }
+
+private:
+    // Holds the startup alive until CallJs has read the deferred
+    struct Delivery {
+        std::shared_ptr<AsyncStartup> startup;
+        StartupReport report;
+    };
+
+    AsyncStartup() : requested_(Clock::now()) {}
+
+    static void SetTiming(napi_env env, napi_value object, const char* name, double ms) {
+        napi_value value;
+        napi_create_double(env, ms, &value);
+        napi_set_named_property(env, object, name, value);
+    }
+
+    static void CallJs(napi_env env, napi_value, void*, void* data) {
+        std::unique_ptr<Delivery> delivery(static_cast<Delivery*>(data));
+        if (env == nullptr) return;
+
+        const StartupReport& report = delivery->report;
+        napi_value timings;
+        napi_create_object(env, &timings);
+        SetTiming(env, timings, "blockingMs", delivery->startup->blockingMs_);
+        SetTiming(env, timings, "threadSpawnMs", report.threadSpawnMs);
+        SetTiming(env, timings, "permissionMs", report.permissionMs);
+        SetTiming(env, timings, "hookMs", report.hookMs);
+        SetTiming(env, timings, "totalMs", report.totalMs);
+
+        napi_deferred deferred = delivery->startup->deferred_;
+        if (report.code == 0) {
+            napi_resolve_deferred(env, deferred, timings);
+            return;
+        }
+
+        napi_value code, message, error;
+        napi_create_int32(env, report.code, &code);
+        napi_create_string_utf8(env, report.message.c_str(), report.message.size(), &message);
+        napi_create_error(env, nullptr, message, &error);
+        napi_set_named_property(env, error, "code", code);
+        napi_set_named_property(env, error, "timings", timings);
+        napi_reject_deferred(env, deferred, error);
+    }
+
+    napi_deferred deferred_ = nullptr;
+    napi_threadsafe_function tsfn_ = nullptr;
+    std::atomic<bool> completed_{false};
+    Clock::time_point requested_;
+    double blockingMs_ = 0;
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_ASYNC_STARTUP_H
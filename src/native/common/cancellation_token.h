@@ -0,0 +1,115 @@
+/**
+ * @file cancellation_token.h
+ * @brief Cancellation tokens with deadlines for native jobs
+ *
+ * A CancellationSource owns the right to cancel; the CancellationTokens it
+ * hands out only observe. Jobs take a token in their options and poll it
+ * between chunks of work (a directory, a chunk of paths, a copy buffer),
+ * so cancelling costs nothing until it happens and takes effect within one
+ * chunk on every pool thread.
+ *
+ * A source may have a deadline, after which its tokens read as cancelled
+ * with reason DeadlineExceeded, and a parent token, whose cancellation it
+ * inherits. Jobs that can also be cancelled directly (DirectoryWalker,
+ * FileTransfer) keep their own source linked to the caller's token.
+ *
+ * In JS, file-ops' NativeCancellationToken wraps a source; the TypeScript
+ * wrappers create one per job from an AbortSignal and a deadlineMs option.
+ */
+
+#ifndef NATIVE_COMMON_CANCELLATION_TOKEN_H
+#define NATIVE_COMMON_CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace FileCataloger {
+
+enum class CancelReason : uint8_t {
+    None = 0,
+    Cancelled = 1,          // Cancel() on this source or a parent
+    DeadlineExceeded = 2
+};
+
+class CancellationToken {
+public:
+    // A token that is never cancelled
+    CancellationToken() = default;
+
+    bool IsCancelled() const { return Reason() != CancelReason::None; }
+
+    // The first reason observed is kept, so a job that stopped for its
+    // deadline reports DeadlineExceeded even if it is cancelled afterwards
+    CancelReason Reason() const { return ReasonOf(state_.get()); }
+
+    bool CanBeCancelled() const { return state_ != nullptr; }
+
+private:
+    friend class CancellationSource;
+    using Clock = std::chrono::steady_clock;
+
+    struct State;
+
+    explicit CancellationToken(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    static CancelReason ReasonOf(State* first);
+
+    std::shared_ptr<State> state_;
+};
+
+struct CancellationToken::State {
+    std::atomic<uint8_t> reason{static_cast<uint8_t>(CancelReason::None)};
+    Clock::time_point deadline;     // epoch for none; fixed at construction
+    std::shared_ptr<State> parent;
+
+    CancelReason Latch(CancelReason wanted) {
+        uint8_t expected = static_cast<uint8_t>(CancelReason::None);
+        reason.compare_exchange_strong(expected, static_cast<uint8_t>(wanted), std::memory_order_acq_rel);
+        return static_cast<CancelReason>(reason.load(std::memory_order_acquire));
+    }
+};
+
+inline CancelReason CancellationToken::ReasonOf(State* first) {
+    for (State* state = first; state != nullptr; state = state->parent.get()) {
+        auto reason = static_cast<CancelReason>(state->reason.load(std::memory_order_acquire));
+        if (reason == CancelReason::None && state->deadline != Clock::time_point() &&
+            Clock::now() >= state->deadline) {
+            reason = state->Latch(CancelReason::DeadlineExceeded);
+        }
+        if (reason != CancelReason::None) {
+            return reason;
+        }
+    }
+    return CancelReason::None;
+}
+
+class CancellationSource {
+public:
+    // deadline zero means none; it counts from construction
+    explicit CancellationSource(CancellationToken parent = CancellationToken(),
+                                std::chrono::milliseconds deadline = std::chrono::milliseconds::zero())
+        : state_(std::make_shared<CancellationToken::State>()) {
+        state_->parent = std::move(parent.state_);
+        if (deadline > std::chrono::milliseconds::zero()) {
+            state_->deadline = CancellationToken::Clock::now() + deadline;
+        }
+    }
+
+    CancellationSource(const CancellationSource&) = delete;
+    CancellationSource& operator=(const CancellationSource&) = delete;
+
+    void Cancel() { state_->Latch(CancelReason::Cancelled); }
+
+    CancellationToken Token() const { return CancellationToken(state_); }
+    bool IsCancelled() const { return Reason() != CancelReason::None; }
+    CancelReason Reason() const { return CancellationToken::ReasonOf(state_.get()); }
+
+private:
+    std::shared_ptr<CancellationToken::State> state_;
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_CANCELLATION_TOKEN_H
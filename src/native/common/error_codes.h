@@ -44,6 +44,12 @@ enum class ErrorCode {
     MOUSE_TRACKER_STOP_FAILED = 301,
     DRAG_MONITOR_START_FAILED = 310,
     DRAG_MONITOR_STOP_FAILED = 311,
+    DIRECTORY_WALK_FAILED = 320,
+    FOLDER_SIZE_FAILED = 321,
+    TRANSFER_FAILED = 322,
+    ZIP_FAILED = 323,
+    SESSION_STORE_FAILED = 324,
+    THUMBNAIL_FAILED = 330,
 
     // Callback errors (400-499)
     CALLBACK_NOT_SET = 400,
@@ -88,6 +94,12 @@ inline std::string GetErrorMessage(ErrorCode code) {
         {ErrorCode::MOUSE_TRACKER_STOP_FAILED, "Failed to stop mouse tracker"},
         {ErrorCode::DRAG_MONITOR_START_FAILED, "Failed to start drag monitor"},
         {ErrorCode::DRAG_MONITOR_STOP_FAILED, "Failed to stop drag monitor"},
+        {ErrorCode::DIRECTORY_WALK_FAILED, "Failed to walk directory"},
+        {ErrorCode::FOLDER_SIZE_FAILED, "Failed to measure folder size"},
+        {ErrorCode::TRANSFER_FAILED, "Failed to copy or move files"},
+        {ErrorCode::ZIP_FAILED, "Failed to write ZIP archive"},
+        {ErrorCode::SESSION_STORE_FAILED, "Failed to open or write session store"},
+        {ErrorCode::THUMBNAIL_FAILED, "Failed to create thumbnail"},
 
         {ErrorCode::CALLBACK_NOT_SET, "Callback function not set"},
         {ErrorCode::CALLBACK_INVOKE_FAILED, "Failed to invoke callback function"},
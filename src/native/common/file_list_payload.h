@@ -0,0 +1,237 @@
+/**
+ * @file file_list_payload.h
+ * @brief Compact binary encoding of a file list for main → renderer transfer
+ *
+ * A file list sent as an array of objects repeats the keys of every entry
+ * and is structured-cloned at each hop. This payload is one buffer instead:
+ * a header, one fixed-width record per file, then a string table holding
+ * the UTF-8 bytes of the paths. A reader (FileListView in
+ * src/shared/fileListPayload.ts) indexes the records with typed arrays and
+ * decodes a string only when it is asked for.
+ *
+ * Layout, little-endian, every offset in bytes:
+ *
+ *   header (16)    u32 magic 'FCFL', u16 version, u16 record size (32),
+ *                  u32 record count, u32 string table bytes
+ *   record (32)    u32 path offset, u32 path length,
+ *                  u32 name offset, u32 name length,
+ *                  u32 extension offset, u16 extension length, u16 flags,
+ *                  f64 size (NaN when unknown)
+ *   string table   at 16 + 32 * count; offsets are relative to it
+ *
+ * The total length is padded to a multiple of 8. A name that is the tail of
+ * its path, and an extension that is the tail of its name, point into the
+ * path's bytes rather than being stored again.
+ *
+ * FileListPayloadReader reads a payload back in place, for native code
+ * handed one from JS (the shelf store's bulk insert of drag results).
+ */
+
+#ifndef NATIVE_COMMON_FILE_LIST_PAYLOAD_H
+#define NATIVE_COMMON_FILE_LIST_PAYLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FileCataloger {
+
+constexpr uint32_t FILE_LIST_PAYLOAD_MAGIC = 0x4C464346;  // "FCFL"
+constexpr uint16_t FILE_LIST_PAYLOAD_VERSION = 1;
+constexpr size_t FILE_LIST_HEADER_BYTES = 16;
+constexpr size_t FILE_LIST_RECORD_BYTES = 32;
+
+enum FileListFlag : uint16_t {
+    FILE_LIST_IS_DIRECTORY = 1 << 0,
+    FILE_LIST_IS_FILE = 1 << 1,
+    FILE_LIST_EXISTS = 1 << 2,
+};
+
+struct FileListEntry {
+    std::string_view path;
+    std::string_view name;
+    std::string_view extension;   // without the dot; empty if none
+    uint16_t flags = 0;
+    double size = std::numeric_limits<double>::quiet_NaN();
+};
+
+/**
+ * Collects entries (Add copies their bytes), then writes the payload into
+ * caller-owned memory, e.g. a freshly created ArrayBuffer, in one pass.
+ */
+class FileListPayloadWriter {
+public:
+    void Reserve(size_t count) { records_.reserve(count); }
+
+    void Add(const FileListEntry& entry) {
+        Record record;
+        record.pathOffset = Append(entry.path);
+        record.pathLength = static_cast<uint32_t>(entry.path.size());
+        record.nameOffset = Within(entry.path, record.pathOffset, entry.name);
+        record.nameLength = static_cast<uint32_t>(entry.name.size());
+
+        // Extensions are ASCII in practice; longer ones are cut to fit u16
+        std::string_view extension = entry.extension.substr(0, UINT16_MAX);
+        std::string_view name = Slice(record.nameOffset, record.nameLength);
+        record.extensionOffset = Within(name, record.nameOffset, extension);
+        record.extensionLength = static_cast<uint16_t>(extension.size());
+        record.flags = entry.flags;
+        record.size = entry.size;
+        records_.push_back(record);
+    }
+
+    size_t Count() const { return records_.size(); }
+
+    size_t ByteLength() const {
+        size_t length = FILE_LIST_HEADER_BYTES + records_.size() * FILE_LIST_RECORD_BYTES +
+                        strings_.size();
+        return (length + 7) & ~size_t(7);
+    }
+
+    // out must hold ByteLength() bytes
+    void WriteTo(void* out) const {
+        auto* bytes = static_cast<uint8_t*>(out);
+        uint8_t* p = bytes;
+        Put32(p, FILE_LIST_PAYLOAD_MAGIC);
+        Put16(p, FILE_LIST_PAYLOAD_VERSION);
+        Put16(p, static_cast<uint16_t>(FILE_LIST_RECORD_BYTES));
+        Put32(p, static_cast<uint32_t>(records_.size()));
+        Put32(p, static_cast<uint32_t>(strings_.size()));
+
+        for (const Record& record : records_) {
+            Put32(p, record.pathOffset);
+            Put32(p, record.pathLength);
+            Put32(p, record.nameOffset);
+            Put32(p, record.nameLength);
+            Put32(p, record.extensionOffset);
+            Put16(p, record.extensionLength);
+            Put16(p, record.flags);
+            uint64_t bits;
+            std::memcpy(&bits, &record.size, sizeof(bits));
+            Put32(p, static_cast<uint32_t>(bits));
+            Put32(p, static_cast<uint32_t>(bits >> 32));
+        }
+
+        if (!strings_.empty()) {
+            std::memcpy(p, strings_.data(), strings_.size());
+            p += strings_.size();
+        }
+        std::memset(p, 0, bytes + ByteLength() - p);
+    }
+
+    std::vector<uint8_t> Finish() const {
+        std::vector<uint8_t> payload(ByteLength());
+        WriteTo(payload.data());
+        return payload;
+    }
+
+private:
+    struct Record {
+        uint32_t pathOffset;
+        uint32_t pathLength;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t extensionOffset;
+        uint16_t extensionLength;
+        uint16_t flags;
+        double size;
+    };
+
+    uint32_t Append(std::string_view text) {
+        uint32_t offset = static_cast<uint32_t>(strings_.size());
+        strings_.append(text.data(), text.size());
+        return offset;
+    }
+
+    // Offset of part if it is the tail of whole (stored at offset), else a copy
+    uint32_t Within(std::string_view whole, uint32_t offset, std::string_view part) {
+        if (part.size() <= whole.size() &&
+            whole.compare(whole.size() - part.size(), part.size(), part) == 0) {
+            return offset + static_cast<uint32_t>(whole.size() - part.size());
+        }
+        return Append(part);
+    }
+
+    std::string_view Slice(uint32_t offset, uint32_t length) const {
+        return std::string_view(strings_).substr(offset, length);
+    }
+
+    static void Put16(uint8_t*& p, uint16_t value) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        p += 2;
+    }
+
+    static void Put32(uint8_t*& p, uint32_t value) {
+        Put16(p, static_cast<uint16_t>(value));
+        Put16(p, static_cast<uint16_t>(value >> 16));
+    }
+
+    std::vector<Record> records_;
+    std::string strings_;
+};
+
+/**
+ * Validates a payload's header and bounds once, then reads entries without
+ * copying; the views point into the caller's buffer, which must outlive them.
+ */
+class FileListPayloadReader {
+public:
+    // False (and Count() 0) unless every record's strings lie in the table
+    bool Open(const uint8_t* bytes, size_t length) {
+        count_ = 0;
+        if (length < FILE_LIST_HEADER_BYTES || Get32(bytes) != FILE_LIST_PAYLOAD_MAGIC ||
+            Get16(bytes + 4) != FILE_LIST_PAYLOAD_VERSION || Get16(bytes + 6) != FILE_LIST_RECORD_BYTES) {
+            return false;
+        }
+        const uint64_t count = Get32(bytes + 8);
+        const uint64_t stringBytes = Get32(bytes + 12);
+        const uint64_t stringsStart = FILE_LIST_HEADER_BYTES + count * FILE_LIST_RECORD_BYTES;
+        if (stringsStart + stringBytes > length) {
+            return false;
+        }
+        records_ = bytes + FILE_LIST_HEADER_BYTES;
+        strings_ = std::string_view(reinterpret_cast<const char*>(bytes + stringsStart), stringBytes);
+        for (uint64_t i = 0; i < count; i++) {
+            const uint8_t* record = records_ + i * FILE_LIST_RECORD_BYTES;
+            if (!InTable(Get32(record), Get32(record + 4)) || !InTable(Get32(record + 8), Get32(record + 12)) ||
+                !InTable(Get32(record + 16), Get16(record + 20))) {
+                return false;
+            }
+        }
+        count_ = static_cast<size_t>(count);
+        return true;
+    }
+
+    size_t Count() const { return count_; }
+
+    FileListEntry Entry(size_t index) const {
+        const uint8_t* record = records_ + index * FILE_LIST_RECORD_BYTES;
+        FileListEntry entry;
+        entry.path = strings_.substr(Get32(record), Get32(record + 4));
+        entry.name = strings_.substr(Get32(record + 8), Get32(record + 12));
+        entry.extension = strings_.substr(Get32(record + 16), Get16(record + 20));
+        entry.flags = Get16(record + 22);
+        uint64_t bits = Get32(record + 24) | (static_cast<uint64_t>(Get32(record + 28)) << 32);
+        std::memcpy(&entry.size, &bits, sizeof(bits));
+        return entry;
+    }
+
+private:
+    bool InTable(uint64_t offset, uint64_t length) const { return offset + length <= strings_.size(); }
+
+    static uint16_t Get16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    static uint32_t Get32(const uint8_t* p) { return Get16(p) | (static_cast<uint32_t>(Get16(p + 2)) << 16); }
+
+    const uint8_t* records_ = nullptr;
+    std::string_view strings_;
+    size_t count_ = 0;
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_FILE_LIST_PAYLOAD_H
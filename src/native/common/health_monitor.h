@@ -6,6 +6,8 @@
 #include <vector>
 #include <map>
 
+#include "process_memory.h"
+
 class HealthMonitor {
 public:
     enum class HealthStatus {
@@ -272,9 +274,8 @@ private:
     }
 
     size_t getMemoryUsage() const {
-        // Simplified memory usage - would need platform-specific implementation
-        // For macOS: task_info() would give actual memory
-        return 50;  // Placeholder
+        // Resident size of the whole process, V8 heap included
+        return static_cast<size_t>(FileCataloger::SampleProcessMemory().residentBytes / (1024 * 1024));
     }
 
     static uint64_t getCurrentTimeMs() {
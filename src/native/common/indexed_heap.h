@@ -0,0 +1,218 @@
+/**
+ * @file indexed_heap.h
+ * @brief Binary min-heap of keyed entries whose ranks can change in place
+ *
+ * Per-item background work (thumbnails, metadata, hashes) is keyed by the
+ * item, and its urgency changes as the user scrolls. IndexedHeap keeps one
+ * entry per key and a key -> slot index, so an entry can be found,
+ * re-ranked or removed in O(log n) without cancelling and re-queueing it.
+ * A bulk change of many ranks updates them in place and rebuilds the heap
+ * once, in O(n).
+ *
+ * Lower ranks pop first. Callers usually put a priority band in the high
+ * bits and a sequence number in the low bits (MakeRank), so entries of one
+ * band pop in the order they were ranked.
+ *
+ * Not thread-safe; owners hold their own lock.
+ */
+
+#ifndef NATIVE_COMMON_INDEXED_HEAP_H
+#define NATIVE_COMMON_INDEXED_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace FileCataloger {
+
+// Band in the top 24 bits, sequence in the low 40 (a trillion rankings)
+inline uint64_t MakeRank(uint32_t band, uint64_t sequence) {
+    return (static_cast<uint64_t>(band) << 40) | (sequence & ((1ull << 40) - 1));
+}
+
+inline uint32_t RankBand(uint64_t rank) {
+    return static_cast<uint32_t>(rank >> 40);
+}
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class IndexedHeap {
+public:
+    struct Entry {
+        Key key;
+        Value value;
+        uint64_t rank;
+    };
+
+    size_t Size() const { return heap_.size(); }
+    bool Empty() const { return heap_.empty(); }
+
+    bool Contains(const Key& key) const { return index_.count(key) != 0; }
+
+    Value* Find(const Key& key) {
+        auto it = index_.find(key);
+        return it == index_.end() ? nullptr : &heap_[it->second].value;
+    }
+
+    // Rank of a queued key; false when absent
+    bool RankOf(const Key& key, uint64_t* rank) const {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        *rank = heap_[it->second].rank;
+        return true;
+    }
+
+    // Adds a key that is not queued yet; false (and nothing changes) if it is
+    bool Push(Key key, Value value, uint64_t rank) {
+        if (index_.count(key) != 0) {
+            return false;
+        }
+        size_t slot = heap_.size();
+        index_.emplace(key, slot);
+        heap_.push_back(Entry{std::move(key), std::move(value), rank});
+        SiftUp(slot);
+        return true;
+    }
+
+    // Moves a queued key to a new rank; false when absent
+    bool Update(const Key& key, uint64_t rank) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        size_t slot = it->second;
+        uint64_t old = heap_[slot].rank;
+        heap_[slot].rank = rank;
+        if (rank < old) {
+            SiftUp(slot);
+        } else if (rank > old) {
+            SiftDown(slot);
+        }
+        return true;
+    }
+
+    // Calls rerank(key, value, rank&) for every entry, then restores the heap
+    // once. For bulk changes that touch a large share of the entries.
+    template<typename Rerank>
+    void RerankAll(Rerank&& rerank) {
+        for (Entry& entry : heap_) {
+            rerank(entry.key, entry.value, entry.rank);
+        }
+        if (heap_.size() < 2) {
+            return;
+        }
+        for (size_t slot = heap_.size() / 2; slot-- > 0;) {
+            SiftDown(slot);
+        }
+    }
+
+    const Entry& Top() const { return heap_.front(); }
+
+    Entry Pop() {
+        return RemoveAt(0);
+    }
+
+    // Removes a key; false when absent. The value is moved into *removed if given.
+    bool Erase(const Key& key, Entry* removed = nullptr) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        Entry entry = RemoveAt(it->second);
+        if (removed) {
+            *removed = std::move(entry);
+        }
+        return true;
+    }
+
+    // Oldest entry of the least urgent band, or nullptr when empty. O(n);
+    // for picking a victim when a bounded queue overflows.
+    const Entry* OldestOfLastBand() const {
+        const Entry* victim = nullptr;
+        for (const Entry& entry : heap_) {
+            if (!victim || RankBand(entry.rank) > RankBand(victim->rank) ||
+                (RankBand(entry.rank) == RankBand(victim->rank) && entry.rank < victim->rank)) {
+                victim = &entry;
+            }
+        }
+        return victim;
+    }
+
+    template<typename Visit>
+    void ForEach(Visit&& visit) const {
+        for (const Entry& entry : heap_) {
+            visit(entry.key, entry.value, entry.rank);
+        }
+    }
+
+    void Clear() {
+        heap_.clear();
+        index_.clear();
+    }
+
+private:
+    Entry RemoveAt(size_t slot) {
+        Entry entry = std::move(heap_[slot]);
+        index_.erase(entry.key);
+        size_t last = heap_.size() - 1;
+        if (slot != last) {
+            heap_[slot] = std::move(heap_[last]);
+            heap_.pop_back();
+            index_[heap_[slot].key] = slot;
+            SiftDown(slot);
+            SiftUp(slot);
+        } else {
+            heap_.pop_back();
+        }
+        return entry;
+    }
+
+    void SiftUp(size_t slot) {
+        Entry entry = std::move(heap_[slot]);
+        while (slot > 0) {
+            size_t parent = (slot - 1) / 2;
+            if (heap_[parent].rank <= entry.rank) {
+                break;
+            }
+            Place(slot, std::move(heap_[parent]));
+            slot = parent;
+        }
+        Place(slot, std::move(entry));
+    }
+
+    void SiftDown(size_t slot) {
+        const size_t count = heap_.size();
+        Entry entry = std::move(heap_[slot]);
+        for (;;) {
+            size_t child = 2 * slot + 1;
+            if (child >= count) {
+                break;
+            }
+            if (child + 1 < count && heap_[child + 1].rank < heap_[child].rank) {
+                child++;
+            }
+            if (entry.rank <= heap_[child].rank) {
+                break;
+            }
+            Place(slot, std::move(heap_[child]));
+            slot = child;
+        }
+        Place(slot, std::move(entry));
+    }
+
+    void Place(size_t slot, Entry&& entry) {
+        heap_[slot] = std::move(entry);
+        index_[heap_[slot].key] = slot;
+    }
+
+    std::vector<Entry> heap_;
+    std::unordered_map<Key, size_t, Hash> index_;
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_INDEXED_HEAP_H
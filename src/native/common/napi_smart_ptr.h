@@ -4,14 +4,30 @@
  *
  * This header provides utilities to safely manage memory when passing
  * data through N-API threadsafe functions while maintaining RAII principles.
+ *
+ * For high-frequency event streams prefer BatchedDispatcher<T>, which
+ * coalesces items from any thread into one JS invocation per drain instead
+ * of paying one uv wake-up and one JS call per item.
  */
 
 #ifndef NATIVE_COMMON_NAPI_SMART_PTR_H
 #define NATIVE_COMMON_NAPI_SMART_PTR_H
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <node_api.h>
 
+#include "alloc_accounting.h"
+#include "sampling_profiler.h"
+
 namespace FileCataloger {
 
 /**
@@ -80,6 +96,323 @@ private:
     std::unique_ptr<T> data_;
 };
 
+/**
+ * The module's AllocAccounting counters as
+ * { eventQueue: { liveBytes, peakBytes, allocations, bytesAllocated }, ... }
+ */
+inline napi_value CreateAllocationStats(napi_env env) {
+    napi_value result;
+    napi_create_object(env, &result);
+    for (size_t i = 0; i < static_cast<size_t>(AllocTag::Count); i++) {
+        AllocTag tag = static_cast<AllocTag>(i);
+        AllocTagStats stats = AllocAccounting::Read(tag);
+
+        napi_value entry, live, peak, allocations, bytes;
+        napi_create_object(env, &entry);
+        napi_create_double(env, static_cast<double>(stats.liveBytes), &live);
+        napi_create_double(env, static_cast<double>(stats.peakBytes), &peak);
+        napi_create_double(env, static_cast<double>(stats.allocations), &allocations);
+        napi_create_double(env, static_cast<double>(stats.bytesAllocated), &bytes);
+        napi_set_named_property(env, entry, "liveBytes", live);
+        napi_set_named_property(env, entry, "peakBytes", peak);
+        napi_set_named_property(env, entry, "allocations", allocations);
+        napi_set_named_property(env, entry, "bytesAllocated", bytes);
+        napi_set_named_property(env, result, AllocTagName(tag), entry);
+    }
+    return result;
+}
+
+/**
+ * Batched, two-lane dispatcher for delivering native items to JS
+ *
+ * Producers on any thread push items into one of two lock-free lanes. Items
+ * are drained on the JS thread by a single threadsafe-function call, so a
+ * burst of events costs one uv wake-up and one drain instead of one per item.
+ *
+ * - High priority (state transitions) schedules a drain immediately and is
+ *   always handed to the drain handler before low-priority items.
+ * - Low priority (bulk data) waits at most Options::maxLatency, or until
+ *   Options::maxBatchSize items are pending, before a drain is scheduled.
+ *
+ * Start() must be called on the JS thread. Stop() may be called from any
+ * thread, so a producer thread whose setup failed can release the
+ * dispatcher itself. Neither may race with Push(): owners start the
+ * dispatcher before their producer threads and stop it after joining them,
+ * or from the last producer once it has stopped pushing.
+ */
+template<typename T>
+class BatchedDispatcher {
+public:
+    enum class Priority { High = 0, Low = 1 };
+
+    struct Options {
+        std::chrono::milliseconds maxLatency{16};  // ~60fps
+        size_t maxBatchSize{64};
+    };
+
+    // Called on the JS thread with each lane's items in FIFO order.
+    // js_callback is the function passed to Start() and may be nullptr.
+    using DrainHandler = std::function<void(napi_env env,
+                                            napi_value js_callback,
+                                            std::vector<T>& high,
+                                            std::vector<T>& low)>;
+
+    explicit BatchedDispatcher(DrainHandler handler, Options options = Options())
+        : handler_(std::move(handler)), options_(options) {}
+
+    ~BatchedDispatcher() {
+        Stop();
+    }
+
+    BatchedDispatcher(const BatchedDispatcher&) = delete;
+    BatchedDispatcher& operator=(const BatchedDispatcher&) = delete;
+
+    napi_status Start(napi_env env, napi_value js_callback, const char* resource_name) {
+        std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+        if (tsfn_) {
+            return napi_ok;
+        }
+
+        napi_value async_resource_name;
+        napi_status status = napi_create_string_utf8(env, resource_name, NAPI_AUTO_LENGTH,
+                                                     &async_resource_name);
+        if (status != napi_ok) {
+            return status;
+        }
+
+        // Shared state outlives this object until the threadsafe function is
+        // finalized, since drains already queued may still run after Stop()
+        shared_ = std::make_shared<Shared>(handler_, options_);
+        auto* holder = new std::shared_ptr<Shared>(shared_);
+
+        status = napi_create_threadsafe_function(
+            env,
+            js_callback,
+            nullptr,
+            async_resource_name,
+            0,
+            1,
+            holder,
+            FinalizeShared,
+            shared_.get(),
+            CallJsDrain,
+            &tsfn_
+        );
+
+        if (status != napi_ok) {
+            delete holder;
+            shared_.reset();
+            tsfn_ = nullptr;
+            return status;
+        }
+
+        shared_->tsfn = tsfn_;
+        flusher_ = std::thread([shared = shared_] { RunFlusher(shared); });
+        return napi_ok;
+    }
+
+    // Any thread; napi_release_threadsafe_function is thread-safe
+    void Stop() {
+        std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+        if (!tsfn_) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(shared_->flush_mutex);
+            shared_->closed.store(true, std::memory_order_release);
+        }
+        shared_->flush_cv.notify_all();
+
+        if (flusher_.joinable()) {
+            flusher_.join();
+        }
+
+        // Pending items are freed with the shared state
+        napi_release_threadsafe_function(tsfn_, napi_tsfn_release);
+        tsfn_ = nullptr;
+    }
+
+    // Safe to call from any thread; returns false if the dispatcher is stopped
+    bool Push(T item, Priority priority = Priority::Low) {
+        Shared* shared = shared_.get();
+        if (!shared || shared->closed.load(std::memory_order_acquire)) {
+            items_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Lane& lane = shared->lanes[static_cast<int>(priority)];
+        Node* node = new Node{std::move(item), nullptr};
+        AllocAccounting::Charge(AllocTag::EventQueue, sizeof(Node));
+        Node* head = lane.head.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!lane.head.compare_exchange_weak(head, node,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed));
+
+        int64_t pending = lane.size.fetch_add(1, std::memory_order_relaxed) + 1;
+        shared->items_queued.fetch_add(1, std::memory_order_relaxed);
+
+        if (priority == Priority::High ||
+            pending >= static_cast<int64_t>(shared->options.maxBatchSize)) {
+            ScheduleDrain(shared);
+        } else if (head == nullptr) {
+            // First low-priority item of a batch arms the latency deadline.
+            // This is the only lock on the push path and is taken once per batch.
+            std::lock_guard<std::mutex> lock(shared->flush_mutex);
+            if (!shared->flush_armed) {
+                shared->flush_deadline = std::chrono::steady_clock::now() + shared->options.maxLatency;
+                shared->flush_armed = true;
+                shared->flush_cv.notify_one();
+            }
+        }
+
+        return true;
+    }
+
+    // Whether a started dispatcher keeps the event loop alive (the default).
+    // Owners that only expect items while work is pending unref it when idle.
+    // JS thread only.
+    napi_status SetKeepsLoopAlive(napi_env env, bool keep_alive) {
+        std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+        if (!tsfn_) {
+            return napi_ok;
+        }
+        return keep_alive ? napi_ref_threadsafe_function(env, tsfn_)
+                          : napi_unref_threadsafe_function(env, tsfn_);
+    }
+
+    uint64_t GetItemsQueued() const {
+        return shared_ ? shared_->items_queued.load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t GetBatchesDelivered() const {
+        return shared_ ? shared_->batches_delivered.load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t GetItemsDropped() const {
+        return items_dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    // Treiber stack; the consumer takes the whole list at once, so there is no ABA
+    struct Lane {
+        std::atomic<Node*> head{nullptr};
+        std::atomic<int64_t> size{0};
+
+        ~Lane() {
+            Node* node = head.load(std::memory_order_acquire);
+            while (node) {
+                Node* next = node->next;
+                delete node;
+                AllocAccounting::Credit(AllocTag::EventQueue, sizeof(Node));
+                node = next;
+            }
+        }
+
+        std::vector<T> TakeAll() {
+            Node* node = head.exchange(nullptr, std::memory_order_acquire);
+            std::vector<T> items;
+            while (node) {
+                Node* next = node->next;
+                items.push_back(std::move(node->value));
+                delete node;
+                node = next;
+            }
+            size.fetch_sub(static_cast<int64_t>(items.size()), std::memory_order_relaxed);
+            AllocAccounting::Credit(AllocTag::EventQueue, items.size() * sizeof(Node));
+            // The stack yields newest first; restore arrival order
+            std::reverse(items.begin(), items.end());
+            return items;
+        }
+    };
+
+    struct Shared {
+        Shared(DrainHandler h, Options o) : handler(std::move(h)), options(o) {}
+
+        DrainHandler handler;
+        Options options;
+        napi_threadsafe_function tsfn = nullptr;
+        Lane lanes[2];
+
+        std::atomic<bool> closed{false};
+        std::atomic<bool> drain_scheduled{false};
+        std::atomic<uint64_t> items_queued{0};
+        std::atomic<uint64_t> batches_delivered{0};
+
+        std::mutex flush_mutex;
+        std::condition_variable flush_cv;
+        std::chrono::steady_clock::time_point flush_deadline;
+        bool flush_armed = false;
+    };
+
+    static void ScheduleDrain(Shared* shared) {
+        if (shared->drain_scheduled.exchange(true, std::memory_order_acq_rel)) {
+            return;  // A drain is already queued and will pick this item up
+        }
+        if (napi_call_threadsafe_function(shared->tsfn, nullptr, napi_tsfn_nonblocking) != napi_ok) {
+            shared->drain_scheduled.store(false, std::memory_order_release);
+        }
+    }
+
+    static void RunFlusher(std::shared_ptr<Shared> shared) {
+        ProfiledThread profiled("batch");
+        std::unique_lock<std::mutex> lock(shared->flush_mutex);
+        while (!shared->closed.load(std::memory_order_acquire)) {
+            if (!shared->flush_armed) {
+                shared->flush_cv.wait(lock);
+                continue;
+            }
+            if (shared->flush_cv.wait_until(lock, shared->flush_deadline) == std::cv_status::timeout) {
+                shared->flush_armed = false;
+                lock.unlock();
+                ScheduleDrain(shared.get());
+                lock.lock();
+            }
+        }
+    }
+
+    static void CallJsDrain(napi_env env, napi_value js_callback, void* context, void* /*data*/) {
+        Shared* shared = static_cast<Shared*>(context);
+
+        // Clear before taking so items pushed during the drain schedule a new one
+        shared->drain_scheduled.store(false, std::memory_order_release);
+
+        std::vector<T> high = shared->lanes[static_cast<int>(Priority::High)].TakeAll();
+        std::vector<T> low = shared->lanes[static_cast<int>(Priority::Low)].TakeAll();
+
+        // env is null while the threadsafe function is being torn down
+        if (!env || shared->closed.load(std::memory_order_acquire) || (high.empty() && low.empty())) {
+            return;
+        }
+
+        shared->batches_delivered.fetch_add(1, std::memory_order_relaxed);
+        size_t payload_bytes = (high.capacity() + low.capacity()) * sizeof(T);
+        AllocAccounting::Charge(AllocTag::NapiPayload, payload_bytes);
+        shared->handler(env, js_callback, high, low);
+        AllocAccounting::Credit(AllocTag::NapiPayload, payload_bytes);
+    }
+
+    static void FinalizeShared(napi_env /*env*/, void* finalize_data, void* /*hint*/) {
+        delete static_cast<std::shared_ptr<Shared>*>(finalize_data);
+    }
+
+    DrainHandler handler_;
+    Options options_;
+    std::shared_ptr<Shared> shared_;
+    // Guards tsfn_ and flusher_, as Stop() can come from another thread
+    std::mutex lifecycle_mutex_;
+    napi_threadsafe_function tsfn_ = nullptr;
+    std::thread flusher_;
+    std::atomic<uint64_t> items_dropped_{0};
+};
+
 } // namespace FileCataloger
 
 #endif // NATIVE_COMMON_NAPI_SMART_PTR_H
\ No newline at end of file
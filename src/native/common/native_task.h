@@ -0,0 +1,396 @@
+/**
+ * @file native_task.h
+ * @brief C++20 coroutines for native async jobs on the WorkStealingPool
+ *
+ * Async native operations are written as straight-line coroutines instead of
+ * chains of pool tasks and completion callbacks:
+ *
+ *   Task<std::vector<uint8_t>> StatChunk(WorkStealingPool& pool, Paths paths) {
+ *       co_await ResumeOn(pool);                      // off the JS thread
+ *       auto batch = co_await Completion<Batch>([&](auto complete) {
+ *           StatFileList(pool, MakeBatch(paths), complete);
+ *       });
+ *       co_return std::move(batch->payload);
+ *   }
+ *
+ * - Task<T> is lazy: it starts when awaited, or when handed to Spawn(), and
+ *   resumes its awaiter on whatever thread it finishes. Exceptions propagate
+ *   to the awaiter.
+ * - ResumeOn(pool) continues the coroutine on a pool worker.
+ * - Completion<T> awaits an existing callback-style operation; the callback
+ *   must be called exactly once, on any thread, possibly before the start
+ *   function returns.
+ * - AsyncGenerator<T> produces a stream with co_yield. The consumer pulls one
+ *   value at a time with Next(), so a producer never runs ahead of it.
+ *
+ * promise_task.h bridges Task<T> to a JS Promise and AsyncGenerator<T> to a
+ * JS async iterator. The pool must outlive every coroutine scheduled on it.
+ */
+
+#ifndef NATIVE_COMMON_NATIVE_TASK_H
+#define NATIVE_COMMON_NATIVE_TASK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+template<typename T = void>
+class Task;
+
+namespace task_detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    // Hands control straight to the awaiter without growing the stack
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().continuation;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+// Fire-and-forget driver for Spawn(); frees itself when done
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace task_detail
+
+/**
+ * Outcome of a spawned task: a value, or the exception it threw
+ */
+template<typename T>
+struct TaskResult {
+    std::optional<T> value;
+    std::exception_ptr error;
+};
+
+template<>
+struct TaskResult<void> {
+    std::exception_ptr error;
+};
+
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    struct promise_type : task_detail::PromiseBase {
+        std::optional<T> value;
+
+        Task get_return_object() noexcept {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        template<typename U>
+        void return_value(U&& result) {
+            value.emplace(std::forward<U>(result));
+        }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~Task() { Reset(); }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() {
+        promise_type& promise = handle_.promise();
+        if (promise.error) {
+            std::rethrow_exception(promise.error);
+        }
+        return std::move(*promise.value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void Reset() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template<>
+class [[nodiscard]] Task<void> {
+public:
+    struct promise_type : task_detail::PromiseBase {
+        Task get_return_object() noexcept {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        void return_void() const noexcept {}
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~Task() { Reset(); }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    void await_resume() {
+        if (handle_.promise().error) {
+            std::rethrow_exception(handle_.promise().error);
+        }
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void Reset() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * co_await ResumeOn(pool) continues on a pool worker
+ */
+class ResumeOn {
+public:
+    explicit ResumeOn(WorkStealingPool& pool) : pool_(pool) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+        pool_.Submit([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+
+private:
+    WorkStealingPool& pool_;
+};
+
+/**
+ * Awaits a callback-style operation. start receives the completion function
+ * and must arrange for it to be called exactly once with the result.
+ */
+template<typename T>
+class Completion {
+public:
+    using Complete = std::function<void(T)>;
+
+    explicit Completion(std::function<void(Complete)> start) : start_(std::move(start)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        handle_ = handle;
+        start_([this](T result) {
+            value_.emplace(std::move(result));
+            if (state_.exchange(kDone, std::memory_order_acq_rel) == kSuspended) {
+                handle_.resume();
+            }
+        });
+        // Completed inline: carry on without suspending
+        return state_.exchange(kSuspended, std::memory_order_acq_rel) != kDone;
+    }
+
+    T await_resume() { return std::move(*value_); }
+
+private:
+    static constexpr int kStarting = 0;
+    static constexpr int kSuspended = 1;
+    static constexpr int kDone = 2;
+
+    std::function<void(Complete)> start_;
+    std::coroutine_handle<> handle_;
+    std::optional<T> value_;
+    std::atomic<int> state_{kStarting};
+};
+
+/**
+ * Streams values from a coroutine that co_yields them. Next() resumes the
+ * producer on a pool worker and calls back, on the producer's thread, with
+ * the next value, or with nullopt once the coroutine returns (error is set
+ * if it threw). One Next() may be outstanding at a time, and the generator
+ * may only be destroyed while none is: the frame is then suspended at a
+ * co_yield, or finished, and its locals are destroyed with it.
+ */
+template<typename T>
+class [[nodiscard]] AsyncGenerator {
+public:
+    using Callback = std::function<void(std::optional<T> value, std::exception_ptr error)>;
+
+    struct promise_type {
+        std::optional<T> current;
+        std::exception_ptr error;
+        Callback consumer;
+
+        // Suspends, then hands the value over; the frame is not touched after
+        struct Deliver {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                promise_type& promise = handle.promise();
+                Callback consumer = std::move(promise.consumer);
+                std::optional<T> value = std::exchange(promise.current, std::nullopt);
+                std::exception_ptr error = promise.error;
+                consumer(std::move(value), error);
+            }
+            void await_resume() const noexcept {}
+        };
+
+        AsyncGenerator get_return_object() noexcept {
+            return AsyncGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        Deliver final_suspend() const noexcept { return {}; }
+        template<typename U>
+        Deliver yield_value(U&& value) {
+            current.emplace(std::forward<U>(value));
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    AsyncGenerator(AsyncGenerator&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~AsyncGenerator() { Reset(); }
+
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+    bool Done() const { return !handle_ || handle_.done(); }
+
+    void Next(WorkStealingPool& pool, Callback callback) {
+        if (Done()) {
+            callback(std::nullopt, nullptr);
+            return;
+        }
+        handle_.promise().consumer = std::move(callback);
+        pool.Submit([handle = handle_] { handle.resume(); });
+    }
+
+private:
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void Reset() {
+        if (handle_) {
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace task_detail {
+
+template<typename T, typename Done>
+Detached Drive(Task<T> task, Done done) {
+    TaskResult<T> result;
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+        } else {
+            result.value.emplace(co_await std::move(task));
+        }
+    } catch (...) {
+        result.error = std::current_exception();
+    }
+    done(std::move(result));
+}
+
+template<typename T>
+Task<T> StartOn(WorkStealingPool& pool, Task<T> task) {
+    co_await ResumeOn(pool);
+    co_return co_await std::move(task);
+}
+
+} // namespace task_detail
+
+/**
+ * Runs task on the pool; done(TaskResult<T>) is called once, on the thread
+ * the task finishes on
+ */
+template<typename T, typename Done>
+void Spawn(WorkStealingPool& pool, Task<T> task, Done done) {
+    task_detail::Drive(task_detail::StartOn(pool, std::move(task)), std::move(done));
+}
+
+/**
+ * Runs task on the pool and blocks the calling thread until it finishes.
+ * For tests and tools; never call it on the JS thread or a pool worker.
+ */
+template<typename T>
+T BlockOn(WorkStealingPool& pool, Task<T> task) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::optional<TaskResult<T>> outcome;
+    Spawn(pool, std::move(task), [&](TaskResult<T> result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        outcome.emplace(std::move(result));
+        cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return outcome.has_value(); });
+    if (outcome->error) {
+        std::rethrow_exception(outcome->error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*outcome->value);
+    }
+}
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_NATIVE_TASK_H
@@ -0,0 +1,103 @@
+/**
+ * @file process_memory.h
+ * @brief Resident size and allocator statistics of the current process
+ *
+ * SampleProcessMemory() reads what the OS and the allocator report right
+ * now. It is cheap enough to call once a second (one small /proc read on
+ * Linux, one task_info call on macOS) and is safe from any thread.
+ *
+ *   residentBytes   pages resident in RAM: /proc/self/statm on Linux,
+ *                   phys_footprint on macOS (what Activity Monitor shows),
+ *                   the working set on Windows
+ *   peakBytes       high-water mark of the above
+ *   heapInUseBytes  bytes handed out by malloc and not yet freed:
+ *                   mallinfo2 on glibc, the default zones on macOS
+ *   heapMappedBytes memory malloc holds from the OS, in use or not
+ *
+ * Heap figures are 0 where the allocator does not report them (Windows,
+ * non-glibc Linux). Resident size includes V8's heap in an Electron
+ * process; the heap figures count native allocations only.
+ */
+
+#ifndef NATIVE_COMMON_PROCESS_MEMORY_H
+#define NATIVE_COMMON_PROCESS_MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <cstdio>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace FileCataloger {
+
+struct ProcessMemorySample {
+    uint64_t residentBytes = 0;
+    uint64_t peakBytes = 0;
+    uint64_t heapInUseBytes = 0;
+    uint64_t heapMappedBytes = 0;
+};
+
+inline ProcessMemorySample SampleProcessMemory() {
+    ProcessMemorySample sample;
+
+#if defined(__linux__)
+    // statm: size resident shared text lib data dt, in pages
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        unsigned long long size = 0;
+        unsigned long long resident = 0;
+        if (std::fscanf(statm, "%llu %llu", &size, &resident) == 2) {
+            sample.residentBytes = resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        }
+        std::fclose(statm);
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        sample.peakBytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // KB on Linux
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    // Large blocks are mmapped one by one and counted separately
+    sample.heapInUseBytes = info.uordblks + info.hblkhd;
+    sample.heapMappedBytes = info.arena + info.hblkhd;
+#endif
+
+#elif defined(__APPLE__)
+    task_vm_info_data_t info = {};  // older kernels fill fewer fields
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+        KERN_SUCCESS) {
+        sample.residentBytes = info.phys_footprint;
+        sample.peakBytes = info.ledger_phys_footprint_peak;
+    }
+    malloc_statistics_t stats;
+    malloc_zone_statistics(nullptr, &stats);  // all zones
+    sample.heapInUseBytes = stats.size_in_use;
+    sample.heapMappedBytes = stats.size_allocated;
+
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        sample.residentBytes = counters.WorkingSetSize;
+        sample.peakBytes = counters.PeakWorkingSetSize;
+    }
+#endif
+
+    if (sample.peakBytes < sample.residentBytes) {
+        sample.peakBytes = sample.residentBytes;
+    }
+    return sample;
+}
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_PROCESS_MEMORY_H
@@ -0,0 +1,142 @@
+/**
+ * @file profile_request.h
+ * @brief startProfiling() for native modules on top of SamplingProfiler
+ *
+ * StartProfiling() reads { durationMs, hz, outputPath } from JS, starts the
+ * module's SamplingProfiler and returns a promise. The profiler's thread
+ * settles it once the folded stacks are written: resolved with
+ * { outputPath, samples, dropped, threads, stacks }, or rejected with an
+ * Error when the profile could not start or the file could not be written.
+ */
+
+#ifndef NATIVE_COMMON_PROFILE_REQUEST_H
+#define NATIVE_COMMON_PROFILE_REQUEST_H
+
+#include <memory>
+#include <string>
+#include <node_api.h>
+
+#include "sampling_profiler.h"
+
+namespace FileCataloger {
+
+class ProfileRequest {
+public:
+    /**
+     * options is a JS object; missing fields keep ProfileOptions defaults.
+     * Returns nullptr with a pending exception if no promise could be made.
+     */
+    static napi_value StartProfiling(napi_env env, napi_value options) {
+        ProfileOptions profile;
+        if (!ReadOptions(env, options, profile)) {
+            napi_throw_type_error(env, nullptr, "startProfiling expects { durationMs, hz, outputPath }");
+            return nullptr;
+        }
+
+        auto* request = new ProfileRequest();
+        napi_value promise;
+        napi_value resourceName;
+        if (napi_create_promise(env, &request->deferred_, &promise) != napi_ok ||
+            napi_create_string_utf8(env, "NativeProfile", NAPI_AUTO_LENGTH, &resourceName) != napi_ok ||
+            napi_create_threadsafe_function(env, nullptr, nullptr, resourceName, 0, 1, request, Finalize,
+                                            request, CallJs, &request->tsfn_) != napi_ok) {
+            delete request;
+            napi_throw_error(env, nullptr, "Failed to create profile promise");
+            return nullptr;
+        }
+
+        std::string error;
+        bool started = SamplingProfiler::Start(
+            profile, [request](const ProfileResult& result) { request->Complete(result); }, &error);
+        if (!started) {
+            ProfileResult result;
+            result.error = error;
+            request->Complete(result);
+        }
+        return promise;
+    }
+
+private:
+    ProfileRequest() = default;
+
+    static bool ReadOptions(napi_env env, napi_value options, ProfileOptions& profile) {
+        napi_valuetype type;
+        if (napi_typeof(env, options, &type) != napi_ok || type != napi_object) {
+            return false;
+        }
+
+        napi_value value;
+        bool has = false;
+        if (napi_has_named_property(env, options, "durationMs", &has) == napi_ok && has) {
+            double ms = 0;
+            napi_get_named_property(env, options, "durationMs", &value);
+            if (napi_get_value_double(env, value, &ms) != napi_ok) return false;
+            profile.duration = std::chrono::milliseconds(static_cast<int64_t>(ms));
+        }
+        if (napi_has_named_property(env, options, "hz", &has) == napi_ok && has) {
+            int32_t hz = 0;
+            napi_get_named_property(env, options, "hz", &value);
+            if (napi_get_value_int32(env, value, &hz) != napi_ok) return false;
+            profile.hz = hz;
+        }
+
+        napi_get_named_property(env, options, "outputPath", &value);
+        size_t length = 0;
+        if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) return false;
+        profile.outputPath.resize(length);
+        napi_get_value_string_utf8(env, value, &profile.outputPath[0], length + 1, &length);
+        return true;
+    }
+
+    // Any thread, once; the request is freed with the threadsafe function
+    void Complete(const ProfileResult& result) {
+        auto* delivery = new ProfileResult(result);
+        if (napi_call_threadsafe_function(tsfn_, delivery, napi_tsfn_blocking) != napi_ok) {
+            delete delivery;
+        }
+        napi_release_threadsafe_function(tsfn_, napi_tsfn_release);
+    }
+
+    static void SetNumber(napi_env env, napi_value object, const char* name, double number) {
+        napi_value value;
+        napi_create_double(env, number, &value);
+        napi_set_named_property(env, object, name, value);
+    }
+
+    static void Finalize(napi_env, void* data, void*) {
+        delete static_cast<ProfileRequest*>(data);
+    }
+
+    static void CallJs(napi_env env, napi_value, void* context, void* data) {
+        std::unique_ptr<ProfileResult> result(static_cast<ProfileResult*>(data));
+        if (env == nullptr) return;
+
+        napi_deferred deferred = static_cast<ProfileRequest*>(context)->deferred_;
+
+        if (!result->ok) {
+            napi_value message, error;
+            std::string text = "Profiling failed: " + result->error;
+            napi_create_string_utf8(env, text.c_str(), text.size(), &message);
+            napi_create_error(env, nullptr, message, &error);
+            napi_reject_deferred(env, deferred, error);
+            return;
+        }
+
+        napi_value object, path;
+        napi_create_object(env, &object);
+        napi_create_string_utf8(env, result->outputPath.c_str(), result->outputPath.size(), &path);
+        napi_set_named_property(env, object, "outputPath", path);
+        SetNumber(env, object, "samples", static_cast<double>(result->samples));
+        SetNumber(env, object, "dropped", static_cast<double>(result->dropped));
+        SetNumber(env, object, "threads", static_cast<double>(result->threads));
+        SetNumber(env, object, "stacks", static_cast<double>(result->stacks));
+        napi_resolve_deferred(env, deferred, object);
+    }
+
+    napi_deferred deferred_ = nullptr;
+    napi_threadsafe_function tsfn_ = nullptr;
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_PROFILE_REQUEST_H
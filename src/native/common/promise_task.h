@@ -0,0 +1,351 @@
+/**
+ * @file promise_task.h
+ * @brief JS Promises and async iterators on top of native_task.h
+ *
+ * PromiseForTask() runs a Task<T> on the pool and returns a Promise that
+ * settles on the JS thread: resolved with toJs(env, value), or rejected with
+ * an Error carrying the message of the exception the task threw.
+ *
+ * AsyncIteratorForGenerator() returns a JS async iterator over an
+ * AsyncGenerator<T>, usable with for await. Each next() resumes the
+ * producer on the pool for one co_yield, so a consumer that stops pulling
+ * stops the native work, and return() (a break out of for await) destroys
+ * the suspended producer. Calls to next() made while a step runs are queued.
+ *
+ * Each promise and each step uses its own threadsafe function, which keeps
+ * the event loop alive only while native work is pending.
+ */
+
+#ifndef NATIVE_COMMON_PROMISE_TASK_H
+#define NATIVE_COMMON_PROMISE_TASK_H
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <node_api.h>
+
+#include "native_task.h"
+
+namespace FileCataloger {
+
+template<typename T>
+using ToJs = std::function<napi_value(napi_env env, T& value)>;
+
+namespace promise_task_detail {
+
+inline napi_value ErrorFor(napi_env env, const std::exception_ptr& error) {
+    std::string text = "Native task failed";
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        text = e.what();
+    } catch (...) {
+    }
+    napi_value message, result;
+    napi_create_string_utf8(env, text.c_str(), text.size(), &message);
+    napi_create_error(env, nullptr, message, &result);
+    return result;
+}
+
+inline napi_value IteratorResult(napi_env env, napi_value value, bool done) {
+    napi_value result, flag;
+    napi_create_object(env, &result);
+    if (value == nullptr) {
+        napi_get_undefined(env, &value);
+    }
+    napi_get_boolean(env, done, &flag);
+    napi_set_named_property(env, result, "value", value);
+    napi_set_named_property(env, result, "done", flag);
+    return result;
+}
+
+template<typename T>
+struct Settlement {
+    napi_deferred deferred = nullptr;
+    napi_threadsafe_function tsfn = nullptr;
+    ToJs<T> toJs;
+};
+
+template<typename T>
+void FinalizeSettlement(napi_env, void* data, void*) {
+    delete static_cast<Settlement<T>*>(data);
+}
+
+template<typename T>
+void Settle(napi_env env, napi_value, void* context, void* data) {
+    std::unique_ptr<TaskResult<T>> result(static_cast<TaskResult<T>*>(data));
+    if (env == nullptr) {
+        return;  // Released during teardown
+    }
+    auto* settlement = static_cast<Settlement<T>*>(context);
+    if (result->error) {
+        napi_reject_deferred(env, settlement->deferred, ErrorFor(env, result->error));
+        return;
+    }
+    napi_value value = nullptr;
+    if constexpr (std::is_void_v<T>) {
+        napi_get_undefined(env, &value);
+    } else {
+        value = settlement->toJs(env, *result->value);
+    }
+    if (value == nullptr) {
+        // toJs failed and left an exception pending; reject with it instead
+        napi_value exception;
+        napi_get_and_clear_last_exception(env, &exception);
+        napi_reject_deferred(env, settlement->deferred, exception);
+        return;
+    }
+    napi_resolve_deferred(env, settlement->deferred, value);
+}
+
+/**
+ * Iterator state, owned by the JS object and by the step in flight. Every
+ * member is touched on the JS thread only, apart from the generator, which
+ * the pool runs between Next() and the step's settlement.
+ */
+template<typename T>
+class IteratorState : public std::enable_shared_from_this<IteratorState<T>> {
+public:
+    IteratorState(WorkStealingPool& pool, AsyncGenerator<T> generator, ToJs<T> toJs, std::string name)
+        : pool_(pool), generator_(std::move(generator)), toJs_(std::move(toJs)), name_(std::move(name)) {}
+
+    napi_value Next(napi_env env) {
+        napi_deferred deferred;
+        napi_value promise;
+        napi_create_promise(env, &deferred, &promise);
+        if (finished_) {
+            napi_resolve_deferred(env, deferred, IteratorResult(env, nullptr, true));
+            return promise;
+        }
+        waiting_.push_back(deferred);
+        if (!running_) {
+            Step(env);
+        }
+        return promise;
+    }
+
+    napi_value Return(napi_env env) {
+        Finish(env);
+        napi_deferred deferred;
+        napi_value promise;
+        napi_create_promise(env, &deferred, &promise);
+        napi_resolve_deferred(env, deferred, IteratorResult(env, nullptr, true));
+        return promise;
+    }
+
+private:
+    struct StepResult {
+        std::optional<T> value;
+        std::exception_ptr error;
+    };
+
+    void Step(napi_env env) {
+        // The holder keeps the state alive until the step has settled
+        auto* holder = new std::shared_ptr<IteratorState>(this->shared_from_this());
+        napi_value resource_name;
+        napi_threadsafe_function tsfn = nullptr;
+        napi_create_string_utf8(env, name_.c_str(), name_.size(), &resource_name);
+        if (napi_create_threadsafe_function(env, nullptr, nullptr, resource_name, 0, 1, holder, FinalizeHolder,
+                                            holder, Deliver, &tsfn) != napi_ok) {
+            delete holder;
+            RejectAll(env, "Failed to create iterator callback");
+            return;
+        }
+
+        running_ = true;
+        generator_.Next(pool_, [tsfn](std::optional<T> value, std::exception_ptr error) {
+            auto* step = new StepResult{std::move(value), error};
+            if (napi_call_threadsafe_function(tsfn, step, napi_tsfn_blocking) != napi_ok) {
+                delete step;
+            }
+            napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+        });
+    }
+
+    static void FinalizeHolder(napi_env, void* data, void*) {
+        delete static_cast<std::shared_ptr<IteratorState>*>(data);
+    }
+
+    static void Deliver(napi_env env, napi_value, void* context, void* data) {
+        std::unique_ptr<StepResult> step(static_cast<StepResult*>(data));
+        if (env == nullptr) {
+            return;
+        }
+        IteratorState& state = **static_cast<std::shared_ptr<IteratorState>*>(context);
+        state.running_ = false;
+        if (state.waiting_.empty()) {
+            state.Release();
+            return;
+        }
+        napi_deferred deferred = state.waiting_.front();
+        state.waiting_.pop_front();
+
+        if (step->error) {
+            napi_reject_deferred(env, deferred, ErrorFor(env, step->error));
+            state.Finish(env);
+            return;
+        }
+        if (!step->value) {
+            napi_resolve_deferred(env, deferred, IteratorResult(env, nullptr, true));
+            state.Finish(env);
+            return;
+        }
+
+        napi_value value = state.toJs_(env, *step->value);
+        if (value == nullptr) {
+            napi_value exception;
+            napi_get_and_clear_last_exception(env, &exception);
+            napi_reject_deferred(env, deferred, exception);
+            state.Finish(env);
+            return;
+        }
+        napi_resolve_deferred(env, deferred, IteratorResult(env, value, false));
+
+        if (state.finished_) {
+            // return() came while this step ran; the producer is suspended now
+            state.Release();
+        } else if (!state.waiting_.empty()) {
+            state.Step(env);
+        }
+    }
+
+    // Settle queued next() calls as done and free the producer once idle
+    void Finish(napi_env env) {
+        finished_ = true;
+        while (!waiting_.empty() && (!running_ || waiting_.size() > 1)) {
+            napi_resolve_deferred(env, waiting_.back(), IteratorResult(env, nullptr, true));
+            waiting_.pop_back();
+        }
+        if (!running_) {
+            Release();
+        }
+    }
+
+    void RejectAll(napi_env env, const char* text) {
+        napi_value message, error;
+        napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, nullptr, message, &error);
+        while (!waiting_.empty()) {
+            napi_reject_deferred(env, waiting_.front(), error);
+            waiting_.pop_front();
+        }
+        finished_ = true;
+        Release();
+    }
+
+    void Release() {
+        AsyncGenerator<T> done = std::move(generator_);
+    }
+
+    WorkStealingPool& pool_;
+    AsyncGenerator<T> generator_;
+    ToJs<T> toJs_;
+    std::string name_;
+    std::deque<napi_deferred> waiting_;
+    bool running_ = false;
+    bool finished_ = false;
+};
+
+// From this, so a next() detached from its iterator cannot outlive the state
+template<typename T>
+IteratorState<T>* UnwrapIterator(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    void* data = nullptr;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+    if (napi_unwrap(env, this_arg, &data) != napi_ok || data == nullptr) {
+        napi_throw_type_error(env, nullptr, "Not a native async iterator");
+        return nullptr;
+    }
+    return static_cast<std::shared_ptr<IteratorState<T>>*>(data)->get();
+}
+
+} // namespace promise_task_detail
+
+/**
+ * Run task on the pool and return a Promise for its result. Returns nullptr
+ * with a pending exception if no promise could be made.
+ */
+template<typename T>
+napi_value PromiseForTask(napi_env env, WorkStealingPool& pool, Task<T> task, ToJs<T> toJs,
+                          const char* resource_name) {
+    using promise_task_detail::Settlement;
+    auto* settlement = new Settlement<T>();
+    settlement->toJs = std::move(toJs);
+
+    napi_value promise, name;
+    if (napi_create_promise(env, &settlement->deferred, &promise) != napi_ok ||
+        napi_create_string_utf8(env, resource_name, NAPI_AUTO_LENGTH, &name) != napi_ok ||
+        napi_create_threadsafe_function(env, nullptr, nullptr, name, 0, 1, settlement,
+                                        promise_task_detail::FinalizeSettlement<T>, settlement,
+                                        promise_task_detail::Settle<T>, &settlement->tsfn) != napi_ok) {
+        delete settlement;
+        napi_throw_error(env, nullptr, "Failed to create native task promise");
+        return nullptr;
+    }
+
+    napi_threadsafe_function tsfn = settlement->tsfn;
+    Spawn(pool, std::move(task), [tsfn](TaskResult<T> result) {
+        auto* delivery = new TaskResult<T>(std::move(result));
+        if (napi_call_threadsafe_function(tsfn, delivery, napi_tsfn_blocking) != napi_ok) {
+            delete delivery;
+        }
+        napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+    });
+    return promise;
+}
+
+/**
+ * Wrap generator in a JS object with next(), return() and
+ * [Symbol.asyncIterator](). Returns nullptr with a pending exception on
+ * failure.
+ */
+template<typename T>
+napi_value AsyncIteratorForGenerator(napi_env env, WorkStealingPool& pool, AsyncGenerator<T> generator,
+                                     ToJs<T> toJs, const char* resource_name) {
+    using State = promise_task_detail::IteratorState<T>;
+    auto* holder = new std::shared_ptr<State>(
+        std::make_shared<State>(pool, std::move(generator), std::move(toJs), resource_name));
+
+    using promise_task_detail::UnwrapIterator;
+    napi_callback next = [](napi_env env, napi_callback_info info) -> napi_value {
+        State* state = UnwrapIterator<T>(env, info);
+        return state ? state->Next(env) : nullptr;
+    };
+    napi_callback finish = [](napi_env env, napi_callback_info info) -> napi_value {
+        State* state = UnwrapIterator<T>(env, info);
+        return state ? state->Return(env) : nullptr;
+    };
+    napi_callback self = [](napi_env env, napi_callback_info info) -> napi_value {
+        napi_value this_arg;
+        napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+        return this_arg;
+    };
+
+    napi_value iterator, next_fn, return_fn, self_fn, global, symbol, async_iterator;
+    if (napi_create_object(env, &iterator) != napi_ok ||
+        napi_wrap(env, iterator, holder,
+                  [](napi_env, void* data, void*) { delete static_cast<std::shared_ptr<State>*>(data); },
+                  nullptr, nullptr) != napi_ok) {
+        delete holder;
+        napi_throw_error(env, nullptr, "Failed to create native async iterator");
+        return nullptr;
+    }
+    napi_create_function(env, "next", NAPI_AUTO_LENGTH, next, nullptr, &next_fn);
+    napi_create_function(env, "return", NAPI_AUTO_LENGTH, finish, nullptr, &return_fn);
+    napi_create_function(env, "[Symbol.asyncIterator]", NAPI_AUTO_LENGTH, self, nullptr, &self_fn);
+    napi_set_named_property(env, iterator, "next", next_fn);
+    napi_set_named_property(env, iterator, "return", return_fn);
+    napi_get_global(env, &global);
+    napi_get_named_property(env, global, "Symbol", &symbol);
+    napi_get_named_property(env, symbol, "asyncIterator", &async_iterator);
+    napi_set_property(env, iterator, async_iterator, self_fn);
+    return iterator;
+}
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_PROMISE_TASK_H
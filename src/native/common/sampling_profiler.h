@@ -0,0 +1,683 @@
+/**
+ * @file sampling_profiler.h
+ * @brief Opt-in sampling profiler for a module's native threads
+ *
+ * Threads worth profiling (event tap, batch flusher, drag monitor, analysis)
+ * hold a ProfiledThread for their lifetime, which records the thread in a
+ * fixed table and does nothing else. Start() samples those threads' stacks
+ * for a fixed duration, then writes them as folded stacks
+ * ("thread;outer;...;inner count" per line) that flamegraph.pl, speedscope
+ * and similar tools read, and reports the result to a callback.
+ *
+ * - Linux: each thread gets a timer on its own CPU clock (timer_create with
+ *   SIGEV_THREAD_ID), so only running threads are sampled, in proportion to
+ *   their CPU time. The SIGPROF handler walks frame pointers from the
+ *   interrupted context, checked against the thread's stack bounds, into a
+ *   preallocated buffer: no locks, no allocation, no unwinder. Build with
+ *   -fno-omit-frame-pointer for full stacks. CPU timers fire on scheduler
+ *   ticks, so rates above CONFIG_HZ (often 250) are capped there.
+ * - macOS: no per-thread timers exist, so a sampler thread suspends each
+ *   running thread in turn, reads its registers and walks its frames the
+ *   same way. Apple's ABIs keep frame pointers.
+ * - Elsewhere Start() fails with "unsupported".
+ *
+ * While no profile runs there are no timers, no sampler thread and no
+ * sample buffer; the only cost is the table entry per registered thread.
+ * On Linux the SIGPROF handler stays installed after the first profile, so
+ * a signal still in flight when a profile ends cannot hit the default
+ * action; it passes signals that are not its own to the previous handler.
+ *
+ * Frames are symbolized with dladdr after sampling stops. Symbols hidden
+ * from the dynamic table print as "module+0xoffset", which atos or
+ * addr2line resolve offline.
+ *
+ * Each .node has its own copy, so each module profiles its own threads.
+ */
+
+#ifndef NATIVE_COMMON_SAMPLING_PROFILER_H
+#define NATIVE_COMMON_SAMPLING_PROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#endif
+
+#if defined(__linux__)
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#define FILECATALOGER_PROFILER_SIGNALS 1
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#if defined(__has_feature)
+#if __has_feature(ptrauth_calls)
+#include <ptrauth.h>
+#define FILECATALOGER_PROFILER_PTRAUTH 1
+#endif
+#endif
+#define FILECATALOGER_PROFILER_MACH 1
+#endif
+
+namespace FileCataloger {
+
+struct ProfileOptions {
+    std::chrono::milliseconds duration{5000};
+    int hz = 499;             // samples per second of each thread's CPU time
+    std::string outputPath;   // folded stacks are written here
+};
+
+struct ProfileResult {
+    bool ok = false;
+    std::string error;
+    std::string outputPath;
+    uint64_t samples = 0;     // stacks captured
+    uint64_t dropped = 0;     // samples lost to a full buffer
+    size_t threads = 0;       // registered threads while the profile ran
+    size_t stacks = 0;        // distinct folded stacks written
+};
+
+class SamplingProfiler {
+public:
+    static constexpr size_t MAX_THREADS = 32;
+    static constexpr size_t MAX_DEPTH = 48;
+    static constexpr size_t MAX_SAMPLES = 32768;
+    static constexpr auto MAX_DURATION = std::chrono::seconds(60);
+
+    using Completion = std::function<void(const ProfileResult&)>;
+
+    /**
+     * Sample the registered threads for options.duration, then write the
+     * folded stacks and call done on the profiler's thread. Returns false
+     * with *error set if a profile is already running or the platform has
+     * no sampler.
+     */
+    static bool Start(const ProfileOptions& options, Completion done, std::string* error) {
+        State& state = Get();
+        std::lock_guard<std::mutex> lock(state.mutex);
+#if !defined(FILECATALOGER_PROFILER_SIGNALS) && !defined(FILECATALOGER_PROFILER_MACH)
+        (void)options;
+        (void)done;
+        *error = "unsupported";
+        return false;
+#else
+        if (state.running) {
+            *error = "a profile is already running";
+            return false;
+        }
+        if (options.outputPath.empty()) {
+            *error = "outputPath is required";
+            return false;
+        }
+        if (options.hz < 1 || options.hz > 10000 || options.duration.count() <= 0 ||
+            options.duration > MAX_DURATION) {
+            *error = "hz must be 1-10000 and duration 1ms-60s";
+            return false;
+        }
+        if (state.controller.joinable()) {
+            state.controller.join();  // the previous profile's finished thread
+        }
+
+        // Every registered thread at full CPU for the whole duration
+        size_t threads = std::max<size_t>(CountThreads(state), 1);
+        double seconds = std::chrono::duration<double>(options.duration).count();
+        size_t capacity = std::min<size_t>(MAX_SAMPLES,
+                                           static_cast<size_t>(options.hz * seconds * threads) + 64);
+        state.samples.reset(new Sample[capacity]);
+        state.capacity = capacity;
+        state.next.store(0, std::memory_order_relaxed);
+        state.dropped.store(0, std::memory_order_relaxed);
+        state.options = options;
+        state.running = true;
+        state.stopRequested = false;
+
+#if defined(FILECATALOGER_PROFILER_SIGNALS)
+        InstallHandler(state);
+        state.active.store(true, std::memory_order_release);
+        for (Slot& slot : state.slots) {
+            if (slot.used) {
+                ArmTimer(state, slot);
+            }
+        }
+#else
+        state.active.store(true, std::memory_order_release);
+#endif
+        state.controller = std::thread([done = std::move(done)] { RunController(done); });
+        return true;
+#endif
+    }
+
+    // End a running profile early; its result is still written and reported
+    static void Stop() {
+        State& state = Get();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.stopRequested = true;
+        }
+        state.cv.notify_all();
+    }
+
+    static bool IsRunning() {
+        State& state = Get();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.running;
+    }
+
+    // Wait for a profile to finish; for module teardown and tests, never
+    // from a completion callback
+    static void Join() {
+        State& state = Get();
+        std::thread controller;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            controller = std::move(state.controller);
+        }
+        if (controller.joinable()) {
+            controller.join();
+        }
+    }
+
+    // Register the calling thread; returns its slot or -1 when the table is full
+    static int RegisterThread(const char* name) {
+        State& state = Get();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (size_t i = 0; i < MAX_THREADS; i++) {
+            Slot& slot = state.slots[i];
+            if (slot.used) {
+                continue;
+            }
+            slot = Slot();
+            slot.used = true;
+            std::snprintf(slot.name, sizeof(slot.name), "%s", name);
+            RecordThread(slot);
+#if defined(FILECATALOGER_PROFILER_SIGNALS)
+            if (state.active.load(std::memory_order_acquire)) {
+                ArmTimer(state, slot);
+            }
+#endif
+            return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    static void UnregisterThread(int index) {
+        if (index < 0) {
+            return;
+        }
+        State& state = Get();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        Slot& slot = state.slots[index];
+#if defined(FILECATALOGER_PROFILER_SIGNALS)
+        DisarmTimer(slot);
+#endif
+        slot.used = false;
+    }
+
+private:
+    struct Sample {
+        uint16_t slot;
+        uint16_t depth;
+        uintptr_t link;   // return address if the leaf kept no frame; see LeafCaller
+        uintptr_t pcs[MAX_DEPTH];
+    };
+
+    struct Slot {
+        bool used = false;
+        char name[32] = {};
+        uintptr_t stackLow = 0;
+        uintptr_t stackHigh = 0;
+#if defined(FILECATALOGER_PROFILER_SIGNALS)
+        pid_t tid = 0;
+        clockid_t clock = 0;
+        timer_t timer = nullptr;
+        bool armed = false;
+#elif defined(FILECATALOGER_PROFILER_MACH)
+        mach_port_t port = MACH_PORT_NULL;
+#endif
+    };
+
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        Slot slots[MAX_THREADS];
+        bool running = false;
+        bool stopRequested = false;
+        ProfileOptions options;
+        std::thread controller;
+
+        // Written by the sampler (signal handler or sampler thread)
+        std::unique_ptr<Sample[]> samples;
+        size_t capacity = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> active{false};
+
+#if defined(FILECATALOGER_PROFILER_SIGNALS)
+        std::atomic<int> inHandler{0};
+        bool handlerInstalled = false;
+        struct sigaction previous = {};
+#endif
+    };
+
+    static State& Get() {
+        static State state;
+        return state;
+    }
+
+    static size_t CountThreads(const State& state) {
+        size_t count = 0;
+        for (const Slot& slot : state.slots) {
+            count += slot.used;
+        }
+        return count;
+    }
+
+    // Return addresses point past the call; a frame is valid while it moves
+    // up the stack, stays aligned and inside the thread's stack
+    static uint16_t WalkFrames(uintptr_t pc, uintptr_t fp, uintptr_t low, uintptr_t high, uintptr_t* pcs) {
+        uint16_t depth = 0;
+        pcs[depth++] = pc;
+        while (depth < MAX_DEPTH && fp >= low && fp + 2 * sizeof(uintptr_t) <= high &&
+               fp % sizeof(uintptr_t) == 0) {
+            const uintptr_t* frame = reinterpret_cast<const uintptr_t*>(fp);
+            uintptr_t next = frame[0];
+            uintptr_t ret = StripPointer(frame[1]);
+            if (ret == 0) {
+                break;
+            }
+            pcs[depth++] = ret - 1;
+            if (next <= fp) {
+                break;
+            }
+            fp = next;
+        }
+        return depth;
+    }
+
+    // Word at the top of the stack, where a call left the return address
+    static uintptr_t StackWord(uintptr_t sp, uintptr_t low, uintptr_t high) {
+        if (sp < low || sp + sizeof(uintptr_t) > high || sp % sizeof(uintptr_t) != 0) {
+            return 0;
+        }
+        return *reinterpret_cast<const uintptr_t*>(sp);
+    }
+
+    static uintptr_t StripPointer(uintptr_t value) {
+#if defined(FILECATALOGER_PROFILER_PTRAUTH)
+        return reinterpret_cast<uintptr_t>(
+            ptrauth_strip(reinterpret_cast<void*>(value), ptrauth_key_return_address));
+#else
+        return value;
+#endif
+    }
+
+    // Claim a buffer entry; lock-free so the signal handler can call it
+    static Sample* ClaimSample(State& state) {
+        size_t index = state.next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= state.capacity) {
+            state.dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &state.samples[index];
+    }
+
+#if defined(FILECATALOGER_PROFILER_SIGNALS)
+    static void RecordThread(Slot& slot) {
+        slot.tid = static_cast<pid_t>(syscall(SYS_gettid));
+        pthread_getcpuclockid(pthread_self(), &slot.clock);
+        pthread_attr_t attr;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+            void* base = nullptr;
+            size_t size = 0;
+            pthread_attr_getstack(&attr, &base, &size);
+            slot.stackLow = reinterpret_cast<uintptr_t>(base);
+            slot.stackHigh = slot.stackLow + size;
+            pthread_attr_destroy(&attr);
+        }
+    }
+
+    static void InstallHandler(State& state) {
+        if (state.handlerInstalled) {
+            return;
+        }
+        struct sigaction action = {};
+        action.sa_sigaction = HandleSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, &state.previous);
+        state.handlerInstalled = true;
+    }
+
+    static void ArmTimer(State& state, Slot& slot) {
+        sigevent event = {};
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event.sigev_value.sival_ptr = &slot;
+        event._sigev_un._tid = slot.tid;
+        if (timer_create(slot.clock, &event, &slot.timer) != 0) {
+            return;
+        }
+        long interval = 1000000000L / state.options.hz;
+        itimerspec spec = {};
+        spec.it_interval.tv_sec = interval / 1000000000L;
+        spec.it_interval.tv_nsec = interval % 1000000000L;
+        spec.it_value = spec.it_interval;
+        timer_settime(slot.timer, 0, &spec, nullptr);
+        slot.armed = true;
+    }
+
+    static void DisarmTimer(Slot& slot) {
+        if (slot.armed) {
+            timer_delete(slot.timer);
+            slot.armed = false;
+        }
+    }
+
+    // Async-signal-safe: atomics, register reads and stack reads only
+    static void HandleSignal(int signal, siginfo_t* info, void* context) {
+        State& state = Get();
+        Slot* slot = static_cast<Slot*>(info->si_value.sival_ptr);
+        bool ours = info->si_code == SI_TIMER && slot >= state.slots && slot < state.slots + MAX_THREADS;
+        if (!ours) {
+            ForwardSignal(state, signal, info, context);
+            return;
+        }
+
+        int savedErrno = errno;
+        state.inHandler.fetch_add(1, std::memory_order_acquire);
+        if (state.active.load(std::memory_order_acquire)) {
+            if (Sample* sample = ClaimSample(state)) {
+                const mcontext_t& mc = static_cast<ucontext_t*>(context)->uc_mcontext;
+#if defined(__x86_64__)
+                uintptr_t pc = static_cast<uintptr_t>(mc.gregs[REG_RIP]);
+                uintptr_t fp = static_cast<uintptr_t>(mc.gregs[REG_RBP]);
+                uintptr_t link = StackWord(static_cast<uintptr_t>(mc.gregs[REG_RSP]), slot->stackLow,
+                                           slot->stackHigh);
+#elif defined(__aarch64__)
+                uintptr_t pc = static_cast<uintptr_t>(mc.pc);
+                uintptr_t fp = static_cast<uintptr_t>(mc.regs[29]);
+                uintptr_t link = static_cast<uintptr_t>(mc.regs[30]);
+#else
+                uintptr_t pc = 0;
+                uintptr_t fp = 0;
+                uintptr_t link = 0;
+#endif
+                sample->slot = static_cast<uint16_t>(slot - state.slots);
+                sample->link = link;
+                sample->depth = WalkFrames(pc, fp, slot->stackLow, slot->stackHigh, sample->pcs);
+            }
+        }
+        state.inHandler.fetch_sub(1, std::memory_order_release);
+        errno = savedErrno;
+    }
+
+    static void ForwardSignal(State& state, int signal, siginfo_t* info, void* context) {
+        const struct sigaction& previous = state.previous;
+        if (previous.sa_flags & SA_SIGINFO) {
+            if (previous.sa_sigaction) {
+                previous.sa_sigaction(signal, info, context);
+            }
+        } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+            previous.sa_handler(signal);
+        }
+    }
+
+    static void StopSampling(State& state) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.active.store(false, std::memory_order_release);
+        for (Slot& slot : state.slots) {
+            DisarmTimer(slot);
+        }
+        // A handler that saw active before the store finishes its sample
+        while (state.inHandler.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+#elif defined(FILECATALOGER_PROFILER_MACH)
+    static void RecordThread(Slot& slot) {
+        pthread_t self = pthread_self();
+        slot.port = pthread_mach_thread_np(self);
+        slot.stackHigh = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(self));
+        slot.stackLow = slot.stackHigh - pthread_get_stacksize_np(self);
+    }
+
+    // Suspend, read registers, walk, resume; nothing here may allocate
+    // while the target is suspended, since it may hold the malloc lock
+    static void SampleThread(State& state, const Slot& slot, size_t index) {
+        thread_basic_info_data_t basic;
+        mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+        if (thread_info(slot.port, THREAD_BASIC_INFO, reinterpret_cast<thread_info_t>(&basic), &count) !=
+                KERN_SUCCESS ||
+            basic.run_state != TH_STATE_RUNNING) {
+            return;
+        }
+        if (thread_suspend(slot.port) != KERN_SUCCESS) {
+            return;
+        }
+#if defined(__arm64__)
+        arm_thread_state64_t regs;
+        mach_msg_type_number_t regCount = ARM_THREAD_STATE64_COUNT;
+        kern_return_t kr = thread_get_state(slot.port, ARM_THREAD_STATE64,
+                                            reinterpret_cast<thread_state_t>(&regs), &regCount);
+        uintptr_t pc = StripPointer(static_cast<uintptr_t>(arm_thread_state64_get_pc(regs)));
+        uintptr_t fp = static_cast<uintptr_t>(arm_thread_state64_get_fp(regs));
+        uintptr_t link = StripPointer(static_cast<uintptr_t>(arm_thread_state64_get_lr(regs)));
+#else
+        x86_thread_state64_t regs;
+        mach_msg_type_number_t regCount = x86_THREAD_STATE64_COUNT;
+        kern_return_t kr = thread_get_state(slot.port, x86_THREAD_STATE64,
+                                            reinterpret_cast<thread_state_t>(&regs), &regCount);
+        uintptr_t pc = static_cast<uintptr_t>(regs.__rip);
+        uintptr_t fp = static_cast<uintptr_t>(regs.__rbp);
+        uintptr_t link = StackWord(static_cast<uintptr_t>(regs.__rsp), slot.stackLow, slot.stackHigh);
+#endif
+        if (kr == KERN_SUCCESS) {
+            if (Sample* sample = ClaimSample(state)) {
+                sample->slot = static_cast<uint16_t>(index);
+                sample->link = link;
+                sample->depth = WalkFrames(pc, fp, slot.stackLow, slot.stackHigh, sample->pcs);
+            }
+        }
+        thread_resume(slot.port);
+    }
+
+    static void RunSampler(State& state, std::chrono::steady_clock::time_point end) {
+        const auto period = std::chrono::nanoseconds(1000000000L / state.options.hz);
+        const mach_port_t self = mach_thread_self();
+        auto next = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(state.mutex);
+        while (!state.stopRequested && next < end) {
+            for (size_t i = 0; i < MAX_THREADS; i++) {
+                if (state.slots[i].used && state.slots[i].port != self) {
+                    SampleThread(state, state.slots[i], i);
+                }
+            }
+            next += period;
+            state.cv.wait_until(lock, next, [&] { return state.stopRequested; });
+        }
+        mach_port_deallocate(mach_task_self(), self);
+    }
+#endif
+
+#if defined(FILECATALOGER_PROFILER_SIGNALS) || defined(FILECATALOGER_PROFILER_MACH)
+    static void RunController(const Completion& done) {
+        State& state = Get();
+        const auto end = std::chrono::steady_clock::now() + state.options.duration;
+#if defined(FILECATALOGER_PROFILER_SIGNALS)
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.cv.wait_until(lock, end, [&] { return state.stopRequested; });
+        }
+        StopSampling(state);
+#else
+        RunSampler(state, end);
+        state.active.store(false, std::memory_order_release);
+#endif
+
+        ProfileResult result = WriteFolded(state);
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.samples.reset();
+            state.capacity = 0;
+            state.running = false;
+        }
+        if (done) {
+            done(result);
+        }
+    }
+
+    /**
+     * Whether the sampled leaf kept no frame of its own, so the walk skipped
+     * its caller. Compilers drop the frame of functions that call nothing
+     * (GCC even with -mno-omit-leaf-frame-pointer); the caller is then the
+     * return address at the top of the stack (x86-64) or in the link
+     * register (arm64). It counts only if the instruction before it is a
+     * direct call to the leaf's function and the walk does not have it yet.
+     */
+    static bool LeafCaller(const Sample& sample) {
+        if (sample.link == 0 || sample.depth == 0 ||
+            (sample.depth > 1 && sample.pcs[1] == sample.link - 1)) {
+            return false;
+        }
+        Dl_info leaf = {};
+        Dl_info caller = {};
+        if (!dladdr(reinterpret_cast<void*>(sample.pcs[0]), &leaf) || !leaf.dli_saddr ||
+            !dladdr(reinterpret_cast<void*>(sample.link - 1), &caller)) {
+            return false;
+        }
+        uintptr_t target = 0;
+#if defined(__x86_64__)
+        const uint8_t* call = reinterpret_cast<const uint8_t*>(sample.link - 5);
+        if (call[0] != 0xE8) {
+            return false;
+        }
+        int32_t offset;
+        std::memcpy(&offset, call + 1, sizeof(offset));
+        target = sample.link + offset;
+#elif defined(__aarch64__) || defined(__arm64__)
+        uint32_t instruction;
+        std::memcpy(&instruction, reinterpret_cast<const void*>(sample.link - 4), sizeof(instruction));
+        if ((instruction & 0xFC000000u) != 0x94000000u) {  // BL imm26
+            return false;
+        }
+        int64_t offset = static_cast<int64_t>(static_cast<int32_t>(instruction << 6) >> 6) * 4;
+        target = sample.link - 4 + offset;
+#endif
+        return target != 0 && target == reinterpret_cast<uintptr_t>(leaf.dli_saddr);
+    }
+
+    static std::string Symbolize(uintptr_t pc, std::unordered_map<uintptr_t, std::string>& cache) {
+        auto cached = cache.find(pc);
+        if (cached != cache.end()) {
+            return cached->second;
+        }
+        std::string name;
+        Dl_info info = {};
+        bool found = dladdr(reinterpret_cast<void*>(pc), &info) != 0;
+        if (found && info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            name = status == 0 && demangled ? demangled : info.dli_sname;
+            std::free(demangled);
+        } else if (found && info.dli_fname) {
+            const char* base = std::strrchr(info.dli_fname, '/');
+            char offset[32];
+            std::snprintf(offset, sizeof(offset), "+0x%llx",
+                          static_cast<unsigned long long>(pc - reinterpret_cast<uintptr_t>(info.dli_fbase)));
+            name = std::string(base ? base + 1 : info.dli_fname) + offset;
+        } else {
+            char address[32];
+            std::snprintf(address, sizeof(address), "0x%llx", static_cast<unsigned long long>(pc));
+            name = address;
+        }
+        // ';' separates frames in the folded format
+        std::replace(name.begin(), name.end(), ';', ':');
+        cache.emplace(pc, name);
+        return name;
+    }
+
+    static ProfileResult WriteFolded(State& state) {
+        ProfileResult result;
+        result.outputPath = state.options.outputPath;
+        size_t count = std::min(state.next.load(std::memory_order_acquire), state.capacity);
+        result.samples = count;
+        result.dropped = state.dropped.load(std::memory_order_relaxed);
+
+        std::map<std::string, uint64_t> folded;
+        std::unordered_map<uintptr_t, std::string> symbols;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            result.threads = CountThreads(state);
+            for (size_t i = 0; i < count; i++) {
+                const Sample& sample = state.samples[i];
+                std::string stack = state.slots[sample.slot].name;
+                for (size_t depth = sample.depth; depth > 0; depth--) {
+                    stack += ';';
+                    stack += Symbolize(sample.pcs[depth - 1], symbols);
+                    if (depth == 1 && LeafCaller(sample)) {
+                        stack.insert(stack.rfind(';'), ";" + Symbolize(sample.link - 1, symbols));
+                    }
+                }
+                folded[stack]++;
+            }
+        }
+        result.stacks = folded.size();
+
+        FILE* file = std::fopen(state.options.outputPath.c_str(), "w");
+        if (!file) {
+            result.error = "cannot open " + state.options.outputPath;
+            return result;
+        }
+        for (const auto& entry : folded) {
+            std::fprintf(file, "%s %llu\n", entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+        }
+        if (std::fclose(file) != 0) {
+            result.error = "cannot write " + state.options.outputPath;
+            return result;
+        }
+        result.ok = true;
+        return result;
+    }
+#else
+    static void RecordThread(Slot&) {}
+#endif
+};
+
+/**
+ * Registers the constructing thread with the profiler until destroyed
+ */
+class ProfiledThread {
+public:
+    explicit ProfiledThread(const char* name) : slot_(SamplingProfiler::RegisterThread(name)) {}
+    ~ProfiledThread() { SamplingProfiler::UnregisterThread(slot_); }
+
+    ProfiledThread(const ProfiledThread&) = delete;
+    ProfiledThread& operator=(const ProfiledThread&) = delete;
+
+private:
+    int slot_;
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_SAMPLING_PROFILER_H
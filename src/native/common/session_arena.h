@@ -0,0 +1,281 @@
+/**
+ * @file session_arena.h
+ * @brief Monotonic bump arena for short-lived, session-scoped native data
+ *
+ * A SessionArena hands out memory by bumping a pointer inside large chunks
+ * and never frees individual allocations. Everything allocated for a session
+ * (e.g. one drag operation) is released at once when the arena is destroyed.
+ * With an ArenaChunkCache the release is an O(1) splice of the chunk list
+ * into the cache, and the next session reuses those chunks without calling
+ * malloc at all.
+ *
+ * Threading: a SessionArena must be allocated from by one thread at a time.
+ * Memory it has already handed out may be read from any thread, so session
+ * objects are typically owned through std::shared_ptr and released by
+ * whichever thread drops the last reference. ArenaChunkCache is thread-safe.
+ */
+
+#ifndef NATIVE_COMMON_SESSION_ARENA_H
+#define NATIVE_COMMON_SESSION_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "alloc_accounting.h"
+
+namespace FileCataloger {
+
+/**
+ * Thread-safe cache of arena chunks shared by all arenas of a module
+ */
+class ArenaChunkCache {
+public:
+    struct Chunk {
+        Chunk* next;
+        size_t capacity;  // usable bytes following the header
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    explicit ArenaChunkCache(size_t max_cached_bytes = 256 * 1024)
+        : max_cached_bytes_(max_cached_bytes) {}
+
+    ~ArenaChunkCache() {
+        FreeList(free_list_);
+        AllocAccounting::Credit(AllocTag::ArenaCache, cached_bytes_);
+    }
+
+    ArenaChunkCache(const ArenaChunkCache&) = delete;
+    ArenaChunkCache& operator=(const ArenaChunkCache&) = delete;
+
+    // Reuse a cached chunk of at least min_capacity bytes, or allocate one
+    Chunk* Acquire(size_t min_capacity) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Chunk** link = &free_list_;
+            while (*link) {
+                if ((*link)->capacity >= min_capacity) {
+                    Chunk* chunk = *link;
+                    *link = chunk->next;
+                    cached_bytes_ -= chunk->capacity;
+                    AllocAccounting::Credit(AllocTag::ArenaCache, chunk->capacity);
+                    chunk->next = nullptr;
+                    return chunk;
+                }
+                link = &(*link)->next;
+            }
+        }
+        chunks_allocated_.fetch_add(1, std::memory_order_relaxed);
+        return AllocateChunk(min_capacity);
+    }
+
+    // Take back a whole chunk list in O(1); trims only when over budget
+    void Release(Chunk* head, Chunk* tail, size_t total_capacity) {
+        if (!head) {
+            return;
+        }
+
+        Chunk* overflow = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cached_bytes_ + total_capacity <= max_cached_bytes_) {
+                tail->next = free_list_;
+                free_list_ = head;
+                cached_bytes_ += total_capacity;
+                AllocAccounting::Charge(AllocTag::ArenaCache, total_capacity);
+                return;
+            }
+            overflow = head;
+        }
+        FreeList(overflow);
+    }
+
+    static Chunk* AllocateChunk(size_t capacity) {
+        void* memory = std::malloc(sizeof(Chunk) + capacity);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        Chunk* chunk = static_cast<Chunk*>(memory);
+        chunk->next = nullptr;
+        chunk->capacity = capacity;
+        return chunk;
+    }
+
+    static void FreeList(Chunk* chunk) {
+        while (chunk) {
+            Chunk* next = chunk->next;
+            std::free(chunk);
+            chunk = next;
+        }
+    }
+
+    size_t CachedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cached_bytes_;
+    }
+
+    // Chunks that had to come from malloc because none were cached
+    uint64_t ChunksAllocated() const {
+        return chunks_allocated_.load(std::memory_order_relaxed);
+    }
+
+private:
+    mutable std::mutex mutex_;
+    Chunk* free_list_ = nullptr;
+    size_t cached_bytes_ = 0;
+    size_t max_cached_bytes_;
+    std::atomic<uint64_t> chunks_allocated_{0};
+};
+
+/**
+ * Monotonic bump allocator; individual deallocation is a no-op
+ */
+class SessionArena {
+public:
+    static constexpr size_t kDefaultChunkSize = 16 * 1024;
+
+    explicit SessionArena(ArenaChunkCache* cache = nullptr, size_t chunk_size = kDefaultChunkSize)
+        : cache_(cache), chunk_size_(chunk_size) {}
+
+    ~SessionArena() {
+        Release();
+    }
+
+    SessionArena(const SessionArena&) = delete;
+    SessionArena& operator=(const SessionArena&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t aligned = (cursor_ + (alignment - 1)) & ~(static_cast<uintptr_t>(alignment) - 1);
+        if (!head_ || aligned + bytes > limit_) {
+            AddChunk(bytes + alignment);
+            aligned = (cursor_ + (alignment - 1)) & ~(static_cast<uintptr_t>(alignment) - 1);
+        }
+        cursor_ = aligned + bytes;
+        bytes_allocated_ += bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Objects are never destroyed individually, so only trivially
+    // destructible types may be created directly in the arena
+    template<typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "SessionArena never runs destructors");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    T* AllocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "SessionArena never runs destructors");
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Copy a string into the arena; the view stays valid for the arena's lifetime
+    std::string_view CopyString(const char* data, size_t length) {
+        char* copy = static_cast<char*>(Allocate(length + 1, 1));
+        std::memcpy(copy, data, length);
+        copy[length] = '\0';
+        return std::string_view(copy, length);
+    }
+
+    // Drop every allocation at once; chunks go back to the cache if present
+    void Release() {
+        if (!head_) {
+            return;
+        }
+        if (cache_) {
+            cache_->Release(head_, tail_, total_capacity_);
+        } else {
+            ArenaChunkCache::FreeList(head_);
+        }
+        head_ = tail_ = nullptr;
+        cursor_ = limit_ = 0;
+        total_capacity_ = 0;
+        bytes_allocated_ = 0;
+        chunk_count_ = 0;
+    }
+
+    size_t BytesAllocated() const { return bytes_allocated_; }
+    size_t ChunkCount() const { return chunk_count_; }
+
+private:
+    void AddChunk(size_t min_bytes) {
+        size_t capacity = min_bytes > chunk_size_ ? min_bytes : chunk_size_;
+        ArenaChunkCache::Chunk* chunk = cache_ ? cache_->Acquire(capacity)
+                                               : ArenaChunkCache::AllocateChunk(capacity);
+
+        // Chunks are kept in allocation order so Release() can splice head..tail
+        if (tail_) {
+            tail_->next = chunk;
+        } else {
+            head_ = chunk;
+        }
+        tail_ = chunk;
+        chunk->next = nullptr;
+
+        cursor_ = reinterpret_cast<uintptr_t>(chunk->data());
+        limit_ = cursor_ + chunk->capacity;
+        total_capacity_ += chunk->capacity;
+        chunk_count_++;
+    }
+
+    ArenaChunkCache* cache_;
+    size_t chunk_size_;
+    ArenaChunkCache::Chunk* head_ = nullptr;
+    ArenaChunkCache::Chunk* tail_ = nullptr;
+    uintptr_t cursor_ = 0;
+    uintptr_t limit_ = 0;
+    size_t total_capacity_ = 0;
+    size_t bytes_allocated_ = 0;
+    size_t chunk_count_ = 0;
+};
+
+/**
+ * STL allocator adapter so containers can grow inside a SessionArena
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(SessionArena* arena) noexcept : arena_(arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena_->Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {
+        // Memory is reclaimed when the arena is released
+    }
+
+    SessionArena* arena() const noexcept { return arena_; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+    SessionArena* arena_;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_SESSION_ARENA_H
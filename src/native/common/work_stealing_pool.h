@@ -0,0 +1,182 @@
+/**
+ * @file work_stealing_pool.h
+ * @brief Fixed-size thread pool with per-worker deques and work stealing
+ *
+ * Each worker owns a deque. Tasks submitted from a worker thread go to the
+ * back of that worker's deque and are popped LIFO, which keeps recursive
+ * work (e.g. a directory and its children) hot in cache and bounds the
+ * number of in-flight tasks. Idle workers steal from the front of other
+ * deques, so the oldest and usually largest pieces of work migrate first.
+ * Tasks submitted from outside the pool are spread round-robin.
+ *
+ * The pool carries no per-job state; callers track completion of their own
+ * task groups (see the pending counter in file-ops' DirectoryWalker).
+ */
+
+#ifndef NATIVE_COMMON_WORK_STEALING_POOL_H
+#define NATIVE_COMMON_WORK_STEALING_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FileCataloger {
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // thread_count 0 picks hardware_concurrency (at least 2)
+    explicit WorkStealingPool(size_t thread_count = 0) {
+        if (thread_count == 0) {
+            thread_count = std::max<size_t>(2, std::thread::hardware_concurrency());
+        }
+
+        queues_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; i++) {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+        threads_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; i++) {
+            threads_.emplace_back([this, i] { RunWorker(i); });
+        }
+    }
+
+    // Joins the workers; tasks that have not started are discarded
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (auto& thread : threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void Submit(Task task) {
+        size_t index;
+        if (current_pool_ == this) {
+            index = current_worker_;
+        } else {
+            index = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        }
+
+        {
+            WorkerQueue& queue = *queues_[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        // queued_ and sleepers_ use seq_cst so either this thread sees the
+        // sleeper or the sleeper sees the new task before it waits
+        queued_.fetch_add(1);
+
+        // Only pay for the sleep lock when someone may be waiting
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            sleep_cv_.notify_one();
+        }
+    }
+
+    size_t ThreadCount() const { return threads_.size(); }
+
+    // Tasks executed by a worker other than the one they were queued on
+    uint64_t GetStealCount() const { return steals_.load(std::memory_order_relaxed); }
+
+    // True when called from one of this pool's workers
+    bool IsWorkerThread() const { return current_pool_ == this; }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool PopLocal(size_t index, Task& out) {
+        WorkerQueue& queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        out = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool Steal(size_t thief, Task& out) {
+        const size_t count = queues_.size();
+        for (size_t offset = 1; offset < count; offset++) {
+            WorkerQueue& queue = *queues_[(thief + offset) % count];
+            std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || queue.tasks.empty()) {
+                continue;
+            }
+            out = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void RunWorker(size_t index) {
+        current_pool_ = this;
+        current_worker_ = index;
+
+        Task task;
+        while (true) {
+            if (PopLocal(index, task) || Steal(index, task)) {
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            if (stopping_) {
+                return;
+            }
+            sleepers_.fetch_add(1);
+            // Re-check after announcing the sleeper so a Submit between the
+            // failed steal and the wait cannot be missed
+            sleep_cv_.wait(lock, [this] {
+                return stopping_ || queued_.load() > 0;
+            });
+            sleepers_.fetch_sub(1);
+            if (stopping_) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stopping_ = false;
+    std::atomic<int> sleepers_{0};
+    std::atomic<int64_t> queued_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<uint64_t> steals_{0};
+
+    static inline thread_local WorkStealingPool* current_pool_ = nullptr;
+    static inline thread_local size_t current_worker_ = 0;
+};
+
+} // namespace FileCataloger
+
+#endif // NATIVE_COMMON_WORK_STEALING_POOL_H
@@ -23,6 +23,12 @@
 import { EventEmitter } from 'events';
 import * as path from 'path';
 import { createLogger } from '@main/modules/utils/logger';
+import type {
+  NativeAllocationStats,
+  NativeProfileOptions,
+  NativeProfileResult,
+  NativeStartupTimings,
+} from '@shared/types';
 
 const logger = createLogger('DragMonitor');
 
@@ -42,8 +48,15 @@ export interface DragEvent {
   items: DraggedItem[];
 }
 
+// startAsync() rejections carry the native code and the phases that ran
+interface NativeStartupError extends Error {
+  code?: number;
+  timings?: NativeStartupTimings;
+}
+
 interface NativeDragMonitor {
   start(): boolean;
+  startAsync(): Promise<NativeStartupTimings>;
   stop(): boolean;
   hasActiveDrag(): boolean;
   getDraggedFiles(): Array<{
@@ -57,6 +70,8 @@ interface NativeDragMonitor {
     exists?: boolean;
   }>;
   isMonitoring(): boolean;
+  getMetrics(): { arenaChunksAllocated: number; allocations: NativeAllocationStats };
+  startProfiling(options: NativeProfileOptions): Promise<NativeProfileResult>;
 }
 
 interface NativeDragModule {
@@ -100,6 +115,7 @@ export class MacDragMonitor extends EventEmitter {
   private pollingInterval: ReturnType<typeof setInterval> | null = null;
   private wasActiveDrag: boolean = false;
   private pollCount: number = 0;
+  private pendingStart: Promise<NativeStartupTimings> | null = null;
 
   constructor() {
     super();
@@ -243,6 +259,51 @@ export class MacDragMonitor extends EventEmitter {
     }
   }
 
+  /**
+   * Start without blocking the main process: the accessibility probe, the
+   * event tap and the pasteboard timer are set up on the native monitoring
+   * thread. Polling begins at once and sees no drag until the tap is live.
+   * Resolves with per-phase timings; rejects (with `code`) if monitoring
+   * could not start.
+   */
+  public startAsync(): Promise<NativeStartupTimings> {
+    if (this.pendingStart) {
+      return this.pendingStart;
+    }
+    if (!this.nativeMonitor) {
+      return Promise.reject(new Error('Native drag monitor not initialized'));
+    }
+
+    const nativeMonitor = this.nativeMonitor;
+    const wasMonitoring = this.monitoring;
+    this.monitoring = true;
+    this.startPolling();
+    this.pendingStart = nativeMonitor.startAsync().then(
+      timings => {
+        this.pendingStart = null;
+        if (!wasMonitoring) {
+          this.emit('started');
+          logger.info('✅ Native drag monitor started in the background', timings);
+        }
+        return timings;
+      },
+      (error: NativeStartupError) => {
+        this.pendingStart = null;
+        this.monitoring = false;
+        this.stopPolling();
+        // Joins the threads the failed start left behind
+        nativeMonitor.stop();
+        logger.warn(
+          '⚠️ Native drag monitor failed to start - may need accessibility permissions',
+          error.message,
+          error.timings
+        );
+        throw error;
+      }
+    );
+    return this.pendingStart;
+  }
+
   public stop(): boolean {
     if (!this.isMonitoring) {
       return false;
@@ -298,6 +359,34 @@ export class MacDragMonitor extends EventEmitter {
     }
   }
 
+  /**
+   * Native bytes held by drag sessions (trajectory, paths, analysis) and
+   * the arena chunks cached between them
+   */
+  public getNativeAllocations(): NativeAllocationStats | null {
+    if (!this.nativeMonitor) {
+      return null;
+    }
+
+    try {
+      return this.nativeMonitor.getMetrics().allocations;
+    } catch (error) {
+      logger.warn('Failed to get native drag monitor metrics:', error);
+      return null;
+    }
+  }
+
+  /**
+   * Sample the monitoring and analysis threads for options.durationMs and
+   * write their folded stacks to options.outputPath
+   */
+  public startProfiling(options: NativeProfileOptions): Promise<NativeProfileResult> {
+    if (!this.nativeMonitor) {
+      return Promise.reject(new Error('Native drag monitor not initialized'));
+    }
+    return this.nativeMonitor.startProfiling(options);
+  }
+
   public destroy(): void {
     if (this.monitoring) {
       this.stop();
@@ -24,16 +24,28 @@
  */
 
 import { createLogger } from '@main/modules/utils/logger';
+import type {
+  NativeAllocationStats,
+  NativeProfileOptions,
+  NativeProfileResult,
+  NativeStartupTimings,
+} from '@shared/types';
 
 const logger = createLogger('DragMonitorFactory');
 
 // Define a common interface for drag monitors
 export interface DragMonitor {
   start(): boolean;
+  /** Start with permission probing and hook setup off the main thread */
+  startAsync?(): Promise<NativeStartupTimings>;
   stop(): boolean;
   isDragging(): boolean;
   isMonitoring(): boolean;
   getDraggedItems(): DraggedItem[];
+  /** Native bytes held per subsystem; macOS only */
+  getNativeAllocations?(): NativeAllocationStats | null;
+  /** Sample the native threads and write folded stacks; macOS only */
+  startProfiling?(options: NativeProfileOptions): Promise<NativeProfileResult>;
   destroy(): void;
   on(event: 'dragStart', listener: (items: DraggedItem[]) => void): this;
   on(event: 'dragging', listener: (items: DraggedItem[]) => void): this;
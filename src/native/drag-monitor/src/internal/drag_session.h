@@ -0,0 +1,176 @@
+/**
+ * @file drag_session.h
+ * @brief Per-drag session state allocated from a single SessionArena
+ *
+ * Everything a drag produces (trajectory points, analysis snapshots and
+ * dragged file paths) lives in the session's arena. The session is shared
+ * between the event tap thread, the analysis thread and the JS thread via
+ * std::shared_ptr; when the last reference drops, the arena's chunks return
+ * to the monitor's ArenaChunkCache in O(1). While it lives, the bytes each
+ * kind of data takes are charged to its AllocAccounting tag.
+ *
+ * Only the thread running the event tap allocates from a session. Other
+ * threads read data that was fully written before it was handed to them
+ * (analysis snapshots through the analysis queue, paths under the monitor's
+ * file path mutex).
+ *
+ * This header is platform independent so the allocation behaviour can be
+ * exercised on Linux (see test/drag_session_alloc_test.cc).
+ */
+
+#ifndef DRAG_MONITOR_DRAG_SESSION_H
+#define DRAG_MONITOR_DRAG_SESSION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "session_arena.h"
+
+namespace FileCataloger {
+
+struct TrajectoryPoint {
+    double x;
+    double y;
+};
+
+/**
+ * Fixed-capacity ring of the most recent trajectory points
+ */
+class TrajectoryRing {
+public:
+    TrajectoryRing(TrajectoryPoint* storage, size_t capacity)
+        : points_(storage), capacity_(capacity) {}
+
+    void Clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    // Overwrites the oldest point once full
+    void Push(TrajectoryPoint point) {
+        points_[(head_ + size_) % capacity_] = point;
+        if (size_ < capacity_) {
+            size_++;
+        } else {
+            head_ = (head_ + 1) % capacity_;
+        }
+    }
+
+    size_t size() const { return size_; }
+    const TrajectoryPoint& operator[](size_t i) const { return points_[(head_ + i) % capacity_]; }
+    const TrajectoryPoint& front() const { return (*this)[0]; }
+    const TrajectoryPoint& back() const { return (*this)[size_ - 1]; }
+
+    void CopyTo(TrajectoryPoint* out) const {
+        for (size_t i = 0; i < size_; i++) {
+            out[i] = (*this)[i];
+        }
+    }
+
+private:
+    TrajectoryPoint* points_;
+    size_t capacity_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+/**
+ * Point-in-time copy of the trajectory handed to the analysis thread
+ */
+struct TrajectorySnapshot {
+    TrajectoryPoint* points;
+    size_t count;
+    std::atomic<bool> inUse{false};
+};
+
+class DragSession {
+public:
+    static constexpr size_t MAX_TRAJECTORY_POINTS = 100;
+    // Bounds in-flight analysis per drag; a snapshot is skipped when all are busy
+    static constexpr size_t MAX_ANALYSIS_SNAPSHOTS = 4;
+
+    explicit DragSession(ArenaChunkCache* cache)
+        : arena_(cache),
+          trajectory_(arena_.AllocateArray<TrajectoryPoint>(MAX_TRAJECTORY_POINTS), MAX_TRAJECTORY_POINTS),
+          filePaths_(ArenaAllocator<std::string_view>(&arena_)) {
+        trajectoryBytes_ = arena_.BytesAllocated();
+        for (auto& snapshot : snapshots_) {
+            snapshot.points = arena_.AllocateArray<TrajectoryPoint>(MAX_TRAJECTORY_POINTS);
+            snapshot.count = 0;
+        }
+        analysisBytes_ = arena_.BytesAllocated() - trajectoryBytes_;
+        AllocAccounting::Charge(AllocTag::Trajectory, trajectoryBytes_);
+        AllocAccounting::Charge(AllocTag::Analysis, analysisBytes_);
+    }
+
+    ~DragSession() {
+        AllocAccounting::Credit(AllocTag::Trajectory, trajectoryBytes_);
+        AllocAccounting::Credit(AllocTag::Analysis, analysisBytes_);
+        AllocAccounting::Credit(AllocTag::Paths, pathBytes_);
+    }
+
+    DragSession(const DragSession&) = delete;
+    DragSession& operator=(const DragSession&) = delete;
+
+    TrajectoryRing& trajectory() { return trajectory_; }
+    const TrajectoryRing& trajectory() const { return trajectory_; }
+
+    // Copy the current trajectory into a free snapshot slot, or return nullptr
+    TrajectorySnapshot* TakeSnapshot() {
+        for (auto& snapshot : snapshots_) {
+            bool expected = false;
+            if (snapshot.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                trajectory_.CopyTo(snapshot.points);
+                snapshot.count = trajectory_.size();
+                return &snapshot;
+            }
+        }
+        return nullptr;
+    }
+
+    static void ReleaseSnapshot(TrajectorySnapshot* snapshot) {
+        snapshot->inUse.store(false, std::memory_order_release);
+    }
+
+    // Replace the dragged paths; callers serialize with readers externally.
+    // Cleared paths keep their arena bytes until the session ends.
+    void ClearFilePaths() { filePaths_.clear(); }
+    void ReserveFilePaths(size_t count) {
+        size_t before = arena_.BytesAllocated();
+        filePaths_.reserve(count);
+        ChargePaths(before);
+    }
+    void AddFilePath(const char* path, size_t length) {
+        size_t before = arena_.BytesAllocated();
+        filePaths_.push_back(arena_.CopyString(path, length));
+        ChargePaths(before);
+    }
+    const ArenaVector<std::string_view>& filePaths() const { return filePaths_; }
+
+    const SessionArena& arena() const { return arena_; }
+
+private:
+    void ChargePaths(size_t before) {
+        size_t bytes = arena_.BytesAllocated() - before;
+        if (bytes > 0) {
+            AllocAccounting::Charge(AllocTag::Paths, bytes);
+            pathBytes_ += bytes;
+        }
+    }
+
+    SessionArena arena_;
+    TrajectoryRing trajectory_;
+    TrajectorySnapshot snapshots_[MAX_ANALYSIS_SNAPSHOTS];
+    ArenaVector<std::string_view> filePaths_;
+    // Arena bytes charged to each AllocAccounting tag
+    size_t trajectoryBytes_ = 0;
+    size_t analysisBytes_ = 0;
+    size_t pathBytes_ = 0;
+};
+
+} // namespace FileCataloger
+
+#endif // DRAG_MONITOR_DRAG_SESSION_H
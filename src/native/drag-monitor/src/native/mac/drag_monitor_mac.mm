@@ -15,6 +15,16 @@
 #include <condition_variable>
 #include <memory>
 
+#include "async_startup.h"
+#include "drag_session.h"
+#include "error_codes.h"
+#include "napi_smart_ptr.h"
+#include "profile_request.h"
+
+using FileCataloger::DragSession;
+using FileCataloger::TrajectoryPoint;
+using FileCataloger::TrajectorySnapshot;
+
 // RAII wrappers for CoreFoundation types
 template<typename T>
 struct CFDeleter {
@@ -72,19 +82,31 @@ private:
     static Napi::FunctionReference constructor;
     
     Napi::Value Start(const Napi::CallbackInfo& info);
+    Napi::Value StartAsync(const Napi::CallbackInfo& info);
     Napi::Value Stop(const Napi::CallbackInfo& info);
     Napi::Value IsMonitoring(const Napi::CallbackInfo& info);
     Napi::Value HasActiveDrag(const Napi::CallbackInfo& info);
     Napi::Value GetFileCount(const Napi::CallbackInfo& info);
     Napi::Value GetDraggedFiles(const Napi::CallbackInfo& info);
+    Napi::Value GetMetrics(const Napi::CallbackInfo& info);
+    Napi::Value StartProfiling(const Napi::CallbackInfo& info);
     
-    void MonitoringLoop();
+    // startup is null for the synchronous Start(), which probed permission
+    void MonitoringLoop(std::shared_ptr<FileCataloger::AsyncStartup> startup);
+    void FailStartup(FileCataloger::AsyncStartup* startup, FileCataloger::StartupReport report,
+                     FileCataloger::ErrorCode code, const char* message);
+    void FailOnMonitoringThread(FileCataloger::AsyncStartup* startup, FileCataloger::StartupReport report,
+                                FileCataloger::ErrorCode code, const char* message);
+    void JoinThreads();
+    static bool ProbeAccessibility();
     bool CheckForFileDrag();
     void RunAnalysisThread();
     
     std::thread* monitoringThread;
     std::atomic<bool> isMonitoring;
     std::atomic<bool> shouldStop;
+    // Orders Stop() against the monitoring thread settling a startAsync()
+    std::mutex startupMutex;
     std::atomic<bool> isDragging;
     std::atomic<int> lastPasteboardChangeCount;
     std::chrono::steady_clock::time_point mouseDownTime;
@@ -92,8 +114,15 @@ private:
     // Polling state variables
     std::atomic<bool> hasActiveDrag;
     std::atomic<int> fileCount;
-    std::vector<std::string> draggedFilePaths;
     std::mutex filePathsMutex;
+
+    // Per-drag arenas. The cache is declared first so it outlives every session.
+    // activeSession is only touched on the monitoring thread (event tap and
+    // pasteboard timer); pathSession keeps the paths of the last file drag
+    // alive for GetDraggedFiles and is guarded by filePathsMutex.
+    FileCataloger::ArenaChunkCache sessionChunkCache;
+    std::shared_ptr<DragSession> activeSession;
+    std::shared_ptr<DragSession> pathSession;
     
     // Track drag state with more precision and trajectory analysis
     struct DragState {
@@ -105,9 +134,7 @@ private:
         int moveCount;
         bool hasFiles;
 
-        // Trajectory analysis with bounded size
-        static constexpr size_t MAX_TRAJECTORY_POINTS = 100;
-        std::deque<CGPoint> trajectory;  // Use deque for efficient front removal
+        // Trajectory points live in activeSession's bounded ring
         int directionChanges;
         double maxVelocity;
         double avgVelocity;
@@ -130,9 +157,16 @@ private:
     std::condition_variable analysisCV;
     struct AnalysisTask {
         std::chrono::steady_clock::time_point timestamp;
-        std::deque<CGPoint> trajectory;  // Copy for thread safety
+        std::shared_ptr<DragSession> session;  // Keeps the snapshot's arena alive
+        TrajectorySnapshot* snapshot;
     };
-    std::queue<AnalysisTask> analysisQueue;
+    // Fixed ring so queueing analysis never allocates; oldest tasks are dropped when full
+    static constexpr size_t ANALYSIS_QUEUE_CAPACITY = 8;
+    AnalysisTask analysisQueue[ANALYSIS_QUEUE_CAPACITY];
+    size_t analysisQueueHead{0};
+    size_t analysisQueueSize{0};
+    void EnqueueAnalysis(const std::shared_ptr<DragSession>& session, TrajectorySnapshot* snapshot);
+    void ClearAnalysisQueue();
 
     // Delayed file path clearing to prevent race condition
     CFTimerWrapper clearPathsTimer;
@@ -144,10 +178,10 @@ private:
                                         void* refcon);
     
     // Trajectory analysis methods
-    void AnalyzeTrajectory();
-    bool DetectCircularMotion();
-    bool DetectZigzagPattern();
-    double CalculateAngle(CGPoint p1, CGPoint p2, CGPoint p3);
+    void AnalyzeTrajectory(const TrajectorySnapshot& snapshot);
+    bool DetectCircularMotion(const TrajectorySnapshot& snapshot, double totalDistance);
+    bool DetectZigzagPattern(const TrajectorySnapshot& snapshot, int directionChanges);
+    static double CalculateAngle(TrajectoryPoint p1, TrajectoryPoint p2, TrajectoryPoint p3);
 
     // Delayed file path clearing
     void ScheduleClearFilePaths();
@@ -161,11 +195,14 @@ Napi::Object DarwinDragMonitor::Init(Napi::Env env, Napi::Object exports) {
     
     Napi::Function func = DefineClass(env, "DarwinDragMonitor", {
         InstanceMethod("start", &DarwinDragMonitor::Start),
+        InstanceMethod("startAsync", &DarwinDragMonitor::StartAsync),
         InstanceMethod("stop", &DarwinDragMonitor::Stop),
         InstanceMethod("isMonitoring", &DarwinDragMonitor::IsMonitoring),
         InstanceMethod("hasActiveDrag", &DarwinDragMonitor::HasActiveDrag),
         InstanceMethod("getFileCount", &DarwinDragMonitor::GetFileCount),
-        InstanceMethod("getDraggedFiles", &DarwinDragMonitor::GetDraggedFiles)
+        InstanceMethod("getDraggedFiles", &DarwinDragMonitor::GetDraggedFiles),
+        InstanceMethod("getMetrics", &DarwinDragMonitor::GetMetrics),
+        InstanceMethod("startProfiling", &DarwinDragMonitor::StartProfiling)
     });
     
     constructor = Napi::Persistent(func);
@@ -196,7 +233,6 @@ DarwinDragMonitor::DarwinDragMonitor(const Napi::CallbackInfo& info)
         dragStateBuffers[i].totalDistance = 0;
         dragStateBuffers[i].moveCount = 0;
         dragStateBuffers[i].hasFiles = false;
-        dragStateBuffers[i].trajectory.clear();
         dragStateBuffers[i].directionChanges = 0;
         dragStateBuffers[i].maxVelocity = 0;
         dragStateBuffers[i].avgVelocity = 0;
@@ -208,30 +244,20 @@ DarwinDragMonitor::DarwinDragMonitor(const Napi::CallbackInfo& info)
 }
 
 DarwinDragMonitor::~DarwinDragMonitor() {
-    if (isMonitoring.load()) {
-        // Clean up without calling Stop() which requires valid Napi environment
-        shouldStop.store(true);
-        analysisRunning.store(false);
-
-        // Notify analysis thread to wake up and exit
-        analysisCV.notify_all();
-
-        if (analysisThread.joinable()) {
-            analysisThread.join();
-        }
+    // A start that failed on the monitoring thread leaves both threads to join
+    bool wasMonitoring = isMonitoring.load();
+    shouldStop.store(true);
+    JoinThreads();
 
-        if (monitoringThread && monitoringThread->joinable()) {
-            monitoringThread->join();
-            delete monitoringThread;
-            monitoringThread = nullptr;
-        }
-        
-        // Clear all state
+    if (wasMonitoring) {
+        // Clean up without calling Stop() which requires valid Napi environment
         hasActiveDrag.store(false);
         fileCount.store(0);
+        ClearAnalysisQueue();
+        activeSession.reset();
         {
             std::lock_guard<std::mutex> lock(filePathsMutex);
-            draggedFilePaths.clear();
+            pathSession.reset();
         }
     }
 }
@@ -422,9 +448,13 @@ bool DarwinDragMonitor::CheckForFileDrag() {
                 if (fileURLs && fileURLs.count > 0) {
                     NSLog(@"[DragMonitor] Found %lu file URLs", (unsigned long)fileURLs.count);
                     @try {
-                        // Store file paths for polling
+                        // Store file paths for polling in the drag's arena
+                        if (!activeSession) {
+                            activeSession = std::make_shared<DragSession>(&sessionChunkCache);
+                        }
                         std::lock_guard<std::mutex> lock(filePathsMutex);
-                        draggedFilePaths.clear();
+                        activeSession->ClearFilePaths();
+                        activeSession->ReserveFilePaths(fileURLs.count);
 
                         for (NSUInteger i = 0; i < fileURLs.count; i++) {
                             NSURL* url = fileURLs[i];
@@ -433,18 +463,19 @@ bool DarwinDragMonitor::CheckForFileDrag() {
                                 if (path && path.length > 0) {
                                     const char* utf8Path = [path UTF8String];
                                     if (utf8Path) {
-                                        draggedFilePaths.push_back(std::string(utf8Path));
+                                        activeSession->AddFilePath(utf8Path, strlen(utf8Path));
                                     }
                                 }
                             }
                         }
 
-                        fileCount.store(static_cast<int>(draggedFilePaths.size()));
+                        pathSession = activeSession;
+                        fileCount.store(static_cast<int>(activeSession->filePaths().size()));
                     } @catch (NSException* exception) {
                         NSLog(@"[DragMonitor] Exception processing file URLs: %@", exception);
                         // Reset state on error
                         std::lock_guard<std::mutex> lock(filePathsMutex);
-                        draggedFilePaths.clear();
+                        pathSession.reset();
                         fileCount.store(0);
                         return false;
                     }
@@ -494,10 +525,15 @@ CGEventRef DarwinDragMonitor::DragEventCallback(CGEventTapProxy proxy,
         if (monitor->hasPendingClear.load()) {
             NSLog(@"[DragMonitor] New drag starting - clearing stale file paths immediately");
             std::lock_guard<std::mutex> lock(monitor->filePathsMutex);
-            monitor->draggedFilePaths.clear();
+            monitor->pathSession.reset();
             monitor->hasPendingClear.store(false);
         }
 
+        // Every drag gets a fresh arena-backed session; the previous one is
+        // released once analysis and path readers are done with it
+        monitor->activeSession = std::make_shared<DragSession>(&monitor->sessionChunkCache);
+        monitor->activeSession->trajectory().Push({location.x, location.y});
+
         // Reset drag state
         dragState.startPoint = location;
         dragState.lastPoint = location;
@@ -506,8 +542,6 @@ CGEventRef DarwinDragMonitor::DragEventCallback(CGEventTapProxy proxy,
         dragState.totalDistance = 0;
         dragState.moveCount = 0;
         dragState.hasFiles = false;
-        dragState.trajectory.clear();
-        dragState.trajectory.push_back(location);
         dragState.directionChanges = 0;
         dragState.maxVelocity = 0;
         dragState.avgVelocity = 0;
@@ -545,11 +579,11 @@ CGEventRef DarwinDragMonitor::DragEventCallback(CGEventTapProxy proxy,
         dragState.moveCount++;
         dragState.lastMoveTime = now;
 
-        // Add to trajectory for analysis with size limit
-        dragState.trajectory.push_back(location);
-        if (dragState.trajectory.size() > DragState::MAX_TRAJECTORY_POINTS) {
-            dragState.trajectory.pop_front();  // Remove oldest point
+        // Add to trajectory for analysis; the ring keeps the latest points
+        if (!monitor->activeSession) {
+            monitor->activeSession = std::make_shared<DragSession>(&monitor->sessionChunkCache);
         }
+        monitor->activeSession->trajectory().Push({location.x, location.y});
         
         // Track velocity
         auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -561,14 +595,11 @@ CGEventRef DarwinDragMonitor::DragEventCallback(CGEventTapProxy proxy,
             dragState.avgVelocity = (dragState.avgVelocity * (dragState.moveCount - 1) + velocity) / dragState.moveCount;
         }
         
-        // Queue trajectory analysis every 10 moves
-        if (dragState.moveCount % 10 == 0 && dragState.trajectory.size() > 3) {
-            std::lock_guard<std::mutex> lock(monitor->analysisQueueMutex);
-            monitor->analysisQueue.push({
-                std::chrono::steady_clock::now(),
-                dragState.trajectory  // Copy trajectory
-            });
-            monitor->analysisCV.notify_one();
+        // Queue trajectory analysis every 10 moves (skipped if all snapshots are busy)
+        if (dragState.moveCount % 10 == 0 && monitor->activeSession->trajectory().size() > 3) {
+            if (TrajectorySnapshot* snapshot = monitor->activeSession->TakeSnapshot()) {
+                monitor->EnqueueAnalysis(monitor->activeSession, snapshot);
+            }
         }
         
         // Calculate time since drag started
@@ -633,10 +664,11 @@ CGEventRef DarwinDragMonitor::DragEventCallback(CGEventTapProxy proxy,
             monitor->ScheduleClearFilePaths();
         }
 
-        // Reset state
+        // Reset state; the session lives on only while paths or analysis need it
         dragState.hasFiles = false;
         dragState.totalDistance = 0;
         dragState.moveCount = 0;
+        monitor->activeSession.reset();
     }
 
     // Swap buffers atomically
@@ -652,28 +684,12 @@ Napi::Value DarwinDragMonitor::Start(const Napi::CallbackInfo& info) {
     if (isMonitoring.load()) {
         return Napi::Boolean::New(env, true);
     }
+    JoinThreads();
     
-    // Request accessibility permissions if needed
-    if (!AXIsProcessTrustedWithOptions(nullptr)) {
-        CFStringRef keys[] = { kAXTrustedCheckOptionPrompt };
-        CFBooleanRef values[] = { kCFBooleanTrue };
-        CFDictionaryRef options = CFDictionaryCreate(
-            kCFAllocatorDefault,
-            (const void**)keys,
-            (const void**)values,
-            1,
-            &kCFTypeDictionaryKeyCallBacks,
-            &kCFTypeDictionaryValueCallBacks
-        );
-        
-        bool trusted = AXIsProcessTrustedWithOptions(options);
-        CFRelease(options);
-        
-        if (!trusted) {
-            Napi::Error::New(env, "Accessibility permission required for drag monitoring")
-                .ThrowAsJavaScriptException();
-            return Napi::Boolean::New(env, false);
-        }
+    if (!ProbeAccessibility()) {
+        Napi::Error::New(env, "Accessibility permission required for drag monitoring")
+            .ThrowAsJavaScriptException();
+        return Napi::Boolean::New(env, false);
     }
     
     isMonitoring.store(true);
@@ -684,12 +700,141 @@ Napi::Value DarwinDragMonitor::Start(const Napi::CallbackInfo& info) {
     analysisThread = std::thread(&DarwinDragMonitor::RunAnalysisThread, this);
 
     // Start monitoring thread
-    monitoringThread = new std::thread(&DarwinDragMonitor::MonitoringLoop, this);
+    monitoringThread = new std::thread(&DarwinDragMonitor::MonitoringLoop, this, nullptr);
     
     return Napi::Boolean::New(env, true);
 }
 
-void DarwinDragMonitor::MonitoringLoop() {
+// Start without blocking the JS thread: the permission probe, the event tap
+// and the pasteboard timer are set up on the monitoring thread, which
+// settles the returned promise with per-phase timings once drags are seen.
+Napi::Value DarwinDragMonitor::StartAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    napi_value promise;
+    auto startup = FileCataloger::AsyncStartup::Create(env, "DragMonitorStartup", &promise);
+    if (!startup) {
+        return env.Undefined();
+    }
+
+    if (isMonitoring.load()) {
+        startup->Complete(FileCataloger::StartupReport());
+        return Napi::Value(env, promise);
+    }
+    JoinThreads();
+
+    isMonitoring.store(true);
+    shouldStop.store(false);
+    analysisRunning.store(true);
+
+    try {
+        analysisThread = std::thread(&DarwinDragMonitor::RunAnalysisThread, this);
+        monitoringThread = new std::thread(&DarwinDragMonitor::MonitoringLoop, this, startup);
+    } catch (const std::exception&) {
+        isMonitoring.store(false);
+        JoinThreads();
+        FailStartup(startup.get(), FileCataloger::StartupReport(),
+                    FileCataloger::ErrorCode::THREAD_CREATE_FAILED,
+                    "Failed to create drag monitoring threads");
+    }
+
+    startup->SetBlockingMs(startup->MsSinceRequest());
+    return Napi::Value(env, promise);
+}
+
+bool DarwinDragMonitor::ProbeAccessibility() {
+    if (AXIsProcessTrustedWithOptions(nullptr)) {
+        return true;
+    }
+
+    // Request accessibility permissions
+    CFStringRef keys[] = { kAXTrustedCheckOptionPrompt };
+    CFBooleanRef values[] = { kCFBooleanTrue };
+    CFDictionaryRef options = CFDictionaryCreate(
+        kCFAllocatorDefault,
+        (const void**)keys,
+        (const void**)values,
+        1,
+        &kCFTypeDictionaryKeyCallBacks,
+        &kCFTypeDictionaryValueCallBacks
+    );
+    
+    bool trusted = AXIsProcessTrustedWithOptions(options);
+    CFRelease(options);
+    return trusted;
+}
+
+void DarwinDragMonitor::FailStartup(FileCataloger::AsyncStartup* startup,
+                                    FileCataloger::StartupReport report,
+                                    FileCataloger::ErrorCode code, const char* message) {
+    report.code = static_cast<int>(code);
+    report.message = message;
+    report.totalMs = startup->MsSinceRequest();
+    startup->Complete(std::move(report));
+}
+
+// Monitoring thread: a start that fails here lets the analysis thread exit
+// at once rather than idle until the next start() or stop() joins both
+void DarwinDragMonitor::FailOnMonitoringThread(FileCataloger::AsyncStartup* startup,
+                                               FileCataloger::StartupReport report,
+                                               FileCataloger::ErrorCode code, const char* message) {
+    isMonitoring.store(false);
+    {
+        std::lock_guard<std::mutex> lock(analysisQueueMutex);
+        analysisRunning.store(false);
+    }
+    analysisCV.notify_all();
+    if (startup) {
+        FailStartup(startup, std::move(report), code, message);
+    }
+}
+
+// Joins whatever threads a previous start left. Callers set shouldStop or
+// know the monitoring thread has exited.
+void DarwinDragMonitor::JoinThreads() {
+    analysisRunning.store(false);
+
+    // Notify analysis thread to wake up and exit
+    analysisCV.notify_all();
+
+    if (analysisThread.joinable()) {
+        analysisThread.join();
+    }
+
+    if (monitoringThread) {
+        if (monitoringThread->joinable()) {
+            monitoringThread->join();
+        }
+        delete monitoringThread;
+        monitoringThread = nullptr;
+    }
+}
+
+void DarwinDragMonitor::MonitoringLoop(std::shared_ptr<FileCataloger::AsyncStartup> startup) {
+    FileCataloger::ProfiledThread profiled("drag-monitor");
+    FileCataloger::StartupReport report;
+    if (startup) {
+        report.threadSpawnMs = startup->MsSinceRequest();
+
+        auto probeStart = FileCataloger::AsyncStartup::Clock::now();
+        bool trusted = ProbeAccessibility();
+        report.permissionMs = FileCataloger::AsyncStartup::MsSince(probeStart);
+        if (!trusted) {
+            FailOnMonitoringThread(startup.get(), std::move(report),
+                                   FileCataloger::ErrorCode::ACCESSIBILITY_PERMISSION_DENIED,
+                                   "Accessibility permission required for drag monitoring");
+            return;
+        }
+        // stop() during the probe; it joins both threads
+        if (shouldStop.load()) {
+            FailStartup(startup.get(), std::move(report),
+                        FileCataloger::ErrorCode::DRAG_MONITOR_START_FAILED,
+                        "Drag monitor stopped during startup");
+            return;
+        }
+    }
+    auto hookStart = FileCataloger::AsyncStartup::Clock::now();
+
     // Create event tap for mouse events
     CGEventMask eventMask = (1 << kCGEventLeftMouseDown) |
                            (1 << kCGEventLeftMouseUp) |
@@ -705,7 +850,10 @@ void DarwinDragMonitor::MonitoringLoop() {
     );
 
     if (!eventTap) {
-        isMonitoring.store(false);
+        report.hookMs = FileCataloger::AsyncStartup::MsSince(hookStart);
+        FailOnMonitoringThread(startup.get(), std::move(report),
+                               FileCataloger::ErrorCode::EVENT_TAP_CREATE_FAILED,
+                               "Failed to create event tap for drag monitoring");
         return;
     }
 
@@ -735,6 +883,21 @@ void DarwinDragMonitor::MonitoringLoop() {
         // Continue without timer - fallback to less efficient monitoring
     }
 
+    if (startup) {
+        report.hookMs = FileCataloger::AsyncStartup::MsSince(hookStart);
+        // Resolve only if no stop() came first; one that comes later stops
+        // a monitor whose start has already resolved
+        std::lock_guard<std::mutex> lock(startupMutex);
+        if (!shouldStop.load()) {
+            report.totalMs = startup->MsSinceRequest();
+            startup->Complete(std::move(report));
+        } else {
+            FailStartup(startup.get(), std::move(report),
+                        FileCataloger::ErrorCode::DRAG_MONITOR_START_FAILED,
+                        "Drag monitor stopped during startup");
+        }
+    }
+
     // Run the event loop
     while (!shouldStop.load()) {
         CFRunLoopRunInMode(kCFRunLoopDefaultMode, 0.5, false);  // Longer timeout OK with timer
@@ -755,31 +918,26 @@ Napi::Value DarwinDragMonitor::Stop(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     if (!isMonitoring.load()) {
+        // Reap the threads of a start that failed on the monitoring thread
+        JoinThreads();
         return Napi::Boolean::New(env, false);
     }
     
-    shouldStop.store(true);
-    analysisRunning.store(false);
-
-    // Notify analysis thread to wake up and exit
-    analysisCV.notify_all();
-
-    if (analysisThread.joinable()) {
-        analysisThread.join();
-    }
-
-    if (monitoringThread && monitoringThread->joinable()) {
-        monitoringThread->join();
-        delete monitoringThread;
-        monitoringThread = nullptr;
+    {
+        // A startAsync() still on the monitoring thread sees this before it settles
+        std::lock_guard<std::mutex> lock(startupMutex);
+        shouldStop.store(true);
     }
+    JoinThreads();
     
-    // Clear all state
+    // Clear all state; releasing the sessions returns their arenas to the cache
     hasActiveDrag.store(false);
     fileCount.store(0);
+    ClearAnalysisQueue();
+    activeSession.reset();
     {
         std::lock_guard<std::mutex> lock(filePathsMutex);
-        draggedFilePaths.clear();
+        pathSession.reset();
     }
     
     return Napi::Boolean::New(env, true);
@@ -800,15 +958,40 @@ Napi::Value DarwinDragMonitor::GetFileCount(const Napi::CallbackInfo& info) {
     return Napi::Number::New(env, fileCount.load());
 }
 
+// Native bytes held per subsystem (trajectory, paths, analysis, arena cache)
+Napi::Value DarwinDragMonitor::GetMetrics(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object metrics = Napi::Object::New(env);
+    metrics.Set("arenaChunksAllocated", Napi::Number::New(env, static_cast<double>(sessionChunkCache.ChunksAllocated())));
+    metrics.Set("allocations", Napi::Value(env, FileCataloger::CreateAllocationStats(env)));
+    return metrics;
+}
+
+// Folded stacks of the monitoring and analysis threads; see profile_request.h
+Napi::Value DarwinDragMonitor::StartProfiling(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "startProfiling expects an options object").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    napi_value promise = FileCataloger::ProfileRequest::StartProfiling(env, info[0]);
+    return promise ? Napi::Value(env, promise) : env.Undefined();
+}
+
 Napi::Value DarwinDragMonitor::GetDraggedFiles(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     Napi::Array files = Napi::Array::New(env);
     
     std::lock_guard<std::mutex> lock(filePathsMutex);
+    if (!pathSession) {
+        return files;
+    }
+
+    const auto& draggedFilePaths = pathSession->filePaths();
     for (size_t i = 0; i < draggedFilePaths.size(); i++) {
         Napi::Object fileInfo = Napi::Object::New(env);
-        std::string filePath = draggedFilePaths[i];
+        std::string filePath(draggedFilePaths[i]);
         
         fileInfo.Set("path", filePath);
         fileInfo.Set("name", filePath.substr(filePath.find_last_of("/\\") + 1));
@@ -852,20 +1035,16 @@ Napi::Value DarwinDragMonitor::GetDraggedFiles(const Napi::CallbackInfo& info) {
 }
 
 // Trajectory analysis implementation
-void DarwinDragMonitor::AnalyzeTrajectory() {
-    // Get current active buffer for read-only access
-    int currentBuffer = activeDragBuffer.load();
-    const DragState& dragState = dragStateBuffers[currentBuffer];
-
-    if (dragState.trajectory.size() < 3) return;
+void DarwinDragMonitor::AnalyzeTrajectory(const TrajectorySnapshot& snapshot) {
+    if (snapshot.count < 3) return;
 
     // Detect direction changes
     int directionChanges = 0;
-    for (size_t i = 2; i < dragState.trajectory.size(); i++) {
+    for (size_t i = 2; i < snapshot.count; i++) {
         double angle = CalculateAngle(
-            dragState.trajectory[i-2],
-            dragState.trajectory[i-1],
-            dragState.trajectory[i]
+            snapshot.points[i-2],
+            snapshot.points[i-1],
+            snapshot.points[i]
         );
 
         // Significant direction change (> 45 degrees)
@@ -874,65 +1053,48 @@ void DarwinDragMonitor::AnalyzeTrajectory() {
         }
     }
 
+    // Calculate total distance
+    double totalDistance = 0;
+    for (size_t i = 1; i < snapshot.count; i++) {
+        double dx = snapshot.points[i].x - snapshot.points[i-1].x;
+        double dy = snapshot.points[i].y - snapshot.points[i-1].y;
+        totalDistance += sqrt(dx * dx + dy * dy);
+    }
+
     // Analyze patterns
-    bool hasCircularMotion = DetectCircularMotion();
-    bool hasZigzagPattern = DetectZigzagPattern();
+    bool hasCircularMotion = DetectCircularMotion(snapshot, totalDistance);
+    bool hasZigzagPattern = DetectZigzagPattern(snapshot, directionChanges);
 
     // Log significant trajectory patterns
-    if (directionChanges > 5 || hasCircularMotion || hasZigzagPattern) {
-        NSLog(@"[DragMonitor] Trajectory analysis: changes=%d, circular=%d, zigzag=%d",
-              directionChanges, hasCircularMotion, hasZigzagPattern);
+    if (hasCircularMotion || hasZigzagPattern) {
+        NSLog(@"[DragMonitor] Trajectory analysis: circular=%d, zigzag=%d, changes=%d",
+              hasCircularMotion, hasZigzagPattern, directionChanges);
     }
 }
 
-bool DarwinDragMonitor::DetectCircularMotion() {
-    int currentBuffer = activeDragBuffer.load();
-    const DragState& dragState = dragStateBuffers[currentBuffer];
-
-    if (dragState.trajectory.size() < 8) return false;
+bool DarwinDragMonitor::DetectCircularMotion(const TrajectorySnapshot& snapshot, double totalDistance) {
+    if (snapshot.count < 8) return false;
     
     // Check if start and end points are close (circular)
-    CGPoint start = dragState.trajectory.front();
-    CGPoint current = dragState.trajectory.back();
+    TrajectoryPoint start = snapshot.points[0];
+    TrajectoryPoint current = snapshot.points[snapshot.count - 1];
     double distance = sqrt(pow(current.x - start.x, 2) + pow(current.y - start.y, 2));
     
     // If we've moved significantly but are close to start, it's circular
-    if (dragState.totalDistance > 100 && distance < 50) {
-        return true;
-    }
-    
-    // Check for curved motion by analyzing angles
-    int curveCount = 0;
-    for (size_t i = 3; i < dragState.trajectory.size(); i += 3) {
-        double angle = CalculateAngle(
-            dragState.trajectory[i-3],
-            dragState.trajectory[i-1],
-            dragState.trajectory[i]
-        );
-        
-        // Consistent small angles indicate curved motion
-        if (angle > 0.1 && angle < M_PI / 3) {
-            curveCount++;
-        }
-    }
-    
-    return static_cast<size_t>(curveCount) > dragState.trajectory.size() / 6;
+    return totalDistance > 100 && distance < 50;
 }
 
-bool DarwinDragMonitor::DetectZigzagPattern() {
-    int currentBuffer = activeDragBuffer.load();
-    const DragState& dragState = dragStateBuffers[currentBuffer];
-
-    if (dragState.directionChanges < 3) return false;
+bool DarwinDragMonitor::DetectZigzagPattern(const TrajectorySnapshot& snapshot, int directionChanges) {
+    if (directionChanges < 3) return false;
     
     // Zigzag pattern has many direction changes relative to distance
-    double changeRate = (double)dragState.directionChanges / dragState.trajectory.size();
+    double changeRate = (double)directionChanges / snapshot.count;
     
     // High rate of direction changes indicates zigzag
     return changeRate > 0.3;
 }
 
-double DarwinDragMonitor::CalculateAngle(CGPoint p1, CGPoint p2, CGPoint p3) {
+double DarwinDragMonitor::CalculateAngle(TrajectoryPoint p1, TrajectoryPoint p2, TrajectoryPoint p3) {
     // Calculate angle between three points
     double v1x = p2.x - p1.x;
     double v1y = p2.y - p1.y;
@@ -945,69 +1107,60 @@ double DarwinDragMonitor::CalculateAngle(CGPoint p1, CGPoint p2, CGPoint p3) {
     return atan2(cross, dot);
 }
 
+void DarwinDragMonitor::EnqueueAnalysis(const std::shared_ptr<DragSession>& session,
+                                        TrajectorySnapshot* snapshot) {
+    std::lock_guard<std::mutex> lock(analysisQueueMutex);
+    if (analysisQueueSize == ANALYSIS_QUEUE_CAPACITY) {
+        // Analysis is best effort; drop the oldest pending task
+        AnalysisTask& oldest = analysisQueue[analysisQueueHead];
+        DragSession::ReleaseSnapshot(oldest.snapshot);
+        oldest.session.reset();
+        analysisQueueHead = (analysisQueueHead + 1) % ANALYSIS_QUEUE_CAPACITY;
+        analysisQueueSize--;
+    }
+    AnalysisTask& task = analysisQueue[(analysisQueueHead + analysisQueueSize) % ANALYSIS_QUEUE_CAPACITY];
+    task.timestamp = std::chrono::steady_clock::now();
+    task.session = session;
+    task.snapshot = snapshot;
+    analysisQueueSize++;
+    analysisCV.notify_one();
+}
+
+void DarwinDragMonitor::ClearAnalysisQueue() {
+    std::lock_guard<std::mutex> lock(analysisQueueMutex);
+    while (analysisQueueSize > 0) {
+        AnalysisTask& task = analysisQueue[analysisQueueHead];
+        DragSession::ReleaseSnapshot(task.snapshot);
+        task.session.reset();
+        analysisQueueHead = (analysisQueueHead + 1) % ANALYSIS_QUEUE_CAPACITY;
+        analysisQueueSize--;
+    }
+}
+
 void DarwinDragMonitor::RunAnalysisThread() {
+    FileCataloger::ProfiledThread profiled("analysis");
     while (analysisRunning.load()) {
         std::unique_lock<std::mutex> lock(analysisQueueMutex);
 
         // Wait for tasks or shutdown
         analysisCV.wait(lock, [this] {
-            return !analysisQueue.empty() || !analysisRunning.load();
+            return analysisQueueSize > 0 || !analysisRunning.load();
         });
 
-        while (!analysisQueue.empty()) {
-            auto task = std::move(analysisQueue.front());
-            analysisQueue.pop();
+        while (analysisQueueSize > 0) {
+            AnalysisTask task = std::move(analysisQueue[analysisQueueHead]);
+            analysisQueueHead = (analysisQueueHead + 1) % ANALYSIS_QUEUE_CAPACITY;
+            analysisQueueSize--;
 
             lock.unlock();
 
             // Perform trajectory analysis in background
-            int directionChanges = 0;
-            for (size_t i = 2; i < task.trajectory.size(); i++) {
-                double angle = CalculateAngle(
-                    task.trajectory[i-2],
-                    task.trajectory[i-1],
-                    task.trajectory[i]
-                );
-                if (angle > M_PI / 4) {
-                    directionChanges++;
-                }
-            }
+            AnalyzeTrajectory(*task.snapshot);
 
-            // Check for patterns
-            bool hasCircularMotion = false;
-            bool hasZigzagPattern = false;
-
-            // Circular motion detection
-            if (task.trajectory.size() >= 8) {
-                CGPoint start = task.trajectory.front();
-                CGPoint current = task.trajectory.back();
-                double distance = sqrt(pow(current.x - start.x, 2) + pow(current.y - start.y, 2));
-
-                // Calculate total distance
-                double totalDistance = 0;
-                for (size_t i = 1; i < task.trajectory.size(); i++) {
-                    double dx = task.trajectory[i].x - task.trajectory[i-1].x;
-                    double dy = task.trajectory[i].y - task.trajectory[i-1].y;
-                    totalDistance += sqrt(dx * dx + dy * dy);
-                }
-
-                if (totalDistance > 100 && distance < 50) {
-                    hasCircularMotion = true;
-                }
-            }
-
-            // Zigzag pattern detection
-            if (directionChanges >= 3) {
-                double changeRate = (double)directionChanges / task.trajectory.size();
-                hasZigzagPattern = changeRate > 0.3;
-            }
-
-            // Store results atomically (would need additional atomic storage)
-            // For now, just log results
-            if (hasCircularMotion || hasZigzagPattern) {
-                NSLog(@"[DragMonitor] Trajectory analysis: circular=%d, zigzag=%d, changes=%d",
-                      hasCircularMotion, hasZigzagPattern, directionChanges);
-            }
+            // Return the snapshot slot; dropping the session reference may
+            // release the whole drag arena if the drag has already ended
+            DragSession::ReleaseSnapshot(task.snapshot);
+            task.session.reset();
 
             lock.lock();
         }
@@ -1047,7 +1200,7 @@ void DarwinDragMonitor::ClearFilePathsCallback(CFRunLoopTimerRef timer, void* in
     NSLog(@"[DragMonitor] Clearing file paths (delayed clearing executed)");
 
     std::lock_guard<std::mutex> lock(monitor->filePathsMutex);
-    monitor->draggedFilePaths.clear();
+    monitor->pathSession.reset();
     monitor->hasPendingClear.store(false);
 
     NSLog(@"[DragMonitor] File paths cleared successfully");
@@ -0,0 +1,104 @@
+# binding.gyp - Build configuration for the native file operations module
+#
+# This file configures the compilation of the file-ops module, which
+# expands dropped folders with a parallel directory walker, measures
+# their sizes against a persistent cache, sniffs file types from their
+# first bytes, reads capture dates from photo and video headers, copies
+# or moves files with reflink/copy_file_range, exports shelves as ZIP
+# archives compressed on all cores, keeps the shelf session in a binary
+# snapshot with a delta log, keeps shelf items in a columnar store, encodes
+# stat'ed file lists as one compact payload for the renderer, and renames
+# or deletes files in bulk.
+#
+# Build command: node-gyp rebuild
+# Output:
+#   macOS: build/Release/file_ops_darwin.node
+#   Linux: build/Release/file_ops_linux.node (tests and benchmarks)
+#
+# Requirements:
+# - macOS: Xcode Command Line Tools (C++20)
+# - Linux: g++ 11 or newer (C++20 coroutines)
+# - Python 3.x
+# - node-gyp installed globally
+#
+# APIs used:
+# - POSIX openat/fstatat, getdents64 on Linux, readdir elsewhere
+# - pread for content sniffing; on Linux, io_uring (raw syscalls, no
+#   liburing) for linked open/read/close header reads and bulk
+#   rename/unlink when the kernel allows it
+# - FICLONE, copy_file_range, sendfile, renameat2 on Linux; clonefile,
+#   renamex_np on macOS
+# - mmap for the folder size cache, the session snapshot and media metadata
+#   header windows
+# - zlib (raw deflate, crc32_combine) for ZIP export, crc32 for the session
+#   snapshot; zlib-ng built in compat mode links in its place
+# - Plain N-API (node_api.h), no node-addon-api dependency
+#
+# Windows is not built yet; the TypeScript wrapper falls back to fs.promises.
+
+{
+  "targets": [
+    {
+      "target_name": "file_ops_<(OS)",
+      "include_dirs": [
+        "src",
+        "src/internal",
+        "../common"
+      ],
+      "sources": [
+        "src/native/file_ops.cc",
+        "src/internal/content_sniffer.cc",
+        "src/internal/directory_walker.cc",
+        "src/internal/file_list_stat.cc",
+        "src/internal/file_transfer.cc",
+        "src/internal/folder_size.cc",
+        "src/internal/folder_size_cache.cc",
+        "src/internal/io_engine.cc",
+        "src/internal/media_metadata.cc",
+        "src/internal/path_ops.cc",
+        "src/internal/session_store.cc",
+        "src/internal/shelf_store.cc",
+        "src/internal/zip_writer.cc"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        ["OS=='mac'", {
+          "target_name": "file_ops_darwin",
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "10.15",
+            "GCC_OPTIMIZATION_LEVEL": "3",
+            "LLVM_LTO": "YES",
+            "CLANG_CXX_LANGUAGE_STANDARD": "c++20",
+            "OTHER_LDFLAGS": [ "-lz" ]
+          }
+        }],
+        ["OS=='linux'", {
+          "target_name": "file_ops_linux",
+          "cflags_cc": [ "-O3", "-std=c++20" ],
+          "libraries": [ "-lz", "-lpthread" ]
+        }],
+        ["OS=='win'", {
+          "type": "none",
+          "sources!": [
+            "src/native/file_ops.cc",
+            "src/internal/content_sniffer.cc",
+            "src/internal/directory_walker.cc",
+            "src/internal/file_list_stat.cc",
+            "src/internal/file_transfer.cc",
+            "src/internal/folder_size.cc",
+            "src/internal/folder_size_cache.cc",
+            "src/internal/io_engine.cc",
+            "src/internal/media_metadata.cc",
+            "src/internal/path_ops.cc",
+            "src/internal/session_store.cc",
+            "src/internal/shelf_store.cc",
+            "src/internal/zip_writer.cc"
+          ]
+        }]
+      ]
+    }
+  ]
+}
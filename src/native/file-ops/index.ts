@@ -0,0 +1,78 @@
+/**
+ * @fileoverview File operations module entry point
+ *
+ * This file re-exports the file operations functionality from the src directory.
+ * It allows for cleaner imports: `from '@native/file-ops'` instead of `from '@native/file-ops/src'`
+ *
+ * @module file-ops
+ */
+
+export {
+  walkDirectory,
+  entriesOf,
+  isNativeWalkerAvailable,
+  WalkEntryType,
+  measureFolderSize,
+  configureFolderSizeCache,
+  sniffContentTypes,
+  contentCategory,
+  contentTypeInfo,
+  isNativeSnifferAvailable,
+  ContentType,
+  ContentCategory,
+  extractMediaMetadata,
+  isNativeMediaMetadataAvailable,
+  statFileList,
+  statFileListChunks,
+  isNativeFileListAvailable,
+  renamePaths,
+  unlinkPaths,
+  getIoEngine,
+  isNativePathOpsAvailable,
+  openSessionStore,
+  isNativeSessionStoreAvailable,
+  SessionStore,
+  createShelfStore,
+  isNativeShelfStoreAvailable,
+  ShelfItemKind,
+  transferFiles,
+  isNativeTransferAvailable,
+  createZipArchive,
+  isNativeZipAvailable,
+} from './src/index';
+export type {
+  WalkOptions,
+  WalkBatch,
+  WalkEntry,
+  WalkError,
+  WalkSummary,
+  WalkHandle,
+  FolderSize,
+  FolderSizeResult,
+  FolderSizeOptions,
+  FolderSizeMeasurement,
+  ContentTypeInfo,
+  MediaMetadata,
+  RecentFile,
+  WindowBounds,
+  SessionUsageStats,
+  SessionStoreStats,
+  ShelfStore,
+  ShelfItemInput,
+  ShelfItemRecord,
+  ShelfStoreStats,
+  TransferMethod,
+  TransferItem,
+  TransferOptions,
+  TransferResult,
+  TransferProgress,
+  TransferSummary,
+  TransferHandle,
+  ZipSource,
+  ZipArchiveOptions,
+  ZipProgress,
+  ZipSummary,
+  ZipHandle,
+  CancellationOptions,
+  IoEngine,
+} from './src/index';
@@ -0,0 +1,116 @@
+/**
+ * @fileoverview AbortSignal and deadlines for file-ops jobs
+ *
+ * Every job in this module takes CancellationOptions. The native side gets
+ * one NativeCancellationToken per job (common/cancellation_token.h), which
+ * its pool threads poll between chunks of work: a directory, a chunk of
+ * paths, a copy slice. Aborting the signal cancels the token, so the work
+ * stops within one chunk instead of running to completion.
+ *
+ * A deadline stops the job the same way once deadlineMs have passed since
+ * it started. Either way the job resolves with what it has done so far:
+ * walks and transfers report cancelled (and timedOut for a deadline) in
+ * their summary, and batch calls leave the entries they did not reach at
+ * their empty value.
+ *
+ * Usage:
+ * ```typescript
+ * const controller = new AbortController();
+ * shelf.once('closed', () => controller.abort());
+ * const codes = await sniffContentTypes(paths, { signal: controller.signal, deadlineMs: 2000 });
+ * ```
+ *
+ * @module file-ops
+ */
+
+import { loadFileOpsModule } from './nativeModule';
+
+export interface CancellationOptions {
+  /** Stops the job within one chunk of work when aborted */
+  signal?: AbortSignal;
+  /** Stops the job after this many ms and resolves with partial results */
+  deadlineMs?: number;
+}
+
+export interface NativeCancellationToken {
+  cancel(): void;
+  reason(): 'none' | 'cancelled' | 'deadline';
+}
+
+interface NativeCancellationModule {
+  NativeCancellationToken: new (deadlineMs?: number) => NativeCancellationToken;
+}
+
+export interface JobCancellation {
+  /** Pass to the native call; undefined when there is nothing to cancel on */
+  token: NativeCancellationToken | undefined;
+  /** Detach from the signal once the job has finished */
+  release(): void;
+}
+
+export interface FallbackCancellation {
+  /** The deadline, rather than the signal, stopped the job */
+  timedOut(): boolean;
+  release(): void;
+}
+
+const nativeModule = loadFileOpsModule<NativeCancellationModule>();
+
+function validDeadline(deadlineMs: number | undefined): number | undefined {
+  return deadlineMs !== undefined && deadlineMs > 0 ? deadlineMs : undefined;
+}
+
+/**
+ * Create the token for one native job
+ */
+export function nativeCancellation(options: CancellationOptions = {}): JobCancellation {
+  const deadlineMs = validDeadline(options.deadlineMs);
+  const signal = options.signal;
+  if (!nativeModule || (!signal && deadlineMs === undefined)) {
+    return { token: undefined, release: () => {} };
+  }
+
+  const token = new nativeModule.NativeCancellationToken(deadlineMs);
+  if (!signal) {
+    return { token, release: () => {} };
+  }
+  if (signal.aborted) {
+    token.cancel();
+    return { token, release: () => {} };
+  }
+  const onAbort = () => token.cancel();
+  signal.addEventListener('abort', onAbort, { once: true });
+  return { token, release: () => signal.removeEventListener('abort', onAbort) };
+}
+
+/**
+ * For the fs fallbacks: call cancel when the signal aborts or the deadline
+ * passes, whichever comes first
+ */
+export function bindCancellation(options: CancellationOptions, cancel: () => void): FallbackCancellation {
+  const deadlineMs = validDeadline(options.deadlineMs);
+  const signal = options.signal;
+  let timedOut = false;
+  let timer: ReturnType<typeof setTimeout> | undefined;
+
+  const onAbort = () => cancel();
+  if (signal?.aborted) {
+    cancel();
+  } else {
+    signal?.addEventListener('abort', onAbort, { once: true });
+    if (deadlineMs !== undefined) {
+      timer = setTimeout(() => {
+        timedOut = true;
+        cancel();
+      }, deadlineMs);
+    }
+  }
+
+  return {
+    timedOut: () => timedOut,
+    release: () => {
+      if (timer) clearTimeout(timer);
+      signal?.removeEventListener('abort', onAbort);
+    },
+  };
+}
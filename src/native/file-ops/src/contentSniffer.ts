@@ -0,0 +1,225 @@
+/**
+ * @fileoverview File types from content instead of extension
+ *
+ * Reads the first 512 bytes of each file on the native worker pool and
+ * classifies them against a table of magic numbers. One call handles
+ * thousands of files and resolves to a Uint8Array of ContentType codes in
+ * path order, so a large drop costs a single round trip.
+ *
+ * Usage:
+ * ```typescript
+ * const codes = await sniffContentTypes(paths);
+ * const info = contentTypeInfo(codes[0]);   // { mime: 'image/png', extension: 'png' } | null
+ * if (contentCategory(codes[0]) === ContentCategory.Image) ...
+ * ```
+ *
+ * Without the native module (e.g. Windows) every code is Unknown and
+ * callers keep relying on the file extension.
+ *
+ * @module file-ops
+ */
+
+import { CancellationOptions, nativeCancellation, NativeCancellationToken } from './cancellation';
+import { loadFileOpsModule } from './nativeModule';
+
+/** Mirrors ContentType in src/internal/content_sniffer.h; values are stable */
+export enum ContentType {
+  Unknown = 0,
+  Unreadable = 1,
+  Directory = 2,
+  Empty = 3,
+  /** Device, FIFO or socket; never read */
+  Special = 4,
+
+  Text = 32,
+  Html = 33,
+  Xml = 34,
+
+  Jpeg = 64,
+  Png = 65,
+  Gif = 66,
+  Webp = 67,
+  Bmp = 68,
+  Tiff = 69,
+  Heic = 70,
+  Avif = 71,
+  Ico = 72,
+  Psd = 73,
+  Svg = 74,
+
+  Zip = 96,
+  Gzip = 97,
+  Bzip2 = 98,
+  Xz = 99,
+  Zstd = 100,
+  SevenZip = 101,
+  Rar = 102,
+  Tar = 103,
+
+  Pdf = 128,
+  Rtf = 129,
+  /** Legacy .doc/.xls/.ppt/.msg */
+  OleCompound = 130,
+  Epub = 131,
+  OpenDocument = 132,
+  Sqlite = 133,
+  /** Office Open XML whose kind is not visible in the header */
+  Ooxml = 134,
+  Docx = 135,
+  Xlsx = 136,
+  Pptx = 137,
+
+  Mp3 = 160,
+  Aac = 161,
+  Flac = 162,
+  Ogg = 163,
+  Wav = 164,
+  Aiff = 165,
+  Midi = 166,
+  M4a = 167,
+  Mp4 = 168,
+  Mov = 169,
+  Avi = 170,
+  Matroska = 171,
+  Webm = 172,
+
+  Elf = 192,
+  MachO = 193,
+  Pe = 194,
+  Wasm = 195,
+  /** #! interpreter line */
+  Script = 196,
+  JavaClass = 197,
+}
+
+/** Each category owns a range of 32 codes */
+export enum ContentCategory {
+  Other = 0,
+  Text = 1,
+  Image = 2,
+  Archive = 3,
+  Document = 4,
+  Media = 5,
+  Executable = 6,
+}
+
+export interface ContentTypeInfo {
+  mime: string;
+  /** Usual extension, without the dot */
+  extension: string;
+}
+
+const TYPE_INFO: Partial<Record<ContentType, ContentTypeInfo>> = {
+  [ContentType.Text]: { mime: 'text/plain', extension: 'txt' },
+  [ContentType.Html]: { mime: 'text/html', extension: 'html' },
+  [ContentType.Xml]: { mime: 'application/xml', extension: 'xml' },
+
+  [ContentType.Jpeg]: { mime: 'image/jpeg', extension: 'jpg' },
+  [ContentType.Png]: { mime: 'image/png', extension: 'png' },
+  [ContentType.Gif]: { mime: 'image/gif', extension: 'gif' },
+  [ContentType.Webp]: { mime: 'image/webp', extension: 'webp' },
+  [ContentType.Bmp]: { mime: 'image/bmp', extension: 'bmp' },
+  [ContentType.Tiff]: { mime: 'image/tiff', extension: 'tiff' },
+  [ContentType.Heic]: { mime: 'image/heic', extension: 'heic' },
+  [ContentType.Avif]: { mime: 'image/avif', extension: 'avif' },
+  [ContentType.Ico]: { mime: 'image/vnd.microsoft.icon', extension: 'ico' },
+  [ContentType.Psd]: { mime: 'image/vnd.adobe.photoshop', extension: 'psd' },
+  [ContentType.Svg]: { mime: 'image/svg+xml', extension: 'svg' },
+
+  [ContentType.Zip]: { mime: 'application/zip', extension: 'zip' },
+  [ContentType.Gzip]: { mime: 'application/gzip', extension: 'gz' },
+  [ContentType.Bzip2]: { mime: 'application/x-bzip2', extension: 'bz2' },
+  [ContentType.Xz]: { mime: 'application/x-xz', extension: 'xz' },
+  [ContentType.Zstd]: { mime: 'application/zstd', extension: 'zst' },
+  [ContentType.SevenZip]: { mime: 'application/x-7z-compressed', extension: '7z' },
+  [ContentType.Rar]: { mime: 'application/vnd.rar', extension: 'rar' },
+  [ContentType.Tar]: { mime: 'application/x-tar', extension: 'tar' },
+
+  [ContentType.Pdf]: { mime: 'application/pdf', extension: 'pdf' },
+  [ContentType.Rtf]: { mime: 'application/rtf', extension: 'rtf' },
+  [ContentType.OleCompound]: { mime: 'application/x-ole-storage', extension: 'doc' },
+  [ContentType.Epub]: { mime: 'application/epub+zip', extension: 'epub' },
+  [ContentType.OpenDocument]: { mime: 'application/vnd.oasis.opendocument', extension: 'odt' },
+  [ContentType.Sqlite]: { mime: 'application/vnd.sqlite3', extension: 'sqlite' },
+  [ContentType.Ooxml]: { mime: 'application/vnd.openxmlformats-officedocument', extension: 'docx' },
+  [ContentType.Docx]: {
+    mime: 'application/vnd.openxmlformats-officedocument.wordprocessingml.document',
+    extension: 'docx',
+  },
+  [ContentType.Xlsx]: {
+    mime: 'application/vnd.openxmlformats-officedocument.spreadsheetml.sheet',
+    extension: 'xlsx',
+  },
+  [ContentType.Pptx]: {
+    mime: 'application/vnd.openxmlformats-officedocument.presentationml.presentation',
+    extension: 'pptx',
+  },
+
+  [ContentType.Mp3]: { mime: 'audio/mpeg', extension: 'mp3' },
+  [ContentType.Aac]: { mime: 'audio/aac', extension: 'aac' },
+  [ContentType.Flac]: { mime: 'audio/flac', extension: 'flac' },
+  [ContentType.Ogg]: { mime: 'audio/ogg', extension: 'ogg' },
+  [ContentType.Wav]: { mime: 'audio/wav', extension: 'wav' },
+  [ContentType.Aiff]: { mime: 'audio/aiff', extension: 'aiff' },
+  [ContentType.Midi]: { mime: 'audio/midi', extension: 'mid' },
+  [ContentType.M4a]: { mime: 'audio/mp4', extension: 'm4a' },
+  [ContentType.Mp4]: { mime: 'video/mp4', extension: 'mp4' },
+  [ContentType.Mov]: { mime: 'video/quicktime', extension: 'mov' },
+  [ContentType.Avi]: { mime: 'video/x-msvideo', extension: 'avi' },
+  [ContentType.Matroska]: { mime: 'video/x-matroska', extension: 'mkv' },
+  [ContentType.Webm]: { mime: 'video/webm', extension: 'webm' },
+
+  [ContentType.Elf]: { mime: 'application/x-elf', extension: '' },
+  [ContentType.MachO]: { mime: 'application/x-mach-binary', extension: '' },
+  [ContentType.Pe]: { mime: 'application/vnd.microsoft.portable-executable', extension: 'exe' },
+  [ContentType.Wasm]: { mime: 'application/wasm', extension: 'wasm' },
+  [ContentType.Script]: { mime: 'text/x-script', extension: 'sh' },
+  [ContentType.JavaClass]: { mime: 'application/java-vm', extension: 'class' },
+};
+
+interface NativeSnifferModule {
+  sniffContentTypes(
+    paths: string[],
+    callback: (codes: Uint8Array) => void,
+    cancellation?: NativeCancellationToken
+  ): void;
+}
+
+const nativeModule = loadFileOpsModule<NativeSnifferModule>();
+
+export function isNativeSnifferAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+export function contentCategory(type: ContentType): ContentCategory {
+  const range = type >> 5;
+  return range <= ContentCategory.Executable ? range : ContentCategory.Other;
+}
+
+/** MIME type and usual extension, or null for Unknown and the non-file codes */
+export function contentTypeInfo(type: ContentType): ContentTypeInfo | null {
+  return TYPE_INFO[type] ?? null;
+}
+
+/**
+ * Classify files by their first bytes. Resolves to one ContentType code
+ * per path, in order; files that cannot be opened are Unreadable, and files
+ * not reached before options.signal aborted or the deadline passed are
+ * Unknown.
+ */
+export function sniffContentTypes(paths: string[], options: CancellationOptions = {}): Promise<Uint8Array> {
+  if (!nativeModule || paths.length === 0) {
+    return Promise.resolve(new Uint8Array(paths.length));
+  }
+  const cancellation = nativeCancellation(options);
+  return new Promise(resolve =>
+    nativeModule.sniffContentTypes(
+      paths,
+      codes => {
+        cancellation.release();
+        resolve(codes);
+      },
+      cancellation.token
+    )
+  );
+}
@@ -0,0 +1,386 @@
+/**
+ * @fileoverview Streaming recursive directory walker
+ *
+ * Expands dropped folders for the rename tree view and file counts. The
+ * native walker reads directories in parallel on a work-stealing pool and
+ * streams columnar batches back to JS; when the native module is missing
+ * (e.g. Windows) the same batches are produced with fs.promises.opendir.
+ *
+ * Usage:
+ * ```typescript
+ * const walk = walkDirectory(folder, { ignore: ['node_modules', '.git'] }, batch => {
+ *   for (const entry of entriesOf(folder, batch)) tree.add(entry);
+ * });
+ * const summary = await walk.done;   // walk.cancel() or options.signal stops early
+ * ```
+ *
+ * @module file-ops
+ */
+
+import { promises as fs } from 'fs';
+import * as path from 'path';
+import { createLogger } from '@main/modules/utils/logger';
+import { NativeErrorCode } from '@shared/nativeErrorCodes';
+import { bindCancellation, CancellationOptions, nativeCancellation, NativeCancellationToken } from './cancellation';
+import { errnoCode, loadFileOpsModule, toErrnoException } from './nativeModule';
+
+const logger = createLogger('DirectoryWalker');
+
+export enum WalkEntryType {
+  Unknown = 0,
+  File = 1,
+  Directory = 2,
+  Symlink = 3,
+  Other = 4,
+}
+
+export interface WalkOptions extends CancellationOptions {
+  /** Levels below the root to enumerate; 1 lists only direct children. Unlimited by default. */
+  maxDepth?: number;
+  /** Entries per batch (default 1024) */
+  batchSize?: number;
+  /** Fill sizes and mtimes (default true) */
+  stat?: boolean;
+  /** Glob patterns ('*', '?') matched against entry names; ignored folders are not entered */
+  ignore?: string[];
+}
+
+/**
+ * Columnar batch of entries; entry i lives in directories[directoryIndex[i]]
+ */
+export interface WalkBatch {
+  directories: string[];
+  directoryDepths: Uint32Array;
+  directoryIndex: Uint32Array;
+  names: string[];
+  types: Uint8Array;
+  sizes: Float64Array;
+  mtimes: Float64Array;
+}
+
+export interface WalkEntry {
+  path: string;
+  relativePath: string;
+  name: string;
+  type: WalkEntryType;
+  size: number;
+  mtimeMs: number;
+  depth: number;
+}
+
+export interface WalkError {
+  path: string;
+  errno: number;
+  code: string;
+  message: string;
+}
+
+export interface WalkSummary {
+  entries: number;
+  directoriesRead: number;
+  errorCount: number;
+  cancelled: boolean;
+  /** Stopped by deadlineMs; the batches read until then were delivered */
+  timedOut: boolean;
+  durationMs: number;
+  errors: WalkError[];
+  native: boolean;
+}
+
+export interface WalkHandle {
+  done: Promise<WalkSummary>;
+  cancel(): void;
+}
+
+type NativeWalkSummary = Omit<WalkSummary, 'errors' | 'native'> & {
+  errors: Array<Omit<WalkError, 'code'>>;
+};
+
+type NativeWalkOptions = Omit<WalkOptions, 'signal' | 'deadlineMs'> & {
+  cancellation?: NativeCancellationToken;
+};
+
+interface NativeDirectoryWalker {
+  start(
+    root: string,
+    options: NativeWalkOptions,
+    callback: (batches: WalkBatch[], summary?: NativeWalkSummary) => void
+  ): boolean;
+  cancel(): void;
+  isRunning(): boolean;
+}
+
+interface NativeWalkerModule {
+  NativeDirectoryWalker: new () => NativeDirectoryWalker;
+}
+
+const MAX_REPORTED_ERRORS = 64;
+const DEFAULT_BATCH_SIZE = 1024;
+
+const nativeModule = loadFileOpsModule<NativeWalkerModule>();
+
+export function isNativeWalkerAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+/**
+ * Walk a directory tree, streaming batches to onBatch as they are read.
+ * Rejects only if the root itself cannot be opened.
+ */
+export function walkDirectory(
+  root: string,
+  options: WalkOptions,
+  onBatch: (batch: WalkBatch) => void
+): WalkHandle {
+  if (nativeModule) {
+    return walkNative(nativeModule, root, options, onBatch);
+  }
+  return walkFallback(root, options, onBatch);
+}
+
+/**
+ * Expand a batch into entry objects with absolute paths
+ */
+export function* entriesOf(root: string, batch: WalkBatch): Generator<WalkEntry> {
+  for (let i = 0; i < batch.names.length; i++) {
+    const directory = batch.directories[batch.directoryIndex[i]];
+    const name = batch.names[i];
+    const relativePath = directory ? `${directory}/${name}` : name;
+    yield {
+      path: path.join(root, relativePath),
+      relativePath,
+      name,
+      type: batch.types[i] as WalkEntryType,
+      size: batch.sizes[i],
+      mtimeMs: batch.mtimes[i],
+      depth: batch.directoryDepths[batch.directoryIndex[i]],
+    };
+  }
+}
+
+function walkNative(
+  module: NativeWalkerModule,
+  root: string,
+  options: WalkOptions,
+  onBatch: (batch: WalkBatch) => void
+): WalkHandle {
+  const walker = new module.NativeDirectoryWalker();
+  const { signal, deadlineMs, ...walkOptions } = options;
+  const cancellation = nativeCancellation({ signal, deadlineMs });
+
+  const done = new Promise<WalkSummary>((resolve, reject) => {
+    try {
+      walker.start(root, { ...walkOptions, cancellation: cancellation.token }, (batches, summary) => {
+        for (const batch of batches) {
+          try {
+            onBatch(batch);
+          } catch (error) {
+            logger.error('Directory walk batch handler failed:', error);
+            walker.cancel();
+          }
+        }
+        if (summary) {
+          cancellation.release();
+          resolve({
+            ...summary,
+            errors: summary.errors.map(error => ({ ...error, code: errnoCode(error.errno) })),
+            native: true,
+          });
+        }
+      });
+    } catch (error: unknown) {
+      cancellation.release();
+      reject(toErrnoException(error, NativeErrorCode.DIRECTORY_WALK_FAILED, root));
+    }
+  });
+
+  return { done, cancel: () => walker.cancel() };
+}
+
+/**
+ * Single-threaded fallback producing the same batches as the native walker
+ */
+function walkFallback(
+  root: string,
+  options: WalkOptions,
+  onBatch: (batch: WalkBatch) => void
+): WalkHandle {
+  let cancelled = false;
+  const batchSize = Math.max(1, options.batchSize ?? DEFAULT_BATCH_SIZE);
+  const maxDepth = options.maxDepth ?? 0;
+  const wantStat = options.stat ?? true;
+  const ignore = (options.ignore ?? []).map(globToRegExp);
+  const startTime = Date.now();
+
+  const summary: WalkSummary = {
+    entries: 0,
+    directoriesRead: 0,
+    errorCount: 0,
+    cancelled: false,
+    timedOut: false,
+    durationMs: 0,
+    errors: [],
+    native: false,
+  };
+  const cancellation = bindCancellation(options, () => {
+    cancelled = true;
+  });
+
+  let pending = newBatch();
+  const flush = () => {
+    // Entries read before a deadline are delivered, as the native walker does
+    if (pending.names.length > 0 && (!cancelled || cancellation.timedOut())) {
+      onBatch(freeze(pending));
+    }
+    pending = newBatch();
+  };
+
+  const recordError = (relativePath: string, error: NodeJS.ErrnoException) => {
+    summary.errorCount++;
+    if (summary.errors.length < MAX_REPORTED_ERRORS) {
+      summary.errors.push({
+        path: relativePath,
+        errno: Math.abs(error.errno ?? 0),
+        code: error.code ?? 'UNKNOWN',
+        message: error.message,
+      });
+    }
+  };
+
+  const scan = async (relativePath: string, depth: number): Promise<void> => {
+    if (cancelled) return;
+
+    let dir;
+    try {
+      dir = await fs.opendir(relativePath ? path.join(root, relativePath) : root);
+    } catch (error) {
+      if (!relativePath) throw error;
+      recordError(relativePath, error as NodeJS.ErrnoException);
+      return;
+    }
+    summary.directoriesRead++;
+
+    const entryDepth = depth + 1;
+    const descend = maxDepth === 0 || entryDepth < maxDepth;
+    const subdirectories: string[] = [];
+    // A directory gets a slot in every batch its entries land in
+    const openSlot = () => {
+      pending.directories.push(relativePath);
+      pending.directoryDepths.push(entryDepth);
+      return pending.directories.length - 1;
+    };
+    let slot = openSlot();
+    let slotUsed = false;
+
+    for await (const dirent of dir) {
+      if (cancelled) break;
+      if (ignore.some(pattern => pattern.test(dirent.name))) continue;
+
+      const childPath = relativePath ? `${relativePath}/${dirent.name}` : dirent.name;
+      let type = dirent.isFile()
+        ? WalkEntryType.File
+        : dirent.isDirectory()
+          ? WalkEntryType.Directory
+          : dirent.isSymbolicLink()
+            ? WalkEntryType.Symlink
+            : WalkEntryType.Other;
+      let size = 0;
+      let mtimeMs = 0;
+      if (wantStat) {
+        try {
+          const stats = await fs.lstat(path.join(root, childPath));
+          size = stats.size;
+          mtimeMs = stats.mtimeMs;
+        } catch {
+          type = WalkEntryType.Unknown;
+        }
+      }
+
+      pending.directoryIndex.push(slot);
+      pending.names.push(dirent.name);
+      pending.types.push(type);
+      pending.sizes.push(size);
+      pending.mtimes.push(mtimeMs);
+      slotUsed = true;
+      summary.entries++;
+
+      if (descend && type === WalkEntryType.Directory) {
+        subdirectories.push(childPath);
+      }
+      if (pending.names.length >= batchSize) {
+        flush();
+        slot = openSlot();
+        slotUsed = false;
+      }
+    }
+
+    // The slot is still the last one, since children are scanned afterwards
+    if (!slotUsed) {
+      pending.directories.pop();
+      pending.directoryDepths.pop();
+    }
+
+    for (const child of subdirectories) {
+      await scan(child, entryDepth);
+    }
+  };
+
+  const done = (async () => {
+    try {
+      await scan('', 0);
+    } finally {
+      cancellation.release();
+    }
+    flush();
+    summary.cancelled = cancelled;
+    summary.timedOut = cancellation.timedOut();
+    summary.durationMs = Date.now() - startTime;
+    return summary;
+  })();
+
+  return {
+    done,
+    cancel: () => {
+      cancelled = true;
+    },
+  };
+}
+
+interface PendingBatch {
+  directories: string[];
+  directoryDepths: number[];
+  directoryIndex: number[];
+  names: string[];
+  types: number[];
+  sizes: number[];
+  mtimes: number[];
+}
+
+function newBatch(): PendingBatch {
+  return {
+    directories: [],
+    directoryDepths: [],
+    directoryIndex: [],
+    names: [],
+    types: [],
+    sizes: [],
+    mtimes: [],
+  };
+}
+
+function freeze(batch: PendingBatch): WalkBatch {
+  return {
+    directories: batch.directories,
+    directoryDepths: Uint32Array.from(batch.directoryDepths),
+    directoryIndex: Uint32Array.from(batch.directoryIndex),
+    names: batch.names,
+    types: Uint8Array.from(batch.types),
+    sizes: Float64Array.from(batch.sizes),
+    mtimes: Float64Array.from(batch.mtimes),
+  };
+}
+
+function globToRegExp(pattern: string): RegExp {
+  const escaped = pattern.replace(/[.+^${}()|[\]\\]/g, '\\$&');
+  return new RegExp(`^${escaped.replace(/\*/g, '.*').replace(/\?/g, '.')}$`, 's');
+}
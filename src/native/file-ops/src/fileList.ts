@@ -0,0 +1,132 @@
+/**
+ * @fileoverview Stat a list of paths into a compact file-list payload
+ *
+ * statFileList() stats every path on the native worker pool and returns one
+ * ArrayBuffer (see src/shared/fileListPayload.ts) instead of an array of
+ * objects, ready to post to a renderer and read there with FileListView.
+ *
+ * statFileListChunks() yields the same payloads chunkSize paths at a time,
+ * so a long list can be shown as it arrives. The native side stats a chunk
+ * only when the loop asks for it, and breaking out of the loop stops it.
+ *
+ * Usage:
+ * ```typescript
+ * const payload = await statFileList(paths);
+ * port.postMessage(payload);
+ *
+ * for await (const chunk of statFileListChunks(paths, 1000)) {
+ *   port.postMessage(chunk);
+ * }
+ * ```
+ *
+ * Without the native module (e.g. Windows) the same payload is built from
+ * fs.promises.stat.
+ *
+ * @module file-ops
+ */
+
+import { promises as fs } from 'fs';
+import * as path from 'path';
+import { encodeFileList } from '@shared/fileListPayload';
+import { CancellationOptions, nativeCancellation, NativeCancellationToken } from './cancellation';
+import { loadFileOpsModule } from './nativeModule';
+
+interface NativeFileListModule {
+  statFileList(paths: string[], cancellation?: NativeCancellationToken): Promise<ArrayBuffer>;
+  statFileListChunks(
+    paths: string[],
+    chunkSize: number,
+    cancellation?: NativeCancellationToken
+  ): AsyncIterableIterator<ArrayBuffer>;
+}
+
+const nativeModule = loadFileOpsModule<NativeFileListModule>();
+
+export function isNativeFileListAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+async function statFileListFallback(paths: string[]): Promise<ArrayBuffer> {
+  const items = await Promise.all(
+    paths.map(async filePath => {
+      const name = path.basename(filePath);
+      const extension = path.extname(name).slice(1) || undefined;
+      try {
+        const stats = await fs.stat(filePath);
+        const isDirectory = stats.isDirectory();
+        return {
+          path: filePath,
+          name,
+          extension,
+          isDirectory,
+          isFile: !isDirectory,
+          exists: true,
+          size: isDirectory ? undefined : stats.size,
+        };
+      } catch {
+        return { path: filePath, name, extension, isDirectory: false, isFile: true, exists: false };
+      }
+    })
+  );
+  return encodeFileList(items);
+}
+
+/**
+ * Stat paths and encode them as a file-list payload, in path order. As with
+ * the drag monitor, symlinks are followed and isFile is !isDirectory, also
+ * for paths that do not exist. Paths not reached before options.signal
+ * aborted or the deadline passed have no flags set (neither exists nor
+ * isFile).
+ */
+export async function statFileList(paths: string[], options: CancellationOptions = {}): Promise<ArrayBuffer> {
+  if (!nativeModule) {
+    return statFileListFallback(paths);
+  }
+  const cancellation = nativeCancellation(options);
+  try {
+    return await nativeModule.statFileList(paths, cancellation.token);
+  } finally {
+    cancellation.release();
+  }
+}
+
+async function* statFileListChunksFallback(
+  paths: string[],
+  chunkSize: number,
+  options: CancellationOptions
+): AsyncIterableIterator<ArrayBuffer> {
+  const deadline = options.deadlineMs ? Date.now() + options.deadlineMs : Infinity;
+  for (let begin = 0; begin < paths.length; begin += chunkSize) {
+    if (options.signal?.aborted || Date.now() >= deadline) return;
+    yield await statFileListFallback(paths.slice(begin, begin + chunkSize));
+  }
+}
+
+async function* releasing(
+  chunks: AsyncIterableIterator<ArrayBuffer>,
+  release: () => void
+): AsyncIterableIterator<ArrayBuffer> {
+  try {
+    yield* chunks;
+  } finally {
+    release();
+  }
+}
+
+/**
+ * Stat paths chunkSize at a time and yield one file-list payload per chunk,
+ * in path order. An aborted signal or a passed deadline ends the stream
+ * after the chunk in progress, which may be partial.
+ */
+export function statFileListChunks(
+  paths: string[],
+  chunkSize: number,
+  options: CancellationOptions = {}
+): AsyncIterableIterator<ArrayBuffer> {
+  const size = Math.max(1, Math.floor(chunkSize));
+  if (!nativeModule) {
+    return statFileListChunksFallback(paths, size, options);
+  }
+  const cancellation = nativeCancellation(options);
+  return releasing(nativeModule.statFileListChunks(paths, size, cancellation.token), cancellation.release);
+}
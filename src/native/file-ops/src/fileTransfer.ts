@@ -0,0 +1,334 @@
+/**
+ * @fileoverview Parallel copy/move of files and folders
+ *
+ * Moves files dropped on a shelf into a folder, and copies them when asked.
+ * The native engine renames when source and destination share a
+ * filesystem, clones on copy-on-write filesystems (btrfs, XFS, APFS), and
+ * otherwise copies inside the kernel with copy_file_range/sendfile, with
+ * a bounded number of copies per destination device. Partial copies are
+ * never left under the destination name. Without the native module the
+ * same API runs on fs.promises.rename/cp, one item at a time.
+ *
+ * Usage:
+ * ```typescript
+ * const transfer = transferFiles(
+ *   paths.map(source => ({ source, destination: path.join(folder, path.basename(source)) })),
+ *   { mode: 'move' },
+ *   progress => bar.set(progress.bytesDone / progress.bytesFound)
+ * );
+ * const summary = await transfer.done;   // transfer.cancel() or options.signal stops early
+ * ```
+ *
+ * @module file-ops
+ */
+
+import { promises as fs } from 'fs';
+import { createLogger } from '@main/modules/utils/logger';
+import { NativeErrorCode } from '@shared/nativeErrorCodes';
+import { bindCancellation, CancellationOptions, nativeCancellation, NativeCancellationToken } from './cancellation';
+import { errnoCode, loadFileOpsModule, toErrnoException } from './nativeModule';
+
+const logger = createLogger('FileTransfer');
+
+export type TransferMethod = 'none' | 'rename' | 'clone' | 'copyFileRange' | 'sendfile' | 'readWrite';
+
+/** Index of each method in the native results' methods array */
+const TRANSFER_METHODS: TransferMethod[] = [
+  'none',
+  'rename',
+  'clone',
+  'copyFileRange',
+  'sendfile',
+  'readWrite',
+];
+
+export interface TransferItem {
+  source: string;
+  /** Full destination path, not the folder it goes into */
+  destination: string;
+}
+
+export interface TransferOptions extends CancellationOptions {
+  /** Default 'copy'; 'move' removes each source once it has been copied */
+  mode?: 'copy' | 'move';
+  /** Replace existing files and merge into existing folders (default false: EEXIST) */
+  overwrite?: boolean;
+  /** Methods to try, in the fixed order above; readWrite is always the last resort */
+  methods?: Array<Exclude<TransferMethod, 'none'>>;
+  /** Copies running at once per destination device (default 4) */
+  perDeviceConcurrency?: number;
+  /** read/write buffer in bytes (default 1MB) */
+  bufferSize?: number;
+}
+
+export interface TransferResult {
+  index: number;
+  source: string;
+  destination: string;
+  /** For folders, the slowest method any of their files needed */
+  method: TransferMethod;
+  bytes: number;
+  error?: NodeJS.ErrnoException;
+}
+
+export interface TransferProgress {
+  bytesDone: number;
+  /** Grows while folders are listed */
+  bytesFound: number;
+  filesDone: number;
+  filesFound: number;
+  itemsDone: number;
+}
+
+export interface TransferSummary {
+  items: number;
+  failed: number;
+  files: number;
+  bytes: number;
+  /** Files transferred per method */
+  methods: Record<Exclude<TransferMethod, 'none'>, number>;
+  cancelled: boolean;
+  /** Stopped by deadlineMs; unfinished items failed with ECANCELED */
+  timedOut: boolean;
+  durationMs: number;
+  /** In item order */
+  results: TransferResult[];
+  native: boolean;
+}
+
+export interface TransferHandle {
+  done: Promise<TransferSummary>;
+  cancel(): void;
+}
+
+interface NativeTransferResults {
+  indices: Uint32Array;
+  methods: Uint8Array;
+  errnos: Int32Array;
+  bytes: Float64Array;
+}
+
+type NativeTransferSummary = Omit<TransferSummary, 'results' | 'native'>;
+
+type NativeTransferOptions = Omit<TransferOptions, 'signal' | 'deadlineMs'> & {
+  cancellation?: NativeCancellationToken;
+};
+
+interface NativeFileTransfer {
+  start(
+    items: TransferItem[],
+    options: NativeTransferOptions,
+    callback: (
+      results: NativeTransferResults,
+      progress: TransferProgress,
+      summary?: NativeTransferSummary
+    ) => void
+  ): boolean;
+  cancel(): void;
+  isRunning(): boolean;
+}
+
+interface NativeTransferModule {
+  NativeFileTransfer: new () => NativeFileTransfer;
+}
+
+const nativeModule = loadFileOpsModule<NativeTransferModule>();
+
+export function isNativeTransferAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+/**
+ * Copy or move every item. Failures are reported per item in the summary;
+ * the promise rejects only on invalid arguments.
+ */
+export function transferFiles(
+  items: TransferItem[],
+  options: TransferOptions = {},
+  onProgress?: (progress: TransferProgress) => void
+): TransferHandle {
+  if (nativeModule) {
+    return transferNative(nativeModule, items, options, onProgress);
+  }
+  return transferFallback(items, options, onProgress);
+}
+
+function errnoException(errno: number, item: TransferItem): NodeJS.ErrnoException {
+  const code = errnoCode(errno);
+  const error = new Error(`${code}: cannot transfer '${item.source}' to '${item.destination}'`) as NodeJS.ErrnoException;
+  error.code = code;
+  error.errno = errno;
+  error.path = item.source;
+  error.dest = item.destination;
+  return error;
+}
+
+function transferNative(
+  module: NativeTransferModule,
+  items: TransferItem[],
+  options: TransferOptions,
+  onProgress?: (progress: TransferProgress) => void
+): TransferHandle {
+  const transfer = new module.NativeFileTransfer();
+  const results: TransferResult[] = new Array(items.length);
+  const { signal, deadlineMs, ...transferOptions } = options;
+  const cancellation = nativeCancellation({ signal, deadlineMs });
+
+  const done = new Promise<TransferSummary>((resolve, reject) => {
+    try {
+      transfer.start(items, { ...transferOptions, cancellation: cancellation.token }, (batch, progress, summary) => {
+        for (let i = 0; i < batch.indices.length; i++) {
+          const index = batch.indices[i];
+          const item = items[index];
+          results[index] = {
+            index,
+            source: item.source,
+            destination: item.destination,
+            method: TRANSFER_METHODS[batch.methods[i]] ?? 'none',
+            bytes: batch.bytes[i],
+            error: batch.errnos[i] ? errnoException(batch.errnos[i], item) : undefined,
+          };
+        }
+        if (onProgress) {
+          try {
+            onProgress(progress);
+          } catch (error) {
+            logger.error('Transfer progress handler failed:', error);
+          }
+        }
+        if (summary) {
+          cancellation.release();
+          resolve({ ...summary, results, native: true });
+        }
+      });
+    } catch (error: unknown) {
+      cancellation.release();
+      reject(toErrnoException(error, NativeErrorCode.TRANSFER_FAILED, items[0]?.source ?? ''));
+    }
+  });
+
+  return { done, cancel: () => transfer.cancel() };
+}
+
+/**
+ * One item at a time with fs.promises: rename for moves, cp when that
+ * crosses devices or for copies
+ */
+function transferFallback(
+  items: TransferItem[],
+  options: TransferOptions,
+  onProgress?: (progress: TransferProgress) => void
+): TransferHandle {
+  let cancelled = false;
+  const move = options.mode === 'move';
+  const overwrite = options.overwrite ?? false;
+  const allowRename = !options.methods || options.methods.includes('rename');
+  const startTime = Date.now();
+
+  const progress: TransferProgress = {
+    bytesDone: 0,
+    bytesFound: 0,
+    filesDone: 0,
+    filesFound: 0,
+    itemsDone: 0,
+  };
+  const summary: TransferSummary = {
+    items: items.length,
+    failed: 0,
+    files: 0,
+    bytes: 0,
+    methods: { rename: 0, clone: 0, copyFileRange: 0, sendfile: 0, readWrite: 0 },
+    cancelled: false,
+    timedOut: false,
+    durationMs: 0,
+    results: [],
+    native: false,
+  };
+  const cancellation = bindCancellation(options, () => {
+    cancelled = true;
+  });
+
+  const transferOne = async (item: TransferItem): Promise<{ method: TransferMethod; bytes: number }> => {
+    const stats = await fs.lstat(item.source);
+    const bytes = stats.isFile() ? stats.size : 0;
+    progress.bytesFound += bytes;
+    progress.filesFound++;
+
+    if (!overwrite) {
+      const exists = await fs.lstat(item.destination).then(
+        () => true,
+        () => false
+      );
+      if (exists) {
+        throw Object.assign(new Error(`EEXIST: '${item.destination}' already exists`), {
+          code: 'EEXIST',
+          path: item.destination,
+        });
+      }
+    }
+    if (move && allowRename) {
+      try {
+        await fs.rename(item.source, item.destination);
+        return { method: 'rename', bytes };
+      } catch (error) {
+        if ((error as NodeJS.ErrnoException).code !== 'EXDEV') throw error;
+      }
+    }
+    await fs.cp(item.source, item.destination, {
+      recursive: true,
+      force: overwrite,
+      errorOnExist: !overwrite,
+      preserveTimestamps: true,
+      verbatimSymlinks: true,
+    });
+    if (move) {
+      await fs.rm(item.source, { recursive: true });
+    }
+    return { method: 'readWrite', bytes };
+  };
+
+  const done = (async () => {
+    for (let index = 0; index < items.length; index++) {
+      const item = items[index];
+      const result: TransferResult = {
+        index,
+        source: item.source,
+        destination: item.destination,
+        method: 'none',
+        bytes: 0,
+      };
+      if (cancelled) {
+        result.error = Object.assign(new Error('Transfer cancelled'), { code: 'ECANCELED' });
+      } else {
+        try {
+          const { method, bytes } = await transferOne(item);
+          result.method = method;
+          result.bytes = bytes;
+          summary.files++;
+          summary.bytes += bytes;
+          if (method !== 'none') summary.methods[method]++;
+          progress.bytesDone += bytes;
+          progress.filesDone++;
+        } catch (error) {
+          result.error = error as NodeJS.ErrnoException;
+        }
+      }
+      if (result.error) summary.failed++;
+      summary.results.push(result);
+      progress.itemsDone++;
+      onProgress?.({ ...progress });
+    }
+    cancellation.release();
+    summary.cancelled = cancelled;
+    summary.timedOut = cancellation.timedOut();
+    summary.durationMs = Date.now() - startTime;
+    return summary;
+  })();
+
+  return {
+    done,
+    cancel: () => {
+      cancelled = true;
+    },
+  };
+}
@@ -0,0 +1,162 @@
+/**
+ * @fileoverview Incremental folder sizes with a persistent cache
+ *
+ * The native service remembers, per directory, its file bytes and
+ * subdirectories keyed by (device, inode, mtime). A measurement only lists
+ * directories whose mtime changed, and the last totals for any folder are
+ * available synchronously as an approximate answer while the exact one is
+ * computed. The cache is an mmap-friendly file that survives restarts.
+ *
+ * Usage:
+ * ```typescript
+ * configureFolderSizeCache(path.join(app.getPath('userData'), 'folder-sizes.cache'));
+ *
+ * const measurement = measureFolderSize(folder);
+ * if (measurement.approximate) showSize(measurement.approximate, { pending: true });
+ * showSize(await measurement.exact);
+ * ```
+ *
+ * Without the native module (e.g. Windows) there is no approximate answer
+ * and the exact one comes from a full walkDirectory pass.
+ *
+ * @module file-ops
+ */
+
+import { createLogger } from '@main/modules/utils/logger';
+import { NativeErrorCode } from '@shared/nativeErrorCodes';
+import { walkDirectory, WalkEntryType } from './directoryWalker';
+import { CancellationOptions, nativeCancellation, NativeCancellationToken } from './cancellation';
+import { loadFileOpsModule, toErrnoException } from './nativeModule';
+
+const logger = createLogger('FolderSize');
+
+export interface FolderSize {
+  bytes: number;
+  files: number;
+  /** Directories below the folder */
+  directories: number;
+}
+
+export interface FolderSizeResult extends FolderSize {
+  cancelled: boolean;
+  /** Stopped by deadlineMs; the totals are partial */
+  timedOut: boolean;
+  /** Directories read from disk; the rest were validated against the cache by mtime */
+  directoriesListed: number;
+  directoriesReused: number;
+  errorCount: number;
+  durationMs: number;
+  native: boolean;
+}
+
+export interface FolderSizeOptions extends CancellationOptions {
+  /**
+   * List every directory even if its cache record is current. Needed to
+   * notice files changed in place, which does not touch the directory mtime.
+   */
+  rescan?: boolean;
+}
+
+export interface FolderSizeMeasurement {
+  /** Totals from the last measurement of this folder, if any; may be stale */
+  approximate: FolderSize | null;
+  /** Rejects only if the folder itself cannot be opened */
+  exact: Promise<FolderSizeResult>;
+  cancel(): void;
+}
+
+interface NativeFolderSizeService {
+  estimate(root: string): FolderSize | null;
+  measure(
+    root: string,
+    options: { rescan?: boolean; cancellation?: NativeCancellationToken },
+    callback: (result: Omit<FolderSizeResult, 'native'>) => void
+  ): number;
+  cancel(id?: number): void;
+  pendingCount(): number;
+}
+
+interface NativeFolderSizeModule {
+  NativeFolderSizeService: new (cachePath?: string) => NativeFolderSizeService;
+}
+
+const nativeModule = loadFileOpsModule<NativeFolderSizeModule>();
+
+let cachePath: string | undefined;
+let service: NativeFolderSizeService | null = null;
+
+/**
+ * Set the cache file; call once at startup, before the first measurement.
+ * Without it the cache only lives for the current process.
+ */
+export function configureFolderSizeCache(path: string): void {
+  if (service) {
+    logger.warn('Folder size cache already in use; new path applies after restart');
+    return;
+  }
+  cachePath = path;
+}
+
+function getService(): NativeFolderSizeService | null {
+  if (!service && nativeModule) {
+    service = new nativeModule.NativeFolderSizeService(cachePath);
+  }
+  return service;
+}
+
+export function measureFolderSize(root: string, options: FolderSizeOptions = {}): FolderSizeMeasurement {
+  const native = getService();
+  if (!native) {
+    return measureFallback(root, options);
+  }
+
+  let id = 0;
+  const cancellation = nativeCancellation(options);
+  const exact = new Promise<FolderSizeResult>((resolve, reject) => {
+    try {
+      id = native.measure(root, { rescan: options.rescan, cancellation: cancellation.token }, result => {
+        cancellation.release();
+        resolve({ ...result, native: true });
+      });
+    } catch (error) {
+      cancellation.release();
+      reject(toErrnoException(error, NativeErrorCode.FOLDER_SIZE_FAILED, root));
+    }
+  });
+
+  return {
+    approximate: native.estimate(root),
+    exact,
+    cancel: () => {
+      if (id) native.cancel(id);
+    },
+  };
+}
+
+function measureFallback(root: string, options: FolderSizeOptions): FolderSizeMeasurement {
+  const size: FolderSize = { bytes: 0, files: 0, directories: 0 };
+  const { signal, deadlineMs } = options;
+  const walk = walkDirectory(root, { signal, deadlineMs }, batch => {
+    for (let i = 0; i < batch.types.length; i++) {
+      if (batch.types[i] === WalkEntryType.File) {
+        size.bytes += batch.sizes[i];
+        size.files++;
+      } else if (batch.types[i] === WalkEntryType.Directory) {
+        size.directories++;
+      }
+    }
+  });
+
+  const exact = walk.done.then(summary => ({
+    ...size,
+    cancelled: summary.cancelled,
+    timedOut: summary.timedOut,
+    directoriesListed: summary.directoriesRead,
+    directoriesReused: 0,
+    errorCount: summary.errorCount,
+    durationMs: summary.durationMs,
+    native: false,
+  }));
+
+  return { approximate: null, exact, cancel: walk.cancel };
+}
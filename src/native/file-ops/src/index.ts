@@ -0,0 +1,82 @@
+/**
+ * @fileoverview Native file operations for FileCataloger
+ *
+ * Supported platforms:
+ * - macOS (darwin) and Linux with the native module (POSIX openat/fstatat)
+ * - Everything else through an fs.promises fallback with the same API
+ *
+ * @module file-ops
+ */
+
+export {
+  walkDirectory,
+  entriesOf,
+  isNativeWalkerAvailable,
+  WalkEntryType,
+} from './directoryWalker';
+export type {
+  WalkOptions,
+  WalkBatch,
+  WalkEntry,
+  WalkError,
+  WalkSummary,
+  WalkHandle,
+} from './directoryWalker';
+export { measureFolderSize, configureFolderSizeCache } from './folderSize';
+export type {
+  FolderSize,
+  FolderSizeResult,
+  FolderSizeOptions,
+  FolderSizeMeasurement,
+} from './folderSize';
+export {
+  sniffContentTypes,
+  contentCategory,
+  contentTypeInfo,
+  isNativeSnifferAvailable,
+  ContentType,
+  ContentCategory,
+} from './contentSniffer';
+export type { ContentTypeInfo } from './contentSniffer';
+export { extractMediaMetadata, isNativeMediaMetadataAvailable } from './mediaMetadata';
+export type { MediaMetadata } from './mediaMetadata';
+export { statFileList, statFileListChunks, isNativeFileListAvailable } from './fileList';
+export type { CancellationOptions } from './cancellation';
+export { renamePaths, unlinkPaths, getIoEngine, isNativePathOpsAvailable } from './pathOps';
+export type { IoEngine } from './pathOps';
+export {
+  openSessionStore,
+  isNativeSessionStoreAvailable,
+  SessionStore,
+} from './sessionStore';
+export type {
+  RecentFile,
+  WindowBounds,
+  SessionUsageStats,
+  SessionStoreStats,
+} from './sessionStore';
+export { createShelfStore, isNativeShelfStoreAvailable, ShelfItemKind } from './shelfStore';
+export type {
+  ShelfStore,
+  ShelfItemInput,
+  ShelfItemRecord,
+  ShelfStoreStats,
+} from './shelfStore';
+export { transferFiles, isNativeTransferAvailable } from './fileTransfer';
+export type {
+  TransferMethod,
+  TransferItem,
+  TransferOptions,
+  TransferResult,
+  TransferProgress,
+  TransferSummary,
+  TransferHandle,
+} from './fileTransfer';
+export { createZipArchive, isNativeZipAvailable } from './zipArchive';
+export type {
+  ZipSource,
+  ZipArchiveOptions,
+  ZipProgress,
+  ZipSummary,
+  ZipHandle,
+} from './zipArchive';
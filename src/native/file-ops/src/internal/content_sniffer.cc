@@ -0,0 +1,448 @@
+/**
+ * @file content_sniffer.cc
+ * @brief Magic-number decision table and bulk sniffing
+ */
+
+#include "content_sniffer.h"
+
+#include <sys/stat.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+
+namespace FileCataloger {
+
+namespace {
+
+// Second look at a container once its magic matched; Unknown means no match
+using Refiner = ContentType (*)(const uint8_t* data, size_t size);
+
+struct Signature {
+    uint16_t offset;
+    uint8_t length;
+    const char* bytes;
+    const char* mask;       // nullptr: compare every bit
+    ContentType type;       // result when there is no refiner
+    Refiner refine;
+};
+
+uint32_t ReadU16LE(const uint8_t* p) { return p[0] | (p[1] << 8); }
+uint32_t ReadU32BE(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+bool HasAt(const uint8_t* data, size_t size, size_t offset, const char* text) {
+    size_t length = strlen(text);
+    return offset + length <= size && memcmp(data + offset, text, length) == 0;
+}
+
+bool Contains(const uint8_t* data, size_t size, const char* text) {
+    size_t length = strlen(text);
+    for (size_t i = 0; i + length <= size; i++) {
+        if (memcmp(data + i, text, length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ContentType RefineRiff(const uint8_t* data, size_t size) {
+    if (HasAt(data, size, 8, "WEBP")) return ContentType::Webp;
+    if (HasAt(data, size, 8, "WAVE")) return ContentType::Wav;
+    if (HasAt(data, size, 8, "AVI ")) return ContentType::Avi;
+    return ContentType::Unknown;
+}
+
+ContentType RefineForm(const uint8_t* data, size_t size) {
+    return HasAt(data, size, 8, "AIFF") || HasAt(data, size, 8, "AIFC") ? ContentType::Aiff : ContentType::Unknown;
+}
+
+// ISO base media file: major brand at 8, compatible brands from 16 to the box end
+ContentType RefineFtyp(const uint8_t* data, size_t size) {
+    if (size < 12) {
+        return ContentType::Unknown;
+    }
+    const size_t boxEnd = std::min<size_t>(ReadU32BE(data), size);
+    auto hasBrand = [&](const char* brand) {
+        if (HasAt(data, size, 8, brand)) {
+            return true;
+        }
+        for (size_t offset = 16; offset + 4 <= boxEnd; offset += 4) {
+            if (memcmp(data + offset, brand, 4) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (const char* brand : {"heic", "heix", "heim", "heis", "hevc", "hevx"}) {
+        if (HasAt(data, size, 8, brand)) return ContentType::Heic;
+    }
+    if (HasAt(data, size, 8, "avif") || HasAt(data, size, 8, "avis")) return ContentType::Avif;
+    if (HasAt(data, size, 8, "mif1") || HasAt(data, size, 8, "msf1")) {
+        return hasBrand("avif") ? ContentType::Avif : ContentType::Heic;
+    }
+    if (HasAt(data, size, 8, "qt  ")) return ContentType::Mov;
+    if (HasAt(data, size, 8, "M4A ") || HasAt(data, size, 8, "M4B ") || HasAt(data, size, 8, "M4P ")) {
+        return ContentType::M4a;
+    }
+    return ContentType::Mp4;
+}
+
+// First local file header: name at 30, data after name and extra field
+ContentType RefineZip(const uint8_t* data, size_t size) {
+    if (size < 30) {
+        return ContentType::Zip;
+    }
+    const size_t nameLength = ReadU16LE(data + 26);
+    const size_t extraLength = ReadU16LE(data + 28);
+    const size_t contentOffset = 30 + nameLength + extraLength;
+
+    if (nameLength == 8 && HasAt(data, size, 30, "mimetype")) {
+        if (HasAt(data, size, contentOffset, "application/epub+zip")) return ContentType::Epub;
+        if (HasAt(data, size, contentOffset, "application/vnd.oasis.opendocument")) return ContentType::OpenDocument;
+    }
+    if (HasAt(data, size, 30, "word/")) return ContentType::Docx;
+    if (HasAt(data, size, 30, "xl/")) return ContentType::Xlsx;
+    if (HasAt(data, size, 30, "ppt/")) return ContentType::Pptx;
+    if (HasAt(data, size, 30, "[Content_Types].xml") || HasAt(data, size, 30, "_rels/")) return ContentType::Ooxml;
+    return ContentType::Zip;
+}
+
+ContentType RefineEbml(const uint8_t* data, size_t size) {
+    // The DocType element sits in the EBML header, well inside the first 64 bytes
+    return Contains(data, std::min<size_t>(size, 64), "webm") ? ContentType::Webm : ContentType::Matroska;
+}
+
+// 0xCAFEBABE is both a fat Mach-O and a Java class; the next word is an
+// architecture count (small) for the former and a class file version (>= 45)
+ContentType RefineCafebabe(const uint8_t* data, size_t size) {
+    if (size < 8) {
+        return ContentType::Unknown;
+    }
+    return ReadU32BE(data + 4) < 45 ? ContentType::MachO : ContentType::JavaClass;
+}
+
+ContentType RefineBmp(const uint8_t* data, size_t size) {
+    if (size < 18 || ReadU32BE(data + 6) != 0) {
+        return ContentType::Unknown;
+    }
+    const uint32_t dibSize = data[14] | (data[15] << 8) | (data[16] << 16) | (static_cast<uint32_t>(data[17]) << 24);
+    switch (dibSize) {
+        case 12: case 40: case 52: case 56: case 64: case 108: case 124:
+            return ContentType::Bmp;
+        default:
+            return ContentType::Unknown;
+    }
+}
+
+ContentType RefineIco(const uint8_t* data, size_t size) {
+    if (size < 22) {
+        return ContentType::Unknown;
+    }
+    const uint32_t count = ReadU16LE(data + 4);
+    return count > 0 && count <= 256 && data[9] == 0 ? ContentType::Ico : ContentType::Unknown;
+}
+
+// MPEG audio frame sync (11 bits); layer 0 is an AAC ADTS header
+ContentType RefineMpegAudio(const uint8_t* data, size_t size) {
+    // FF FE is also the UTF-16LE byte order mark, far more common than Layer I audio
+    if (size < 4 || data[1] == 0xFE) {
+        return ContentType::Unknown;
+    }
+    const uint32_t layer = (data[1] >> 1) & 3;
+    if (layer == 0) {
+        return (data[1] & 0xF6) == 0xF0 ? ContentType::Aac : ContentType::Unknown;
+    }
+    const uint32_t bitrate = data[2] >> 4;
+    const uint32_t sampleRate = (data[2] >> 2) & 3;
+    return bitrate != 0xF && sampleRate != 3 ? ContentType::Mp3 : ContentType::Unknown;
+}
+
+// Order matters within a first byte: more specific signatures come first
+const Signature kSignatures[] = {
+    // Images
+    {0, 3, "\xFF\xD8\xFF", nullptr, ContentType::Jpeg, nullptr},
+    {0, 8, "\x89PNG\r\n\x1A\n", nullptr, ContentType::Png, nullptr},
+    {0, 6, "GIF87a", nullptr, ContentType::Gif, nullptr},
+    {0, 6, "GIF89a", nullptr, ContentType::Gif, nullptr},
+    {0, 4, "II*\0", nullptr, ContentType::Tiff, nullptr},
+    {0, 4, "MM\0*", nullptr, ContentType::Tiff, nullptr},
+    {0, 4, "8BPS", nullptr, ContentType::Psd, nullptr},
+    {0, 2, "BM", nullptr, ContentType::Unknown, RefineBmp},
+    {0, 4, "\0\0\1\0", nullptr, ContentType::Unknown, RefineIco},
+    {4, 4, "ftyp", nullptr, ContentType::Unknown, RefineFtyp},
+    {0, 4, "RIFF", nullptr, ContentType::Unknown, RefineRiff},
+
+    // Archives
+    {0, 4, "PK\x03\x04", nullptr, ContentType::Zip, RefineZip},
+    {0, 4, "PK\x05\x06", nullptr, ContentType::Zip, nullptr},
+    {0, 2, "\x1F\x8B", nullptr, ContentType::Gzip, nullptr},
+    {0, 3, "BZh", nullptr, ContentType::Bzip2, nullptr},
+    {0, 6, "\xFD" "7zXZ\0", nullptr, ContentType::Xz, nullptr},
+    {0, 4, "\x28\xB5\x2F\xFD", nullptr, ContentType::Zstd, nullptr},
+    {0, 6, "7z\xBC\xAF\x27\x1C", nullptr, ContentType::SevenZip, nullptr},
+    {0, 6, "Rar!\x1A\x07", nullptr, ContentType::Rar, nullptr},
+    {257, 5, "ustar", nullptr, ContentType::Tar, nullptr},
+
+    // Documents
+    {0, 5, "%PDF-", nullptr, ContentType::Pdf, nullptr},
+    {0, 5, "{\\rtf", nullptr, ContentType::Rtf, nullptr},
+    {0, 8, "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", nullptr, ContentType::OleCompound, nullptr},
+    {0, 16, "SQLite format 3\0", nullptr, ContentType::Sqlite, nullptr},
+
+    // Media
+    {0, 3, "ID3", nullptr, ContentType::Mp3, nullptr},
+    {0, 2, "\xFF\xE0", "\xFF\xE0", ContentType::Unknown, RefineMpegAudio},
+    {0, 4, "fLaC", nullptr, ContentType::Flac, nullptr},
+    {0, 4, "OggS", nullptr, ContentType::Ogg, nullptr},
+    {0, 4, "FORM", nullptr, ContentType::Unknown, RefineForm},
+    {0, 4, "MThd", nullptr, ContentType::Midi, nullptr},
+    {0, 4, "\x1A\x45\xDF\xA3", nullptr, ContentType::Matroska, RefineEbml},
+
+    // Executables
+    {0, 4, "\x7F" "ELF", nullptr, ContentType::Elf, nullptr},
+    {0, 4, "\xFE\xED\xFA\xCE", nullptr, ContentType::MachO, nullptr},
+    {0, 4, "\xFE\xED\xFA\xCF", nullptr, ContentType::MachO, nullptr},
+    {0, 4, "\xCE\xFA\xED\xFE", nullptr, ContentType::MachO, nullptr},
+    {0, 4, "\xCF\xFA\xED\xFE", nullptr, ContentType::MachO, nullptr},
+    {0, 4, "\xCA\xFE\xBA\xBE", nullptr, ContentType::Unknown, RefineCafebabe},
+    {0, 4, "\0asm", nullptr, ContentType::Wasm, nullptr},
+    {0, 2, "MZ", nullptr, ContentType::Pe, nullptr},
+    {0, 2, "#!", nullptr, ContentType::Script, nullptr},
+};
+
+constexpr size_t kSignatureCount = sizeof(kSignatures) / sizeof(kSignatures[0]);
+static_assert(kSignatureCount < 256, "signature indices are stored as uint8_t");
+
+bool Matches(const Signature& signature, const uint8_t* data, size_t size) {
+    if (signature.offset + signature.length > size) {
+        return false;
+    }
+    const uint8_t* p = data + signature.offset;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(signature.bytes);
+    const auto* mask = reinterpret_cast<const uint8_t*>(signature.mask);
+    for (size_t i = 0; i < signature.length; i++) {
+        if ((mask ? (p[i] & mask[i]) : p[i]) != bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Signatures at offset 0 bucketed by every first byte they accept; the rest
+// are checked for every file, after the bucket
+class DecisionTable {
+public:
+    DecisionTable() {
+        for (size_t i = 0; i < kSignatureCount; i++) {
+            const Signature& signature = kSignatures[i];
+            if (signature.offset != 0) {
+                anchored_.push_back(static_cast<uint8_t>(i));
+                continue;
+            }
+            const uint8_t first = static_cast<uint8_t>(signature.bytes[0]);
+            const uint8_t mask = signature.mask ? static_cast<uint8_t>(signature.mask[0]) : 0xFF;
+            for (unsigned value = 0; value < 256; value++) {
+                if ((value & mask) == first) {
+                    buckets_[value].push_back(static_cast<uint8_t>(i));
+                }
+            }
+        }
+    }
+
+    ContentType Classify(const uint8_t* data, size_t size) const {
+        for (uint8_t index : buckets_[data[0]]) {
+            if (ContentType type = Apply(kSignatures[index], data, size); type != ContentType::Unknown) {
+                return type;
+            }
+        }
+        for (uint8_t index : anchored_) {
+            if (ContentType type = Apply(kSignatures[index], data, size); type != ContentType::Unknown) {
+                return type;
+            }
+        }
+        return ContentType::Unknown;
+    }
+
+private:
+    static ContentType Apply(const Signature& signature, const uint8_t* data, size_t size) {
+        if (!Matches(signature, data, size)) {
+            return ContentType::Unknown;
+        }
+        return signature.refine ? signature.refine(data, size) : signature.type;
+    }
+
+    std::array<std::vector<uint8_t>, 256> buckets_;
+    std::vector<uint8_t> anchored_;
+};
+
+const DecisionTable& Table() {
+    static const DecisionTable table;
+    return table;
+}
+
+bool StartsWithNoCase(const uint8_t* data, size_t size, const char* text) {
+    size_t length = strlen(text);
+    if (length > size) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (tolower(data[i]) != text[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// UTF-8 without NULs or unusual control characters; a sequence cut off by
+// the end of the header is accepted
+bool LooksLikeText(const uint8_t* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t c = data[i];
+        if (c < 0x80) {
+            if (c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\v' && c != '\b' && c != 0x1B) {
+                return false;
+            }
+            i++;
+            continue;
+        }
+        size_t continuation;
+        if (c >= 0xC2 && c <= 0xDF) continuation = 1;
+        else if (c >= 0xE0 && c <= 0xEF) continuation = 2;
+        else if (c >= 0xF0 && c <= 0xF4) continuation = 3;
+        else return false;
+        for (size_t k = 1; k <= continuation; k++) {
+            if (i + k >= size) {
+                return true;
+            }
+            if ((data[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += continuation + 1;
+    }
+    return true;
+}
+
+ContentType ClassifyText(const uint8_t* data, size_t size) {
+    if (size >= 2 && ((data[0] == 0xFF && data[1] == 0xFE) || (data[0] == 0xFE && data[1] == 0xFF))) {
+        return ContentType::Text;  // UTF-16 with BOM
+    }
+    if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        data += 3;
+        size -= 3;
+    }
+    if (!LooksLikeText(data, size)) {
+        return ContentType::Unknown;
+    }
+
+    while (size > 0 && (*data == ' ' || *data == '\t' || *data == '\r' || *data == '\n')) {
+        data++;
+        size--;
+    }
+    if (StartsWithNoCase(data, size, "<?xml")) {
+        return Contains(data, size, "<svg") ? ContentType::Svg : ContentType::Xml;
+    }
+    if (StartsWithNoCase(data, size, "<svg") || StartsWithNoCase(data, size, "<!doctype svg")) {
+        return ContentType::Svg;
+    }
+    if (StartsWithNoCase(data, size, "<!doctype html") || StartsWithNoCase(data, size, "<html")) {
+        return ContentType::Html;
+    }
+    return ContentType::Text;
+}
+
+} // namespace
+
+ContentType ClassifyContent(const uint8_t* data, size_t size) {
+    if (size == 0) {
+        return ContentType::Empty;
+    }
+    ContentType type = Table().Classify(data, size);
+    return type != ContentType::Unknown ? type : ClassifyText(data, size);
+}
+
+namespace {
+
+ContentType TypeOf(const IoHeader& header, const uint8_t* bytes) {
+    const IoStat& stat = header.stat;
+    if (stat.error != 0) {
+        return ContentType::Unreadable;
+    }
+    if (S_ISDIR(stat.mode)) {
+        return ContentType::Directory;
+    }
+    if (!S_ISREG(stat.mode)) {
+        return ContentType::Special;
+    }
+    if (stat.size == 0) {
+        return ContentType::Empty;
+    }
+    if (header.readError != 0) {
+        return ContentType::Unreadable;
+    }
+    return ClassifyContent(bytes, header.length);
+}
+
+} // namespace
+
+ContentType SniffFile(const std::string& path) {
+    IoHeader header;
+    uint8_t bytes[SNIFF_BYTES];
+    SyscallIoEngine().ReadHeaders(&path, 1, SNIFF_BYTES, &header, bytes);
+    return TypeOf(header, bytes);
+}
+
+void SniffFiles(WorkStealingPool& pool, std::shared_ptr<SniffBatch> batch,
+                std::function<void(std::shared_ptr<SniffBatch>)> done) {
+    // Enough files per task to amortize scheduling, few enough to spread
+    // a drop of a few hundred files over every worker
+    constexpr size_t kChunk = 32;
+
+    const size_t count = batch->paths.size();
+    batch->types.assign(count, ContentType::Unknown);
+    if (count == 0) {
+        done(std::move(batch));
+        return;
+    }
+
+    struct State {
+        std::shared_ptr<SniffBatch> batch;
+        std::function<void(std::shared_ptr<SniffBatch>)> done;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> skipped{false};
+    };
+    const size_t chunks = (count + kChunk - 1) / kChunk;
+    auto state = std::make_shared<State>();
+    state->batch = std::move(batch);
+    state->done = std::move(done);
+    state->remaining.store(chunks, std::memory_order_relaxed);
+
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        pool.Submit([state, chunk, count] {
+            SniffBatch& batch = *state->batch;
+            if (batch.cancellation.IsCancelled()) {
+                state->skipped.store(true, std::memory_order_relaxed);
+            } else {
+                const size_t begin = chunk * kChunk;
+                const size_t end = std::min(count, begin + kChunk);
+                IoHeader headers[kChunk];
+                uint8_t bytes[kChunk * SNIFF_BYTES];
+                IoEngine& engine = batch.engine ? *batch.engine : DefaultIoEngine();
+                engine.ReadHeaders(batch.paths.data() + begin, end - begin, SNIFF_BYTES, headers, bytes);
+                for (size_t i = begin; i < end; i++) {
+                    batch.types[i] = TypeOf(headers[i - begin], bytes + (i - begin) * SNIFF_BYTES);
+                }
+            }
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                batch.cancelled = state->skipped.load(std::memory_order_relaxed);
+                state->done(std::move(state->batch));
+            }
+        });
+    }
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,146 @@
+/**
+ * @file content_sniffer.h
+ * @brief Bulk file type detection from magic numbers
+ *
+ * Each file is opened, its first SNIFF_BYTES bytes are read with a single
+ * pread, and the header is classified against a table of magic numbers.
+ * The table is compiled once into 256 buckets keyed by the first header
+ * byte, so a file is only compared against the few signatures that can
+ * match it. Container formats (RIFF, ISO-BMFF, ZIP, EBML) get a second look
+ * at their brand or first entry. Headers that match nothing and look like
+ * UTF-8 are classified as text, with HTML, XML and SVG told apart.
+ *
+ * SniffFiles spreads a batch over a WorkStealingPool in chunks and reads
+ * each chunk through an IoEngine (io_engine.h): on Linux one io_uring
+ * submission per window of files, elsewhere a few syscalls per file.
+ * Devices, FIFOs, sockets and empty files are classified from their stat
+ * without being opened.
+ *
+ * ContentType values are stable: they are passed to JS as a Uint8Array and
+ * mirrored in file-ops/src/contentSniffer.ts. Each category owns a range of
+ * 32 codes (see CategoryOf).
+ */
+
+#ifndef FILE_OPS_CONTENT_SNIFFER_H
+#define FILE_OPS_CONTENT_SNIFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "io_engine.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+enum class ContentType : uint8_t {
+    Unknown = 0,
+    Unreadable = 1,     // open or read failed
+    Directory = 2,
+    Empty = 3,
+    Special = 4,        // device, FIFO or socket; never read
+
+    Text = 32,
+    Html = 33,
+    Xml = 34,
+
+    Jpeg = 64,
+    Png = 65,
+    Gif = 66,
+    Webp = 67,
+    Bmp = 68,
+    Tiff = 69,
+    Heic = 70,
+    Avif = 71,
+    Ico = 72,
+    Psd = 73,
+    Svg = 74,
+
+    Zip = 96,
+    Gzip = 97,
+    Bzip2 = 98,
+    Xz = 99,
+    Zstd = 100,
+    SevenZip = 101,
+    Rar = 102,
+    Tar = 103,
+
+    Pdf = 128,
+    Rtf = 129,
+    OleCompound = 130,  // legacy .doc/.xls/.ppt/.msg
+    Epub = 131,
+    OpenDocument = 132,
+    Sqlite = 133,
+    Ooxml = 134,        // Office Open XML whose kind is not visible in the header
+    Docx = 135,
+    Xlsx = 136,
+    Pptx = 137,
+
+    Mp3 = 160,
+    Aac = 161,
+    Flac = 162,
+    Ogg = 163,
+    Wav = 164,
+    Aiff = 165,
+    Midi = 166,
+    M4a = 167,
+    Mp4 = 168,
+    Mov = 169,
+    Avi = 170,
+    Matroska = 171,
+    Webm = 172,
+
+    Elf = 192,
+    MachO = 193,
+    Pe = 194,
+    Wasm = 195,
+    Script = 196,       // #! interpreter line
+    JavaClass = 197
+};
+
+enum class ContentCategory : uint8_t {
+    Other = 0,          // Unknown, Unreadable, Directory, Empty, Special
+    Text = 1,
+    Image = 2,
+    Archive = 3,
+    Document = 4,
+    Media = 5,
+    Executable = 6
+};
+
+inline ContentCategory CategoryOf(ContentType type) {
+    uint8_t range = static_cast<uint8_t>(type) >> 5;
+    return range <= static_cast<uint8_t>(ContentCategory::Executable) ? static_cast<ContentCategory>(range)
+                                                                       : ContentCategory::Other;
+}
+
+// Bytes read per file: enough for the tar magic at offset 257 and for
+// the first entry of a ZIP or the brands of an ISO-BMFF file
+constexpr size_t SNIFF_BYTES = 512;
+
+// Classify a file header; size may be shorter than SNIFF_BYTES
+ContentType ClassifyContent(const uint8_t* data, size_t size);
+
+// Open, read and classify one file. FIFOs and devices are never read.
+ContentType SniffFile(const std::string& path);
+
+struct SniffBatch {
+    std::vector<std::string> paths;
+    std::vector<ContentType> types;   // filled by SniffFiles, same order as paths
+    CancellationToken cancellation;   // checked before each chunk of files
+    bool cancelled = false;           // chunks were skipped; their types stay Unknown
+    IoEngine* engine = nullptr;       // DefaultIoEngine() when null
+};
+
+// Classify every path on the pool. done runs exactly once, on a pool thread
+// (or the calling thread for an empty batch), after all types are written.
+void SniffFiles(WorkStealingPool& pool, std::shared_ptr<SniffBatch> batch,
+                std::function<void(std::shared_ptr<SniffBatch>)> done);
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_CONTENT_SNIFFER_H
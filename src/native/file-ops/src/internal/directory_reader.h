@@ -0,0 +1,115 @@
+/**
+ * @file directory_reader.h
+ * @brief Shared POSIX directory listing helpers for the file-ops module
+ *
+ * ReadDirectory lists one open directory with getdents64 on Linux, reusing
+ * a per-thread 64KB buffer, and with fdopendir/readdir elsewhere.
+ */
+
+#ifndef FILE_OPS_DIRECTORY_READER_H
+#define FILE_OPS_DIRECTORY_READER_H
+
+#include <cerrno>
+#include <cstdint>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+namespace FileCataloger {
+
+constexpr int kOpenDirectoryFlags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+
+inline bool IsDotOrDotDot(const char* name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+inline int64_t MtimeNs(const struct stat& st) {
+#if defined(__APPLE__)
+    const struct timespec& ts = st.st_mtimespec;
+#else
+    const struct timespec& ts = st.st_mtim;
+#endif
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+#if defined(__linux__)
+namespace detail {
+
+constexpr size_t kDirentBufferSize = 64 * 1024;
+
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+} // namespace detail
+#endif
+
+/**
+ * Calls visit(name, d_type) for every entry of dirFd except "." and "..".
+ * visit returns false to stop early. Always closes dirFd. Returns 0, or
+ * the errno that ended the listing.
+ */
+template <typename Visit>
+int ReadDirectory(int dirFd, Visit&& visit) {
+#if defined(__linux__)
+    thread_local std::unique_ptr<char[]> buffer(new char[detail::kDirentBufferSize]);
+
+    int error = 0;
+    for (bool done = false; !done;) {
+        long bytes = syscall(SYS_getdents64, dirFd, buffer.get(), detail::kDirentBufferSize);
+        if (bytes == 0) {
+            break;
+        }
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = errno;
+            break;
+        }
+
+        for (long offset = 0; offset < bytes;) {
+            auto* dirent = reinterpret_cast<detail::LinuxDirent64*>(buffer.get() + offset);
+            offset += dirent->d_reclen;
+            if (!IsDotOrDotDot(dirent->d_name) && !visit(dirent->d_name, dirent->d_type)) {
+                done = true;
+                break;
+            }
+        }
+    }
+    close(dirFd);
+    return error;
+#else
+    // fdopendir takes ownership of dirFd; callers may still use it for fstatat
+    DIR* dir = fdopendir(dirFd);
+    if (!dir) {
+        int error = errno;
+        close(dirFd);
+        return error;
+    }
+    errno = 0;
+    while (struct dirent* dirent = readdir(dir)) {
+        if (!IsDotOrDotDot(dirent->d_name) && !visit(dirent->d_name, dirent->d_type)) {
+            break;
+        }
+        errno = 0;
+    }
+    int error = errno;
+    closedir(dir);
+    return error;
+#endif
+}
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_DIRECTORY_READER_H
@@ -0,0 +1,335 @@
+/**
+ * @file directory_walker.cc
+ * @brief POSIX implementation of the parallel directory walker
+ */
+
+#include "directory_walker.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "directory_reader.h"
+
+namespace FileCataloger {
+
+struct DirectoryWalker::ScratchEntry {
+    uint32_t nameEnd;
+    EntryType type;
+    double size;
+    double mtimeMs;
+};
+
+namespace {
+
+constexpr size_t kCancelCheckInterval = 256;
+
+EntryType TypeFromDirent(unsigned char type) {
+    switch (type) {
+        case DT_REG: return EntryType::File;
+        case DT_DIR: return EntryType::Directory;
+        case DT_LNK: return EntryType::Symlink;
+        case DT_UNKNOWN: return EntryType::Unknown;
+        default: return EntryType::Other;
+    }
+}
+
+EntryType TypeFromMode(mode_t mode) {
+    if (S_ISREG(mode)) return EntryType::File;
+    if (S_ISDIR(mode)) return EntryType::Directory;
+    if (S_ISLNK(mode)) return EntryType::Symlink;
+    return EntryType::Other;
+}
+
+double MtimeMs(const struct stat& st) {
+    return static_cast<double>(MtimeNs(st)) / 1e6;
+}
+
+} // namespace
+
+bool MatchGlob(std::string_view pattern, std::string_view name) {
+    size_t p = 0;
+    size_t n = 0;
+    size_t starPattern = std::string_view::npos;
+    size_t starName = 0;
+
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starName = n;
+        } else if (starPattern != std::string_view::npos) {
+            // Let the last '*' absorb one more byte and retry
+            p = starPattern + 1;
+            n = ++starName;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+std::shared_ptr<DirectoryWalker> DirectoryWalker::Create(std::string root,
+                                                         WalkOptions options,
+                                                         BatchSink onBatch,
+                                                         DoneSink onDone) {
+    return std::shared_ptr<DirectoryWalker>(
+        new DirectoryWalker(std::move(root), std::move(options), std::move(onBatch), std::move(onDone)));
+}
+
+DirectoryWalker::DirectoryWalker(std::string root, WalkOptions options, BatchSink onBatch, DoneSink onDone)
+    : root_(std::move(root)),
+      options_(std::move(options)),
+      onBatch_(std::move(onBatch)),
+      onDone_(std::move(onDone)),
+      cancellation_(options_.cancellation) {
+    if (options_.batchSize == 0) {
+        options_.batchSize = 1;
+    }
+}
+
+DirectoryWalker::~DirectoryWalker() {
+    if (rootFd_ >= 0) {
+        close(rootFd_);
+    }
+}
+
+int DirectoryWalker::Start(WorkStealingPool& pool) {
+    int fd = open(root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno;
+    }
+
+    rootFd_ = fd;
+    pool_ = &pool;
+    startTime_ = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(finishMutex_);
+        started_ = true;
+    }
+
+    SubmitDirectory(std::string(), 0);
+    return 0;
+}
+
+void DirectoryWalker::Cancel() {
+    cancellation_.Cancel();
+}
+
+void DirectoryWalker::WaitUntilFinished() {
+    std::unique_lock<std::mutex> lock(finishMutex_);
+    finishCv_.wait(lock, [this] { return !started_ || finished_; });
+}
+
+bool DirectoryWalker::IsFinished() const {
+    std::lock_guard<std::mutex> lock(finishMutex_);
+    return finished_;
+}
+
+void DirectoryWalker::SubmitDirectory(std::string relativePath, uint32_t depth) {
+    pendingTasks_.fetch_add(1, std::memory_order_relaxed);
+    pool_->Submit([self = shared_from_this(), path = std::move(relativePath), depth] {
+        self->ScanDirectory(path, depth);
+        self->TaskDone();
+    });
+}
+
+bool DirectoryWalker::IsIgnored(std::string_view name) const {
+    for (const auto& pattern : options_.ignorePatterns) {
+        if (MatchGlob(pattern, name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DirectoryWalker::ScanDirectory(const std::string& relativePath, uint32_t depth) {
+    if (IsCancelled()) {
+        return;
+    }
+
+    int dirFd = openat(rootFd_, relativePath.empty() ? "." : relativePath.c_str(), kOpenDirectoryFlags);
+    if (dirFd < 0) {
+        RecordError(relativePath, errno);
+        return;
+    }
+    directoriesRead_.fetch_add(1, std::memory_order_relaxed);
+
+    // Per-worker buffers reused by every directory that worker scans
+    thread_local std::string names;
+    thread_local std::vector<ScratchEntry> entries;
+    entries.clear();
+    names.clear();
+    std::vector<std::string> subdirectories;
+
+    const uint32_t entryDepth = depth + 1;
+    const bool descend = options_.maxDepth == 0 || entryDepth < options_.maxDepth;
+    size_t sinceCancelCheck = 0;
+
+    int error = ReadDirectory(dirFd, [&](const char* name, unsigned char direntType) {
+        if (++sinceCancelCheck >= kCancelCheckInterval) {
+            sinceCancelCheck = 0;
+            if (IsCancelled()) {
+                return false;
+            }
+        }
+
+        size_t nameLength = strlen(name);
+        std::string_view nameView(name, nameLength);
+        if (!options_.ignorePatterns.empty() && IsIgnored(nameView)) {
+            return true;
+        }
+
+        ScratchEntry entry{0, TypeFromDirent(direntType), 0, 0};
+        if (options_.statEntries || entry.type == EntryType::Unknown) {
+            struct stat st;
+            if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                entry.type = TypeFromMode(st.st_mode);
+                if (options_.statEntries) {
+                    entry.size = static_cast<double>(st.st_size);
+                    entry.mtimeMs = MtimeMs(st);
+                }
+            } else if (errno == ENOENT) {
+                return true;  // Removed between listing and stat
+            }
+        }
+
+        names.append(nameView);
+        entry.nameEnd = static_cast<uint32_t>(names.size());
+        entries.push_back(entry);
+
+        if (descend && entry.type == EntryType::Directory) {
+            std::string child;
+            child.reserve(relativePath.size() + 1 + nameLength);
+            if (!relativePath.empty()) {
+                child.append(relativePath).push_back('/');
+            }
+            child.append(nameView);
+            subdirectories.push_back(std::move(child));
+        }
+
+        // Very large directories are handed out in several pieces
+        if (entries.size() >= options_.batchSize) {
+            AppendEntries(relativePath, entryDepth, entries, names);
+            entries.clear();
+            names.clear();
+        }
+        return true;
+    });
+    if (error != 0) {
+        RecordError(relativePath, error);
+    }
+
+    if (!entries.empty() && !IsDropping()) {
+        AppendEntries(relativePath, entryDepth, entries, names);
+    }
+    if (IsCancelled()) {
+        return;
+    }
+
+    for (auto& child : subdirectories) {
+        SubmitDirectory(std::move(child), entryDepth);
+    }
+}
+
+void DirectoryWalker::AppendEntries(const std::string& relativePath, uint32_t depth,
+                                    const std::vector<ScratchEntry>& entries, const std::string& names) {
+    // Usually empty; holds at most two batches since entries.size() <= batchSize
+    std::vector<std::unique_ptr<WalkBatch>> full;
+    {
+        std::lock_guard<std::mutex> lock(batchMutex_);
+        if (IsDropping()) {
+            return;
+        }
+
+        size_t next = 0;
+        uint32_t nameBegin = 0;
+        while (next < entries.size()) {
+            if (!batch_) {
+                batch_ = std::make_unique<WalkBatch>();
+                batch_->Reserve(options_.batchSize);
+            }
+
+            WalkBatch& batch = *batch_;
+            uint32_t directory = static_cast<uint32_t>(batch.directories.size());
+            batch.directories.push_back(relativePath);
+            batch.directoryDepths.push_back(depth);
+
+            size_t count = std::min(entries.size() - next, options_.batchSize - batch.size());
+            uint32_t nameEnd = entries[next + count - 1].nameEnd;
+            uint32_t base = static_cast<uint32_t>(batch.names.size()) - nameBegin;
+            batch.names.append(names, nameBegin, nameEnd - nameBegin);
+            for (size_t i = next; i < next + count; i++) {
+                const ScratchEntry& entry = entries[i];
+                batch.directoryIndex.push_back(directory);
+                batch.nameEnds.push_back(base + entry.nameEnd);
+                batch.types.push_back(static_cast<uint8_t>(entry.type));
+                batch.sizes.push_back(entry.size);
+                batch.mtimesMs.push_back(entry.mtimeMs);
+            }
+            next += count;
+            nameBegin = nameEnd;
+
+            if (batch.size() >= options_.batchSize) {
+                full.push_back(std::move(batch_));
+            }
+        }
+    }
+
+    entries_.fetch_add(entries.size(), std::memory_order_relaxed);
+    for (auto& batch : full) {
+        onBatch_(std::move(batch));
+    }
+}
+
+void DirectoryWalker::RecordError(const std::string& relativePath, int code) {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    errorCount_++;
+    if (errors_.size() < WalkSummary::MAX_REPORTED_ERRORS) {
+        errors_.push_back({relativePath, code});
+    }
+}
+
+void DirectoryWalker::TaskDone() {
+    if (pendingTasks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Finish();
+    }
+}
+
+void DirectoryWalker::Finish() {
+    std::unique_ptr<WalkBatch> remainder;
+    {
+        std::lock_guard<std::mutex> lock(batchMutex_);
+        remainder = std::move(batch_);
+    }
+    if (remainder && !remainder->empty() && !IsDropping()) {
+        onBatch_(std::move(remainder));
+    }
+
+    auto summary = std::make_unique<WalkSummary>();
+    summary->entries = entries_.load(std::memory_order_relaxed);
+    summary->directoriesRead = directoriesRead_.load(std::memory_order_relaxed);
+    summary->cancelled = IsCancelled();
+    summary->timedOut = cancellation_.Reason() == CancelReason::DeadlineExceeded;
+    summary->durationMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime_).count();
+    {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        summary->errorCount = errorCount_;
+        summary->errors = std::move(errors_);
+    }
+
+    onDone_(std::move(summary));
+
+    {
+        std::lock_guard<std::mutex> lock(finishMutex_);
+        finished_ = true;
+    }
+    finishCv_.notify_all();
+}
+
+} // namespace FileCataloger
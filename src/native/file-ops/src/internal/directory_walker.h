@@ -0,0 +1,191 @@
+/**
+ * @file directory_walker.h
+ * @brief Parallel recursive directory walker that streams entry batches
+ *
+ * Each directory is one task on a WorkStealingPool. A task opens its
+ * directory relative to the walk's root descriptor, reads it with
+ * getdents64 (Linux) or readdir (other POSIX systems), stats every entry
+ * with fstatat relative to the directory descriptor, and queues child
+ * directories as new tasks. Entries from all tasks are appended to a shared
+ * batch, one lock per directory, and handed to the batch sink whenever it
+ * reaches WalkOptions::batchSize. The done sink runs exactly once, after
+ * the last batch, on whichever thread finishes the last directory. Both
+ * sinks run on pool threads, and the batch sink may run concurrently.
+ *
+ * Cancel(), or the options' cancellation token, stops the walk within one
+ * directory, or kCancelCheckInterval entries of a large one, and drops the
+ * entries not yet handed out. When the token's deadline passes instead,
+ * the walk stops just as quickly but still delivers what it has read, and
+ * the summary is marked timedOut.
+ *
+ * Symlinks are reported but never followed. Ignore patterns are matched
+ * against entry names; an ignored directory is neither reported nor read.
+ */
+
+#ifndef FILE_OPS_DIRECTORY_WALKER_H
+#define FILE_OPS_DIRECTORY_WALKER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+enum class EntryType : uint8_t {
+    Unknown = 0,
+    File = 1,
+    Directory = 2,
+    Symlink = 3,
+    Other = 4
+};
+
+struct WalkOptions {
+    // Levels below the root to enumerate; 1 lists only the root's children, 0 is unlimited
+    uint32_t maxDepth = 0;
+    size_t batchSize = 1024;
+    // When false, size and mtime are left at 0 and entries are only stat'ed
+    // if the directory listing does not report their type
+    bool statEntries = true;
+    // Glob patterns ('*' and '?') matched against entry names
+    std::vector<std::string> ignorePatterns;
+    // Polled between directories and every few hundred entries
+    CancellationToken cancellation;
+};
+
+/**
+ * Columnar batch of entries, possibly spanning several directories
+ */
+struct WalkBatch {
+    std::vector<std::string> directories;      // relative to the root, '/' separated, "" for the root
+    std::vector<uint32_t> directoryDepths;     // depth of each directory's entries (root children are 1)
+    std::vector<uint32_t> directoryIndex;      // per entry, index into directories
+    std::string names;                         // entry names packed back to back
+    std::vector<uint32_t> nameEnds;            // per entry, end offset into names
+    std::vector<uint8_t> types;                // per entry, EntryType
+    std::vector<double> sizes;                 // per entry, bytes
+    std::vector<double> mtimesMs;              // per entry, ms since the epoch
+
+    size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+
+    std::string_view name(size_t i) const {
+        uint32_t begin = i == 0 ? 0 : nameEnds[i - 1];
+        return std::string_view(names.data() + begin, nameEnds[i] - begin);
+    }
+
+    void Reserve(size_t entries) {
+        nameEnds.reserve(entries);
+        directoryIndex.reserve(entries);
+        types.reserve(entries);
+        sizes.reserve(entries);
+        mtimesMs.reserve(entries);
+        names.reserve(entries * 16);
+    }
+};
+
+struct WalkError {
+    std::string path;  // relative to the root
+    int code;          // errno
+};
+
+struct WalkSummary {
+    static constexpr size_t MAX_REPORTED_ERRORS = 64;
+
+    uint64_t entries = 0;
+    uint64_t directoriesRead = 0;
+    uint64_t errorCount = 0;
+    bool cancelled = false;
+    bool timedOut = false;           // stopped by the deadline; entries so far were delivered
+    double durationMs = 0;
+    std::vector<WalkError> errors;  // first MAX_REPORTED_ERRORS errors
+};
+
+// Glob match supporting '*' (any run) and '?' (any single byte)
+bool MatchGlob(std::string_view pattern, std::string_view name);
+
+class DirectoryWalker : public std::enable_shared_from_this<DirectoryWalker> {
+public:
+    using BatchSink = std::function<void(std::unique_ptr<WalkBatch>)>;
+    using DoneSink = std::function<void(std::unique_ptr<WalkSummary>)>;
+
+    static std::shared_ptr<DirectoryWalker> Create(std::string root,
+                                                   WalkOptions options,
+                                                   BatchSink onBatch,
+                                                   DoneSink onDone);
+
+    ~DirectoryWalker();
+
+    DirectoryWalker(const DirectoryWalker&) = delete;
+    DirectoryWalker& operator=(const DirectoryWalker&) = delete;
+
+    // Opens the root and queues the first task. Returns 0, or the errno from
+    // opening the root, in which case no sink is ever called.
+    int Start(WorkStealingPool& pool);
+
+    // Stops reading new directories; batches not yet handed out are dropped
+    void Cancel();
+    bool IsCancelled() const { return cancellation_.IsCancelled(); }
+
+    // Blocks until the done sink has returned (immediately if never started)
+    void WaitUntilFinished();
+    bool IsFinished() const;
+
+    const std::string& root() const { return root_; }
+
+private:
+    DirectoryWalker(std::string root, WalkOptions options, BatchSink onBatch, DoneSink onDone);
+
+    struct ScratchEntry;
+
+    void ScanDirectory(const std::string& relativePath, uint32_t depth);
+    void SubmitDirectory(std::string relativePath, uint32_t depth);
+    void AppendEntries(const std::string& relativePath, uint32_t depth,
+                       const std::vector<ScratchEntry>& entries, const std::string& names);
+    void RecordError(const std::string& relativePath, int code);
+    void TaskDone();
+    void Finish();
+    bool IsIgnored(std::string_view name) const;
+    // Cancelled rather than out of time: collected entries are discarded
+    bool IsDropping() const { return cancellation_.Reason() == CancelReason::Cancelled; }
+
+    std::string root_;
+    WalkOptions options_;
+    BatchSink onBatch_;
+    DoneSink onDone_;
+
+    WorkStealingPool* pool_ = nullptr;
+    int rootFd_ = -1;
+    std::chrono::steady_clock::time_point startTime_;
+
+    CancellationSource cancellation_;
+    std::atomic<int64_t> pendingTasks_{0};
+    std::atomic<uint64_t> entries_{0};
+    std::atomic<uint64_t> directoriesRead_{0};
+
+    std::mutex batchMutex_;
+    std::unique_ptr<WalkBatch> batch_;
+
+    std::mutex errorMutex_;
+    uint64_t errorCount_ = 0;
+    std::vector<WalkError> errors_;
+
+    mutable std::mutex finishMutex_;
+    std::condition_variable finishCv_;
+    bool started_ = false;
+    bool finished_ = false;
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_DIRECTORY_WALKER_H
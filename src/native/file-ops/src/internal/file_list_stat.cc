@@ -0,0 +1,125 @@
+/**
+ * @file file_list_stat.cc
+ * @brief Parallel stat and payload encoding for file lists
+ */
+
+#include "file_list_stat.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "file_list_payload.h"
+
+namespace FileCataloger {
+
+namespace {
+
+struct PathStat {
+    uint16_t flags = 0;
+    double size = std::nan("");
+};
+
+PathStat ToPathStat(const IoStat& stat) {
+    PathStat result;
+    if (stat.error != 0) {
+        result.flags = FILE_LIST_IS_FILE;
+        return result;
+    }
+    result.flags = FILE_LIST_EXISTS;
+    if (S_ISDIR(stat.mode)) {
+        result.flags |= FILE_LIST_IS_DIRECTORY;
+    } else {
+        result.flags |= FILE_LIST_IS_FILE;
+        result.size = static_cast<double>(stat.size);
+    }
+    return result;
+}
+
+void Encode(FileListBatch& batch, const std::vector<PathStat>& stats) {
+    FileListPayloadWriter writer;
+    writer.Reserve(batch.paths.size());
+    for (size_t i = 0; i < batch.paths.size(); i++) {
+        FileListEntry entry;
+        entry.path = batch.paths[i];
+        entry.name = FileListName(entry.path);
+        entry.extension = FileListExtension(entry.name);
+        entry.flags = stats[i].flags;
+        entry.size = stats[i].size;
+        writer.Add(entry);
+    }
+    batch.payload = writer.Finish();
+}
+
+} // namespace
+
+std::string_view FileListName(std::string_view path) {
+    while (path.size() > 1 && path.back() == '/') {
+        path.remove_suffix(1);
+    }
+    size_t slash = path.find_last_of('/');
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+std::string_view FileListExtension(std::string_view name) {
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string_view::npos || dot == 0) {
+        return std::string_view();
+    }
+    return name.substr(dot + 1);
+}
+
+void StatFileList(WorkStealingPool& pool, std::shared_ptr<FileListBatch> batch,
+                  std::function<void(std::shared_ptr<FileListBatch>)> done) {
+    // stat is cheap; larger chunks than the sniffer's keep scheduling
+    // overhead below the syscalls for a 50k-entry list
+    constexpr size_t kChunk = 256;
+
+    const size_t count = batch->paths.size();
+    if (count == 0) {
+        Encode(*batch, {});
+        done(std::move(batch));
+        return;
+    }
+
+    struct State {
+        std::shared_ptr<FileListBatch> batch;
+        std::vector<PathStat> stats;
+        std::function<void(std::shared_ptr<FileListBatch>)> done;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> skipped{false};
+    };
+    const size_t chunks = (count + kChunk - 1) / kChunk;
+    auto state = std::make_shared<State>();
+    state->batch = std::move(batch);
+    state->stats.resize(count);
+    state->done = std::move(done);
+    state->remaining.store(chunks, std::memory_order_relaxed);
+
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        pool.Submit([state, chunk, count] {
+            FileListBatch& batch = *state->batch;
+            if (batch.cancellation.IsCancelled()) {
+                state->skipped.store(true, std::memory_order_relaxed);
+            } else {
+                const size_t begin = chunk * kChunk;
+                const size_t end = std::min(count, begin + kChunk);
+                IoStat stats[kChunk];
+                IoEngine& engine = batch.engine ? *batch.engine : DefaultIoEngine();
+                engine.Stat(batch.paths.data() + begin, end - begin, stats);
+                for (size_t i = begin; i < end; i++) {
+                    state->stats[i] = ToPathStat(stats[i - begin]);
+                }
+            }
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                state->batch->cancelled = state->skipped.load(std::memory_order_relaxed);
+                Encode(*state->batch, state->stats);
+                state->done(std::move(state->batch));
+            }
+        });
+    }
+}
+
+} // namespace FileCataloger
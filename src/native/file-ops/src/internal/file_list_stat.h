@@ -0,0 +1,52 @@
+/**
+ * @file file_list_stat.h
+ * @brief Stat a list of paths into a compact file-list payload
+ *
+ * StatFileList stats every path on a WorkStealingPool, a chunk per task
+ * through an IoEngine (io_engine.h), and encodes the result with FileListPayloadWriter (common/file_list_payload.h): path,
+ * name, extension, existence, kind and size per file, in path order. The
+ * payload is one buffer the main process can hand to a renderer instead of
+ * an array of objects.
+ *
+ * The fields follow the drag monitor's GetDraggedFiles: symlinks are
+ * followed, isFile is the complement of isDirectory, and size is only set
+ * for existing files.
+ */
+
+#ifndef FILE_OPS_FILE_LIST_STAT_H
+#define FILE_OPS_FILE_LIST_STAT_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "io_engine.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+struct FileListBatch {
+    std::vector<std::string> paths;
+    std::vector<uint8_t> payload;     // filled by StatFileList
+    CancellationToken cancellation;   // checked before each chunk of paths
+    bool cancelled = false;           // chunks were skipped; their records have no flags set
+    IoEngine* engine = nullptr;       // DefaultIoEngine() when null
+};
+
+// Last path component, ignoring trailing slashes
+std::string_view FileListName(std::string_view path);
+// Text after the last dot of name, without it; empty for none or a leading dot
+std::string_view FileListExtension(std::string_view name);
+
+// Stat and encode every path on the pool. done runs exactly once, on a pool
+// thread (or the calling thread for an empty batch), with the payload set.
+void StatFileList(WorkStealingPool& pool, std::shared_ptr<FileListBatch> batch,
+                  std::function<void(std::shared_ptr<FileListBatch>)> done);
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_FILE_LIST_STAT_H
@@ -0,0 +1,810 @@
+/**
+ * @file file_transfer.cc
+ * @brief POSIX implementation of the copy/move engine
+ */
+
+#include "file_transfer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "directory_reader.h"
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#ifndef RENAME_NOREPLACE
+#define RENAME_NOREPLACE (1 << 0)
+#endif
+#elif defined(__APPLE__)
+#include <stdio.h>
+#include <sys/clonefile.h>
+#endif
+
+namespace FileCataloger {
+
+struct FileTransfer::ItemState {
+    struct Directory {
+        std::string path;
+        mode_t mode;
+        struct timespec times[2];
+    };
+
+    uint32_t index = 0;
+    uint64_t device = 0;
+    std::string source;
+    bool removeSource = false;   // a move that had to copy
+    std::atomic<int64_t> pending{1};
+    std::atomic<int> error{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint8_t> method{0};
+
+    // Created folders get their mode and times once everything inside is written
+    std::mutex directoriesMutex;
+    std::vector<Directory> directories;
+
+    void Fail(int code) {
+        int expected = 0;
+        error.compare_exchange_strong(expected, code, std::memory_order_acq_rel);
+    }
+
+    void UseMethod(TransferMethod used) {
+        uint8_t current = method.load(std::memory_order_relaxed);
+        while (current < static_cast<uint8_t>(used) &&
+               !method.compare_exchange_weak(current, static_cast<uint8_t>(used), std::memory_order_relaxed)) {
+        }
+    }
+};
+
+namespace {
+
+constexpr const char* kPartialSuffix = ".fcpart";
+constexpr int kPartialAttempts = 100;
+constexpr size_t kBufferAlignment = 4096;
+
+bool Allowed(const TransferOptions& options, TransferMethod method) {
+    return (options.methods & TransferMethodBit(method)) != 0;
+}
+
+// Errors meaning "this method cannot copy between these two files"
+bool IsUnsupported(int error) {
+    return error == EXDEV || error == ENOSYS || error == EOPNOTSUPP || error == ENOTSUP || error == EINVAL ||
+           error == ENOTTY;
+}
+
+void StatTimes(const struct stat& st, struct timespec times[2]) {
+#if defined(__APPLE__)
+    times[0] = st.st_atimespec;
+    times[1] = st.st_mtimespec;
+#else
+    times[0] = st.st_atim;
+    times[1] = st.st_mtim;
+#endif
+}
+
+std::string ParentOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+// The path with symlinks resolved in its parent but not in its last
+// component, which need not exist yet. False when the parent cannot be resolved.
+bool ResolvedPath(std::string path, std::string* resolved) {
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    char buffer[PATH_MAX];
+    const size_t slash = path.find_last_of('/');
+    const std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    if (path == "/" || name == "." || name == "..") {
+        // Names a folder through itself, which must exist
+        if (!realpath(path.c_str(), buffer)) {
+            return false;
+        }
+        *resolved = buffer;
+        return true;
+    }
+    if (!realpath(ParentOf(path).c_str(), buffer)) {
+        return false;
+    }
+    *resolved = buffer;
+    if (resolved->back() != '/') {
+        *resolved += '/';
+    }
+    *resolved += name;
+    return true;
+}
+
+// True when destination is source or lies inside it, so copying a folder
+// there would walk into its own copy
+bool IsSameOrInside(const std::string& source, const std::string& destination) {
+    std::string from;
+    std::string to;
+    if (!ResolvedPath(source, &from) || !ResolvedPath(destination, &to)) {
+        return false;
+    }
+    return to == from || (to.size() > from.size() && to.compare(0, from.size(), from) == 0 &&
+                          (from.back() == '/' || to[from.size()] == '/'));
+}
+
+std::string JoinPath(const std::string& directory, const char* name) {
+    std::string path = directory;
+    if (path.empty() || path.back() != '/') {
+        path += '/';
+    }
+    return path + name;
+}
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+struct FreeDeleter {
+    void operator()(void* buffer) const { free(buffer); }
+};
+
+// Page-aligned buffer per pool thread, reused across files
+char* ThreadBuffer(size_t size) {
+    thread_local std::unique_ptr<char, FreeDeleter> buffer;
+    thread_local size_t capacity = 0;
+    if (capacity < size) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, kBufferAlignment, size) != 0) {
+            return nullptr;
+        }
+        buffer.reset(static_cast<char*>(memory));
+        capacity = size;
+    }
+    return buffer.get();
+}
+
+bool IsCancelled(const std::atomic<bool>* cancelled, const TransferOptions& options) {
+    return (cancelled && cancelled->load(std::memory_order_relaxed)) || options.cancellation.IsCancelled();
+}
+
+void Report(const std::function<void(uint64_t)>& onBytes, uint64_t bytes) {
+    if (onBytes && bytes > 0) {
+        onBytes(bytes);
+    }
+}
+
+#if defined(__linux__)
+// In-kernel copy from *offset to EOF. Returns 0 when done, or an errno;
+// an IsUnsupported errno before or during the copy leaves *offset where
+// the next method should continue.
+int CopyInKernel(TransferMethod method, int in, int out, uint64_t* offset, const TransferOptions& options,
+                 const std::atomic<bool>* cancelled, const std::function<void(uint64_t)>& onBytes) {
+    if (method == TransferMethod::Sendfile && lseek(out, static_cast<off_t>(*offset), SEEK_SET) < 0) {
+        return errno;
+    }
+    for (;;) {
+        if (IsCancelled(cancelled, options)) {
+            return ECANCELED;
+        }
+        ssize_t copied;
+        if (method == TransferMethod::CopyFileRange) {
+#if defined(SYS_copy_file_range)
+            loff_t inOffset = static_cast<loff_t>(*offset);
+            loff_t outOffset = inOffset;
+            copied = syscall(SYS_copy_file_range, in, &inOffset, out, &outOffset, options.sliceSize, 0);
+#else
+            errno = ENOSYS;
+            copied = -1;
+#endif
+        } else {
+            off_t inOffset = static_cast<off_t>(*offset);
+            copied = sendfile(out, in, &inOffset, options.sliceSize);
+        }
+        if (copied < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (copied == 0) {
+            return 0;
+        }
+        *offset += static_cast<uint64_t>(copied);
+        Report(onBytes, static_cast<uint64_t>(copied));
+    }
+}
+#endif
+
+int CopyWithBuffer(int in, int out, uint64_t* offset, const TransferOptions& options,
+                   const std::atomic<bool>* cancelled, const std::function<void(uint64_t)>& onBytes) {
+    const size_t size = std::max<size_t>(options.bufferSize, kBufferAlignment);
+    char* buffer = ThreadBuffer(size);
+    if (!buffer) {
+        return ENOMEM;
+    }
+#if defined(__linux__)
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    for (;;) {
+        if (IsCancelled(cancelled, options)) {
+            return ECANCELED;
+        }
+        ssize_t got = pread(in, buffer, size, static_cast<off_t>(*offset));
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (got == 0) {
+            return 0;
+        }
+        for (ssize_t written = 0; written < got;) {
+            ssize_t n = pwrite(out, buffer + written, got - written, static_cast<off_t>(*offset + written));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            written += n;
+        }
+        *offset += static_cast<uint64_t>(got);
+        Report(onBytes, static_cast<uint64_t>(got));
+    }
+}
+
+// "<destination>.fcpart", then "<destination>.<n>.fcpart" when a file
+// already holds that name
+std::string PartialName(const std::string& destination, int attempt) {
+    return attempt == 0 ? destination + kPartialSuffix
+                        : destination + "." + std::to_string(attempt) + kPartialSuffix;
+}
+
+// Creates partial itself (EEXIST when the name is taken)
+int CopySymlink(const std::string& source, const std::string& partial, const struct stat& st) {
+    std::string target(static_cast<size_t>(st.st_size > 0 ? st.st_size : 256) + 1, '\0');
+    ssize_t length = readlink(source.c_str(), &target[0], target.size());
+    if (length < 0) {
+        return errno;
+    }
+    target.resize(static_cast<size_t>(length));
+    if (symlink(target.c_str(), partial.c_str()) != 0) {
+        return errno;
+    }
+    struct timespec times[2];
+    StatTimes(st, times);
+    utimensat(AT_FDCWD, partial.c_str(), times, AT_SYMLINK_NOFOLLOW);
+    return 0;
+}
+
+// Copy the data of an open regular file into a new file partial (EEXIST when
+// the name is taken), trying each allowed method
+int CopyRegular(int in, const std::string& partial, const struct stat& st,
+                const TransferOptions& options, TransferMethod* method, uint64_t* bytes,
+                const std::atomic<bool>* cancelled, const std::function<void(uint64_t)>& onBytes) {
+#if defined(__APPLE__)
+    // clonefile creates the file itself, with mode and times
+    if (Allowed(options, TransferMethod::Clone)) {
+        if (fclonefileat(in, AT_FDCWD, partial.c_str(), 0) == 0) {
+            *method = TransferMethod::Clone;
+            *bytes = static_cast<uint64_t>(st.st_size);
+            Report(onBytes, *bytes);
+            return 0;
+        }
+        if (!IsUnsupported(errno)) {
+            return errno;
+        }
+    }
+#endif
+
+    int out = open(partial.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0600);
+    if (out < 0) {
+        return errno;
+    }
+
+    uint64_t offset = 0;
+    int error = 0;
+    bool done = false;
+
+#if defined(__linux__)
+    if (Allowed(options, TransferMethod::Clone)) {
+        if (ioctl(out, FICLONE, in) == 0) {
+            *method = TransferMethod::Clone;
+            offset = static_cast<uint64_t>(st.st_size);
+            Report(onBytes, offset);
+            done = true;
+        } else if (!IsUnsupported(errno)) {
+            error = errno;
+        }
+    }
+    for (TransferMethod kernelMethod : {TransferMethod::CopyFileRange, TransferMethod::Sendfile}) {
+        if (done || error != 0 || !Allowed(options, kernelMethod)) {
+            continue;
+        }
+        const uint64_t before = offset;
+        error = CopyInKernel(kernelMethod, in, out, &offset, options, cancelled, onBytes);
+        if (offset > before || error == 0) {
+            *method = kernelMethod;
+        }
+        if (error == 0) {
+            done = true;
+        } else if (IsUnsupported(error)) {
+            error = 0;  // continue from offset with the next method
+        }
+    }
+#endif
+
+    if (!done && error == 0) {
+        error = CopyWithBuffer(in, out, &offset, options, cancelled, onBytes);
+        if (error == 0) {
+            *method = TransferMethod::ReadWrite;
+        }
+    }
+
+    if (error == 0) {
+        struct timespec times[2];
+        StatTimes(st, times);
+        if (fchmod(out, st.st_mode & 07777) != 0 || futimens(out, times) != 0) {
+            error = errno;
+        }
+    }
+    if (close(out) != 0 && error == 0) {
+        error = errno;
+    }
+    *bytes = offset;
+    return error;
+}
+
+int RemoveTree(const std::string& path) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) {
+        return errno;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return unlink(path.c_str()) == 0 ? 0 : errno;
+    }
+
+    int fd = open(path.c_str(), kOpenDirectoryFlags);
+    if (fd < 0) {
+        return errno;
+    }
+    std::vector<std::string> children;
+    int error = ReadDirectory(fd, [&](const char* name, unsigned char) {
+        children.push_back(JoinPath(path, name));
+        return true;
+    });
+    for (const auto& child : children) {
+        int childError = RemoveTree(child);
+        if (error == 0) {
+            error = childError;
+        }
+    }
+    if (error == 0 && rmdir(path.c_str()) != 0) {
+        error = errno;
+    }
+    return error;
+}
+
+} // namespace
+
+int RenameNoReplace(const std::string& from, const std::string& to) {
+#if defined(__linux__) && defined(SYS_renameat2)
+    if (syscall(SYS_renameat2, AT_FDCWD, from.c_str(), AT_FDCWD, to.c_str(), RENAME_NOREPLACE) == 0) {
+        return 0;
+    }
+    if (errno != ENOSYS && errno != EINVAL) {
+        return errno;
+    }
+#elif defined(__APPLE__)
+    if (renamex_np(from.c_str(), to.c_str(), RENAME_EXCL) == 0) {
+        return 0;
+    }
+    if (errno != ENOTSUP) {
+        return errno;
+    }
+#endif
+    // Filesystem without an exclusive rename: link() refuses to replace.
+    // Directories cannot be linked; check, then rename (racy, but rare).
+    if (link(from.c_str(), to.c_str()) == 0) {
+        unlink(from.c_str());
+        return 0;
+    }
+    if (errno == EEXIST) {
+        return EEXIST;
+    }
+    struct stat st;
+    if (lstat(to.c_str(), &st) == 0) {
+        return EEXIST;
+    }
+    return rename(from.c_str(), to.c_str()) == 0 ? 0 : errno;
+}
+
+int CopyFileTo(const std::string& source, const std::string& destination, const TransferOptions& options,
+               TransferMethod* method, uint64_t* bytes, const std::atomic<bool>* cancelled,
+               const std::function<void(uint64_t)>& onBytes) {
+    *method = TransferMethod::None;
+    *bytes = 0;
+
+    struct stat st;
+    if (lstat(source.c_str(), &st) != 0) {
+        return errno;
+    }
+    struct stat existing;
+    if (!options.overwrite && lstat(destination.c_str(), &existing) == 0) {
+        return EEXIST;
+    }
+    if (IsCancelled(cancelled, options)) {
+        return ECANCELED;
+    }
+
+    int in = -1;
+    if (S_ISREG(st.st_mode)) {
+        in = open(source.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (in < 0) {
+            return errno;
+        }
+    } else if (!S_ISLNK(st.st_mode)) {
+        return ENOTSUP;
+    }
+
+    // The staging file is created exclusively, so a file of the user's that
+    // happens to carry the staging name is skipped, never replaced
+    std::string partial;
+    int error = EEXIST;
+    for (int attempt = 0; attempt < kPartialAttempts && error == EEXIST; attempt++) {
+        partial = PartialName(destination, attempt);
+        if (in < 0) {
+            error = CopySymlink(source, partial, st);
+            *method = TransferMethod::ReadWrite;
+        } else {
+            error = CopyRegular(in, partial, st, options, method, bytes, cancelled, onBytes);
+        }
+    }
+    if (in >= 0) {
+        close(in);
+    }
+    if (error == EEXIST) {
+        *method = TransferMethod::None;
+        return error;   // every name was taken; none of them is ours to remove
+    }
+
+    if (error == 0) {
+        if (options.overwrite) {
+            error = rename(partial.c_str(), destination.c_str()) == 0 ? 0 : errno;
+        } else {
+            error = RenameNoReplace(partial, destination);
+        }
+    }
+    if (error != 0) {
+        unlink(partial.c_str());
+        *method = TransferMethod::None;
+    }
+    return error;
+}
+
+std::shared_ptr<FileTransfer> FileTransfer::Create(std::vector<TransferItem> items, TransferOptions options,
+                                                   ResultSink onResult, ProgressSink onProgress,
+                                                   DoneSink onDone) {
+    return std::shared_ptr<FileTransfer>(new FileTransfer(std::move(items), std::move(options),
+                                                          std::move(onResult), std::move(onProgress),
+                                                          std::move(onDone)));
+}
+
+FileTransfer::FileTransfer(std::vector<TransferItem> items, TransferOptions options, ResultSink onResult,
+                           ProgressSink onProgress, DoneSink onDone)
+    : items_(std::move(items)),
+      options_(std::move(options)),
+      onResult_(std::move(onResult)),
+      onProgress_(std::move(onProgress)),
+      onDone_(std::move(onDone)),
+      cancellation_(options_.cancellation) {
+    // Copies poll the options' token, so they see Cancel() too
+    options_.cancellation = cancellation_.Token();
+    options_.perDeviceConcurrency = std::max<uint32_t>(1, options_.perDeviceConcurrency);
+    options_.sliceSize = std::max<size_t>(options_.sliceSize, 64 * 1024);
+}
+
+FileTransfer::~FileTransfer() = default;
+
+void FileTransfer::Start(WorkStealingPool& pool) {
+    pool_ = &pool;
+    startTime_ = std::chrono::steady_clock::now();
+    lastProgressNs_.store(NowNs(), std::memory_order_relaxed);
+    summary_.items = items_.size();
+    {
+        std::lock_guard<std::mutex> lock(finishMutex_);
+        started_ = true;
+    }
+
+    if (items_.empty()) {
+        Finish();
+        return;
+    }
+    for (uint32_t i = 0; i < items_.size(); i++) {
+        pool.Submit([self = shared_from_this(), i] { self->StartItem(i); });
+    }
+}
+
+void FileTransfer::Cancel() {
+    cancellation_.Cancel();
+}
+
+TransferProgress FileTransfer::Progress() const {
+    TransferProgress progress;
+    progress.bytesDone = bytesDone_.load(std::memory_order_relaxed);
+    progress.bytesFound = bytesFound_.load(std::memory_order_relaxed);
+    progress.filesDone = filesDone_.load(std::memory_order_relaxed);
+    progress.filesFound = filesFound_.load(std::memory_order_relaxed);
+    progress.itemsDone = itemsDone_.load(std::memory_order_relaxed);
+    return progress;
+}
+
+void FileTransfer::WaitUntilFinished() {
+    std::unique_lock<std::mutex> lock(finishMutex_);
+    finishCv_.wait(lock, [this] { return !started_ || finished_; });
+}
+
+void FileTransfer::StartItem(uint32_t index) {
+    auto item = std::make_shared<ItemState>();
+    item->index = index;
+    const TransferItem& request = items_[index];
+    item->source = request.source;
+
+    struct stat st;
+    struct stat parent;
+    if (IsCancelled()) {
+        item->Fail(ECANCELED);
+    } else if (lstat(request.source.c_str(), &st) != 0) {
+        item->Fail(errno);
+    } else if (stat(ParentOf(request.destination).c_str(), &parent) != 0) {
+        item->Fail(errno);
+    } else if (IsSameOrInside(request.source, request.destination)) {
+        // As fs.cp: a folder cannot be copied or moved into itself
+        item->Fail(EINVAL);
+    } else {
+        item->device = static_cast<uint64_t>(parent.st_dev);
+        bool renamed = false;
+        if (options_.mode == TransferMode::Move && Allowed(options_, TransferMethod::Rename)) {
+            int error = options_.overwrite
+                            ? (rename(request.source.c_str(), request.destination.c_str()) == 0 ? 0 : errno)
+                            : RenameNoReplace(request.source, request.destination);
+            // Moving a folder onto one that exists merges them by copying
+            bool merge = options_.overwrite && S_ISDIR(st.st_mode) && (error == ENOTEMPTY || error == EEXIST);
+            if (error == 0) {
+                renamed = true;
+                const uint64_t size = S_ISREG(st.st_mode) ? static_cast<uint64_t>(st.st_size) : 0;
+                item->UseMethod(TransferMethod::Rename);
+                item->bytes.store(size, std::memory_order_relaxed);
+                bytesFound_.fetch_add(size, std::memory_order_relaxed);
+                filesFound_.fetch_add(1, std::memory_order_relaxed);
+                filesDone_.fetch_add(1, std::memory_order_relaxed);
+                AddBytes(size);
+                std::lock_guard<std::mutex> lock(summaryMutex_);
+                summary_.methodCounts[static_cast<int>(TransferMethod::Rename)]++;
+            } else if (error != EXDEV && !merge) {
+                item->Fail(error);
+            }
+        }
+        if (!renamed && item->error.load(std::memory_order_relaxed) == 0) {
+            item->removeSource = options_.mode == TransferMode::Move;
+            if (S_ISDIR(st.st_mode)) {
+                CopyDirectory(item, request.source, request.destination);
+            } else {
+                QueueFile(item, request.source, request.destination, static_cast<uint64_t>(st.st_size));
+            }
+        }
+    }
+    TaskDone(item);
+}
+
+void FileTransfer::CopyDirectory(const std::shared_ptr<ItemState>& item, const std::string& source,
+                                 const std::string& destination) {
+    if (IsCancelled()) {
+        item->Fail(ECANCELED);
+        return;
+    }
+    int fd = open(source.c_str(), kOpenDirectoryFlags);
+    if (fd < 0) {
+        item->Fail(errno);
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        item->Fail(errno);
+        close(fd);
+        return;
+    }
+
+    // Owner access until the folder's own mode is applied at the end
+    if (mkdir(destination.c_str(), 0700) != 0) {
+        const int error = errno;
+        struct stat existing;
+        if (error != EEXIST || !options_.overwrite || stat(destination.c_str(), &existing) != 0 ||
+            !S_ISDIR(existing.st_mode)) {
+            item->Fail(error);
+            close(fd);
+            return;
+        }
+    }
+    {
+        ItemState::Directory directory{destination, st.st_mode & 07777, {}};
+        StatTimes(st, directory.times);
+        std::lock_guard<std::mutex> lock(item->directoriesMutex);
+        item->directories.push_back(std::move(directory));
+    }
+
+    int error = ReadDirectory(fd, [&](const char* name, unsigned char) {
+        if (IsCancelled()) {
+            item->Fail(ECANCELED);
+            return false;
+        }
+        struct stat child;
+        if (fstatat(fd, name, &child, AT_SYMLINK_NOFOLLOW) != 0) {
+            item->Fail(errno);
+            return true;
+        }
+        std::string childSource = JoinPath(source, name);
+        std::string childDestination = JoinPath(destination, name);
+        if (S_ISDIR(child.st_mode)) {
+            item->pending.fetch_add(1, std::memory_order_relaxed);
+            pool_->Submit([self = shared_from_this(), item, childSource = std::move(childSource),
+                           childDestination = std::move(childDestination)] {
+                self->CopyDirectory(item, childSource, childDestination);
+                self->TaskDone(item);
+            });
+        } else {
+            QueueFile(item, std::move(childSource), std::move(childDestination),
+                      static_cast<uint64_t>(child.st_size));
+        }
+        return true;
+    });
+    if (error != 0) {
+        item->Fail(error);
+    }
+}
+
+void FileTransfer::QueueFile(const std::shared_ptr<ItemState>& item, std::string source, std::string destination,
+                             uint64_t size) {
+    item->pending.fetch_add(1, std::memory_order_relaxed);
+    filesFound_.fetch_add(1, std::memory_order_relaxed);
+    bytesFound_.fetch_add(size, std::memory_order_relaxed);
+    const uint64_t device = item->device;
+    RunOnDevice(device, [self = shared_from_this(), item, source = std::move(source),
+                         destination = std::move(destination), device] {
+        self->CopyOneFile(item, source, destination);
+        self->ReleaseDevice(device);
+        self->TaskDone(item);
+    });
+}
+
+void FileTransfer::CopyOneFile(const std::shared_ptr<ItemState>& item, const std::string& source,
+                               const std::string& destination) {
+    if (IsCancelled()) {
+        item->Fail(ECANCELED);
+        return;
+    }
+    TransferMethod method;
+    uint64_t bytes = 0;
+    int error = CopyFileTo(source, destination, options_, &method, &bytes, nullptr,
+                           [this](uint64_t copied) { AddBytes(copied); });
+    if (error != 0) {
+        item->Fail(error);
+        return;
+    }
+    item->UseMethod(method);
+    item->bytes.fetch_add(bytes, std::memory_order_relaxed);
+    filesDone_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(summaryMutex_);
+    summary_.methodCounts[static_cast<int>(method)]++;
+}
+
+void FileTransfer::RunOnDevice(uint64_t device, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex_);
+        DeviceSlots& slots = devices_[device];
+        if (slots.active >= options_.perDeviceConcurrency) {
+            slots.waiting.push_back(std::move(task));
+            return;
+        }
+        slots.active++;
+    }
+    pool_->Submit(std::move(task));
+}
+
+void FileTransfer::ReleaseDevice(uint64_t device) {
+    std::function<void()> next;
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex_);
+        DeviceSlots& slots = devices_[device];
+        if (slots.waiting.empty()) {
+            slots.active--;
+            return;
+        }
+        // The slot passes straight to the next file for this device
+        next = std::move(slots.waiting.front());
+        slots.waiting.pop_front();
+    }
+    pool_->Submit(std::move(next));
+}
+
+void FileTransfer::AddBytes(uint64_t bytes) {
+    bytesDone_.fetch_add(bytes, std::memory_order_relaxed);
+    const int64_t now = NowNs();
+    int64_t last = lastProgressNs_.load(std::memory_order_relaxed);
+    const int64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.progressInterval).count();
+    if (now - last >= interval && lastProgressNs_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        onProgress_();
+    }
+}
+
+void FileTransfer::TaskDone(const std::shared_ptr<ItemState>& item) {
+    if (item->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    FinishItem(*item);
+    if (itemsDone_.fetch_add(1, std::memory_order_acq_rel) + 1 == items_.size()) {
+        Finish();
+    }
+}
+
+void FileTransfer::FinishItem(ItemState& item) {
+    // Innermost folders first, so a read-only folder is locked after its contents
+    for (auto it = item.directories.rbegin(); it != item.directories.rend(); ++it) {
+        chmod(it->path.c_str(), it->mode);
+        utimensat(AT_FDCWD, it->path.c_str(), it->times, 0);
+    }
+    if (item.removeSource && item.error.load(std::memory_order_acquire) == 0) {
+        int error = RemoveTree(item.source);
+        if (error != 0) {
+            item.Fail(error);
+        }
+    }
+
+    TransferResult result;
+    result.index = item.index;
+    result.error = item.error.load(std::memory_order_acquire);
+    result.method = static_cast<TransferMethod>(item.method.load(std::memory_order_relaxed));
+    result.bytes = item.bytes.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(summaryMutex_);
+        if (result.error != 0) {
+            summary_.failed++;
+        }
+    }
+    onResult_(result);
+}
+
+void FileTransfer::Finish() {
+    TransferSummary summary;
+    {
+        std::lock_guard<std::mutex> lock(summaryMutex_);
+        summary = summary_;
+    }
+    summary.files = filesDone_.load(std::memory_order_relaxed);
+    summary.bytes = bytesDone_.load(std::memory_order_relaxed);
+    summary.cancelled = IsCancelled();
+    summary.timedOut = cancellation_.Reason() == CancelReason::DeadlineExceeded;
+    summary.durationMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime_).count();
+    onDone_(summary);
+
+    {
+        std::lock_guard<std::mutex> lock(finishMutex_);
+        finished_ = true;
+    }
+    finishCv_.notify_all();
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,223 @@
+/**
+ * @file file_transfer.h
+ * @brief Parallel copy/move of files and folders into a destination
+ *
+ * Each item is moved or copied with the cheapest method that works:
+ *
+ *   1. rename            (move only, same filesystem)
+ *   2. reflink           FICLONE on Linux (btrfs, XFS, bcachefs), clonefile on macOS
+ *   3. copy_file_range   in-kernel copy (Linux); NFS/SMB may copy server-side
+ *   4. sendfile          in-kernel copy for kernels without cross-fs copy_file_range
+ *   5. read/write        1MB page-aligned buffer per thread
+ *
+ * A method that is not supported for a pair of files (EXDEV, EOPNOTSUPP,
+ * ENOSYS, EINVAL, ...) falls through to the next one, continuing from the
+ * bytes already copied. Data goes to "<destination>.fcpart", created
+ * exclusively ("<destination>.<n>.fcpart" when a file already has that
+ * name), and is renamed into place once complete, with the source's mode
+ * and timestamps, so a failed or cancelled copy never leaves a truncated
+ * file under the real name. A move deletes its source only after the whole item was copied.
+ *
+ * Folders are copied recursively, one pool task per directory, and every
+ * file is one task. Copies run in parallel on a WorkStealingPool but at most
+ * TransferOptions::perDeviceConcurrency at a time per destination device,
+ * so a slow disk is not flooded while a fast one stays busy. Symlinks are
+ * recreated, not followed; other special files fail with ENOTSUP.
+ * An item whose destination is its source, or lies inside it once symlinks
+ * are resolved, fails with EINVAL before anything is created, as fs.cp does.
+ *
+ * The result sink runs once per item as it finishes, the progress sink at
+ * most every progressInterval while data moves, and the done sink exactly
+ * once after the last result. All run on pool threads, possibly at once.
+ */
+
+#ifndef FILE_OPS_FILE_TRANSFER_H
+#define FILE_OPS_FILE_TRANSFER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+enum class TransferMode : uint8_t {
+    Copy = 0,
+    Move = 1
+};
+
+enum class TransferMethod : uint8_t {
+    None = 0,           // nothing was transferred (an error, or an empty folder)
+    Rename = 1,
+    Clone = 2,
+    CopyFileRange = 3,
+    Sendfile = 4,
+    ReadWrite = 5
+};
+
+constexpr uint32_t TransferMethodBit(TransferMethod method) {
+    return 1u << static_cast<uint32_t>(method);
+}
+
+constexpr uint32_t ALL_TRANSFER_METHODS =
+    TransferMethodBit(TransferMethod::Rename) | TransferMethodBit(TransferMethod::Clone) |
+    TransferMethodBit(TransferMethod::CopyFileRange) | TransferMethodBit(TransferMethod::Sendfile) |
+    TransferMethodBit(TransferMethod::ReadWrite);
+
+struct TransferOptions {
+    TransferMode mode = TransferMode::Copy;
+    // Replace existing destinations (folders are merged); otherwise they fail with EEXIST
+    bool overwrite = false;
+    // Methods to try, TransferMethodBit()s; read/write is always the last resort
+    uint32_t methods = ALL_TRANSFER_METHODS;
+    uint32_t perDeviceConcurrency = 4;
+    // read/write buffer, and bytes per copy_file_range/sendfile call, which
+    // is how often a copy notices cancellation and reports progress
+    size_t bufferSize = 1 << 20;
+    size_t sliceSize = 16 << 20;
+    std::chrono::milliseconds progressInterval{50};
+    // Polled before each file and between slices, like FileTransfer::Cancel()
+    CancellationToken cancellation;
+};
+
+struct TransferItem {
+    std::string source;
+    std::string destination;   // full destination path, not the folder it goes into
+};
+
+struct TransferResult {
+    uint32_t index;            // into the items passed to Create
+    TransferMethod method;     // for folders, the slowest method any file needed
+    int error;                 // 0, or the first errno hit while transferring the item
+    uint64_t bytes;            // data bytes written (renames count the file size)
+};
+
+struct TransferProgress {
+    uint64_t bytesDone = 0;
+    uint64_t bytesFound = 0;   // grows while folders are being listed
+    uint64_t filesDone = 0;
+    uint64_t filesFound = 0;
+    uint64_t itemsDone = 0;
+};
+
+struct TransferSummary {
+    uint64_t items = 0;
+    uint64_t failed = 0;
+    uint64_t files = 0;              // a folder moved by rename counts once
+    uint64_t bytes = 0;
+    uint64_t methodCounts[6] = {};   // files per TransferMethod
+    bool cancelled = false;
+    bool timedOut = false;           // items not finished by the deadline failed with ECANCELED
+    double durationMs = 0;
+};
+
+/**
+ * Copy one regular file or symlink to destination (via an exclusively created "<destination>.fcpart").
+ * onBytes is called as data is written. Returns 0 or an errno; ECANCELED
+ * when cancelled is set or options.cancellation fires mid-copy. Used by FileTransfer and by tests.
+ */
+int CopyFileTo(const std::string& source, const std::string& destination, const TransferOptions& options,
+               TransferMethod* method, uint64_t* bytes, const std::atomic<bool>* cancelled = nullptr,
+               const std::function<void(uint64_t)>& onBytes = nullptr);
+
+// rename() that fails with EEXIST instead of replacing (renameat2 RENAME_NOREPLACE,
+// renamex_np RENAME_EXCL)
+int RenameNoReplace(const std::string& from, const std::string& to);
+
+class FileTransfer : public std::enable_shared_from_this<FileTransfer> {
+public:
+    using ResultSink = std::function<void(const TransferResult&)>;
+    using ProgressSink = std::function<void()>;
+    using DoneSink = std::function<void(const TransferSummary&)>;
+
+    static std::shared_ptr<FileTransfer> Create(std::vector<TransferItem> items,
+                                                TransferOptions options,
+                                                ResultSink onResult,
+                                                ProgressSink onProgress,
+                                                DoneSink onDone);
+
+    ~FileTransfer();
+
+    FileTransfer(const FileTransfer&) = delete;
+    FileTransfer& operator=(const FileTransfer&) = delete;
+
+    // Queues every item; the sinks are called even if items is empty
+    void Start(WorkStealingPool& pool);
+
+    // Stops starting files and interrupts copies between slices; their items
+    // fail with ECANCELED and partial files are removed
+    void Cancel();
+    bool IsCancelled() const { return cancellation_.IsCancelled(); }
+
+    TransferProgress Progress() const;
+
+    // Blocks until the done sink has returned (immediately if never started)
+    void WaitUntilFinished();
+
+private:
+    FileTransfer(std::vector<TransferItem> items, TransferOptions options, ResultSink onResult,
+                 ProgressSink onProgress, DoneSink onDone);
+
+    struct ItemState;
+
+    void StartItem(uint32_t index);
+    void CopyDirectory(const std::shared_ptr<ItemState>& item, const std::string& source,
+                       const std::string& destination);
+    void QueueFile(const std::shared_ptr<ItemState>& item, std::string source, std::string destination,
+                   uint64_t size);
+    void CopyOneFile(const std::shared_ptr<ItemState>& item, const std::string& source,
+                     const std::string& destination);
+    void RunOnDevice(uint64_t device, std::function<void()> task);
+    void ReleaseDevice(uint64_t device);
+    void AddBytes(uint64_t bytes);
+    void TaskDone(const std::shared_ptr<ItemState>& item);
+    void FinishItem(ItemState& item);
+    void Finish();
+
+    std::vector<TransferItem> items_;
+    TransferOptions options_;
+    ResultSink onResult_;
+    ProgressSink onProgress_;
+    DoneSink onDone_;
+
+    WorkStealingPool* pool_ = nullptr;
+    std::chrono::steady_clock::time_point startTime_;
+    CancellationSource cancellation_;
+
+    std::atomic<uint64_t> bytesDone_{0};
+    std::atomic<uint64_t> bytesFound_{0};
+    std::atomic<uint64_t> filesDone_{0};
+    std::atomic<uint64_t> filesFound_{0};
+    std::atomic<uint64_t> itemsDone_{0};
+    std::atomic<int64_t> lastProgressNs_{0};
+
+    std::mutex summaryMutex_;
+    TransferSummary summary_;
+
+    struct DeviceSlots {
+        uint32_t active = 0;
+        std::deque<std::function<void()>> waiting;
+    };
+    std::mutex deviceMutex_;
+    std::unordered_map<uint64_t, DeviceSlots> devices_;
+
+    mutable std::mutex finishMutex_;
+    std::condition_variable finishCv_;
+    bool started_ = false;
+    bool finished_ = false;
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_FILE_TRANSFER_H
@@ -0,0 +1,276 @@
+/**
+ * @file folder_size.cc
+ * @brief POSIX implementation of incremental folder size measurement
+ */
+
+#include "folder_size.h"
+
+#include <cerrno>
+#include <ctime>
+
+#include "directory_reader.h"
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr size_t kCancelCheckInterval = 256;
+
+// Directories modified this recently may change again within the same
+// mtime tick (1s on HFS+, 2s on FAT), so their listings are not trusted later
+constexpr int64_t kRacyWindowNs = 2000000000LL;
+
+int64_t RealtimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+} // namespace
+
+/**
+ * One directory being measured. A node is freed once its own scan and all
+ * of its children have completed, after adding its totals to its parent.
+ */
+struct FolderSizeScanner::Node {
+    explicit Node(Node* parent) : parent(parent) {}
+
+    Node* const parent;
+    std::atomic<uint32_t> pending{1};  // unfinished children, plus its own scan
+    DirectoryKey key;
+    DirectorySizeRecord record;
+    bool listed = false;
+    bool cacheable = false;
+    std::atomic<uint64_t> childBytes{0};
+    std::atomic<uint64_t> childFiles{0};
+    std::atomic<uint64_t> childDirectories{0};
+};
+
+int EstimateFolderSize(const FolderSizeCache& cache, const std::string& root, FolderSize* size) {
+    struct stat st;
+    if (stat(root.c_str(), &st) != 0) {
+        return errno;
+    }
+
+    DirectorySizeRecord record;
+    if (!S_ISDIR(st.st_mode) ||
+        !cache.Lookup(DirectoryKey{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)},
+                      &record, false)) {
+        return ENOENT;
+    }
+    size->bytes = record.totalBytes;
+    size->files = record.totalFiles;
+    size->directories = record.totalDirectories;
+    return 0;
+}
+
+std::shared_ptr<FolderSizeScanner> FolderSizeScanner::Create(std::string root,
+                                                             std::shared_ptr<FolderSizeCache> cache,
+                                                             FolderSizeOptions options,
+                                                             DoneSink onDone) {
+    return std::shared_ptr<FolderSizeScanner>(
+        new FolderSizeScanner(std::move(root), std::move(cache), options, std::move(onDone)));
+}
+
+FolderSizeScanner::FolderSizeScanner(std::string root, std::shared_ptr<FolderSizeCache> cache,
+                                     FolderSizeOptions options, DoneSink onDone)
+    : root_(std::move(root)),
+      cache_(std::move(cache)),
+      options_(std::move(options)),
+      onDone_(std::move(onDone)),
+      cancellation_(options_.cancellation) {}
+
+FolderSizeScanner::~FolderSizeScanner() {
+    if (rootFd_ >= 0) {
+        close(rootFd_);
+    }
+}
+
+int FolderSizeScanner::Start(WorkStealingPool& pool) {
+    int fd = open(root_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno;
+    }
+
+    rootFd_ = fd;
+    pool_ = &pool;
+    startTime_ = std::chrono::steady_clock::now();
+    racyThresholdNs_ = RealtimeNs() - kRacyWindowNs;
+    {
+        std::lock_guard<std::mutex> lock(finishMutex_);
+        started_ = true;
+    }
+
+    Submit(new Node(nullptr), std::string());
+    return 0;
+}
+
+void FolderSizeScanner::Cancel() {
+    cancellation_.Cancel();
+}
+
+void FolderSizeScanner::WaitUntilFinished() {
+    std::unique_lock<std::mutex> lock(finishMutex_);
+    finishCv_.wait(lock, [this] { return !started_ || finished_; });
+}
+
+void FolderSizeScanner::Submit(Node* node, std::string relativePath) {
+    pool_->Submit([self = shared_from_this(), node, path = std::move(relativePath)] {
+        self->ScanDirectory(node, path);
+        self->Complete(node);
+    });
+}
+
+void FolderSizeScanner::ScanDirectory(Node* node, const std::string& relativePath) {
+    if (IsCancelled()) {
+        return;
+    }
+
+    struct stat st;
+    if (fstatat(rootFd_, relativePath.empty() ? "." : relativePath.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        if (errno != ENOENT) {
+            errorCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return;  // Replaced since its parent was listed
+    }
+
+    node->key = DirectoryKey{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+    const int64_t mtimeNs = MtimeNs(st);
+
+    if (!options_.rescan && mtimeNs != 0 && cache_->Lookup(node->key, &node->record) &&
+        node->record.mtimeNs == mtimeNs) {
+        directoriesReused_.fetch_add(1, std::memory_order_relaxed);
+        node->cacheable = true;
+    } else {
+        node->record = DirectorySizeRecord();
+        node->record.mtimeNs = mtimeNs < racyThresholdNs_ ? mtimeNs : 0;
+        ListDirectory(node, relativePath);
+    }
+
+    const auto& subdirectories = node->record.subdirectories;
+    if (subdirectories.empty() || IsCancelled()) {
+        return;
+    }
+    node->pending.fetch_add(static_cast<uint32_t>(subdirectories.size()), std::memory_order_relaxed);
+    for (const auto& name : subdirectories) {
+        std::string child;
+        child.reserve(relativePath.size() + 1 + name.size());
+        if (!relativePath.empty()) {
+            child.append(relativePath).push_back('/');
+        }
+        child.append(name);
+        Submit(new Node(node), std::move(child));
+    }
+}
+
+void FolderSizeScanner::ListDirectory(Node* node, const std::string& relativePath) {
+    int dirFd = openat(rootFd_, relativePath.empty() ? "." : relativePath.c_str(), kOpenDirectoryFlags);
+    if (dirFd < 0) {
+        if (errno != ENOENT) {
+            errorCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    directoriesListed_.fetch_add(1, std::memory_order_relaxed);
+    node->listed = true;
+
+    DirectorySizeRecord& record = node->record;
+    size_t sinceCancelCheck = 0;
+    int error = ReadDirectory(dirFd, [&](const char* name, unsigned char type) {
+        if (++sinceCancelCheck >= kCancelCheckInterval) {
+            sinceCancelCheck = 0;
+            if (IsCancelled()) {
+                return false;
+            }
+        }
+
+        if (type == DT_DIR) {
+            record.subdirectories.emplace_back(name);
+            return true;
+        }
+        if (type != DT_REG && type != DT_UNKNOWN) {
+            return true;
+        }
+
+        struct stat st;
+        if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            return true;  // Removed between listing and stat
+        }
+        if (S_ISREG(st.st_mode)) {
+            record.ownBytes += static_cast<uint64_t>(st.st_size);
+            record.ownFiles++;
+        } else if (S_ISDIR(st.st_mode)) {
+            record.subdirectories.emplace_back(name);
+        }
+        return true;
+    });
+
+    if (error != 0) {
+        errorCount_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    node->cacheable = !IsCancelled();
+}
+
+void FolderSizeScanner::Complete(Node* node) {
+    while (node->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        FolderSize total;
+        total.bytes = node->record.ownBytes + node->childBytes.load(std::memory_order_relaxed);
+        total.files = node->record.ownFiles + node->childFiles.load(std::memory_order_relaxed);
+        total.directories = node->childDirectories.load(std::memory_order_relaxed);
+
+        // A reused record is only rewritten when something below it changed
+        DirectorySizeRecord& record = node->record;
+        bool changed = node->listed || record.totalBytes != total.bytes ||
+                       record.totalFiles != total.files || record.totalDirectories != total.directories;
+        if (node->cacheable && changed && !IsCancelled()) {
+            record.totalBytes = total.bytes;
+            record.totalFiles = total.files;
+            record.totalDirectories = total.directories;
+            cache_->Store(node->key, std::move(record));
+        }
+
+        Node* parent = node->parent;
+        delete node;
+        if (!parent) {
+            Finish(total);
+            return;
+        }
+
+        parent->childBytes.fetch_add(total.bytes, std::memory_order_relaxed);
+        parent->childFiles.fetch_add(total.files, std::memory_order_relaxed);
+        parent->childDirectories.fetch_add(total.directories + 1, std::memory_order_relaxed);
+        node = parent;
+    }
+}
+
+void FolderSizeScanner::Finish(const FolderSize& size) {
+    FolderSizeResult result;
+    result.size = size;
+    result.cancelled = IsCancelled();
+    result.timedOut = cancellation_.Reason() == CancelReason::DeadlineExceeded;
+    result.directoriesListed = directoriesListed_.load(std::memory_order_relaxed);
+    result.directoriesReused = directoriesReused_.load(std::memory_order_relaxed);
+    result.errorCount = errorCount_.load(std::memory_order_relaxed);
+    result.durationMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime_).count();
+
+    onDone_(result);
+
+    // Persisting is best effort; a failed save leaves the records in memory
+    // for the next measurement to save
+    if (!result.cancelled) {
+        cache_->Save();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(finishMutex_);
+        finished_ = true;
+    }
+    finishCv_.notify_all();
+}
+
+} // namespace FileCataloger
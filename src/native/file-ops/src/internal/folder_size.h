@@ -0,0 +1,129 @@
+/**
+ * @file folder_size.h
+ * @brief Incremental folder size measurement on top of FolderSizeCache
+ *
+ * A measurement visits every directory below the root as one task on a
+ * WorkStealingPool, but only lists the directories whose mtime differs
+ * from their cache record; for the others one fstatat is enough, and the
+ * cached file bytes and subdirectory names are reused. Subtree totals are
+ * summed bottom-up as directories complete and written back to the cache,
+ * so EstimateFolderSize can answer instantly for any folder measured
+ * before, even while it is being re-measured.
+ *
+ * Sizes are apparent sizes (st_size) of regular files. Symlinks are not
+ * followed or counted, and hard-linked files are counted once per link.
+ *
+ * Because a directory's mtime only changes when its entries do, a file
+ * rewritten in place (rather than replaced by rename, as most editors and
+ * copy tools do) is picked up once its directory changes, or when the
+ * measurement is made with FolderSizeOptions::rescan.
+ */
+
+#ifndef FILE_OPS_FOLDER_SIZE_H
+#define FILE_OPS_FOLDER_SIZE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "cancellation_token.h"
+#include "folder_size_cache.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+struct FolderSize {
+    uint64_t bytes = 0;
+    uint64_t files = 0;
+    uint64_t directories = 0;  // below the root
+};
+
+struct FolderSizeOptions {
+    // List every directory even when its cache record is current
+    bool rescan = false;
+    // Polled like Cancel(); a deadline leaves partial totals, as cancelling does
+    CancellationToken cancellation;
+};
+
+struct FolderSizeResult {
+    FolderSize size;
+    bool cancelled = false;
+    bool timedOut = false;
+    uint64_t directoriesListed = 0;
+    uint64_t directoriesReused = 0;
+    uint64_t errorCount = 0;
+    double durationMs = 0;
+};
+
+// Last measured totals for root from the cache, whether or not they are
+// still current. Returns 0, ENOENT if root was never measured, or the errno
+// from stat'ing root.
+int EstimateFolderSize(const FolderSizeCache& cache, const std::string& root, FolderSize* size);
+
+class FolderSizeScanner : public std::enable_shared_from_this<FolderSizeScanner> {
+public:
+    using DoneSink = std::function<void(const FolderSizeResult&)>;
+
+    static std::shared_ptr<FolderSizeScanner> Create(std::string root,
+                                                     std::shared_ptr<FolderSizeCache> cache,
+                                                     FolderSizeOptions options,
+                                                     DoneSink onDone);
+
+    ~FolderSizeScanner();
+
+    FolderSizeScanner(const FolderSizeScanner&) = delete;
+    FolderSizeScanner& operator=(const FolderSizeScanner&) = delete;
+
+    // Opens the root and queues the first task. Returns 0, or the errno from
+    // opening the root, in which case the done sink is never called.
+    int Start(WorkStealingPool& pool);
+
+    // The done sink still runs, with partial totals; nothing is cached.
+    // The options' cancellation token has the same effect.
+    void Cancel();
+    bool IsCancelled() const { return cancellation_.IsCancelled(); }
+
+    // Blocks until the done sink has returned and the cache has been saved
+    void WaitUntilFinished();
+
+private:
+    FolderSizeScanner(std::string root, std::shared_ptr<FolderSizeCache> cache,
+                      FolderSizeOptions options, DoneSink onDone);
+
+    struct Node;
+
+    void Submit(Node* node, std::string relativePath);
+    void ScanDirectory(Node* node, const std::string& relativePath);
+    void ListDirectory(Node* node, const std::string& relativePath);
+    void Complete(Node* node);
+    void Finish(const FolderSize& size);
+
+    std::string root_;
+    std::shared_ptr<FolderSizeCache> cache_;
+    FolderSizeOptions options_;
+    DoneSink onDone_;
+
+    WorkStealingPool* pool_ = nullptr;
+    int rootFd_ = -1;
+    std::chrono::steady_clock::time_point startTime_;
+    int64_t racyThresholdNs_ = 0;
+
+    CancellationSource cancellation_;
+    std::atomic<uint64_t> directoriesListed_{0};
+    std::atomic<uint64_t> directoriesReused_{0};
+    std::atomic<uint64_t> errorCount_{0};
+
+    std::mutex finishMutex_;
+    std::condition_variable finishCv_;
+    bool started_ = false;
+    bool finished_ = false;
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_FOLDER_SIZE_H
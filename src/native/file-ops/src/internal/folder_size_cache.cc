@@ -0,0 +1,332 @@
+/**
+ * @file folder_size_cache.cc
+ * @brief mmap-backed implementation of the folder size cache
+ */
+
+#include "folder_size_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'C', 'D', 'S', 'I', 'Z', 'E', '\0'};
+constexpr uint32_t kVersion = 1;
+
+int WriteAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return 0;
+}
+
+} // namespace
+
+// On-disk layout, native byte order:
+//   FileHeader | DiskRecord[recordCount] | DiskName[nameCount] | char[stringBytes]
+struct FolderSizeCache::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t recordCount;
+    uint64_t nameCount;
+    uint64_t stringBytes;
+};
+
+struct FolderSizeCache::DiskRecord {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t mtimeNs;
+    uint64_t ownBytes;
+    uint64_t ownFiles;
+    uint64_t totalBytes;
+    uint64_t totalFiles;
+    uint64_t totalDirectories;
+    uint64_t firstName;
+    uint32_t nameCount;
+    uint32_t reserved;
+};
+
+struct FolderSizeCache::DiskName {
+    uint32_t offset;
+    uint32_t length;
+};
+
+FolderSizeCache::FolderSizeCache(std::string path) : path_(std::move(path)) {
+    static_assert(sizeof(FileHeader) % 8 == 0, "records must stay 8-byte aligned");
+    static_assert(sizeof(DiskRecord) % 8 == 0, "names must stay 8-byte aligned");
+
+    if (!path_.empty()) {
+        Map();
+    }
+}
+
+FolderSizeCache::~FolderSizeCache() {
+    Unmap();
+}
+
+void FolderSizeCache::Map() {
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        return;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+
+    // A file from another version or a torn write is ignored and replaced on the next Save
+    const auto* header = static_cast<const FileHeader*>(mapping);
+    const uint64_t maxCount = size / sizeof(DiskName);
+    bool valid = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+                 header->version == kVersion &&
+                 header->recordSize == sizeof(DiskRecord) &&
+                 header->recordCount <= maxCount && header->nameCount <= maxCount &&
+                 sizeof(FileHeader) + header->recordCount * sizeof(DiskRecord) +
+                     header->nameCount * sizeof(DiskName) + header->stringBytes == size;
+    if (!valid) {
+        munmap(mapping, size);
+        return;
+    }
+
+    const char* base = static_cast<const char*>(mapping);
+    mapping_ = mapping;
+    mappingSize_ = size;
+    records_ = reinterpret_cast<const DiskRecord*>(base + sizeof(FileHeader));
+    recordCount_ = header->recordCount;
+    names_ = reinterpret_cast<const DiskName*>(records_ + recordCount_);
+    nameCount_ = header->nameCount;
+    strings_ = reinterpret_cast<const char*>(names_ + nameCount_);
+    stringBytes_ = header->stringBytes;
+}
+
+void FolderSizeCache::Unmap() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    records_ = nullptr;
+    recordCount_ = 0;
+    names_ = nullptr;
+    nameCount_ = 0;
+    strings_ = nullptr;
+    stringBytes_ = 0;
+}
+
+const FolderSizeCache::DiskRecord* FolderSizeCache::FindMapped(const DirectoryKey& key) const {
+    const DiskRecord* end = records_ + recordCount_;
+    const DiskRecord* it = std::lower_bound(records_, end, key, [](const DiskRecord& record, const DirectoryKey& k) {
+        return DirectoryKey{record.dev, record.ino} < k;
+    });
+    return it != end && it->dev == key.dev && it->ino == key.ino ? it : nullptr;
+}
+
+bool FolderSizeCache::ReadMapped(const DiskRecord& disk, DirectorySizeRecord* record, bool withSubdirectories) const {
+    record->mtimeNs = disk.mtimeNs;
+    record->ownBytes = disk.ownBytes;
+    record->ownFiles = disk.ownFiles;
+    record->totalBytes = disk.totalBytes;
+    record->totalFiles = disk.totalFiles;
+    record->totalDirectories = disk.totalDirectories;
+    record->subdirectories.clear();
+    if (!withSubdirectories) {
+        return true;
+    }
+
+    if (disk.firstName > nameCount_ || disk.nameCount > nameCount_ - disk.firstName) {
+        return false;
+    }
+    record->subdirectories.reserve(disk.nameCount);
+    for (uint32_t i = 0; i < disk.nameCount; i++) {
+        const DiskName& name = names_[disk.firstName + i];
+        if (name.offset > stringBytes_ || name.length > stringBytes_ - name.offset) {
+            return false;
+        }
+        record->subdirectories.emplace_back(strings_ + name.offset, name.length);
+    }
+    return true;
+}
+
+bool FolderSizeCache::Lookup(const DirectoryKey& key, DirectorySizeRecord* record, bool withSubdirectories) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    auto it = overlay_.find(key);
+    if (it != overlay_.end()) {
+        if (withSubdirectories) {
+            *record = it->second;
+        } else {
+            const DirectorySizeRecord& found = it->second;
+            *record = DirectorySizeRecord{found.mtimeNs, found.ownBytes, found.ownFiles,
+                                          found.totalBytes, found.totalFiles, found.totalDirectories, {}};
+        }
+        return true;
+    }
+
+    const DiskRecord* disk = FindMapped(key);
+    return disk && ReadMapped(*disk, record, withSubdirectories);
+}
+
+void FolderSizeCache::Store(const DirectoryKey& key, DirectorySizeRecord record) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    overlay_[key] = std::move(record);
+}
+
+size_t FolderSizeCache::MappedRecordCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return recordCount_;
+}
+
+size_t FolderSizeCache::PendingRecordCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return overlay_.size();
+}
+
+int FolderSizeCache::Save() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (overlay_.empty()) {
+        return 0;
+    }
+    if (path_.empty()) {
+        if (overlay_.size() > MAX_RECORDS) {
+            overlay_.clear();
+        }
+        return 0;
+    }
+
+    std::vector<std::pair<DirectoryKey, const DirectorySizeRecord*>> stored;
+    stored.reserve(overlay_.size());
+    for (const auto& entry : overlay_) {
+        stored.emplace_back(entry.first, &entry.second);
+    }
+    std::sort(stored.begin(), stored.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    // Stored records always survive; older mapped ones fill the remaining budget
+    size_t mappedBudget = MAX_RECORDS > stored.size() ? MAX_RECORDS - stored.size() : 0;
+
+    std::vector<DiskRecord> records;
+    std::vector<DiskName> names;
+    std::string strings;
+    records.reserve(std::min(recordCount_, mappedBudget) + stored.size());
+
+    auto appendNames = [&](DiskRecord& disk, auto&& forEachName) {
+        disk.firstName = names.size();
+        forEachName([&](const char* data, size_t length) {
+            names.push_back({static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(length)});
+            strings.append(data, length);
+        });
+        disk.nameCount = static_cast<uint32_t>(names.size() - disk.firstName);
+    };
+
+    auto appendStored = [&](const DirectoryKey& key, const DirectorySizeRecord& record) {
+        DiskRecord disk{key.dev, key.ino, record.mtimeNs, record.ownBytes, record.ownFiles,
+                        record.totalBytes, record.totalFiles, record.totalDirectories, 0, 0, 0};
+        appendNames(disk, [&](auto&& add) {
+            for (const auto& name : record.subdirectories) {
+                add(name.data(), name.size());
+            }
+        });
+        records.push_back(disk);
+    };
+
+    auto appendMapped = [&](const DiskRecord& mapped) {
+        if (mapped.firstName > nameCount_ || mapped.nameCount > nameCount_ - mapped.firstName) {
+            return;
+        }
+        DiskRecord disk = mapped;
+        bool valid = true;
+        appendNames(disk, [&](auto&& add) {
+            for (uint32_t i = 0; i < mapped.nameCount && valid; i++) {
+                const DiskName& name = names_[mapped.firstName + i];
+                valid = name.offset <= stringBytes_ && name.length <= stringBytes_ - name.offset;
+                if (valid) {
+                    add(strings_ + name.offset, name.length);
+                }
+            }
+        });
+        if (!valid) {
+            disk.mtimeNs = 0;  // Partial name list; relist on next use
+        }
+        records.push_back(disk);
+    };
+
+    // Merge both sorted sequences; a stored record replaces its mapped one
+    size_t m = 0;
+    for (const auto& [key, record] : stored) {
+        for (; m < recordCount_ && DirectoryKey{records_[m].dev, records_[m].ino} < key; m++) {
+            if (mappedBudget > 0) {
+                appendMapped(records_[m]);
+                mappedBudget--;
+            }
+        }
+        if (m < recordCount_ && DirectoryKey{records_[m].dev, records_[m].ino} == key) {
+            m++;
+        }
+        appendStored(key, *record);
+    }
+    for (; m < recordCount_ && mappedBudget > 0; m++, mappedBudget--) {
+        appendMapped(records_[m]);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.recordSize = sizeof(DiskRecord);
+    header.recordCount = records.size();
+    header.nameCount = names.size();
+    header.stringBytes = strings.size();
+
+    std::string tempPath = path_ + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return errno;
+    }
+    int error = WriteAll(fd, &header, sizeof(header));
+    if (error == 0) error = WriteAll(fd, records.data(), records.size() * sizeof(DiskRecord));
+    if (error == 0) error = WriteAll(fd, names.data(), names.size() * sizeof(DiskName));
+    if (error == 0) error = WriteAll(fd, strings.data(), strings.size());
+    if (close(fd) != 0 && error == 0) {
+        error = errno;
+    }
+    if (error == 0 && rename(tempPath.c_str(), path_.c_str()) != 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        unlink(tempPath.c_str());
+        return error;
+    }
+
+    Unmap();
+    Map();
+    overlay_.clear();
+    return 0;
+}
+
+} // namespace FileCataloger
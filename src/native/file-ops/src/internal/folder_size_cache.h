@@ -0,0 +1,112 @@
+/**
+ * @file folder_size_cache.h
+ * @brief Persistent per-directory size cache keyed by (dev, inode, mtime)
+ *
+ * Each record describes one directory as of its last listing: the bytes
+ * and count of regular files directly inside it, the names of its
+ * subdirectories, and the subtree totals from the last full measurement.
+ * A record is current while the directory's mtime is unchanged, which
+ * holds until an entry is added, removed or renamed inside it.
+ *
+ * The file is a header, the records sorted by (dev, inode), a table of
+ * subdirectory name references and a string blob. It is mapped read-only
+ * and searched in place, so opening a large cache costs no parsing.
+ * Records stored since then live in an in-memory overlay until Save()
+ * rewrites the file (to a temporary name, then renamed over it) and
+ * remaps it.
+ *
+ * Lookup and Store are safe from any thread; Save excludes both.
+ */
+
+#ifndef FILE_OPS_FOLDER_SIZE_CACHE_H
+#define FILE_OPS_FOLDER_SIZE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FileCataloger {
+
+struct DirectoryKey {
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+
+    bool operator==(const DirectoryKey& other) const { return dev == other.dev && ino == other.ino; }
+    bool operator<(const DirectoryKey& other) const {
+        return dev != other.dev ? dev < other.dev : ino < other.ino;
+    }
+};
+
+struct DirectoryKeyHash {
+    size_t operator()(const DirectoryKey& key) const {
+        return std::hash<uint64_t>()(key.ino * 0x9E3779B97F4A7C15ULL ^ key.dev);
+    }
+};
+
+struct DirectorySizeRecord {
+    int64_t mtimeNs = 0;            // 0 never matches, forcing a fresh listing
+    uint64_t ownBytes = 0;          // regular files directly inside
+    uint64_t ownFiles = 0;
+    uint64_t totalBytes = 0;        // whole subtree at the last measurement
+    uint64_t totalFiles = 0;
+    uint64_t totalDirectories = 0;  // below this directory
+    std::vector<std::string> subdirectories;
+};
+
+class FolderSizeCache {
+public:
+    // Older records beyond this are dropped on Save
+    static constexpr size_t MAX_RECORDS = 1 << 20;
+
+    // Maps the cache file at path if it exists and is valid; an empty path
+    // keeps the cache in memory only
+    explicit FolderSizeCache(std::string path);
+    ~FolderSizeCache();
+
+    FolderSizeCache(const FolderSizeCache&) = delete;
+    FolderSizeCache& operator=(const FolderSizeCache&) = delete;
+
+    // Copies the record out; subdirectory names are skipped unless requested
+    bool Lookup(const DirectoryKey& key, DirectorySizeRecord* record, bool withSubdirectories = true) const;
+    void Store(const DirectoryKey& key, DirectorySizeRecord record);
+
+    // Writes mapped and stored records back to disk if anything was stored.
+    // Returns 0 or an errno; the in-memory state is kept on failure.
+    int Save();
+
+    size_t MappedRecordCount() const;
+    size_t PendingRecordCount() const;
+    const std::string& path() const { return path_; }
+
+private:
+    struct FileHeader;
+    struct DiskRecord;
+    struct DiskName;
+
+    void Map();
+    void Unmap();
+    const DiskRecord* FindMapped(const DirectoryKey& key) const;
+    bool ReadMapped(const DiskRecord& disk, DirectorySizeRecord* record, bool withSubdirectories) const;
+
+    std::string path_;
+    mutable std::shared_mutex mutex_;
+
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    const DiskRecord* records_ = nullptr;
+    size_t recordCount_ = 0;
+    const DiskName* names_ = nullptr;
+    size_t nameCount_ = 0;
+    const char* strings_ = nullptr;
+    size_t stringBytes_ = 0;
+
+    std::unordered_map<DirectoryKey, DirectorySizeRecord, DirectoryKeyHash> overlay_;
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_FOLDER_SIZE_CACHE_H
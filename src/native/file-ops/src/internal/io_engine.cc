@@ -0,0 +1,608 @@
+/**
+ * @file io_engine.cc
+ * @brief Syscall and io_uring IoEngines
+ *
+ * The io_uring engine talks to the kernel directly (io_uring_setup,
+ * io_uring_enter, io_uring_register and the mmapped rings) rather than
+ * through liburing, which is not available on every build host.
+ */
+
+#include "io_engine.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define FILE_OPS_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace FileCataloger {
+
+namespace {
+
+void FillStat(const struct stat& st, IoStat* out) {
+    out->error = 0;
+    out->mode = st.st_mode;
+    out->size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+    out->mtimeNs = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    out->mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+}
+
+void StatOne(const std::string& path, IoStat* out) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        *out = IoStat();
+        out->error = errno;
+        return;
+    }
+    FillStat(st, out);
+}
+
+bool WantsHeader(const IoStat& stat) {
+    return stat.error == 0 && S_ISREG(stat.mode) && stat.size > 0;
+}
+
+// open, fstat, pread, close. O_NONBLOCK: a path swapped for a FIFO since
+// it was stat'ed must not block; the fstat then refreshes its type.
+void ReadHeaderOne(const std::string& path, size_t headerBytes, IoHeader* out, uint8_t* header) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        out->readError = errno;
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        out->readError = errno;
+    } else {
+        FillStat(st, &out->stat);
+        if (WantsHeader(out->stat)) {
+            ssize_t n;
+            do {
+                n = pread(fd, header, headerBytes, 0);
+            } while (n < 0 && errno == EINTR);
+            if (n < 0) {
+                out->readError = errno;
+            } else {
+                out->length = static_cast<uint32_t>(n);
+            }
+        }
+    }
+    close(fd);
+}
+
+class SyscallEngine : public IoEngine {
+public:
+    IoEngineKind Kind() const override { return IoEngineKind::Syscalls; }
+
+    void Stat(const std::string* paths, size_t count, IoStat* out) override {
+        for (size_t i = 0; i < count; i++) {
+            StatOne(paths[i], &out[i]);
+        }
+    }
+
+    void ReadHeaders(const std::string* paths, size_t count, size_t headerBytes, IoHeader* out,
+                     uint8_t* headers) override {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = IoHeader();
+            StatOne(paths[i], &out[i].stat);
+            if (WantsHeader(out[i].stat)) {
+                ReadHeaderOne(paths[i], headerBytes, &out[i], headers + i * headerBytes);
+            }
+        }
+    }
+
+    void Rename(const std::string* from, const std::string* to, size_t count, int* errors) override {
+        for (size_t i = 0; i < count; i++) {
+            errors[i] = ::rename(from[i].c_str(), to[i].c_str()) == 0 ? 0 : errno;
+        }
+    }
+
+    void Unlink(const std::string* paths, size_t count, int* errors) override {
+        for (size_t i = 0; i < count; i++) {
+            errors[i] = ::unlink(paths[i].c_str()) == 0 ? 0 : errno;
+        }
+    }
+};
+
+#if defined(FILE_OPS_HAVE_IO_URING)
+
+/**
+ * One io_uring instance, used only by the thread that created it
+ * (IORING_SETUP_SINGLE_ISSUER where the kernel has it). Callers queue at
+ * most kEntries SQEs, then Run() submits them and reaps every completion.
+ */
+class Ring {
+public:
+    static constexpr unsigned kEntries = 256;
+    // Files per open -> read -> close window: 3 SQEs each
+    static constexpr unsigned kHeaderSlots = 64;
+    static constexpr size_t kHeaderSlotBytes = 4096;
+
+    static std::unique_ptr<Ring> Create() {
+        std::unique_ptr<Ring> ring(new Ring());
+        return ring->Setup() ? std::move(ring) : nullptr;
+    }
+
+    ~Ring() {
+        if (sqes_ != MAP_FAILED) {
+            munmap(sqes_, sqesSize_);
+        }
+        if (cqMap_ != MAP_FAILED && cqMap_ != sqMap_) {
+            munmap(cqMap_, cqMapSize_);
+        }
+        if (sqMap_ != MAP_FAILED) {
+            munmap(sqMap_, sqMapSize_);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    io_uring_sqe* Queue(uint8_t opcode, uint64_t userData) {
+        unsigned index = tail_ & *sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->user_data = userData;
+        sqArray_[index] = index;
+        tail_++;
+        return sqe;
+    }
+
+    // Submits what was queued and calls onCompletion(userData, res) for
+    // each of expected completions. Returns 0, or the errno that stopped
+    // io_uring_enter, in which case some completions were not delivered.
+    template<typename F>
+    int Run(unsigned expected, F&& onCompletion) {
+        __atomic_store_n(sqTail_, tail_, __ATOMIC_RELEASE);
+        unsigned toSubmit = tail_ - submitted_;
+        unsigned reaped = 0;
+        while (reaped < expected) {
+            int result = static_cast<int>(
+                syscall(__NR_io_uring_enter, fd_, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (result < 0) {
+                // EAGAIN/EBUSY: the kernel is short of resources or the CQ is full; reap and retry
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    int error = errno;
+                    submitted_ = tail_;
+                    return error;
+                }
+            } else {
+                toSubmit -= static_cast<unsigned>(result);
+                submitted_ += static_cast<unsigned>(result);
+            }
+
+            unsigned head = *cqHead_;
+            unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; head++, reaped++) {
+                const io_uring_cqe& cqe = cqes_[head & *cqMask_];
+                onCompletion(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        }
+        return 0;
+    }
+
+    uint8_t* HeaderSlot(unsigned slot) { return headerBuffers_.get() + slot * kHeaderSlotBytes; }
+
+    struct statx* StatxSlot(unsigned slot) { return &statx_[slot]; }
+
+private:
+    Ring() = default;
+
+    bool Setup() {
+        io_uring_params params;
+        // Fewer interrupts where the kernel has them: completions are only
+        // needed when Run() asks
+        const unsigned flagSets[] = {
+#if defined(IORING_SETUP_DEFER_TASKRUN)
+            IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN,
+#endif
+#if defined(IORING_SETUP_COOP_TASKRUN)
+            IORING_SETUP_COOP_TASKRUN,
+#endif
+            0,
+        };
+        for (unsigned flags : flagSets) {
+            std::memset(&params, 0, sizeof(params));
+            params.flags = flags;
+            fd_ = static_cast<int>(syscall(__NR_io_uring_setup, kEntries, &params));
+            if (fd_ >= 0 || errno != EINVAL) {
+                break;
+            }
+        }
+        if (fd_ < 0) {
+            return false;
+        }
+
+        sqMapSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMapSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqMapSize_ = cqMapSize_ = std::max(sqMapSize_, cqMapSize_);
+        }
+        sqMap_ = mmap(nullptr, sqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                      IORING_OFF_SQ_RING);
+        if (sqMap_ == MAP_FAILED) {
+            return false;
+        }
+        cqMap_ = singleMap ? sqMap_
+                           : mmap(nullptr, cqMapSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                  IORING_OFF_CQ_RING);
+        if (cqMap_ == MAP_FAILED) {
+            return false;
+        }
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(
+            mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) {
+            return false;
+        }
+
+        auto* sq = static_cast<uint8_t*>(sqMap_);
+        auto* cq = static_cast<uint8_t*>(cqMap_);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        tail_ = submitted_ = *sqTail_;
+
+        // Opcodes this engine queues. LINKAT is not used; it arrived in the
+        // same release (5.15) as opening into a registered descriptor slot,
+        // which the probe cannot ask about directly.
+        const uint8_t required[] = {IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ_FIXED, IORING_OP_CLOSE,
+                                    IORING_OP_RENAMEAT, IORING_OP_UNLINKAT, IORING_OP_LINKAT};
+        const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+        std::unique_ptr<uint8_t[]> probeBytes(new uint8_t[probeSize]());
+        auto* probe = reinterpret_cast<io_uring_probe*>(probeBytes.get());
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, 256) != 0) {
+            return false;
+        }
+        for (uint8_t op : required) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+
+        // Empty descriptor slots for the header chains, and one buffer they read into
+        int slots[kHeaderSlots];
+        std::fill(std::begin(slots), std::end(slots), -1);
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_FILES, slots, kHeaderSlots) != 0) {
+            return false;
+        }
+        headerBuffers_.reset(new uint8_t[kHeaderSlots * kHeaderSlotBytes]);
+        iovec buffer = {headerBuffers_.get(), kHeaderSlots * kHeaderSlotBytes};
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, &buffer, 1) != 0) {
+            return false;
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+    void* sqMap_ = MAP_FAILED;
+    void* cqMap_ = MAP_FAILED;
+    size_t sqMapSize_ = 0;
+    size_t cqMapSize_ = 0;
+    io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize_ = 0;
+
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqMask_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned* cqMask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    unsigned tail_ = 0;        // next SQE to queue
+    unsigned submitted_ = 0;   // SQEs the kernel has consumed
+
+    std::unique_ptr<uint8_t[]> headerBuffers_;
+    struct statx statx_[kEntries];
+};
+
+// Per thread: a ring may only be used by one issuer
+thread_local std::unique_ptr<Ring> t_ring;
+thread_local bool t_ringFailed = false;
+
+Ring* ThreadRing() {
+    if (!t_ring && !t_ringFailed) {
+        t_ring = Ring::Create();
+        t_ringFailed = t_ring == nullptr;
+    }
+    return t_ring.get();
+}
+
+// After io_uring_enter failed outright, requests may still be in flight
+// and write into the ring's buffers, so it is leaked rather than closed.
+// This thread makes plain syscalls from now on.
+void AbandonThreadRing() {
+    t_ring.release();
+    t_ringFailed = true;
+}
+
+// Header chain stages, in the low bits of user_data
+constexpr uint64_t kOpenStage = 0;
+constexpr uint64_t kReadStage = 1;
+constexpr uint64_t kCloseStage = 2;
+
+class UringEngine : public IoEngine {
+public:
+    IoEngineKind Kind() const override { return IoEngineKind::IoUring; }
+
+    void Stat(const std::string* paths, size_t count, IoStat* out) override {
+        Ring* ring = ThreadRing();
+        if (!ring) {
+            SyscallIoEngine().Stat(paths, count, out);
+            return;
+        }
+        StatInto(*ring, paths, count, [out](size_t i) -> IoStat& { return out[i]; });
+    }
+
+    void ReadHeaders(const std::string* paths, size_t count, size_t headerBytes, IoHeader* out,
+                     uint8_t* headers) override {
+        Ring* ring = ThreadRing();
+        if (!ring || headerBytes > Ring::kHeaderSlotBytes) {
+            SyscallIoEngine().ReadHeaders(paths, count, headerBytes, out, headers);
+            return;
+        }
+        for (size_t i = 0; i < count; i++) {
+            out[i] = IoHeader();
+        }
+        StatInto(*ring, paths, count, [out](size_t i) -> IoStat& { return out[i].stat; });
+
+        // Only non-empty regular files are opened
+        std::vector<uint32_t> wanted;
+        for (size_t i = 0; i < count; i++) {
+            if (WantsHeader(out[i].stat)) {
+                wanted.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        for (size_t begin = 0; begin < wanted.size(); begin += Ring::kHeaderSlots) {
+            const unsigned n = static_cast<unsigned>(std::min<size_t>(Ring::kHeaderSlots, wanted.size() - begin));
+            for (unsigned slot = 0; slot < n; slot++) {
+                const std::string& path = paths[wanted[begin + slot]];
+                const uint64_t tag = static_cast<uint64_t>(slot) << 2;
+
+                // O_NONBLOCK so a path swapped for a FIFO cannot hold the
+                // open forever; no O_CLOEXEC, which slots do not accept
+                io_uring_sqe* openSqe = ring->Queue(IORING_OP_OPENAT, tag | kOpenStage);
+                openSqe->fd = AT_FDCWD;
+                openSqe->addr = reinterpret_cast<uint64_t>(path.c_str());
+                openSqe->open_flags = O_RDONLY | O_NONBLOCK;
+                openSqe->file_index = slot + 1;
+                openSqe->flags = IOSQE_IO_LINK;
+
+                // Hard link: the close runs even when the read fails
+                io_uring_sqe* readSqe = ring->Queue(IORING_OP_READ_FIXED, tag | kReadStage);
+                readSqe->fd = static_cast<int>(slot);
+                readSqe->addr = reinterpret_cast<uint64_t>(ring->HeaderSlot(slot));
+                readSqe->len = static_cast<uint32_t>(headerBytes);
+                readSqe->buf_index = 0;
+                readSqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+
+                io_uring_sqe* closeSqe = ring->Queue(IORING_OP_CLOSE, tag | kCloseStage);
+                closeSqe->file_index = slot + 1;
+            }
+
+            // A read of a header that is not in the page cache fails with
+            // EAGAIN on an O_NONBLOCK file; those are read again with pread
+            bool again[Ring::kHeaderSlots] = {};
+            int error = ring->Run(3 * n, [&](uint64_t userData, int res) {
+                const unsigned slot = static_cast<unsigned>(userData >> 2);
+                IoHeader& header = out[wanted[begin + slot]];
+                switch (userData & 3) {
+                case kOpenStage:
+                    if (res < 0) {
+                        header.readError = -res;
+                    }
+                    break;
+                case kReadStage:
+                    if (res >= 0) {
+                        header.length = static_cast<uint32_t>(res);
+                    } else if (res == -EAGAIN) {
+                        again[slot] = true;
+                    } else if (header.readError == 0) {
+                        header.readError = -res;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            });
+
+            if (error != 0) {
+                AbandonThreadRing();
+            }
+            for (unsigned slot = 0; slot < n; slot++) {
+                const size_t i = wanted[begin + slot];
+                if (error != 0 || again[slot]) {
+                    out[i].readError = 0;
+                    out[i].length = 0;
+                    ReadHeaderOne(paths[i], headerBytes, &out[i], headers + i * headerBytes);
+                } else if (out[i].readError == 0) {
+                    std::memcpy(headers + i * headerBytes, ring->HeaderSlot(slot), out[i].length);
+                }
+            }
+        }
+    }
+
+    void Rename(const std::string* from, const std::string* to, size_t count, int* errors) override {
+        Ring* ring = ThreadRing();
+        if (!ring) {
+            SyscallIoEngine().Rename(from, to, count, errors);
+            return;
+        }
+        RunWindows(*ring, count, errors, [&](size_t i, uint64_t tag) {
+            io_uring_sqe* sqe = ring->Queue(IORING_OP_RENAMEAT, tag);
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uint64_t>(from[i].c_str());
+            sqe->len = static_cast<uint32_t>(AT_FDCWD);
+            sqe->off = reinterpret_cast<uint64_t>(to[i].c_str());
+        });
+    }
+
+    void Unlink(const std::string* paths, size_t count, int* errors) override {
+        Ring* ring = ThreadRing();
+        if (!ring) {
+            SyscallIoEngine().Unlink(paths, count, errors);
+            return;
+        }
+        RunWindows(*ring, count, errors, [&](size_t i, uint64_t tag) {
+            io_uring_sqe* sqe = ring->Queue(IORING_OP_UNLINKAT, tag);
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uint64_t>(paths[i].c_str());
+        });
+    }
+
+private:
+    template<typename Slot>
+    static void StatInto(Ring& ring, const std::string* paths, size_t count, Slot&& slotOf) {
+        for (size_t begin = 0; begin < count; begin += Ring::kEntries) {
+            const unsigned n = static_cast<unsigned>(std::min<size_t>(Ring::kEntries, count - begin));
+            for (unsigned j = 0; j < n; j++) {
+                io_uring_sqe* sqe = ring.Queue(IORING_OP_STATX, j);
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<uint64_t>(paths[begin + j].c_str());
+                sqe->len = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME;
+                sqe->off = reinterpret_cast<uint64_t>(ring.StatxSlot(j));
+                sqe->statx_flags = AT_STATX_SYNC_AS_STAT;
+            }
+            bool delivered[Ring::kEntries] = {};
+            int error = ring.Run(n, [&](uint64_t j, int res) {
+                IoStat& stat = slotOf(begin + j);
+                delivered[j] = true;
+                if (res < 0) {
+                    stat = IoStat();
+                    stat.error = -res;
+                    return;
+                }
+                const struct statx& sx = *ring.StatxSlot(static_cast<unsigned>(j));
+                stat.error = 0;
+                stat.mode = sx.stx_mode;
+                stat.size = sx.stx_size;
+                stat.mtimeNs = static_cast<int64_t>(sx.stx_mtime.tv_sec) * 1000000000LL + sx.stx_mtime.tv_nsec;
+            });
+            if (error != 0) {
+                AbandonThreadRing();
+                for (unsigned j = 0; j < n; j++) {
+                    if (!delivered[j]) {
+                        StatOne(paths[begin + j], &slotOf(begin + j));
+                    }
+                }
+            }
+        }
+    }
+
+    // For operations that must not be repeated (rename, unlink): an op
+    // whose completion was lost to a failed io_uring_enter reports its errno
+    template<typename Queue>
+    static void RunWindows(Ring& ring, size_t count, int* errors, Queue&& queue) {
+        for (size_t begin = 0; begin < count; begin += Ring::kEntries) {
+            const unsigned n = static_cast<unsigned>(std::min<size_t>(Ring::kEntries, count - begin));
+            for (unsigned j = 0; j < n; j++) {
+                errors[begin + j] = -1;
+                queue(begin + j, j);
+            }
+            int error = ring.Run(n, [&](uint64_t j, int res) { errors[begin + j] = res < 0 ? -res : 0; });
+            if (error != 0) {
+                AbandonThreadRing();
+                for (unsigned j = 0; j < n; j++) {
+                    if (errors[begin + j] == -1) {
+                        errors[begin + j] = error;
+                    }
+                }
+            }
+        }
+    }
+};
+
+/**
+ * What DefaultIoEngine() hands out: io_uring for header reads only. The
+ * kernel always punts statx, renameat and unlinkat to its io-wq workers,
+ * and on a warm cache that handoff costs more than the syscall it saves
+ * (io_engine_bench: 0.5-0.8x); an open -> read -> close chain completes
+ * inline and wins (1.3x).
+ */
+class DefaultEngine : public IoEngine {
+public:
+    explicit DefaultEngine(IoEngine& uring) : uring_(uring) {}
+
+    IoEngineKind Kind() const override { return IoEngineKind::IoUring; }
+
+    void Stat(const std::string* paths, size_t count, IoStat* out) override {
+        SyscallIoEngine().Stat(paths, count, out);
+    }
+
+    void ReadHeaders(const std::string* paths, size_t count, size_t headerBytes, IoHeader* out,
+                     uint8_t* headers) override {
+        uring_.ReadHeaders(paths, count, headerBytes, out, headers);
+    }
+
+    void Rename(const std::string* from, const std::string* to, size_t count, int* errors) override {
+        SyscallIoEngine().Rename(from, to, count, errors);
+    }
+
+    void Unlink(const std::string* paths, size_t count, int* errors) override {
+        SyscallIoEngine().Unlink(paths, count, errors);
+    }
+
+private:
+    IoEngine& uring_;
+};
+
+#endif // FILE_OPS_HAVE_IO_URING
+
+} // namespace
+
+const char* IoEngineName(IoEngineKind kind) {
+    return kind == IoEngineKind::IoUring ? "io_uring" : "syscalls";
+}
+
+IoEngine& SyscallIoEngine() {
+    static SyscallEngine engine;
+    return engine;
+}
+
+IoEngine* UringIoEngine() {
+#if defined(FILE_OPS_HAVE_IO_URING)
+    static UringEngine engine;
+    static const bool available = ThreadRing() != nullptr;
+    return available ? &engine : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+IoEngine& DefaultIoEngine() {
+#if defined(FILE_OPS_HAVE_IO_URING)
+    if (IoEngine* uring = UringIoEngine()) {
+        static DefaultEngine engine(*uring);
+        return engine;
+    }
+#endif
+    return SyscallIoEngine();
+}
+
+} // namespace FileCataloger
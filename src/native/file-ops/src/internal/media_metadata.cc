@@ -0,0 +1,1068 @@
+/**
+ * @file media_metadata.cc
+ * @brief Header-only EXIF/TIFF, PNG and ISO-BMFF metadata parsing
+ */
+
+#include "media_metadata.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr int kMaxSegments = 256;       // JPEG markers before the first scan
+constexpr int kMaxChunks = 1024;        // PNG chunks before the first IDAT
+constexpr int kMaxBoxes = 4096;         // ISO-BMFF boxes per level
+constexpr int kMaxBoxDepth = 8;
+constexpr int kMaxIfdEntries = 1024;
+constexpr size_t kMaxString = 64;       // camera make/model
+constexpr size_t kMaxDateString = 64;
+
+// Seconds from 1904-01-01 (QuickTime/ISO-BMFF epoch) to 1970-01-01
+constexpr uint64_t kMacEpochOffset = 2082844800ull;
+
+uint16_t Be16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+uint32_t Be32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+           static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+uint64_t Be64(const uint8_t* p) {
+    return static_cast<uint64_t>(Be32(p)) << 32 | Be32(p + 4);
+}
+
+uint64_t BeN(const uint8_t* p, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value = value << 8 | p[i];
+    }
+    return value;
+}
+
+constexpr uint32_t FourCc(const char (&code)[5]) {
+    return static_cast<uint32_t>(static_cast<uint8_t>(code[0])) << 24 |
+           static_cast<uint32_t>(static_cast<uint8_t>(code[1])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(code[2])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(code[3]));
+}
+
+// Printable ASCII/UTF-8 up to the first NUL, trailing spaces trimmed
+std::string CleanString(const uint8_t* data, size_t size, size_t maxLength) {
+    std::string value;
+    for (size_t i = 0; i < size && data[i] != 0 && value.size() < maxLength; i++) {
+        value.push_back(data[i] < 0x20 ? ' ' : static_cast<char>(data[i]));
+    }
+    size_t begin = value.find_first_not_of(' ');
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    return value.substr(begin, value.find_last_not_of(' ') - begin + 1);
+}
+
+int ReadDigits(const char*& p, const char* end, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++, p++) {
+        if (p >= end || *p < '0' || *p > '9') {
+            return -1;
+        }
+        value = value * 10 + (*p - '0');
+    }
+    return value;
+}
+
+// "+02:00", "-0530" or "Z"; seconds east of UTC
+bool ParseZone(const char*& p, const char* end, int* offsetSeconds) {
+    if (p < end && *p == 'Z') {
+        p++;
+        *offsetSeconds = 0;
+        return true;
+    }
+    if (p >= end || (*p != '+' && *p != '-')) {
+        return false;
+    }
+    const int sign = *p++ == '-' ? -1 : 1;
+    const int hours = ReadDigits(p, end, 2);
+    if (p < end && *p == ':') {
+        p++;
+    }
+    const int minutes = ReadDigits(p, end, 2);
+    if (hours < 0 || minutes < 0 || hours > 14 || minutes > 59) {
+        return false;
+    }
+    *offsetSeconds = sign * (hours * 3600 + minutes * 60);
+    return true;
+}
+
+int64_t ToUnixMs(struct tm& fields, int milliseconds, bool hasZone, int offsetSeconds) {
+    if (hasZone) {
+        return (static_cast<int64_t>(timegm(&fields)) - offsetSeconds) * 1000 + milliseconds;
+    }
+    fields.tm_isdst = -1;
+    return static_cast<int64_t>(mktime(&fields)) * 1000 + milliseconds;
+}
+
+/**
+ * EXIF "YYYY:MM:DD HH:MM:SS" and ISO 8601 "YYYY-MM-DDTHH:MM:SS[.fff][zone]".
+ * A zone in the string wins over zoneOffset; without either the time is local.
+ */
+bool ParseDateTime(const std::string& text, const int* zoneOffset, int64_t* ms) {
+    const char* p = text.c_str();
+    const char* end = p + text.size();
+    struct tm fields {};
+    const int year = ReadDigits(p, end, 4);
+    if (year < 1900 || p >= end || (*p != ':' && *p != '-')) {
+        return false;
+    }
+    p++;
+    const int month = ReadDigits(p, end, 2);
+    if (p >= end || (*p != ':' && *p != '-')) {
+        return false;
+    }
+    p++;
+    const int day = ReadDigits(p, end, 2);
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+    fields.tm_year = year - 1900;
+    fields.tm_mon = month - 1;
+    fields.tm_mday = day;
+
+    int milliseconds = 0;
+    if (p < end && (*p == ' ' || *p == 'T')) {
+        p++;
+        const int hour = ReadDigits(p, end, 2);
+        const int minute = (p < end && *p == ':') ? (p++, ReadDigits(p, end, 2)) : -1;
+        const int second = (p < end && *p == ':') ? (p++, ReadDigits(p, end, 2)) : 0;
+        if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60) {
+            return false;
+        }
+        fields.tm_hour = hour;
+        fields.tm_min = minute;
+        fields.tm_sec = second;
+        if (p < end && *p == '.') {
+            p++;
+            for (int scale = 100; p < end && *p >= '0' && *p <= '9'; p++, scale /= 10) {
+                milliseconds += (*p - '0') * scale;
+            }
+        }
+    }
+
+    int offset = 0;
+    bool hasZone = ParseZone(p, end, &offset);
+    if (!hasZone && zoneOffset) {
+        offset = *zoneOffset;
+        hasZone = true;
+    }
+    *ms = ToUnixMs(fields, milliseconds, hasZone, offset);
+    return true;
+}
+
+// RFC 1123 "Sat, 01 Jan 2000 12:00:00 GMT", as the PNG spec suggests for "Creation Time"
+bool ParseRfc1123(const std::string& text, int64_t* ms) {
+    static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    const size_t comma = text.find(", ");
+    const char* p = text.c_str() + (comma == std::string::npos ? 0 : comma + 2);
+    const char* end = text.c_str() + text.size();
+    struct tm fields {};
+    fields.tm_mday = ReadDigits(p, end, 2);
+    if (fields.tm_mday < 1 || end - p < 5 || *p != ' ') {
+        return false;
+    }
+    p++;
+    fields.tm_mon = -1;
+    for (int i = 0; i < 12; i++) {
+        if (std::strncmp(p, months[i], 3) == 0) {
+            fields.tm_mon = i;
+        }
+    }
+    p += 4;
+    const int year = ReadDigits(p, end, 4);
+    if (fields.tm_mon < 0 || year < 1900) {
+        return false;
+    }
+    fields.tm_year = year - 1900;
+    if (p < end && *p == ' ') {
+        p++;
+        fields.tm_hour = ReadDigits(p, end, 2);
+        fields.tm_min = (p < end && *p == ':') ? (p++, ReadDigits(p, end, 2)) : -1;
+        fields.tm_sec = (p < end && *p == ':') ? (p++, ReadDigits(p, end, 2)) : 0;
+        if (fields.tm_hour < 0 || fields.tm_min < 0 || fields.tm_sec < 0) {
+            return false;
+        }
+    }
+    while (p < end && *p == ' ') {
+        p++;
+    }
+    int offset = 0;
+    const bool hasZone = (end - p >= 3 && std::strncmp(p, "GMT", 3) == 0) || (end - p >= 3 && std::strncmp(p, "UTC", 3) == 0) ||
+                         ParseZone(p, end, &offset);
+    *ms = ToUnixMs(fields, 0, hasZone, offset);
+    return true;
+}
+
+void SetCaptureTime(MediaMetadata* metadata, int64_t ms) {
+    metadata->captureTimeMs = ms;
+    metadata->fields |= kMediaCaptureTime;
+}
+
+void SetDimensions(MediaMetadata* metadata, uint32_t width, uint32_t height) {
+    if (width > 0 && height > 0) {
+        metadata->width = width;
+        metadata->height = height;
+        metadata->fields |= kMediaDimensions;
+    }
+}
+
+void SetCamera(MediaMetadata* metadata, std::string make, std::string model) {
+    if (!make.empty()) {
+        metadata->cameraMake = std::move(make);
+    }
+    if (!model.empty()) {
+        metadata->cameraModel = std::move(model);
+    }
+    if (!metadata->cameraMake.empty() || !metadata->cameraModel.empty()) {
+        metadata->fields |= kMediaCamera;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TIFF / EXIF
+// ---------------------------------------------------------------------------
+
+class TiffBlock {
+public:
+    TiffBlock(MediaMetadataReader& reader, uint64_t base, uint64_t limit)
+        : reader_(reader), base_(base), limit_(std::min(limit, reader.Size())) {}
+
+    bool ReadHeader(uint32_t* firstIfd) {
+        const uint8_t* p = At(0, 8);
+        if (!p) {
+            return false;
+        }
+        // Standard byte orders, plus the magic numbers of Panasonic (U) and Olympus (RO/RS) raw files
+        if (p[0] == 'I' && p[1] == 'I' && (p[2] == 42 || p[2] == 'U' || p[2] == 'R')) {
+            little_ = true;
+        } else if (p[0] == 'M' && p[1] == 'M' && p[3] == 42) {
+            little_ = false;
+        } else {
+            return false;
+        }
+        *firstIfd = U32(p + 4);
+        return true;
+    }
+
+    const uint8_t* At(uint64_t offset, size_t length) {
+        if (base_ > limit_ || offset > limit_ - base_ || length > limit_ - base_ - offset) {
+            return nullptr;
+        }
+        return reader_.Map(base_ + offset, length);
+    }
+
+    uint16_t U16(const uint8_t* p) const {
+        return little_ ? static_cast<uint16_t>(p[0] | p[1] << 8) : Be16(p);
+    }
+
+    uint32_t U32(const uint8_t* p) const {
+        return little_ ? static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                             static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24
+                       : Be32(p);
+    }
+
+    // Value bytes of a 12-byte IFD entry: inline when they fit in 4 bytes
+    const uint8_t* Value(const uint8_t* entry, size_t* size) {
+        static const uint8_t kTypeSizes[] = {0, 1, 1, 2, 4, 8, 1, 1, 2, 4, 8, 4, 8};
+        const uint16_t type = U16(entry + 2);
+        const uint32_t count = U32(entry + 4);
+        if (type == 0 || type >= sizeof(kTypeSizes) || count > (1u << 16)) {
+            return nullptr;
+        }
+        *size = static_cast<size_t>(count) * kTypeSizes[type];
+        return *size <= 4 ? entry + 8 : At(U32(entry + 8), *size);
+    }
+
+    std::string String(const uint8_t* entry, size_t maxLength) {
+        size_t size = 0;
+        const uint8_t* value = Value(entry, &size);
+        return value ? CleanString(value, size, maxLength) : std::string();
+    }
+
+    uint32_t Number(const uint8_t* entry) {
+        size_t size = 0;
+        const uint8_t* value = Value(entry, &size);
+        if (!value) {
+            return 0;
+        }
+        const uint16_t type = U16(entry + 2);
+        return type == 3 && size >= 2 ? U16(value) : (type == 4 && size >= 4 ? U32(value) : 0);
+    }
+
+private:
+    MediaMetadataReader& reader_;
+    uint64_t base_;
+    uint64_t limit_;
+    bool little_ = true;
+};
+
+struct ExifFields {
+    std::string make, model;
+    std::string dateTime, dateTimeOriginal, dateTimeDigitized;
+    std::string offsetTime, offsetTimeOriginal, offsetTimeDigitized;
+    std::string subSecTimeOriginal;
+    uint32_t width = 0, height = 0;             // IFD0
+    uint32_t pixelWidth = 0, pixelHeight = 0;   // EXIF IFD
+};
+
+template <typename Visit>
+void ForEachIfdEntry(TiffBlock& tiff, uint32_t offset, Visit visit) {
+    const uint8_t* header = tiff.At(offset, 2);
+    if (!header) {
+        return;
+    }
+    const int count = std::min<int>(tiff.U16(header), kMaxIfdEntries);
+    const uint8_t* entries = tiff.At(offset + 2ull, static_cast<size_t>(count) * 12);
+    for (int i = 0; entries && i < count; i++) {
+        visit(tiff.U16(entries + i * 12), entries + i * 12);
+    }
+}
+
+/**
+ * Reads IFD0 and the EXIF IFD of the TIFF structure at [base, limit).
+ * ifd0Dimensions: take ImageWidth/ImageLength from IFD0 (plain TIFF files;
+ * in raw files IFD0 often describes a preview).
+ */
+bool ParseTiff(MediaMetadataReader& reader, uint64_t base, uint64_t limit, bool ifd0Dimensions,
+               MediaMetadata* metadata) {
+    TiffBlock tiff(reader, base, limit);
+    uint32_t ifd0 = 0;
+    if (!tiff.ReadHeader(&ifd0)) {
+        return false;
+    }
+
+    ExifFields exif;
+    uint32_t exifIfd = 0;
+    ForEachIfdEntry(tiff, ifd0, [&](uint16_t tag, const uint8_t* entry) {
+        switch (tag) {
+            case 0x0100: exif.width = tiff.Number(entry); break;
+            case 0x0101: exif.height = tiff.Number(entry); break;
+            case 0x010F: exif.make = tiff.String(entry, kMaxString); break;
+            case 0x0110: exif.model = tiff.String(entry, kMaxString); break;
+            case 0x0132: exif.dateTime = tiff.String(entry, kMaxDateString); break;
+            case 0x8769: exifIfd = tiff.Number(entry); break;
+            default: break;
+        }
+    });
+    if (exifIfd != 0 && exifIfd != ifd0) {
+        ForEachIfdEntry(tiff, exifIfd, [&](uint16_t tag, const uint8_t* entry) {
+            switch (tag) {
+                case 0x9003: exif.dateTimeOriginal = tiff.String(entry, kMaxDateString); break;
+                case 0x9004: exif.dateTimeDigitized = tiff.String(entry, kMaxDateString); break;
+                case 0x9010: exif.offsetTime = tiff.String(entry, 16); break;
+                case 0x9011: exif.offsetTimeOriginal = tiff.String(entry, 16); break;
+                case 0x9012: exif.offsetTimeDigitized = tiff.String(entry, 16); break;
+                case 0x9291: exif.subSecTimeOriginal = tiff.String(entry, 9); break;
+                case 0xA002: exif.pixelWidth = tiff.Number(entry); break;
+                case 0xA003: exif.pixelHeight = tiff.Number(entry); break;
+                default: break;
+            }
+        });
+    }
+
+    // DateTimeOriginal is when the shutter fired; the others are fallbacks
+    const std::pair<std::string*, std::string*> dates[] = {
+        {&exif.dateTimeOriginal, &exif.offsetTimeOriginal},
+        {&exif.dateTimeDigitized, &exif.offsetTimeDigitized},
+        {&exif.dateTime, &exif.offsetTime},
+    };
+    for (const auto& date : dates) {
+        std::string text = *date.first;
+        if (date.first == &exif.dateTimeOriginal && !exif.subSecTimeOriginal.empty() && text.size() == 19) {
+            text += "." + exif.subSecTimeOriginal;
+        }
+        int zone = 0;
+        const char* zoneBegin = date.second->c_str();
+        const bool hasZone = ParseZone(zoneBegin, zoneBegin + date.second->size(), &zone);
+        int64_t ms = 0;
+        if (ParseDateTime(text, hasZone ? &zone : nullptr, &ms)) {
+            SetCaptureTime(metadata, ms);
+            break;
+        }
+    }
+
+    SetCamera(metadata, std::move(exif.make), std::move(exif.model));
+    if (exif.pixelWidth && exif.pixelHeight) {
+        SetDimensions(metadata, exif.pixelWidth, exif.pixelHeight);
+    } else if (ifd0Dimensions) {
+        SetDimensions(metadata, exif.width, exif.height);
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// JPEG
+// ---------------------------------------------------------------------------
+
+void ParseJpeg(MediaMetadataReader& reader, MediaMetadata* metadata) {
+    uint64_t offset = 2;
+    bool haveSof = false;
+    uint32_t sofWidth = 0, sofHeight = 0;
+    for (int segment = 0; segment < kMaxSegments; segment++) {
+        const uint8_t* p = reader.Map(offset, 4);
+        if (!p || p[0] != 0xFF) {
+            break;
+        }
+        const uint8_t marker = p[1];
+        if (marker == 0xFF) {
+            offset++;   // fill byte
+            continue;
+        }
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            offset += 2;
+            continue;
+        }
+        if (marker == 0xDA || marker == 0xD9) {
+            break;      // start of scan or end of image: no metadata past this
+        }
+        const uint16_t length = Be16(p + 2);
+        if (length < 2) {
+            break;
+        }
+
+        const uint8_t* body = length >= 8 ? reader.Map(offset + 4, 6) : nullptr;
+        if (marker == 0xE1 && body && std::memcmp(body, "Exif\0\0", 6) == 0 && !(metadata->fields & kMediaCaptureTime)) {
+            ParseTiff(reader, offset + 10, offset + 2 + length, false, metadata);
+        }
+        const bool sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (sof && !haveSof && body) {
+            sofHeight = Be16(body + 1);
+            sofWidth = Be16(body + 3);
+            haveSof = true;
+        }
+        offset += 2ull + length;
+    }
+    if (!(metadata->fields & kMediaDimensions) && haveSof) {
+        SetDimensions(metadata, sofWidth, sofHeight);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// PNG
+// ---------------------------------------------------------------------------
+
+void ParsePng(MediaMetadataReader& reader, MediaMetadata* metadata) {
+    uint64_t offset = 8;
+    for (int chunk = 0; chunk < kMaxChunks; chunk++) {
+        const uint8_t* header = reader.Map(offset, 8);
+        if (!header) {
+            break;
+        }
+        const uint32_t length = Be32(header);
+        const uint32_t type = Be32(header + 4);
+        const uint64_t data = offset + 8;
+        if (type == FourCc("IDAT") || type == FourCc("IEND")) {
+            break;
+        }
+
+        if (type == FourCc("IHDR") && length >= 8) {
+            if (const uint8_t* p = reader.Map(data, 8)) {
+                SetDimensions(metadata, Be32(p), Be32(p + 4));
+            }
+        } else if (type == FourCc("eXIf") && length >= 8) {
+            const uint8_t* p = reader.Map(data, 6);
+            const uint64_t skip = p && std::memcmp(p, "Exif\0\0", 6) == 0 ? 6 : 0;
+            // EXIF dates win over a "Creation Time" text chunk, whichever comes first
+            ParseTiff(reader, data + skip, data + length, false, metadata);
+        } else if ((type == FourCc("tEXt") || type == FourCc("iTXt")) && length > 14 &&
+                   !(metadata->fields & kMediaCaptureTime)) {
+            const size_t size = std::min<size_t>(length, 256);
+            const uint8_t* p = reader.Map(data, size);
+            if (p && std::memcmp(p, "Creation Time\0", 14) == 0) {
+                size_t text = 14;
+                if (type == FourCc("iTXt")) {
+                    // compression flag, method, language tag\0, translated keyword\0
+                    if (p[14] != 0) {
+                        offset += 12ull + length;
+                        continue;
+                    }
+                    text = 16;
+                    for (int nul = 0; nul < 2 && text < size; text++) {
+                        nul += p[text] == 0;
+                    }
+                }
+                if (text < size) {
+                    const std::string value = CleanString(p + text, size - text, kMaxDateString);
+                    int64_t ms = 0;
+                    if (ParseDateTime(value, nullptr, &ms) || ParseRfc1123(value, &ms)) {
+                        SetCaptureTime(metadata, ms);
+                    }
+                }
+            }
+        }
+        offset += 12ull + length;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ISO-BMFF
+// ---------------------------------------------------------------------------
+
+struct Box {
+    uint32_t type;
+    uint64_t payload;   // offset of the payload
+    uint64_t end;
+};
+
+// Calls visit(box) for each box in [begin, end); stops when visit returns false
+template <typename Visit>
+void ForEachBox(MediaMetadataReader& reader, uint64_t begin, uint64_t end, Visit visit) {
+    uint64_t offset = begin;
+    for (int i = 0; i < kMaxBoxes && offset + 8 <= end; i++) {
+        const uint8_t* p = reader.Map(offset, 8);
+        if (!p) {
+            return;
+        }
+        uint64_t size = Be32(p);
+        uint64_t header = 8;
+        if (size == 1) {
+            const uint8_t* large = reader.Map(offset + 8, 8);
+            if (!large) {
+                return;
+            }
+            size = Be64(large);
+            header = 16;
+        } else if (size == 0) {
+            size = end - offset;
+        }
+        if (size < header || size > end - offset) {
+            return;
+        }
+        if (!visit(Box{Be32(p + 4), offset + header, offset + size})) {
+            return;
+        }
+        offset += size;
+    }
+}
+
+struct MovieFields {
+    int64_t appleCreationMs = 0;        // com.apple.quicktime.creationdate, with zone
+    bool hasAppleCreation = false;
+    int64_t userDataDateMs = 0;         // udta ©day
+    bool hasUserDataDate = false;
+    int64_t headerCreationMs = 0;       // mvhd creation_time, UTC
+    bool hasHeaderCreation = false;
+    std::string make, model;
+    uint64_t area = 0;
+};
+
+void ParseMovieHeader(MediaMetadataReader& reader, const Box& box, MediaMetadata* metadata, MovieFields* movie) {
+    const uint8_t* p = reader.Map(box.payload, std::min<uint64_t>(box.end - box.payload, 32));
+    if (!p || box.end - box.payload < 20) {
+        return;
+    }
+    uint64_t creation = 0, duration = 0;
+    uint32_t timescale = 0;
+    if (p[0] == 1 && box.end - box.payload >= 32) {
+        creation = Be64(p + 4);
+        timescale = Be32(p + 20);
+        duration = Be64(p + 24);
+        if (duration == ~0ull) {
+            duration = 0;
+        }
+    } else {
+        creation = Be32(p + 4);
+        timescale = Be32(p + 12);
+        duration = Be32(p + 16);
+        if (duration == 0xFFFFFFFFull) {
+            duration = 0;
+        }
+    }
+    if (timescale > 0 && duration > 0) {
+        metadata->durationMs = static_cast<double>(duration) * 1000.0 / timescale;
+        metadata->fields |= kMediaDuration;
+    }
+    // Cameras that never set their clock write 0 (1904) or small values
+    if (creation > kMacEpochOffset + 86400ull * 365) {
+        movie->headerCreationMs = static_cast<int64_t>(creation - kMacEpochOffset) * 1000;
+        movie->hasHeaderCreation = true;
+    }
+}
+
+void ParseTrackHeader(MediaMetadataReader& reader, const Box& box, MovieFields* movie, MediaMetadata* metadata) {
+    const uint8_t* version = reader.Map(box.payload, 1);
+    if (!version) {
+        return;
+    }
+    const uint64_t sizes = 4 + (version[0] == 1 ? 32 : 20) + 52;
+    const uint8_t* p = box.end - box.payload >= sizes + 8 ? reader.Map(box.payload + sizes, 8) : nullptr;
+    if (!p) {
+        return;
+    }
+    const uint32_t width = Be32(p) >> 16;
+    const uint32_t height = Be32(p + 4) >> 16;
+    if (static_cast<uint64_t>(width) * height > movie->area) {
+        movie->area = static_cast<uint64_t>(width) * height;
+        SetDimensions(metadata, width, height);
+    }
+}
+
+// QuickTime user data: ©day, ©mak, ©mod as (u16 size, u16 language, text)
+void ParseUserData(MediaMetadataReader& reader, const Box& udta, MovieFields* movie) {
+    ForEachBox(reader, udta.payload, udta.end, [&](const Box& box) {
+        const uint32_t kDay = 0xA9646179, kMake = 0xA96D616B, kModel = 0xA96D6F64;   // ©day ©mak ©mod
+        if (box.type != kDay && box.type != kMake && box.type != kModel) {
+            return true;
+        }
+        const size_t available = static_cast<size_t>(std::min<uint64_t>(box.end - box.payload, 128));
+        const uint8_t* p = available > 4 ? reader.Map(box.payload, available) : nullptr;
+        if (!p) {
+            return true;
+        }
+        const size_t length = std::min<size_t>(Be16(p), available - 4);
+        const std::string text = CleanString(p + 4, length, kMaxDateString);
+        if (box.type == kDay) {
+            movie->hasUserDataDate = ParseDateTime(text, nullptr, &movie->userDataDateMs);
+        } else if (box.type == kMake) {
+            movie->make = text.substr(0, kMaxString);
+        } else {
+            movie->model = text.substr(0, kMaxString);
+        }
+        return true;
+    });
+}
+
+// QuickTime metadata (iPhone and most phones): keys names the entries of ilst
+void ParseQuickTimeMeta(MediaMetadataReader& reader, const Box& meta, MovieFields* movie) {
+    std::vector<std::string> keys;
+    ForEachBox(reader, meta.payload, meta.end, [&](const Box& box) {
+        if (box.type == FourCc("keys")) {
+            const uint8_t* p = reader.Map(box.payload, 8);
+            const uint32_t count = p ? std::min<uint32_t>(Be32(p + 4), 256) : 0;
+            uint64_t offset = box.payload + 8;
+            for (uint32_t i = 0; i < count; i++) {
+                const uint8_t* entry = reader.Map(offset, 8);
+                const uint32_t size = entry ? Be32(entry) : 0;
+                if (size < 8 || offset + size > box.end) {
+                    break;
+                }
+                const uint8_t* name = reader.Map(offset + 8, std::min<uint32_t>(size - 8, 128));
+                keys.push_back(name ? std::string(reinterpret_cast<const char*>(name), std::min<uint32_t>(size - 8, 128))
+                                    : std::string());
+                offset += size;
+            }
+        } else if (box.type == FourCc("ilst")) {
+            ForEachBox(reader, box.payload, box.end, [&](const Box& item) {
+                // Item type is the 1-based key index
+                if (item.type == 0 || item.type > keys.size()) {
+                    return true;
+                }
+                const std::string& key = keys[item.type - 1];
+                const bool date = key == "com.apple.quicktime.creationdate";
+                const bool make = key == "com.apple.quicktime.make";
+                const bool model = key == "com.apple.quicktime.model";
+                if (!date && !make && !model) {
+                    return true;
+                }
+                ForEachBox(reader, item.payload, item.end, [&](const Box& data) {
+                    if (data.type != FourCc("data") || data.end - data.payload <= 8) {
+                        return true;
+                    }
+                    const size_t length = static_cast<size_t>(std::min<uint64_t>(data.end - data.payload - 8, 128));
+                    const uint8_t* p = reader.Map(data.payload + 8, length);
+                    if (!p) {
+                        return false;
+                    }
+                    const std::string text = CleanString(p, length, kMaxDateString);
+                    if (date) {
+                        movie->hasAppleCreation = ParseDateTime(text, nullptr, &movie->appleCreationMs);
+                    } else if (make) {
+                        movie->make = text.substr(0, kMaxString);
+                    } else {
+                        movie->model = text.substr(0, kMaxString);
+                    }
+                    return false;
+                });
+                return true;
+            });
+        }
+        return true;
+    });
+}
+
+// Payload of a meta box: QuickTime's has no version/flags, ISO's does
+uint64_t MetaChildren(MediaMetadataReader& reader, const Box& meta) {
+    const uint8_t* p = reader.Map(meta.payload, 12);
+    if (p && Be32(p + 4) == FourCc("hdlr")) {
+        return meta.payload;
+    }
+    return meta.payload + 4;
+}
+
+void ParseMovie(MediaMetadataReader& reader, const Box& moov, MediaMetadata* metadata, MovieFields* movie, int depth) {
+    if (depth > kMaxBoxDepth) {
+        return;
+    }
+    ForEachBox(reader, moov.payload, moov.end, [&](const Box& box) {
+        switch (box.type) {
+            case FourCc("mvhd"): ParseMovieHeader(reader, box, metadata, movie); break;
+            case FourCc("tkhd"): ParseTrackHeader(reader, box, movie, metadata); break;
+            case FourCc("trak"): ParseMovie(reader, box, metadata, movie, depth + 1); break;
+            case FourCc("udta"): ParseUserData(reader, box, movie); break;
+            case FourCc("meta"): {
+                const Box children{box.type, MetaChildren(reader, box), box.end};
+                ParseQuickTimeMeta(reader, children, movie);
+                break;
+            }
+            default: break;
+        }
+        return true;
+    });
+}
+
+struct HeifItems {
+    uint32_t exifItem = 0;
+    bool hasExif = false;
+    uint64_t exifOffset = 0;
+    uint64_t exifLength = 0;
+    uint64_t area = 0;
+};
+
+void ParseItemInfo(MediaMetadataReader& reader, const Box& iinf, HeifItems* items) {
+    const uint8_t* p = reader.Map(iinf.payload, 6);
+    if (!p) {
+        return;
+    }
+    const uint64_t children = iinf.payload + (p[0] == 0 ? 6 : 8);
+    ForEachBox(reader, children, iinf.end, [&](const Box& infe) {
+        const uint8_t* q = infe.type == FourCc("infe") ? reader.Map(infe.payload, 12) : nullptr;
+        if (!q || q[0] < 2) {
+            return true;
+        }
+        // version 2: u16 item_ID, version 3: u32; then u16 protection index and the item type
+        const uint32_t id = q[0] == 2 ? Be16(q + 4) : Be32(q + 4);
+        const uint32_t type = Be32(q + (q[0] == 2 ? 8 : 10));
+        if (type == FourCc("Exif") && !items->hasExif) {
+            items->exifItem = id;
+            items->hasExif = true;
+        }
+        return true;
+    });
+}
+
+void ParseItemLocations(MediaMetadataReader& reader, const Box& iloc, HeifItems* items) {
+    const uint8_t* p = reader.Map(iloc.payload, 8);
+    if (!p || !items->hasExif) {
+        return;
+    }
+    const uint8_t version = p[0];
+    const size_t offsetSize = p[4] >> 4, lengthSize = p[4] & 15, baseSize = p[5] >> 4;
+    const size_t indexSize = (version == 1 || version == 2) ? (p[5] & 15) : 0;
+    uint64_t offset = iloc.payload + 6;
+    const uint8_t* countBytes = reader.Map(offset, 4);
+    if (!countBytes || version > 2) {
+        return;
+    }
+    const uint32_t count = version < 2 ? Be16(countBytes) : Be32(countBytes);
+    offset += version < 2 ? 2 : 4;
+    const size_t idSize = version < 2 ? 2 : 4;
+    const size_t methodSize = (version == 1 || version == 2) ? 2 : 0;
+
+    for (uint32_t i = 0; i < count && i < static_cast<uint32_t>(kMaxBoxes); i++) {
+        const size_t fixed = idSize + methodSize + 2 + baseSize + 2;
+        const uint8_t* item = reader.Map(offset, fixed);
+        if (!item || offset + fixed > iloc.end) {
+            return;
+        }
+        const uint32_t id = static_cast<uint32_t>(BeN(item, idSize));
+        const uint16_t method = methodSize ? Be16(item + idSize) & 15 : 0;
+        const uint64_t base = BeN(item + idSize + methodSize + 2, baseSize);
+        const uint16_t extents = Be16(item + idSize + methodSize + 2 + baseSize);
+        offset += fixed;
+        const size_t extentSize = indexSize + offsetSize + lengthSize;
+        if (id == items->exifItem && method == 0 && extents >= 1) {
+            const uint8_t* extent = reader.Map(offset, extentSize);
+            if (extent) {
+                items->exifOffset = base + BeN(extent + indexSize, offsetSize);
+                items->exifLength = BeN(extent + indexSize + offsetSize, lengthSize);
+            }
+            return;
+        }
+        offset += static_cast<uint64_t>(extents) * extentSize;
+    }
+}
+
+void ParseHeifMeta(MediaMetadataReader& reader, const Box& meta, MediaMetadata* metadata) {
+    HeifItems items;
+    // iinf comes before iloc in practice, but nothing requires it
+    for (int pass = 0; pass < 2; pass++) {
+        ForEachBox(reader, meta.payload + 4, meta.end, [&](const Box& box) {
+            if (pass == 0 && box.type == FourCc("iinf")) {
+                ParseItemInfo(reader, box, &items);
+            } else if (pass == 1 && box.type == FourCc("iloc")) {
+                ParseItemLocations(reader, box, &items);
+            } else if (pass == 1 && box.type == FourCc("iprp")) {
+                ForEachBox(reader, box.payload, box.end, [&](const Box& ipco) {
+                    if (ipco.type != FourCc("ipco")) {
+                        return true;
+                    }
+                    // The largest ispe is the full image; grids list each tile too
+                    ForEachBox(reader, ipco.payload, ipco.end, [&](const Box& ispe) {
+                        const uint8_t* p = ispe.type == FourCc("ispe") ? reader.Map(ispe.payload, 12) : nullptr;
+                        if (p && static_cast<uint64_t>(Be32(p + 4)) * Be32(p + 8) > items.area) {
+                            items.area = static_cast<uint64_t>(Be32(p + 4)) * Be32(p + 8);
+                            SetDimensions(metadata, Be32(p + 4), Be32(p + 8));
+                        }
+                        return true;
+                    });
+                    return false;
+                });
+            }
+            return true;
+        });
+    }
+
+    // The Exif item starts with the offset of the TIFF header past its own 4 bytes
+    if (items.exifLength > 8) {
+        const uint8_t* p = reader.Map(items.exifOffset, 4);
+        if (p && Be32(p) < items.exifLength - 4) {
+            const uint8_t dimensions = metadata->fields & kMediaDimensions;
+            const uint32_t width = metadata->width, height = metadata->height;
+            ParseTiff(reader, items.exifOffset + 4 + Be32(p), items.exifOffset + items.exifLength, false, metadata);
+            if (dimensions) {
+                SetDimensions(metadata, width, height);   // ispe describes the decoded image
+            }
+        }
+    }
+}
+
+void ParseIsoBmff(MediaMetadataReader& reader, MediaMetadata* metadata) {
+    MovieFields movie;
+    ForEachBox(reader, 0, reader.Size(), [&](const Box& box) {
+        if (box.type == FourCc("moov")) {
+            ParseMovie(reader, box, metadata, &movie, 0);
+        } else if (box.type == FourCc("meta")) {
+            ParseHeifMeta(reader, box, metadata);
+        }
+        return true;
+    });
+
+    if (!(metadata->fields & kMediaCaptureTime)) {
+        if (movie.hasAppleCreation) {
+            SetCaptureTime(metadata, movie.appleCreationMs);
+        } else if (movie.hasUserDataDate) {
+            SetCaptureTime(metadata, movie.userDataDateMs);
+        } else if (movie.hasHeaderCreation) {
+            SetCaptureTime(metadata, movie.headerCreationMs);
+        }
+    }
+    if (!(metadata->fields & kMediaCamera)) {
+        SetCamera(metadata, std::move(movie.make), std::move(movie.model));
+    }
+}
+
+bool IsIsoBmffBox(const uint8_t* type) {
+    static const char* kTopLevel[] = {"ftyp", "moov", "mdat", "wide", "free", "skip", "pnot"};
+    for (const char* name : kTopLevel) {
+        if (std::memcmp(type, name, 4) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReadOpenFile(int fd, uint64_t size, MediaMetadata* metadata) {
+    MediaMetadataReader reader(fd, size);
+    return ParseMediaMetadata(reader, metadata);
+}
+
+} // namespace
+
+MediaMetadataReader::MediaMetadataReader(int fd, uint64_t size) : fd_(fd), size_(size) {}
+
+MediaMetadataReader::~MediaMetadataReader() {
+    for (const auto& window : windows_) {
+        munmap(window.base, window.length);
+    }
+}
+
+const uint8_t* MediaMetadataReader::Map(uint64_t offset, size_t length) {
+    if (length == 0 || offset > size_ || length > size_ - offset) {
+        return nullptr;
+    }
+    for (const auto& window : windows_) {
+        if (offset >= window.offset && offset + length <= window.offset + window.length) {
+            return static_cast<const uint8_t*>(window.base) + (offset - window.offset);
+        }
+    }
+
+    static const uint64_t kPageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset & ~(kPageSize - 1);
+    const uint64_t end = std::min(size_, std::max<uint64_t>(offset + length, start + kWindowSize));
+    const size_t mapLength = static_cast<size_t>(end - start);
+    if (mappedBytes_ + mapLength > kMaxMappedBytes) {
+        return nullptr;
+    }
+    void* base = mmap(nullptr, mapLength, PROT_READ, MAP_PRIVATE, fd_, static_cast<off_t>(start));
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    mappedBytes_ += mapLength;
+    windows_.push_back(Window{start, mapLength, base});
+    return static_cast<const uint8_t*>(base) + (offset - start);
+}
+
+bool ParseMediaMetadata(MediaMetadataReader& reader, MediaMetadata* metadata) {
+    *metadata = MediaMetadata();
+    const uint8_t* p = reader.Map(0, static_cast<size_t>(std::min<uint64_t>(reader.Size(), 12)));
+    if (!p || reader.Size() < 12) {
+        return false;
+    }
+    if (p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF) {
+        ParseJpeg(reader, metadata);
+    } else if (std::memcmp(p, "\x89PNG\r\n\x1a\n", 8) == 0) {
+        ParsePng(reader, metadata);
+    } else if ((p[0] == 'I' && p[1] == 'I') || (p[0] == 'M' && p[1] == 'M')) {
+        if (!ParseTiff(reader, 0, reader.Size(), true, metadata)) {
+            return false;
+        }
+    } else if (IsIsoBmffBox(p + 4)) {
+        ParseIsoBmff(reader, metadata);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ReadMediaMetadata(const std::string& path, MediaMetadata* metadata) {
+    *metadata = MediaMetadata();
+    // O_NONBLOCK: a FIFO must not block the caller; fstat then rejects it
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    bool parsed = false;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        parsed = ReadOpenFile(fd, static_cast<uint64_t>(st.st_size), metadata);
+    }
+    close(fd);
+    return parsed;
+}
+
+size_t MediaMetadataExtractor::KeyHash::operator()(const Key& key) const {
+    uint64_t h = static_cast<uint64_t>(key.inode) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<uint64_t>(key.device) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+    h ^= static_cast<uint64_t>(key.mtimeNs) + (h << 6) + (h >> 2);
+    h ^= key.size + (h << 6) + (h >> 2);
+    return static_cast<size_t>(h);
+}
+
+MediaMetadataExtractor::MediaMetadataExtractor(size_t capacity)
+    : shardCapacity_(std::max<size_t>(1, capacity / kShards / 2)) {}
+
+MediaMetadata MediaMetadataExtractor::Extract(const std::string& path) {
+    MediaMetadata metadata;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        return metadata;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return metadata;
+    }
+
+#ifdef __APPLE__
+    const int64_t mtimeNs = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    const int64_t mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    const Key key{st.st_dev, st.st_ino, mtimeNs, static_cast<uint64_t>(st.st_size)};
+    Shard& shard = shards_[KeyHash()(key) % kShards];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        bool hit = false;
+        auto found = shard.current.find(key);
+        if (found != shard.current.end()) {
+            metadata = found->second;
+            hit = true;
+        } else if ((found = shard.previous.find(key)) != shard.previous.end()) {
+            metadata = found->second;
+            shard.current.emplace(key, std::move(found->second));
+            shard.previous.erase(found);
+            hit = true;
+        }
+        if (hit) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            close(fd);
+            return metadata;
+        }
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    ReadOpenFile(fd, static_cast<uint64_t>(st.st_size), &metadata);
+    close(fd);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.current[key] = metadata;
+    if (shard.current.size() >= shardCapacity_) {
+        shard.previous = std::move(shard.current);
+        shard.current = Map();
+    }
+    return metadata;
+}
+
+void MediaMetadataExtractor::ExtractFiles(WorkStealingPool& pool, std::shared_ptr<MediaMetadataBatch> batch,
+                                          std::function<void(std::shared_ptr<MediaMetadataBatch>)> done) {
+    // Fewer files per task than SniffFiles: a video can take several reads
+    constexpr size_t kChunk = 16;
+
+    const size_t count = batch->paths.size();
+    batch->results.assign(count, MediaMetadata());
+    if (count == 0) {
+        done(std::move(batch));
+        return;
+    }
+
+    struct State {
+        std::shared_ptr<MediaMetadataBatch> batch;
+        std::function<void(std::shared_ptr<MediaMetadataBatch>)> done;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> skipped{false};
+    };
+    const size_t chunks = (count + kChunk - 1) / kChunk;
+    auto state = std::make_shared<State>();
+    state->batch = std::move(batch);
+    state->done = std::move(done);
+    state->remaining.store(chunks, std::memory_order_relaxed);
+
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        pool.Submit([this, state, chunk, count] {
+            MediaMetadataBatch& batch = *state->batch;
+            if (batch.cancellation.IsCancelled()) {
+                state->skipped.store(true, std::memory_order_relaxed);
+            } else {
+                const size_t end = std::min(count, (chunk + 1) * kChunk);
+                for (size_t i = chunk * kChunk; i < end; i++) {
+                    batch.results[i] = Extract(batch.paths[i]);
+                }
+            }
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                batch.cancelled = state->skipped.load(std::memory_order_relaxed);
+                state->done(std::move(state->batch));
+            }
+        });
+    }
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,165 @@
+/**
+ * @file media_metadata.h
+ * @brief Capture date, camera and duration from photo and video headers
+ *
+ * Reads only the bytes that hold the metadata, through small mmap windows
+ * (MediaMetadataReader), and never decodes pixels or samples:
+ *
+ * - JPEG: markers up to the first scan; EXIF from the APP1 segment,
+ *   dimensions from the SOF segment
+ * - TIFF and TIFF-based raw files (CR2, NEF, ARW, DNG, ...): IFD0 and the
+ *   EXIF IFD
+ * - PNG: IHDR, eXIf and tEXt/iTXt "Creation Time" chunks before the first IDAT
+ * - ISO-BMFF (HEIC/AVIF, MP4, MOV, M4A, 3GP): mvhd duration and creation
+ *   time, track dimensions, QuickTime udta/keys metadata, and for HEIF the
+ *   EXIF item located through iinf/iloc
+ *
+ * Box and segment walks are bounded in count and nesting, and every offset
+ * is checked against the file size, so a truncated or hostile file yields
+ * fewer fields, never a crash. Typical reads touch a few pages: the first
+ * 64KB of a photo, and a handful of box headers plus mvhd for a video
+ * whose moov sits at the end.
+ *
+ * EXIF dates without an OffsetTime tag are local wall-clock times and are
+ * converted with the local time zone, so formatting them in local time
+ * gives back the date the camera showed.
+ *
+ * MediaMetadataExtractor caches results by (device, inode, mtime, size) and
+ * spreads batches over a WorkStealingPool like SniffFiles.
+ */
+
+#ifndef FILE_OPS_MEDIA_METADATA_H
+#define FILE_OPS_MEDIA_METADATA_H
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+// Bits of MediaMetadata::fields
+enum MediaField : uint8_t {
+    kMediaCaptureTime = 1 << 0,
+    kMediaCamera = 1 << 1,      // cameraMake and/or cameraModel
+    kMediaDuration = 1 << 2,
+    kMediaDimensions = 1 << 3,
+};
+
+struct MediaMetadata {
+    uint8_t fields = 0;
+    int64_t captureTimeMs = 0;  // Unix time in milliseconds
+    double durationMs = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::string cameraMake;
+    std::string cameraModel;
+};
+
+// Small read-only mmap windows over one file. Map() returns a pointer to
+// [offset, offset + length), reusing a window that already covers it; null
+// past the end of the file or once maxMappedBytes are mapped.
+class MediaMetadataReader {
+public:
+    static constexpr size_t kWindowSize = 64 * 1024;
+    static constexpr size_t kMaxMappedBytes = 2 * 1024 * 1024;
+
+    MediaMetadataReader(int fd, uint64_t size);
+    ~MediaMetadataReader();
+
+    MediaMetadataReader(const MediaMetadataReader&) = delete;
+    MediaMetadataReader& operator=(const MediaMetadataReader&) = delete;
+
+    const uint8_t* Map(uint64_t offset, size_t length);
+    uint64_t Size() const { return size_; }
+    size_t MappedBytes() const { return mappedBytes_; }
+
+private:
+    struct Window {
+        uint64_t offset;        // page-aligned file offset of base
+        size_t length;
+        void* base;
+    };
+
+    int fd_;
+    uint64_t size_;
+    size_t mappedBytes_ = 0;
+    std::vector<Window> windows_;
+};
+
+// Parse whatever metadata the file's format carries. Returns false for
+// formats it does not know; fields is 0 when nothing was found.
+bool ParseMediaMetadata(MediaMetadataReader& reader, MediaMetadata* metadata);
+
+// Open, parse and close one file, without the cache
+bool ReadMediaMetadata(const std::string& path, MediaMetadata* metadata);
+
+struct MediaMetadataBatch {
+    std::vector<std::string> paths;
+    std::vector<MediaMetadata> results;     // filled by Extract, same order as paths
+    CancellationToken cancellation;         // checked before each chunk of files
+    bool cancelled = false;                 // chunks were skipped; their results stay empty
+};
+
+class MediaMetadataExtractor {
+public:
+    // Keeps up to about capacity results; the oldest half is dropped first
+    explicit MediaMetadataExtractor(size_t capacity = 65536);
+
+    MediaMetadataExtractor(const MediaMetadataExtractor&) = delete;
+    MediaMetadataExtractor& operator=(const MediaMetadataExtractor&) = delete;
+
+    // Cached metadata of one file; empty for unreadable files
+    MediaMetadata Extract(const std::string& path);
+
+    // Extract every path on the pool. done runs exactly once, on a pool
+    // thread (or the calling thread for an empty batch), after all results
+    // are written.
+    void ExtractFiles(WorkStealingPool& pool, std::shared_ptr<MediaMetadataBatch> batch,
+                      std::function<void(std::shared_ptr<MediaMetadataBatch>)> done);
+
+    uint64_t CacheHits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t CacheMisses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    struct Key {
+        dev_t device;
+        ino_t inode;
+        int64_t mtimeNs;
+        uint64_t size;
+        bool operator==(const Key& other) const {
+            return device == other.device && inode == other.inode && mtimeNs == other.mtimeNs &&
+                   size == other.size;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    using Map = std::unordered_map<Key, MediaMetadata, KeyHash>;
+
+    static constexpr size_t kShards = 16;
+    struct Shard {
+        std::mutex mutex;
+        Map current;
+        Map previous;       // the generation before; hits are moved back to current
+    };
+
+    size_t shardCapacity_;
+    Shard shards_[kShards];
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_MEDIA_METADATA_H
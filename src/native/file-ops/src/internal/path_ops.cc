@@ -0,0 +1,264 @@
+/**
+ * @file path_ops.cc
+ * @brief Bulk rename and unlink on the pool
+ */
+
+#include "path_ops.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/vfs.h>
+#endif
+
+namespace FileCataloger {
+
+namespace {
+
+// Absolute, with "." and ".." resolved and no repeated or trailing '/'.
+// Lexical only: symlinked directories are not resolved.
+std::string NormalizePath(const std::string& path, const std::string& cwd) {
+    if (path.empty()) {
+        return path;
+    }
+    std::string out;
+    std::string_view rest = path;
+    if (path[0] != '/') {
+        out = cwd;
+    }
+    while (!rest.empty()) {
+        size_t slash = rest.find('/');
+        std::string_view part = rest.substr(0, slash);
+        rest = slash == std::string_view::npos ? std::string_view() : rest.substr(slash + 1);
+        if (part.empty() || part == ".") {
+            continue;
+        }
+        if (part == "..") {
+            out.resize(out.rfind('/') == std::string::npos ? 0 : out.rfind('/'));
+            continue;
+        }
+        out += '/';
+        out += part;
+    }
+    return out.empty() ? "/" : out;
+}
+
+std::string_view ParentOf(std::string_view key) {
+    size_t slash = key.rfind('/');
+    return slash == 0 || slash == std::string_view::npos ? std::string_view("/") : key.substr(0, slash);
+}
+
+// The naming of every volume the batch touches, merged
+VolumeNaming BatchNaming(const std::vector<std::string>& keys) {
+    std::unordered_set<std::string_view> directories;
+    VolumeNaming naming;
+    for (const std::string& key : keys) {
+        std::string_view directory = ParentOf(key);
+        if (!directories.insert(directory).second) {
+            continue;
+        }
+        VolumeNaming volume = NamingOf(std::string(directory));
+        naming.ignoresCase |= volume.ignoresCase;
+        naming.ignoresNormalization |= volume.ignoresNormalization;
+    }
+    return naming;
+}
+
+std::vector<std::string> NormalizedKeys(const std::vector<std::string>& paths,
+                                        const std::vector<std::string>& destinations) {
+    std::string cwd;
+    auto relative = [](const std::string& path) { return !path.empty() && path[0] != '/'; };
+    if (std::any_of(paths.begin(), paths.end(), relative) ||
+        std::any_of(destinations.begin(), destinations.end(), relative)) {
+        char buffer[4096];
+        cwd = getcwd(buffer, sizeof(buffer)) ? buffer : "";
+        if (cwd == "/") {
+            cwd.clear();
+        }
+    }
+    std::vector<std::string> keys;
+    keys.reserve(paths.size() + destinations.size());
+    for (const std::string& path : paths) {
+        keys.push_back(NormalizePath(path, cwd));
+    }
+    for (const std::string& destination : destinations) {
+        keys.push_back(NormalizePath(destination, cwd));
+    }
+    return keys;
+}
+
+// keys holds the sources, then the destinations
+bool KeysDependOnOrder(std::vector<std::string>& keys, size_t count, VolumeNaming naming) {
+    if (naming.ignoresCase || naming.ignoresNormalization) {
+        for (std::string& key : keys) {
+            for (char& c : key) {
+                if (static_cast<unsigned char>(c) >= 0x80) {
+                    return true;
+                }
+                if (naming.ignoresCase && c >= 'A' && c <= 'Z') {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+            }
+        }
+    }
+
+    // A destination that is another rename's source, a source or
+    // destination named twice
+    std::unordered_map<std::string_view, size_t> sources;
+    std::unordered_set<std::string_view> all;
+    for (size_t i = 0; i < count; i++) {
+        if (!sources.emplace(keys[i], i).second) {
+            return true;
+        }
+        all.insert(keys[i]);
+    }
+    std::unordered_set<std::string_view> destinations;
+    for (size_t i = 0; i < count; i++) {
+        std::string_view destination = keys[count + i];
+        auto source = sources.find(destination);
+        if ((source != sources.end() && source->second != i) || !destinations.insert(destination).second) {
+            return true;
+        }
+        all.insert(destination);
+    }
+
+    // A path inside a directory that the batch renames or renames onto
+    for (const std::string& key : keys) {
+        for (std::string_view parent = ParentOf(key); parent != "/"; parent = ParentOf(parent)) {
+            if (all.count(parent) != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void RunChunk(PathOpBatch& batch, IoEngine& engine, size_t begin, size_t end) {
+    int* errors = batch.errors.data();
+    if (batch.op == PathOp::Rename) {
+        engine.Rename(batch.paths.data() + begin, batch.destinations.data() + begin, end - begin, errors + begin);
+    } else {
+        engine.Unlink(batch.paths.data() + begin, end - begin, errors + begin);
+    }
+}
+
+} // namespace
+
+VolumeNaming NamingOf(const std::string& directory) {
+    VolumeNaming naming;
+#if defined(__APPLE__)
+    // APFS and HFS+ both ignore normalization, whatever their case setting
+    long caseSensitive = pathconf(directory.c_str(), _PC_CASE_SENSITIVE);
+    naming.ignoresCase = caseSensitive == 0;
+    naming.ignoresNormalization = true;
+#elif defined(__linux__)
+    struct statfs volume;
+    if (statfs(directory.c_str(), &volume) == 0) {
+        // vfat/msdos and exfat
+        naming.ignoresCase = volume.f_type == 0x4d44 || volume.f_type == 0x2011BAB0;
+    }
+#if defined(FS_CASEFOLD_FL)
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        int flags = 0;
+        if (ioctl(fd, FS_IOC_GETFLAGS, &flags) == 0 && (flags & FS_CASEFOLD_FL) != 0) {
+            naming.ignoresCase = true;
+            naming.ignoresNormalization = true;
+        }
+        close(fd);
+    }
+#endif
+#else
+    (void)directory;
+#endif
+    return naming;
+}
+
+bool RenamesDependOnOrder(const std::vector<std::string>& paths, const std::vector<std::string>& destinations,
+                          VolumeNaming naming) {
+    std::vector<std::string> keys = NormalizedKeys(paths, destinations);
+    return KeysDependOnOrder(keys, paths.size(), naming);
+}
+
+static_assert(std::is_same_v<int32_t, int>, "errors are written through int*");
+
+void RunPathOps(WorkStealingPool& pool, std::shared_ptr<PathOpBatch> batch,
+                std::function<void(std::shared_ptr<PathOpBatch>)> done) {
+    // Same as StatFileList: the syscalls dwarf the scheduling per path
+    constexpr size_t kChunk = 256;
+
+    const size_t count = batch->paths.size();
+    batch->errors.assign(count, ECANCELED);
+    if (batch->op == PathOp::Rename && batch->destinations.size() != count) {
+        batch->errors.assign(count, EINVAL);
+        done(std::move(batch));
+        return;
+    }
+    if (count == 0) {
+        done(std::move(batch));
+        return;
+    }
+
+    IoEngine& engine = batch->engine ? *batch->engine : DefaultIoEngine();
+    bool inOrder = false;
+    if (batch->op == PathOp::Rename) {
+        std::vector<std::string> keys = NormalizedKeys(batch->paths, batch->destinations);
+        inOrder = KeysDependOnOrder(keys, count, BatchNaming(keys));
+    }
+    if (inOrder) {
+        pool.Submit([batch = std::move(batch), done = std::move(done), &engine, count]() mutable {
+            for (size_t i = 0; i < count; i++) {
+                if (batch->cancellation.IsCancelled()) {
+                    batch->cancelled = true;
+                    break;
+                }
+                RunChunk(*batch, engine, i, i + 1);
+                if (batch->errors[i] == EXDEV) {
+                    break;   // the rest may depend on this one; see path_ops.h
+                }
+            }
+            done(std::move(batch));
+        });
+        return;
+    }
+
+    struct State {
+        std::shared_ptr<PathOpBatch> batch;
+        std::function<void(std::shared_ptr<PathOpBatch>)> done;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> skipped{false};
+    };
+    const size_t chunks = (count + kChunk - 1) / kChunk;
+    auto state = std::make_shared<State>();
+    state->batch = std::move(batch);
+    state->done = std::move(done);
+    state->remaining.store(chunks, std::memory_order_relaxed);
+
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        pool.Submit([state, chunk, count, &engine] {
+            PathOpBatch& batch = *state->batch;
+            if (batch.cancellation.IsCancelled()) {
+                state->skipped.store(true, std::memory_order_relaxed);
+            } else {
+                RunChunk(batch, engine, chunk * kChunk, std::min(count, (chunk + 1) * kChunk));
+            }
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                batch.cancelled = state->skipped.load(std::memory_order_relaxed);
+                state->done(std::move(state->batch));
+            }
+        });
+    }
+}
+
+} // namespace FileCataloger
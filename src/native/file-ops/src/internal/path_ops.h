@@ -0,0 +1,74 @@
+/**
+ * @file path_ops.h
+ * @brief Bulk rename and unlink on the pool
+ *
+ * RunPathOps splits a batch into chunks, one pool task each, and runs every
+ * chunk through an IoEngine (io_engine.h): plain syscalls by default, or
+ * one io_uring submission per 256 paths when given UringIoEngine().
+ *
+ * Operations in a batch run concurrently. A rename batch whose outcome
+ * depends on its order (a destination that is also a source, a -> b and
+ * b -> c, two renames to one destination, or a rename inside a directory
+ * the batch also renames) runs one rename at a time in batch order instead,
+ * like the loop it replaces. Paths are compared as the volume compares
+ * them, see RenamesDependOnOrder(). Such a batch stops at its first EXDEV,
+ * since later renames may need that one done first: the rest stay
+ * ECANCELED and untouched, for the caller to run again once it has moved
+ * that path across volumes.
+ */
+
+#ifndef FILE_OPS_PATH_OPS_H
+#define FILE_OPS_PATH_OPS_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "io_engine.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+enum class PathOp : uint8_t {
+    Rename = 0,     // paths[i] -> destinations[i], replacing like fs.rename
+    Unlink = 1
+};
+
+struct PathOpBatch {
+    PathOp op = PathOp::Rename;
+    std::vector<std::string> paths;
+    std::vector<std::string> destinations;   // Rename only, same length as paths
+    std::vector<int32_t> errors;             // filled by RunPathOps: 0 or errno per path
+    CancellationToken cancellation;          // checked before each chunk; skipped paths get ECANCELED
+    bool cancelled = false;
+    IoEngine* engine = nullptr;              // DefaultIoEngine() when null
+};
+
+// How a volume matches names beyond their bytes
+struct VolumeNaming {
+    bool ignoresCase = false;            // APFS and HFS+ by default, FAT, exFAT, ext4/f2fs casefold
+    bool ignoresNormalization = false;   // NFC and NFD spellings name one file: APFS, HFS+, casefold
+};
+
+// Naming of the volume holding directory; exact when it cannot be told
+VolumeNaming NamingOf(const std::string& directory);
+
+// Whether renaming paths[i] -> destinations[i] concurrently could differ
+// from renaming them in order. Paths are compared lexically normalized
+// (absolute, "." and ".." resolved, repeated and trailing '/' dropped) and
+// ASCII case-folded when naming ignores case; a non-ASCII path on a volume
+// that folds names counts as dependent, since it may fold onto another.
+bool RenamesDependOnOrder(const std::vector<std::string>& paths, const std::vector<std::string>& destinations,
+                          VolumeNaming naming);
+
+// done runs exactly once, on a pool thread (or the calling thread for an
+// empty batch), after every error is written
+void RunPathOps(WorkStealingPool& pool, std::shared_ptr<PathOpBatch> batch,
+                std::function<void(std::shared_ptr<PathOpBatch>)> done);
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_PATH_OPS_H
@@ -0,0 +1,643 @@
+/**
+ * @file session_store.cc
+ * @brief mmap-backed snapshot and delta log of the session store
+ */
+
+#include "session_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'F', 'C', 'S', 'E', 'S', 'S', 'N', '\0'};
+constexpr char kLogMagic[8] = {'F', 'C', 'S', 'E', 'S', 'L', 'G', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint8_t kOpPut = 1;
+constexpr uint8_t kOpDelete = 2;
+
+// Record framing in the log: crc32 and length of the body that follows
+struct RecordFrame {
+    uint32_t crc;
+    uint32_t length;
+};
+
+struct RecordBody {
+    uint8_t op;
+    uint8_t reserved;
+    uint16_t space;
+    uint32_t keyLength;
+};
+
+uint32_t Crc(const void* data, size_t size, uint32_t crc = 0) {
+    const auto* bytes = static_cast<const Bytef*>(data);
+    while (size > 0) {
+        const uInt chunk = static_cast<uInt>(std::min<size_t>(size, 1u << 30));
+        crc = static_cast<uint32_t>(crc32(crc, bytes, chunk));
+        bytes += chunk;
+        size -= chunk;
+    }
+    return crc;
+}
+
+int WriteAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return 0;
+}
+
+int ReadFile(const std::string& path, std::string* contents) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno;
+    }
+    contents->clear();
+    char buffer[64 * 1024];
+    for (;;) {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            int error = errno;
+            close(fd);
+            return error;
+        }
+        if (n == 0) {
+            break;
+        }
+        contents->append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return 0;
+}
+
+// Same order as std::string: bytes compared unsigned, then length
+int CompareKey(uint16_t space, const char* key, size_t keyLength, uint16_t otherSpace, const char* other,
+               size_t otherLength) {
+    if (space != otherSpace) {
+        return space < otherSpace ? -1 : 1;
+    }
+    int c = std::memcmp(key, other, std::min(keyLength, otherLength));
+    if (c != 0) {
+        return c;
+    }
+    return keyLength < otherLength ? -1 : keyLength > otherLength ? 1 : 0;
+}
+
+int CompareKey(uint16_t space, const char* key, size_t keyLength, uint16_t otherSpace, const std::string& other) {
+    return CompareKey(space, key, keyLength, otherSpace, other.data(), other.size());
+}
+
+} // namespace
+
+// Snapshot layout, native byte order:
+//   FileHeader | DiskEntry[entryCount] | char[keyBytes] | char[valueBytes]
+// Entries are sorted by (space, key); keyBytes is padded to 8 so the values
+// start aligned. indexCrc covers the entries and keys.
+struct SessionStore::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t generation;
+    uint64_t entryCount;
+    uint64_t keyBytes;
+    uint64_t valueBytes;
+    uint32_t indexCrc;
+    uint32_t reserved;
+};
+
+struct SessionStore::DiskEntry {
+    uint16_t space;
+    uint16_t reserved;
+    uint32_t keyLength;
+    uint64_t keyOffset;
+    uint64_t valueOffset;
+    uint32_t valueLength;
+    uint32_t valueCrc;
+};
+
+// Log layout: LogHeader | (RecordFrame | RecordBody | key | value)*
+struct SessionStore::LogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t generation;
+};
+
+SessionStore::SessionStore(std::string path) : path_(std::move(path)), logPath_(path_ + ".log") {
+    static_assert(sizeof(FileHeader) % 8 == 0, "entries must stay 8-byte aligned");
+    static_assert(sizeof(DiskEntry) % 8 == 0, "keys must stay 8-byte aligned");
+}
+
+SessionStore::~SessionStore() {
+    UnmapSnapshot();
+    if (logFd_ >= 0) {
+        close(logFd_);
+    }
+}
+
+void SessionStore::MapSnapshot() {
+    generation_ = 0;
+    int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        return;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+
+    // A file from another version or a torn write is ignored and replaced on the next Compact
+    const auto* header = static_cast<const FileHeader*>(mapping);
+    const char* base = static_cast<const char*>(mapping);
+    bool valid = std::memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0 &&
+                 header->version == kVersion &&
+                 header->entrySize == sizeof(DiskEntry) &&
+                 header->entryCount <= size / sizeof(DiskEntry) &&
+                 header->keyBytes <= size && header->valueBytes <= size &&
+                 header->keyBytes % 8 == 0 &&
+                 sizeof(FileHeader) + header->entryCount * sizeof(DiskEntry) + header->keyBytes +
+                         header->valueBytes == size;
+    if (valid) {
+        const size_t indexSize = header->entryCount * sizeof(DiskEntry) + header->keyBytes;
+        valid = Crc(base + sizeof(FileHeader), indexSize) == header->indexCrc;
+    }
+
+    const auto* entries = reinterpret_cast<const DiskEntry*>(base + sizeof(FileHeader));
+    const char* keys = reinterpret_cast<const char*>(entries + (valid ? header->entryCount : 0));
+    // The CRC matched, so anything out of bounds or order was written that way; refuse it too
+    for (uint64_t i = 0; valid && i < header->entryCount; i++) {
+        const DiskEntry& e = entries[i];
+        valid = e.keyOffset <= header->keyBytes && e.keyLength <= header->keyBytes - e.keyOffset &&
+                e.valueOffset <= header->valueBytes && e.valueLength <= header->valueBytes - e.valueOffset;
+        if (valid && i > 0) {
+            const DiskEntry& p = entries[i - 1];
+            valid = CompareKey(p.space, keys + p.keyOffset, p.keyLength, e.space, keys + e.keyOffset,
+                               e.keyLength) < 0;
+        }
+    }
+    if (!valid) {
+        munmap(mapping, size);
+        return;
+    }
+
+    mapping_ = mapping;
+    mappingSize_ = size;
+    entries_ = entries;
+    entryCount_ = header->entryCount;
+    keys_ = keys;
+    keyBytes_ = header->keyBytes;
+    values_ = keys_ + keyBytes_;
+    valueBytes_ = header->valueBytes;
+    generation_ = header->generation;
+}
+
+void SessionStore::UnmapSnapshot() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    entries_ = nullptr;
+    entryCount_ = 0;
+    keys_ = nullptr;
+    keyBytes_ = 0;
+    values_ = nullptr;
+    valueBytes_ = 0;
+}
+
+const SessionStore::DiskEntry* SessionStore::FindMapped(uint16_t space, const std::string& key) const {
+    size_t lo = 0;
+    size_t hi = entryCount_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const DiskEntry& e = entries_[mid];
+        int c = CompareKey(e.space, keys_ + e.keyOffset, e.keyLength, space, key);
+        if (c == 0) {
+            return &e;
+        }
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return nullptr;
+}
+
+bool SessionStore::ReadMapped(const DiskEntry& entry, std::string* value) const {
+    const char* data = values_ + entry.valueOffset;
+    if (Crc(data, entry.valueLength) != entry.valueCrc) {
+        corruptValues_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    value->assign(data, entry.valueLength);
+    return true;
+}
+
+namespace {
+
+void EncodeRecord(bool put, uint16_t space, const std::string& key, const std::string& value, std::string* out) {
+    RecordBody body{};
+    body.op = put ? kOpPut : kOpDelete;
+    body.space = space;
+    body.keyLength = static_cast<uint32_t>(key.size());
+
+    const size_t start = out->size();
+    out->resize(start + sizeof(RecordFrame));
+    out->append(reinterpret_cast<const char*>(&body), sizeof(body));
+    out->append(key);
+    if (put) {
+        out->append(value);
+    }
+
+    RecordFrame frame;
+    frame.length = static_cast<uint32_t>(out->size() - start - sizeof(RecordFrame));
+    frame.crc = Crc(out->data() + start + sizeof(RecordFrame), frame.length);
+    std::memcpy(&(*out)[start], &frame, sizeof(frame));
+}
+
+} // namespace
+
+void SessionStore::Apply(const LogRecord& record) {
+    auto& slot = overlay_[Key(record.space, record.key)];
+    slot.first = record.put;
+    slot.second = record.put ? record.value : std::string();
+}
+
+// Writes a fresh log holding records at the current generation and switches to it
+int SessionStore::StartLog(const std::vector<LogRecord>& records) {
+    LogHeader header{};
+    std::memcpy(header.magic, kLogMagic, sizeof(kLogMagic));
+    header.version = kVersion;
+    header.generation = generation_;
+
+    std::string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const LogRecord& record : records) {
+        EncodeRecord(record.put, record.space, record.key, record.value, &contents);
+    }
+
+    std::string tempPath = logPath_ + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return errno;
+    }
+    int error = WriteAll(fd, contents.data(), contents.size());
+    if (error == 0 && fsync(fd) != 0) {
+        error = errno;
+    }
+    if (error == 0 && rename(tempPath.c_str(), logPath_.c_str()) != 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        close(fd);
+        unlink(tempPath.c_str());
+        return error;
+    }
+
+    if (logFd_ >= 0) {
+        close(logFd_);
+    }
+    logFd_ = fd;
+    logBytes_ = contents.size();
+    logRecords_ = records.size();
+    return 0;
+}
+
+int SessionStore::Open() {
+    std::lock_guard<std::mutex> compactLock(compactMutex_);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    UnmapSnapshot();
+    overlay_.clear();
+    if (logFd_ >= 0) {
+        close(logFd_);
+        logFd_ = -1;
+    }
+    MapSnapshot();
+
+    // Replay every record up to the first that is torn or fails its CRC
+    std::string log;
+    std::vector<LogRecord> records;
+    size_t validBytes = 0;
+    bool replay = false;
+    if (ReadFile(logPath_, &log) == 0 && log.size() >= sizeof(LogHeader)) {
+        LogHeader header;
+        std::memcpy(&header, log.data(), sizeof(header));
+        replay = std::memcmp(header.magic, kLogMagic, sizeof(kLogMagic)) == 0 && header.version == kVersion &&
+                 (header.generation == generation_ || header.generation + 1 == generation_);
+        // A log one generation behind was already merged into this snapshot; replaying it
+        // again is harmless, but new records must go to a log of the current generation
+        const bool current = replay && header.generation == generation_;
+        size_t offset = sizeof(LogHeader);
+        while (replay && log.size() - offset >= sizeof(RecordFrame) + sizeof(RecordBody)) {
+            RecordFrame frame;
+            std::memcpy(&frame, log.data() + offset, sizeof(frame));
+            const char* body = log.data() + offset + sizeof(frame);
+            if (frame.length < sizeof(RecordBody) || frame.length > log.size() - offset - sizeof(frame) ||
+                Crc(body, frame.length) != frame.crc) {
+                break;
+            }
+            RecordBody fields;
+            std::memcpy(&fields, body, sizeof(fields));
+            if ((fields.op != kOpPut && fields.op != kOpDelete) ||
+                fields.keyLength > frame.length - sizeof(RecordBody)) {
+                break;
+            }
+            LogRecord record;
+            record.put = fields.op == kOpPut;
+            record.space = fields.space;
+            record.key.assign(body + sizeof(RecordBody), fields.keyLength);
+            if (record.put) {
+                record.value.assign(body + sizeof(RecordBody) + fields.keyLength,
+                                    frame.length - sizeof(RecordBody) - fields.keyLength);
+            }
+            Apply(record);
+            records.push_back(std::move(record));
+            offset += sizeof(frame) + frame.length;
+        }
+        validBytes = offset;
+        replay = current;
+    }
+
+    if (replay) {
+        int fd = open(logPath_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd < 0) {
+            return errno;
+        }
+        if (validBytes < log.size() && ftruncate(fd, static_cast<off_t>(validBytes)) != 0) {
+            int error = errno;
+            close(fd);
+            return error;
+        }
+        logFd_ = fd;
+        logBytes_ = validBytes;
+        logRecords_ = records.size();
+        return 0;
+    }
+    // No usable log, or one from the previous generation: start one for this snapshot,
+    // carrying whatever was replayed
+    return StartLog(records);
+}
+
+bool SessionStore::Get(uint16_t space, const std::string& key, std::string* value) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = overlay_.find(Key(space, key));
+    if (it != overlay_.end()) {
+        if (!it->second.first) {
+            return false;
+        }
+        *value = it->second.second;
+        return true;
+    }
+    const DiskEntry* entry = FindMapped(space, key);
+    return entry && ReadMapped(*entry, value);
+}
+
+std::vector<std::string> SessionStore::Keys(uint16_t space) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<std::string> keys;
+
+    // Merge the mapped range of this namespace with the overlay, both sorted
+    size_t m = 0;
+    size_t hi = entryCount_;
+    while (m < hi) {
+        const size_t mid = m + (hi - m) / 2;
+        if (entries_[mid].space < space) {
+            m = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    auto it = overlay_.lower_bound(Key(space, std::string()));
+    while (true) {
+        const bool mapped = m < entryCount_ && entries_[m].space == space;
+        const bool overlaid = it != overlay_.end() && it->first.first == space;
+        if (!mapped && !overlaid) {
+            break;
+        }
+        int c;
+        if (!mapped) {
+            c = 1;
+        } else if (!overlaid) {
+            c = -1;
+        } else {
+            const DiskEntry& e = entries_[m];
+            c = CompareKey(space, keys_ + e.keyOffset, e.keyLength, space, it->first.second);
+        }
+        if (c < 0) {
+            keys.emplace_back(keys_ + entries_[m].keyOffset, entries_[m].keyLength);
+            m++;
+            continue;
+        }
+        if (it->second.first) {
+            keys.push_back(it->first.second);
+        }
+        if (c == 0) {
+            m++;
+        }
+        ++it;
+    }
+    return keys;
+}
+
+int SessionStore::Append(LogRecord record) {
+    if (record.key.size() > MAX_KEY_BYTES || record.value.size() > MAX_VALUE_BYTES) {
+        return EINVAL;
+    }
+    std::string encoded;
+    EncodeRecord(record.put, record.space, record.key, record.value, &encoded);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (logFd_ < 0) {
+        return EBADF;
+    }
+    // One write per record so a crash leaves at most one torn record at the tail
+    int error = WriteAll(logFd_, encoded.data(), encoded.size());
+    if (error != 0) {
+        // Records after a torn one would never replay, so stop appending
+        // until the next Open cuts the tail off
+        if (ftruncate(logFd_, static_cast<off_t>(logBytes_)) != 0) {
+            close(logFd_);
+            logFd_ = -1;
+        }
+        return error;
+    }
+    logBytes_ += encoded.size();
+    logRecords_++;
+    Apply(record);
+    if (compacting_) {
+        appendedDuringCompact_.push_back(std::move(record));
+    }
+    return 0;
+}
+
+int SessionStore::Put(uint16_t space, const std::string& key, const std::string& value) {
+    return Append(LogRecord{true, space, key, value});
+}
+
+int SessionStore::Delete(uint16_t space, const std::string& key) {
+    return Append(LogRecord{false, space, key, std::string()});
+}
+
+bool SessionStore::NeedsCompaction() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return logFd_ >= 0 && logBytes_ >= COMPACT_LOG_BYTES;
+}
+
+int SessionStore::Compact() {
+    std::lock_guard<std::mutex> compactLock(compactMutex_);
+
+    // The mapping only changes under compactMutex_, so it can be read below without mutex_
+    Overlay frozen;
+    uint64_t generation;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (logFd_ < 0) {
+            return EBADF;
+        }
+        if (overlay_.empty()) {
+            return 0;
+        }
+        frozen = overlay_;
+        generation = generation_ + 1;
+        compacting_ = true;
+        appendedDuringCompact_.clear();
+    }
+
+    std::vector<DiskEntry> entries;
+    std::string keys;
+    std::string values;
+    auto append = [&](uint16_t space, const char* key, size_t keyLength, const char* value, size_t valueLength,
+                      uint32_t crc) {
+        DiskEntry e{};
+        e.space = space;
+        e.keyLength = static_cast<uint32_t>(keyLength);
+        e.keyOffset = keys.size();
+        e.valueOffset = values.size();
+        e.valueLength = static_cast<uint32_t>(valueLength);
+        // A value that was already corrupt keeps its stored CRC and stays detected
+        e.valueCrc = crc;
+        keys.append(key, keyLength);
+        values.append(value, valueLength);
+        entries.push_back(e);
+    };
+    auto appendMapped = [&](const DiskEntry& e) {
+        append(e.space, keys_ + e.keyOffset, e.keyLength, values_ + e.valueOffset, e.valueLength, e.valueCrc);
+    };
+
+    size_t m = 0;
+    for (const auto& item : frozen) {
+        const Key& key = item.first;
+        while (m < entryCount_) {
+            const DiskEntry& e = entries_[m];
+            int c = CompareKey(e.space, keys_ + e.keyOffset, e.keyLength, key.first, key.second);
+            if (c > 0) {
+                break;
+            }
+            if (c < 0) {
+                appendMapped(e);
+            }
+            m++;
+        }
+        if (item.second.first) {
+            const std::string& value = item.second.second;
+            append(key.first, key.second.data(), key.second.size(), value.data(), value.size(),
+                   Crc(value.data(), value.size()));
+        }
+    }
+    for (; m < entryCount_; m++) {
+        appendMapped(entries_[m]);
+    }
+    keys.resize((keys.size() + 7) & ~size_t(7), '\0');
+
+    FileHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kVersion;
+    header.entrySize = sizeof(DiskEntry);
+    header.generation = generation;
+    header.entryCount = entries.size();
+    header.keyBytes = keys.size();
+    header.valueBytes = values.size();
+    header.indexCrc = Crc(keys.data(), keys.size(), Crc(entries.data(), entries.size() * sizeof(DiskEntry)));
+
+    std::string tempPath = path_ + ".tmp";
+    int error = 0;
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = errno;
+    } else {
+        error = WriteAll(fd, &header, sizeof(header));
+        if (error == 0) error = WriteAll(fd, entries.data(), entries.size() * sizeof(DiskEntry));
+        if (error == 0) error = WriteAll(fd, keys.data(), keys.size());
+        if (error == 0) error = WriteAll(fd, values.data(), values.size());
+        if (error == 0 && fsync(fd) != 0) {
+            error = errno;
+        }
+        if (close(fd) != 0 && error == 0) {
+            error = errno;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    compacting_ = false;
+    std::vector<LogRecord> appended = std::move(appendedDuringCompact_);
+    appendedDuringCompact_.clear();
+    if (error == 0 && rename(tempPath.c_str(), path_.c_str()) != 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        unlink(tempPath.c_str());
+        return error;
+    }
+
+    // The old log replays over the new snapshot until StartLog replaces it
+    UnmapSnapshot();
+    MapSnapshot();
+    overlay_.clear();
+    for (const LogRecord& record : appended) {
+        Apply(record);
+    }
+    return StartLog(appended);
+}
+
+SessionStoreStats SessionStore::Stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    SessionStoreStats stats;
+    stats.generation = generation_;
+    stats.snapshotRecords = entryCount_;
+    stats.snapshotBytes = mappingSize_;
+    stats.logRecords = logRecords_;
+    stats.logBytes = logBytes_;
+    stats.corruptValues = corruptValues_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace FileCataloger
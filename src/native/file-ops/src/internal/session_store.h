@@ -0,0 +1,144 @@
+/**
+ * @file session_store.h
+ * @brief Binary session snapshot with an append-only delta log
+ *
+ * Holds small records keyed by (namespace, key): recent files, window
+ * bounds, usage counters and shelf sessions. The caller defines what each
+ * namespace and value means; values are opaque bytes.
+ *
+ * Two files live side by side:
+ *
+ * - The snapshot (path): a header, an index sorted by (namespace, key), the
+ *   keys, then the values. It is mapped read-only. Opening validates the
+ *   header and a CRC of the index and keys; each value carries its own CRC,
+ *   checked when it is read. Startup therefore touches the index pages and
+ *   only the values it asks for.
+ * - The delta log (path + ".log"): a header, then one CRC-framed record per
+ *   Put or Delete, appended with a single write. Opening replays it over the
+ *   snapshot and cuts off a torn tail.
+ *
+ * Compact() merges the log into a new snapshot, written to a temporary
+ * file, synced and renamed over the old one, then starts a new log. Puts
+ * made while it writes go to the old log and are carried into the new
+ * one. Each snapshot records a generation, and a log is replayed over the
+ * snapshot of its own generation or the next one. Replaying the same log
+ * twice gives the same state, so a crash between the two renames loses
+ * nothing.
+ *
+ * Get, Put and Delete are safe from any thread; Compact may run on a pool
+ * thread while they are called.
+ */
+
+#ifndef FILE_OPS_SESSION_STORE_H
+#define FILE_OPS_SESSION_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace FileCataloger {
+
+struct SessionStoreStats {
+    uint64_t generation = 0;
+    uint64_t snapshotRecords = 0;
+    uint64_t snapshotBytes = 0;
+    uint64_t logRecords = 0;        // replayed or appended since the last compaction
+    uint64_t logBytes = 0;
+    uint64_t corruptValues = 0;     // values whose CRC failed when read
+};
+
+class SessionStore {
+public:
+    static constexpr size_t MAX_KEY_BYTES = 4096;
+    static constexpr size_t MAX_VALUE_BYTES = 16 << 20;
+    // NeedsCompaction() past this much log
+    static constexpr uint64_t COMPACT_LOG_BYTES = 256 * 1024;
+
+    // Nothing is read until Open()
+    explicit SessionStore(std::string path);
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    // Maps the snapshot and replays the log. A snapshot that fails
+    // validation is ignored (and replaced by the next Compact); returns 0
+    // or the errno of opening the log for appending.
+    int Open();
+
+    // Copies the value out; false if absent or its CRC does not match
+    bool Get(uint16_t space, const std::string& key, std::string* value) const;
+    // Keys of one namespace, in byte order
+    std::vector<std::string> Keys(uint16_t space) const;
+
+    // Append to the log; 0 or an errno (the record is then not applied)
+    int Put(uint16_t space, const std::string& key, const std::string& value);
+    int Delete(uint16_t space, const std::string& key);
+
+    bool NeedsCompaction() const;
+    // Write a new snapshot if the log holds anything; 0 or an errno, in
+    // which case the current files stay in use
+    int Compact();
+
+    SessionStoreStats Stats() const;
+    const std::string& path() const { return path_; }
+
+private:
+    struct FileHeader;
+    struct DiskEntry;
+    struct LogHeader;
+
+    using Key = std::pair<uint16_t, std::string>;
+    // A missing value (second == false) is a deletion
+    using Overlay = std::map<Key, std::pair<bool, std::string>>;
+
+    struct LogRecord {
+        bool put;
+        uint16_t space;
+        std::string key;
+        std::string value;
+    };
+
+    void MapSnapshot();
+    void UnmapSnapshot();
+    const DiskEntry* FindMapped(uint16_t space, const std::string& key) const;
+    bool ReadMapped(const DiskEntry& entry, std::string* value) const;
+    int StartLog(const std::vector<LogRecord>& records);
+    int Append(LogRecord record);
+    void Apply(const LogRecord& record);
+
+    std::string path_;
+    std::string logPath_;
+    mutable std::shared_mutex mutex_;   // state below
+    std::mutex compactMutex_;           // one Compact at a time
+
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    const DiskEntry* entries_ = nullptr;
+    size_t entryCount_ = 0;
+    const char* keys_ = nullptr;
+    size_t keyBytes_ = 0;
+    const char* values_ = nullptr;
+    size_t valueBytes_ = 0;
+    uint64_t generation_ = 0;
+
+    Overlay overlay_;
+    int logFd_ = -1;
+    uint64_t logBytes_ = 0;
+    uint64_t logRecords_ = 0;
+    mutable std::atomic<uint64_t> corruptValues_{0};
+
+    // Records appended while Compact writes, carried into the new log
+    bool compacting_ = false;
+    std::vector<LogRecord> appendedDuringCompact_;
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_SESSION_STORE_H
@@ -0,0 +1,658 @@
+/**
+ * @file shelf_store.cc
+ * @brief Columnar shelf item store: slots, path index and serialization
+ */
+
+#include "shelf_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "file_list_payload.h"
+
+namespace FileCataloger {
+
+namespace {
+
+// Payload columns are copied with memcpy; every supported target is little-endian
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "shelf items payload assumes a little-endian host");
+#endif
+
+#ifdef _WIN32
+constexpr const char* kSeparators = "/\\";
+#else
+constexpr const char* kSeparators = "/";
+#endif
+
+constexpr uint8_t kLastKind = static_cast<uint8_t>(ShelfItemKind::Image);
+
+// Directory including its trailing separator, and the last component
+void SplitPath(std::string_view path, std::string_view* directory, std::string_view* name) {
+    size_t separator = path.find_last_of(kSeparators);
+    size_t split = separator == std::string_view::npos ? 0 : separator + 1;
+    *directory = path.substr(0, split);
+    *name = path.substr(split);
+}
+
+uint32_t Fnv1a(std::string_view text) {
+    uint32_t hash = 2166136261u;
+    for (char c : text) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+size_t PayloadLength(size_t items, size_t directories, size_t stringBytes) {
+    size_t length = SHELF_ITEMS_HEADER_BYTES + items * (3 * 8 + 3 * 4 + 2 + 1) + directories * 2 * 4 + stringBytes;
+    return (length + 7) & ~size_t(7);
+}
+
+template<typename T>
+void PutColumn(uint8_t*& p, const T* values, size_t count) {
+    if (count > 0) {
+        std::memcpy(p, values, count * sizeof(T));
+    }
+    p += count * sizeof(T);
+}
+
+template<typename T>
+T Read(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template<typename T>
+size_t CapacityBytes(const std::vector<T>& column) {
+    return column.capacity() * sizeof(T);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Slots and order
+// ---------------------------------------------------------------------------
+
+uint32_t ShelfStore::SlotOf(ShelfItemId id) const {
+    const uint32_t slot = static_cast<uint32_t>(id);
+    if (slot >= kind_.size() || kind_[slot] == FREE_KIND || generation_[slot] != (id >> 32)) {
+        return NONE;
+    }
+    return slot;
+}
+
+uint32_t ShelfStore::AcquireSlot() {
+    if (!freeSlots_.empty()) {
+        uint32_t slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        return slot;
+    }
+    if (kind_.size() >= MAX_SLOTS) {
+        return NONE;
+    }
+    generation_.push_back(1);
+    directory_.push_back(NONE);
+    nameOffset_.push_back(0);
+    nameLength_.push_back(0);
+    hash_.push_back(0);
+    prev_.push_back(NONE);
+    next_.push_back(NONE);
+    size_.push_back(0);
+    mtime_.push_back(0);
+    flags_.push_back(0);
+    kind_.push_back(FREE_KIND);
+    return static_cast<uint32_t>(kind_.size() - 1);
+}
+
+void ShelfStore::Link(uint32_t slot) {
+    prev_[slot] = tail_;
+    next_[slot] = NONE;
+    if (tail_ == NONE) {
+        head_ = slot;
+    } else {
+        next_[tail_] = slot;
+    }
+    tail_ = slot;
+}
+
+void ShelfStore::Unlink(uint32_t slot) {
+    if (prev_[slot] == NONE) {
+        head_ = next_[slot];
+    } else {
+        next_[prev_[slot]] = next_[slot];
+    }
+    if (next_[slot] == NONE) {
+        tail_ = prev_[slot];
+    } else {
+        prev_[next_[slot]] = prev_[slot];
+    }
+}
+
+std::string_view ShelfStore::NameOf(uint32_t slot) const {
+    return std::string_view(names_).substr(nameOffset_[slot], nameLength_[slot]);
+}
+
+// ---------------------------------------------------------------------------
+// Directories
+// ---------------------------------------------------------------------------
+
+uint32_t ShelfStore::LookupDirectory(std::string_view directory) const {
+    auto it = directoryIndex_.find(directory);
+    return it == directoryIndex_.end() ? NONE : it->second;
+}
+
+uint32_t ShelfStore::InternDirectory(std::string_view directory) {
+    uint32_t id = LookupDirectory(directory);
+    if (id != NONE) {
+        directoryRefs_[id]++;
+        return id;
+    }
+    if (!freeDirectories_.empty()) {
+        id = freeDirectories_.back();
+        freeDirectories_.pop_back();
+        directories_[id].assign(directory.data(), directory.size());
+        directoryRefs_[id] = 1;
+    } else {
+        id = static_cast<uint32_t>(directories_.size());
+        directories_.emplace_back(directory);
+        directoryRefs_.push_back(1);
+    }
+    directoryIndex_.emplace(directories_[id], id);
+    directoryBytes_ += directory.size();
+    return id;
+}
+
+void ShelfStore::ReleaseDirectory(uint32_t directory) {
+    if (--directoryRefs_[directory] > 0) {
+        return;
+    }
+    directoryIndex_.erase(directories_[directory]);
+    directoryBytes_ -= directories_[directory].size();
+    std::string().swap(directories_[directory]);
+    freeDirectories_.push_back(directory);
+}
+
+// ---------------------------------------------------------------------------
+// Path index
+// ---------------------------------------------------------------------------
+
+uint32_t ShelfStore::HashOf(uint32_t directory, std::string_view name) {
+    uint32_t hash = Fnv1a(name) ^ (directory * 0x9E3779B1u);
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+uint32_t ShelfStore::FindSlot(uint32_t directory, std::string_view name, uint32_t hash) const {
+    if (table_.empty()) {
+        return NONE;
+    }
+    const size_t mask = table_.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const uint32_t slot = table_[i];
+        if (slot == NONE) {
+            return NONE;
+        }
+        if (slot != TOMBSTONE && hash_[slot] == hash && directory_[slot] == directory && NameOf(slot) == name) {
+            return slot;
+        }
+    }
+}
+
+void ShelfStore::IndexInsert(uint32_t slot) {
+    if ((tableUsed_ + 1) * 2 > table_.size()) {
+        size_t capacity = 16;
+        while (capacity < (indexed_ + 1) * 4) {
+            capacity *= 2;
+        }
+        Rehash(capacity);
+    }
+    const size_t mask = table_.size() - 1;
+    size_t i = hash_[slot] & mask;
+    while (table_[i] != NONE && table_[i] != TOMBSTONE) {
+        i = (i + 1) & mask;
+    }
+    if (table_[i] == NONE) {
+        tableUsed_++;
+    }
+    table_[i] = slot;
+    indexed_++;
+}
+
+void ShelfStore::IndexErase(uint32_t slot) {
+    const size_t mask = table_.size() - 1;
+    size_t i = hash_[slot] & mask;
+    while (table_[i] != slot) {
+        i = (i + 1) & mask;
+    }
+    table_[i] = TOMBSTONE;
+    indexed_--;
+}
+
+void ShelfStore::Rehash(size_t capacity) {
+    std::vector<uint32_t> old;
+    old.swap(table_);
+    table_.assign(capacity, NONE);
+    tableUsed_ = 0;
+    const size_t mask = capacity - 1;
+    for (uint32_t slot : old) {
+        if (slot == NONE || slot == TOMBSTONE) {
+            continue;
+        }
+        size_t i = hash_[slot] & mask;
+        while (table_[i] != NONE) {
+            i = (i + 1) & mask;
+        }
+        table_[i] = slot;
+        tableUsed_++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Items
+// ---------------------------------------------------------------------------
+
+size_t ShelfStore::Insert(const ShelfItemRecord* records, size_t count, ShelfItemId* ids) {
+    size_t added = 0;
+    for (size_t i = 0; i < count; i++) {
+        const ShelfItemRecord& record = records[i];
+        std::string_view directory;
+        std::string_view name = record.name;
+        uint32_t hash = 0;
+        if (!record.path.empty()) {
+            SplitPath(record.path, &directory, &name);
+            uint32_t known = LookupDirectory(directory);
+            if (known != NONE) {
+                uint32_t existing = FindSlot(known, name, HashOf(known, name));
+                if (existing != NONE) {
+                    ids[i] = IdOf(existing);
+                    continue;
+                }
+            }
+        }
+
+        const uint32_t slot = AcquireSlot();
+        if (slot == NONE) {
+            ids[i] = 0;
+            continue;
+        }
+        uint32_t directoryId = NONE;
+        if (!record.path.empty()) {
+            directoryId = InternDirectory(directory);
+            hash = HashOf(directoryId, name);
+        }
+        directory_[slot] = directoryId;
+        nameOffset_[slot] = static_cast<uint32_t>(names_.size());
+        nameLength_[slot] = static_cast<uint32_t>(name.size());
+        names_.append(name.data(), name.size());
+        hash_[slot] = hash;
+        size_[slot] = record.size;
+        mtime_[slot] = record.mtimeMs;
+        flags_[slot] = record.flags;
+        kind_[slot] = static_cast<uint8_t>(record.kind);
+        if (directoryId != NONE) {
+            IndexInsert(slot);
+        }
+        Link(slot);
+        count_++;
+        added++;
+        ids[i] = IdOf(slot);
+    }
+    return added;
+}
+
+bool ShelfStore::InsertFileList(const uint8_t* payload, size_t length, std::vector<ShelfItemId>* ids,
+                                size_t* added) {
+    FileListPayloadReader reader;
+    if (!reader.Open(payload, length)) {
+        return false;
+    }
+    std::vector<ShelfItemRecord> records(reader.Count());
+    for (size_t i = 0; i < records.size(); i++) {
+        FileListEntry entry = reader.Entry(i);
+        records[i].path = entry.path;
+        records[i].kind = (entry.flags & FILE_LIST_IS_DIRECTORY) ? ShelfItemKind::Folder : ShelfItemKind::File;
+        records[i].flags = entry.flags;
+        records[i].size = entry.size;
+    }
+    ids->assign(records.size(), 0);
+    *added = Insert(records.data(), records.size(), ids->data());
+    return true;
+}
+
+bool ShelfStore::Remove(ShelfItemId id) {
+    const uint32_t slot = SlotOf(id);
+    if (slot == NONE) {
+        return false;
+    }
+    if (directory_[slot] != NONE) {
+        IndexErase(slot);
+        ReleaseDirectory(directory_[slot]);
+    }
+    Unlink(slot);
+    garbageBytes_ += nameLength_[slot];
+    kind_[slot] = FREE_KIND;
+    generation_[slot] = generation_[slot] >= MAX_GENERATION ? 1 : generation_[slot] + 1;
+    freeSlots_.push_back(slot);
+    count_--;
+    if (garbageBytes_ * 2 > names_.size()) {
+        CompactNames();
+    }
+    return true;
+}
+
+void ShelfStore::Clear() {
+    for (uint32_t slot = head_; slot != NONE; slot = next_[slot]) {
+        kind_[slot] = FREE_KIND;
+        generation_[slot] = generation_[slot] >= MAX_GENERATION ? 1 : generation_[slot] + 1;
+        freeSlots_.push_back(slot);
+    }
+    head_ = tail_ = NONE;
+    count_ = 0;
+    std::string().swap(names_);
+    garbageBytes_ = 0;
+    directories_.clear();
+    directoryRefs_.clear();
+    directoryIndex_.clear();
+    freeDirectories_.clear();
+    directoryBytes_ = 0;
+    std::vector<uint32_t>().swap(table_);
+    tableUsed_ = 0;
+    indexed_ = 0;
+}
+
+void ShelfStore::CompactNames() {
+    std::string compacted;
+    compacted.reserve(names_.size() - garbageBytes_);
+    for (uint32_t slot = head_; slot != NONE; slot = next_[slot]) {
+        std::string_view name = NameOf(slot);
+        nameOffset_[slot] = static_cast<uint32_t>(compacted.size());
+        compacted.append(name.data(), name.size());
+    }
+    names_.swap(compacted);
+    garbageBytes_ = 0;
+}
+
+ShelfItemId ShelfStore::Find(std::string_view path) const {
+    if (path.empty()) {
+        return 0;
+    }
+    std::string_view directory;
+    std::string_view name;
+    SplitPath(path, &directory, &name);
+    const uint32_t directoryId = LookupDirectory(directory);
+    if (directoryId == NONE) {
+        return 0;
+    }
+    const uint32_t slot = FindSlot(directoryId, name, HashOf(directoryId, name));
+    return slot == NONE ? 0 : IdOf(slot);
+}
+
+bool ShelfStore::Get(ShelfItemId id, ShelfItem* item) const {
+    const uint32_t slot = SlotOf(id);
+    if (slot == NONE) {
+        return false;
+    }
+    item->id = id;
+    item->name.assign(NameOf(slot));
+    if (directory_[slot] == NONE) {
+        item->path.clear();
+    } else {
+        item->path = directories_[directory_[slot]];
+        item->path += item->name;
+    }
+    item->kind = static_cast<ShelfItemKind>(kind_[slot]);
+    item->flags = flags_[slot];
+    item->size = size_[slot];
+    item->mtimeMs = mtime_[slot];
+    return true;
+}
+
+std::vector<ShelfItemId> ShelfStore::Ids() const {
+    std::vector<ShelfItemId> ids;
+    ids.reserve(count_);
+    for (uint32_t slot = head_; slot != NONE; slot = next_[slot]) {
+        ids.push_back(IdOf(slot));
+    }
+    return ids;
+}
+
+// ---------------------------------------------------------------------------
+// Serialization
+// ---------------------------------------------------------------------------
+
+size_t ShelfStore::SerializedLength() const {
+    return PayloadLength(count_, directoryIndex_.size(), directoryBytes_ + names_.size() - garbageBytes_);
+}
+
+void ShelfStore::SerializeTo(void* out) const {
+    const size_t n = count_;
+    const size_t d = directoryIndex_.size();
+    const size_t nameBytes = names_.size() - garbageBytes_;
+    const size_t stringBytes = directoryBytes_ + nameBytes;
+
+    // Directories are numbered densely, in order of first use
+    std::vector<uint32_t> dense(directories_.size(), NONE);
+    std::vector<uint32_t> used;
+    used.reserve(d);
+
+    std::vector<double> ids(n);
+    std::vector<double> sizes(n);
+    std::vector<double> mtimes(n);
+    std::vector<uint32_t> directory(n);
+    std::vector<uint32_t> nameOffset(n);
+    std::vector<uint32_t> nameLength(n);
+    std::vector<uint16_t> flags(n);
+    std::vector<uint8_t> kind(n);
+    uint32_t nameCursor = static_cast<uint32_t>(directoryBytes_);
+    size_t i = 0;
+    for (uint32_t slot = head_; slot != NONE; slot = next_[slot], i++) {
+        ids[i] = static_cast<double>(IdOf(slot));
+        sizes[i] = size_[slot];
+        mtimes[i] = mtime_[slot];
+        const uint32_t dir = directory_[slot];
+        if (dir == NONE) {
+            directory[i] = NONE;
+        } else {
+            if (dense[dir] == NONE) {
+                dense[dir] = static_cast<uint32_t>(used.size());
+                used.push_back(dir);
+            }
+            directory[i] = dense[dir];
+        }
+        nameOffset[i] = nameCursor;
+        nameLength[i] = nameLength_[slot];
+        nameCursor += nameLength_[slot];
+        flags[i] = flags_[slot];
+        kind[i] = kind_[slot];
+    }
+
+    std::vector<uint32_t> directoryOffset(d);
+    std::vector<uint32_t> directoryLength(d);
+    uint32_t directoryCursor = 0;
+    for (size_t k = 0; k < d; k++) {
+        directoryOffset[k] = directoryCursor;
+        directoryLength[k] = static_cast<uint32_t>(directories_[used[k]].size());
+        directoryCursor += directoryLength[k];
+    }
+
+    auto* bytes = static_cast<uint8_t*>(out);
+    uint8_t* p = bytes;
+    const uint32_t header32[] = {SHELF_ITEMS_PAYLOAD_MAGIC};
+    const uint16_t header16[] = {SHELF_ITEMS_PAYLOAD_VERSION, 0};
+    const uint32_t counts[] = {static_cast<uint32_t>(n), static_cast<uint32_t>(d),
+                               static_cast<uint32_t>(stringBytes), 0};
+    PutColumn(p, header32, 1);
+    PutColumn(p, header16, 2);
+    PutColumn(p, counts, 4);
+    PutColumn(p, ids.data(), n);
+    PutColumn(p, sizes.data(), n);
+    PutColumn(p, mtimes.data(), n);
+    PutColumn(p, directory.data(), n);
+    PutColumn(p, nameOffset.data(), n);
+    PutColumn(p, nameLength.data(), n);
+    PutColumn(p, directoryOffset.data(), d);
+    PutColumn(p, directoryLength.data(), d);
+    PutColumn(p, flags.data(), n);
+    PutColumn(p, kind.data(), n);
+    for (uint32_t dir : used) {
+        PutColumn(p, directories_[dir].data(), directories_[dir].size());
+    }
+    for (uint32_t slot = head_; slot != NONE; slot = next_[slot]) {
+        PutColumn(p, names_.data() + nameOffset_[slot], nameLength_[slot]);
+    }
+    std::memset(p, 0, bytes + PayloadLength(n, d, stringBytes) - p);
+}
+
+std::vector<uint8_t> ShelfStore::Serialize() const {
+    std::vector<uint8_t> payload(SerializedLength());
+    SerializeTo(payload.data());
+    return payload;
+}
+
+bool ShelfStore::Load(const uint8_t* payload, size_t length) {
+    *this = ShelfStore();
+    if (length < SHELF_ITEMS_HEADER_BYTES || Read<uint32_t>(payload) != SHELF_ITEMS_PAYLOAD_MAGIC ||
+        Read<uint16_t>(payload + 4) != SHELF_ITEMS_PAYLOAD_VERSION) {
+        return false;
+    }
+    const uint64_t n = Read<uint32_t>(payload + 8);
+    const uint64_t d = Read<uint32_t>(payload + 12);
+    const uint64_t s = Read<uint32_t>(payload + 16);
+    if (n > MAX_SLOTS || SHELF_ITEMS_HEADER_BYTES + n * 39 + d * 8 + s > length) {
+        return false;
+    }
+
+    const uint8_t* ids = payload + SHELF_ITEMS_HEADER_BYTES;
+    const uint8_t* sizes = ids + n * 8;
+    const uint8_t* mtimes = sizes + n * 8;
+    const uint8_t* directory = mtimes + n * 8;
+    const uint8_t* nameOffset = directory + n * 4;
+    const uint8_t* nameLength = nameOffset + n * 4;
+    const uint8_t* directoryOffset = nameLength + n * 4;
+    const uint8_t* directoryLength = directoryOffset + d * 4;
+    const uint8_t* flags = directoryLength + d * 4;
+    const uint8_t* kind = flags + n * 2;
+    const std::string_view strings(reinterpret_cast<const char*>(kind + n), s);
+
+    auto fail = [this]() {
+        *this = ShelfStore();
+        return false;
+    };
+
+    // Ids first: they fix the slot count
+    uint64_t slots = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        const double value = Read<double>(ids + i * 8);
+        if (!(value >= 1 && value < 9007199254740992.0)) {
+            return fail();
+        }
+        const uint64_t id = static_cast<uint64_t>(value);
+        const uint64_t generation = id >> 32;
+        if (static_cast<double>(id) != value || generation < 1 || generation > MAX_GENERATION ||
+            (id & 0xFFFFFFFF) >= MAX_SLOTS) {
+            return fail();
+        }
+        slots = std::max(slots, (id & 0xFFFFFFFF) + 1);
+    }
+    generation_.assign(slots, 1);
+    directory_.assign(slots, NONE);
+    nameOffset_.assign(slots, 0);
+    nameLength_.assign(slots, 0);
+    hash_.assign(slots, 0);
+    prev_.assign(slots, NONE);
+    next_.assign(slots, NONE);
+    size_.assign(slots, 0);
+    mtime_.assign(slots, 0);
+    flags_.assign(slots, 0);
+    kind_.assign(slots, FREE_KIND);
+
+    std::vector<uint32_t> directoryIds(d, NONE);
+    for (uint64_t i = 0; i < n; i++) {
+        const uint64_t id = static_cast<uint64_t>(Read<double>(ids + i * 8));
+        const uint32_t slot = static_cast<uint32_t>(id);
+        const uint8_t itemKind = kind[i];
+        const uint64_t offset = Read<uint32_t>(nameOffset + i * 4);
+        const uint64_t nameBytes = Read<uint32_t>(nameLength + i * 4);
+        if (kind_[slot] != FREE_KIND || itemKind > kLastKind || offset + nameBytes > s) {
+            return fail();
+        }
+        const std::string_view name = strings.substr(offset, nameBytes);
+        const uint32_t dir = Read<uint32_t>(directory + i * 4);
+        uint32_t directoryId = NONE;
+        if (dir != NONE) {
+            if (dir >= d || name.find_first_of(kSeparators) != std::string_view::npos) {
+                return fail();
+            }
+            if (directoryIds[dir] == NONE) {
+                const uint64_t dirOffset = Read<uint32_t>(directoryOffset + dir * 4);
+                const uint64_t dirBytes = Read<uint32_t>(directoryLength + dir * 4);
+                if (dirOffset + dirBytes > s) {
+                    return fail();
+                }
+                const std::string_view path = strings.substr(dirOffset, dirBytes);
+                if (!path.empty() && std::strchr(kSeparators, path.back()) == nullptr) {
+                    return fail();
+                }
+                directoryIds[dir] = InternDirectory(path);
+            } else {
+                directoryRefs_[directoryIds[dir]]++;
+            }
+            directoryId = directoryIds[dir];
+            if (FindSlot(directoryId, name, HashOf(directoryId, name)) != NONE) {
+                return fail();
+            }
+        }
+
+        generation_[slot] = static_cast<uint32_t>(id >> 32);
+        directory_[slot] = directoryId;
+        nameOffset_[slot] = static_cast<uint32_t>(names_.size());
+        nameLength_[slot] = static_cast<uint32_t>(name.size());
+        names_.append(name.data(), name.size());
+        size_[slot] = Read<double>(sizes + i * 8);
+        mtime_[slot] = Read<double>(mtimes + i * 8);
+        flags_[slot] = Read<uint16_t>(flags + i * 2);
+        kind_[slot] = itemKind;
+        if (directoryId != NONE) {
+            hash_[slot] = HashOf(directoryId, name);
+            IndexInsert(slot);
+        }
+        Link(slot);
+        count_++;
+    }
+
+    // Gaps between restored ids are free, lowest reused first. Their old
+    // generations are not saved, so they start past every saved one.
+    uint32_t next = 1;
+    for (uint32_t generation : generation_) {
+        next = std::max(next, generation);
+    }
+    next = next >= MAX_GENERATION ? 1 : next + 1;
+    for (uint32_t slot = static_cast<uint32_t>(slots); slot-- > 0;) {
+        if (kind_[slot] == FREE_KIND) {
+            generation_[slot] = next;
+            freeSlots_.push_back(slot);
+        }
+    }
+    return true;
+}
+
+ShelfStoreStats ShelfStore::Stats() const {
+    ShelfStoreStats stats;
+    stats.items = count_;
+    stats.slots = kind_.size();
+    stats.directories = directoryIndex_.size();
+    stats.nameBytes = names_.size();
+    stats.garbageBytes = garbageBytes_;
+    stats.memoryBytes = CapacityBytes(generation_) + CapacityBytes(directory_) + CapacityBytes(nameOffset_) +
+                        CapacityBytes(nameLength_) + CapacityBytes(hash_) + CapacityBytes(prev_) +
+                        CapacityBytes(next_) + CapacityBytes(size_) + CapacityBytes(mtime_) +
+                        CapacityBytes(flags_) + CapacityBytes(kind_) + CapacityBytes(freeSlots_) +
+                        CapacityBytes(table_) + CapacityBytes(directoryRefs_) + names_.capacity() +
+                        directoryBytes_ + directoryIndex_.size() * (sizeof(std::string) + 2 * sizeof(void*) + 16);
+    return stats;
+}
+
+} // namespace FileCataloger
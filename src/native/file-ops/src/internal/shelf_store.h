@@ -0,0 +1,204 @@
+/**
+ * @file shelf_store.h
+ * @brief Columnar store of one shelf's items
+ *
+ * Items are kept as parallel columns indexed by slot (structure of
+ * arrays), not as one object each: generation, directory, name offset and
+ * length, kind, flags, size and mtime. A path is split into its directory,
+ * interned once per store with a reference count, and its last component,
+ * appended to a shared name arena. 100k files dropped from a few folders
+ * then cost about 60 bytes each in columns and index, plus their names.
+ *
+ * - Ids are stable handles: the slot in the low 32 bits, the slot's
+ *   generation above. Removing an item bumps the generation, so a stale id
+ *   never reaches the item that reuses the slot. Ids stay below 2^53 and
+ *   cross into JS as plain numbers.
+ * - Removed slots go on a free list and are reused first, so removal is
+ *   O(1) and the columns never need compacting. The name arena is rewritten
+ *   once more than half of it belongs to removed items.
+ * - An open-addressing hash index over (directory, name) finds a path in
+ *   O(1); inserting a path already on the shelf returns the existing id.
+ * - Shelf order is a doubly linked list through the slots.
+ *
+ * Serialize() writes the items in shelf order as one compact payload,
+ * column by column, read in JS by ShelfItemsView (src/shared/shelfItemsPayload.ts)
+ * and by Load(). Little-endian, every offset in bytes:
+ *
+ *   header (24)     u32 magic 'FCSI', u16 version, u16 0,
+ *                   u32 item count n, u32 directory count d,
+ *                   u32 string bytes s, u32 0
+ *   f64 id[n]       ShelfItemId
+ *   f64 size[n]     bytes, NaN when unknown
+ *   f64 mtime[n]    ms since the epoch, NaN when unknown
+ *   u32 directory[n]   index into the directory table, 0xFFFFFFFF without a path
+ *   u32 nameOffset[n], u32 nameLength[n]
+ *   u32 directoryOffset[d], u32 directoryLength[d]
+ *   u16 flags[n]
+ *   u8  kind[n]
+ *   strings (s)     directories (each ending in its separator) then names, UTF-8
+ *
+ * The total length is padded to a multiple of 8. Only directories in use
+ * and live names are written.
+ *
+ * Not thread-safe; the binding calls it from the JS thread only.
+ */
+
+#ifndef FILE_OPS_SHELF_STORE_H
+#define FILE_OPS_SHELF_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace FileCataloger {
+
+// Mirrors ShelfItemType in src/shared/enums.ts
+enum class ShelfItemKind : uint8_t {
+    File = 0,
+    Folder = 1,
+    Text = 2,
+    Url = 3,
+    Image = 4
+};
+
+using ShelfItemId = uint64_t;   // 0 is never a valid id
+
+constexpr uint32_t SHELF_ITEMS_PAYLOAD_MAGIC = 0x49534346;  // "FCSI"
+constexpr uint16_t SHELF_ITEMS_PAYLOAD_VERSION = 1;
+constexpr size_t SHELF_ITEMS_HEADER_BYTES = 24;
+
+struct ShelfItemRecord {
+    std::string_view path;        // empty for text and URL items
+    std::string_view name;        // used only without a path; otherwise the path's last component
+    ShelfItemKind kind = ShelfItemKind::File;
+    uint16_t flags = 0;           // the caller's; InsertFileList stores the file list's flags
+    double size = std::numeric_limits<double>::quiet_NaN();
+    double mtimeMs = std::numeric_limits<double>::quiet_NaN();
+};
+
+struct ShelfItem {
+    ShelfItemId id = 0;
+    std::string path;
+    std::string name;
+    ShelfItemKind kind = ShelfItemKind::File;
+    uint16_t flags = 0;
+    double size = std::numeric_limits<double>::quiet_NaN();
+    double mtimeMs = std::numeric_limits<double>::quiet_NaN();
+};
+
+struct ShelfStoreStats {
+    size_t items = 0;
+    size_t slots = 0;             // items plus free slots
+    size_t directories = 0;
+    size_t nameBytes = 0;         // arena size, garbage included
+    size_t garbageBytes = 0;      // names of removed items, until the arena is rewritten
+    size_t memoryBytes = 0;       // columns, arena, directories and index, by capacity
+};
+
+class ShelfStore {
+public:
+    // Appends records in order; ids[i] is the new id, or that of the item
+    // already holding records[i]'s path. Returns how many were added. A store
+    // holds at most 2^24 items; past that, ids are left 0.
+    size_t Insert(const ShelfItemRecord* records, size_t count, ShelfItemId* ids);
+
+    // Insert() of every entry of a file-list payload (common/file_list_payload.h),
+    // as folders or files by its directory flag. False, adding nothing, for
+    // a malformed payload.
+    bool InsertFileList(const uint8_t* payload, size_t length, std::vector<ShelfItemId>* ids, size_t* added);
+
+    // False for an unknown or stale id
+    bool Remove(ShelfItemId id);
+    // Removes every item; their ids go stale like removed ones
+    void Clear();
+
+    // 0 when the path is not on the shelf
+    ShelfItemId Find(std::string_view path) const;
+    bool Contains(ShelfItemId id) const { return SlotOf(id) != NONE; }
+    bool Get(ShelfItemId id, ShelfItem* item) const;
+
+    size_t Size() const { return count_; }
+    // Shelf order
+    std::vector<ShelfItemId> Ids() const;
+
+    size_t SerializedLength() const;
+    // out must hold SerializedLength() bytes
+    void SerializeTo(void* out) const;
+    std::vector<uint8_t> Serialize() const;
+
+    // Replaces the contents with a serialized store, keeping its ids; slots
+    // between them are free. False, leaving the store empty, for a malformed
+    // payload.
+    bool Load(const uint8_t* payload, size_t length);
+
+    ShelfStoreStats Stats() const;
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+    static constexpr uint32_t TOMBSTONE = 0xFFFFFFFE;
+    static constexpr uint8_t FREE_KIND = 0xFF;
+    static constexpr uint32_t MAX_SLOTS = 1u << 24;
+    static constexpr uint32_t MAX_GENERATION = (1u << 21) - 1;   // ids below 2^53
+
+    uint32_t SlotOf(ShelfItemId id) const;
+    ShelfItemId IdOf(uint32_t slot) const { return (static_cast<uint64_t>(generation_[slot]) << 32) | slot; }
+
+    uint32_t AcquireSlot();
+    void Link(uint32_t slot);
+    void Unlink(uint32_t slot);
+    uint32_t InternDirectory(std::string_view directory);
+    void ReleaseDirectory(uint32_t directory);
+    std::string_view NameOf(uint32_t slot) const;
+    uint32_t LookupDirectory(std::string_view directory) const;
+
+    // Hash index over (directory, name)
+    static uint32_t HashOf(uint32_t directory, std::string_view name);
+    uint32_t FindSlot(uint32_t directory, std::string_view name, uint32_t hash) const;
+    void IndexInsert(uint32_t slot);
+    void IndexErase(uint32_t slot);
+    void Rehash(size_t capacity);
+
+    void CompactNames();
+
+    // Columns, one entry per slot
+    std::vector<uint32_t> generation_;
+    std::vector<uint32_t> directory_;    // NONE for items without a path
+    std::vector<uint32_t> nameOffset_;
+    std::vector<uint32_t> nameLength_;
+    std::vector<uint32_t> hash_;
+    std::vector<uint32_t> prev_;
+    std::vector<uint32_t> next_;
+    std::vector<double> size_;
+    std::vector<double> mtime_;
+    std::vector<uint16_t> flags_;
+    std::vector<uint8_t> kind_;          // FREE_KIND for free slots
+
+    std::vector<uint32_t> freeSlots_;
+    uint32_t head_ = NONE;
+    uint32_t tail_ = NONE;
+    size_t count_ = 0;
+
+    std::string names_;
+    size_t garbageBytes_ = 0;
+
+    // Directory strings end in their separator; ids of released directories
+    // are reused. A deque so the index's views survive growth.
+    std::deque<std::string> directories_;
+    std::vector<uint32_t> directoryRefs_;
+    std::unordered_map<std::string_view, uint32_t> directoryIndex_;
+    std::vector<uint32_t> freeDirectories_;
+    size_t directoryBytes_ = 0;          // of directories in use
+
+    std::vector<uint32_t> table_;        // slots, NONE or TOMBSTONE; capacity a power of two
+    size_t tableUsed_ = 0;               // slots plus tombstones
+    size_t indexed_ = 0;                 // items with a path
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_SHELF_STORE_H
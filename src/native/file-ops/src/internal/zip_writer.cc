@@ -0,0 +1,954 @@
+/**
+ * @file zip_writer.cc
+ * @brief Streaming ZIP64 writer: ordered reader, parallel deflate, ordered writer
+ */
+
+#include "zip_writer.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include "directory_reader.h"
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr const char* kPartialSuffix = ".fcpart";
+constexpr size_t kDictionarySize = 32 * 1024;
+constexpr size_t kOutputBufferSize = 1 << 20;
+constexpr size_t kDirectWriteSize = 256 * 1024;   // larger appends bypass the buffer
+constexpr int kMaxFolderDepth = 256;
+
+// Entries this large reserve ZIP64 sizes in their local header; the margin
+// covers deflate's worst-case growth on incompressible data
+constexpr uint64_t kZip64EntrySize = 0xF0000000ull;
+constexpr uint64_t kMax32 = 0xFFFFFFFFull;
+
+constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+constexpr uint32_t kEndSignature = 0x06054b50;
+constexpr uint32_t kZip64EndSignature = 0x06064b50;
+constexpr uint32_t kZip64LocatorSignature = 0x07064b50;
+constexpr uint16_t kZip64ExtraId = 0x0001;
+constexpr uint16_t kTimestampExtraId = 0x5455;   // "UT": Unix mtime
+constexpr uint16_t kUtf8Flag = 0x0800;
+constexpr uint16_t kMadeByUnix = 3 << 8;
+constexpr uint16_t kLocalHeaderSize = 30;
+
+// CRC-32 of two concatenated blocks from their CRCs and the second block's
+// length (zlib's crc32_combine, which Node's bundled zlib.h hides when
+// _FILE_OFFSET_BITS is 64): crc1 * x^(8 * length2) mod P, plus crc2, in GF(2)
+constexpr uint32_t kCrcPolynomial = 0xEDB88320;
+
+uint32_t MultiplyModP(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = 1u << 31; m != 0; m >>= 1) {
+        if (a & m) {
+            product ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        b = (b & 1) ? (b >> 1) ^ kCrcPolynomial : b >> 1;
+    }
+    return product;
+}
+
+uint32_t CrcCombine(uint32_t crc1, uint32_t crc2, uint64_t length2) {
+    // x^(2^n) mod P for n = 0..63
+    static const auto powers = [] {
+        std::array<uint32_t, 64> table{};
+        uint32_t p = 1u << 30;   // x^1
+        for (auto& entry : table) {
+            entry = p;
+            p = MultiplyModP(p, p);
+        }
+        return table;
+    }();
+    uint32_t shift = 1u << 31;   // x^0
+    for (uint64_t bits = length2 * 8, n = 0; bits != 0; bits >>= 1, n++) {
+        if (bits & 1) {
+            shift = MultiplyModP(powers[n], shift);
+        }
+    }
+    return MultiplyModP(shift, crc1) ^ crc2;
+}
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void Put16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void Put32(std::vector<uint8_t>& out, uint32_t value) {
+    Put16(out, value & 0xFFFF);
+    Put16(out, value >> 16);
+}
+
+void Put64(std::vector<uint8_t>& out, uint64_t value) {
+    Put32(out, static_cast<uint32_t>(value));
+    Put32(out, static_cast<uint32_t>(value >> 32));
+}
+
+void Store32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+void Store64(uint8_t* p, uint64_t value) {
+    Store32(p, static_cast<uint32_t>(value));
+    Store32(p + 4, static_cast<uint32_t>(value >> 32));
+}
+
+int WriteAll(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return 0;
+}
+
+// "a/./b//c" -> "a/b/c"; empty when the name would escape the archive root
+std::string CleanName(const std::string& name) {
+    std::string clean;
+    size_t start = 0;
+    while (start <= name.size()) {
+        size_t end = name.find('/', start);
+        if (end == std::string::npos) {
+            end = name.size();
+        }
+        std::string part = name.substr(start, end - start);
+        if (part == "..") {
+            return std::string();
+        }
+        if (!part.empty() && part != ".") {
+            if (!clean.empty()) {
+                clean += '/';
+            }
+            clean += part;
+        }
+        start = end + 1;
+    }
+    return clean;
+}
+
+std::string BaseName(const std::string& path) {
+    size_t end = path.find_last_not_of('/');
+    if (end == std::string::npos) {
+        return std::string();
+    }
+    size_t start = path.find_last_of('/', end);
+    start = start == std::string::npos ? 0 : start + 1;
+    return path.substr(start, end - start + 1);
+}
+
+// One zlib stream per pool thread, reset between chunks
+struct DeflateStream {
+    z_stream stream{};
+    int level = -1;
+
+    ~DeflateStream() {
+        if (level >= 0) {
+            deflateEnd(&stream);
+        }
+    }
+
+    bool Prepare(int wanted) {
+        if (level == wanted) {
+            return deflateReset(&stream) == Z_OK;
+        }
+        if (level >= 0) {
+            deflateEnd(&stream);
+            level = -1;
+        }
+        stream = z_stream{};
+        if (deflateInit2(&stream, wanted, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        level = wanted;
+        return true;
+    }
+};
+
+// Bytes of an entry's first chunk deflated to decide whether to store it
+constexpr size_t kProbeBytes = 64 * 1024;
+
+// False when level 1 deflate does not shrink data at all, as for random,
+// encrypted or compressed content the sniffer does not know
+bool DeflateShrinks(const uint8_t* data, size_t size) {
+    thread_local DeflateStream probe;
+    thread_local std::vector<uint8_t> output;
+    if (size == 0 || !probe.Prepare(1)) {
+        return true;
+    }
+    output.resize(deflateBound(&probe.stream, static_cast<uLong>(size)));
+    probe.stream.next_in = const_cast<Bytef*>(data);
+    probe.stream.avail_in = static_cast<uInt>(size);
+    probe.stream.next_out = output.data();
+    probe.stream.avail_out = static_cast<uInt>(output.size());
+    return deflate(&probe.stream, Z_FINISH) == Z_STREAM_END && probe.stream.total_out < size;
+}
+
+} // namespace
+
+struct ZipWriter::Chunk {
+    size_t entry = 0;
+    bool first = false;
+    bool last = false;
+    bool stored = false;
+    std::vector<uint8_t> input;       // dictionary, then this chunk's data
+    size_t dictionarySize = 0;
+    size_t dataSize = 0;              // input bytes, kept after input is released
+    std::vector<uint8_t> output;      // deflated data (empty when stored)
+    uint32_t crc = 0;
+    int error = 0;
+    bool ready = false;               // guarded by ZipWriter::mutex_
+
+    const uint8_t* Data() const { return input.data() + dictionarySize; }
+};
+
+bool IsCompressedContent(ContentType type) {
+    switch (type) {
+        case ContentType::Jpeg:
+        case ContentType::Png:
+        case ContentType::Gif:
+        case ContentType::Webp:
+        case ContentType::Heic:
+        case ContentType::Avif:
+        case ContentType::Zip:
+        case ContentType::Gzip:
+        case ContentType::Bzip2:
+        case ContentType::Xz:
+        case ContentType::Zstd:
+        case ContentType::SevenZip:
+        case ContentType::Rar:
+        case ContentType::Epub:
+        case ContentType::OpenDocument:
+        case ContentType::Ooxml:
+        case ContentType::Docx:
+        case ContentType::Xlsx:
+        case ContentType::Pptx:
+        case ContentType::Mp3:
+        case ContentType::Aac:
+        case ContentType::Flac:
+        case ContentType::Ogg:
+        case ContentType::M4a:
+        case ContentType::Mp4:
+        case ContentType::Mov:
+        case ContentType::Avi:
+        case ContentType::Matroska:
+        case ContentType::Webm:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t DosDateTime(int64_t unixSeconds) {
+    time_t seconds = static_cast<time_t>(unixSeconds);
+    struct tm local;
+    if (!localtime_r(&seconds, &local) || local.tm_year < 80) {
+        return (1 << 21) | (1 << 16);   // 1980-01-01 00:00, the earliest DOS date
+    }
+    if (local.tm_year > 207) {
+        local = tm{};
+        local.tm_year = 207;
+        local.tm_mon = 11;
+        local.tm_mday = 31;
+        local.tm_hour = 23;
+        local.tm_min = 59;
+        local.tm_sec = 58;
+    }
+    const uint32_t date = ((local.tm_year - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday;
+    const uint32_t time = (local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2);
+    return (date << 16) | time;
+}
+
+std::shared_ptr<ZipWriter> ZipWriter::Create(std::vector<ZipSource> sources, std::string outputPath,
+                                             ZipOptions options, ProgressSink onProgress, DoneSink onDone) {
+    return std::shared_ptr<ZipWriter>(new ZipWriter(std::move(sources), std::move(outputPath), options,
+                                                    std::move(onProgress), std::move(onDone)));
+}
+
+ZipWriter::ZipWriter(std::vector<ZipSource> sources, std::string outputPath, ZipOptions options,
+                     ProgressSink onProgress, DoneSink onDone)
+    : sources_(std::move(sources)),
+      outputPath_(std::move(outputPath)),
+      partialPath_(outputPath_ + kPartialSuffix),
+      options_(options),
+      onProgress_(std::move(onProgress)),
+      onDone_(std::move(onDone)) {
+    options_.level = std::max(0, std::min(9, options_.level));
+    options_.chunkSize = std::max<size_t>(options_.chunkSize, 64 * 1024);
+}
+
+ZipWriter::~ZipWriter() {
+    if (readFd_ >= 0) {
+        close(readFd_);
+    }
+    if (outFd_ >= 0) {
+        close(outFd_);
+    }
+}
+
+void ZipWriter::Start(WorkStealingPool& pool) {
+    pool_ = &pool;
+    startTime_ = std::chrono::steady_clock::now();
+    lastProgressNs_.store(NowNs(), std::memory_order_relaxed);
+    maxChunksInFlight_ = options_.maxChunksInFlight > 0 ? options_.maxChunksInFlight : pool.ThreadCount() * 2 + 2;
+    {
+        std::lock_guard<std::mutex> lock(finishMutex_);
+        started_ = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readerRunning_ = true;
+    }
+
+    pool.Submit([self = shared_from_this()] {
+        self->ListSources();
+        self->outFd_ = open(self->partialPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (self->outFd_ < 0) {
+            self->Fail(errno);
+        }
+        self->outBuffer_.reserve(kOutputBufferSize + kDirectWriteSize);
+        self->ReadChunks();
+    });
+}
+
+void ZipWriter::Cancel() {
+    cancelled_.store(true, std::memory_order_release);
+}
+
+ZipProgress ZipWriter::Progress() const {
+    ZipProgress progress;
+    progress.bytesRead = bytesRead_.load(std::memory_order_relaxed);
+    progress.bytesTotal = bytesTotal_.load(std::memory_order_relaxed);
+    progress.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    progress.entriesDone = entriesDone_.load(std::memory_order_relaxed);
+    // entries_ only grows while listing, before any progress is reported
+    progress.entriesTotal = entries_.size();
+    return progress;
+}
+
+void ZipWriter::WaitUntilFinished() {
+    std::unique_lock<std::mutex> lock(finishMutex_);
+    finishCv_.wait(lock, [this] { return !started_ || finished_; });
+}
+
+void ZipWriter::ListSources() {
+    for (const ZipSource& source : sources_) {
+        std::string name = CleanName(source.name.empty() ? BaseName(source.path) : source.name);
+        if (name.empty()) {
+            skipped_.push_back({source.path, EINVAL});
+            continue;
+        }
+        struct stat st;
+        if (stat(source.path.c_str(), &st) != 0) {
+            skipped_.push_back({source.path, errno});
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            ListFolder(source.path, name, 0);
+        } else if (S_ISREG(st.st_mode)) {
+            Entry entry;
+            entry.path = source.path;
+            entry.name = std::move(name);
+            entry.size = static_cast<uint64_t>(st.st_size);
+            entry.mtime = st.st_mtime;
+            entry.mode = st.st_mode;
+            bytesTotal_.fetch_add(entry.size, std::memory_order_relaxed);
+            entries_.push_back(std::move(entry));
+        } else {
+            skipped_.push_back({source.path, ENOTSUP});
+        }
+    }
+}
+
+void ZipWriter::ListFolder(const std::string& path, const std::string& name, int depth) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        skipped_.push_back({path, errno});
+        return;
+    }
+    Entry folder;
+    folder.path = path;
+    folder.name = name + "/";
+    folder.mtime = st.st_mtime;
+    folder.mode = st.st_mode;
+    folder.directory = true;
+    entries_.push_back(std::move(folder));
+
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        skipped_.push_back({path, errno});
+        return;
+    }
+    std::vector<std::string> children;
+    int error = ReadDirectory(fd, [&](const char* child, unsigned char) {
+        children.emplace_back(child);
+        return true;
+    });
+    if (error != 0) {
+        skipped_.push_back({path, error});
+    }
+    // Sorted, so the same folder always gives the same archive
+    std::sort(children.begin(), children.end());
+
+    for (const std::string& child : children) {
+        const std::string childPath = path + "/" + child;
+        const std::string childName = name + "/" + child;
+        if (lstat(childPath.c_str(), &st) != 0) {
+            skipped_.push_back({childPath, errno});
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            if (depth + 1 >= kMaxFolderDepth) {
+                skipped_.push_back({childPath, ELOOP});
+            } else {
+                ListFolder(childPath, childName, depth + 1);
+            }
+            continue;
+        }
+        // Symlinks to files are archived as the file; links to folders are
+        // not followed, which also rules out cycles
+        if (S_ISLNK(st.st_mode) && (stat(childPath.c_str(), &st) != 0 || !S_ISREG(st.st_mode))) {
+            continue;
+        }
+        if (!S_ISREG(st.st_mode)) {
+            continue;
+        }
+        Entry entry;
+        entry.path = childPath;
+        entry.name = childName;
+        entry.size = static_cast<uint64_t>(st.st_size);
+        entry.mtime = st.st_mtime;
+        entry.mode = st.st_mode;
+        bytesTotal_.fetch_add(entry.size, std::memory_order_relaxed);
+        entries_.push_back(std::move(entry));
+    }
+}
+
+void ZipWriter::ReadChunks() {
+    for (;;) {
+        bool finish = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (IsCancelled() || error_.load(std::memory_order_relaxed) != 0) {
+                readDone_ = true;
+            }
+            if (readDone_ || window_.size() >= maxChunksInFlight_) {
+                // The writer restarts the reader when it frees a slot
+                readerRunning_ = false;
+                finish = ShouldFinishLocked();
+                if (!finish) {
+                    return;
+                }
+            }
+        }
+        if (finish) {
+            Finish();
+            return;
+        }
+
+        std::shared_ptr<Chunk> chunk;
+        if (!ReadOneChunk(&chunk)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            readDone_ = true;
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            window_.push_back(chunk);
+        }
+        // An empty chunk of a deflated entry (the file shrank since it was
+        // listed) still goes through Compress: it may be the one that ends
+        // the deflate stream
+        if (chunk->error != 0 || (chunk->dataSize == 0 && chunk->stored)) {
+            ChunkReady(chunk.get());
+        } else {
+            const int level = options_.level;
+            pool_->Submit([self = shared_from_this(), chunk, level] {
+                if (!self->IsCancelled()) {
+                    Compress(*chunk, level);
+                }
+                self->ChunkReady(chunk.get());
+            });
+        }
+    }
+}
+
+bool ZipWriter::ReadOneChunk(std::shared_ptr<Chunk>* result) {
+    while (readEntry_ < entries_.size()) {
+        Entry& entry = entries_[readEntry_];
+        auto chunk = std::make_shared<Chunk>();
+        chunk->entry = readEntry_;
+
+        if (entry.directory) {
+            chunk->first = chunk->last = chunk->stored = true;
+            entry.stored = true;
+            readEntry_++;
+            *result = std::move(chunk);
+            return true;
+        }
+
+        if (readFd_ < 0) {
+            readFd_ = open(entry.path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (readFd_ < 0) {
+                // Nothing of it was written yet, so the archive can go on without it
+                skipped_.push_back({entry.path, errno});
+                entry.skipped = true;
+                bytesTotal_.fetch_sub(entry.size, std::memory_order_relaxed);
+                readEntry_++;
+                continue;
+            }
+#if defined(__linux__)
+            posix_fadvise(readFd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+            readOffset_ = 0;
+            dictionary_.clear();
+            chunk->first = true;
+        }
+
+        const size_t want = static_cast<size_t>(std::min<uint64_t>(options_.chunkSize, entry.size - readOffset_));
+        chunk->dictionarySize = dictionary_.size();
+        chunk->input.resize(dictionary_.size() + want);
+        if (!dictionary_.empty()) {
+            memcpy(chunk->input.data(), dictionary_.data(), dictionary_.size());
+        }
+        size_t got = 0;
+        while (got < want) {
+            ssize_t n = pread(readFd_, chunk->input.data() + chunk->dictionarySize + got, want - got,
+                              static_cast<off_t>(readOffset_ + got));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // Part of the entry may already be written; the archive fails
+                chunk->error = errno;
+                break;
+            }
+            if (n == 0) {
+                break;   // the file shrank since it was listed
+            }
+            got += static_cast<size_t>(n);
+        }
+        chunk->input.resize(chunk->dictionarySize + got);
+        chunk->dataSize = got;
+        readOffset_ += got;
+        bytesRead_.fetch_add(got, std::memory_order_relaxed);
+        chunk->last = chunk->error != 0 || got < want || readOffset_ >= entry.size;
+
+        if (chunk->first) {
+            entry.stored = options_.level == 0 || entry.size == 0 ||
+                           (options_.storeCompressedContent &&
+                            IsCompressedContent(ClassifyContent(chunk->Data(), std::min(got, SNIFF_BYTES))));
+            // Chunks of a longer entry are deflated before any of them is
+            // written, so a sample decides; a single chunk is checked whole
+            // in Compress
+            if (!entry.stored && !chunk->last && !DeflateShrinks(chunk->Data(), std::min(got, kProbeBytes))) {
+                entry.stored = true;
+            }
+        }
+        chunk->stored = entry.stored;
+
+        if (chunk->last) {
+            close(readFd_);
+            readFd_ = -1;
+            readEntry_++;
+        } else if (!entry.stored) {
+            const size_t keep = std::min(kDictionarySize, chunk->input.size());
+            dictionary_.assign(chunk->input.end() - keep, chunk->input.end());
+        }
+        *result = std::move(chunk);
+        return true;
+    }
+    return false;
+}
+
+void ZipWriter::Compress(Chunk& chunk, int level) {
+    const size_t size = chunk.dataSize;
+    chunk.crc = static_cast<uint32_t>(crc32(0, chunk.Data(), static_cast<uInt>(size)));
+    if (chunk.stored) {
+        return;
+    }
+
+    thread_local DeflateStream perThread;
+    if (!perThread.Prepare(level) ||
+        (chunk.dictionarySize > 0 &&
+         deflateSetDictionary(&perThread.stream, chunk.input.data(), static_cast<uInt>(chunk.dictionarySize)) != Z_OK)) {
+        chunk.error = ENOMEM;
+        return;
+    }
+
+    z_stream& stream = perThread.stream;
+    // A sync flush adds an empty stored block (5 bytes) to deflateBound
+    chunk.output.resize(deflateBound(&stream, static_cast<uLong>(size)) + 16);
+    stream.next_in = const_cast<Bytef*>(chunk.Data());
+    stream.avail_in = static_cast<uInt>(size);
+    const int flush = chunk.last ? Z_FINISH : Z_SYNC_FLUSH;
+    for (;;) {
+        stream.next_out = chunk.output.data() + stream.total_out;
+        stream.avail_out = static_cast<uInt>(chunk.output.size() - stream.total_out);
+        int status = deflate(&stream, flush);
+        if (status == Z_STREAM_ERROR) {
+            chunk.error = EIO;
+            return;
+        }
+        if (stream.avail_out > 0 && (flush != Z_FINISH || status == Z_STREAM_END)) {
+            break;
+        }
+        chunk.output.resize(chunk.output.size() * 2);
+    }
+    if (chunk.first && chunk.last && stream.total_out >= size) {
+        // The whole entry did not shrink: write it stored, from the input
+        std::vector<uint8_t>().swap(chunk.output);
+        chunk.stored = true;
+        return;
+    }
+    chunk.output.resize(stream.total_out);
+    // Only the deflated bytes are written; release the input now to keep the window small
+    std::vector<uint8_t>().swap(chunk.input);
+    chunk.dictionarySize = 0;
+}
+
+void ZipWriter::ChunkReady(Chunk* ready) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready->ready = true;
+    if (writing_) {
+        return;   // the current writer picks it up
+    }
+    writing_ = true;
+
+    while (!window_.empty() && window_.front()->ready) {
+        std::shared_ptr<Chunk> chunk = std::move(window_.front());
+        window_.pop_front();
+        const bool restartReader = !readerRunning_ && !readDone_;
+        if (restartReader) {
+            readerRunning_ = true;
+        }
+        lock.unlock();
+
+        if (restartReader) {
+            pool_->Submit([self = shared_from_this()] { self->ReadChunks(); });
+        }
+        if (error_.load(std::memory_order_relaxed) == 0 && !IsCancelled()) {
+            int error = chunk->error != 0 ? chunk->error : WriteChunk(*chunk);
+            if (error != 0) {
+                Fail(error);
+            }
+        }
+        chunk.reset();
+        ReportProgress();
+
+        lock.lock();
+    }
+    writing_ = false;
+    const bool finish = ShouldFinishLocked();
+    lock.unlock();
+    if (finish) {
+        Finish();
+    }
+}
+
+// Called with mutex_ held; true once, for the caller that must run Finish
+bool ZipWriter::ShouldFinishLocked() {
+    if (!readDone_ || readerRunning_ || writing_ || !window_.empty() || finishing_) {
+        return false;
+    }
+    finishing_ = true;
+    return true;
+}
+
+int ZipWriter::WriteChunk(Chunk& chunk) {
+    Entry& entry = entries_[chunk.entry];
+    if (chunk.first) {
+        entry.headerOffset = flushedBytes_ + outBuffer_.size();
+        entry.zip64 = entry.size >= kZip64EntrySize;
+        entry.stored = chunk.stored;
+        int error = WriteLocalHeader(entry);
+        if (error != 0) {
+            return error;
+        }
+    }
+
+    const size_t dataSize = chunk.dataSize;
+    const uint8_t* data = chunk.stored ? chunk.Data() : chunk.output.data();
+    const size_t size = chunk.stored ? dataSize : chunk.output.size();
+    int error = Append(data, size);
+    if (error != 0) {
+        return error;
+    }
+    entry.crc = chunk.first ? chunk.crc
+                            : CrcCombine(entry.crc, chunk.crc, dataSize);
+    entry.uncompressedSize += dataSize;
+    entry.compressedSize += size;
+
+    return chunk.last ? FinishEntry(entry) : 0;
+}
+
+int ZipWriter::WriteLocalHeader(Entry& entry) {
+    const uint32_t dosTime = DosDateTime(entry.mtime);
+    std::vector<uint8_t> header;
+    header.reserve(kLocalHeaderSize + entry.name.size() + 29);
+    Put32(header, kLocalHeaderSignature);
+    Put16(header, entry.zip64 ? 45 : 20);
+    Put16(header, kUtf8Flag);
+    Put16(header, entry.stored ? 0 : Z_DEFLATED);
+    Put16(header, dosTime & 0xFFFF);
+    Put16(header, dosTime >> 16);
+    Put32(header, 0);                                 // crc, patched
+    Put32(header, entry.zip64 ? 0xFFFFFFFF : 0);      // compressed size, patched
+    Put32(header, entry.zip64 ? 0xFFFFFFFF : 0);      // uncompressed size, patched
+    Put16(header, static_cast<uint32_t>(entry.name.size()));
+    Put16(header, (entry.zip64 ? 20 : 0) + 9);
+    header.insert(header.end(), entry.name.begin(), entry.name.end());
+    if (entry.zip64) {
+        Put16(header, kZip64ExtraId);
+        Put16(header, 16);
+        Put64(header, 0);                             // uncompressed size, patched
+        Put64(header, 0);                             // compressed size, patched
+    }
+    Put16(header, kTimestampExtraId);
+    Put16(header, 5);
+    header.push_back(1);                              // mtime present
+    Put32(header, static_cast<uint32_t>(entry.mtime));
+    return Append(header.data(), header.size());
+}
+
+int ZipWriter::FinishEntry(Entry& entry) {
+    if (!entry.zip64 && (entry.compressedSize > kMax32 || entry.uncompressedSize > kMax32)) {
+        return EFBIG;   // the file grew past 4GB after it was listed
+    }
+    uint8_t fields[12];
+    Store32(fields, entry.crc);
+    Store32(fields + 4, entry.zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(entry.compressedSize));
+    Store32(fields + 8, entry.zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(entry.uncompressedSize));
+    int error = Patch(entry.headerOffset + 14, fields, sizeof(fields));
+    if (error == 0 && entry.zip64) {
+        uint8_t sizes[16];
+        Store64(sizes, entry.uncompressedSize);
+        Store64(sizes + 8, entry.compressedSize);
+        error = Patch(entry.headerOffset + kLocalHeaderSize + entry.name.size() + 4, sizes, sizeof(sizes));
+        zip64_ = true;
+    }
+    if (entry.stored && !entry.directory && entry.size > 0 && options_.level > 0) {
+        storedEntries_++;
+    }
+    written_.push_back(static_cast<size_t>(&entry - entries_.data()));
+    entriesDone_.fetch_add(1, std::memory_order_relaxed);
+    return error;
+}
+
+int ZipWriter::WriteCentralDirectory() {
+    const uint64_t start = flushedBytes_ + outBuffer_.size();
+    std::vector<uint8_t> record;
+    for (size_t index : written_) {
+        const Entry& entry = entries_[index];
+        const bool bigSizes = entry.zip64;
+        const bool bigOffset = entry.headerOffset >= kMax32;
+        const uint32_t extraSize = (bigSizes || bigOffset ? 4 + (bigSizes ? 16 : 0) + (bigOffset ? 8 : 0) : 0) + 9;
+        const uint16_t version = bigSizes || bigOffset ? 45 : 20;
+        const uint32_t dosTime = DosDateTime(entry.mtime);
+
+        record.clear();
+        Put32(record, kCentralHeaderSignature);
+        Put16(record, kMadeByUnix | version);
+        Put16(record, version);
+        Put16(record, kUtf8Flag);
+        Put16(record, entry.stored ? 0 : Z_DEFLATED);
+        Put16(record, dosTime & 0xFFFF);
+        Put16(record, dosTime >> 16);
+        Put32(record, entry.crc);
+        Put32(record, bigSizes ? 0xFFFFFFFF : static_cast<uint32_t>(entry.compressedSize));
+        Put32(record, bigSizes ? 0xFFFFFFFF : static_cast<uint32_t>(entry.uncompressedSize));
+        Put16(record, static_cast<uint32_t>(entry.name.size()));
+        Put16(record, extraSize);
+        Put16(record, 0);                             // comment length
+        Put16(record, 0);                             // disk number
+        Put16(record, 0);                             // internal attributes
+        Put32(record, ((entry.mode & 0xFFFF) << 16) | (entry.directory ? 0x10 : 0));
+        Put32(record, bigOffset ? 0xFFFFFFFF : static_cast<uint32_t>(entry.headerOffset));
+        record.insert(record.end(), entry.name.begin(), entry.name.end());
+        if (bigSizes || bigOffset) {
+            Put16(record, kZip64ExtraId);
+            Put16(record, (bigSizes ? 16 : 0) + (bigOffset ? 8 : 0));
+            if (bigSizes) {
+                Put64(record, entry.uncompressedSize);
+                Put64(record, entry.compressedSize);
+            }
+            if (bigOffset) {
+                Put64(record, entry.headerOffset);
+            }
+            zip64_ = true;
+        }
+        Put16(record, kTimestampExtraId);
+        Put16(record, 5);
+        record.push_back(1);
+        Put32(record, static_cast<uint32_t>(entry.mtime));
+        int error = Append(record.data(), record.size());
+        if (error != 0) {
+            return error;
+        }
+    }
+
+    const uint64_t end = flushedBytes_ + outBuffer_.size();
+    const uint64_t count = written_.size();
+    const uint64_t size = end - start;
+    record.clear();
+    if (count >= 0xFFFF || size >= kMax32 || start >= kMax32) {
+        zip64_ = true;
+        Put32(record, kZip64EndSignature);
+        Put64(record, 44);                            // size of the rest of this record
+        Put16(record, kMadeByUnix | 45);
+        Put16(record, 45);
+        Put32(record, 0);                             // this disk
+        Put32(record, 0);                             // disk with the central directory
+        Put64(record, count);
+        Put64(record, count);
+        Put64(record, size);
+        Put64(record, start);
+        Put32(record, kZip64LocatorSignature);
+        Put32(record, 0);
+        Put64(record, end);                           // offset of the ZIP64 end record
+        Put32(record, 1);                             // total disks
+    }
+    Put32(record, kEndSignature);
+    Put16(record, 0);
+    Put16(record, 0);
+    Put16(record, static_cast<uint32_t>(std::min<uint64_t>(count, 0xFFFF)));
+    Put16(record, static_cast<uint32_t>(std::min<uint64_t>(count, 0xFFFF)));
+    Put32(record, static_cast<uint32_t>(std::min<uint64_t>(size, kMax32)));
+    Put32(record, static_cast<uint32_t>(std::min<uint64_t>(start, kMax32)));
+    Put16(record, 0);                                 // comment length
+    return Append(record.data(), record.size());
+}
+
+int ZipWriter::Append(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    if (size >= kDirectWriteSize) {
+        int error = Flush();
+        if (error == 0) {
+            error = WriteAll(outFd_, bytes, size);
+        }
+        if (error == 0) {
+            flushedBytes_ += size;
+            bytesWritten_.store(flushedBytes_, std::memory_order_relaxed);
+        }
+        return error;
+    }
+    outBuffer_.insert(outBuffer_.end(), bytes, bytes + size);
+    return outBuffer_.size() >= kOutputBufferSize ? Flush() : 0;
+}
+
+int ZipWriter::Flush() {
+    if (outBuffer_.empty()) {
+        return 0;
+    }
+    int error = WriteAll(outFd_, outBuffer_.data(), outBuffer_.size());
+    if (error == 0) {
+        flushedBytes_ += outBuffer_.size();
+        bytesWritten_.store(flushedBytes_, std::memory_order_relaxed);
+        outBuffer_.clear();
+    }
+    return error;
+}
+
+// Headers are appended whole, so a patch is either still buffered or already written
+int ZipWriter::Patch(uint64_t offset, const void* data, size_t size) {
+    if (offset >= flushedBytes_) {
+        memcpy(outBuffer_.data() + (offset - flushedBytes_), data, size);
+        return 0;
+    }
+    ssize_t written = pwrite(outFd_, data, size, static_cast<off_t>(offset));
+    return written == static_cast<ssize_t>(size) ? 0 : (written < 0 ? errno : EIO);
+}
+
+void ZipWriter::Fail(int error) {
+    int expected = 0;
+    error_.compare_exchange_strong(expected, error, std::memory_order_relaxed);
+}
+
+void ZipWriter::ReportProgress() {
+    if (!onProgress_) {
+        return;
+    }
+    const int64_t now = NowNs();
+    int64_t last = lastProgressNs_.load(std::memory_order_relaxed);
+    const int64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(options_.progressInterval).count();
+    if (now - last >= interval && lastProgressNs_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        onProgress_();
+    }
+}
+
+void ZipWriter::Finish() {
+    int error = error_.load(std::memory_order_relaxed);
+    const bool cancelled = IsCancelled();
+    if (error == 0 && !cancelled) {
+        error = WriteCentralDirectory();
+        if (error == 0) {
+            error = Flush();
+        }
+    }
+    if (readFd_ >= 0) {
+        close(readFd_);
+        readFd_ = -1;
+    }
+    if (outFd_ >= 0) {
+        if (close(outFd_) != 0 && error == 0) {
+            error = errno;
+        }
+        outFd_ = -1;
+    }
+    if (error == 0 && !cancelled && rename(partialPath_.c_str(), outputPath_.c_str()) != 0) {
+        error = errno;
+    }
+    if (error != 0 || cancelled) {
+        unlink(partialPath_.c_str());
+    }
+
+    ZipSummary summary;
+    summary.error = error;
+    summary.cancelled = cancelled;
+    summary.entries = written_.size();
+    summary.storedEntries = storedEntries_;
+    summary.bytesIn = bytesRead_.load(std::memory_order_relaxed);
+    summary.bytesOut = flushedBytes_;
+    summary.zip64 = zip64_;
+    summary.skipped = std::move(skipped_);
+    summary.durationMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime_).count();
+    if (onDone_) {
+        onDone_(summary);
+    }
+
+    std::lock_guard<std::mutex> lock(finishMutex_);
+    finished_ = true;
+    finishCv_.notify_all();
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,227 @@
+/**
+ * @file zip_writer.h
+ * @brief Streaming ZIP64 archive writer with parallel deflate
+ *
+ * Files are read in order, in chunks of ZipOptions::chunkSize, and every
+ * chunk is compressed as its own pool task, the way pigz does: each chunk
+ * is a raw deflate stream primed with the previous chunk's last 32KB as
+ * its dictionary, ended with a sync flush on a byte boundary, and only an
+ * entry's last chunk ends with a final block. The concatenation is one
+ * valid deflate stream. Chunk CRCs are combined in GF(2), as crc32_combine does. The
+ * compression ratio is within a fraction of a percent of single-threaded
+ * zlib at the same level.
+ *
+ * The deflate is plain zlib. libdeflate only compresses whole buffers, with
+ * no preset dictionary and no sync flush, so its chunks could not be
+ * chained into one stream without losing the 32KB of history. zlib-ng in
+ * compat mode keeps zlib's API and can be linked in its place.
+ *
+ * Compressed chunks are written strictly in order as they complete. At
+ * most maxChunksInFlight chunks are read ahead, so memory stays bounded
+ * whatever the size of the shelf. Files whose content is already compressed
+ * (JPEG, PNG, HEIC, MP4, ZIP, DOCX, ...; detected by content_sniffer from
+ * the first chunk) are stored, which costs only the CRC. So is data that
+ * deflate does not shrink: a single-chunk entry when its deflated chunk is
+ * no smaller, a longer one when a level 1 deflate of its first 64KB is not.
+ *
+ * The archive is written to "<output>.fcpart", and each local header is
+ * patched with its sizes and CRC once the entry is complete (no data
+ * descriptors, which some readers reject for stored entries). ZIP64
+ * fields are used only where needed: entries of 4GB or more, more than
+ * 65535 entries, or offsets past 4GB. When the archive is done it is
+ * renamed to the output path.
+ *
+ * Nothing blocks a pool thread. Reading, compressing and writing are
+ * short tasks, and the reader stops when the window is full until the
+ * writer frees a slot.
+ */
+
+#ifndef FILE_OPS_ZIP_WRITER_H
+#define FILE_OPS_ZIP_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "content_sniffer.h"
+#include "work_stealing_pool.h"
+
+namespace FileCataloger {
+
+struct ZipSource {
+    std::string path;
+    // Name inside the archive, '/'-separated; a folder's files go below it
+    std::string name;
+};
+
+struct ZipOptions {
+    int level = 6;                  // zlib level; 0 stores everything
+    size_t chunkSize = 1 << 20;
+    size_t maxChunksInFlight = 0;   // 0: twice the pool's threads, plus 2
+    bool storeCompressedContent = true;
+    std::chrono::milliseconds progressInterval{50};
+};
+
+struct ZipProgress {
+    uint64_t bytesRead = 0;
+    uint64_t bytesTotal = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t entriesDone = 0;
+    uint64_t entriesTotal = 0;
+};
+
+struct ZipEntryError {
+    std::string path;
+    int code;
+};
+
+struct ZipSummary {
+    int error = 0;                  // 0, or the errno that stopped the archive
+    uint64_t entries = 0;
+    uint64_t storedEntries = 0;     // files stored: compressed content, or data deflate does not shrink
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;          // archive size
+    bool zip64 = false;
+    bool cancelled = false;
+    double durationMs = 0;
+    std::vector<ZipEntryError> skipped;   // files that could not be opened or listed
+};
+
+// True for content that deflate cannot shrink (images, audio/video,
+// archives, zip-based documents)
+bool IsCompressedContent(ContentType type);
+
+// MS-DOS date (high 16 bits) and time (low 16 bits) of a Unix time, in local time
+uint32_t DosDateTime(int64_t unixSeconds);
+
+class ZipWriter : public std::enable_shared_from_this<ZipWriter> {
+public:
+    using ProgressSink = std::function<void()>;
+    using DoneSink = std::function<void(const ZipSummary&)>;
+
+    static std::shared_ptr<ZipWriter> Create(std::vector<ZipSource> sources,
+                                             std::string outputPath,
+                                             ZipOptions options,
+                                             ProgressSink onProgress,
+                                             DoneSink onDone);
+
+    ~ZipWriter();
+
+    ZipWriter(const ZipWriter&) = delete;
+    ZipWriter& operator=(const ZipWriter&) = delete;
+
+    // Lists the sources and starts writing; the done sink runs exactly once
+    void Start(WorkStealingPool& pool);
+
+    // Stops reading; chunks in flight are dropped and the partial archive removed
+    void Cancel();
+    bool IsCancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+    ZipProgress Progress() const;
+
+    // Blocks until the done sink has returned (immediately if never started)
+    void WaitUntilFinished();
+
+private:
+    ZipWriter(std::vector<ZipSource> sources, std::string outputPath, ZipOptions options,
+              ProgressSink onProgress, DoneSink onDone);
+
+    struct Entry {
+        std::string path;
+        std::string name;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint32_t mode = 0;
+        bool directory = false;
+        bool skipped = false;       // could not be opened; not in the archive
+        // Set while writing
+        bool stored = false;
+        bool zip64 = false;
+        uint32_t crc = 0;
+        uint64_t compressedSize = 0;
+        uint64_t uncompressedSize = 0;
+        uint64_t headerOffset = 0;
+    };
+
+    struct Chunk;
+
+    void ListSources();
+    void ListFolder(const std::string& path, const std::string& name, int depth);
+    void ReadChunks();
+    bool ReadOneChunk(std::shared_ptr<Chunk>* chunk);
+    static void Compress(Chunk& chunk, int level);
+    void ChunkReady(Chunk* ready);
+    bool ShouldFinishLocked();
+    int WriteChunk(Chunk& chunk);
+    int WriteLocalHeader(Entry& entry);
+    int FinishEntry(Entry& entry);
+    int WriteCentralDirectory();
+    int Append(const void* data, size_t size);
+    int Flush();
+    int Patch(uint64_t offset, const void* data, size_t size);
+    void Fail(int error);
+    void ReportProgress();
+    void Finish();
+
+    std::vector<ZipSource> sources_;
+    std::string outputPath_;
+    std::string partialPath_;
+    ZipOptions options_;
+    ProgressSink onProgress_;
+    DoneSink onDone_;
+
+    WorkStealingPool* pool_ = nullptr;
+    std::chrono::steady_clock::time_point startTime_;
+    std::atomic<bool> cancelled_{false};
+    std::atomic<int> error_{0};
+
+    std::vector<Entry> entries_;
+    std::vector<ZipEntryError> skipped_;
+    std::vector<size_t> written_;       // entries_ indices in archive order
+    size_t maxChunksInFlight_ = 0;
+
+    // Reader state, touched only by the one reader task at a time
+    size_t readEntry_ = 0;
+    int readFd_ = -1;
+    uint64_t readOffset_ = 0;
+    std::vector<uint8_t> dictionary_;   // last 32KB of the previous chunk of this entry
+    uint64_t nextSequence_ = 0;
+
+    // Window of chunks in sequence order, guarded by mutex_
+    std::mutex mutex_;
+    std::deque<std::shared_ptr<Chunk>> window_;
+    bool readerRunning_ = false;
+    bool readDone_ = false;
+    bool writing_ = false;
+    bool finishing_ = false;
+
+    // Output, touched only by the one writer at a time
+    int outFd_ = -1;
+    std::vector<uint8_t> outBuffer_;
+    uint64_t flushedBytes_ = 0;
+    uint64_t storedEntries_ = 0;
+    bool zip64_ = false;
+
+    std::atomic<uint64_t> bytesRead_{0};
+    std::atomic<uint64_t> bytesTotal_{0};
+    std::atomic<uint64_t> bytesWritten_{0};
+    std::atomic<uint64_t> entriesDone_{0};
+    std::atomic<int64_t> lastProgressNs_{0};
+
+    mutable std::mutex finishMutex_;
+    std::condition_variable finishCv_;
+    bool started_ = false;
+    bool finished_ = false;
+};
+
+} // namespace FileCataloger
+
+#endif // FILE_OPS_ZIP_WRITER_H
@@ -0,0 +1,108 @@
+/**
+ * @fileoverview Capture date, camera and duration of photos and videos
+ *
+ * Reads EXIF (JPEG, TIFF and raw files, HEIC), PNG text chunks and the
+ * ISO-BMFF movie header (MP4, MOV) from the few pages of each file that hold
+ * them, on the native worker pool. Results are cached natively by inode and
+ * modification time, so previewing the same rename twice reads each file
+ * once.
+ *
+ * Usage:
+ * ```typescript
+ * const [photo] = await extractMediaMetadata(['/Users/me/IMG_0001.HEIC']);
+ * if (photo?.captureTime) rename(new Date(photo.captureTime));
+ * ```
+ *
+ * Without the native module (e.g. Windows) every entry is null and callers
+ * fall back to file timestamps.
+ *
+ * @module file-ops
+ */
+
+import { CancellationOptions, nativeCancellation, NativeCancellationToken } from './cancellation';
+import { loadFileOpsModule } from './nativeModule';
+
+/** Bits of the fields column; mirrors MediaField in src/internal/media_metadata.h */
+enum MediaField {
+  CaptureTime = 1 << 0,
+  Camera = 1 << 1,
+  Duration = 1 << 2,
+  Dimensions = 1 << 3,
+}
+
+export interface MediaMetadata {
+  /** When the photo or video was taken, ms since the epoch */
+  captureTime?: number;
+  cameraMake?: string;
+  cameraModel?: string;
+  /** Length of a video or audio file in ms */
+  duration?: number;
+  width?: number;
+  height?: number;
+}
+
+interface NativeMediaColumns {
+  fields: Uint8Array;
+  captureTimes: Float64Array;
+  durations: Float64Array;
+  widths: Uint32Array;
+  heights: Uint32Array;
+  makes: string[];
+  models: string[];
+}
+
+interface NativeMediaModule {
+  extractMediaMetadata(
+    paths: string[],
+    callback: (columns: NativeMediaColumns) => void,
+    cancellation?: NativeCancellationToken
+  ): void;
+}
+
+const nativeModule = loadFileOpsModule<NativeMediaModule>();
+
+export function isNativeMediaMetadataAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+function toMediaMetadata(columns: NativeMediaColumns, index: number): MediaMetadata | null {
+  const fields = columns.fields[index];
+  if (!fields) return null;
+  const metadata: MediaMetadata = {};
+  if (fields & MediaField.CaptureTime) metadata.captureTime = columns.captureTimes[index];
+  if (fields & MediaField.Camera) {
+    if (columns.makes[index]) metadata.cameraMake = columns.makes[index];
+    if (columns.models[index]) metadata.cameraModel = columns.models[index];
+  }
+  if (fields & MediaField.Duration) metadata.duration = columns.durations[index];
+  if (fields & MediaField.Dimensions) {
+    metadata.width = columns.widths[index];
+    metadata.height = columns.heights[index];
+  }
+  return metadata;
+}
+
+/**
+ * Read media metadata from file headers. Resolves to one entry per path, in
+ * order; null for files without any (documents, unreadable files) and for
+ * files not reached before options.signal aborted or the deadline passed.
+ */
+export function extractMediaMetadata(
+  paths: string[],
+  options: CancellationOptions = {}
+): Promise<Array<MediaMetadata | null>> {
+  if (!nativeModule || paths.length === 0) {
+    return Promise.resolve(paths.map(() => null));
+  }
+  const cancellation = nativeCancellation(options);
+  return new Promise(resolve =>
+    nativeModule.extractMediaMetadata(
+      paths,
+      columns => {
+        cancellation.release();
+        resolve(paths.map((_, index) => toMediaMetadata(columns, index)));
+      },
+      cancellation.token
+    )
+  );
+}
@@ -0,0 +1,2847 @@
+/**
+ * @file file_ops.cc
+ * @brief N-API bindings for native file operations
+ *
+ * Exposes, on a process-wide WorkStealingPool:
+ *
+ * - NativeDirectoryWalker, which expands dropped folders with the parallel
+ *   DirectoryWalker (src/internal/directory_walker.h). Batches are delivered
+ *   to JS through a BatchedDispatcher, so a walk that yields thousands of
+ *   batches still costs only one JS call per drain.
+ *
+ *   JS callback contract:
+ *     callback(batches: Batch[], summary?: Summary)
+ *   Every call carries zero or more batches; the final call carries the
+ *   summary and no further calls follow it.
+ *
+ * - NativeFolderSizeService, which measures folder sizes incrementally
+ *   against a persistent FolderSizeCache (src/internal/folder_size.h).
+ *   estimate() answers synchronously from the cache; measure() calls its
+ *   callback exactly once with the exact result.
+ *
+ * - NativeFileTransfer, which copies or moves files and folders with the
+ *   cheapest method each pair of filesystems allows (src/internal/file_transfer.h).
+ *
+ *   JS callback contract:
+ *     callback(results: Results, progress: Progress, summary?: Summary)
+ *   results holds the items finished since the previous call as parallel
+ *   typed arrays (indices, methods, errnos, bytes), possibly empty; the
+ *   final call carries the summary.
+ *
+ * - NativeZipWriter, which writes files and folders into a ZIP archive,
+ *   compressing chunks on every pool thread (src/internal/zip_writer.h).
+ *
+ *   JS callback contract:
+ *     callback(progress: Progress, summary?: Summary)
+ *   Progress ticks are coalesced; the final call carries the summary.
+ *
+ * - sniffContentTypes(paths, callback), which classifies files by their
+ *   first bytes (src/internal/content_sniffer.h). The callback is called
+ *   once with a Uint8Array of ContentType codes, in path order.
+ *
+ * - extractMediaMetadata(paths, callback), which reads capture time, camera
+ *   and duration from photo and video headers (src/internal/media_metadata.h).
+ *   The callback is called once with columns in path order: fields
+ *   (Uint8Array of MediaField bits), captureTimes and durations
+ *   (Float64Array, ms), widths and heights (Uint32Array), makes and models
+ *   (string arrays). Results are cached by inode and mtime across calls.
+ *
+ * - statFileList(paths), which stats every path and encodes the list as
+ *   one file-list payload (common/file_list_payload.h). It returns a
+ *   Promise for an ArrayBuffer, read in JS by FileListView
+ *   (src/shared/fileListPayload.ts).
+ *
+ * - statFileListChunks(paths, chunkSize), an async iterator of the same
+ *   payloads for chunkSize paths each, so a long list can be shown as it
+ *   arrives. Each chunk is stat'ed when next() asks for it; breaking out
+ *   of for await stops the work.
+ *
+ * - renamePaths(from, to) and unlinkPaths(paths), bulk renames and unlinks
+ *   in chunks on the pool (src/internal/path_ops.h). Each returns a Promise
+ *   for an Int32Array of errnos, 0 where the path succeeded, in path order.
+ *   getIoEngine() names the engine doing bulk I/O (src/internal/io_engine.h):
+ *   'io_uring' where the kernel allows it, otherwise 'syscalls'.
+ *
+ * - NativeSessionStore, the shelf session snapshot and its delta log
+ *   (src/internal/session_store.h). get, keys, put and delete are
+ *   synchronous; values are Uint8Arrays the caller encodes. Once the log
+ *   has grown, a put schedules compaction on the pool.
+ *
+ * - NativeShelfStore(payload?), one shelf's items in columns
+ *   (src/internal/shelf_store.h). insertFileList takes a file-list payload
+ *   straight from a drag and returns the new ids as a Float64Array; insert,
+ *   remove, find, get, ids and clear are synchronous. serialize() returns
+ *   the whole shelf as one ArrayBuffer, read in JS by ShelfItemsView
+ *   (src/shared/shelfItemsPayload.ts) and by the constructor.
+ *
+ * - NativeCancellationToken(deadlineMs?), passed as the cancellation option
+ *   of walks, folder sizes and transfers, or as the last argument of
+ *   sniffContentTypes, extractMediaMetadata, statFileList,
+ *   statFileListChunks, renamePaths and unlinkPaths (common/cancellation_token.h). cancel() stops every
+ *   job holding it within one chunk of work; after deadlineMs jobs stop
+ *   the same way but keep what they have. reason() is 'none', 'cancelled'
+ *   or 'deadline'.
+ *
+ * statFileList, statFileListChunks, renamePaths and unlinkPaths are
+ * coroutines (common/native_task.h) bridged to JS by common/promise_task.h;
+ * the rest still use callbacks.
+ *
+ * Thread safety:
+ * - Pool tasks only push into a dispatcher or threadsafe function
+ * - All methods and JS conversions run on the JS thread
+ * - A dispatcher or threadsafe function is released only after its
+ *   producer has finished, so no pool thread calls into a released one
+ *
+ * @author FileCataloger Team
+ * @date 2025
+ */
+
+#include <node_api.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "content_sniffer.h"
+#include "directory_walker.h"
+#include "error_codes.h"
+#include "file_list_stat.h"
+#include "file_transfer.h"
+#include "folder_size.h"
+#include "io_engine.h"
+#include "media_metadata.h"
+#include "napi_smart_ptr.h"
+#include "native_task.h"
+#include "path_ops.h"
+#include "promise_task.h"
+#include "session_store.h"
+#include "shelf_store.h"
+#include "work_stealing_pool.h"
+#include "zip_writer.h"
+
+using FileCataloger::DirectoryWalker;
+using FileCataloger::AsyncGenerator;
+using FileCataloger::CancellationSource;
+using FileCataloger::CancellationToken;
+using FileCataloger::CancelReason;
+using FileCataloger::Completion;
+using FileCataloger::FileListBatch;
+using FileCataloger::FileTransfer;
+using FileCataloger::SniffBatch;
+using FileCataloger::Task;
+using FileCataloger::FolderSize;
+using FileCataloger::FolderSizeCache;
+using FileCataloger::FolderSizeOptions;
+using FileCataloger::FolderSizeResult;
+using FileCataloger::FolderSizeScanner;
+using FileCataloger::IoEngineName;
+using FileCataloger::DefaultIoEngine;
+using FileCataloger::MediaMetadataBatch;
+using FileCataloger::MediaMetadataExtractor;
+using FileCataloger::PathOp;
+using FileCataloger::PathOpBatch;
+using FileCataloger::SessionStore;
+using FileCataloger::SessionStoreStats;
+using FileCataloger::ShelfItem;
+using FileCataloger::ShelfItemId;
+using FileCataloger::ShelfItemKind;
+using FileCataloger::ShelfItemRecord;
+using FileCataloger::ShelfStore;
+using FileCataloger::ShelfStoreStats;
+using FileCataloger::TransferItem;
+using FileCataloger::TransferMode;
+using FileCataloger::TransferOptions;
+using FileCataloger::TransferProgress;
+using FileCataloger::TransferResult;
+using FileCataloger::TransferSummary;
+using FileCataloger::WalkBatch;
+using FileCataloger::WalkOptions;
+using FileCataloger::WalkSummary;
+using FileCataloger::WorkStealingPool;
+using FileCataloger::ZipOptions;
+using FileCataloger::ZipProgress;
+using FileCataloger::ZipSource;
+using FileCataloger::ZipSummary;
+using FileCataloger::ZipWriter;
+
+namespace {
+
+// Shared by every operation in the process; threads are created on first use
+WorkStealingPool& SharedPool() {
+    static WorkStealingPool pool;
+    return pool;
+}
+
+// Process-wide so that renaming the same shelf twice reads each file once.
+// Never destroyed: pool tasks may still be using it at exit.
+MediaMetadataExtractor& SharedMediaMetadataExtractor() {
+    static MediaMetadataExtractor* extractor = new MediaMetadataExtractor();
+    return *extractor;
+}
+
+struct WalkEvent {
+    std::unique_ptr<WalkBatch> batch;     // entry batch, or
+    std::unique_ptr<WalkSummary> summary; // the final summary
+};
+
+using WalkEventDispatcher = FileCataloger::BatchedDispatcher<WalkEvent>;
+
+napi_value CreateUint32Array(napi_env env, const std::vector<uint32_t>& values) {
+    void* data = nullptr;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, values.size() * sizeof(uint32_t), &data, &buffer);
+    if (!values.empty()) {
+        memcpy(data, values.data(), values.size() * sizeof(uint32_t));
+    }
+    napi_create_typedarray(env, napi_uint32_array, values.size(), buffer, 0, &array);
+    return array;
+}
+
+napi_value CreateUint8Array(napi_env env, const std::vector<uint8_t>& values) {
+    void* data = nullptr;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, values.size(), &data, &buffer);
+    if (!values.empty()) {
+        memcpy(data, values.data(), values.size());
+    }
+    napi_create_typedarray(env, napi_uint8_array, values.size(), buffer, 0, &array);
+    return array;
+}
+
+napi_value CreateFloat64Array(napi_env env, const std::vector<double>& values) {
+    void* data = nullptr;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, values.size() * sizeof(double), &data, &buffer);
+    if (!values.empty()) {
+        memcpy(data, values.data(), values.size() * sizeof(double));
+    }
+    napi_create_typedarray(env, napi_float64_array, values.size(), buffer, 0, &array);
+    return array;
+}
+
+void SetNumber(napi_env env, napi_value object, const char* name, double value) {
+    napi_value number;
+    napi_create_double(env, value, &number);
+    napi_set_named_property(env, object, name, number);
+}
+
+napi_value BatchToJs(napi_env env, const WalkBatch& batch) {
+    napi_value batch_obj;
+    napi_create_object(env, &batch_obj);
+
+    napi_value directories;
+    napi_create_array_with_length(env, batch.directories.size(), &directories);
+    for (size_t i = 0; i < batch.directories.size(); i++) {
+        napi_value dir;
+        napi_create_string_utf8(env, batch.directories[i].data(), batch.directories[i].size(), &dir);
+        napi_set_element(env, directories, static_cast<uint32_t>(i), dir);
+    }
+    napi_set_named_property(env, batch_obj, "directories", directories);
+    napi_set_named_property(env, batch_obj, "directoryDepths", CreateUint32Array(env, batch.directoryDepths));
+    napi_set_named_property(env, batch_obj, "directoryIndex", CreateUint32Array(env, batch.directoryIndex));
+
+    napi_value names;
+    napi_create_array_with_length(env, batch.size(), &names);
+    for (size_t i = 0; i < batch.size(); i++) {
+        std::string_view name = batch.name(i);
+        napi_value name_val;
+        napi_create_string_utf8(env, name.data(), name.size(), &name_val);
+        napi_set_element(env, names, static_cast<uint32_t>(i), name_val);
+    }
+    napi_set_named_property(env, batch_obj, "names", names);
+    napi_set_named_property(env, batch_obj, "types", CreateUint8Array(env, batch.types));
+    napi_set_named_property(env, batch_obj, "sizes", CreateFloat64Array(env, batch.sizes));
+    napi_set_named_property(env, batch_obj, "mtimes", CreateFloat64Array(env, batch.mtimesMs));
+
+    return batch_obj;
+}
+
+napi_value SummaryToJs(napi_env env, const WalkSummary& summary) {
+    napi_value summary_obj;
+    napi_create_object(env, &summary_obj);
+
+    SetNumber(env, summary_obj, "entries", static_cast<double>(summary.entries));
+    SetNumber(env, summary_obj, "directoriesRead", static_cast<double>(summary.directoriesRead));
+    SetNumber(env, summary_obj, "errorCount", static_cast<double>(summary.errorCount));
+    SetNumber(env, summary_obj, "durationMs", summary.durationMs);
+
+    napi_value cancelled, timed_out;
+    napi_get_boolean(env, summary.cancelled, &cancelled);
+    napi_set_named_property(env, summary_obj, "cancelled", cancelled);
+    napi_get_boolean(env, summary.timedOut, &timed_out);
+    napi_set_named_property(env, summary_obj, "timedOut", timed_out);
+
+    napi_value errors;
+    napi_create_array_with_length(env, summary.errors.size(), &errors);
+    for (size_t i = 0; i < summary.errors.size(); i++) {
+        const auto& error = summary.errors[i];
+        napi_value error_obj, path, message;
+        napi_create_object(env, &error_obj);
+        napi_create_string_utf8(env, error.path.c_str(), error.path.size(), &path);
+        napi_set_named_property(env, error_obj, "path", path);
+        SetNumber(env, error_obj, "errno", error.code);
+        napi_create_string_utf8(env, strerror(error.code), NAPI_AUTO_LENGTH, &message);
+        napi_set_named_property(env, error_obj, "message", message);
+        napi_set_element(env, errors, static_cast<uint32_t>(i), error_obj);
+    }
+    napi_set_named_property(env, summary_obj, "errors", errors);
+
+    return summary_obj;
+}
+
+void ThrowFileOpsError(napi_env env, FileCataloger::ErrorCode code, const std::string& message, int sys_errno) {
+    napi_value msg_val, error, code_val;
+    napi_create_string_utf8(env, message.c_str(), message.size(), &msg_val);
+    napi_create_error(env, nullptr, msg_val, &error);
+    napi_create_int32(env, static_cast<int>(code), &code_val);
+    napi_set_named_property(env, error, "code", code_val);
+    if (sys_errno != 0) {
+        SetNumber(env, error, "errno", sys_errno);
+    }
+    napi_throw(env, error);
+}
+
+struct TransferEvent {
+    bool hasResult = false;                 // an item result, or
+    TransferResult result{};
+    std::unique_ptr<TransferSummary> summary; // the final summary; neither: a progress tick
+};
+
+using TransferEventDispatcher = FileCataloger::BatchedDispatcher<TransferEvent>;
+
+napi_value CreateInt32Array(napi_env env, const std::vector<int32_t>& values) {
+    void* data = nullptr;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, values.size() * sizeof(int32_t), &data, &buffer);
+    if (!values.empty()) {
+        memcpy(data, values.data(), values.size() * sizeof(int32_t));
+    }
+    napi_create_typedarray(env, napi_int32_array, values.size(), buffer, 0, &array);
+    return array;
+}
+
+napi_value TransferProgressToJs(napi_env env, const TransferProgress& progress) {
+    napi_value progress_obj;
+    napi_create_object(env, &progress_obj);
+    SetNumber(env, progress_obj, "bytesDone", static_cast<double>(progress.bytesDone));
+    SetNumber(env, progress_obj, "bytesFound", static_cast<double>(progress.bytesFound));
+    SetNumber(env, progress_obj, "filesDone", static_cast<double>(progress.filesDone));
+    SetNumber(env, progress_obj, "filesFound", static_cast<double>(progress.filesFound));
+    SetNumber(env, progress_obj, "itemsDone", static_cast<double>(progress.itemsDone));
+    return progress_obj;
+}
+
+const char* const kTransferMethodNames[] = {"none", "rename", "clone", "copyFileRange", "sendfile", "readWrite"};
+
+napi_value TransferSummaryToJs(napi_env env, const TransferSummary& summary) {
+    napi_value summary_obj;
+    napi_create_object(env, &summary_obj);
+    SetNumber(env, summary_obj, "items", static_cast<double>(summary.items));
+    SetNumber(env, summary_obj, "failed", static_cast<double>(summary.failed));
+    SetNumber(env, summary_obj, "files", static_cast<double>(summary.files));
+    SetNumber(env, summary_obj, "bytes", static_cast<double>(summary.bytes));
+    SetNumber(env, summary_obj, "durationMs", summary.durationMs);
+
+    napi_value methods;
+    napi_create_object(env, &methods);
+    for (size_t i = 1; i < 6; i++) {
+        SetNumber(env, methods, kTransferMethodNames[i], static_cast<double>(summary.methodCounts[i]));
+    }
+    napi_set_named_property(env, summary_obj, "methods", methods);
+
+    napi_value cancelled, timed_out;
+    napi_get_boolean(env, summary.cancelled, &cancelled);
+    napi_set_named_property(env, summary_obj, "cancelled", cancelled);
+    napi_get_boolean(env, summary.timedOut, &timed_out);
+    napi_set_named_property(env, summary_obj, "timedOut", timed_out);
+    return summary_obj;
+}
+
+struct ZipEvent {
+    std::unique_ptr<ZipSummary> summary;    // the final summary, or null for a progress tick
+};
+
+using ZipEventDispatcher = FileCataloger::BatchedDispatcher<ZipEvent>;
+
+napi_value ZipProgressToJs(napi_env env, const ZipProgress& progress) {
+    napi_value progress_obj;
+    napi_create_object(env, &progress_obj);
+    SetNumber(env, progress_obj, "bytesRead", static_cast<double>(progress.bytesRead));
+    SetNumber(env, progress_obj, "bytesTotal", static_cast<double>(progress.bytesTotal));
+    SetNumber(env, progress_obj, "bytesWritten", static_cast<double>(progress.bytesWritten));
+    SetNumber(env, progress_obj, "entriesDone", static_cast<double>(progress.entriesDone));
+    SetNumber(env, progress_obj, "entriesTotal", static_cast<double>(progress.entriesTotal));
+    return progress_obj;
+}
+
+napi_value ZipSummaryToJs(napi_env env, const ZipSummary& summary) {
+    napi_value summary_obj;
+    napi_create_object(env, &summary_obj);
+    SetNumber(env, summary_obj, "errno", summary.error);
+    SetNumber(env, summary_obj, "entries", static_cast<double>(summary.entries));
+    SetNumber(env, summary_obj, "storedEntries", static_cast<double>(summary.storedEntries));
+    SetNumber(env, summary_obj, "bytesIn", static_cast<double>(summary.bytesIn));
+    SetNumber(env, summary_obj, "bytesOut", static_cast<double>(summary.bytesOut));
+    SetNumber(env, summary_obj, "durationMs", summary.durationMs);
+
+    napi_value zip64, cancelled;
+    napi_get_boolean(env, summary.zip64, &zip64);
+    napi_set_named_property(env, summary_obj, "zip64", zip64);
+    napi_get_boolean(env, summary.cancelled, &cancelled);
+    napi_set_named_property(env, summary_obj, "cancelled", cancelled);
+
+    napi_value skipped;
+    napi_create_array_with_length(env, summary.skipped.size(), &skipped);
+    for (size_t i = 0; i < summary.skipped.size(); i++) {
+        napi_value entry, path;
+        napi_create_object(env, &entry);
+        napi_create_string_utf8(env, summary.skipped[i].path.c_str(), summary.skipped[i].path.size(), &path);
+        napi_set_named_property(env, entry, "path", path);
+        SetNumber(env, entry, "errno", summary.skipped[i].code);
+        napi_set_element(env, skipped, static_cast<uint32_t>(i), entry);
+    }
+    napi_set_named_property(env, summary_obj, "skipped", skipped);
+    return summary_obj;
+}
+
+napi_value FolderSizeToJs(napi_env env, const FolderSize& size) {
+    napi_value size_obj;
+    napi_create_object(env, &size_obj);
+    SetNumber(env, size_obj, "bytes", static_cast<double>(size.bytes));
+    SetNumber(env, size_obj, "files", static_cast<double>(size.files));
+    SetNumber(env, size_obj, "directories", static_cast<double>(size.directories));
+    return size_obj;
+}
+
+napi_value FolderSizeResultToJs(napi_env env, const FolderSizeResult& result) {
+    napi_value result_obj = FolderSizeToJs(env, result.size);
+    SetNumber(env, result_obj, "directoriesListed", static_cast<double>(result.directoriesListed));
+    SetNumber(env, result_obj, "directoriesReused", static_cast<double>(result.directoriesReused));
+    SetNumber(env, result_obj, "errorCount", static_cast<double>(result.errorCount));
+    SetNumber(env, result_obj, "durationMs", result.durationMs);
+
+    napi_value cancelled, timed_out;
+    napi_get_boolean(env, result.cancelled, &cancelled);
+    napi_set_named_property(env, result_obj, "cancelled", cancelled);
+    napi_get_boolean(env, result.timedOut, &timed_out);
+    napi_set_named_property(env, result_obj, "timedOut", timed_out);
+    return result_obj;
+}
+
+bool GetOptionalProperty(napi_env env, napi_value object, const char* name, napi_value* result) {
+    bool has = false;
+    if (napi_has_named_property(env, object, name, &has) != napi_ok || !has) {
+        return false;
+    }
+    napi_get_named_property(env, object, name, result);
+    napi_valuetype type;
+    napi_typeof(env, *result, &type);
+    return type != napi_undefined && type != napi_null;
+}
+
+// Marks NativeCancellationToken objects, so no other wrapped object is taken for one
+const napi_type_tag kCancellationTokenTag = { 0x9c1d6b0e5a2f4e13ULL, 0xb7a8e4c2d1f03569ULL };
+
+// An optional NativeCancellationToken; undefined and null leave token as is
+bool ReadCancellationToken(napi_env env, napi_value value, CancellationToken* token) {
+    napi_valuetype type = napi_undefined;
+    napi_typeof(env, value, &type);
+    if (type == napi_undefined || type == napi_null) {
+        return true;
+    }
+    bool tagged = false;
+    void* source = nullptr;
+    if (type != napi_object || napi_check_object_type_tag(env, value, &kCancellationTokenTag, &tagged) != napi_ok ||
+        !tagged || napi_unwrap(env, value, &source) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "cancellation must be a NativeCancellationToken");
+        return false;
+    }
+    *token = static_cast<CancellationSource*>(source)->Token();
+    return true;
+}
+
+bool ReadWalkOptions(napi_env env, napi_value options_obj, WalkOptions* options) {
+    napi_value value;
+    if (GetOptionalProperty(env, options_obj, "maxDepth", &value) &&
+        napi_get_value_uint32(env, value, &options->maxDepth) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "maxDepth must be a number");
+        return false;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "batchSize", &value)) {
+        uint32_t batch_size = 0;
+        if (napi_get_value_uint32(env, value, &batch_size) != napi_ok || batch_size == 0) {
+            napi_throw_type_error(env, nullptr, "batchSize must be a positive number");
+            return false;
+        }
+        options->batchSize = batch_size;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "stat", &value) &&
+        napi_get_value_bool(env, value, &options->statEntries) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "stat must be a boolean");
+        return false;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "ignore", &value)) {
+        bool is_array = false;
+        napi_is_array(env, value, &is_array);
+        if (!is_array) {
+            napi_throw_type_error(env, nullptr, "ignore must be an array of strings");
+            return false;
+        }
+        uint32_t length = 0;
+        napi_get_array_length(env, value, &length);
+        for (uint32_t i = 0; i < length; i++) {
+            napi_value element;
+            napi_get_element(env, value, i, &element);
+            size_t size = 0;
+            if (napi_get_value_string_utf8(env, element, nullptr, 0, &size) != napi_ok) {
+                napi_throw_type_error(env, nullptr, "ignore must be an array of strings");
+                return false;
+            }
+            std::string pattern(size, '\0');
+            napi_get_value_string_utf8(env, element, &pattern[0], size + 1, &size);
+            options->ignorePatterns.push_back(std::move(pattern));
+        }
+    }
+
+    if (GetOptionalProperty(env, options_obj, "cancellation", &value) &&
+        !ReadCancellationToken(env, value, &options->cancellation)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool ReadString(napi_env env, napi_value value, std::string* result) {
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) {
+        return false;
+    }
+    result->assign(length, '\0');
+    napi_get_value_string_utf8(env, value, &(*result)[0], length + 1, &length);
+    return true;
+}
+
+bool ReadTransferItems(napi_env env, napi_value value, std::vector<TransferItem>* items) {
+    bool is_array = false;
+    napi_is_array(env, value, &is_array);
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "items must be an array of { source, destination }");
+        return false;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env, value, &length);
+    items->reserve(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element, source, destination;
+        napi_get_element(env, value, i, &element);
+        TransferItem item;
+        if (!GetOptionalProperty(env, element, "source", &source) ||
+            !GetOptionalProperty(env, element, "destination", &destination) ||
+            !ReadString(env, source, &item.source) || !ReadString(env, destination, &item.destination) ||
+            item.source.empty() || item.destination.empty()) {
+            napi_throw_type_error(env, nullptr, "items must be an array of { source, destination }");
+            return false;
+        }
+        items->push_back(std::move(item));
+    }
+    return true;
+}
+
+bool ReadTransferOptions(napi_env env, napi_value options_obj, TransferOptions* options) {
+    napi_value value;
+    if (GetOptionalProperty(env, options_obj, "mode", &value)) {
+        std::string mode;
+        if (!ReadString(env, value, &mode) || (mode != "copy" && mode != "move")) {
+            napi_throw_type_error(env, nullptr, "mode must be 'copy' or 'move'");
+            return false;
+        }
+        options->mode = mode == "move" ? TransferMode::Move : TransferMode::Copy;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "overwrite", &value) &&
+        napi_get_value_bool(env, value, &options->overwrite) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "overwrite must be a boolean");
+        return false;
+    }
+
+    // Names from kTransferMethodNames; readWrite is always the last resort
+    if (GetOptionalProperty(env, options_obj, "methods", &value)) {
+        bool is_array = false;
+        napi_is_array(env, value, &is_array);
+        uint32_t length = 0;
+        napi_get_array_length(env, value, &length);
+        options->methods = 0;
+        for (uint32_t i = 0; is_array && i < length; i++) {
+            napi_value element;
+            napi_get_element(env, value, i, &element);
+            std::string name;
+            ReadString(env, element, &name);
+            const auto* begin = std::begin(kTransferMethodNames) + 1;
+            const auto* found = std::find(begin, std::end(kTransferMethodNames), name);
+            if (found == std::end(kTransferMethodNames)) {
+                is_array = false;
+                break;
+            }
+            options->methods |= 1u << (found - std::begin(kTransferMethodNames));
+        }
+        if (!is_array) {
+            napi_throw_type_error(env, nullptr,
+                                  "methods must be an array of 'rename', 'clone', 'copyFileRange', 'sendfile'");
+            return false;
+        }
+    }
+
+    if (GetOptionalProperty(env, options_obj, "perDeviceConcurrency", &value)) {
+        uint32_t concurrency = 0;
+        if (napi_get_value_uint32(env, value, &concurrency) != napi_ok || concurrency == 0) {
+            napi_throw_type_error(env, nullptr, "perDeviceConcurrency must be a positive number");
+            return false;
+        }
+        options->perDeviceConcurrency = concurrency;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "bufferSize", &value)) {
+        uint32_t buffer_size = 0;
+        if (napi_get_value_uint32(env, value, &buffer_size) != napi_ok || buffer_size < 4096) {
+            napi_throw_type_error(env, nullptr, "bufferSize must be at least 4096");
+            return false;
+        }
+        options->bufferSize = buffer_size;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "cancellation", &value) &&
+        !ReadCancellationToken(env, value, &options->cancellation)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool ReadZipSources(napi_env env, napi_value value, std::vector<ZipSource>* sources) {
+    bool is_array = false;
+    napi_is_array(env, value, &is_array);
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "sources must be an array of { path, name? }");
+        return false;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env, value, &length);
+    sources->reserve(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element, path, name;
+        napi_get_element(env, value, i, &element);
+        ZipSource source;
+        if (!GetOptionalProperty(env, element, "path", &path) || !ReadString(env, path, &source.path) ||
+            source.path.empty() ||
+            (GetOptionalProperty(env, element, "name", &name) && !ReadString(env, name, &source.name))) {
+            napi_throw_type_error(env, nullptr, "sources must be an array of { path, name? }");
+            return false;
+        }
+        sources->push_back(std::move(source));
+    }
+    return true;
+}
+
+bool ReadZipOptions(napi_env env, napi_value options_obj, ZipOptions* options) {
+    napi_value value;
+    if (GetOptionalProperty(env, options_obj, "level", &value)) {
+        int32_t level = -1;
+        if (napi_get_value_int32(env, value, &level) != napi_ok || level < 0 || level > 9) {
+            napi_throw_type_error(env, nullptr, "level must be a number from 0 to 9");
+            return false;
+        }
+        options->level = level;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "chunkSize", &value)) {
+        uint32_t chunk_size = 0;
+        if (napi_get_value_uint32(env, value, &chunk_size) != napi_ok || chunk_size < 64 * 1024) {
+            napi_throw_type_error(env, nullptr, "chunkSize must be at least 65536");
+            return false;
+        }
+        options->chunkSize = chunk_size;
+    }
+
+    if (GetOptionalProperty(env, options_obj, "storeCompressed", &value) &&
+        napi_get_value_bool(env, value, &options->storeCompressedContent) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "storeCompressed must be a boolean");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+/**
+ * One directory walk at a time, owned by a JS NativeDirectoryWalker object
+ */
+class DirectoryWalkerBinding {
+public:
+    explicit DirectoryWalkerBinding(napi_env env) : env_(env) {}
+
+    ~DirectoryWalkerBinding() {
+        Shutdown();
+    }
+
+    // Returns false with a pending JS exception on failure
+    bool Start(napi_env env, napi_value self, std::string root, WalkOptions options, napi_value callback) {
+        if (IsRunning()) {
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::ALREADY_INITIALIZED,
+                           "A directory walk is already in progress", 0);
+            return false;
+        }
+
+        // Batches are bulk data: a short latency bound, and a drain early
+        // once a handful of batches are waiting
+        WalkEventDispatcher::Options dispatch_options;
+        dispatch_options.maxLatency = std::chrono::milliseconds(16);
+        dispatch_options.maxBatchSize = 8;
+
+        dispatcher_ = std::make_unique<WalkEventDispatcher>(
+            [this](napi_env env, napi_value js_callback,
+                   std::vector<WalkEvent>& high, std::vector<WalkEvent>& low) {
+                DeliverEvents(env, js_callback, high, low);
+            },
+            dispatch_options);
+
+        if (dispatcher_->Start(env, callback, "FileOpsDirectoryWalk") != napi_ok) {
+            dispatcher_.reset();
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                           "Failed to create walk callback", 0);
+            return false;
+        }
+
+        WalkEventDispatcher* dispatcher = dispatcher_.get();
+        walker_ = DirectoryWalker::Create(
+            root,
+            std::move(options),
+            [dispatcher](std::unique_ptr<WalkBatch> batch) {
+                dispatcher->Push(WalkEvent{std::move(batch), nullptr});
+            },
+            [dispatcher](std::unique_ptr<WalkSummary> summary) {
+                dispatcher->Push(WalkEvent{nullptr, std::move(summary)}, WalkEventDispatcher::Priority::High);
+            });
+
+        int error = walker_->Start(SharedPool());
+        if (error != 0) {
+            walker_.reset();
+            dispatcher_->Stop();
+            dispatcher_.reset();
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::DIRECTORY_WALK_FAILED,
+                           "Cannot open directory '" + root + "': " + strerror(error), error);
+            return false;
+        }
+
+        // Keep the JS object alive until the summary is delivered; otherwise
+        // an unreferenced walker would be collected and cancel its own walk
+        napi_create_reference(env, self, 1, &self_ref_);
+
+        running_ = true;
+        if (!cleanup_hook_added_) {
+            napi_add_env_cleanup_hook(env, CleanupHook, this);
+            cleanup_hook_added_ = true;
+        }
+        return true;
+    }
+
+    void Cancel() {
+        if (walker_) {
+            walker_->Cancel();
+        }
+    }
+
+    bool IsRunning() const { return running_; }
+
+private:
+    void DeliverEvents(napi_env env, napi_value js_callback,
+                       std::vector<WalkEvent>& high, std::vector<WalkEvent>& low) {
+        napi_handle_scope scope;
+        napi_open_handle_scope(env, &scope);
+
+        napi_value batches;
+        napi_create_array(env, &batches);
+        uint32_t batch_count = 0;
+        std::unique_ptr<WalkSummary> summary;
+        napi_ref finished_ref = nullptr;
+
+        // Batches only use the low lane and the summary the high lane, so
+        // delivering low first keeps the summary after every batch
+        for (auto* lane : {&low, &high}) {
+            for (auto& event : *lane) {
+                if (event.batch) {
+                    napi_set_element(env, batches, batch_count++, BatchToJs(env, *event.batch));
+                }
+                if (event.summary) {
+                    summary = std::move(event.summary);
+                }
+            }
+        }
+
+        if (summary) {
+            // The done sink has already pushed; once it returns no producer
+            // is left and the dispatcher can stop. This happens before the
+            // callback runs so the callback may start the next walk.
+            walker_->WaitUntilFinished();
+            dispatcher_->Stop();
+            running_ = false;
+            RemoveCleanupHook();
+            finished_ref = self_ref_;
+            self_ref_ = nullptr;
+        }
+
+        napi_value global, result;
+        napi_get_global(env, &global);
+        napi_value argv[2] = { batches, nullptr };
+        size_t argc = 1;
+        if (summary) {
+            argv[1] = SummaryToJs(env, *summary);
+            argc = 2;
+        }
+        napi_call_function(env, global, js_callback, argc, argv, &result);
+
+        // Last use of this; the callback may have started another walk with its own reference
+        if (finished_ref) {
+            napi_delete_reference(env, finished_ref);
+        }
+        napi_close_handle_scope(env, scope);
+    }
+
+    // Cancel and drain any walk in flight; safe to call repeatedly
+    void Shutdown() {
+        if (walker_) {
+            walker_->Cancel();
+            walker_->WaitUntilFinished();
+        }
+        if (dispatcher_) {
+            dispatcher_->Stop();
+        }
+        running_ = false;
+        RemoveCleanupHook();
+        if (self_ref_) {
+            napi_delete_reference(env_, self_ref_);
+            self_ref_ = nullptr;
+        }
+    }
+
+    void RemoveCleanupHook() {
+        if (cleanup_hook_added_) {
+            napi_remove_env_cleanup_hook(env_, CleanupHook, this);
+            cleanup_hook_added_ = false;
+        }
+    }
+
+    // Environment teardown (e.g. worker thread exit) can precede GC of the wrapper
+    static void CleanupHook(void* arg) {
+        auto* binding = static_cast<DirectoryWalkerBinding*>(arg);
+        binding->cleanup_hook_added_ = false;
+        binding->Shutdown();
+    }
+
+    napi_env env_;
+    std::shared_ptr<DirectoryWalker> walker_;
+    std::unique_ptr<WalkEventDispatcher> dispatcher_;
+    napi_ref self_ref_ = nullptr;
+    bool running_ = false;
+    bool cleanup_hook_added_ = false;
+};
+
+// N-API wrapper functions
+static DirectoryWalkerBinding* UnwrapWalker(napi_env env, napi_value this_arg) {
+    DirectoryWalkerBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    return binding;
+}
+
+static napi_value CreateWalker(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    auto* binding = new DirectoryWalkerBinding(env);
+    napi_wrap(env, this_arg, binding,
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<DirectoryWalkerBinding*>(data);
+        }, nullptr, nullptr);
+
+    return this_arg;
+}
+
+static napi_value StartWalk(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, nullptr, "start(root, options, callback) requires 3 arguments");
+        return nullptr;
+    }
+
+    std::string root;
+    if (!ReadString(env, args[0], &root) || root.empty()) {
+        napi_throw_type_error(env, nullptr, "root must be a non-empty string");
+        return nullptr;
+    }
+
+    napi_valuetype options_type, callback_type;
+    napi_typeof(env, args[1], &options_type);
+    napi_typeof(env, args[2], &callback_type);
+    if (callback_type != napi_function) {
+        napi_throw_type_error(env, nullptr, "callback must be a function");
+        return nullptr;
+    }
+
+    WalkOptions options;
+    if (options_type == napi_object && !ReadWalkOptions(env, args[1], &options)) {
+        return nullptr;
+    }
+
+    DirectoryWalkerBinding* binding = UnwrapWalker(env, this_arg);
+    if (!binding || !binding->Start(env, this_arg, std::move(root), std::move(options), args[2])) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_get_boolean(env, true, &result);
+    return result;
+}
+
+static napi_value CancelWalk(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    if (DirectoryWalkerBinding* binding = UnwrapWalker(env, this_arg)) {
+        binding->Cancel();
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value IsWalkRunning(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    DirectoryWalkerBinding* binding = UnwrapWalker(env, this_arg);
+
+    napi_value result;
+    napi_get_boolean(env, binding && binding->IsRunning(), &result);
+    return result;
+}
+
+/**
+ * One copy/move at a time, owned by a JS NativeFileTransfer object
+ */
+class FileTransferBinding {
+public:
+    explicit FileTransferBinding(napi_env env) : env_(env) {}
+
+    ~FileTransferBinding() {
+        Shutdown();
+    }
+
+    // Returns false with a pending JS exception on failure
+    bool Start(napi_env env, napi_value self, std::vector<TransferItem> items, TransferOptions options,
+               napi_value callback) {
+        if (IsRunning()) {
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::ALREADY_INITIALIZED,
+                           "A transfer is already in progress", 0);
+            return false;
+        }
+
+        // Results and progress ticks are coalesced; a drain delivers
+        // whatever finished since the last one plus a fresh progress snapshot
+        TransferEventDispatcher::Options dispatch_options;
+        dispatch_options.maxLatency = std::chrono::milliseconds(16);
+        dispatch_options.maxBatchSize = 256;
+
+        dispatcher_ = std::make_unique<TransferEventDispatcher>(
+            [this](napi_env env, napi_value js_callback,
+                   std::vector<TransferEvent>& high, std::vector<TransferEvent>& low) {
+                DeliverEvents(env, js_callback, high, low);
+            },
+            dispatch_options);
+
+        if (dispatcher_->Start(env, callback, "FileOpsTransfer") != napi_ok) {
+            dispatcher_.reset();
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                           "Failed to create transfer callback", 0);
+            return false;
+        }
+
+        TransferEventDispatcher* dispatcher = dispatcher_.get();
+        transfer_ = FileTransfer::Create(
+            std::move(items),
+            options,
+            [dispatcher](const TransferResult& result) {
+                dispatcher->Push(TransferEvent{true, result, nullptr});
+            },
+            [dispatcher] {
+                dispatcher->Push(TransferEvent{});
+            },
+            [dispatcher](const TransferSummary& summary) {
+                dispatcher->Push(TransferEvent{false, {}, std::make_unique<TransferSummary>(summary)},
+                                 TransferEventDispatcher::Priority::High);
+            });
+        transfer_->Start(SharedPool());
+
+        // Keep the JS object alive until the summary is delivered
+        napi_create_reference(env, self, 1, &self_ref_);
+
+        running_ = true;
+        if (!cleanup_hook_added_) {
+            napi_add_env_cleanup_hook(env, CleanupHook, this);
+            cleanup_hook_added_ = true;
+        }
+        return true;
+    }
+
+    void Cancel() {
+        if (transfer_) {
+            transfer_->Cancel();
+        }
+    }
+
+    bool IsRunning() const { return running_; }
+
+private:
+    void DeliverEvents(napi_env env, napi_value js_callback,
+                       std::vector<TransferEvent>& high, std::vector<TransferEvent>& low) {
+        napi_handle_scope scope;
+        napi_open_handle_scope(env, &scope);
+
+        std::vector<uint32_t> indices;
+        std::vector<uint8_t> methods;
+        std::vector<int32_t> errnos;
+        std::vector<double> bytes;
+        std::unique_ptr<TransferSummary> summary;
+        napi_ref finished_ref = nullptr;
+
+        // Results only use the low lane and the summary the high lane
+        for (auto* lane : {&low, &high}) {
+            for (auto& event : *lane) {
+                if (event.hasResult) {
+                    indices.push_back(event.result.index);
+                    methods.push_back(static_cast<uint8_t>(event.result.method));
+                    errnos.push_back(event.result.error);
+                    bytes.push_back(static_cast<double>(event.result.bytes));
+                }
+                if (event.summary) {
+                    summary = std::move(event.summary);
+                }
+            }
+        }
+
+        napi_value results;
+        napi_create_object(env, &results);
+        napi_set_named_property(env, results, "indices", CreateUint32Array(env, indices));
+        napi_set_named_property(env, results, "methods", CreateUint8Array(env, methods));
+        napi_set_named_property(env, results, "errnos", CreateInt32Array(env, errnos));
+        napi_set_named_property(env, results, "bytes", CreateFloat64Array(env, bytes));
+        napi_value progress = TransferProgressToJs(env, transfer_->Progress());
+
+        if (summary) {
+            // Same ordering as the directory walker: stop before the callback
+            // so it may start the next transfer
+            transfer_->WaitUntilFinished();
+            dispatcher_->Stop();
+            running_ = false;
+            RemoveCleanupHook();
+            finished_ref = self_ref_;
+            self_ref_ = nullptr;
+        }
+
+        napi_value global, result;
+        napi_get_global(env, &global);
+        napi_value argv[3] = { results, progress, nullptr };
+        size_t argc = 2;
+        if (summary) {
+            argv[2] = TransferSummaryToJs(env, *summary);
+            argc = 3;
+        }
+        napi_call_function(env, global, js_callback, argc, argv, &result);
+
+        if (finished_ref) {
+            napi_delete_reference(env, finished_ref);
+        }
+        napi_close_handle_scope(env, scope);
+    }
+
+    // Cancel and drain any transfer in flight; safe to call repeatedly
+    void Shutdown() {
+        if (transfer_) {
+            transfer_->Cancel();
+            transfer_->WaitUntilFinished();
+        }
+        if (dispatcher_) {
+            dispatcher_->Stop();
+        }
+        running_ = false;
+        RemoveCleanupHook();
+        if (self_ref_) {
+            napi_delete_reference(env_, self_ref_);
+            self_ref_ = nullptr;
+        }
+    }
+
+    void RemoveCleanupHook() {
+        if (cleanup_hook_added_) {
+            napi_remove_env_cleanup_hook(env_, CleanupHook, this);
+            cleanup_hook_added_ = false;
+        }
+    }
+
+    static void CleanupHook(void* arg) {
+        auto* binding = static_cast<FileTransferBinding*>(arg);
+        binding->cleanup_hook_added_ = false;
+        binding->Shutdown();
+    }
+
+    napi_env env_;
+    std::shared_ptr<FileTransfer> transfer_;
+    std::unique_ptr<TransferEventDispatcher> dispatcher_;
+    napi_ref self_ref_ = nullptr;
+    bool running_ = false;
+    bool cleanup_hook_added_ = false;
+};
+
+static FileTransferBinding* UnwrapTransfer(napi_env env, napi_value this_arg) {
+    FileTransferBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    return binding;
+}
+
+static napi_value CreateTransfer(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    auto* binding = new FileTransferBinding(env);
+    napi_wrap(env, this_arg, binding,
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<FileTransferBinding*>(data);
+        }, nullptr, nullptr);
+
+    return this_arg;
+}
+
+static napi_value StartTransfer(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, nullptr, "start(items, options, callback) requires 3 arguments");
+        return nullptr;
+    }
+
+    std::vector<TransferItem> items;
+    if (!ReadTransferItems(env, args[0], &items)) {
+        return nullptr;
+    }
+
+    napi_valuetype options_type, callback_type;
+    napi_typeof(env, args[1], &options_type);
+    napi_typeof(env, args[2], &callback_type);
+    if (callback_type != napi_function) {
+        napi_throw_type_error(env, nullptr, "callback must be a function");
+        return nullptr;
+    }
+
+    TransferOptions options;
+    if (options_type == napi_object && !ReadTransferOptions(env, args[1], &options)) {
+        return nullptr;
+    }
+
+    FileTransferBinding* binding = UnwrapTransfer(env, this_arg);
+    if (!binding || !binding->Start(env, this_arg, std::move(items), options, args[2])) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_get_boolean(env, true, &result);
+    return result;
+}
+
+static napi_value CancelTransfer(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    if (FileTransferBinding* binding = UnwrapTransfer(env, this_arg)) {
+        binding->Cancel();
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value IsTransferRunning(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    FileTransferBinding* binding = UnwrapTransfer(env, this_arg);
+
+    napi_value result;
+    napi_get_boolean(env, binding && binding->IsRunning(), &result);
+    return result;
+}
+
+/**
+ * One archive at a time, owned by a JS NativeZipWriter object
+ */
+class ZipWriterBinding {
+public:
+    explicit ZipWriterBinding(napi_env env) : env_(env) {}
+
+    ~ZipWriterBinding() {
+        Shutdown();
+    }
+
+    // Returns false with a pending JS exception on failure
+    bool Start(napi_env env, napi_value self, std::vector<ZipSource> sources, std::string output_path,
+               ZipOptions options, napi_value callback) {
+        if (IsRunning()) {
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::ALREADY_INITIALIZED,
+                           "An archive is already being written", 0);
+            return false;
+        }
+
+        ZipEventDispatcher::Options dispatch_options;
+        dispatch_options.maxLatency = std::chrono::milliseconds(16);
+
+        dispatcher_ = std::make_unique<ZipEventDispatcher>(
+            [this](napi_env env, napi_value js_callback,
+                   std::vector<ZipEvent>& high, std::vector<ZipEvent>& low) {
+                DeliverEvents(env, js_callback, high, low);
+            },
+            dispatch_options);
+
+        if (dispatcher_->Start(env, callback, "FileOpsZip") != napi_ok) {
+            dispatcher_.reset();
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                           "Failed to create archive callback", 0);
+            return false;
+        }
+
+        ZipEventDispatcher* dispatcher = dispatcher_.get();
+        writer_ = ZipWriter::Create(
+            std::move(sources),
+            std::move(output_path),
+            options,
+            [dispatcher] {
+                dispatcher->Push(ZipEvent{});
+            },
+            [dispatcher](const ZipSummary& summary) {
+                dispatcher->Push(ZipEvent{std::make_unique<ZipSummary>(summary)},
+                                 ZipEventDispatcher::Priority::High);
+            });
+        writer_->Start(SharedPool());
+
+        // Keep the JS object alive until the summary is delivered
+        napi_create_reference(env, self, 1, &self_ref_);
+
+        running_ = true;
+        if (!cleanup_hook_added_) {
+            napi_add_env_cleanup_hook(env, CleanupHook, this);
+            cleanup_hook_added_ = true;
+        }
+        return true;
+    }
+
+    void Cancel() {
+        if (writer_) {
+            writer_->Cancel();
+        }
+    }
+
+    bool IsRunning() const { return running_; }
+
+private:
+    void DeliverEvents(napi_env env, napi_value js_callback,
+                       std::vector<ZipEvent>& high, std::vector<ZipEvent>& low) {
+        napi_handle_scope scope;
+        napi_open_handle_scope(env, &scope);
+
+        // Progress ticks only use the low lane and the summary the high lane
+        std::unique_ptr<ZipSummary> summary;
+        for (auto& event : high) {
+            if (event.summary) {
+                summary = std::move(event.summary);
+            }
+        }
+        napi_value progress = ZipProgressToJs(env, writer_->Progress());
+        napi_ref finished_ref = nullptr;
+
+        if (summary) {
+            // Stop before the callback so it may start the next archive
+            writer_->WaitUntilFinished();
+            dispatcher_->Stop();
+            running_ = false;
+            RemoveCleanupHook();
+            finished_ref = self_ref_;
+            self_ref_ = nullptr;
+        }
+
+        napi_value global, result;
+        napi_get_global(env, &global);
+        napi_value argv[2] = { progress, nullptr };
+        size_t argc = 1;
+        if (summary) {
+            argv[1] = ZipSummaryToJs(env, *summary);
+            argc = 2;
+        }
+        napi_call_function(env, global, js_callback, argc, argv, &result);
+
+        if (finished_ref) {
+            napi_delete_reference(env, finished_ref);
+        }
+        napi_close_handle_scope(env, scope);
+    }
+
+    // Cancel and drain any archive in flight; safe to call repeatedly
+    void Shutdown() {
+        if (writer_) {
+            writer_->Cancel();
+            writer_->WaitUntilFinished();
+        }
+        if (dispatcher_) {
+            dispatcher_->Stop();
+        }
+        running_ = false;
+        RemoveCleanupHook();
+        if (self_ref_) {
+            napi_delete_reference(env_, self_ref_);
+            self_ref_ = nullptr;
+        }
+    }
+
+    void RemoveCleanupHook() {
+        if (cleanup_hook_added_) {
+            napi_remove_env_cleanup_hook(env_, CleanupHook, this);
+            cleanup_hook_added_ = false;
+        }
+    }
+
+    static void CleanupHook(void* arg) {
+        auto* binding = static_cast<ZipWriterBinding*>(arg);
+        binding->cleanup_hook_added_ = false;
+        binding->Shutdown();
+    }
+
+    napi_env env_;
+    std::shared_ptr<ZipWriter> writer_;
+    std::unique_ptr<ZipEventDispatcher> dispatcher_;
+    napi_ref self_ref_ = nullptr;
+    bool running_ = false;
+    bool cleanup_hook_added_ = false;
+};
+
+static ZipWriterBinding* UnwrapZipWriter(napi_env env, napi_value this_arg) {
+    ZipWriterBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    return binding;
+}
+
+static napi_value CreateZipWriter(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    auto* binding = new ZipWriterBinding(env);
+    napi_wrap(env, this_arg, binding,
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<ZipWriterBinding*>(data);
+        }, nullptr, nullptr);
+
+    return this_arg;
+}
+
+static napi_value StartZip(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    if (argc < 4) {
+        napi_throw_type_error(env, nullptr, "start(sources, outputPath, options, callback) requires 4 arguments");
+        return nullptr;
+    }
+
+    std::vector<ZipSource> sources;
+    if (!ReadZipSources(env, args[0], &sources)) {
+        return nullptr;
+    }
+
+    std::string output_path;
+    if (!ReadString(env, args[1], &output_path) || output_path.empty()) {
+        napi_throw_type_error(env, nullptr, "outputPath must be a non-empty string");
+        return nullptr;
+    }
+
+    napi_valuetype options_type, callback_type;
+    napi_typeof(env, args[2], &options_type);
+    napi_typeof(env, args[3], &callback_type);
+    if (callback_type != napi_function) {
+        napi_throw_type_error(env, nullptr, "callback must be a function");
+        return nullptr;
+    }
+
+    ZipOptions options;
+    if (options_type == napi_object && !ReadZipOptions(env, args[2], &options)) {
+        return nullptr;
+    }
+
+    ZipWriterBinding* binding = UnwrapZipWriter(env, this_arg);
+    if (!binding ||
+        !binding->Start(env, this_arg, std::move(sources), std::move(output_path), options, args[3])) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_get_boolean(env, true, &result);
+    return result;
+}
+
+static napi_value CancelZip(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    if (ZipWriterBinding* binding = UnwrapZipWriter(env, this_arg)) {
+        binding->Cancel();
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value IsZipRunning(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    ZipWriterBinding* binding = UnwrapZipWriter(env, this_arg);
+
+    napi_value result;
+    napi_get_boolean(env, binding && binding->IsRunning(), &result);
+    return result;
+}
+
+/**
+ * Folder size measurements sharing one cache, owned by a JS
+ * NativeFolderSizeService object. Each measurement has its own threadsafe
+ * function, called once with the result and released on delivery.
+ */
+class FolderSizeServiceBinding {
+public:
+    FolderSizeServiceBinding(napi_env env, std::string cache_path)
+        : env_(env), cache_(std::make_shared<FolderSizeCache>(std::move(cache_path))) {}
+
+    ~FolderSizeServiceBinding() {
+        Shutdown();
+        if (self_ref_) {
+            napi_delete_reference(env_, self_ref_);
+        }
+    }
+
+    void SetSelfReference(napi_ref ref) { self_ref_ = ref; }
+
+    napi_value Estimate(napi_env env, const std::string& root) {
+        FolderSize size;
+        napi_value result;
+        if (FileCataloger::EstimateFolderSize(*cache_, root, &size) != 0) {
+            napi_get_null(env, &result);
+            return result;
+        }
+        return FolderSizeToJs(env, size);
+    }
+
+    // Returns the measurement id, or 0 with a pending JS exception
+    uint32_t Measure(napi_env env, std::string root, FolderSizeOptions options, napi_value callback) {
+        napi_value resource_name;
+        napi_create_string_utf8(env, "FileOpsFolderSize", NAPI_AUTO_LENGTH, &resource_name);
+
+        napi_threadsafe_function tsfn = nullptr;
+        if (napi_create_threadsafe_function(env, callback, nullptr, resource_name, 0, 1, nullptr, nullptr,
+                                            this, CallJs, &tsfn) != napi_ok) {
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                              "Failed to create folder size callback", 0);
+            return 0;
+        }
+
+        uint32_t id = next_id_++;
+        auto scanner = FolderSizeScanner::Create(
+            root, cache_, options,
+            [tsfn, id](const FolderSizeResult& result) {
+                FileCataloger::ThreadsafeFunctionCall<Delivery> call(
+                    tsfn, std::make_unique<Delivery>(Delivery{id, result}));
+                call.Call();
+            });
+
+        int error = scanner->Start(SharedPool());
+        if (error != 0) {
+            napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::FOLDER_SIZE_FAILED,
+                              "Cannot open directory '" + root + "': " + strerror(error), error);
+            return 0;
+        }
+
+        // Pending measurements keep the JS object, and with it the cache, alive
+        measurements_.push_back({id, std::move(scanner), tsfn});
+        napi_reference_ref(env, self_ref_, nullptr);
+        if (!cleanup_hook_added_) {
+            napi_add_env_cleanup_hook(env, CleanupHook, this);
+            cleanup_hook_added_ = true;
+        }
+        return id;
+    }
+
+    void Cancel(uint32_t id) {
+        for (auto& measurement : measurements_) {
+            if (id == 0 || measurement.id == id) {
+                measurement.scanner->Cancel();
+            }
+        }
+    }
+
+    size_t PendingCount() const { return measurements_.size(); }
+
+private:
+    struct Delivery {
+        uint32_t id;
+        FolderSizeResult result;
+    };
+
+    struct Measurement {
+        uint32_t id;
+        std::shared_ptr<FolderSizeScanner> scanner;
+        napi_threadsafe_function tsfn;
+    };
+
+    static void CallJs(napi_env env, napi_value js_callback, void* context, void* data) {
+        std::unique_ptr<Delivery> delivery(static_cast<Delivery*>(data));
+        if (env == nullptr) {
+            return;  // Released during teardown
+        }
+        static_cast<FolderSizeServiceBinding*>(context)->Deliver(env, js_callback, *delivery);
+    }
+
+    void Deliver(napi_env env, napi_value js_callback, const Delivery& delivery) {
+        auto it = std::find_if(measurements_.begin(), measurements_.end(),
+                               [&](const Measurement& m) { return m.id == delivery.id; });
+        if (it == measurements_.end()) {
+            return;
+        }
+        // The done sink was the scanner's last use of the function
+        napi_release_threadsafe_function(it->tsfn, napi_tsfn_release);
+        measurements_.erase(it);
+        if (measurements_.empty()) {
+            RemoveCleanupHook();
+        }
+
+        napi_handle_scope scope;
+        napi_open_handle_scope(env, &scope);
+        napi_value global, result;
+        napi_get_global(env, &global);
+        napi_value argv[1] = { FolderSizeResultToJs(env, delivery.result) };
+        napi_call_function(env, global, js_callback, 1, argv, &result);
+        napi_close_handle_scope(env, scope);
+
+        // Last use of this; the object may be collected from here on
+        uint32_t refs = 0;
+        napi_reference_unref(env, self_ref_, &refs);
+    }
+
+    // Cancel and wait for every measurement in flight; safe to call repeatedly
+    void Shutdown() {
+        for (auto& measurement : measurements_) {
+            measurement.scanner->Cancel();
+        }
+        for (auto& measurement : measurements_) {
+            measurement.scanner->WaitUntilFinished();
+            napi_release_threadsafe_function(measurement.tsfn, napi_tsfn_abort);
+        }
+        measurements_.clear();
+        RemoveCleanupHook();
+    }
+
+    void RemoveCleanupHook() {
+        if (cleanup_hook_added_) {
+            napi_remove_env_cleanup_hook(env_, CleanupHook, this);
+            cleanup_hook_added_ = false;
+        }
+    }
+
+    static void CleanupHook(void* arg) {
+        auto* binding = static_cast<FolderSizeServiceBinding*>(arg);
+        binding->cleanup_hook_added_ = false;
+        binding->Shutdown();
+    }
+
+    napi_env env_;
+    std::shared_ptr<FolderSizeCache> cache_;
+    std::vector<Measurement> measurements_;
+    napi_ref self_ref_ = nullptr;
+    uint32_t next_id_ = 1;
+    bool cleanup_hook_added_ = false;
+};
+
+static FolderSizeServiceBinding* UnwrapFolderSizeService(napi_env env, napi_value this_arg) {
+    FolderSizeServiceBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    return binding;
+}
+
+static napi_value CreateFolderSizeService(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    // An omitted cache path keeps the cache in memory only
+    std::string cache_path;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_undefined && type != napi_null && !ReadString(env, args[0], &cache_path)) {
+        napi_throw_type_error(env, nullptr, "cachePath must be a string");
+        return nullptr;
+    }
+
+    auto* binding = new FolderSizeServiceBinding(env, std::move(cache_path));
+    napi_wrap(env, this_arg, binding,
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<FolderSizeServiceBinding*>(data);
+        }, nullptr, nullptr);
+
+    napi_ref self_ref;
+    napi_create_reference(env, this_arg, 0, &self_ref);
+    binding->SetSelfReference(self_ref);
+
+    return this_arg;
+}
+
+static napi_value EstimateFolderSize(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    std::string root;
+    if (argc < 1 || !ReadString(env, args[0], &root) || root.empty()) {
+        napi_throw_type_error(env, nullptr, "root must be a non-empty string");
+        return nullptr;
+    }
+
+    FolderSizeServiceBinding* binding = UnwrapFolderSizeService(env, this_arg);
+    if (!binding) {
+        return nullptr;
+    }
+    return binding->Estimate(env, root);
+}
+
+static napi_value MeasureFolderSize(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, nullptr, "measure(root, options, callback) requires 3 arguments");
+        return nullptr;
+    }
+
+    std::string root;
+    if (!ReadString(env, args[0], &root) || root.empty()) {
+        napi_throw_type_error(env, nullptr, "root must be a non-empty string");
+        return nullptr;
+    }
+
+    napi_valuetype options_type, callback_type;
+    napi_typeof(env, args[1], &options_type);
+    napi_typeof(env, args[2], &callback_type);
+    if (callback_type != napi_function) {
+        napi_throw_type_error(env, nullptr, "callback must be a function");
+        return nullptr;
+    }
+
+    FolderSizeOptions options;
+    napi_value value;
+    if (options_type == napi_object && GetOptionalProperty(env, args[1], "rescan", &value) &&
+        napi_get_value_bool(env, value, &options.rescan) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "rescan must be a boolean");
+        return nullptr;
+    }
+    if (options_type == napi_object && GetOptionalProperty(env, args[1], "cancellation", &value) &&
+        !ReadCancellationToken(env, value, &options.cancellation)) {
+        return nullptr;
+    }
+
+    FolderSizeServiceBinding* binding = UnwrapFolderSizeService(env, this_arg);
+    uint32_t id = binding ? binding->Measure(env, std::move(root), options, args[2]) : 0;
+    if (id == 0) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_create_uint32(env, id, &result);
+    return result;
+}
+
+static napi_value CancelFolderSize(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    // cancel() without an id cancels every pending measurement
+    uint32_t id = 0;
+    if (argc >= 1) {
+        napi_get_value_uint32(env, args[0], &id);
+    }
+    if (FolderSizeServiceBinding* binding = UnwrapFolderSizeService(env, this_arg)) {
+        binding->Cancel(id);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value GetPendingFolderSizeCount(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    FolderSizeServiceBinding* binding = UnwrapFolderSizeService(env, this_arg);
+
+    napi_value result;
+    napi_create_uint32(env, binding ? static_cast<uint32_t>(binding->PendingCount()) : 0, &result);
+    return result;
+}
+
+// The threadsafe function is created per call and released by the pool
+// thread that delivers the batch, so nothing outlives a sniff
+static void DeliverSniffBatch(napi_env env, napi_value js_callback, void* context, void* data) {
+    std::unique_ptr<SniffBatch> batch(static_cast<SniffBatch*>(data));
+    if (env == nullptr) {
+        return;  // Released during teardown
+    }
+
+    std::vector<uint8_t> codes(batch->types.size());
+    for (size_t i = 0; i < codes.size(); i++) {
+        codes[i] = static_cast<uint8_t>(batch->types[i]);
+    }
+
+    napi_value global, result;
+    napi_get_global(env, &global);
+    napi_value argv[1] = { CreateUint8Array(env, codes) };
+    napi_call_function(env, global, js_callback, 1, argv, &result);
+}
+
+static napi_value SniffContentTypes(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool is_array = false;
+    napi_valuetype callback_type = napi_undefined;
+    if (argc >= 2) {
+        napi_is_array(env, args[0], &is_array);
+        napi_typeof(env, args[1], &callback_type);
+    }
+    if (!is_array || callback_type != napi_function) {
+        napi_throw_type_error(env, nullptr, "sniffContentTypes(paths: string[], callback, cancellation?) expected");
+        return nullptr;
+    }
+
+    auto batch = std::make_shared<SniffBatch>();
+    if (argc >= 3 && !ReadCancellationToken(env, args[2], &batch->cancellation)) {
+        return nullptr;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env, args[0], &length);
+    batch->paths.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, args[0], i, &element);
+        if (!ReadString(env, element, &batch->paths[i])) {
+            napi_throw_type_error(env, nullptr, "paths must be strings");
+            return nullptr;
+        }
+    }
+
+    napi_value resource_name;
+    napi_create_string_utf8(env, "FileOpsSniff", NAPI_AUTO_LENGTH, &resource_name);
+    napi_threadsafe_function tsfn = nullptr;
+    if (napi_create_threadsafe_function(env, args[1], nullptr, resource_name, 0, 1, nullptr, nullptr,
+                                        nullptr, DeliverSniffBatch, &tsfn) != napi_ok) {
+        ThrowFileOpsError(env, FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                          "Failed to create sniff callback", 0);
+        return nullptr;
+    }
+
+    FileCataloger::SniffFiles(SharedPool(), std::move(batch), [tsfn](std::shared_ptr<SniffBatch> done) {
+        FileCataloger::ThreadsafeFunctionCall<SniffBatch> call(
+            tsfn, std::make_unique<SniffBatch>(std::move(*done)));
+        call.Call();
+        napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+    });
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value CreateStringArray(napi_env env, const std::vector<std::string>& values) {
+    napi_value array;
+    napi_create_array_with_length(env, values.size(), &array);
+    for (size_t i = 0; i < values.size(); i++) {
+        napi_value value;
+        napi_create_string_utf8(env, values[i].data(), values[i].size(), &value);
+        napi_set_element(env, array, static_cast<uint32_t>(i), value);
+    }
+    return array;
+}
+
+// Same lifetime as DeliverSniffBatch: one threadsafe function per call
+static void DeliverMediaMetadataBatch(napi_env env, napi_value js_callback, void* context, void* data) {
+    std::unique_ptr<MediaMetadataBatch> batch(static_cast<MediaMetadataBatch*>(data));
+    if (env == nullptr) {
+        return;  // Released during teardown
+    }
+
+    const size_t count = batch->results.size();
+    std::vector<uint8_t> fields(count);
+    std::vector<double> captureTimes(count), durations(count);
+    std::vector<uint32_t> widths(count), heights(count);
+    std::vector<std::string> makes(count), models(count);
+    for (size_t i = 0; i < count; i++) {
+        auto& metadata = batch->results[i];
+        fields[i] = metadata.fields;
+        captureTimes[i] = static_cast<double>(metadata.captureTimeMs);
+        durations[i] = metadata.durationMs;
+        widths[i] = metadata.width;
+        heights[i] = metadata.height;
+        makes[i] = std::move(metadata.cameraMake);
+        models[i] = std::move(metadata.cameraModel);
+    }
+
+    napi_value columns;
+    napi_create_object(env, &columns);
+    napi_set_named_property(env, columns, "fields", CreateUint8Array(env, fields));
+    napi_set_named_property(env, columns, "captureTimes", CreateFloat64Array(env, captureTimes));
+    napi_set_named_property(env, columns, "durations", CreateFloat64Array(env, durations));
+    napi_set_named_property(env, columns, "widths", CreateUint32Array(env, widths));
+    napi_set_named_property(env, columns, "heights", CreateUint32Array(env, heights));
+    napi_set_named_property(env, columns, "makes", CreateStringArray(env, makes));
+    napi_set_named_property(env, columns, "models", CreateStringArray(env, models));
+
+    napi_value global, result;
+    napi_get_global(env, &global);
+    napi_value argv[1] = { columns };
+    napi_call_function(env, global, js_callback, 1, argv, &result);
+}
+
+static napi_value ExtractMediaMetadata(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool is_array = false;
+    napi_valuetype callback_type = napi_undefined;
+    if (argc >= 2) {
+        napi_is_array(env, args[0], &is_array);
+        napi_typeof(env, args[1], &callback_type);
+    }
+    if (!is_array || callback_type != napi_function) {
+        napi_throw_type_error(env, nullptr, "extractMediaMetadata(paths: string[], callback, cancellation?) expected");
+        return nullptr;
+    }
+
+    auto batch = std::make_shared<MediaMetadataBatch>();
+    if (argc >= 3 && !ReadCancellationToken(env, args[2], &batch->cancellation)) {
+        return nullptr;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env, args[0], &length);
+    batch->paths.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, args[0], i, &element);
+        if (!ReadString(env, element, &batch->paths[i])) {
+            napi_throw_type_error(env, nullptr, "paths must be strings");
+            return nullptr;
+        }
+    }
+
+    napi_value resource_name;
+    napi_create_string_utf8(env, "FileOpsMediaMetadata", NAPI_AUTO_LENGTH, &resource_name);
+    napi_threadsafe_function tsfn = nullptr;
+    if (napi_create_threadsafe_function(env, args[1], nullptr, resource_name, 0, 1, nullptr, nullptr,
+                                        nullptr, DeliverMediaMetadataBatch, &tsfn) != napi_ok) {
+        ThrowFileOpsError(env, FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                          "Failed to create media metadata callback", 0);
+        return nullptr;
+    }
+
+    SharedMediaMetadataExtractor().ExtractFiles(
+        SharedPool(), std::move(batch), [tsfn](std::shared_ptr<MediaMetadataBatch> done) {
+            FileCataloger::ThreadsafeFunctionCall<MediaMetadataBatch> call(
+                tsfn, std::make_unique<MediaMetadataBatch>(std::move(*done)));
+            call.Call();
+            napi_release_threadsafe_function(tsfn, napi_tsfn_release);
+        });
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// One copy into V8's heap; external buffers are not allowed under
+// Electron's memory cage
+static napi_value FileListPayloadToJs(napi_env env, std::vector<uint8_t>& payload) {
+    void* bytes = nullptr;
+    napi_value buffer;
+    if (napi_create_arraybuffer(env, payload.size(), &bytes, &buffer) != napi_ok) {
+        return nullptr;
+    }
+    if (!payload.empty()) {
+        std::memcpy(bytes, payload.data(), payload.size());
+    }
+    return buffer;
+}
+
+// Stats and encodes one batch; resumes on the pool thread that finished it
+static Task<std::vector<uint8_t>> StatFileListTask(std::vector<std::string> paths,
+                                                   CancellationToken cancellation) {
+    auto batch = std::make_shared<FileListBatch>();
+    batch->paths = std::move(paths);
+    batch->cancellation = std::move(cancellation);
+    std::shared_ptr<FileListBatch> done = co_await Completion<std::shared_ptr<FileListBatch>>(
+        [&batch](Completion<std::shared_ptr<FileListBatch>>::Complete complete) {
+            FileCataloger::StatFileList(SharedPool(), std::move(batch), std::move(complete));
+        });
+    co_return std::move(done->payload);
+}
+
+// One payload per chunk_size paths; the next chunk is stat'ed only once the
+// consumer asks for it. Cancellation ends the stream after a partial chunk.
+static AsyncGenerator<std::vector<uint8_t>> StatFileListChunksGenerator(std::vector<std::string> paths,
+                                                                         size_t chunk_size,
+                                                                         CancellationToken cancellation) {
+    for (size_t begin = 0; begin < paths.size() && !cancellation.IsCancelled(); begin += chunk_size) {
+        size_t end = std::min(paths.size(), begin + chunk_size);
+        std::vector<std::string> chunk(std::make_move_iterator(paths.begin() + begin),
+                                       std::make_move_iterator(paths.begin() + end));
+        co_yield co_await StatFileListTask(std::move(chunk), cancellation);
+    }
+}
+
+static bool ReadPathList(napi_env env, napi_value array, std::vector<std::string>* paths) {
+    uint32_t length = 0;
+    napi_get_array_length(env, array, &length);
+    paths->resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, array, i, &element);
+        if (!ReadString(env, element, &(*paths)[i])) {
+            napi_throw_type_error(env, nullptr, "paths must be strings");
+            return false;
+        }
+    }
+    return true;
+}
+
+static napi_value StatFileList(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool is_array = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "statFileList(paths: string[], cancellation?) expected");
+        return nullptr;
+    }
+
+    std::vector<std::string> paths;
+    CancellationToken cancellation;
+    if (!ReadPathList(env, args[0], &paths) || (argc >= 2 && !ReadCancellationToken(env, args[1], &cancellation))) {
+        return nullptr;
+    }
+    return FileCataloger::PromiseForTask<std::vector<uint8_t>>(
+        env, SharedPool(), StatFileListTask(std::move(paths), std::move(cancellation)), FileListPayloadToJs,
+        "FileOpsFileList");
+}
+
+static napi_value StatFileListChunks(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool is_array = false;
+    double chunk_size = 0;
+    if (argc >= 2) {
+        napi_is_array(env, args[0], &is_array);
+        napi_get_value_double(env, args[1], &chunk_size);
+    }
+    if (!is_array || !(chunk_size >= 1)) {
+        napi_throw_type_error(env, nullptr,
+                              "statFileListChunks(paths: string[], chunkSize: number, cancellation?) expected");
+        return nullptr;
+    }
+
+    std::vector<std::string> paths;
+    CancellationToken cancellation;
+    if (!ReadPathList(env, args[0], &paths) || (argc >= 3 && !ReadCancellationToken(env, args[2], &cancellation))) {
+        return nullptr;
+    }
+    return FileCataloger::AsyncIteratorForGenerator<std::vector<uint8_t>>(
+        env, SharedPool(),
+        StatFileListChunksGenerator(std::move(paths), static_cast<size_t>(chunk_size), std::move(cancellation)),
+        FileListPayloadToJs, "FileOpsFileListChunks");
+}
+
+// Runs one rename or unlink batch; errors[i] is 0 or the errno for paths[i]
+static Task<std::vector<int32_t>> PathOpsTask(std::shared_ptr<PathOpBatch> batch) {
+    std::shared_ptr<PathOpBatch> done = co_await Completion<std::shared_ptr<PathOpBatch>>(
+        [&batch](Completion<std::shared_ptr<PathOpBatch>>::Complete complete) {
+            FileCataloger::RunPathOps(SharedPool(), std::move(batch), std::move(complete));
+        });
+    co_return std::move(done->errors);
+}
+
+static napi_value PathErrorsToJs(napi_env env, std::vector<int32_t>& errors) {
+    return CreateInt32Array(env, errors);
+}
+
+static napi_value RenamePaths(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool from_is_array = false;
+    bool to_is_array = false;
+    if (argc >= 2) {
+        napi_is_array(env, args[0], &from_is_array);
+        napi_is_array(env, args[1], &to_is_array);
+    }
+    if (!from_is_array || !to_is_array) {
+        napi_throw_type_error(env, nullptr, "renamePaths(from: string[], to: string[], cancellation?) expected");
+        return nullptr;
+    }
+
+    auto batch = std::make_shared<PathOpBatch>();
+    batch->op = PathOp::Rename;
+    if (!ReadPathList(env, args[0], &batch->paths) || !ReadPathList(env, args[1], &batch->destinations) ||
+        (argc >= 3 && !ReadCancellationToken(env, args[2], &batch->cancellation))) {
+        return nullptr;
+    }
+    if (batch->paths.size() != batch->destinations.size()) {
+        napi_throw_range_error(env, nullptr, "renamePaths: from and to must have the same length");
+        return nullptr;
+    }
+    return FileCataloger::PromiseForTask<std::vector<int32_t>>(env, SharedPool(), PathOpsTask(std::move(batch)),
+                                                               PathErrorsToJs, "FileOpsRenamePaths");
+}
+
+static napi_value UnlinkPaths(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool is_array = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "unlinkPaths(paths: string[], cancellation?) expected");
+        return nullptr;
+    }
+
+    auto batch = std::make_shared<PathOpBatch>();
+    batch->op = PathOp::Unlink;
+    if (!ReadPathList(env, args[0], &batch->paths) ||
+        (argc >= 2 && !ReadCancellationToken(env, args[1], &batch->cancellation))) {
+        return nullptr;
+    }
+    return FileCataloger::PromiseForTask<std::vector<int32_t>>(env, SharedPool(), PathOpsTask(std::move(batch)),
+                                                               PathErrorsToJs, "FileOpsUnlinkPaths");
+}
+
+static napi_value GetIoEngine(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_create_string_utf8(env, IoEngineName(DefaultIoEngine().Kind()), NAPI_AUTO_LENGTH, &result);
+    return result;
+}
+
+/**
+ * The session store behind a JS NativeSessionStore object. Reads and
+ * appends are synchronous: a Get copies one value out of the mapping and a
+ * Put is one small write to the log. Compaction runs on the pool once the
+ * log has grown, holding the store alive until it finishes.
+ */
+class SessionStoreBinding {
+public:
+    explicit SessionStoreBinding(std::string path)
+        : store_(std::make_shared<SessionStore>(std::move(path))),
+          compacting_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    SessionStore& store() { return *store_; }
+
+    void CompactInBackgroundIfNeeded() {
+        if (!store_->NeedsCompaction() || compacting_->exchange(true)) {
+            return;
+        }
+        std::shared_ptr<SessionStore> store = store_;
+        std::shared_ptr<std::atomic<bool>> compacting = compacting_;
+        SharedPool().Submit([store, compacting] {
+            // On failure the log keeps everything and the next Put retries
+            store->Compact();
+            compacting->store(false);
+        });
+    }
+
+private:
+    std::shared_ptr<SessionStore> store_;
+    std::shared_ptr<std::atomic<bool>> compacting_;
+};
+
+static SessionStoreBinding* UnwrapSessionStore(napi_env env, napi_value this_arg) {
+    SessionStoreBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    return binding;
+}
+
+static napi_value CreateSessionStore(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    std::string path;
+    if (argc < 1 || !ReadString(env, args[0], &path) || path.empty()) {
+        napi_throw_type_error(env, nullptr, "path must be a non-empty string");
+        return nullptr;
+    }
+
+    auto binding = std::make_unique<SessionStoreBinding>(path);
+    int error = binding->store().Open();
+    if (error != 0) {
+        ThrowFileOpsError(env, FileCataloger::ErrorCode::SESSION_STORE_FAILED,
+                          "Cannot open session store '" + path + "': " + strerror(error), error);
+        return nullptr;
+    }
+    napi_wrap(env, this_arg, binding.release(),
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<SessionStoreBinding*>(data);
+        }, nullptr, nullptr);
+
+    return this_arg;
+}
+
+// Reads the (space, key) arguments every session store method starts with
+static SessionStoreBinding* ReadSessionStoreKey(napi_env env, napi_callback_info info, size_t expected,
+                                                napi_value* args, uint16_t* space, std::string* key) {
+    size_t argc = expected;
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    uint32_t value = 0;
+    if (argc < expected || napi_get_value_uint32(env, args[0], &value) != napi_ok || value > 0xFFFF) {
+        napi_throw_type_error(env, nullptr, "space must be an integer between 0 and 65535");
+        return nullptr;
+    }
+    *space = static_cast<uint16_t>(value);
+    if (expected > 1 && !ReadString(env, args[1], key)) {
+        napi_throw_type_error(env, nullptr, "key must be a string");
+        return nullptr;
+    }
+    return UnwrapSessionStore(env, this_arg);
+}
+
+static napi_value GetSessionValue(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    uint16_t space;
+    std::string key;
+    SessionStoreBinding* binding = ReadSessionStoreKey(env, info, 2, args, &space, &key);
+    if (!binding) {
+        return nullptr;
+    }
+
+    std::string value;
+    napi_value result;
+    if (!binding->store().Get(space, key, &value)) {
+        napi_get_undefined(env, &result);
+        return result;
+    }
+    napi_create_buffer_copy(env, value.size(), value.data(), nullptr, &result);
+    return result;
+}
+
+static napi_value GetSessionKeys(napi_env env, napi_callback_info info) {
+    napi_value args[1];
+    uint16_t space;
+    SessionStoreBinding* binding = ReadSessionStoreKey(env, info, 1, args, &space, nullptr);
+    if (!binding) {
+        return nullptr;
+    }
+    return CreateStringArray(env, binding->store().Keys(space));
+}
+
+static napi_value PutSessionValue(napi_env env, napi_callback_info info) {
+    napi_value args[3];
+    uint16_t space;
+    std::string key;
+    SessionStoreBinding* binding = ReadSessionStoreKey(env, info, 3, args, &space, &key);
+    if (!binding) {
+        return nullptr;
+    }
+
+    bool is_typedarray = false;
+    napi_is_typedarray(env, args[2], &is_typedarray);
+    napi_typedarray_type type;
+    size_t length = 0;
+    void* data = nullptr;
+    if (!is_typedarray ||
+        napi_get_typedarray_info(env, args[2], &type, &length, &data, nullptr, nullptr) != napi_ok ||
+        type != napi_uint8_array) {
+        napi_throw_type_error(env, nullptr, "value must be a Uint8Array");
+        return nullptr;
+    }
+
+    int error = binding->store().Put(space, key, std::string(static_cast<const char*>(data), length));
+    if (error != 0) {
+        ThrowFileOpsError(env, FileCataloger::ErrorCode::SESSION_STORE_FAILED,
+                          std::string("Cannot write session value: ") + strerror(error), error);
+        return nullptr;
+    }
+    binding->CompactInBackgroundIfNeeded();
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value DeleteSessionValue(napi_env env, napi_callback_info info) {
+    napi_value args[2];
+    uint16_t space;
+    std::string key;
+    SessionStoreBinding* binding = ReadSessionStoreKey(env, info, 2, args, &space, &key);
+    if (!binding) {
+        return nullptr;
+    }
+
+    int error = binding->store().Delete(space, key);
+    if (error != 0) {
+        ThrowFileOpsError(env, FileCataloger::ErrorCode::SESSION_STORE_FAILED,
+                          std::string("Cannot write session value: ") + strerror(error), error);
+        return nullptr;
+    }
+    binding->CompactInBackgroundIfNeeded();
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Synchronous, for shutdown: the next start maps one snapshot and replays nothing
+static napi_value CompactSessionStore(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    SessionStoreBinding* binding = UnwrapSessionStore(env, this_arg);
+    if (!binding) {
+        return nullptr;
+    }
+    int error = binding->store().Compact();
+    if (error != 0) {
+        ThrowFileOpsError(env, FileCataloger::ErrorCode::SESSION_STORE_FAILED,
+                          std::string("Cannot compact session store: ") + strerror(error), error);
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value GetSessionStoreStats(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    SessionStoreBinding* binding = UnwrapSessionStore(env, this_arg);
+    if (!binding) {
+        return nullptr;
+    }
+    const SessionStoreStats stats = binding->store().Stats();
+    napi_value result;
+    napi_create_object(env, &result);
+    SetNumber(env, result, "generation", static_cast<double>(stats.generation));
+    SetNumber(env, result, "snapshotRecords", static_cast<double>(stats.snapshotRecords));
+    SetNumber(env, result, "snapshotBytes", static_cast<double>(stats.snapshotBytes));
+    SetNumber(env, result, "logRecords", static_cast<double>(stats.logRecords));
+    SetNumber(env, result, "logBytes", static_cast<double>(stats.logBytes));
+    SetNumber(env, result, "corruptValues", static_cast<double>(stats.corruptValues));
+    return result;
+}
+
+static ShelfStore* UnwrapShelfStore(napi_env env, napi_value this_arg) {
+    ShelfStore* store = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&store));
+    return store;
+}
+
+// An ArrayBuffer or a Uint8Array (Buffer); the bytes stay owned by JS
+static bool ReadBytes(napi_env env, napi_value value, const uint8_t** data, size_t* length) {
+    bool is_arraybuffer = false;
+    bool is_typedarray = false;
+    napi_is_arraybuffer(env, value, &is_arraybuffer);
+    napi_is_typedarray(env, value, &is_typedarray);
+    void* bytes = nullptr;
+    if (is_arraybuffer) {
+        napi_get_arraybuffer_info(env, value, &bytes, length);
+    } else {
+        napi_typedarray_type type;
+        if (!is_typedarray ||
+            napi_get_typedarray_info(env, value, &type, length, &bytes, nullptr, nullptr) != napi_ok ||
+            type != napi_uint8_array) {
+            return false;
+        }
+    }
+    *data = static_cast<const uint8_t*>(bytes);
+    return true;
+}
+
+static napi_value ShelfIdToJs(napi_env env, ShelfItemId id) {
+    napi_value result;
+    if (id == 0) {
+        napi_get_null(env, &result);
+    } else {
+        napi_create_double(env, static_cast<double>(id), &result);
+    }
+    return result;
+}
+
+static napi_value ShelfIdsToJs(napi_env env, const std::vector<ShelfItemId>& ids) {
+    std::vector<double> values(ids.begin(), ids.end());
+    return CreateFloat64Array(env, values);
+}
+
+// NativeShelfStore(payload?): empty, or restored from serialize()
+static napi_value CreateShelfStore(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    auto store = std::make_unique<ShelfStore>();
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_undefined && type != napi_null) {
+        const uint8_t* data = nullptr;
+        size_t length = 0;
+        if (!ReadBytes(env, args[0], &data, &length)) {
+            napi_throw_type_error(env, nullptr, "payload must be an ArrayBuffer or a Uint8Array");
+            return nullptr;
+        }
+        if (!store->Load(data, length)) {
+            ThrowFileOpsError(env, FileCataloger::ErrorCode::INVALID_ARGUMENT, "Not a shelf items payload", 0);
+            return nullptr;
+        }
+    }
+    napi_wrap(env, this_arg, store.release(),
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<ShelfStore*>(data);
+        }, nullptr, nullptr);
+
+    return this_arg;
+}
+
+// insertFileList(payload) -> { ids: Float64Array, added }
+static napi_value InsertShelfFileList(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    if (!store || argc < 1 || !ReadBytes(env, args[0], &data, &length)) {
+        napi_throw_type_error(env, nullptr, "insertFileList(payload: ArrayBuffer | Uint8Array) expected");
+        return nullptr;
+    }
+    std::vector<ShelfItemId> ids;
+    size_t added = 0;
+    if (!store->InsertFileList(data, length, &ids, &added)) {
+        ThrowFileOpsError(env, FileCataloger::ErrorCode::INVALID_ARGUMENT, "Not a file list payload", 0);
+        return nullptr;
+    }
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "ids", ShelfIdsToJs(env, ids));
+    SetNumber(env, result, "added", static_cast<double>(added));
+    return result;
+}
+
+// insert(items: { kind, path?, name?, flags?, size?, mtimeMs? }[]) -> Float64Array of ids
+static napi_value InsertShelfItems(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    bool is_array = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!store || !is_array) {
+        napi_throw_type_error(env, nullptr, "insert(items: object[]) expected");
+        return nullptr;
+    }
+
+    uint32_t count = 0;
+    napi_get_array_length(env, args[0], &count);
+    // Records view these strings, so they are read in full first
+    std::vector<std::string> paths(count);
+    std::vector<std::string> names(count);
+    std::vector<ShelfItemRecord> records(count);
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value item, value;
+        napi_get_element(env, args[0], i, &item);
+        uint32_t kind = 0;
+        if (!GetOptionalProperty(env, item, "kind", &value) || napi_get_value_uint32(env, value, &kind) != napi_ok ||
+            kind > static_cast<uint32_t>(ShelfItemKind::Image)) {
+            napi_throw_type_error(env, nullptr, "item kind must be a ShelfItemKind");
+            return nullptr;
+        }
+        records[i].kind = static_cast<ShelfItemKind>(kind);
+        if (GetOptionalProperty(env, item, "path", &value) && !ReadString(env, value, &paths[i])) {
+            napi_throw_type_error(env, nullptr, "item path must be a string");
+            return nullptr;
+        }
+        if (GetOptionalProperty(env, item, "name", &value) && !ReadString(env, value, &names[i])) {
+            napi_throw_type_error(env, nullptr, "item name must be a string");
+            return nullptr;
+        }
+        uint32_t flags = 0;
+        if (GetOptionalProperty(env, item, "flags", &value)) {
+            napi_get_value_uint32(env, value, &flags);
+        }
+        records[i].flags = static_cast<uint16_t>(flags);
+        if (GetOptionalProperty(env, item, "size", &value)) {
+            napi_get_value_double(env, value, &records[i].size);
+        }
+        if (GetOptionalProperty(env, item, "mtimeMs", &value)) {
+            napi_get_value_double(env, value, &records[i].mtimeMs);
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        records[i].path = paths[i];
+        records[i].name = names[i];
+    }
+
+    std::vector<ShelfItemId> ids(count);
+    store->Insert(records.data(), records.size(), ids.data());
+    return ShelfIdsToJs(env, ids);
+}
+
+// remove(ids: number[] | Float64Array) -> how many were on the shelf
+static napi_value RemoveShelfItems(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    bool is_array = false;
+    bool is_typedarray = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &is_array);
+        napi_is_typedarray(env, args[0], &is_typedarray);
+    }
+    if (!store || (!is_array && !is_typedarray)) {
+        napi_throw_type_error(env, nullptr, "remove(ids: number[] | Float64Array) expected");
+        return nullptr;
+    }
+
+    uint32_t removed = 0;
+    napi_typedarray_type type = napi_float64_array;
+    size_t length = 0;
+    void* data = nullptr;
+    if (is_typedarray) {
+        napi_get_typedarray_info(env, args[0], &type, &length, &data, nullptr, nullptr);
+    }
+    if (is_typedarray && type == napi_float64_array) {
+        const double* ids = static_cast<const double*>(data);
+        for (size_t i = 0; i < length; i++) {
+            removed += ids[i] >= 1 && store->Remove(static_cast<ShelfItemId>(ids[i])) ? 1 : 0;
+        }
+    } else {
+        uint32_t count = 0;
+        napi_get_array_length(env, args[0], &count);
+        for (uint32_t i = 0; i < count; i++) {
+            napi_value element;
+            double id = 0;
+            napi_get_element(env, args[0], i, &element);
+            napi_get_value_double(env, element, &id);
+            removed += id >= 1 && store->Remove(static_cast<ShelfItemId>(id)) ? 1 : 0;
+        }
+    }
+
+    napi_value result;
+    napi_create_uint32(env, removed, &result);
+    return result;
+}
+
+// find(path) -> id or null
+static napi_value FindShelfItem(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    std::string path;
+    if (!store || argc < 1 || !ReadString(env, args[0], &path)) {
+        napi_throw_type_error(env, nullptr, "find(path: string) expected");
+        return nullptr;
+    }
+    return ShelfIdToJs(env, store->Find(path));
+}
+
+// get(id) -> item, or undefined for an unknown or removed id
+static napi_value GetShelfItem(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    double id = 0;
+    if (!store || argc < 1 || napi_get_value_double(env, args[0], &id) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "get(id: number) expected");
+        return nullptr;
+    }
+
+    ShelfItem item;
+    napi_value result;
+    if (!(id >= 1) || !store->Get(static_cast<ShelfItemId>(id), &item)) {
+        napi_get_undefined(env, &result);
+        return result;
+    }
+    napi_value value;
+    napi_create_object(env, &result);
+    SetNumber(env, result, "id", id);
+    SetNumber(env, result, "kind", static_cast<double>(item.kind));
+    if (!item.path.empty()) {
+        napi_create_string_utf8(env, item.path.data(), item.path.size(), &value);
+        napi_set_named_property(env, result, "path", value);
+    }
+    napi_create_string_utf8(env, item.name.data(), item.name.size(), &value);
+    napi_set_named_property(env, result, "name", value);
+    SetNumber(env, result, "flags", item.flags);
+    if (!std::isnan(item.size)) {
+        SetNumber(env, result, "size", item.size);
+    }
+    if (!std::isnan(item.mtimeMs)) {
+        SetNumber(env, result, "mtimeMs", item.mtimeMs);
+    }
+    return result;
+}
+
+// ids() -> Float64Array in shelf order
+static napi_value GetShelfIds(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    if (!store) {
+        return nullptr;
+    }
+    return ShelfIdsToJs(env, store->Ids());
+}
+
+static napi_value GetShelfCount(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    napi_value result;
+    napi_create_double(env, store ? static_cast<double>(store->Size()) : 0, &result);
+    return result;
+}
+
+static napi_value ClearShelfStore(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    if (ShelfStore* store = UnwrapShelfStore(env, this_arg)) {
+        store->Clear();
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// serialize() -> ArrayBuffer, written in place
+static napi_value SerializeShelfStore(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    if (!store) {
+        return nullptr;
+    }
+    void* bytes = nullptr;
+    napi_value buffer;
+    if (napi_create_arraybuffer(env, store->SerializedLength(), &bytes, &buffer) != napi_ok) {
+        return nullptr;
+    }
+    store->SerializeTo(bytes);
+    return buffer;
+}
+
+static napi_value GetShelfStoreStats(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    ShelfStore* store = UnwrapShelfStore(env, this_arg);
+    if (!store) {
+        return nullptr;
+    }
+    const ShelfStoreStats stats = store->Stats();
+    napi_value result;
+    napi_create_object(env, &result);
+    SetNumber(env, result, "items", static_cast<double>(stats.items));
+    SetNumber(env, result, "slots", static_cast<double>(stats.slots));
+    SetNumber(env, result, "directories", static_cast<double>(stats.directories));
+    SetNumber(env, result, "nameBytes", static_cast<double>(stats.nameBytes));
+    SetNumber(env, result, "garbageBytes", static_cast<double>(stats.garbageBytes));
+    SetNumber(env, result, "memoryBytes", static_cast<double>(stats.memoryBytes));
+    return result;
+}
+
+// NativeCancellationToken(deadlineMs?): one CancellationSource, handed to
+// jobs through their cancellation option. Jobs hold the token's state, so
+// the JS object may be collected while they run.
+static napi_value CreateCancellationToken(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    double deadline_ms = 0;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_undefined && type != napi_null &&
+        (napi_get_value_double(env, args[0], &deadline_ms) != napi_ok || !(deadline_ms > 0))) {
+        napi_throw_type_error(env, nullptr, "deadlineMs must be a positive number");
+        return nullptr;
+    }
+
+    auto* source = new CancellationSource(
+        CancellationToken(), std::chrono::milliseconds(static_cast<int64_t>(std::ceil(deadline_ms))));
+    if (napi_wrap(env, this_arg, source,
+                  [](napi_env env, void* data, void* hint) { delete static_cast<CancellationSource*>(data); },
+                  nullptr, nullptr) != napi_ok) {
+        delete source;
+        return nullptr;
+    }
+    napi_type_tag_object(env, this_arg, &kCancellationTokenTag);
+    return this_arg;
+}
+
+static CancellationSource* UnwrapCancellationToken(napi_env env, napi_value this_arg) {
+    void* source = nullptr;
+    napi_unwrap(env, this_arg, &source);
+    return static_cast<CancellationSource*>(source);
+}
+
+static napi_value CancelToken(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    if (CancellationSource* source = UnwrapCancellationToken(env, this_arg)) {
+        source->Cancel();
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// 'none', 'cancelled' or 'deadline'
+static napi_value GetCancelReason(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    CancellationSource* source = UnwrapCancellationToken(env, this_arg);
+    CancelReason reason = source ? source->Reason() : CancelReason::None;
+    const char* name = reason == CancelReason::Cancelled          ? "cancelled"
+                       : reason == CancelReason::DeadlineExceeded ? "deadline"
+                                                                  : "none";
+    napi_value result;
+    napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &result);
+    return result;
+}
+
+static napi_value GetWorkerCount(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_create_uint32(env, static_cast<uint32_t>(SharedPool().ThreadCount()), &result);
+    return result;
+}
+
+// Module initialization
+static napi_value Init(napi_env env, napi_value exports) {
+    napi_value walker_class;
+
+    napi_property_descriptor properties[] = {
+        { "start", nullptr, StartWalk, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "cancel", nullptr, CancelWalk, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "isRunning", nullptr, IsWalkRunning, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeDirectoryWalker", NAPI_AUTO_LENGTH,
+                      CreateWalker, nullptr, 3, properties, &walker_class);
+    napi_set_named_property(env, exports, "NativeDirectoryWalker", walker_class);
+
+    napi_value folder_size_class;
+
+    napi_property_descriptor folder_size_properties[] = {
+        { "estimate", nullptr, EstimateFolderSize, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "measure", nullptr, MeasureFolderSize, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "cancel", nullptr, CancelFolderSize, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "pendingCount", nullptr, GetPendingFolderSizeCount, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeFolderSizeService", NAPI_AUTO_LENGTH,
+                      CreateFolderSizeService, nullptr, 4, folder_size_properties, &folder_size_class);
+    napi_set_named_property(env, exports, "NativeFolderSizeService", folder_size_class);
+
+    napi_value transfer_class;
+
+    napi_property_descriptor transfer_properties[] = {
+        { "start", nullptr, StartTransfer, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "cancel", nullptr, CancelTransfer, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "isRunning", nullptr, IsTransferRunning, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeFileTransfer", NAPI_AUTO_LENGTH,
+                      CreateTransfer, nullptr, 3, transfer_properties, &transfer_class);
+    napi_set_named_property(env, exports, "NativeFileTransfer", transfer_class);
+
+    napi_value zip_class;
+
+    napi_property_descriptor zip_properties[] = {
+        { "start", nullptr, StartZip, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "cancel", nullptr, CancelZip, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "isRunning", nullptr, IsZipRunning, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeZipWriter", NAPI_AUTO_LENGTH,
+                      CreateZipWriter, nullptr, 3, zip_properties, &zip_class);
+    napi_set_named_property(env, exports, "NativeZipWriter", zip_class);
+
+    napi_value session_store_class;
+
+    napi_property_descriptor session_store_properties[] = {
+        { "get", nullptr, GetSessionValue, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "keys", nullptr, GetSessionKeys, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "put", nullptr, PutSessionValue, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "delete", nullptr, DeleteSessionValue, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "compact", nullptr, CompactSessionStore, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "stats", nullptr, GetSessionStoreStats, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeSessionStore", NAPI_AUTO_LENGTH,
+                      CreateSessionStore, nullptr, 6, session_store_properties, &session_store_class);
+    napi_set_named_property(env, exports, "NativeSessionStore", session_store_class);
+
+    napi_value shelf_store_class;
+
+    napi_property_descriptor shelf_store_properties[] = {
+        { "insertFileList", nullptr, InsertShelfFileList, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "insert", nullptr, InsertShelfItems, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "remove", nullptr, RemoveShelfItems, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "find", nullptr, FindShelfItem, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "get", nullptr, GetShelfItem, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "ids", nullptr, GetShelfIds, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "count", nullptr, GetShelfCount, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "clear", nullptr, ClearShelfStore, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "serialize", nullptr, SerializeShelfStore, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "stats", nullptr, GetShelfStoreStats, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeShelfStore", NAPI_AUTO_LENGTH,
+                      CreateShelfStore, nullptr, 10, shelf_store_properties, &shelf_store_class);
+    napi_set_named_property(env, exports, "NativeShelfStore", shelf_store_class);
+
+    napi_value cancellation_token_class;
+
+    napi_property_descriptor cancellation_token_properties[] = {
+        { "cancel", nullptr, CancelToken, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "reason", nullptr, GetCancelReason, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeCancellationToken", NAPI_AUTO_LENGTH, CreateCancellationToken, nullptr, 2,
+                      cancellation_token_properties, &cancellation_token_class);
+    napi_set_named_property(env, exports, "NativeCancellationToken", cancellation_token_class);
+
+    napi_value sniff_fn;
+    napi_create_function(env, "sniffContentTypes", NAPI_AUTO_LENGTH, SniffContentTypes, nullptr, &sniff_fn);
+    napi_set_named_property(env, exports, "sniffContentTypes", sniff_fn);
+
+    napi_value media_fn;
+    napi_create_function(env, "extractMediaMetadata", NAPI_AUTO_LENGTH, ExtractMediaMetadata, nullptr, &media_fn);
+    napi_set_named_property(env, exports, "extractMediaMetadata", media_fn);
+
+    napi_value file_list_fn;
+    napi_create_function(env, "statFileList", NAPI_AUTO_LENGTH, StatFileList, nullptr, &file_list_fn);
+    napi_set_named_property(env, exports, "statFileList", file_list_fn);
+
+    napi_value file_list_chunks_fn;
+    napi_create_function(env, "statFileListChunks", NAPI_AUTO_LENGTH, StatFileListChunks, nullptr,
+                         &file_list_chunks_fn);
+    napi_set_named_property(env, exports, "statFileListChunks", file_list_chunks_fn);
+
+    napi_value rename_fn;
+    napi_create_function(env, "renamePaths", NAPI_AUTO_LENGTH, RenamePaths, nullptr, &rename_fn);
+    napi_set_named_property(env, exports, "renamePaths", rename_fn);
+
+    napi_value unlink_fn;
+    napi_create_function(env, "unlinkPaths", NAPI_AUTO_LENGTH, UnlinkPaths, nullptr, &unlink_fn);
+    napi_set_named_property(env, exports, "unlinkPaths", unlink_fn);
+
+    napi_value io_engine_fn;
+    napi_create_function(env, "getIoEngine", NAPI_AUTO_LENGTH, GetIoEngine, nullptr, &io_engine_fn);
+    napi_set_named_property(env, exports, "getIoEngine", io_engine_fn);
+
+    napi_value worker_count_fn;
+    napi_create_function(env, "getWorkerCount", NAPI_AUTO_LENGTH, GetWorkerCount, nullptr, &worker_count_fn);
+    napi_set_named_property(env, exports, "getWorkerCount", worker_count_fn);
+
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,69 @@
+/**
+ * @fileoverview Loader for the file-ops native module
+ *
+ * The module is built for macOS, and for Linux in development and tests.
+ * Each wrapper in this directory types the part of it that it uses and
+ * falls back to plain fs APIs when it is missing.
+ *
+ * @module file-ops
+ */
+
+import * as os from 'os';
+import * as path from 'path';
+import { createLogger } from '@main/modules/utils/logger';
+
+const logger = createLogger('FileOps');
+
+let nativeModule: unknown = null;
+let loadAttempted = false;
+
+export function loadFileOpsModule<T>(): T | null {
+  if (loadAttempted) {
+    return nativeModule as T | null;
+  }
+  loadAttempted = true;
+
+  if (process.platform !== 'darwin' && process.platform !== 'linux') {
+    return null;
+  }
+
+  const moduleName = `file_ops_${process.platform}.node`;
+  try {
+    try {
+      // Development: from native module build directory
+      nativeModule = require(`../build/Release/${moduleName}`);
+    } catch {
+      // Production: from dist/main, unpacked from asar when packaged
+      let nativePath = path.join(__dirname, moduleName);
+      if (nativePath.includes('.asar')) {
+        nativePath = nativePath.replace(/\.asar([/\\])/i, '.asar.unpacked$1');
+      }
+      nativeModule = require(nativePath);
+    }
+    logger.info('Successfully loaded file-ops native module');
+  } catch {
+    logger.info('File-ops native module not available - using fs fallbacks');
+  }
+  return nativeModule as T | null;
+}
+
+export function errnoCode(errno: number): string {
+  const match = Object.entries(os.constants.errno).find(([, value]) => value === errno);
+  return match ? match[0] : 'UNKNOWN';
+}
+
+/**
+ * Convert a native error carrying an errno into the ErrnoException that the
+ * equivalent fs call would have thrown; other errors are returned unchanged
+ */
+export function toErrnoException(error: unknown, nativeCode: number, filePath: string): unknown {
+  const nativeError = error as Error & { code?: number; errno?: number };
+  if (nativeError.code !== nativeCode || !nativeError.errno) {
+    return error;
+  }
+  const fsError = new Error(nativeError.message) as NodeJS.ErrnoException;
+  fsError.code = errnoCode(nativeError.errno);
+  fsError.errno = nativeError.errno;
+  fsError.path = filePath;
+  return fsError;
+}
@@ -0,0 +1,154 @@
+/**
+ * @fileoverview Rename or delete many paths in one native call
+ *
+ * renamePaths() and unlinkPaths() run a whole batch on the native worker
+ * pool, where on Linux it goes to the kernel through io_uring when
+ * available (see getIoEngine()). They resolve with one error or null per
+ * path, in path order, and never reject for a single failed path.
+ *
+ * Usage:
+ * ```typescript
+ * const errors = await renamePaths(['/a/1.txt'], ['/a/one.txt']);
+ * if (errors[0]?.code === 'EXDEV') {
+ *   // copy and delete instead
+ * }
+ * ```
+ *
+ * Renames replace an existing destination, like fs.rename, and do not
+ * cross volumes (EXDEV). A batch where one rename's destination is
+ * another's source, or one rename lies inside a directory another renames,
+ * runs one rename at a time, in order; paths are compared normalized, and
+ * case-folded on case-insensitive volumes. Such a batch stops at its first
+ * EXDEV: the paths after it fail with ECANCELED and are left untouched, so
+ * the caller can move that one across volumes and rename the rest again.
+ * Without the native module (e.g. Windows) the batch runs through
+ * fs.promises, in order, and stops at an EXDEV the same way.
+ *
+ * @module file-ops
+ */
+
+import { promises as fs } from 'fs';
+import { CancellationOptions, nativeCancellation, NativeCancellationToken } from './cancellation';
+import { errnoCode, loadFileOpsModule } from './nativeModule';
+
+interface NativePathOpsModule {
+  renamePaths(from: string[], to: string[], cancellation?: NativeCancellationToken): Promise<Int32Array>;
+  unlinkPaths(paths: string[], cancellation?: NativeCancellationToken): Promise<Int32Array>;
+  getIoEngine(): 'io_uring' | 'syscalls';
+}
+
+const nativeModule = loadFileOpsModule<NativePathOpsModule>();
+
+export type IoEngine = 'io_uring' | 'syscalls' | 'fs';
+
+export function isNativePathOpsAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+/** How bulk path operations reach the kernel in this process */
+export function getIoEngine(): IoEngine {
+  return nativeModule ? nativeModule.getIoEngine() : 'fs';
+}
+
+function pathError(errno: number, syscall: string, filePath: string, dest?: string): NodeJS.ErrnoException {
+  const code = errnoCode(errno);
+  const target = dest === undefined ? `'${filePath}'` : `'${filePath}' -> '${dest}'`;
+  const error = new Error(`${code}: ${syscall} ${target}`) as NodeJS.ErrnoException;
+  error.code = code;
+  error.errno = errno;
+  error.syscall = syscall;
+  error.path = filePath;
+  if (dest !== undefined) {
+    (error as NodeJS.ErrnoException & { dest?: string }).dest = dest;
+  }
+  return error;
+}
+
+function cancelledError(syscall: string, filePath: string): NodeJS.ErrnoException {
+  const error = new Error(`ECANCELED: ${syscall} '${filePath}'`) as NodeJS.ErrnoException;
+  error.code = 'ECANCELED';
+  error.syscall = syscall;
+  error.path = filePath;
+  return error;
+}
+
+// After an error with code stopOn, the remaining paths are left untouched
+async function runFallback(
+  paths: string[],
+  syscall: string,
+  options: CancellationOptions,
+  run: (index: number) => Promise<void>,
+  stopOn?: string
+): Promise<(NodeJS.ErrnoException | null)[]> {
+  const deadline = options.deadlineMs ? Date.now() + options.deadlineMs : Infinity;
+  const errors: (NodeJS.ErrnoException | null)[] = [];
+  let stopped = false;
+  for (let i = 0; i < paths.length; i++) {
+    if (stopped || options.signal?.aborted || Date.now() >= deadline) {
+      errors.push(cancelledError(syscall, paths[i]));
+      continue;
+    }
+    try {
+      await run(i);
+      errors.push(null);
+    } catch (error) {
+      errors.push(error as NodeJS.ErrnoException);
+      stopped = stopOn !== undefined && (error as NodeJS.ErrnoException).code === stopOn;
+    }
+  }
+  return errors;
+}
+
+function toErrors(
+  errnos: Int32Array,
+  syscall: string,
+  paths: string[],
+  destinations?: string[]
+): (NodeJS.ErrnoException | null)[] {
+  return Array.from(errnos, (errno, i) =>
+    errno === 0 ? null : pathError(errno, syscall, paths[i], destinations?.[i])
+  );
+}
+
+/**
+ * Rename from[i] to to[i] for every i. Paths not reached before
+ * options.signal aborted or the deadline passed get an ECANCELED error and
+ * are left where they were.
+ */
+export async function renamePaths(
+  from: string[],
+  to: string[],
+  options: CancellationOptions = {}
+): Promise<(NodeJS.ErrnoException | null)[]> {
+  if (from.length !== to.length) {
+    throw new RangeError('renamePaths: from and to must have the same length');
+  }
+  if (!nativeModule) {
+    return runFallback(from, 'rename', options, i => fs.rename(from[i], to[i]), 'EXDEV');
+  }
+  const cancellation = nativeCancellation(options);
+  try {
+    return toErrors(await nativeModule.renamePaths(from, to, cancellation.token), 'rename', from, to);
+  } finally {
+    cancellation.release();
+  }
+}
+
+/**
+ * Unlink every path (files and symlinks; a directory fails with EISDIR or
+ * EPERM). Cancellation works as in renamePaths().
+ */
+export async function unlinkPaths(
+  paths: string[],
+  options: CancellationOptions = {}
+): Promise<(NodeJS.ErrnoException | null)[]> {
+  if (!nativeModule) {
+    return runFallback(paths, 'unlink', options, i => fs.unlink(paths[i]));
+  }
+  const cancellation = nativeCancellation(options);
+  try {
+    return toErrors(await nativeModule.unlinkPaths(paths, cancellation.token), 'unlink', paths);
+  } finally {
+    cancellation.release();
+  }
+}
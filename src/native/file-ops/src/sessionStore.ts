@@ -0,0 +1,216 @@
+/**
+ * @fileoverview Binary session snapshot for fast startup restore
+ *
+ * Session state (recent files, window bounds, usage counters, the last
+ * shelf position and saved shelves) lives in a native snapshot mapped at
+ * startup, with every change appended to a small log and merged into the
+ * snapshot on the worker pool once the log grows. Opening the store maps
+ * the file and checks its index; a value is only decoded when asked for,
+ * so restoring the first visible shelf does not parse the others.
+ *
+ * Usage:
+ * ```typescript
+ * const store = openSessionStore(path.join(app.getPath('userData'), 'session.fcs'));
+ * const [first] = store?.shelfIds() ?? [];
+ * const config = first ? store?.getShelf<ShelfConfig>(first) : null;
+ * ```
+ *
+ * Without the native module (e.g. Windows) openSessionStore returns null and
+ * callers keep their JSON store.
+ *
+ * @module file-ops
+ */
+
+import { loadFileOpsModule } from './nativeModule';
+
+/** Namespaces of the store; values are never reused */
+enum SessionSpace {
+  RecentFiles = 1,
+  WindowStates = 2,
+  UsageStats = 3,
+  ShelfPosition = 4,
+  Shelves = 5,
+}
+
+export interface RecentFile {
+  path: string;
+  timestamp: number;
+}
+
+export interface WindowBounds {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
+
+export interface SessionUsageStats {
+  shelfCreations: number;
+  filesDropped: number;
+  lastUsed: number;
+}
+
+export interface SessionStoreStats {
+  generation: number;
+  snapshotRecords: number;
+  snapshotBytes: number;
+  /** Records in the log, replayed on the next open until a compaction */
+  logRecords: number;
+  logBytes: number;
+  /** Values whose checksum failed when read; they read as missing */
+  corruptValues: number;
+}
+
+interface NativeSessionStore {
+  get(space: number, key: string): Buffer | undefined;
+  keys(space: number): string[];
+  put(space: number, key: string, value: Uint8Array): void;
+  delete(space: number, key: string): void;
+  compact(): void;
+  stats(): SessionStoreStats;
+}
+
+interface NativeSessionStoreModule {
+  NativeSessionStore: new (path: string) => NativeSessionStore;
+}
+
+const nativeModule = loadFileOpsModule<NativeSessionStoreModule>();
+
+export function isNativeSessionStoreAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+// Fixed-size records are little-endian float64s
+function encodeNumbers(values: number[]): Uint8Array {
+  const bytes = new Uint8Array(values.length * 8);
+  const view = new DataView(bytes.buffer);
+  values.forEach((value, index) => view.setFloat64(index * 8, value, true));
+  return bytes;
+}
+
+function decodeNumbers(bytes: Buffer | undefined, count: number): number[] | null {
+  if (!bytes || bytes.length !== count * 8) return null;
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.length);
+  return Array.from({ length: count }, (_, index) => view.getFloat64(index * 8, true));
+}
+
+export class SessionStore {
+  constructor(private readonly native: NativeSessionStore) {}
+
+  /** Most recent first */
+  getRecentFiles(limit = Infinity): RecentFile[] {
+    const files: RecentFile[] = [];
+    for (const filePath of this.native.keys(SessionSpace.RecentFiles)) {
+      const value = decodeNumbers(this.native.get(SessionSpace.RecentFiles, filePath), 1);
+      if (value) files.push({ path: filePath, timestamp: value[0] });
+    }
+    files.sort((a, b) => b.timestamp - a.timestamp);
+    return files.slice(0, limit);
+  }
+
+  /** Record a use of filePath, dropping the oldest entries beyond maxEntries */
+  addRecentFile(filePath: string, timestamp: number, maxEntries: number): void {
+    this.native.put(SessionSpace.RecentFiles, filePath, encodeNumbers([timestamp]));
+    const files = this.getRecentFiles();
+    for (const stale of files.slice(maxEntries)) {
+      this.native.delete(SessionSpace.RecentFiles, stale.path);
+    }
+  }
+
+  getWindowBounds(windowId: string): WindowBounds | null {
+    const value = decodeNumbers(this.native.get(SessionSpace.WindowStates, windowId), 4);
+    return value ? { x: value[0], y: value[1], width: value[2], height: value[3] } : null;
+  }
+
+  setWindowBounds(windowId: string, bounds: WindowBounds): void {
+    const { x, y, width, height } = bounds;
+    this.native.put(SessionSpace.WindowStates, windowId, encodeNumbers([x, y, width, height]));
+  }
+
+  windowIds(): string[] {
+    return this.native.keys(SessionSpace.WindowStates);
+  }
+
+  getUsageStats(): SessionUsageStats | null {
+    const value = decodeNumbers(this.native.get(SessionSpace.UsageStats, ''), 3);
+    return value ? { shelfCreations: value[0], filesDropped: value[1], lastUsed: value[2] } : null;
+  }
+
+  setUsageStats(stats: SessionUsageStats): void {
+    const { shelfCreations, filesDropped, lastUsed } = stats;
+    this.native.put(SessionSpace.UsageStats, '', encodeNumbers([shelfCreations, filesDropped, lastUsed]));
+  }
+
+  getLastShelfPosition(): { x: number; y: number } | null {
+    const value = decodeNumbers(this.native.get(SessionSpace.ShelfPosition, ''), 2);
+    return value ? { x: value[0], y: value[1] } : null;
+  }
+
+  setLastShelfPosition(x: number, y: number): void {
+    this.native.put(SessionSpace.ShelfPosition, '', encodeNumbers([x, y]));
+  }
+
+  /** Ids of saved shelves, without reading any of them */
+  shelfIds(): string[] {
+    return this.native.keys(SessionSpace.Shelves);
+  }
+
+  /** Decode one saved shelf; null if missing or unreadable */
+  getShelf<T>(shelfId: string): T | null {
+    const value = this.native.get(SessionSpace.Shelves, shelfId);
+    if (!value) return null;
+    try {
+      return JSON.parse(value.toString('utf8')) as T;
+    } catch {
+      return null;
+    }
+  }
+
+  setShelf(shelfId: string, shelf: unknown): void {
+    this.native.put(SessionSpace.Shelves, shelfId, Buffer.from(JSON.stringify(shelf), 'utf8'));
+  }
+
+  deleteShelf(shelfId: string): void {
+    this.native.delete(SessionSpace.Shelves, shelfId);
+  }
+
+  /** True if nothing was ever written, e.g. before migrating older state */
+  isEmpty(): boolean {
+    const stats = this.native.stats();
+    return stats.snapshotRecords === 0 && stats.logRecords === 0;
+  }
+
+  /** Remove every record, e.g. before an import */
+  clear(): void {
+    for (const space of [
+      SessionSpace.RecentFiles,
+      SessionSpace.WindowStates,
+      SessionSpace.UsageStats,
+      SessionSpace.ShelfPosition,
+      SessionSpace.Shelves,
+    ]) {
+      for (const key of this.native.keys(space)) {
+        this.native.delete(space, key);
+      }
+    }
+  }
+
+  /** Merge the log into the snapshot now, e.g. at quit; synchronous */
+  compact(): void {
+    this.native.compact();
+  }
+
+  stats(): SessionStoreStats {
+    return this.native.stats();
+  }
+}
+
+/**
+ * Open the session store at storePath (the log lives next to it), creating
+ * it if missing. Returns null without the native module; throws an Error
+ * with code NativeErrorCode.SESSION_STORE_FAILED if the log cannot be opened.
+ */
+export function openSessionStore(storePath: string): SessionStore | null {
+  if (!nativeModule) return null;
+  return new SessionStore(new nativeModule.NativeSessionStore(storePath));
+}
@@ -0,0 +1,221 @@
+/**
+ * @fileoverview Columnar shelf item store
+ *
+ * A shelf holding 100k dropped files as ShelfItem objects costs a JS object,
+ * a UUID and a full path string per file, a linear scan per duplicate
+ * check and a structured clone of the whole array per save. The native
+ * store keeps the same items as columns: ids, an interned directory per
+ * item plus its name, kind, size, mtime and flags. Duplicate paths are
+ * found through a hash index, removal is O(1) with slots reused through a
+ * free list, and serialize() returns the whole shelf as one ArrayBuffer
+ * (read by ShelfItemsView in src/shared/shelfItemsPayload.ts).
+ *
+ * Usage:
+ * ```typescript
+ * const store = createShelfStore();
+ * const { ids, added } = store.insertFileList(await statFileList(paths));
+ * store.remove([ids[0]]);
+ * const saved = store.serialize();
+ * const restored = createShelfStore(saved);
+ * ```
+ *
+ * Ids are numbers, stable for the life of an item and never handed to
+ * another item, and survive serialize(). Calls are synchronous and belong
+ * to one thread (the main process). Without the native module (e.g.
+ * Windows) the same API runs on a Map, with the same payloads.
+ *
+ * @module file-ops
+ */
+
+import { FileListView } from '@shared/fileListPayload';
+import {
+  encodeShelfItems,
+  ShelfItemKind,
+  ShelfItemRecord,
+  ShelfItemsView,
+} from '@shared/shelfItemsPayload';
+import { loadFileOpsModule } from './nativeModule';
+
+export { ShelfItemKind };
+export type { ShelfItemRecord };
+
+/** An item to insert; path is required for files and folders */
+export interface ShelfItemInput {
+  kind: ShelfItemKind;
+  path?: string;
+  /** Ignored when path is given: the name is the path's last component */
+  name?: string;
+  flags?: number;
+  size?: number;
+  mtimeMs?: number;
+}
+
+export interface ShelfStoreStats {
+  items: number;
+  /** Items plus free slots */
+  slots: number;
+  directories: number;
+  nameBytes: number;
+  /** Names of removed items, until the name arena is rewritten */
+  garbageBytes: number;
+  memoryBytes: number;
+}
+
+export interface ShelfStore {
+  /** Insert a file-list payload (statFileList()); folders by their directory flag */
+  insertFileList(payload: ArrayBuffer | Uint8Array): { ids: Float64Array; added: number };
+  /** ids[i] is the new id, or that of the item already holding items[i].path */
+  insert(items: ShelfItemInput[]): Float64Array;
+  /** Returns how many of ids were on the shelf */
+  remove(ids: ArrayLike<number>): number;
+  find(path: string): number | null;
+  get(id: number): ShelfItemRecord | undefined;
+  /** Shelf order */
+  ids(): Float64Array;
+  count(): number;
+  clear(): void;
+  serialize(): ArrayBuffer;
+  stats(): ShelfStoreStats;
+}
+
+interface NativeShelfStoreModule {
+  NativeShelfStore: new (payload?: ArrayBuffer | Uint8Array) => ShelfStore;
+}
+
+const nativeModule = loadFileOpsModule<NativeShelfStoreModule>();
+
+export function isNativeShelfStoreAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+function lastComponent(filePath: string): string {
+  return filePath.slice(filePath.lastIndexOf('/') + 1);
+}
+
+/** The same contract on a Map, for platforms without the native module */
+class FallbackShelfStore implements ShelfStore {
+  private readonly items = new Map<number, ShelfItemRecord>();
+  private readonly byPath = new Map<string, number>();
+  private nextId = 1;
+
+  constructor(payload?: ArrayBuffer | Uint8Array) {
+    if (!payload) return;
+    const buffer =
+      payload instanceof ArrayBuffer
+        ? payload
+        : (payload.buffer.slice(payload.byteOffset, payload.byteOffset + payload.byteLength) as ArrayBuffer);
+    for (const item of new ShelfItemsView(buffer).toArray()) {
+      this.items.set(item.id, item);
+      if (item.path !== undefined) this.byPath.set(item.path, item.id);
+      this.nextId = Math.max(this.nextId, item.id + 1);
+    }
+  }
+
+  insertFileList(payload: ArrayBuffer | Uint8Array): { ids: Float64Array; added: number } {
+    const buffer = payload instanceof ArrayBuffer ? payload : (new Uint8Array(payload).buffer as ArrayBuffer);
+    const files = new FileListView(buffer);
+    const before = this.items.size;
+    const inputs: ShelfItemInput[] = [];
+    const flags: number[] = [];
+    for (let i = 0; i < files.length; i++) {
+      inputs.push({
+        kind: files.isDirectory(i) ? ShelfItemKind.Folder : ShelfItemKind.File,
+        path: files.path(i),
+        size: files.size(i),
+      });
+      // FileListFlag bits, as the native store keeps them
+      flags.push(
+        (files.isDirectory(i) ? 1 : 0) | (files.isFile(i) ? 2 : 0) | (files.exists(i) ? 4 : 0)
+      );
+    }
+    const ids = this.insert(inputs.map((input, i) => ({ ...input, flags: flags[i] })));
+    return { ids, added: this.items.size - before };
+  }
+
+  insert(inputs: ShelfItemInput[]): Float64Array {
+    const ids = new Float64Array(inputs.length);
+    inputs.forEach((input, i) => {
+      const existing = input.path ? this.byPath.get(input.path) : undefined;
+      if (existing !== undefined) {
+        ids[i] = existing;
+        return;
+      }
+      const id = this.nextId++;
+      this.items.set(id, {
+        id,
+        kind: input.kind,
+        path: input.path || undefined,
+        name: input.path ? lastComponent(input.path) : (input.name ?? ''),
+        flags: input.flags ?? 0,
+        size: input.size,
+        mtimeMs: input.mtimeMs,
+      });
+      if (input.path) this.byPath.set(input.path, id);
+      ids[i] = id;
+    });
+    return ids;
+  }
+
+  remove(ids: ArrayLike<number>): number {
+    let removed = 0;
+    for (let i = 0; i < ids.length; i++) {
+      const item = this.items.get(ids[i]);
+      if (!item) continue;
+      this.items.delete(item.id);
+      if (item.path !== undefined) this.byPath.delete(item.path);
+      removed++;
+    }
+    return removed;
+  }
+
+  find(filePath: string): number | null {
+    return this.byPath.get(filePath) ?? null;
+  }
+
+  get(id: number): ShelfItemRecord | undefined {
+    const item = this.items.get(id);
+    return item && { ...item };
+  }
+
+  ids(): Float64Array {
+    return Float64Array.from(this.items.keys());
+  }
+
+  count(): number {
+    return this.items.size;
+  }
+
+  clear(): void {
+    this.items.clear();
+    this.byPath.clear();
+  }
+
+  serialize(): ArrayBuffer {
+    return encodeShelfItems([...this.items.values()]);
+  }
+
+  stats(): ShelfStoreStats {
+    const directories = new Set<string>();
+    let nameBytes = 0;
+    for (const item of this.items.values()) {
+      if (item.path !== undefined) directories.add(item.path.slice(0, item.path.length - item.name.length));
+      nameBytes += item.name.length;
+    }
+    return {
+      items: this.items.size,
+      slots: this.items.size,
+      directories: directories.size,
+      nameBytes,
+      garbageBytes: 0,
+      memoryBytes: NaN,
+    };
+  }
+}
+
+/**
+ * An empty store, or one restored from serialize() with the same ids.
+ * Throws if payload is not a serialized shelf.
+ */
+export function createShelfStore(payload?: ArrayBuffer | Uint8Array): ShelfStore {
+  return nativeModule ? new nativeModule.NativeShelfStore(payload) : new FallbackShelfStore(payload);
+}
@@ -0,0 +1,161 @@
+/**
+ * @fileoverview ZIP export of shelf contents
+ *
+ * Writes files and folders into a ZIP archive with the native streaming
+ * writer: chunks of each file are deflated on every core of the shared
+ * pool and written in order, with bounded memory whatever the size of the
+ * shelf. Files whose content is already compressed (photos, video, audio,
+ * archives, Office documents) are stored instead, as is data that deflate
+ * does not shrink. ZIP64 records are added only when the archive needs
+ * them. The archive appears under its name only once it is complete.
+ *
+ * There is no fs fallback: without the native module createZipArchive
+ * rejects with ENOTSUP.
+ *
+ * Usage:
+ * ```typescript
+ * const zip = createZipArchive(
+ *   paths.map(path => ({ path })),
+ *   '/Users/me/Desktop/Shelf.zip',
+ *   {},
+ *   progress => bar.set(progress.bytesRead / progress.bytesTotal)
+ * );
+ * const summary = await zip.done;   // zip.cancel() stops and removes the archive
+ * ```
+ *
+ * @module file-ops
+ */
+
+import { createLogger } from '@main/modules/utils/logger';
+import { NativeErrorCode } from '@shared/nativeErrorCodes';
+import { errnoCode, loadFileOpsModule, toErrnoException } from './nativeModule';
+
+const logger = createLogger('ZipArchive');
+
+export interface ZipSource {
+  path: string;
+  /** Name inside the archive, '/'-separated; defaults to the basename */
+  name?: string;
+}
+
+export interface ZipArchiveOptions {
+  /** zlib level 0-9 (default 6); 0 stores everything */
+  level?: number;
+  /** Bytes per parallel deflate chunk, at least 64KB (default 1MB) */
+  chunkSize?: number;
+  /** Store files whose content is already compressed (default true) */
+  storeCompressed?: boolean;
+}
+
+export interface ZipProgress {
+  bytesRead: number;
+  bytesTotal: number;
+  bytesWritten: number;
+  entriesDone: number;
+  entriesTotal: number;
+}
+
+export interface ZipSummary {
+  entries: number;
+  /** Files stored because their content is already compressed or does not shrink */
+  storedEntries: number;
+  bytesIn: number;
+  /** Size of the archive */
+  bytesOut: number;
+  zip64: boolean;
+  cancelled: boolean;
+  durationMs: number;
+  /** Sources that could not be read; the archive is written without them */
+  skipped: NodeJS.ErrnoException[];
+}
+
+export interface ZipHandle {
+  /** Rejects when the archive itself cannot be written */
+  done: Promise<ZipSummary>;
+  cancel(): void;
+}
+
+interface NativeZipSummary extends Omit<ZipSummary, 'skipped'> {
+  errno: number;
+  skipped: Array<{ path: string; errno: number }>;
+}
+
+interface NativeZipWriter {
+  start(
+    sources: ZipSource[],
+    outputPath: string,
+    options: ZipArchiveOptions,
+    callback: (progress: ZipProgress, summary?: NativeZipSummary) => void
+  ): boolean;
+  cancel(): void;
+  isRunning(): boolean;
+}
+
+interface NativeZipModule {
+  NativeZipWriter: new () => NativeZipWriter;
+}
+
+const nativeModule = loadFileOpsModule<NativeZipModule>();
+
+export function isNativeZipAvailable(): boolean {
+  return nativeModule !== null;
+}
+
+function errnoException(errno: number, syscall: string, filePath: string): NodeJS.ErrnoException {
+  const code = errnoCode(errno);
+  const error = new Error(`${code}: cannot ${syscall} '${filePath}'`) as NodeJS.ErrnoException;
+  error.code = code;
+  error.errno = errno;
+  error.syscall = syscall;
+  error.path = filePath;
+  return error;
+}
+
+export function createZipArchive(
+  sources: ZipSource[],
+  outputPath: string,
+  options: ZipArchiveOptions = {},
+  onProgress?: (progress: ZipProgress) => void
+): ZipHandle {
+  if (!nativeModule) {
+    const error = Object.assign(new Error('ENOTSUP: ZIP export needs the native file-ops module'), {
+      code: 'ENOTSUP',
+      path: outputPath,
+    });
+    return { done: Promise.reject(error), cancel: () => {} };
+  }
+
+  const writer = new nativeModule.NativeZipWriter();
+  const done = new Promise<ZipSummary>((resolve, reject) => {
+    try {
+      writer.start(sources, outputPath, options, (progress, summary) => {
+        if (onProgress) {
+          try {
+            onProgress(progress);
+          } catch (error) {
+            logger.error('ZIP progress handler failed:', error);
+          }
+        }
+        if (!summary) return;
+        if (summary.errno) {
+          reject(errnoException(summary.errno, 'write', outputPath));
+          return;
+        }
+        resolve({
+          entries: summary.entries,
+          storedEntries: summary.storedEntries,
+          bytesIn: summary.bytesIn,
+          bytesOut: summary.bytesOut,
+          zip64: summary.zip64,
+          cancelled: summary.cancelled,
+          durationMs: summary.durationMs,
+          skipped: summary.skipped.map(entry => errnoException(entry.errno, 'read', entry.path)),
+        });
+      });
+    } catch (error: unknown) {
+      reject(toErrnoException(error, NativeErrorCode.ZIP_FAILED, outputPath));
+    }
+  });
+
+  return { done, cancel: () => writer.cancel() };
+}
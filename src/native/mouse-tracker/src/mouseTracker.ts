@@ -24,7 +24,15 @@
 
 import { EventEmitter } from 'events';
 import * as path from 'path';
-import { MouseTracker, MousePosition, PerformanceMetrics } from '@shared/types';
+import {
+  MouseTracker,
+  MousePosition,
+  NativeAllocationStats,
+  NativeProfileOptions,
+  NativeProfileResult,
+  NativeStartupTimings,
+  PerformanceMetrics,
+} from '@shared/types';
 import { createLogger } from '@main/modules/utils/logger';
 import { NativeErrorCode, getNativeErrorDescription } from '@shared/nativeErrorCodes';
 
@@ -39,6 +47,7 @@ interface NativeError {
 interface NativePerformanceMetrics {
   eventsProcessed: number;
   eventsBatched: number;
+  allocations: NativeAllocationStats;
 }
 
 interface NativePositionData {
@@ -48,13 +57,21 @@ interface NativePositionData {
   leftButtonDown?: boolean;
 }
 
+// startAsync() rejections carry the native code and the phases that ran
+interface NativeStartupError extends Error {
+  code?: number;
+  timings?: NativeStartupTimings;
+}
+
 interface NativeMouseTracker {
   start(): boolean;
+  startAsync(): Promise<NativeStartupTimings>;
   stop(): void;
   onMouseMove(callback: (position: NativePositionData) => void): void;
   onButtonStateChange(callback: (leftButton: boolean, rightButton: boolean) => void): void;
   getLastError(): NativeError;
   getPerformanceMetrics(): NativePerformanceMetrics;
+  startProfiling(options: NativeProfileOptions): Promise<NativeProfileResult>;
 }
 
 // Load native module
@@ -104,6 +121,7 @@ export class MacOSMouseTracker extends EventEmitter implements MouseTracker {
   private eventCount: number = 0;
   private lastMetricsUpdate: number = Date.now();
   private metricsInterval?: NodeJS.Timeout;
+  private pendingStart: Promise<NativeStartupTimings> | null = null;
 
   constructor() {
     super();
@@ -197,20 +215,7 @@ export class MacOSMouseTracker extends EventEmitter implements MouseTracker {
         logger.info(
           '✅ Optimized macOS mouse tracking started with event batching and button detection'
         );
-
-        // Health check: Verify mouse events start flowing within 2 seconds
-        setTimeout(() => {
-          if (this.eventCount === 0) {
-            logger.warn(
-              '⚠️ HEALTH CHECK FAILED: No mouse events received within 2 seconds of starting'
-            );
-            logger.warn('This may indicate CGEventTap is not capturing events properly');
-          } else {
-            logger.info(
-              `✅ HEALTH CHECK PASSED: ${this.eventCount} mouse events received in first 2 seconds`
-            );
-          }
-        }, 2000);
+        this.scheduleHealthCheck();
       } else {
         // Get detailed error information
         const error = this.nativeTracker?.getLastError() ?? {
@@ -245,6 +250,65 @@ export class MacOSMouseTracker extends EventEmitter implements MouseTracker {
     }
   }
 
+  /**
+   * Start tracking without blocking the main process. The accessibility
+   * probe and event tap creation run on the native event thread; resolves
+   * with per-phase timings once events can flow and rejects (with `code`)
+   * if tracking could not start.
+   */
+  public startAsync(): Promise<NativeStartupTimings> {
+    if (this.pendingStart) {
+      return this.pendingStart;
+    }
+    if (!this.nativeTracker) {
+      return Promise.reject(new Error('Native tracker not initialized'));
+    }
+
+    const nativeTracker = this.nativeTracker;
+    // The native tracker counts as running from here, so stop() works mid-start
+    this.isActive = true;
+    this.pendingStart = nativeTracker.startAsync().then(
+      timings => {
+        this.pendingStart = null;
+        logger.info('✅ macOS mouse tracking started in the background', timings);
+        this.scheduleHealthCheck();
+        return timings;
+      },
+      (error: NativeStartupError) => {
+        this.pendingStart = null;
+        this.isActive = false;
+        // Joins the event thread the failed start left behind
+        nativeTracker.stop();
+
+        if (error.code === NativeErrorCode.ACCESSIBILITY_PERMISSION_DENIED) {
+          logger.error('⚠️ ACCESSIBILITY PERMISSION REQUIRED');
+          logger.error(getNativeErrorDescription(error.code));
+        }
+        logger.error('Failed to start MouseTracker:', error.message, error.timings);
+        throw error;
+      }
+    );
+    return this.pendingStart;
+  }
+
+  /**
+   * Verify mouse events start flowing within 2 seconds
+   */
+  private scheduleHealthCheck(): void {
+    setTimeout(() => {
+      if (this.eventCount === 0) {
+        logger.warn(
+          '⚠️ HEALTH CHECK FAILED: No mouse events received within 2 seconds of starting'
+        );
+        logger.warn('This may indicate CGEventTap is not capturing events properly');
+      } else {
+        logger.info(
+          `✅ HEALTH CHECK PASSED: ${this.eventCount} mouse events received in first 2 seconds`
+        );
+      }
+    }, 2000);
+  }
+
   /**
    * Stop tracking mouse position
    */
@@ -308,6 +372,24 @@ export class MacOSMouseTracker extends EventEmitter implements MouseTracker {
     }
   }
 
+  /**
+   * Native bytes held by the event queue and batches in delivery
+   */
+  public getNativeAllocations(): NativeAllocationStats | null {
+    return this.getNativePerformanceMetrics()?.allocations ?? null;
+  }
+
+  /**
+   * Sample the event tap and batch threads for options.durationMs and write
+   * their folded stacks to options.outputPath
+   */
+  public startProfiling(options: NativeProfileOptions): Promise<NativeProfileResult> {
+    if (!this.nativeTracker) {
+      return Promise.reject(new Error('Native mouse tracker not initialized'));
+    }
+    return this.nativeTracker.startProfiling(options);
+  }
+
   /**
    * Update mouse position and emit events
    */
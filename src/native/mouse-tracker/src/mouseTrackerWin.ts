@@ -24,7 +24,7 @@
 
 import { EventEmitter } from 'events';
 import * as path from 'path';
-import { MouseTracker, MousePosition, PerformanceMetrics } from '@shared/types';
+import { MouseTracker, MousePosition, PerformanceMetrics, NativeAllocationStats } from '@shared/types';
 import { createLogger } from '@main/modules/utils/logger';
 import { NativeErrorCode } from '@shared/nativeErrorCodes';
 
@@ -39,6 +39,7 @@ interface NativeError {
 interface NativePerformanceMetrics {
   eventsProcessed: number;
   eventsBatched: number;
+  allocations: NativeAllocationStats;
 }
 
 interface NativePositionData {
@@ -275,6 +276,13 @@ export class WindowsMouseTracker extends EventEmitter implements MouseTracker {
     }
   }
 
+  /**
+   * Native bytes held by the event queue and batches in delivery
+   */
+  public getNativeAllocations(): NativeAllocationStats | null {
+    return this.getNativePerformanceMetrics()?.allocations ?? null;
+  }
+
   /**
    * Update mouse position and emit events
    */
@@ -9,8 +9,11 @@
  * Architecture:
  * - CGEventTap for intercepting mouse events at the system level
  * - Separate thread for event processing to avoid blocking
- * - N-API threadsafe functions for JS callbacks
+ * - BatchedDispatcher (napi_smart_ptr.h) delivers button transitions and
+ *   coalesced moves to JS in one threadsafe-function drain per batch
  * - Atomic operations for thread-safe state management
+ * - startAsync() moves the permission probe and tap creation onto the event
+ *   thread and resolves with per-phase timings (async_startup.h)
  *
  * Performance characteristics:
  * - 60fps mouse tracking with <1ms latency
@@ -23,6 +26,8 @@
  *
  * Thread safety:
  * - Event tap callbacks run on separate thread
+ * - The event thread creates, disables and releases the tap; stop() only
+ *   signals and joins it
  * - Uses threadsafe functions for JS communication
  * - Atomic flags for state synchronization
  *
@@ -42,6 +47,11 @@
 #include <chrono>
 #include <deque>
 #include <condition_variable>
+#include <vector>
+
+#include "async_startup.h"
+#include "napi_smart_ptr.h"
+#include "profile_request.h"
 
 // Error codes for better error reporting
 namespace FileCataloger {
@@ -69,7 +79,8 @@ namespace FileCataloger {
     };
 }
 
-// Event data structures
+// Event data structure. Moves travel in the dispatcher's low-priority lane and
+// are coalesced to the latest position; button transitions use the high lane.
 struct MouseData {
     double x;
     double y;
@@ -79,68 +90,27 @@ struct MouseData {
     uint64_t timestamp;
 };
 
-struct ButtonData {
-    bool left_button;
-    bool right_button;
-};
-
-// Forward declarations for callback functions
-static void CallJsMoveCallback(napi_env env, napi_value js_callback, void* context, void* data);
-static void CallJsButtonCallback(napi_env env, napi_value js_callback, void* context, void* data);
+using MouseEventDispatcher = FileCataloger::BatchedDispatcher<MouseData>;
 
-// Memory pool for event data
-template<typename T>
-class ObjectPool {
-private:
-    std::queue<std::unique_ptr<T>> pool_;
-    std::mutex mutex_;
-    size_t max_size_;
-
-public:
-    ObjectPool(size_t max_size = 100) : max_size_(max_size) {}
-
-    std::unique_ptr<T> acquire() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (pool_.empty()) {
-            return std::make_unique<T>();
-        }
-        auto obj = std::move(pool_.front());
-        pool_.pop();
-        return obj;
-    }
-
-    void release(std::unique_ptr<T> obj) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (pool_.size() < max_size_) {
-            pool_.push(std::move(obj));
-        }
-        // If pool is full, let obj destroy itself
-    }
-};
+// Delivery helpers invoked from the dispatcher drain on the JS thread
+static void CallJsMoveCallback(napi_env env, napi_value js_callback, const MouseData& mouse_data);
+static void CallJsButtonCallback(napi_env env, napi_value js_callback, const MouseData& button_data);
 
 class MacOSMouseTracker {
 private:
     napi_env env_;
-    napi_threadsafe_function tsfn_move_;
-    napi_threadsafe_function tsfn_button_;
-    CFMachPortRef event_tap_;
+    napi_ref move_callback_ref_;
+    napi_ref button_callback_ref_;
+    CFMachPortRef event_tap_;   // created, used and released on the event thread only
     std::thread event_thread_;
-    std::thread batch_thread_;
     std::atomic<bool> running_;
+    // Orders Stop() against the event thread settling a startAsync()
+    std::mutex startup_mutex_;
     std::atomic<bool> left_button_down_;
     std::atomic<bool> right_button_down_;
 
     // Event batching
-    std::mutex batch_mutex_;
-    std::condition_variable batch_cv_;
-    std::deque<std::unique_ptr<MouseData>> pending_moves_;
-    std::deque<std::unique_ptr<ButtonData>> pending_buttons_;
-    static constexpr size_t MAX_BATCH_SIZE = 10;
-    static constexpr auto BATCH_INTERVAL = std::chrono::milliseconds(16); // ~60fps
-
-    // Memory pools
-    ObjectPool<MouseData> mouse_data_pool_;
-    ObjectPool<ButtonData> button_data_pool_;
+    MouseEventDispatcher dispatcher_;
 
     // Error tracking
     mutable std::mutex error_mutex_;
@@ -186,12 +156,16 @@ private:
 public:
     MacOSMouseTracker(napi_env env)
         : env_(env),
-          tsfn_move_(nullptr),
-          tsfn_button_(nullptr),
+          move_callback_ref_(nullptr),
+          button_callback_ref_(nullptr),
           event_tap_(nullptr),
           running_(false),
           left_button_down_(false),
           right_button_down_(false),
+          dispatcher_([this](napi_env env, napi_value, std::vector<MouseData>& buttons,
+                             std::vector<MouseData>& moves) {
+              DeliverBatch(env, buttons, moves);
+          }),
           last_error_(FileCataloger::ErrorCode::SUCCESS, "No error"),
           events_processed_(0),
           events_batched_(0),
@@ -200,13 +174,14 @@ public:
     
     ~MacOSMouseTracker() {
         Stop();
-        if (tsfn_move_) {
-            napi_release_threadsafe_function(tsfn_move_, napi_tsfn_release);
-            tsfn_move_ = nullptr;
+        dispatcher_.Stop();
+        if (move_callback_ref_) {
+            napi_delete_reference(env_, move_callback_ref_);
+            move_callback_ref_ = nullptr;
         }
-        if (tsfn_button_) {
-            napi_release_threadsafe_function(tsfn_button_, napi_tsfn_release);
-            tsfn_button_ = nullptr;
+        if (button_callback_ref_) {
+            napi_delete_reference(env_, button_callback_ref_);
+            button_callback_ref_ = nullptr;
         }
     }
 
@@ -227,76 +202,44 @@ public:
     }
     
     void SetMoveCallback(napi_value callback) {
-        // Clean up old callback
-        if (tsfn_move_) {
-            napi_release_threadsafe_function(tsfn_move_, napi_tsfn_release);
-            tsfn_move_ = nullptr;
+        // Replace old callback; delivery resolves the reference on each drain
+        if (move_callback_ref_) {
+            napi_delete_reference(env_, move_callback_ref_);
+            move_callback_ref_ = nullptr;
         }
-        
-        // Create new thread-safe function
-        napi_value async_resource_name;
-        napi_create_string_utf8(env_, "MouseMoveCallback", NAPI_AUTO_LENGTH, &async_resource_name);
-        
-        napi_create_threadsafe_function(
-            env_,
-            callback,
-            nullptr,
-            async_resource_name,
-            0,
-            1,
-            nullptr,
-            nullptr,
-            nullptr,
-            CallJsMoveCallback,
-            &tsfn_move_
-        );
+        napi_create_reference(env_, callback, 1, &move_callback_ref_);
     }
-    
+
     void SetButtonCallback(napi_value callback) {
-        // Clean up old callback
-        if (tsfn_button_) {
-            napi_release_threadsafe_function(tsfn_button_, napi_tsfn_release);
-            tsfn_button_ = nullptr;
+        if (button_callback_ref_) {
+            napi_delete_reference(env_, button_callback_ref_);
+            button_callback_ref_ = nullptr;
         }
-        
-        // Create new thread-safe function
-        napi_value async_resource_name;
-        napi_create_string_utf8(env_, "ButtonStateCallback", NAPI_AUTO_LENGTH, &async_resource_name);
-        
-        napi_create_threadsafe_function(
-            env_,
-            callback,
-            nullptr,
-            async_resource_name,
-            0,
-            1,
-            nullptr,
-            nullptr,
-            nullptr,
-            CallJsButtonCallback,
-            &tsfn_button_
-        );
+        napi_create_reference(env_, callback, 1, &button_callback_ref_);
     }
-    
+
     bool Start() {
         if (running_.load()) {
             SetError(FileCataloger::ErrorCode::ALREADY_INITIALIZED, "Mouse tracker is already running");
             return true;
         }
 
+        // Join the thread of a start that failed on it
+        if (event_thread_.joinable()) {
+            Stop();
+        }
+
         // Clear any previous errors
         ClearError();
 
-        // Check for accessibility permissions
-        if (!AXIsProcessTrusted()) {
-            std::cerr << "Accessibility permission not granted. Please enable in System Preferences." << std::endl;
-
-            // Prompt user to grant permission
-            NSDictionary* options = @{(__bridge id)kAXTrustedCheckOptionPrompt: @YES};
-            AXIsProcessTrustedWithOptions((__bridge CFDictionaryRef)options);
+        if (!ProbeAccessibility()) {
+            return false;
+        }
 
-            SetError(FileCataloger::ErrorCode::ACCESSIBILITY_PERMISSION_DENIED,
-                    "Accessibility permission required. Please grant permission in System Preferences > Security & Privacy > Accessibility");
+        // Start event delivery before any producer can push
+        if (dispatcher_.Start(env_, nullptr, "MouseTrackerDispatch") != napi_ok) {
+            SetError(FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                    "Failed to create event dispatcher");
             return false;
         }
 
@@ -305,15 +248,11 @@ public:
         // Start event processing thread
         try {
             event_thread_ = std::thread([this]() {
-                this->RunEventLoop();
-            });
-
-            // Start batch processing thread
-            batch_thread_ = std::thread([this]() {
-                this->RunBatchProcessor();
+                this->RunEventLoop(nullptr);
             });
         } catch (const std::exception& e) {
             running_ = false;
+            dispatcher_.Stop();
             SetError(FileCataloger::ErrorCode::THREAD_CREATE_FAILED,
                     std::string("Failed to create event processing thread: ") + e.what());
             return false;
@@ -321,39 +260,139 @@ public:
 
         return true;
     }
-    
-    void Stop() {
-        if (!running_.load()) {
-            return;
+
+    /**
+     * Start without blocking the JS thread. Only the dispatcher and the
+     * thread are created here; the permission probe and the event tap run
+     * on the event thread, which settles the returned promise once events
+     * can flow. Returns nullptr with a pending exception if no promise
+     * could be created.
+     */
+    napi_value StartAsync() {
+        napi_value promise;
+        auto startup = FileCataloger::AsyncStartup::Create(env_, "MouseTrackerStartup", &promise);
+        if (!startup) {
+            return nullptr;
         }
 
-        running_ = false;
+        if (running_.load()) {
+            startup->Complete(FileCataloger::StartupReport());
+            return promise;
+        }
+
+        if (event_thread_.joinable()) {
+            Stop();
+        }
+        ClearError();
 
-        if (event_tap_) {
-            CGEventTapEnable(event_tap_, false);
+        if (dispatcher_.Start(env_, nullptr, "MouseTrackerDispatch") != napi_ok) {
+            FailStartup(startup.get(), FileCataloger::StartupReport(),
+                        FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                        "Failed to create event dispatcher");
+            startup->SetBlockingMs(startup->MsSinceRequest());
+            return promise;
         }
 
-        // Notify batch processor to wake up and exit
-        batch_cv_.notify_all();
+        running_ = true;
 
-        if (event_thread_.joinable()) {
-            event_thread_.join();
+        try {
+            event_thread_ = std::thread([this, startup]() {
+                this->RunEventLoop(startup);
+            });
+        } catch (const std::exception& e) {
+            running_ = false;
+            dispatcher_.Stop();
+            FailStartup(startup.get(), FileCataloger::StartupReport(),
+                        FileCataloger::ErrorCode::THREAD_CREATE_FAILED,
+                        std::string("Failed to create event processing thread: ") + e.what());
         }
 
-        if (batch_thread_.joinable()) {
-            batch_thread_.join();
+        startup->SetBlockingMs(startup->MsSinceRequest());
+        return promise;
+    }
+
+    void Stop() {
+        // A start that failed on the event thread leaves it to be joined
+        if (!running_.load() && !event_thread_.joinable()) {
+            return;
         }
 
-        // Run loop source cleanup handled by RAII wrapper
+        {
+            // A startAsync() still on the event thread sees this before it settles
+            std::lock_guard<std::mutex> lock(startup_mutex_);
+            running_ = false;
+        }
 
-        if (event_tap_) {
-            CFRelease(event_tap_);
-            event_tap_ = nullptr;
+        // The event thread disables and releases its tap on the way out
+        if (event_thread_.joinable()) {
+            event_thread_.join();
         }
+
+        // Producers are gone; undelivered events are discarded
+        dispatcher_.Stop();
     }
     
 private:
-    void RunEventLoop() {
+    static bool ProbeAccessibility() {
+        if (AXIsProcessTrusted()) {
+            return true;
+        }
+
+        std::cerr << "Accessibility permission not granted. Please enable in System Preferences." << std::endl;
+
+        // Prompt user to grant permission
+        NSDictionary* options = @{(__bridge id)kAXTrustedCheckOptionPrompt: @YES};
+        AXIsProcessTrustedWithOptions((__bridge CFDictionaryRef)options);
+        return false;
+    }
+
+    void FailStartup(FileCataloger::AsyncStartup* startup, FileCataloger::StartupReport report,
+                     FileCataloger::ErrorCode code, const std::string& message) {
+        SetError(code, message);
+        if (startup) {
+            report.code = static_cast<int>(code);
+            report.message = message;
+            report.totalMs = startup->MsSinceRequest();
+            startup->Complete(std::move(report));
+        }
+    }
+
+    // Event thread: a start that fails here releases its dispatcher at once
+    // rather than leaving it to the next start() or stop(). Nothing pushes
+    // by now, and BatchedDispatcher::Stop() may be called from any thread.
+    void FailOnEventThread(FileCataloger::AsyncStartup* startup, FileCataloger::StartupReport report,
+                           FileCataloger::ErrorCode code, const std::string& message) {
+        running_ = false;
+        FailStartup(startup, std::move(report), code, message);
+        dispatcher_.Stop();
+    }
+
+    // startup is null for the synchronous Start(), which probed permission
+    void RunEventLoop(std::shared_ptr<FileCataloger::AsyncStartup> startup) {
+        FileCataloger::ProfiledThread profiled("tracker");
+        FileCataloger::StartupReport report;
+        if (startup) {
+            report.threadSpawnMs = startup->MsSinceRequest();
+
+            auto probe_start = FileCataloger::AsyncStartup::Clock::now();
+            bool trusted = ProbeAccessibility();
+            report.permissionMs = FileCataloger::AsyncStartup::MsSince(probe_start);
+            if (!trusted) {
+                FailOnEventThread(startup.get(), std::move(report),
+                                  FileCataloger::ErrorCode::ACCESSIBILITY_PERMISSION_DENIED,
+                                  "Accessibility permission required. Please grant permission in System Preferences > Security & Privacy > Accessibility");
+                return;
+            }
+            // stop() during the probe; it joins this thread and stops the dispatcher
+            if (!running_.load()) {
+                FailStartup(startup.get(), std::move(report),
+                            FileCataloger::ErrorCode::MOUSE_TRACKER_START_FAILED,
+                            "Mouse tracker stopped during startup");
+                return;
+            }
+        }
+        auto hook_start = FileCataloger::AsyncStartup::Clock::now();
+
         // Set up event tap for mouse events
         CGEventMask event_mask = 
             CGEventMaskBit(kCGEventMouseMoved) |
@@ -375,31 +414,52 @@ private:
         
         if (!event_tap_) {
             std::cerr << "Failed to create event tap" << std::endl;
-            SetError(FileCataloger::ErrorCode::EVENT_TAP_CREATE_FAILED,
-                    "Failed to create CGEventTap. This may be due to missing accessibility permissions.");
-            running_ = false;
+            report.hookMs = FileCataloger::AsyncStartup::MsSince(hook_start);
+            FailOnEventThread(startup.get(), std::move(report),
+                              FileCataloger::ErrorCode::EVENT_TAP_CREATE_FAILED,
+                              "Failed to create CGEventTap. This may be due to missing accessibility permissions.");
             return;
         }
         
         run_loop_wrapper_->create(event_tap_);
         if (!run_loop_wrapper_->isValid()) {
             std::cerr << "Failed to create run loop source" << std::endl;
-            SetError(FileCataloger::ErrorCode::RUNLOOP_CREATE_FAILED,
-                    "Failed to create run loop source for event tap");
             CFRelease(event_tap_);
             event_tap_ = nullptr;
-            running_ = false;
+            report.hookMs = FileCataloger::AsyncStartup::MsSince(hook_start);
+            FailOnEventThread(startup.get(), std::move(report),
+                              FileCataloger::ErrorCode::RUNLOOP_CREATE_FAILED,
+                              "Failed to create run loop source for event tap");
             return;
         }
 
         CGEventTapEnable(event_tap_, true);
+
+        if (startup) {
+            report.hookMs = FileCataloger::AsyncStartup::MsSince(hook_start);
+            // Resolve only if no stop() came first; one that comes later
+            // stops a tracker whose start has already resolved
+            std::lock_guard<std::mutex> lock(startup_mutex_);
+            if (running_.load()) {
+                report.totalMs = startup->MsSinceRequest();
+                startup->Complete(std::move(report));
+            } else {
+                FailStartup(startup.get(), std::move(report),
+                            FileCataloger::ErrorCode::MOUSE_TRACKER_START_FAILED,
+                            "Mouse tracker stopped during startup");
+            }
+        }
         
         // Run the event loop with reduced timeout for better responsiveness
         while (running_.load()) {
             CFRunLoopRunInMode(kCFRunLoopDefaultMode, 0.01, false); // 10ms timeout
         }
 
-        // RAII wrapper handles cleanup
+        // Tear down on the thread that owns the tap and its run loop source
+        CGEventTapEnable(event_tap_, false);
+        run_loop_wrapper_ = std::make_unique<RunLoopSourceWrapper>();
+        CFRelease(event_tap_);
+        event_tap_ = nullptr;
     }
     
     static CGEventRef EventCallback(CGEventTapProxy proxy, CGEventType type,
@@ -454,89 +514,45 @@ private:
     
     // Event batching methods
     void QueueMouseEvent(double x, double y, bool left_button, bool right_button, bool omit_button_state = false) {
-        auto data = mouse_data_pool_.acquire();
-        data->x = x;
-        data->y = y;
-        data->left_button = left_button;
-        data->right_button = right_button;
-        data->omit_button_state = omit_button_state;
-        data->timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        MouseData data;
+        data.x = x;
+        data.y = y;
+        data.left_button = left_button;
+        data.right_button = right_button;
+        data.omit_button_state = omit_button_state;
+        data.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
 
-        std::lock_guard<std::mutex> lock(batch_mutex_);
-        pending_moves_.push_back(std::move(data));
-
-        // If batch is full, notify processor immediately
-        if (pending_moves_.size() >= MAX_BATCH_SIZE) {
-            batch_cv_.notify_one();
-        }
+        dispatcher_.Push(data, MouseEventDispatcher::Priority::Low);
     }
 
     void QueueButtonEvent(bool left_button, bool right_button) {
-        auto data = button_data_pool_.acquire();
-        data->left_button = left_button;
-        data->right_button = right_button;
+        MouseData data = {};
+        data.left_button = left_button;
+        data.right_button = right_button;
 
-        std::lock_guard<std::mutex> lock(batch_mutex_);
-        pending_buttons_.push_back(std::move(data));
-        batch_cv_.notify_one();
+        // State transitions jump the queue and trigger an immediate drain
+        dispatcher_.Push(data, MouseEventDispatcher::Priority::High);
     }
 
-    void RunBatchProcessor() {
-        while (running_.load(std::memory_order_relaxed)) {
-            std::unique_lock<std::mutex> lock(batch_mutex_);
-
-            // Wait for events or timeout
-            batch_cv_.wait_for(lock, BATCH_INTERVAL, [this] {
-                return !pending_moves_.empty() || !pending_buttons_.empty() || !running_.load();
-            });
-
-            if (!running_.load()) {
-                break;
-            }
-
-            // Process mouse moves (send only the latest position to avoid flooding)
-            if (!pending_moves_.empty()) {
-                auto latest_move = std::move(pending_moves_.back());
-                pending_moves_.clear(); // Discard intermediate positions
-
-                lock.unlock();
-                if (tsfn_move_) {
-                    MouseData* raw_data = latest_move.release();
-                    auto result = napi_call_threadsafe_function(
-                        tsfn_move_,
-                        raw_data,
-                        napi_tsfn_nonblocking
-                    );
-                    if (result != napi_ok) {
-                        // Return to pool if call failed - data was not transferred to JS
-                        mouse_data_pool_.release(std::unique_ptr<MouseData>(raw_data));
-                    } else {
-                        events_batched_.fetch_add(1, std::memory_order_relaxed);
-                    }
+    // Runs on the JS thread, once per dispatcher drain
+    void DeliverBatch(napi_env env, std::vector<MouseData>& buttons, std::vector<MouseData>& moves) {
+        // Send all button changes first so JS sees transitions before positions
+        if (!buttons.empty() && button_callback_ref_) {
+            napi_value callback;
+            if (napi_get_reference_value(env, button_callback_ref_, &callback) == napi_ok && callback) {
+                for (const MouseData& button : buttons) {
+                    CallJsButtonCallback(env, callback, button);
                 }
-                lock.lock();
             }
+        }
 
-            // Process button events (send all button changes)
-            while (!pending_buttons_.empty()) {
-                auto button_event = std::move(pending_buttons_.front());
-                pending_buttons_.pop_front();
-
-                lock.unlock();
-                if (tsfn_button_) {
-                    ButtonData* raw_data = button_event.release();
-                    auto result = napi_call_threadsafe_function(
-                        tsfn_button_,
-                        raw_data,
-                        napi_tsfn_nonblocking
-                    );
-                    if (result != napi_ok) {
-                        // Return to pool if call failed - data was not transferred to JS
-                        button_data_pool_.release(std::unique_ptr<ButtonData>(raw_data));
-                    }
-                }
-                lock.lock();
+        // Send only the latest position to avoid flooding
+        if (!moves.empty() && move_callback_ref_) {
+            napi_value callback;
+            if (napi_get_reference_value(env, move_callback_ref_, &callback) == napi_ok && callback) {
+                CallJsMoveCallback(env, callback, moves.back());
+                events_batched_.fetch_add(1, std::memory_order_relaxed);
             }
         }
     }
@@ -547,96 +563,77 @@ public:
     uint64_t getEventsBatched() const { return events_batched_.load(); }
 };
     
-    static void CallJsMoveCallback(napi_env env, napi_value js_callback, void* context, void* data) {
-        if (!env || !data) {
-            return;
-        }
+static void CallJsMoveCallback(napi_env env, napi_value js_callback, const MouseData& mouse_data) {
+    napi_status status;
+    napi_value position_obj;
+    status = napi_create_object(env, &position_obj);
+    if (status != napi_ok) {
+        return;
+    }
 
-        MouseData* mouse_data = static_cast<MouseData*>(data);
+    // Create and set position values with error checking
+    napi_value x_val, y_val, timestamp_val;
+    status = napi_create_double(env, mouse_data.x, &x_val);
+    if (status == napi_ok) {
+        napi_set_named_property(env, position_obj, "x", x_val);
+    }
 
-        napi_status status;
-        napi_value position_obj;
-        status = napi_create_object(env, &position_obj);
-        if (status != napi_ok) {
-            delete mouse_data;
-            return;
-        }
+    status = napi_create_double(env, mouse_data.y, &y_val);
+    if (status == napi_ok) {
+        napi_set_named_property(env, position_obj, "y", y_val);
+    }
 
-        // Create and set position values with error checking
-        napi_value x_val, y_val, timestamp_val;
-        status = napi_create_double(env, mouse_data->x, &x_val);
-        if (status == napi_ok) {
-            napi_set_named_property(env, position_obj, "x", x_val);
-        }
+    status = napi_create_double(env, static_cast<double>(mouse_data.timestamp), &timestamp_val);
+    if (status == napi_ok) {
+        napi_set_named_property(env, position_obj, "timestamp", timestamp_val);
+    }
 
-        status = napi_create_double(env, mouse_data->y, &y_val);
+    // Only include button state if it's relevant (not omitted for move-only events)
+    if (!mouse_data.omit_button_state) {
+        napi_value left_button_val, right_button_val;
+        status = napi_get_boolean(env, mouse_data.left_button, &left_button_val);
         if (status == napi_ok) {
-            napi_set_named_property(env, position_obj, "y", y_val);
+            napi_set_named_property(env, position_obj, "leftButtonDown", left_button_val);
         }
 
-        status = napi_create_double(env, static_cast<double>(mouse_data->timestamp), &timestamp_val);
+        status = napi_get_boolean(env, mouse_data.right_button, &right_button_val);
         if (status == napi_ok) {
-            napi_set_named_property(env, position_obj, "timestamp", timestamp_val);
+            napi_set_named_property(env, position_obj, "rightButtonDown", right_button_val);
         }
-
-        // Only include button state if it's relevant (not omitted for move-only events)
-        if (!mouse_data->omit_button_state) {
-            napi_value left_button_val, right_button_val;
-            status = napi_get_boolean(env, mouse_data->left_button, &left_button_val);
-            if (status == napi_ok) {
-                napi_set_named_property(env, position_obj, "leftButtonDown", left_button_val);
-            }
-
-            status = napi_get_boolean(env, mouse_data->right_button, &right_button_val);
-            if (status == napi_ok) {
-                napi_set_named_property(env, position_obj, "rightButtonDown", right_button_val);
-            }
-        }
-
-        // Call JavaScript callback
-        napi_value global;
-        status = napi_get_global(env, &global);
-        if (status == napi_ok) {
-            napi_value argv[] = { position_obj };
-            napi_value result;
-            napi_call_function(env, global, js_callback, 1, argv, &result);
-        }
-
-        delete mouse_data;
     }
-    
-    static void CallJsButtonCallback(napi_env env, napi_value js_callback, void* context, void* data) {
-        if (!env || !data) {
-            return;
-        }
 
-        ButtonData* button_data = static_cast<ButtonData*>(data);
+    // Call JavaScript callback
+    napi_value global;
+    status = napi_get_global(env, &global);
+    if (status == napi_ok) {
+        napi_value argv[] = { position_obj };
+        napi_value result;
+        napi_call_function(env, global, js_callback, 1, argv, &result);
+    }
+}
 
-        napi_value left_button_val, right_button_val;
-        napi_status status;
+static void CallJsButtonCallback(napi_env env, napi_value js_callback, const MouseData& button_data) {
+    napi_value left_button_val, right_button_val;
+    napi_status status;
 
-        status = napi_get_boolean(env, button_data->left_button, &left_button_val);
-        if (status != napi_ok) {
-            delete button_data;
-            return;
-        }
-
-        status = napi_get_boolean(env, button_data->right_button, &right_button_val);
-        if (status != napi_ok) {
-            delete button_data;
-            return;
-        }
+    status = napi_get_boolean(env, button_data.left_button, &left_button_val);
+    if (status != napi_ok) {
+        return;
+    }
 
-        napi_value global;
-        status = napi_get_global(env, &global);
-        if (status == napi_ok) {
-            napi_value argv[] = { left_button_val, right_button_val };
-            napi_value result;
-            napi_call_function(env, global, js_callback, 2, argv, &result);
-        }
+    status = napi_get_boolean(env, button_data.right_button, &right_button_val);
+    if (status != napi_ok) {
+        return;
+    }
 
-        delete button_data;
+    napi_value global;
+    status = napi_get_global(env, &global);
+    if (status == napi_ok) {
+        napi_value argv[] = { left_button_val, right_button_val };
+        napi_value result;
+        napi_call_function(env, global, js_callback, 2, argv, &result);
     }
+}
 
 // N-API wrapper functions
 static napi_value CreateTracker(napi_env env, napi_callback_info info) {
@@ -678,6 +675,18 @@ static napi_value Start(napi_env env, napi_callback_info info) {
     return result;
 }
 
+static napi_value StartAsync(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    void* data;
+
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, &data);
+
+    MacOSMouseTracker* tracker;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&tracker));
+
+    return tracker->StartAsync();
+}
+
 static napi_value Stop(napi_env env, napi_callback_info info) {
     napi_value this_arg;
     void* data;
@@ -792,24 +801,43 @@ static napi_value GetPerformanceMetrics(napi_env env, napi_callback_info info) {
     napi_set_named_property(env, metrics_obj, "eventsProcessed", processed_val);
     napi_set_named_property(env, metrics_obj, "eventsBatched", batched_val);
 
+    // Native bytes held by the event queue and batches being delivered
+    napi_set_named_property(env, metrics_obj, "allocations", FileCataloger::CreateAllocationStats(env));
+
     return metrics_obj;
 }
 
+// startProfiling({ durationMs, hz, outputPath }): folded stacks of the
+// event tap and batch threads, written when the promise resolves
+static napi_value StartProfiling(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+
+    if (argc < 1) {
+        napi_throw_type_error(env, nullptr, "startProfiling expects an options object");
+        return nullptr;
+    }
+    return FileCataloger::ProfileRequest::StartProfiling(env, argv[0]);
+}
+
 // Module initialization
 static napi_value Init(napi_env env, napi_value exports) {
     napi_value tracker_class;
     
     napi_property_descriptor properties[] = {
         { "start", nullptr, Start, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "startAsync", nullptr, StartAsync, nullptr, nullptr, nullptr, napi_default, nullptr },
         { "stop", nullptr, Stop, nullptr, nullptr, nullptr, napi_default, nullptr },
         { "onMouseMove", nullptr, OnMouseMove, nullptr, nullptr, nullptr, napi_default, nullptr },
         { "onButtonStateChange", nullptr, OnButtonStateChange, nullptr, nullptr, nullptr, napi_default, nullptr },
         { "getLastError", nullptr, GetLastError, nullptr, nullptr, nullptr, napi_default, nullptr },
-        { "getPerformanceMetrics", nullptr, GetPerformanceMetrics, nullptr, nullptr, nullptr, napi_default, nullptr }
+        { "getPerformanceMetrics", nullptr, GetPerformanceMetrics, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "startProfiling", nullptr, StartProfiling, nullptr, nullptr, nullptr, napi_default, nullptr }
     };
 
     napi_define_class(env, "MacOSMouseTracker", NAPI_AUTO_LENGTH,
-                     CreateTracker, nullptr, 6, properties, &tracker_class);
+                     CreateTracker, nullptr, 8, properties, &tracker_class);
     
     napi_set_named_property(env, exports, "MacOSMouseTracker", tracker_class);
     
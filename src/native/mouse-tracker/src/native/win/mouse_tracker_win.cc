@@ -9,7 +9,8 @@
  * Architecture:
  * - SetWindowsHookEx with WH_MOUSE_LL for low-level mouse events
  * - Separate message pump thread for event processing
- * - N-API threadsafe functions for JS callbacks
+ * - BatchedDispatcher (napi_smart_ptr.h) delivers button transitions and
+ *   coalesced moves to JS in one threadsafe-function drain per batch
  * - Atomic operations for thread-safe state management
  *
  * Performance characteristics:
@@ -38,6 +39,9 @@
 #include <deque>
 #include <condition_variable>
 #include <string>
+#include <vector>
+
+#include "napi_smart_ptr.h"
 
 // Error codes for better error reporting
 namespace FileCataloger {
@@ -63,53 +67,22 @@ namespace FileCataloger {
     };
 }
 
-// Event data structures
+// Event data structure. Moves travel in the dispatcher's low-priority lane and
+// are coalesced to the latest position; button transitions use the high lane.
 struct MouseData {
     double x;
     double y;
     bool left_button;
     bool right_button;
-    bool omit_button_state;
+    bool omit_button_state; // Don't send button state if it hasn't changed
     uint64_t timestamp;
 };
 
-struct ButtonData {
-    bool left_button;
-    bool right_button;
-};
+using MouseEventDispatcher = FileCataloger::BatchedDispatcher<MouseData>;
 
-// Forward declarations for callback functions
-static void CallJsMoveCallback(napi_env env, napi_value js_callback, void* context, void* data);
-static void CallJsButtonCallback(napi_env env, napi_value js_callback, void* context, void* data);
-
-// Memory pool for event data
-template<typename T>
-class ObjectPool {
-private:
-    std::queue<std::unique_ptr<T>> pool_;
-    std::mutex mutex_;
-    size_t max_size_;
-
-public:
-    ObjectPool(size_t max_size = 100) : max_size_(max_size) {}
-
-    std::unique_ptr<T> acquire() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (pool_.empty()) {
-            return std::make_unique<T>();
-        }
-        auto obj = std::move(pool_.front());
-        pool_.pop();
-        return obj;
-    }
-
-    void release(std::unique_ptr<T> obj) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (pool_.size() < max_size_) {
-            pool_.push(std::move(obj));
-        }
-    }
-};
+// Delivery helpers invoked from the dispatcher drain on the JS thread
+static void CallJsMoveCallback(napi_env env, napi_value js_callback, const MouseData& mouse_data);
+static void CallJsButtonCallback(napi_env env, napi_value js_callback, const MouseData& button_data);
 
 // Forward declaration
 class WindowsMouseTracker;
@@ -121,27 +94,17 @@ static std::mutex g_instance_mutex;
 class WindowsMouseTracker {
 private:
     napi_env env_;
-    napi_threadsafe_function tsfn_move_;
-    napi_threadsafe_function tsfn_button_;
+    napi_ref move_callback_ref_;
+    napi_ref button_callback_ref_;
     HHOOK mouse_hook_;
     std::thread event_thread_;
-    std::thread batch_thread_;
     std::atomic<bool> running_;
     std::atomic<bool> left_button_down_;
     std::atomic<bool> right_button_down_;
     DWORD thread_id_;
 
     // Event batching
-    std::mutex batch_mutex_;
-    std::condition_variable batch_cv_;
-    std::deque<std::unique_ptr<MouseData>> pending_moves_;
-    std::deque<std::unique_ptr<ButtonData>> pending_buttons_;
-    static constexpr size_t MAX_BATCH_SIZE = 10;
-    static constexpr auto BATCH_INTERVAL = std::chrono::milliseconds(16); // ~60fps
-
-    // Memory pools
-    ObjectPool<MouseData> mouse_data_pool_;
-    ObjectPool<ButtonData> button_data_pool_;
+    MouseEventDispatcher dispatcher_;
 
     // Error tracking
     mutable std::mutex error_mutex_;
@@ -154,13 +117,17 @@ private:
 public:
     WindowsMouseTracker(napi_env env)
         : env_(env),
-          tsfn_move_(nullptr),
-          tsfn_button_(nullptr),
+          move_callback_ref_(nullptr),
+          button_callback_ref_(nullptr),
           mouse_hook_(nullptr),
           running_(false),
           left_button_down_(false),
           right_button_down_(false),
           thread_id_(0),
+          dispatcher_([this](napi_env env, napi_value, std::vector<MouseData>& buttons,
+                             std::vector<MouseData>& moves) {
+              DeliverBatch(env, buttons, moves);
+          }),
           last_error_(FileCataloger::ErrorCode::SUCCESS, "No error"),
           events_processed_(0),
           events_batched_(0) {
@@ -168,13 +135,14 @@ public:
 
     ~WindowsMouseTracker() {
         Stop();
-        if (tsfn_move_) {
-            napi_release_threadsafe_function(tsfn_move_, napi_tsfn_release);
-            tsfn_move_ = nullptr;
+        dispatcher_.Stop();
+        if (move_callback_ref_) {
+            napi_delete_reference(env_, move_callback_ref_);
+            move_callback_ref_ = nullptr;
         }
-        if (tsfn_button_) {
-            napi_release_threadsafe_function(tsfn_button_, napi_tsfn_release);
-            tsfn_button_ = nullptr;
+        if (button_callback_ref_) {
+            napi_delete_reference(env_, button_callback_ref_);
+            button_callback_ref_ = nullptr;
         }
     }
 
@@ -195,51 +163,20 @@ public:
     }
 
     void SetMoveCallback(napi_value callback) {
-        if (tsfn_move_) {
-            napi_release_threadsafe_function(tsfn_move_, napi_tsfn_release);
-            tsfn_move_ = nullptr;
+        // Replace old callback; delivery resolves the reference on each drain
+        if (move_callback_ref_) {
+            napi_delete_reference(env_, move_callback_ref_);
+            move_callback_ref_ = nullptr;
         }
-
-        napi_value async_resource_name;
-        napi_create_string_utf8(env_, "MouseMoveCallback", NAPI_AUTO_LENGTH, &async_resource_name);
-
-        napi_create_threadsafe_function(
-            env_,
-            callback,
-            nullptr,
-            async_resource_name,
-            0,
-            1,
-            nullptr,
-            nullptr,
-            nullptr,
-            CallJsMoveCallback,
-            &tsfn_move_
-        );
+        napi_create_reference(env_, callback, 1, &move_callback_ref_);
     }
 
     void SetButtonCallback(napi_value callback) {
-        if (tsfn_button_) {
-            napi_release_threadsafe_function(tsfn_button_, napi_tsfn_release);
-            tsfn_button_ = nullptr;
+        if (button_callback_ref_) {
+            napi_delete_reference(env_, button_callback_ref_);
+            button_callback_ref_ = nullptr;
         }
-
-        napi_value async_resource_name;
-        napi_create_string_utf8(env_, "ButtonStateCallback", NAPI_AUTO_LENGTH, &async_resource_name);
-
-        napi_create_threadsafe_function(
-            env_,
-            callback,
-            nullptr,
-            async_resource_name,
-            0,
-            1,
-            nullptr,
-            nullptr,
-            nullptr,
-            CallJsButtonCallback,
-            &tsfn_button_
-        );
+        napi_create_reference(env_, callback, 1, &button_callback_ref_);
     }
 
     bool Start() {
@@ -249,6 +186,14 @@ public:
         }
 
         ClearError();
+
+        // Start event delivery before any producer can push
+        if (dispatcher_.Start(env_, nullptr, "MouseTrackerDispatch") != napi_ok) {
+            SetError(FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                    "Failed to create event dispatcher");
+            return false;
+        }
+
         running_ = true;
 
         // Set global instance for hook callback
@@ -263,11 +208,6 @@ public:
                 this->RunEventLoop();
             });
 
-            // Start batch processing thread
-            batch_thread_ = std::thread([this]() {
-                this->RunBatchProcessor();
-            });
-
             // Wait a bit for the hook to be installed
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
@@ -277,6 +217,7 @@ public:
                     std::lock_guard<std::mutex> lock(g_instance_mutex);
                     g_tracker_instance = nullptr;
                 }
+                dispatcher_.Stop();
                 SetError(FileCataloger::ErrorCode::HOOK_INSTALL_FAILED,
                         "Failed to install low-level mouse hook");
                 return false;
@@ -288,6 +229,7 @@ public:
                 std::lock_guard<std::mutex> lock(g_instance_mutex);
                 g_tracker_instance = nullptr;
             }
+            dispatcher_.Stop();
             SetError(FileCataloger::ErrorCode::THREAD_CREATE_FAILED,
                     std::string("Failed to create event processing thread: ") + e.what());
             return false;
@@ -308,22 +250,18 @@ public:
             PostThreadMessage(thread_id_, WM_QUIT, 0, 0);
         }
 
-        // Notify batch processor to wake up and exit
-        batch_cv_.notify_all();
-
         if (event_thread_.joinable()) {
             event_thread_.join();
         }
 
-        if (batch_thread_.joinable()) {
-            batch_thread_.join();
-        }
-
         // Clear global instance
         {
             std::lock_guard<std::mutex> lock(g_instance_mutex);
             g_tracker_instance = nullptr;
         }
+
+        // Producers are gone; undelivered events are discarded
+        dispatcher_.Stop();
     }
 
 private:
@@ -423,85 +361,45 @@ private:
     }
 
     void QueueMouseEvent(double x, double y, bool left_button, bool right_button, bool omit_button_state = false) {
-        auto data = mouse_data_pool_.acquire();
-        data->x = x;
-        data->y = y;
-        data->left_button = left_button;
-        data->right_button = right_button;
-        data->omit_button_state = omit_button_state;
-        data->timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        MouseData data;
+        data.x = x;
+        data.y = y;
+        data.left_button = left_button;
+        data.right_button = right_button;
+        data.omit_button_state = omit_button_state;
+        data.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
 
-        std::lock_guard<std::mutex> lock(batch_mutex_);
-        pending_moves_.push_back(std::move(data));
-
-        if (pending_moves_.size() >= MAX_BATCH_SIZE) {
-            batch_cv_.notify_one();
-        }
+        dispatcher_.Push(data, MouseEventDispatcher::Priority::Low);
     }
 
     void QueueButtonEvent(bool left_button, bool right_button) {
-        auto data = button_data_pool_.acquire();
-        data->left_button = left_button;
-        data->right_button = right_button;
+        MouseData data = {};
+        data.left_button = left_button;
+        data.right_button = right_button;
 
-        std::lock_guard<std::mutex> lock(batch_mutex_);
-        pending_buttons_.push_back(std::move(data));
-        batch_cv_.notify_one();
+        // State transitions jump the queue and trigger an immediate drain
+        dispatcher_.Push(data, MouseEventDispatcher::Priority::High);
     }
 
-    void RunBatchProcessor() {
-        while (running_.load(std::memory_order_relaxed)) {
-            std::unique_lock<std::mutex> lock(batch_mutex_);
-
-            batch_cv_.wait_for(lock, BATCH_INTERVAL, [this] {
-                return !pending_moves_.empty() || !pending_buttons_.empty() || !running_.load();
-            });
-
-            if (!running_.load()) {
-                break;
-            }
-
-            // Process mouse moves (send only the latest position)
-            if (!pending_moves_.empty()) {
-                auto latest_move = std::move(pending_moves_.back());
-                pending_moves_.clear();
-
-                lock.unlock();
-                if (tsfn_move_) {
-                    MouseData* raw_data = latest_move.release();
-                    auto result = napi_call_threadsafe_function(
-                        tsfn_move_,
-                        raw_data,
-                        napi_tsfn_nonblocking
-                    );
-                    if (result != napi_ok) {
-                        mouse_data_pool_.release(std::unique_ptr<MouseData>(raw_data));
-                    } else {
-                        events_batched_.fetch_add(1, std::memory_order_relaxed);
-                    }
+    // Runs on the JS thread, once per dispatcher drain
+    void DeliverBatch(napi_env env, std::vector<MouseData>& buttons, std::vector<MouseData>& moves) {
+        // Send all button changes first so JS sees transitions before positions
+        if (!buttons.empty() && button_callback_ref_) {
+            napi_value callback;
+            if (napi_get_reference_value(env, button_callback_ref_, &callback) == napi_ok && callback) {
+                for (const MouseData& button : buttons) {
+                    CallJsButtonCallback(env, callback, button);
                 }
-                lock.lock();
             }
+        }
 
-            // Process button events
-            while (!pending_buttons_.empty()) {
-                auto button_event = std::move(pending_buttons_.front());
-                pending_buttons_.pop_front();
-
-                lock.unlock();
-                if (tsfn_button_) {
-                    ButtonData* raw_data = button_event.release();
-                    auto result = napi_call_threadsafe_function(
-                        tsfn_button_,
-                        raw_data,
-                        napi_tsfn_nonblocking
-                    );
-                    if (result != napi_ok) {
-                        button_data_pool_.release(std::unique_ptr<ButtonData>(raw_data));
-                    }
-                }
-                lock.lock();
+        // Send only the latest position
+        if (!moves.empty() && move_callback_ref_) {
+            napi_value callback;
+            if (napi_get_reference_value(env, move_callback_ref_, &callback) == napi_ok && callback) {
+                CallJsMoveCallback(env, callback, moves.back());
+                events_batched_.fetch_add(1, std::memory_order_relaxed);
             }
         }
     }
@@ -511,45 +409,38 @@ public:
     uint64_t getEventsBatched() const { return events_batched_.load(); }
 };
 
-static void CallJsMoveCallback(napi_env env, napi_value js_callback, void* context, void* data) {
-    if (!env || !data) {
-        return;
-    }
-
-    MouseData* mouse_data = static_cast<MouseData*>(data);
-
+static void CallJsMoveCallback(napi_env env, napi_value js_callback, const MouseData& mouse_data) {
     napi_status status;
     napi_value position_obj;
     status = napi_create_object(env, &position_obj);
     if (status != napi_ok) {
-        delete mouse_data;
         return;
     }
 
     napi_value x_val, y_val, timestamp_val;
-    status = napi_create_double(env, mouse_data->x, &x_val);
+    status = napi_create_double(env, mouse_data.x, &x_val);
     if (status == napi_ok) {
         napi_set_named_property(env, position_obj, "x", x_val);
     }
 
-    status = napi_create_double(env, mouse_data->y, &y_val);
+    status = napi_create_double(env, mouse_data.y, &y_val);
     if (status == napi_ok) {
         napi_set_named_property(env, position_obj, "y", y_val);
     }
 
-    status = napi_create_double(env, static_cast<double>(mouse_data->timestamp), &timestamp_val);
+    status = napi_create_double(env, static_cast<double>(mouse_data.timestamp), &timestamp_val);
     if (status == napi_ok) {
         napi_set_named_property(env, position_obj, "timestamp", timestamp_val);
     }
 
-    if (!mouse_data->omit_button_state) {
+    if (!mouse_data.omit_button_state) {
         napi_value left_button_val, right_button_val;
-        status = napi_get_boolean(env, mouse_data->left_button, &left_button_val);
+        status = napi_get_boolean(env, mouse_data.left_button, &left_button_val);
         if (status == napi_ok) {
             napi_set_named_property(env, position_obj, "leftButtonDown", left_button_val);
         }
 
-        status = napi_get_boolean(env, mouse_data->right_button, &right_button_val);
+        status = napi_get_boolean(env, mouse_data.right_button, &right_button_val);
         if (status == napi_ok) {
             napi_set_named_property(env, position_obj, "rightButtonDown", right_button_val);
         }
@@ -562,29 +453,19 @@ static void CallJsMoveCallback(napi_env env, napi_value js_callback, void* conte
         napi_value result;
         napi_call_function(env, global, js_callback, 1, argv, &result);
     }
-
-    delete mouse_data;
 }
 
-static void CallJsButtonCallback(napi_env env, napi_value js_callback, void* context, void* data) {
-    if (!env || !data) {
-        return;
-    }
-
-    ButtonData* button_data = static_cast<ButtonData*>(data);
-
+static void CallJsButtonCallback(napi_env env, napi_value js_callback, const MouseData& button_data) {
     napi_value left_button_val, right_button_val;
     napi_status status;
 
-    status = napi_get_boolean(env, button_data->left_button, &left_button_val);
+    status = napi_get_boolean(env, button_data.left_button, &left_button_val);
     if (status != napi_ok) {
-        delete button_data;
         return;
     }
 
-    status = napi_get_boolean(env, button_data->right_button, &right_button_val);
+    status = napi_get_boolean(env, button_data.right_button, &right_button_val);
     if (status != napi_ok) {
-        delete button_data;
         return;
     }
 
@@ -595,8 +476,6 @@ static void CallJsButtonCallback(napi_env env, napi_value js_callback, void* con
         napi_value result;
         napi_call_function(env, global, js_callback, 2, argv, &result);
     }
-
-    delete button_data;
 }
 
 // N-API wrapper functions
@@ -748,6 +627,9 @@ static napi_value GetPerformanceMetrics(napi_env env, napi_callback_info info) {
     napi_set_named_property(env, metrics_obj, "eventsProcessed", processed_val);
     napi_set_named_property(env, metrics_obj, "eventsBatched", batched_val);
 
+    // Native bytes held by the event queue and batches being delivered
+    napi_set_named_property(env, metrics_obj, "allocations", FileCataloger::CreateAllocationStats(env));
+
     return metrics_obj;
 }
 
@@ -0,0 +1,70 @@
+# binding.gyp - Build configuration for the native shelf search module
+#
+# This file configures the compilation of the shelf-search module, which
+# ranks shelf items by fuzzy name match over a packed, case-folded name
+# column, and sorts names in natural order with precomputed collation keys.
+#
+# Build command: node-gyp rebuild
+# Output:
+#   macOS: build/Release/shelf_search_darwin.node
+#   Linux: build/Release/shelf_search_linux.node (tests and benchmarks)
+#
+# Requirements:
+# - macOS: Xcode Command Line Tools
+# - Linux: g++ with C++17 support
+# - Python 3.x
+# - node-gyp installed globally
+#
+# APIs used:
+# - SSE2 / NEON mask filter (src/internal/fuzzy_match.cc)
+# - Plain N-API (node_api.h), no node-addon-api dependency
+#
+# Windows is not built yet; the TypeScript wrapper falls back to a plain
+# JavaScript subsequence match there.
+
+{
+  "targets": [
+    {
+      "target_name": "shelf_search_<(OS)",
+      "include_dirs": [
+        "src",
+        "src/internal",
+        "../common"
+      ],
+      "sources": [
+        "src/native/shelf_search.cc",
+        "src/internal/fuzzy_match.cc",
+        "src/internal/name_index.cc",
+        "src/internal/natural_sort.cc"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        ["OS=='mac'", {
+          "target_name": "shelf_search_darwin",
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "10.15",
+            "GCC_OPTIMIZATION_LEVEL": "3",
+            "LLVM_LTO": "YES",
+            "CLANG_CXX_LANGUAGE_STANDARD": "c++17"
+          }
+        }],
+        ["OS=='linux'", {
+          "target_name": "shelf_search_linux",
+          "cflags_cc": [ "-O3", "-std=c++17" ]
+        }],
+        ["OS=='win'", {
+          "type": "none",
+          "sources!": [
+            "src/native/shelf_search.cc",
+            "src/internal/fuzzy_match.cc",
+            "src/internal/name_index.cc",
+            "src/internal/natural_sort.cc"
+          ]
+        }]
+      ]
+    }
+  ]
+}
@@ -0,0 +1,11 @@
+/**
+ * @fileoverview Shelf search module entry point
+ *
+ * This file re-exports the shelf search functionality from the src directory.
+ * It allows for cleaner imports: `from '@native/shelf-search'` instead of `from '@native/shelf-search/src'`
+ *
+ * @module shelf-search
+ */
+
+export { NameIndex, isNativeSearchAvailable, naturalSortOrder, compareNatural } from './src/index';
+export type { NameSearchOptions, NameSearchResult } from './src/index';
@@ -0,0 +1,15 @@
+/**
+ * @fileoverview Native shelf search for FileCataloger
+ *
+ * Supported platforms:
+ * - macOS (darwin) and Linux with the native module (SSE2/NEON mask filter)
+ * - Everything else through a JavaScript subsequence match with the same API
+ *
+ * Natural-order sorting of names (naturalSortOrder) uses the same module.
+ *
+ * @module shelf-search
+ */
+
+export { NameIndex, isNativeSearchAvailable } from './nameIndex';
+export { naturalSortOrder, compareNatural } from './naturalSort';
+export type { NameSearchOptions, NameSearchResult } from './nameIndex';
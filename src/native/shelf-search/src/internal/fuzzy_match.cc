@@ -0,0 +1,226 @@
+/**
+ * @file fuzzy_match.cc
+ * @brief Folding, masks, fzf v1 scoring and the mask filter kernels
+ */
+
+#include "fuzzy_match.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SHELF_SEARCH_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SHELF_SEARCH_NEON 1
+#endif
+
+namespace FileCataloger {
+
+namespace {
+
+// Scoring constants from fzf (src/algo/algo.go)
+constexpr int32_t kScoreMatch = 16;
+constexpr int32_t kScoreGapStart = -3;
+constexpr int32_t kScoreGapExtension = -1;
+constexpr int32_t kBonusBoundary = kScoreMatch / 2;
+constexpr int32_t kBonusNonWord = kScoreMatch / 2;
+constexpr int32_t kBonusCamel123 = kBonusBoundary + kScoreGapExtension;
+constexpr int32_t kBonusConsecutive = -(kScoreGapStart + kScoreGapExtension);
+constexpr int32_t kBonusBoundaryWhite = kBonusBoundary + 2;
+constexpr int32_t kBonusBoundaryDelimiter = kBonusBoundary + 1;
+constexpr int32_t kBonusFirstCharMultiplier = 2;
+
+// Ordered so that everything up to NonWord is a word boundary
+enum CharClass : uint8_t { White, Delimiter, NonWord, Lower, Upper, Number };
+
+CharClass ClassOf(uint8_t c) {
+    if (c >= 'a' && c <= 'z') return Lower;
+    if (c >= 'A' && c <= 'Z') return Upper;
+    if (c >= '0' && c <= '9') return Number;
+    if (c == ' ' || c == '\t') return White;
+    if (c == '/' || c == ',' || c == ':' || c == ';' || c == '|') return Delimiter;
+    // Non-ASCII bytes are almost always letters in file names
+    return c >= 0x80 ? Lower : NonWord;
+}
+
+int32_t BonusFor(CharClass previous, CharClass current) {
+    if (previous <= NonWord && current > NonWord) {
+        return previous == White ? kBonusBoundaryWhite
+             : previous == Delimiter ? kBonusBoundaryDelimiter
+             : kBonusBoundary;
+    }
+    if ((previous == Lower && current == Upper) || (previous != Number && current == Number)) {
+        return kBonusCamel123;
+    }
+    if (current == White) return kBonusBoundaryWhite;
+    if (current <= NonWord) return kBonusNonWord;
+    return 0;
+}
+
+// Letters and digits get a bit each; other ASCII and UTF-8 bytes share the rest
+const std::array<uint64_t, 256>& MaskBits() {
+    static const std::array<uint64_t, 256> bits = [] {
+        std::array<uint64_t, 256> table{};
+        for (unsigned c = 0; c < 256; c++) {
+            unsigned bit = c >= 'a' && c <= 'z' ? c - 'a'
+                         : c >= '0' && c <= '9' ? 26 + (c - '0')
+                         : c < 0x80 ? 36 + c % 12
+                         : 48 + (c & 15);
+            table[c] = uint64_t(1) << bit;
+        }
+        return table;
+    }();
+    return bits;
+}
+
+} // namespace
+
+std::string FoldCase(const char* text, size_t length) {
+    std::string folded(text, length);
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = static_cast<uint8_t>(folded[i]);
+        if (c >= 'A' && c <= 'Z') {
+            folded[i] = static_cast<char>(c + 32);
+        } else if (c == 0xC3 && i + 1 < length) {
+            // U+00C0-U+00DE except U+00D7 (multiplication sign)
+            uint8_t next = static_cast<uint8_t>(folded[i + 1]);
+            if (next >= 0x80 && next <= 0x9E && next != 0x97) {
+                folded[i + 1] = static_cast<char>(next + 0x20);
+            }
+            i++;
+        }
+    }
+    return folded;
+}
+
+uint64_t CharMask(const char* folded, size_t length) {
+    const auto& bits = MaskBits();
+    uint64_t mask = 0;
+    for (size_t i = 0; i < length; i++) {
+        mask |= bits[static_cast<uint8_t>(folded[i])];
+    }
+    return mask;
+}
+
+bool ScoreMatch(const char* folded, const char* original, size_t length,
+                const char* query, size_t queryLength, int32_t* score) {
+    if (queryLength == 0) {
+        *score = 0;
+        return true;
+    }
+
+    // Forward: the earliest position where the whole query has been seen
+    size_t end = 0;
+    for (size_t q = 0; q < queryLength; q++) {
+        const void* hit = memchr(folded + end, query[q], length - end);
+        if (!hit) {
+            return false;
+        }
+        end = static_cast<const char*>(hit) - folded + 1;
+    }
+
+    // Backward from there: the latest start, which gives the tightest window
+    size_t start = end - 1;
+    for (size_t q = queryLength; q-- > 0;) {
+        while (folded[start] != query[q]) {
+            start--;
+        }
+        if (q > 0) {
+            start--;
+        }
+    }
+
+    int32_t total = 0;
+    int32_t consecutive = 0;
+    int32_t firstBonus = 0;
+    bool inGap = false;
+    size_t q = 0;
+    CharClass previous = start > 0 ? ClassOf(static_cast<uint8_t>(original[start - 1])) : White;
+    for (size_t i = start; i < end; i++) {
+        CharClass current = ClassOf(static_cast<uint8_t>(original[i]));
+        if (folded[i] == query[q]) {
+            total += kScoreMatch;
+            int32_t bonus = BonusFor(previous, current);
+            if (consecutive == 0) {
+                firstBonus = bonus;
+            } else {
+                // A run keeps the bonus of its first character
+                if (bonus >= kBonusBoundary && bonus > firstBonus) {
+                    firstBonus = bonus;
+                }
+                bonus = std::max(std::max(bonus, firstBonus), kBonusConsecutive);
+            }
+            total += q == 0 ? bonus * kBonusFirstCharMultiplier : bonus;
+            inGap = false;
+            consecutive++;
+            q++;
+        } else {
+            total += inGap ? kScoreGapExtension : kScoreGapStart;
+            inGap = true;
+            consecutive = 0;
+            firstBonus = 0;
+        }
+        previous = current;
+    }
+    *score = total;
+    return true;
+}
+
+void FilterByMask(const uint64_t* masks, uint32_t count, uint64_t need, std::vector<uint32_t>* out,
+                  MatchKernel kernel) {
+    uint32_t i = 0;
+#if defined(SHELF_SEARCH_SSE2)
+    if (kernel == MatchKernel::Auto) {
+        const __m128i needVector = _mm_set1_epi64x(static_cast<long long>(need));
+        // SSE2 has no 64-bit compare: both 32-bit halves must be equal
+        auto test = [&](uint32_t index) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + index));
+            __m128i equal = _mm_cmpeq_epi32(_mm_and_si128(value, needVector), needVector);
+            equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+            return static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(equal)));
+        };
+        for (; i + 8 <= count; i += 8) {
+            uint32_t bits = test(i) | test(i + 2) << 2 | test(i + 4) << 4 | test(i + 6) << 6;
+            while (bits != 0) {
+                out->push_back(i + __builtin_ctz(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+#elif defined(SHELF_SEARCH_NEON)
+    if (kernel == MatchKernel::Auto) {
+        const uint64x2_t needVector = vdupq_n_u64(need);
+        auto test = [&](uint32_t index) {
+            uint64x2_t equal = vceqq_u64(vandq_u64(vld1q_u64(masks + index), needVector), needVector);
+            return static_cast<uint32_t>((vgetq_lane_u64(equal, 0) & 1) | (vgetq_lane_u64(equal, 1) & 2));
+        };
+        for (; i + 8 <= count; i += 8) {
+            uint32_t bits = test(i) | test(i + 2) << 2 | test(i + 4) << 4 | test(i + 6) << 6;
+            while (bits != 0) {
+                out->push_back(i + __builtin_ctz(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+#else
+    (void)kernel;
+#endif
+    for (; i < count; i++) {
+        if ((masks[i] & need) == need) {
+            out->push_back(i);
+        }
+    }
+}
+
+bool HasSimdFilter() {
+#if defined(SHELF_SEARCH_SSE2) || defined(SHELF_SEARCH_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,55 @@
+/**
+ * @file fuzzy_match.h
+ * @brief Case folding, character masks and fzf-style match scoring
+ *
+ * A query matches a name when its characters appear in the name in order
+ * (a subsequence), ignoring case. Matches are scored the way fzf's v1
+ * algorithm does: the shortest window ending at the first complete match
+ * is found by a forward and a backward pass, then scored with bonuses for
+ * characters at word boundaries, camelCase humps and digit runs, and
+ * penalties for gaps. "shrp" ranks "Shelf Report.pdf" above
+ * "washer parts.txt".
+ *
+ * Folding is ASCII plus the Latin-1 letters (U+00C0-U+00DE), and keeps
+ * byte lengths, so positions in the folded and original names agree.
+ *
+ * CharMask summarizes which characters a folded string contains in 64
+ * bits. A name can only match a query whose mask is a subset of its own,
+ * which rejects most names with one AND per name; FilterByMask runs that
+ * test over a whole mask column with SSE2 or NEON.
+ */
+
+#ifndef SHELF_SEARCH_FUZZY_MATCH_H
+#define SHELF_SEARCH_FUZZY_MATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FileCataloger {
+
+enum class MatchKernel {
+    Auto,    // SIMD when the target supports it
+    Scalar
+};
+
+// Same length as the input; see the file comment for what is folded
+std::string FoldCase(const char* text, size_t length);
+
+uint64_t CharMask(const char* folded, size_t length);
+
+// Score of folded query against a name, or false if it does not match.
+// folded and original are the same name before and after FoldCase.
+bool ScoreMatch(const char* folded, const char* original, size_t length,
+                const char* query, size_t queryLength, int32_t* score);
+
+// Append to out the index of every mask that contains all bits of need
+void FilterByMask(const uint64_t* masks, uint32_t count, uint64_t need, std::vector<uint32_t>* out,
+                  MatchKernel kernel = MatchKernel::Auto);
+
+bool HasSimdFilter();
+
+} // namespace FileCataloger
+
+#endif // SHELF_SEARCH_FUZZY_MATCH_H
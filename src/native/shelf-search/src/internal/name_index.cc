@@ -0,0 +1,125 @@
+/**
+ * @file name_index.cc
+ * @brief Packed name column and ranked fuzzy search
+ */
+
+#include "name_index.h"
+
+#include <algorithm>
+
+namespace FileCataloger {
+
+namespace {
+
+bool IsSubsequence(const std::string& needle, const std::string& haystack) {
+    size_t i = 0;
+    for (size_t j = 0; i < needle.size() && j < haystack.size(); j++) {
+        if (needle[i] == haystack[j]) {
+            i++;
+        }
+    }
+    return i == needle.size();
+}
+
+} // namespace
+
+NameIndex::NameIndex(MatchKernel kernel) : kernel_(kernel), offsets_{0} {}
+
+void NameIndex::Append(const char* name, size_t length) {
+    std::string folded = FoldCase(name, length);
+    original_.append(name, length);
+    folded_.append(folded);
+    offsets_.push_back(static_cast<uint32_t>(original_.size()));
+    masks_.push_back(CharMask(folded.data(), folded.size()));
+}
+
+void NameIndex::Clear() {
+    original_.clear();
+    folded_.clear();
+    offsets_.assign(1, 0);
+    masks_.clear();
+    lastValid_ = false;
+    lastMatches_.clear();
+}
+
+size_t NameIndex::MemoryUsage() const {
+    return original_.capacity() + folded_.capacity() + offsets_.capacity() * sizeof(uint32_t) +
+           masks_.capacity() * sizeof(uint64_t) + lastMatches_.capacity() * sizeof(uint32_t) +
+           candidates_.capacity() * sizeof(uint32_t) + matches_.capacity() * sizeof(Match);
+}
+
+void NameIndex::Search(const std::string& rawQuery, uint32_t limit, NameSearchResult* result) {
+    result->indices.clear();
+    result->scores.clear();
+    result->narrowed = false;
+
+    const uint32_t size = Size();
+    const std::string query = FoldCase(rawQuery.data(), rawQuery.size());
+    if (query.empty()) {
+        uint32_t count = limit == 0 ? size : std::min(limit, size);
+        for (uint32_t i = 0; i < count; i++) {
+            result->indices.push_back(i);
+        }
+        result->scores.assign(count, 0);
+        result->total = size;
+        result->scanned = 0;
+        lastValid_ = false;
+        return;
+    }
+
+    const uint64_t need = CharMask(query.data(), query.size());
+    candidates_.clear();
+    if (lastValid_ && IsSubsequence(lastQuery_, query)) {
+        // Every match of the new query also matched the previous one
+        for (uint32_t index : lastMatches_) {
+            if ((masks_[index] & need) == need) {
+                candidates_.push_back(index);
+            }
+        }
+        size_t before = candidates_.size();
+        FilterByMask(masks_.data() + lastSize_, size - lastSize_, need, &candidates_, kernel_);
+        for (size_t i = before; i < candidates_.size(); i++) {
+            candidates_[i] += lastSize_;
+        }
+        result->scanned = static_cast<uint32_t>(lastMatches_.size()) + (size - lastSize_);
+        result->narrowed = true;
+    } else {
+        FilterByMask(masks_.data(), size, need, &candidates_, kernel_);
+        result->scanned = size;
+    }
+
+    matches_.clear();
+    lastMatches_.clear();
+    for (uint32_t index : candidates_) {
+        const uint32_t offset = offsets_[index];
+        int32_t score;
+        if (ScoreMatch(folded_.data() + offset, original_.data() + offset, Length(index), query.data(),
+                       query.size(), &score)) {
+            matches_.push_back({index, score});
+            lastMatches_.push_back(index);
+        }
+    }
+    lastValid_ = true;
+    lastQuery_ = query;
+    lastSize_ = size;
+
+    auto better = [this](const Match& a, const Match& b) {
+        if (a.score != b.score) return a.score > b.score;
+        uint32_t lengthA = Length(a.index);
+        uint32_t lengthB = Length(b.index);
+        if (lengthA != lengthB) return lengthA < lengthB;
+        return a.index < b.index;
+    };
+    const size_t count = limit == 0 ? matches_.size() : std::min<size_t>(limit, matches_.size());
+    std::partial_sort(matches_.begin(), matches_.begin() + count, matches_.end(), better);
+
+    result->total = static_cast<uint32_t>(matches_.size());
+    result->indices.reserve(count);
+    result->scores.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        result->indices.push_back(matches_[i].index);
+        result->scores.push_back(matches_[i].score);
+    }
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,78 @@
+/**
+ * @file name_index.h
+ * @brief Packed name column with ranked fuzzy search
+ *
+ * Names are stored back to back in two byte buffers, as given and case
+ * folded, with an offset per name and a 64-bit character mask per name.
+ * A search first filters the mask column (FilterByMask, SIMD), then
+ * scores the survivors against the folded buffer (ScoreMatch) and sorts
+ * them by score, shorter names first on ties.
+ *
+ * Typing narrows the previous query: when it is a subsequence of the new
+ * one, only its matches and names appended since are scanned. Any other
+ * query, or Clear(), scans the whole column again.
+ *
+ * Not thread-safe; the binding uses one index per shelf on the JS thread.
+ */
+
+#ifndef SHELF_SEARCH_NAME_INDEX_H
+#define SHELF_SEARCH_NAME_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "fuzzy_match.h"
+
+namespace FileCataloger {
+
+struct NameSearchResult {
+    std::vector<uint32_t> indices;  // best match first, at most the limit
+    std::vector<int32_t> scores;    // parallel to indices
+    uint32_t total = 0;             // matches before the limit was applied
+    uint32_t scanned = 0;           // names that went through the mask filter
+    bool narrowed = false;          // reused the previous query's matches
+};
+
+class NameIndex {
+public:
+    explicit NameIndex(MatchKernel kernel = MatchKernel::Auto);
+
+    void Append(const char* name, size_t length);
+    void Append(const std::string& name) { Append(name.data(), name.size()); }
+    void Clear();
+
+    uint32_t Size() const { return static_cast<uint32_t>(masks_.size()); }
+    size_t MemoryUsage() const;
+
+    // An empty query matches every name in index order. limit 0: no limit.
+    void Search(const std::string& query, uint32_t limit, NameSearchResult* result);
+
+private:
+    struct Match {
+        uint32_t index;
+        int32_t score;
+    };
+
+    uint32_t Length(uint32_t index) const { return offsets_[index + 1] - offsets_[index]; }
+
+    MatchKernel kernel_;
+    std::string original_;
+    std::string folded_;
+    std::vector<uint32_t> offsets_;   // name i is [offsets_[i], offsets_[i + 1])
+    std::vector<uint64_t> masks_;
+
+    // Previous search, for narrowing
+    bool lastValid_ = false;
+    std::string lastQuery_;             // folded
+    std::vector<uint32_t> lastMatches_; // ascending
+    uint32_t lastSize_ = 0;             // names in the index at the time
+
+    std::vector<uint32_t> candidates_;
+    std::vector<Match> matches_;
+};
+
+} // namespace FileCataloger
+
+#endif // SHELF_SEARCH_NAME_INDEX_H
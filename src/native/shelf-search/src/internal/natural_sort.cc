@@ -0,0 +1,216 @@
+/**
+ * @file natural_sort.cc
+ * @brief Natural-order collation keys and a radix sort over them
+ */
+
+#include "natural_sort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "fuzzy_match.h"
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr char kDigitTag = '0';
+constexpr uint32_t kLongRun = 255;
+
+// Buckets this small are finished with an insertion sort
+constexpr uint32_t kInsertionThreshold = 32;
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Leading zeros and significant digits of the run starting at text[start]
+void ScanDigits(const std::string& text, size_t start, size_t* digits, size_t* end) {
+    size_t i = start;
+    while (i < text.size() && text[i] == '0') {
+        i++;
+    }
+    *digits = i;
+    while (i < text.size() && IsDigit(text[i])) {
+        i++;
+    }
+    *end = i;
+}
+
+} // namespace
+
+void AppendCollationKey(const char* name, size_t length, std::string* key) {
+    const std::string folded = FoldCase(name, length);
+    size_t i = 0;
+    while (i < folded.size()) {
+        if (!IsDigit(folded[i])) {
+            key->push_back(folded[i++]);
+            continue;
+        }
+        size_t digits, end;
+        ScanDigits(folded, i, &digits, &end);
+        const size_t count = end - digits;
+        key->push_back(kDigitTag);
+        if (count < kLongRun) {
+            key->push_back(static_cast<char>(count));
+        } else {
+            key->push_back(static_cast<char>(kLongRun));
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                key->push_back(static_cast<char>((count >> shift) & 0xFF));
+            }
+        }
+        key->append(folded, digits, count);
+        i = end;
+    }
+}
+
+int CompareNatural(const char* a, size_t aLength, const char* b, size_t bLength) {
+    const std::string x = FoldCase(a, aLength);
+    const std::string y = FoldCase(b, bLength);
+    size_t i = 0, j = 0;
+    while (i < x.size() && j < y.size()) {
+        const bool xDigit = IsDigit(x[i]);
+        const bool yDigit = IsDigit(y[j]);
+        if (xDigit && yDigit) {
+            size_t xDigits, xEnd, yDigits, yEnd;
+            ScanDigits(x, i, &xDigits, &xEnd);
+            ScanDigits(y, j, &yDigits, &yEnd);
+            const size_t xCount = xEnd - xDigits;
+            const size_t yCount = yEnd - yDigits;
+            if (xCount != yCount) {
+                return xCount < yCount ? -1 : 1;
+            }
+            int order = memcmp(x.data() + xDigits, y.data() + yDigits, xCount);
+            if (order != 0) {
+                return order;
+            }
+            i = xEnd;
+            j = yEnd;
+            continue;
+        }
+        const uint8_t xByte = xDigit ? kDigitTag : static_cast<uint8_t>(x[i]);
+        const uint8_t yByte = yDigit ? kDigitTag : static_cast<uint8_t>(y[j]);
+        if (xByte != yByte) {
+            return xByte < yByte ? -1 : 1;
+        }
+        i++;
+        j++;
+    }
+    if (i < x.size()) return 1;
+    if (j < y.size()) return -1;
+    return 0;
+}
+
+void CollationKeys::Append(const char* name, size_t length) {
+    AppendCollationKey(name, length, &bytes_);
+    offsets_.push_back(static_cast<uint32_t>(bytes_.size()));
+}
+
+void CollationKeys::Clear() {
+    bytes_.clear();
+    offsets_.assign(1, 0);
+}
+
+void CollationKeys::Reserve(uint32_t names, size_t bytes) {
+    offsets_.reserve(static_cast<size_t>(names) + 1);
+    bytes_.reserve(bytes);
+}
+
+int CollationKeys::Compare(uint32_t a, uint32_t b) const {
+    const uint32_t lengthA = Length(a);
+    const uint32_t lengthB = Length(b);
+    int order = memcmp(Key(a), Key(b), std::min(lengthA, lengthB));
+    if (order != 0) {
+        return order;
+    }
+    return lengthA < lengthB ? -1 : lengthA > lengthB ? 1 : 0;
+}
+
+void CollationKeys::InsertionSort(uint32_t* items, uint32_t count, uint32_t depth) const {
+    // Keys in a bucket share their first depth bytes
+    auto less = [this, depth](uint32_t a, uint32_t b) {
+        const uint32_t lengthA = Length(a) - depth;
+        const uint32_t lengthB = Length(b) - depth;
+        int order = memcmp(Key(a) + depth, Key(b) + depth, std::min(lengthA, lengthB));
+        return order < 0 || (order == 0 && lengthA < lengthB);
+    };
+    for (uint32_t i = 1; i < count; i++) {
+        const uint32_t item = items[i];
+        uint32_t j = i;
+        for (; j > 0 && less(item, items[j - 1]); j--) {
+            items[j] = items[j - 1];
+        }
+        items[j] = item;
+    }
+}
+
+void CollationKeys::Sort(std::vector<uint32_t>* order) const {
+    const uint32_t count = Size();
+    order->resize(count);
+    std::iota(order->begin(), order->end(), 0u);
+    if (count < 2) {
+        return;
+    }
+
+    struct Range {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t depth;
+    };
+    std::vector<Range> pending{{0, count, 0}};
+    std::vector<uint32_t> scratch(count);
+    // Bucket of each item at the current depth: 0 for keys that end there,
+    // byte + 1 otherwise. Read once per pass, so the keys are touched once.
+    std::vector<uint16_t> buckets(count);
+    uint32_t* items = order->data();
+
+    while (!pending.empty()) {
+        const Range range = pending.back();
+        pending.pop_back();
+        const uint32_t size = range.end - range.begin;
+        if (size < kInsertionThreshold) {
+            InsertionSort(items + range.begin, size, range.depth);
+            continue;
+        }
+
+        uint32_t counts[257] = {};
+        for (uint32_t i = range.begin; i < range.end; i++) {
+            const uint32_t item = items[i];
+            const uint16_t bucket = Length(item) > range.depth ? Key(item)[range.depth] + 1 : 0;
+            buckets[i] = bucket;
+            counts[bucket]++;
+        }
+
+        // A shared byte (a common prefix such as "img_") needs no moves
+        const uint16_t first = buckets[range.begin];
+        if (counts[first] == size) {
+            if (first != 0) {
+                pending.push_back({range.begin, range.end, range.depth + 1});
+            }
+            continue;
+        }
+
+        uint32_t starts[257];
+        uint32_t next = range.begin;
+        for (int bucket = 0; bucket < 257; bucket++) {
+            starts[bucket] = next;
+            next += counts[bucket];
+        }
+        uint32_t cursor[257];
+        std::copy(starts, starts + 257, cursor);
+        for (uint32_t i = range.begin; i < range.end; i++) {
+            scratch[cursor[buckets[i]]++] = items[i];
+        }
+        std::copy(scratch.begin() + range.begin, scratch.begin() + range.end, items + range.begin);
+
+        // Bucket 0 holds keys equal up to their end; they stay in input order
+        for (int bucket = 1; bucket < 257; bucket++) {
+            if (counts[bucket] > 1) {
+                pending.push_back({starts[bucket], starts[bucket] + counts[bucket], range.depth + 1});
+            }
+        }
+    }
+}
+
+} // namespace FileCataloger
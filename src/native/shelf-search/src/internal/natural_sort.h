@@ -0,0 +1,72 @@
+/**
+ * @file natural_sort.h
+ * @brief Natural-order collation keys and a radix sort over them
+ *
+ * Natural order compares runs of digits by value, so "img2" sorts before
+ * "img10". Instead of re-parsing digits on every comparison, each name is
+ * turned once into a binary key whose plain byte order (memcmp) is the
+ * natural order:
+ *
+ *   - other bytes are case folded (FoldCase) and copied as they are
+ *   - a digit run becomes '0', the count of its significant digits, then
+ *     those digits; leading zeros are dropped, so "007" and "7" are equal.
+ *     Counts of 255 and up are written as 255 and four big-endian bytes.
+ *
+ * The tag byte keeps digits where ASCII puts them: after "." and before
+ * letters, so "a.txt" < "a1.txt" < "a10.txt" < "ab.txt". Collation is
+ * locale-insensitive byte order beyond the Latin-1 case folding.
+ *
+ * CollationKeys packs the keys of a name list into one buffer and sorts it
+ * with an MSD radix sort (insertion sort for small buckets). The sort is
+ * stable: names with equal keys keep their input order.
+ */
+
+#ifndef SHELF_SEARCH_NATURAL_SORT_H
+#define SHELF_SEARCH_NATURAL_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FileCataloger {
+
+// Append the collation key of name to key
+void AppendCollationKey(const char* name, size_t length, std::string* key);
+
+// Natural-order comparison that parses both names on every call (<0, 0, >0).
+// Agrees with comparing collation keys; kept as the reference for tests.
+int CompareNatural(const char* a, size_t aLength, const char* b, size_t bLength);
+
+class CollationKeys {
+public:
+    CollationKeys() : offsets_{0} {}
+
+    void Append(const char* name, size_t length);
+    void Append(const std::string& name) { Append(name.data(), name.size()); }
+    void Clear();
+    void Reserve(uint32_t names, size_t bytes);
+
+    uint32_t Size() const { return static_cast<uint32_t>(offsets_.size() - 1); }
+    size_t MemoryUsage() const { return bytes_.capacity() + offsets_.capacity() * sizeof(uint32_t); }
+
+    int Compare(uint32_t a, uint32_t b) const;
+
+    // Replace order with the indices of the names in natural order
+    void Sort(std::vector<uint32_t>* order) const;
+
+private:
+    const uint8_t* Key(uint32_t index) const {
+        return reinterpret_cast<const uint8_t*>(bytes_.data()) + offsets_[index];
+    }
+    uint32_t Length(uint32_t index) const { return offsets_[index + 1] - offsets_[index]; }
+
+    void InsertionSort(uint32_t* items, uint32_t count, uint32_t depth) const;
+
+    std::string bytes_;
+    std::vector<uint32_t> offsets_;  // key i is [offsets_[i], offsets_[i + 1])
+};
+
+} // namespace FileCataloger
+
+#endif // SHELF_SEARCH_NATURAL_SORT_H
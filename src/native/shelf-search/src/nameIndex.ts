@@ -0,0 +1,128 @@
+/**
+ * @fileoverview Fuzzy search over shelf item names
+ *
+ * A NameIndex holds the names of one shelf's items in a packed native
+ * column and ranks them against a query the way fzf does: the query's
+ * characters must appear in order, ignoring case, and matches at word
+ * boundaries, camelCase humps and in runs score higher. Extending the
+ * previous query only rescans the previous matches, so each keystroke
+ * while typing gets cheaper.
+ *
+ * Usage:
+ * ```typescript
+ * const index = new NameIndex();
+ * index.append(items.map(item => item.name));
+ * const { indices } = index.search('shrp', { limit: 200 });  // best first
+ * const visible = Array.from(indices, i => items[i]);
+ * ```
+ *
+ * Without the native module (e.g. Windows) a JavaScript subsequence match
+ * with a simpler score is used.
+ *
+ * @module shelf-search
+ */
+
+import { loadShelfSearchModule } from './nativeModule';
+
+export interface NameSearchOptions {
+  /** Most results to return (default: all) */
+  limit?: number;
+}
+
+export interface NameSearchResult {
+  /** Item indices, best match first */
+  indices: Uint32Array;
+  /** Match scores, parallel to indices */
+  scores: Int32Array;
+  /** Matches before the limit was applied */
+  total: number;
+  /** Names examined; smaller than the index when the previous query was narrowed */
+  scanned: number;
+  narrowed: boolean;
+}
+
+interface NativeNameIndex {
+  append(names: string[]): void;
+  clear(): void;
+  size(): number;
+  search(query: string, limit: number): NameSearchResult;
+  stats(): { size: number; memoryBytes: number; simd: boolean };
+}
+
+interface NativeShelfSearchModule {
+  NativeNameIndex: new (options?: { simd?: boolean }) => NativeNameIndex;
+}
+
+function loadNativeModule(): NativeShelfSearchModule | null {
+  return loadShelfSearchModule<NativeShelfSearchModule>();
+}
+
+export function isNativeSearchAvailable(): boolean {
+  return loadNativeModule() !== null;
+}
+
+export class NameIndex {
+  private native: NativeNameIndex | null;
+  private names: string[] = [];
+
+  constructor() {
+    const native = loadNativeModule();
+    this.native = native ? new native.NativeNameIndex() : null;
+  }
+
+  get size(): number {
+    return this.native ? this.native.size() : this.names.length;
+  }
+
+  /** Add names; their indices continue from the current size */
+  append(names: string[]): void {
+    if (this.native) {
+      this.native.append(names);
+    } else {
+      this.names.push(...names.map(name => name.toLowerCase()));
+    }
+  }
+
+  clear(): void {
+    if (this.native) {
+      this.native.clear();
+    } else {
+      this.names = [];
+    }
+  }
+
+  /** An empty query returns every index in order */
+  search(query: string, { limit = 0 }: NameSearchOptions = {}): NameSearchResult {
+    return this.native ? this.native.search(query, limit) : searchFallback(this.names, query, limit);
+  }
+}
+
+// Subsequence match ranked by the length of the matched span, then by
+// where it starts
+function searchFallback(names: string[], query: string, limit: number): NameSearchResult {
+  const needle = query.toLowerCase();
+  const matches: Array<{ index: number; score: number }> = [];
+  names.forEach((name, index) => {
+    let start = -1;
+    let position = -1;
+    for (const char of needle) {
+      position = name.indexOf(char, position + 1);
+      if (position < 0) return;
+      if (start < 0) start = position;
+    }
+    const span = needle.length === 0 ? 0 : position - start + 1;
+    matches.push({ index, score: -(span * 256 + Math.min(start, 255)) });
+  });
+  if (needle.length > 0) {
+    matches.sort((a, b) => b.score - a.score || a.index - b.index);
+  }
+
+  const count = limit > 0 ? Math.min(limit, matches.length) : matches.length;
+  return {
+    indices: Uint32Array.from(matches.slice(0, count), match => match.index),
+    scores: Int32Array.from(matches.slice(0, count), match => match.score),
+    total: matches.length,
+    scanned: names.length,
+    narrowed: false,
+  };
+}
@@ -0,0 +1,278 @@
+/**
+ * @file shelf_search.cc
+ * @brief N-API bindings for fuzzy search over shelf item names
+ *
+ * Exposes NativeNameIndex, a packed, case-folded name column with
+ * fzf-style ranked search (src/internal/name_index.h).
+ *
+ *   new NativeNameIndex(options?)      options: { simd?: boolean } (benchmarks)
+ *   append(names: string[])
+ *   clear()
+ *   size() -> number
+ *   search(query, limit) -> { indices: Uint32Array, scores: Int32Array,
+ *                             total, scanned, narrowed }
+ *   stats() -> { size, memoryBytes, simd }
+ *
+ * and naturalSort(names: string[]) -> Uint32Array, the indices of names in
+ * natural order ("img2" before "img10"), from collation keys and a radix
+ * sort (src/internal/natural_sort.h).
+ *
+ * Searches are synchronous: 100k names take a few milliseconds, and the
+ * caller needs the result before it can render anything.
+ *
+ * @author FileCataloger Team
+ * @date 2025
+ */
+
+#include <node_api.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "name_index.h"
+#include "natural_sort.h"
+
+using FileCataloger::CollationKeys;
+using FileCataloger::MatchKernel;
+using FileCataloger::NameIndex;
+using FileCataloger::NameSearchResult;
+
+namespace {
+
+void SetNumber(napi_env env, napi_value object, const char* name, double value) {
+    napi_value number;
+    napi_create_double(env, value, &number);
+    napi_set_named_property(env, object, name, number);
+}
+
+void SetBoolean(napi_env env, napi_value object, const char* name, bool value) {
+    napi_value boolean;
+    napi_get_boolean(env, value, &boolean);
+    napi_set_named_property(env, object, name, boolean);
+}
+
+template <typename T>
+napi_value CreateTypedArray(napi_env env, napi_typedarray_type type, const std::vector<T>& values) {
+    void* data = nullptr;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, values.size() * sizeof(T), &data, &buffer);
+    if (!values.empty()) {
+        memcpy(data, values.data(), values.size() * sizeof(T));
+    }
+    napi_create_typedarray(env, type, values.size(), buffer, 0, &array);
+    return array;
+}
+
+bool ReadString(napi_env env, napi_value value, std::string* result) {
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) {
+        return false;
+    }
+    result->assign(length, '\0');
+    napi_get_value_string_utf8(env, value, &(*result)[0], length + 1, &length);
+    return true;
+}
+
+NameIndex* Unwrap(napi_env env, napi_callback_info info, size_t* argc, napi_value* args) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, argc, args, &this_arg, nullptr);
+    NameIndex* index = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&index));
+    return index;
+}
+
+} // namespace
+
+static napi_value CreateNameIndex(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    // { simd: false } forces the scalar mask filter, for benchmarks
+    MatchKernel kernel = MatchKernel::Auto;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type == napi_object) {
+        bool has_simd = false;
+        napi_has_named_property(env, args[0], "simd", &has_simd);
+        if (has_simd) {
+            napi_value value;
+            bool simd = true;
+            napi_get_named_property(env, args[0], "simd", &value);
+            if (napi_get_value_bool(env, value, &simd) != napi_ok) {
+                napi_throw_type_error(env, nullptr, "simd must be a boolean");
+                return nullptr;
+            }
+            kernel = simd ? MatchKernel::Auto : MatchKernel::Scalar;
+        }
+    }
+
+    auto* index = new NameIndex(kernel);
+    napi_wrap(env, this_arg, index,
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<NameIndex*>(data);
+        }, nullptr, nullptr);
+    return this_arg;
+}
+
+static napi_value AppendNames(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    NameIndex* index = Unwrap(env, info, &argc, args);
+    if (!index) {
+        return nullptr;
+    }
+
+    bool is_array = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "append(names: string[]) expected");
+        return nullptr;
+    }
+
+    uint32_t length = 0;
+    napi_get_array_length(env, args[0], &length);
+    std::string name;
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, args[0], i, &element);
+        if (!ReadString(env, element, &name)) {
+            napi_throw_type_error(env, nullptr, "names must be strings");
+            return nullptr;
+        }
+        index->Append(name);
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value ClearNames(napi_env env, napi_callback_info info) {
+    if (NameIndex* index = Unwrap(env, info, nullptr, nullptr)) {
+        index->Clear();
+    }
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+static napi_value GetSize(napi_env env, napi_callback_info info) {
+    NameIndex* index = Unwrap(env, info, nullptr, nullptr);
+    napi_value result;
+    napi_create_uint32(env, index ? index->Size() : 0, &result);
+    return result;
+}
+
+static napi_value SearchNames(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    NameIndex* index = Unwrap(env, info, &argc, args);
+    if (!index) {
+        return nullptr;
+    }
+
+    std::string query;
+    if (argc < 1 || !ReadString(env, args[0], &query)) {
+        napi_throw_type_error(env, nullptr, "search(query: string, limit?: number) expected");
+        return nullptr;
+    }
+    uint32_t limit = 0;
+    if (argc >= 2) {
+        napi_valuetype type;
+        napi_typeof(env, args[1], &type);
+        if (type != napi_undefined && napi_get_value_uint32(env, args[1], &limit) != napi_ok) {
+            napi_throw_type_error(env, nullptr, "limit must be a number");
+            return nullptr;
+        }
+    }
+
+    NameSearchResult search;
+    index->Search(query, limit, &search);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "indices", CreateTypedArray(env, napi_uint32_array, search.indices));
+    napi_set_named_property(env, result, "scores", CreateTypedArray(env, napi_int32_array, search.scores));
+    SetNumber(env, result, "total", search.total);
+    SetNumber(env, result, "scanned", search.scanned);
+    SetBoolean(env, result, "narrowed", search.narrowed);
+    return result;
+}
+
+static napi_value GetStats(napi_env env, napi_callback_info info) {
+    NameIndex* index = Unwrap(env, info, nullptr, nullptr);
+    if (!index) {
+        return nullptr;
+    }
+    napi_value result;
+    napi_create_object(env, &result);
+    SetNumber(env, result, "size", index->Size());
+    SetNumber(env, result, "memoryBytes", static_cast<double>(index->MemoryUsage()));
+    SetBoolean(env, result, "simd", FileCataloger::HasSimdFilter());
+    return result;
+}
+
+static napi_value NaturalSort(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    bool is_array = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &is_array);
+    }
+    if (!is_array) {
+        napi_throw_type_error(env, nullptr, "naturalSort(names: string[]) expected");
+        return nullptr;
+    }
+
+    uint32_t length = 0;
+    napi_get_array_length(env, args[0], &length);
+    CollationKeys keys;
+    keys.Reserve(length, static_cast<size_t>(length) * 24);
+    std::string name;
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, args[0], i, &element);
+        if (!ReadString(env, element, &name)) {
+            napi_throw_type_error(env, nullptr, "names must be strings");
+            return nullptr;
+        }
+        keys.Append(name);
+    }
+
+    std::vector<uint32_t> order;
+    keys.Sort(&order);
+    return CreateTypedArray(env, napi_uint32_array, order);
+}
+
+// Module initialization
+static napi_value Init(napi_env env, napi_value exports) {
+    napi_value index_class;
+
+    napi_property_descriptor properties[] = {
+        { "append", nullptr, AppendNames, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "clear", nullptr, ClearNames, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "size", nullptr, GetSize, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "search", nullptr, SearchNames, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "stats", nullptr, GetStats, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeNameIndex", NAPI_AUTO_LENGTH,
+                      CreateNameIndex, nullptr, 5, properties, &index_class);
+    napi_set_named_property(env, exports, "NativeNameIndex", index_class);
+
+    napi_value natural_sort_fn;
+    napi_create_function(env, "naturalSort", NAPI_AUTO_LENGTH, NaturalSort, nullptr, &natural_sort_fn);
+    napi_set_named_property(env, exports, "naturalSort", natural_sort_fn);
+
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,47 @@
+/**
+ * @fileoverview Loader for the shelf-search native module
+ *
+ * The module is built for macOS, and for Linux in development and tests.
+ * Each wrapper in this directory types the part of it that it uses and
+ * falls back to JavaScript when it is missing.
+ *
+ * @module shelf-search
+ */
+
+import * as path from 'path';
+import { createLogger } from '@main/modules/utils/logger';
+
+const logger = createLogger('ShelfSearch');
+
+let nativeModule: unknown = null;
+let loadAttempted = false;
+
+export function loadShelfSearchModule<T>(): T | null {
+  if (loadAttempted) {
+    return nativeModule as T | null;
+  }
+  loadAttempted = true;
+
+  if (process.platform !== 'darwin' && process.platform !== 'linux') {
+    return null;
+  }
+
+  const moduleName = `shelf_search_${process.platform}.node`;
+  try {
+    try {
+      // Development: from native module build directory
+      nativeModule = require(`../build/Release/${moduleName}`);
+    } catch {
+      // Production: from dist/main, unpacked from asar when packaged
+      let nativePath = path.join(__dirname, moduleName);
+      if (nativePath.includes('.asar')) {
+        nativePath = nativePath.replace(/\.asar([/\\])/i, '.asar.unpacked$1');
+      }
+      nativeModule = require(nativePath);
+    }
+    logger.info('Successfully loaded shelf-search native module');
+  } catch {
+    logger.info('Shelf-search native module not available - using JavaScript fallbacks');
+  }
+  return nativeModule as T | null;
+}
@@ -0,0 +1,81 @@
+/**
+ * @fileoverview Natural-order sorting of file names
+ *
+ * Numbers inside names compare by value, so "img2" sorts before "img10"
+ * and counter-based renames follow the order users expect. The native
+ * module computes one binary collation key per name and radix-sorts the
+ * keys, instead of re-parsing digits in every comparison.
+ *
+ * Usage:
+ * ```typescript
+ * const order = naturalSortOrder(items.map(item => item.name));
+ * const sorted = Array.from(order, i => items[i]);
+ * ```
+ *
+ * Collation ignores case and leading zeros and is otherwise byte order, not
+ * locale-aware. Names that compare equal keep their input order.
+ *
+ * @module shelf-search
+ */
+
+import { loadShelfSearchModule } from './nativeModule';
+
+interface NativeNaturalSortModule {
+  naturalSort(names: string[]): Uint32Array;
+}
+
+/**
+ * Indices of names in natural order
+ */
+export function naturalSortOrder(names: string[]): Uint32Array {
+  const native = loadShelfSearchModule<NativeNaturalSortModule>();
+  if (native) {
+    return native.naturalSort(names);
+  }
+  const folded = names.map(name => name.toLowerCase());
+  const order = Array.from(names, (_, index) => index);
+  order.sort((a, b) => compareFolded(folded[a], folded[b]));
+  return Uint32Array.from(order);
+}
+
+/**
+ * Natural-order comparison of two names; used by the fallback and for
+ * sorting a handful of names where the native call is not worth it
+ */
+export function compareNatural(a: string, b: string): number {
+  return compareFolded(a.toLowerCase(), b.toLowerCase());
+}
+
+const isDigit = (code: number): boolean => code >= 48 && code <= 57;
+
+// Same rules as the native collation key: a digit run compares as '0',
+// then by significant digit count, then digit by digit
+function compareFolded(a: string, b: string): number {
+  let i = 0;
+  let j = 0;
+  while (i < a.length && j < b.length) {
+    const x = a.charCodeAt(i);
+    const y = b.charCodeAt(j);
+    if (isDigit(x) && isDigit(y)) {
+      while (a.charCodeAt(i) === 48) i++;
+      while (b.charCodeAt(j) === 48) j++;
+      const xStart = i;
+      const yStart = j;
+      while (i < a.length && isDigit(a.charCodeAt(i))) i++;
+      while (j < b.length && isDigit(b.charCodeAt(j))) j++;
+      const xCount = i - xStart;
+      const yCount = j - yStart;
+      if (xCount !== yCount) return xCount - yCount;
+      const xDigits = a.slice(xStart, i);
+      const yDigits = b.slice(yStart, j);
+      if (xDigits !== yDigits) return xDigits < yDigits ? -1 : 1;
+      continue;
+    }
+    const xByte = isDigit(x) ? 48 : x;
+    const yByte = isDigit(y) ? 48 : y;
+    if (xByte !== yByte) return xByte - yByte;
+    i++;
+    j++;
+  }
+  return a.length - i - (b.length - j);
+}
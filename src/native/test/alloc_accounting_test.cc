@@ -0,0 +1,156 @@
+/**
+ * @file alloc_accounting_test.cc
+ * @brief Steady-state test for per-subsystem allocation accounting
+ *
+ * Replays rounds of mouse moves through a BatchedDispatcher (drained on the
+ * stand-in JS thread from napi_test_shim.h) and drags through DragSession
+ * and an ArenaChunkCache, the way the input modules do. At the idle point
+ * after each round, the live bytes of every AllocAccounting tag must be the
+ * same as after the first warm-up round: replaying the same input may not
+ * leave anything behind. The event queue and N-API payload tags must be
+ * empty at idle, peaks must stay within what the replay can hold at once,
+ * and every tag must come back to zero once the modules are torn down.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "alloc_accounting.h"
+#include "input_replay.h"
+#include "napi_test_shim.h"
+#include "test_support.h"
+
+using FileCataloger::AllocAccounting;
+using FileCataloger::AllocTag;
+using FileCataloger::AllocTagName;
+using FileCataloger::AllocTagStats;
+
+namespace {
+
+constexpr int kWarmupRounds = 2;
+constexpr int kRounds = 20;
+constexpr int kMovesPerRound = 20000;
+constexpr int kDragsPerRound = 50;
+constexpr int kMovesPerDrag = 300;
+constexpr size_t kPathsPerDrag = 32;
+
+constexpr size_t kTagCount = static_cast<size_t>(AllocTag::Count);
+
+void ReadAll(AllocTagStats (&stats)[kTagCount]) {
+    for (size_t i = 0; i < kTagCount; i++) {
+        stats[i] = AllocAccounting::Read(static_cast<AllocTag>(i));
+    }
+}
+
+AllocTagStats& Of(AllocTagStats (&stats)[kTagCount], AllocTag tag) {
+    return stats[static_cast<size_t>(tag)];
+}
+
+void RunRound(MouseReplay& mouse, DragReplay& drags, uint64_t& timestamp) {
+    for (int i = 0; i < kMovesPerRound; i++) {
+        mouse.Move(400 + (i % 97), 300 + (i % 53), false, ++timestamp);
+        if (i % (kMovesPerRound / kDragsPerRound) == 0) {
+            drags.RunDrag(kMovesPerDrag);
+        }
+    }
+    mouse.Settle();
+}
+
+} // namespace
+
+int main() {
+    std::thread jsThread(NapiTestShim::RunJsThread);
+
+    AllocTagStats baseline[kTagCount];
+    {
+        MouseReplay mouse("AllocAccountingMoves");
+        DragReplay drags(kPathsPerDrag);
+        EXPECT(mouse.Start(), "dispatcher starts");
+
+        uint64_t timestamp = 0;
+        for (int i = 0; i < kWarmupRounds; i++) {
+            RunRound(mouse, drags, timestamp);
+        }
+        ReadAll(baseline);
+        AllocAccounting::ResetPeaks();
+
+        std::printf("%-12s %10s %10s %12s %14s\n", "tag", "live B", "peak B", "allocations", "bytes charged");
+        for (size_t i = 0; i < kTagCount; i++) {
+            std::printf("%-12s %10lld %10lld %12llu %14llu\n",
+                        AllocTagName(static_cast<AllocTag>(i)),
+                        static_cast<long long>(baseline[i].liveBytes),
+                        static_cast<long long>(baseline[i].peakBytes),
+                        static_cast<unsigned long long>(baseline[i].allocations),
+                        static_cast<unsigned long long>(baseline[i].bytesAllocated));
+        }
+
+        EXPECT(Of(baseline, AllocTag::EventQueue).liveBytes == 0, "event queue is empty at idle");
+        EXPECT(Of(baseline, AllocTag::NapiPayload).liveBytes == 0, "no N-API payload is held at idle");
+        EXPECT(Of(baseline, AllocTag::Trajectory).liveBytes > 0, "the path session's trajectory is charged");
+        EXPECT(Of(baseline, AllocTag::Paths).liveBytes > 0, "the path session's paths are charged");
+        EXPECT(Of(baseline, AllocTag::Analysis).liveBytes > 0, "the path session's snapshots are charged");
+        EXPECT(Of(baseline, AllocTag::ArenaCache).liveBytes > 0, "the chunk cache is charged");
+
+        bool steady = true;
+        for (int round = 0; round < kRounds; round++) {
+            uint64_t pushedBefore = mouse.Pushed();
+            uint64_t queueAllocationsBefore = AllocAccounting::Read(AllocTag::EventQueue).allocations;
+
+            RunRound(mouse, drags, timestamp);
+
+            AllocTagStats stats[kTagCount];
+            ReadAll(stats);
+            for (size_t i = 0; i < kTagCount; i++) {
+                if (stats[i].liveBytes != baseline[i].liveBytes) {
+                    std::fprintf(stderr, "round %d: %s live bytes %lld, expected %lld\n",
+                                 round, AllocTagName(static_cast<AllocTag>(i)),
+                                 static_cast<long long>(stats[i].liveBytes),
+                                 static_cast<long long>(baseline[i].liveBytes));
+                    steady = false;
+                }
+            }
+            EXPECT(Of(stats, AllocTag::EventQueue).allocations - queueAllocationsBefore ==
+                       mouse.Pushed() - pushedBefore,
+                   "every queued event is charged once");
+        }
+        EXPECT(steady, "live bytes are the same after every round (zero growth)");
+
+        AllocTagStats end[kTagCount];
+        ReadAll(end);
+        const AllocTagStats& queue = Of(end, AllocTag::EventQueue);
+        int64_t nodeBytes = queue.allocations ? static_cast<int64_t>(queue.bytesAllocated / queue.allocations) : 0;
+        EXPECT(queue.peakBytes <= static_cast<int64_t>(MouseReplay::MAX_IN_FLIGHT) * nodeBytes,
+               "event queue peak stays within the events in flight");
+        EXPECT(Of(end, AllocTag::Paths).peakBytes <= 2 * Of(baseline, AllocTag::Paths).liveBytes,
+               "paths peak stays within a drag and the path session");
+        EXPECT(Of(end, AllocTag::Trajectory).peakBytes <= 2 * Of(baseline, AllocTag::Trajectory).liveBytes,
+               "trajectory peak stays within a drag and the path session");
+
+        // From another thread, as the mouse tracker's event thread does when
+        // its start fails there
+        std::thread([&mouse] { mouse.Stop(); }).join();
+        while (NapiTestShim::LiveFunctions() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    AllocTagStats torndown[kTagCount];
+    ReadAll(torndown);
+    for (size_t i = 0; i < kTagCount; i++) {
+        if (torndown[i].liveBytes != 0) {
+            std::fprintf(stderr, "%s: %lld live bytes after teardown\n",
+                         AllocTagName(static_cast<AllocTag>(i)), static_cast<long long>(torndown[i].liveBytes));
+            g_failures++;
+        }
+    }
+
+    NapiTestShim::StopJsThread();
+    jsThread.join();
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+# binding.gyp - Linux test and benchmark executables for the native modules
+#
+# These targets exercise the platform-independent parts of the native modules
+# (common/ headers and each module's src/internal/ headers) on Linux, where
+# CI can run them without macOS event taps or Windows hooks.
+#
+# Build and run: npm run test:linux (from src/native)
+# Output: build/Release/<target_name>
+
+{
+  "variables": {
+    # xinput_latency_bench needs the X11, XInput2 and XTest development files
+    "has_xtest%": "<!(pkg-config --exists x11 xi xtst && echo 1 || echo 0)"
+  },
+  "target_defaults": {
+    "include_dirs": [
+      "../common"
+    ],
+    "cflags_cc!": [ "-fno-exceptions", "-fno-rtti" ],
+    "cflags_cc": [ "-O2", "-std=c++17" ],
+    "libraries": [ "-lpthread" ]
+  },
+  "conditions": [
+    ["OS=='linux'", {
+      "targets": [
+        # Module sources shared by several executables are compiled once,
+        # here; executables compiling them directly would write the same
+        # object files concurrently under make -j
+        {
+          "target_name": "file_ops_internal",
+          "type": "static_library",
+          "include_dirs": [ "../file-ops/src/internal" ],
+          "sources": [
+            "../file-ops/src/internal/content_sniffer.cc",
+            "../file-ops/src/internal/directory_walker.cc",
+            "../file-ops/src/internal/file_list_stat.cc",
+            "../file-ops/src/internal/file_transfer.cc",
+            "../file-ops/src/internal/folder_size.cc",
+            "../file-ops/src/internal/folder_size_cache.cc",
+            "../file-ops/src/internal/io_engine.cc",
+            "../file-ops/src/internal/media_metadata.cc",
+            "../file-ops/src/internal/path_ops.cc",
+            "../file-ops/src/internal/session_store.cc",
+            "../file-ops/src/internal/shelf_store.cc",
+            "../file-ops/src/internal/zip_writer.cc"
+          ],
+          "direct_dependent_settings": {
+            "include_dirs": [ "../file-ops/src/internal" ]
+          },
+          "link_settings": {
+            "libraries": [ "-lz" ]
+          }
+        },
+        {
+          "target_name": "thumbnails_internal",
+          "type": "static_library",
+          "include_dirs": [ "../thumbnails/src/internal" ],
+          "sources": [
+            "../thumbnails/src/internal/image_resize.cc",
+            "../thumbnails/src/internal/thumbnail_cache.cc",
+            "../thumbnails/src/internal/thumbnail_service.cc",
+            "../thumbnails/src/native/linux/thumbnail_decoder_linux.cc"
+          ],
+          "direct_dependent_settings": {
+            "include_dirs": [ "../thumbnails/src/internal" ]
+          },
+          "link_settings": {
+            "libraries": [ "-ljpeg", "-lpng", "-lz" ]
+          }
+        },
+        {
+          "target_name": "shelf_search_internal",
+          "type": "static_library",
+          "include_dirs": [ "../shelf-search/src/internal" ],
+          "sources": [
+            "../shelf-search/src/internal/fuzzy_match.cc",
+            "../shelf-search/src/internal/name_index.cc",
+            "../shelf-search/src/internal/natural_sort.cc"
+          ],
+          "direct_dependent_settings": {
+            "include_dirs": [ "../shelf-search/src/internal" ]
+          }
+        },
+        {
+          "target_name": "drag_session_alloc_test",
+          "type": "executable",
+          "include_dirs": [ "../drag-monitor/src/internal" ],
+          "sources": [ "drag_session_alloc_test.cc" ]
+        },
+        {
+          "target_name": "alloc_accounting_test",
+          "type": "executable",
+          "include_dirs": [ "../drag-monitor/src/internal" ],
+          "sources": [
+            "alloc_accounting_test.cc",
+            "napi_test_shim.cc"
+          ]
+        },
+        {
+          "target_name": "soak_test",
+          "type": "executable",
+          "include_dirs": [ "../drag-monitor/src/internal" ],
+          "sources": [
+            "soak_test.cc",
+            "napi_test_shim.cc"
+          ]
+        },
+        {
+          "target_name": "sampling_profiler_test",
+          "type": "executable",
+          "cflags_cc": [ "-fno-omit-frame-pointer" ],
+          "ldflags": [ "-rdynamic" ],
+          "sources": [ "sampling_profiler_test.cc" ],
+          "libraries": [ "-lrt" ]
+        },
+        {
+          "target_name": "energy_bench",
+          "type": "executable",
+          "include_dirs": [ "../drag-monitor/src/internal" ],
+          "sources": [
+            "energy_bench.cc",
+            "napi_test_shim.cc"
+          ]
+        },
+        {
+          "target_name": "input_path_bench",
+          "type": "executable",
+          "include_dirs": [ "../drag-monitor/src/internal" ],
+          "sources": [
+            "input_path_bench.cc",
+            "napi_test_shim.cc"
+          ]
+        },
+        {
+          "target_name": "native_task_test",
+          "type": "executable",
+          "cflags_cc!": [ "-std=c++17" ],
+          "cflags_cc": [ "-std=c++20" ],
+          "sources": [ "native_task_test.cc" ]
+        },
+        {
+          "target_name": "directory_walker_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "directory_walker_test.cc" ]
+        },
+        {
+          "target_name": "folder_size_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "folder_size_test.cc" ]
+        },
+        {
+          "target_name": "file_transfer_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "file_transfer_test.cc" ]
+        },
+        {
+          "target_name": "content_sniffer_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "content_sniffer_test.cc" ]
+        },
+        {
+          "target_name": "file_list_payload_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "file_list_payload_test.cc" ]
+        },
+        {
+          "target_name": "cancellation_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "cancellation_test.cc" ]
+        },
+        {
+          "target_name": "io_engine_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "io_engine_test.cc" ]
+        },
+        {
+          "target_name": "io_engine_bench",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "io_engine_bench.cc" ]
+        },
+        {
+          "target_name": "zip_writer_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "zip_writer_test.cc" ]
+        },
+        {
+          "target_name": "zip_writer_bench",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "zip_writer_bench.cc" ]
+        },
+        {
+          "target_name": "media_metadata_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "media_metadata_test.cc" ]
+        },
+        {
+          "target_name": "media_metadata_bench",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "media_metadata_bench.cc" ]
+        },
+        {
+          "target_name": "session_store_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "session_store_test.cc" ]
+        },
+        {
+          "target_name": "shelf_store_test",
+          "type": "executable",
+          "dependencies": [ "file_ops_internal" ],
+          "sources": [ "shelf_store_test.cc" ]
+        },
+        {
+          "target_name": "thumbnail_test",
+          "type": "executable",
+          "dependencies": [ "thumbnails_internal" ],
+          "sources": [ "thumbnail_test.cc" ]
+        },
+        {
+          "target_name": "thumbnail_bench",
+          "type": "executable",
+          "dependencies": [ "thumbnails_internal" ],
+          "sources": [ "thumbnail_bench.cc" ]
+        },
+        {
+          "target_name": "name_index_test",
+          "type": "executable",
+          "dependencies": [ "shelf_search_internal" ],
+          "sources": [ "name_index_test.cc" ]
+        },
+        {
+          "target_name": "natural_sort_test",
+          "type": "executable",
+          "dependencies": [ "shelf_search_internal" ],
+          "sources": [ "natural_sort_test.cc" ]
+        }
+      ]
+    }, {
+      "targets": []
+    }],
+    ["OS=='linux' and has_xtest==1", {
+      "targets": [
+        {
+          "target_name": "xinput_latency_bench",
+          "type": "executable",
+          "include_dirs": [ "../drag-monitor/src/internal" ],
+          "sources": [
+            "xinput_latency_bench.cc",
+            "napi_test_shim.cc"
+          ],
+          "libraries": [ "-lX11", "-lXi", "-lXtst" ]
+        }
+      ]
+    }]
+  ]
+}
@@ -0,0 +1,152 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := content_sniffer_test
+DEFS_Debug := \
+	'-DNODE_GYP_MODULE_NAME=content_sniffer_test' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := \
+	-O2 \
+	-std=c++17 \
+	-std=gnu++17
+
+INCS_Debug := \
+	-I$(srcdir)/../common \
+	-I/usr/include/node \
+	-I/usr/src \
+	-I/usr/deps/openssl/config \
+	-I/usr/deps/openssl/openssl/include \
+	-I/usr/deps/uv/include \
+	-I/usr/deps/zlib \
+	-I/usr/deps/v8/include \
+	-I$(srcdir)/../file-ops/src/internal
+
+DEFS_Release := \
+	'-DNODE_GYP_MODULE_NAME=content_sniffer_test' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS'
+
+# Flags passed to all source files.
+CFLAGS_Release := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-O3 \
+	-fno-omit-frame-pointer
+
+# Flags passed to only C files.
+CFLAGS_C_Release :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := \
+	-O2 \
+	-std=c++17 \
+	-std=gnu++17
+
+INCS_Release := \
+	-I$(srcdir)/../common \
+	-I/usr/include/node \
+	-I/usr/src \
+	-I/usr/deps/openssl/config \
+	-I/usr/deps/openssl/openssl/include \
+	-I/usr/deps/uv/include \
+	-I/usr/deps/zlib \
+	-I/usr/deps/v8/include \
+	-I$(srcdir)/../file-ops/src/internal
+
+OBJS := \
+	$(obj).target/$(TARGET)/content_sniffer_test.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# Make sure our dependencies are built before any of us.
+$(OBJS): | $(builddir)/file_ops_internal.a $(obj).target/file_ops_internal.a
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LIBS := \
+	-lpthread \
+	-lz
+
+$(builddir)/content_sniffer_test: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(builddir)/content_sniffer_test: LIBS := $(LIBS)
+$(builddir)/content_sniffer_test: LD_INPUTS := $(OBJS) $(obj).target/file_ops_internal.a
+$(builddir)/content_sniffer_test: TOOLSET := $(TOOLSET)
+$(builddir)/content_sniffer_test: $(OBJS) $(obj).target/file_ops_internal.a FORCE_DO_CMD
+	$(call do_cmd,link)
+
+all_deps += $(builddir)/content_sniffer_test
+# Add target alias
+.PHONY: content_sniffer_test
+content_sniffer_test: $(builddir)/content_sniffer_test
+
+# Add executable to "all" target.
+.PHONY: all
+all: $(builddir)/content_sniffer_test
+
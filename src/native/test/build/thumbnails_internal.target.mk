@@ -0,0 +1,167 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := thumbnails_internal
+DEFS_Debug := \
+	'-DNODE_GYP_MODULE_NAME=thumbnails_internal' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := \
+	-O2 \
+	-std=c++17 \
+	-std=gnu++17
+
+INCS_Debug := \
+	-I$(srcdir)/../common \
+	-I/usr/include/node \
+	-I/usr/src \
+	-I/usr/deps/openssl/config \
+	-I/usr/deps/openssl/openssl/include \
+	-I/usr/deps/uv/include \
+	-I/usr/deps/zlib \
+	-I/usr/deps/v8/include \
+	-I$(srcdir)/../thumbnails/src/internal
+
+DEFS_Release := \
+	'-DNODE_GYP_MODULE_NAME=thumbnails_internal' \
+	'-DUSING_UV_SHARED=1' \
+	'-DUSING_V8_SHARED=1' \
+	'-DV8_DEPRECATION_WARNINGS=1' \
+	'-D_GLIBCXX_USE_CXX11_ABI=1' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D__STDC_FORMAT_MACROS' \
+	'-DOPENSSL_NO_PINSHARED' \
+	'-DOPENSSL_THREADS'
+
+# Flags passed to all source files.
+CFLAGS_Release := \
+	-fPIC \
+	-pthread \
+	-Wall \
+	-Wextra \
+	-Wno-unused-parameter \
+	-m64 \
+	-O3 \
+	-fno-omit-frame-pointer
+
+# Flags passed to only C files.
+CFLAGS_C_Release :=
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := \
+	-O2 \
+	-std=c++17 \
+	-std=gnu++17
+
+INCS_Release := \
+	-I$(srcdir)/../common \
+	-I/usr/include/node \
+	-I/usr/src \
+	-I/usr/deps/openssl/config \
+	-I/usr/deps/openssl/openssl/include \
+	-I/usr/deps/uv/include \
+	-I/usr/deps/zlib \
+	-I/usr/deps/v8/include \
+	-I$(srcdir)/../thumbnails/src/internal
+
+OBJS := \
+	$(obj).target/$(TARGET)/../thumbnails/src/internal/image_resize.o \
+	$(obj).target/$(TARGET)/../thumbnails/src/internal/thumbnail_cache.o \
+	$(obj).target/$(TARGET)/../thumbnails/src/internal/thumbnail_service.o \
+	$(obj).target/$(TARGET)/../thumbnails/src/native/linux/thumbnail_decoder_linux.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE))  $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LDFLAGS_Release := \
+	-pthread \
+	-rdynamic \
+	-m64
+
+LIBS := \
+	-lpthread
+
+$(obj).target/thumbnails_internal.a: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/thumbnails_internal.a: LIBS := $(LIBS)
+$(obj).target/thumbnails_internal.a: TOOLSET := $(TOOLSET)
+$(obj).target/thumbnails_internal.a: $(OBJS)
+	$(call create_archive,$@,$^)
+
+# Add target alias
+.PHONY: thumbnails_internal
+thumbnails_internal: $(obj).target/thumbnails_internal.a
+
+# Add target alias to "all" target.
+.PHONY: all
+all: thumbnails_internal
+
+# Add target alias
+.PHONY: thumbnails_internal
+thumbnails_internal: $(builddir)/thumbnails_internal.a
+
+# Copy this to the static library output path.
+$(builddir)/thumbnails_internal.a: TOOLSET := $(TOOLSET)
+$(builddir)/thumbnails_internal.a: $(obj).target/thumbnails_internal.a FORCE_DO_CMD
+	$(call do_cmd,copy)
+
+all_deps += $(builddir)/thumbnails_internal.a
+# Short alias for building this static library.
+.PHONY: thumbnails_internal.a
+thumbnails_internal.a: $(obj).target/thumbnails_internal.a $(builddir)/thumbnails_internal.a
+
+# Add static library to "all" target.
+.PHONY: all
+all: $(builddir)/thumbnails_internal.a
+
@@ -0,0 +1,338 @@
+/**
+ * @file cancellation_test.cc
+ * @brief Functional test for cancellation tokens and deadlines in file-ops jobs
+ *
+ * Checks the token itself (a default token never fires, Cancel() and
+ * deadlines latch their reason, children inherit from parents), then runs
+ * the file-ops jobs against a large synthetic tree: a walk cancelled from
+ * another thread must finish within a bound that does not grow with the
+ * tree, a walk with a deadline delivers the entries it read and reports
+ * timedOut, and stat, sniff and transfer batches given a cancelled token
+ * skip their work and say so.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "cancellation_token.h"
+#include "content_sniffer.h"
+#include "directory_walker.h"
+#include "file_list_stat.h"
+#include "file_transfer.h"
+#include "test_support.h"
+
+using FileCataloger::CancellationSource;
+using FileCataloger::CancellationToken;
+using FileCataloger::CancelReason;
+using FileCataloger::ContentType;
+using FileCataloger::DirectoryWalker;
+using FileCataloger::FileListBatch;
+using FileCataloger::FileTransfer;
+using FileCataloger::SniffBatch;
+using FileCataloger::TransferItem;
+using FileCataloger::TransferOptions;
+using FileCataloger::TransferResult;
+using FileCataloger::TransferSummary;
+using FileCataloger::WalkBatch;
+using FileCataloger::WalkOptions;
+using FileCataloger::WalkSummary;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+// 40 top-level folders of 25 folders of 30 files: 31000 entries
+constexpr int TOP_DIRS = 40;
+constexpr int SUB_DIRS = 25;
+constexpr int FILES_PER_DIR = 30;
+constexpr uint64_t TREE_ENTRIES = TOP_DIRS + TOP_DIRS * SUB_DIRS * (1 + FILES_PER_DIR);
+
+// Generous for a loaded CI machine; the walk checks the token once per directory
+constexpr auto CANCEL_LATENCY_BOUND = std::chrono::milliseconds(250);
+
+double MsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BuildTree(const std::string& root) {
+    for (int top = 0; top < TOP_DIRS; top++) {
+        std::string topPath = root + "/d" + std::to_string(top);
+        MakeDir(topPath);
+        for (int sub = 0; sub < SUB_DIRS; sub++) {
+            std::string subPath = topPath + "/s" + std::to_string(sub);
+            MakeDir(subPath);
+            for (int file = 0; file < FILES_PER_DIR; file++) {
+                WriteFile(subPath + "/f" + std::to_string(file) + ".txt", "hello");
+            }
+        }
+    }
+}
+
+void RemoveTree(const std::string& path) {
+    std::string command = "rm -rf '" + path + "'";
+    if (std::system(command.c_str()) != 0) {
+        std::fprintf(stderr, "cannot remove %s\n", path.c_str());
+    }
+}
+
+struct WalkResult {
+    uint64_t delivered = 0;
+    std::unique_ptr<WalkSummary> summary;
+    double doneAtMs = 0;
+};
+
+// Walks root; cancelAfterMs >= 0 cancels the walker from another thread
+WalkResult Walk(WorkStealingPool& pool, const std::string& root, WalkOptions options,
+                double* cancelledAtMs = nullptr, int cancelAfterMs = -1) {
+    WalkResult result;
+    std::mutex mutex;
+    auto start = std::chrono::steady_clock::now();
+
+    auto walker = DirectoryWalker::Create(
+        root, std::move(options),
+        [&](std::unique_ptr<WalkBatch> batch) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result.delivered += batch->size();
+        },
+        [&](std::unique_ptr<WalkSummary> summary) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result.summary = std::move(summary);
+            result.doneAtMs = MsSince(start);
+        });
+
+    std::thread canceller;
+    if (cancelAfterMs >= 0) {
+        canceller = std::thread([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(cancelAfterMs));
+            *cancelledAtMs = MsSince(start);
+            walker->Cancel();
+        });
+    }
+    if (walker->Start(pool) != 0) {
+        std::fprintf(stderr, "cannot open %s\n", root.c_str());
+        std::exit(2);
+    }
+    walker->WaitUntilFinished();
+    if (canceller.joinable()) {
+        canceller.join();
+    }
+    return result;
+}
+
+void TestToken() {
+    std::printf("token\n");
+    CancellationToken never;
+    EXPECT(!never.CanBeCancelled() && !never.IsCancelled(), "default token");
+
+    CancellationSource parent;
+    CancellationSource child(parent.Token());
+    CancellationToken token = child.Token();
+    EXPECT(token.CanBeCancelled() && !token.IsCancelled(), "fresh token cancelled");
+    parent.Cancel();
+    EXPECT(token.Reason() == CancelReason::Cancelled, "child did not inherit the parent's cancellation");
+    EXPECT(!CancellationToken().IsCancelled(), "unrelated token cancelled");
+
+    CancellationSource timed(CancellationToken(), std::chrono::milliseconds(20));
+    EXPECT(!timed.IsCancelled(), "deadline fired early");
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT(timed.Reason() == CancelReason::DeadlineExceeded, "deadline did not fire");
+    timed.Cancel();
+    EXPECT(timed.Reason() == CancelReason::DeadlineExceeded, "Cancel() replaced the deadline reason");
+
+    CancellationSource cancelledFirst(CancellationToken(), std::chrono::milliseconds(1));
+    cancelledFirst.Cancel();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT(cancelledFirst.Reason() == CancelReason::Cancelled, "deadline replaced the Cancel() reason");
+}
+
+// Returns how long an uncancelled walk of the tree takes
+double TestWalkCancelLatency(WorkStealingPool& pool, const std::string& root) {
+    std::printf("walk cancel latency\n");
+    WalkResult full = Walk(pool, root, WalkOptions());
+    EXPECT(full.summary && full.summary->entries == TREE_ENTRIES, "full walk saw %llu of %llu entries",
+           full.summary ? static_cast<unsigned long long>(full.summary->entries) : 0ULL,
+           static_cast<unsigned long long>(TREE_ENTRIES));
+    std::printf("  full walk of %llu entries: %.1f ms\n", static_cast<unsigned long long>(TREE_ENTRIES),
+                full.doneAtMs);
+
+    // Cancel at a fraction of the full walk so it lands mid-walk
+    int cancelAfterMs = static_cast<int>(full.doneAtMs / 4);
+    double worstMs = 0;
+    for (int run = 0; run < 5; run++) {
+        double cancelledAtMs = 0;
+        WalkResult cancelled = Walk(pool, root, WalkOptions(), &cancelledAtMs, cancelAfterMs);
+        EXPECT(cancelled.summary && cancelled.summary->cancelled, "run %d: summary not cancelled", run);
+        EXPECT(cancelled.summary && !cancelled.summary->timedOut, "run %d: cancel reported as timeout", run);
+        worstMs = std::max(worstMs, cancelled.doneAtMs - cancelledAtMs);
+    }
+    std::printf("  worst cancel-to-done: %.2f ms\n", worstMs);
+    EXPECT(worstMs < CANCEL_LATENCY_BOUND.count(), "cancel took %.1f ms to finish the walk", worstMs);
+    return full.doneAtMs;
+}
+
+void TestWalkDeadline(WorkStealingPool& pool, const std::string& root, double fullWalkMs) {
+    std::printf("walk deadline\n");
+    // A deadline a quarter of the way through the walk delivers what was read before it
+    auto deadline = std::chrono::milliseconds(std::max(1, static_cast<int>(fullWalkMs / 4)));
+    CancellationSource early(CancellationToken(), deadline);
+    WalkOptions options;
+    options.cancellation = early.Token();
+    WalkResult result = Walk(pool, root, options);
+    EXPECT(result.summary && result.summary->timedOut && result.summary->cancelled, "summary not timedOut");
+    EXPECT(result.delivered > 0 && result.delivered < TREE_ENTRIES, "%llu entries delivered",
+           static_cast<unsigned long long>(result.delivered));
+    EXPECT(result.summary && result.summary->entries == result.delivered,
+           "summary counts entries that were never delivered");
+
+    // A deadline the walk beats changes nothing
+    CancellationSource generous(CancellationToken(), std::chrono::milliseconds(60000));
+    options.cancellation = generous.Token();
+    result = Walk(pool, root, options);
+    EXPECT(result.summary && !result.summary->cancelled && !result.summary->timedOut, "generous deadline fired");
+    EXPECT(result.delivered == TREE_ENTRIES, "walk under a deadline lost entries");
+}
+
+std::vector<std::string> SomeFiles(const std::string& root, size_t count) {
+    std::vector<std::string> paths;
+    for (int top = 0; paths.size() < count; top++) {
+        for (int file = 0; file < FILES_PER_DIR && paths.size() < count; file++) {
+            paths.push_back(root + "/d" + std::to_string(top % TOP_DIRS) + "/s" + std::to_string(top / TOP_DIRS) +
+                            "/f" + std::to_string(file) + ".txt");
+        }
+    }
+    return paths;
+}
+
+template<typename Batch>
+std::shared_ptr<Batch> RunBatch(WorkStealingPool& pool, std::shared_ptr<Batch> batch,
+                                void (*run)(WorkStealingPool&, std::shared_ptr<Batch>,
+                                            std::function<void(std::shared_ptr<Batch>)>)) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    run(pool, batch, [&](std::shared_ptr<Batch>) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return done; });
+    return batch;
+}
+
+void TestBatches(WorkStealingPool& pool, const std::string& root) {
+    std::printf("stat and sniff batches\n");
+    std::vector<std::string> paths = SomeFiles(root, 2000);
+
+    auto stat = std::make_shared<FileListBatch>();
+    stat->paths = paths;
+    RunBatch(pool, stat, &FileCataloger::StatFileList);
+    EXPECT(!stat->cancelled, "uncancelled stat batch reports cancelled");
+    size_t fullPayload = stat->payload.size();
+
+    CancellationSource cancelledStat;
+    cancelledStat.Cancel();
+    stat = std::make_shared<FileListBatch>();
+    stat->paths = paths;
+    stat->cancellation = cancelledStat.Token();
+    RunBatch(pool, stat, &FileCataloger::StatFileList);
+    EXPECT(stat->cancelled, "cancelled stat batch not reported");
+    EXPECT(stat->payload.size() == fullPayload, "cancelled payload is %zu bytes, expected the full layout of %zu",
+           stat->payload.size(), fullPayload);
+
+    auto sniff = std::make_shared<SniffBatch>();
+    sniff->paths = paths;
+    RunBatch(pool, sniff, &FileCataloger::SniffFiles);
+    EXPECT(!sniff->cancelled && sniff->types[0] != ContentType::Unknown, "uncancelled sniff batch");
+
+    CancellationSource cancelledSniff;
+    cancelledSniff.Cancel();
+    sniff = std::make_shared<SniffBatch>();
+    sniff->paths = paths;
+    sniff->cancellation = cancelledSniff.Token();
+    RunBatch(pool, sniff, &FileCataloger::SniffFiles);
+    EXPECT(sniff->cancelled, "cancelled sniff batch not reported");
+    size_t sniffed = 0;
+    for (ContentType type : sniff->types) {
+        sniffed += type != ContentType::Unknown;
+    }
+    EXPECT(sniff->types.size() == paths.size() && sniffed == 0, "%zu files sniffed after cancel", sniffed);
+}
+
+void TestTransfer(WorkStealingPool& pool, const std::string& root) {
+    std::printf("transfer\n");
+    std::string destination = root + "-out";
+    MakeDir(destination);
+
+    std::vector<TransferItem> items;
+    for (int i = 0; i < 20; i++) {
+        std::string name = "/d" + std::to_string(i);
+        items.push_back({root + name, destination + name});
+    }
+
+    CancellationSource expired(CancellationToken(), std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    TransferOptions options;
+    options.cancellation = expired.Token();
+
+    std::mutex mutex;
+    size_t cancelledItems = 0;
+    TransferSummary summary;
+    auto transfer = FileTransfer::Create(
+        items, options,
+        [&](const TransferResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelledItems += result.error == ECANCELED;
+        },
+        [] {},
+        [&](const TransferSummary& done) {
+            std::lock_guard<std::mutex> lock(mutex);
+            summary = done;
+        });
+    transfer->Start(pool);
+    transfer->WaitUntilFinished();
+
+    EXPECT(summary.cancelled && summary.timedOut, "transfer summary not timedOut");
+    EXPECT(cancelledItems == items.size(), "%zu of %zu items failed with ECANCELED", cancelledItems, items.size());
+    EXPECT(summary.files == 0, "%llu files copied after the deadline", static_cast<unsigned long long>(summary.files));
+    RemoveTree(destination);
+}
+
+} // namespace
+
+int main() {
+    char pattern[] = "/tmp/fc-cancellation-XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        return 2;
+    }
+    BuildTree(root);
+
+    WorkStealingPool pool(4);
+    TestToken();
+    double fullWalkMs = TestWalkCancelLatency(pool, root);
+    TestWalkDeadline(pool, root, fullWalkMs);
+    TestBatches(pool, root);
+    TestTransfer(pool, root);
+
+    RemoveTree(root);
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
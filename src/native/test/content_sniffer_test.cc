@@ -0,0 +1,299 @@
+/**
+ * @file content_sniffer_test.cc
+ * @brief Functional test for magic-number content sniffing
+ *
+ * Classifies in-memory headers for every supported format, plus the
+ * near-misses the refiners exist for (text starting with "BM", CAFEBABE as
+ * Mach-O or Java, ZIP-based document formats, ISO-BMFF brands). Then sniffs
+ * files on disk: mislabelled and extensionless files, empty files,
+ * directories, FIFOs and missing paths, and a bulk batch whose results
+ * must come back in path order.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <condition_variable>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "content_sniffer.h"
+#include "test_support.h"
+
+using FileCataloger::CategoryOf;
+using FileCataloger::ClassifyContent;
+using FileCataloger::ContentCategory;
+using FileCataloger::ContentType;
+using FileCataloger::SniffBatch;
+using FileCataloger::SniffFile;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes Raw(const char* data, size_t size) {
+    return Bytes(data, data + size);
+}
+
+Bytes Text(const std::string& text) {
+    return Bytes(text.begin(), text.end());
+}
+
+Bytes Concat(std::initializer_list<Bytes> parts) {
+    Bytes out;
+    for (const auto& part : parts) {
+        out.insert(out.end(), part.begin(), part.end());
+    }
+    return out;
+}
+
+Bytes Padded(Bytes bytes, size_t size = 64) {
+    bytes.resize(std::max(bytes.size(), size), 0);
+    return bytes;
+}
+
+// Local file header for a first entry, followed by its stored data
+Bytes ZipEntry(const std::string& name, const std::string& data) {
+    Bytes header = Raw("PK\x03\x04\x14\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+                       "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", 30);
+    header[26] = static_cast<uint8_t>(name.size());
+    return Concat({header, Text(name), Text(data)});
+}
+
+Bytes Ftyp(const char* major, std::initializer_list<const char*> compatible) {
+    Bytes box = Raw("\0\0\0\0ftyp", 8);
+    Bytes brand = Text(major);
+    box.insert(box.end(), brand.begin(), brand.end());
+    box.insert(box.end(), 4, 0);
+    for (const char* compat : compatible) {
+        Bytes b = Text(compat);
+        box.insert(box.end(), b.begin(), b.end());
+    }
+    box[3] = static_cast<uint8_t>(box.size());
+    return Padded(box);
+}
+
+Bytes Tar() {
+    Bytes block(512, 0);
+    memcpy(block.data(), "notes.txt", 9);
+    memcpy(block.data() + 257, "ustar\0" "00", 8);
+    return block;
+}
+
+struct Case {
+    const char* name;
+    Bytes header;
+    ContentType expected;
+};
+
+void TestClassify() {
+    const Case cases[] = {
+        {"jpeg", Padded(Raw("\xFF\xD8\xFF\xE0\0\x10JFIF", 10)), ContentType::Jpeg},
+        {"png", Padded(Raw("\x89PNG\r\n\x1A\n\0\0\0\rIHDR", 16)), ContentType::Png},
+        {"gif", Padded(Text("GIF89a")), ContentType::Gif},
+        {"webp", Padded(Raw("RIFF\0\0\0\0WEBPVP8 ", 16)), ContentType::Webp},
+        {"bmp", Padded(Raw("BM\x36\0\0\0\0\0\0\0\x36\0\0\0\x28\0\0\0", 18)), ContentType::Bmp},
+        {"tiff", Padded(Raw("II*\0\x08\0\0\0", 8)), ContentType::Tiff},
+        {"heic", Ftyp("heic", {"mif1", "heic"}), ContentType::Heic},
+        {"avif via mif1", Ftyp("mif1", {"avif", "miaf"}), ContentType::Avif},
+        {"heif via mif1", Ftyp("mif1", {"heic"}), ContentType::Heic},
+        {"ico", Padded(Raw("\0\0\1\0\1\0\x10\x10\0\0\1\0\x20\0", 14)), ContentType::Ico},
+        {"psd", Padded(Raw("8BPS\0\1", 6)), ContentType::Psd},
+        {"svg", Text("<?xml version=\"1.0\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\"/>"), ContentType::Svg},
+        {"bare svg", Text("  <svg viewBox=\"0 0 1 1\"></svg>"), ContentType::Svg},
+
+        {"zip", ZipEntry("hello.txt", "hi"), ContentType::Zip},
+        {"empty zip", Padded(Raw("PK\x05\x06", 4), 22), ContentType::Zip},
+        {"gzip", Padded(Raw("\x1F\x8B\x08\0", 4)), ContentType::Gzip},
+        {"bzip2", Padded(Text("BZh91AY&SY")), ContentType::Bzip2},
+        {"xz", Padded(Raw("\xFD" "7zXZ\0\0\x04", 8)), ContentType::Xz},
+        {"zstd", Padded(Raw("\x28\xB5\x2F\xFD", 4)), ContentType::Zstd},
+        {"7z", Padded(Raw("7z\xBC\xAF\x27\x1C\0\x04", 8)), ContentType::SevenZip},
+        {"rar", Padded(Raw("Rar!\x1A\x07\x01\0", 8)), ContentType::Rar},
+        {"tar", Tar(), ContentType::Tar},
+
+        {"pdf", Text("%PDF-1.7\n%\xE2\xE3\xCF\xD3\n"), ContentType::Pdf},
+        {"rtf", Text("{\\rtf1\\ansi\\deff0"), ContentType::Rtf},
+        {"ole", Padded(Raw("\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8)), ContentType::OleCompound},
+        {"epub", ZipEntry("mimetype", "application/epub+zip"), ContentType::Epub},
+        {"odt", ZipEntry("mimetype", "application/vnd.oasis.opendocument.text"), ContentType::OpenDocument},
+        {"sqlite", Padded(Raw("SQLite format 3\0\x10\0", 18)), ContentType::Sqlite},
+        {"ooxml", ZipEntry("[Content_Types].xml", "<?xml"), ContentType::Ooxml},
+        {"docx", ZipEntry("word/document.xml", "<?xml"), ContentType::Docx},
+        {"xlsx", ZipEntry("xl/workbook.xml", "<?xml"), ContentType::Xlsx},
+        {"pptx", ZipEntry("ppt/presentation.xml", "<?xml"), ContentType::Pptx},
+
+        {"mp3 id3", Padded(Raw("ID3\x04\0\0", 6)), ContentType::Mp3},
+        {"mp3 frame", Padded(Raw("\xFF\xFB\x90\x64", 4)), ContentType::Mp3},
+        {"aac adts", Padded(Raw("\xFF\xF1\x50\x80", 4)), ContentType::Aac},
+        {"flac", Padded(Raw("fLaC\0\0\0\x22", 8)), ContentType::Flac},
+        {"ogg", Padded(Raw("OggS\0\x02", 6)), ContentType::Ogg},
+        {"wav", Padded(Raw("RIFF\x24\0\0\0WAVEfmt ", 16)), ContentType::Wav},
+        {"aiff", Padded(Raw("FORM\0\0\0\0AIFFCOMM", 16)), ContentType::Aiff},
+        {"midi", Padded(Raw("MThd\0\0\0\x06", 8)), ContentType::Midi},
+        {"m4a", Ftyp("M4A ", {"M4A ", "isom"}), ContentType::M4a},
+        {"mp4", Ftyp("isom", {"isom", "iso2", "avc1", "mp41"}), ContentType::Mp4},
+        {"mov", Ftyp("qt  ", {"qt  "}), ContentType::Mov},
+        {"avi", Padded(Raw("RIFF\0\0\0\0AVI LIST", 16)), ContentType::Avi},
+        {"mkv", Padded(Raw("\x1A\x45\xDF\xA3\x9F\x42\x86\x81\x01\x42\x82\x88matroska", 20)), ContentType::Matroska},
+        {"webm", Padded(Raw("\x1A\x45\xDF\xA3\x9F\x42\x86\x81\x01\x42\x82\x84webm", 16)), ContentType::Webm},
+
+        {"elf", Padded(Raw("\x7F" "ELF\x02\x01\x01", 7)), ContentType::Elf},
+        {"mach-o", Padded(Raw("\xCF\xFA\xED\xFE\x0C\0\0\x01", 8)), ContentType::MachO},
+        {"fat mach-o", Padded(Raw("\xCA\xFE\xBA\xBE\0\0\0\x02", 8)), ContentType::MachO},
+        {"java class", Padded(Raw("\xCA\xFE\xBA\xBE\0\0\0\x34", 8)), ContentType::JavaClass},
+        {"pe", Padded(Raw("MZ\x90\0\x03\0", 6)), ContentType::Pe},
+        {"wasm", Padded(Raw("\0asm\x01\0\0\0", 8)), ContentType::Wasm},
+        {"script", Text("#!/bin/sh\necho hi\n"), ContentType::Script},
+
+        {"text", Text("hello world\n"), ContentType::Text},
+        {"text starting with BM", Text("BMW service notes\n"), ContentType::Text},
+        {"utf-8", Text("caf\xC3\xA9 cr\xC3\xA8me\n"), ContentType::Text},
+        {"utf-8 cut at the end", Text("\xE2\x82\xAC 5 \xE2\x82"), ContentType::Text},
+        {"utf-8 bom", Text("\xEF\xBB\xBF<html><body>"), ContentType::Html},
+        {"utf-16 bom", Raw("\xFF\xFEh\0i\0", 6), ContentType::Text},
+        {"html", Text("\n<!DOCTYPE html>\n<html lang=\"en\">"), ContentType::Html},
+        {"xml", Text("<?xml version=\"1.0\"?><plist version=\"1.0\"/>"), ContentType::Xml},
+        {"binary", Raw("\x01\x02\x03\0\x04\x05", 6), ContentType::Unknown},
+        {"latin-1", Text("caf\xE9 au lait"), ContentType::Unknown},
+        {"bmp lookalike", Padded(Raw("BM\x36\0\0\0\x01\0\0\0", 10)), ContentType::Unknown},
+        {"truncated ftyp", Raw("\0\0\0\x18" "ftyp", 8), ContentType::Unknown},
+    };
+
+    for (const auto& test : cases) {
+        ContentType type = ClassifyContent(test.header.data(), test.header.size());
+        EXPECT(type == test.expected, "%s: got %d, expected %d", test.name, static_cast<int>(type),
+               static_cast<int>(test.expected));
+    }
+
+    EXPECT(ClassifyContent(nullptr, 0) == ContentType::Empty, "empty header");
+    EXPECT(CategoryOf(ContentType::Heic) == ContentCategory::Image, "heic category");
+    EXPECT(CategoryOf(ContentType::Tar) == ContentCategory::Archive, "tar category");
+    EXPECT(CategoryOf(ContentType::Pptx) == ContentCategory::Document, "pptx category");
+    EXPECT(CategoryOf(ContentType::Webm) == ContentCategory::Media, "webm category");
+    EXPECT(CategoryOf(ContentType::Wasm) == ContentCategory::Executable, "wasm category");
+    EXPECT(CategoryOf(ContentType::Svg) == ContentCategory::Image, "svg category");
+    EXPECT(CategoryOf(ContentType::Special) == ContentCategory::Other, "special category");
+    EXPECT(CategoryOf(static_cast<ContentType>(250)) == ContentCategory::Other, "out of range category");
+}
+
+void TestFiles(const std::string& root) {
+    Bytes png = Padded(Raw("\x89PNG\r\n\x1A\n\0\0\0\rIHDR", 16), 2048);
+    WriteFile(root + "/no-extension", png);
+    EXPECT(SniffFile(root + "/no-extension") == ContentType::Png, "extensionless png");
+
+    WriteFile(root + "/photo.txt", Padded(Raw("\xFF\xD8\xFF\xE1", 4), 100));
+    EXPECT(SniffFile(root + "/photo.txt") == ContentType::Jpeg, "jpeg named .txt");
+
+    WriteFile(root + "/short", Text("ok"));
+    EXPECT(SniffFile(root + "/short") == ContentType::Text, "two-byte text file");
+
+    WriteFile(root + "/empty.pdf", Bytes());
+    EXPECT(SniffFile(root + "/empty.pdf") == ContentType::Empty, "empty file");
+
+    mkdir((root + "/folder.zip").c_str(), 0755);
+    EXPECT(SniffFile(root + "/folder.zip") == ContentType::Directory, "directory");
+
+    // Must not block waiting for a writer
+    mkfifo((root + "/pipe").c_str(), 0644);
+    EXPECT(SniffFile(root + "/pipe") == ContentType::Special, "fifo");
+
+    EXPECT(SniffFile(root + "/missing") == ContentType::Unreadable, "missing file");
+
+    if (geteuid() != 0) {
+        WriteFile(root + "/locked", png);
+        chmod((root + "/locked").c_str(), 0);
+        EXPECT(SniffFile(root + "/locked") == ContentType::Unreadable, "unreadable file");
+    }
+}
+
+void TestBatch(const std::string& root) {
+    const Bytes kinds[] = {
+        Padded(Raw("\x89PNG\r\n\x1A\n", 8), 4096),
+        Padded(Raw("%PDF-1.4\n", 9), 4096),
+        Text(std::string(4096, 'a')),
+        Padded(Raw("\x1F\x8B\x08\0", 4), 4096),
+    };
+    const ContentType expected[] = {ContentType::Png, ContentType::Pdf, ContentType::Text, ContentType::Gzip};
+
+    const size_t count = 3000;
+    auto batch = std::make_shared<SniffBatch>();
+    mkdir((root + "/bulk").c_str(), 0755);
+    for (size_t i = 0; i < count; i++) {
+        std::string path = root + "/bulk/f" + std::to_string(i);
+        WriteFile(path, kinds[i % 4]);
+        batch->paths.push_back(path);
+    }
+    batch->paths.push_back(root + "/bulk/missing");
+
+    WorkStealingPool pool(4);
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::shared_ptr<SniffBatch> result;
+    int calls = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    FileCataloger::SniffFiles(pool, batch, [&](std::shared_ptr<SniffBatch> done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = std::move(done);
+        calls++;
+        cv.notify_one();
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return result != nullptr; });
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT(result->types.size() == count + 1, "batch size %zu", result->types.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count && i < result->types.size(); i++) {
+        mismatches += result->types[i] != expected[i % 4] ? 1 : 0;
+    }
+    EXPECT(mismatches == 0, "%zu files out of order or misclassified", mismatches);
+    EXPECT(result->types.back() == ContentType::Unreadable, "missing file in batch");
+    std::printf("  sniffed %zu files in %.1f ms (%.0f files/s, page cache warm)\n", count + 1, ms,
+                (count + 1) / ms * 1000.0);
+
+    // An empty batch completes on the calling thread
+    bool emptyDone = false;
+    FileCataloger::SniffFiles(pool, std::make_shared<SniffBatch>(),
+                              [&](std::shared_ptr<SniffBatch> done) { emptyDone = done->types.empty(); });
+    EXPECT(emptyDone, "empty batch");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT(calls == 1, "done called %d times", calls);
+}
+
+} // namespace
+
+int main() {
+    char pattern[] = "/tmp/content_sniffer_test.XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        return 2;
+    }
+
+    TestClassify();
+    TestFiles(root);
+    TestBatch(root);
+
+    std::string cleanup = std::string("rm -rf '") + root + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", root);
+    }
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/**
+ * @fileoverview Benchmark: native directory walker vs fs.promises
+ *
+ * Builds (once) a synthetic tree of ENTRIES entries under the temp directory
+ * and times a full recursive listing with:
+ *   - the file-ops native walker, with and without stat
+ *   - recursive fs.promises.readdir(withFileTypes) + lstat per entry
+ *   - recursive fs.promises.readdir(withFileTypes) without stat
+ *
+ * Usage (from src/native, after npm run build:file-ops):
+ *   node test/directory_walker_bench.mjs
+ *   ENTRIES=100000 RUNS=3 node test/directory_walker_bench.mjs
+ *
+ * Results depend heavily on core count and on whether the tree is in the
+ * page cache; the first run warms the cache and is not reported.
+ */
+
+import { createRequire } from 'module';
+import { promises as fs, existsSync, mkdirSync, writeFileSync } from 'fs';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const require = createRequire(import.meta.url);
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const ENTRIES = Number(process.env.ENTRIES || 500000);
+const RUNS = Number(process.env.RUNS || 5);
+const FILES_PER_DIR = 100;
+const DIRS_PER_DIR = 8;
+
+const native = require(
+  path.join(__dirname, '..', 'file-ops', 'build', 'Release', `file_ops_${process.platform}.node`)
+);
+
+function makeTree(root) {
+  const marker = path.join(root, '.complete');
+  if (existsSync(marker)) return;
+
+  console.log(`Creating ${ENTRIES} entries under ${root} ...`);
+  mkdirSync(root, { recursive: true });
+  let created = 0;
+  const queue = [root];
+  while (created < ENTRIES && queue.length > 0) {
+    const dir = queue.shift();
+    for (let i = 0; i < DIRS_PER_DIR && created < ENTRIES; i++, created++) {
+      const child = path.join(dir, `dir${i}`);
+      mkdirSync(child);
+      queue.push(child);
+    }
+    for (let i = 0; i < FILES_PER_DIR && created < ENTRIES; i++, created++) {
+      writeFileSync(path.join(dir, `file${i}.dat`), '');
+    }
+  }
+  writeFileSync(marker, '');
+}
+
+function walkNative(root, stat) {
+  return new Promise((resolve, reject) => {
+    const walker = new native.NativeDirectoryWalker();
+    const start = process.hrtime.bigint();
+    let entries = 0;
+    let firstBatchMs = 0;
+    try {
+      walker.start(root, { stat, ignore: ['.complete'] }, (batches, summary) => {
+        for (const batch of batches) {
+          if (entries === 0) firstBatchMs = Number(process.hrtime.bigint() - start) / 1e6;
+          entries += batch.names.length;
+        }
+        if (summary) {
+          resolve({ entries, firstBatchMs, ms: Number(process.hrtime.bigint() - start) / 1e6 });
+        }
+      });
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+async function walkFsPromises(root, stat) {
+  const start = process.hrtime.bigint();
+  let entries = 0;
+  let firstBatchMs = 0;
+  const visit = async dir => {
+    const dirents = await fs.readdir(dir, { withFileTypes: true });
+    const children = [];
+    const stats = [];
+    let count = 0;
+    for (const dirent of dirents) {
+      if (dirent.name === '.complete') continue;
+      count++;
+      const full = path.join(dir, dirent.name);
+      if (stat) stats.push(fs.lstat(full));
+      if (dirent.isDirectory()) children.push(full);
+    }
+    await Promise.all(stats);
+    if (entries === 0) firstBatchMs = Number(process.hrtime.bigint() - start) / 1e6;
+    entries += count;
+    await Promise.all(children.map(visit));
+  };
+  await visit(root);
+  return { entries, firstBatchMs, ms: Number(process.hrtime.bigint() - start) / 1e6 };
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+async function bench(name, fn) {
+  await fn(); // warm the page cache and dentry cache
+  const results = [];
+  for (let i = 0; i < RUNS; i++) results.push(await fn());
+  const ms = median(results.map(r => r.ms));
+  const first = median(results.map(r => r.firstBatchMs));
+  console.log(
+    `${name.padEnd(34)} ${String(results[0].entries).padStart(8)} entries  ` +
+      `${ms.toFixed(1).padStart(8)} ms  first batch ${first.toFixed(2).padStart(7)} ms  ` +
+      `${Math.round(results[0].entries / (ms / 1000)).toLocaleString()} entries/s`
+  );
+  return ms;
+}
+
+const root = process.env.BENCH_ROOT || path.join(os.tmpdir(), `file-ops-bench-${ENTRIES}`);
+makeTree(root);
+
+console.log(
+  `\nNode ${process.version}, ${os.cpus().length} CPUs, native pool ${native.getWorkerCount()} workers, ` +
+    `median of ${RUNS} warm runs\n`
+);
+const nativeStat = await bench('native walker (stat)', () => walkNative(root, true));
+const nativeNoStat = await bench('native walker (no stat)', () => walkNative(root, false));
+const fsStat = await bench('fs.promises.readdir + lstat', () => walkFsPromises(root, true));
+const fsNoStat = await bench('fs.promises.readdir (types only)', () => walkFsPromises(root, false));
+
+console.log(`\nspeedup with stat:    ${(fsStat / nativeStat).toFixed(1)}x`);
+console.log(`speedup without stat: ${(fsNoStat / nativeNoStat).toFixed(1)}x`);
@@ -0,0 +1,229 @@
+/**
+ * @file directory_walker_test.cc
+ * @brief Functional test for the file-ops parallel directory walker
+ *
+ * Builds a small fixture tree in a temporary directory and checks that the
+ * walker reports every entry exactly once with the right type, size and
+ * depth, honours maxDepth, ignore patterns and batchSize, never follows
+ * symlinks, reports a missing root, and finishes promptly when cancelled.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "directory_walker.h"
+#include "test_support.h"
+
+using FileCataloger::DirectoryWalker;
+using FileCataloger::EntryType;
+using FileCataloger::MatchGlob;
+using FileCataloger::WalkBatch;
+using FileCataloger::WalkOptions;
+using FileCataloger::WalkSummary;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+struct Entry {
+    EntryType type;
+    double size;
+    uint32_t depth;
+};
+
+struct WalkResult {
+    std::map<std::string, Entry> entries;
+    size_t batches = 0;
+    size_t largestBatch = 0;
+    size_t duplicates = 0;
+    std::unique_ptr<WalkSummary> summary;
+    int startError = 0;
+};
+
+WalkResult Walk(WorkStealingPool& pool, const std::string& root, WalkOptions options,
+                size_t cancelAfterBatches = 0) {
+    WalkResult result;
+    std::mutex mutex;
+    std::shared_ptr<DirectoryWalker> walker;
+
+    walker = DirectoryWalker::Create(
+        root, std::move(options),
+        [&](std::unique_ptr<WalkBatch> batch) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result.batches++;
+            result.largestBatch = std::max(result.largestBatch, batch->size());
+            for (size_t i = 0; i < batch->size(); i++) {
+                const std::string& dir = batch->directories[batch->directoryIndex[i]];
+                std::string path = dir.empty() ? std::string(batch->name(i))
+                                               : dir + "/" + std::string(batch->name(i));
+                Entry entry{static_cast<EntryType>(batch->types[i]), batch->sizes[i],
+                            batch->directoryDepths[batch->directoryIndex[i]]};
+                if (!result.entries.emplace(path, entry).second) {
+                    result.duplicates++;
+                }
+            }
+            if (cancelAfterBatches && result.batches >= cancelAfterBatches) {
+                walker->Cancel();
+            }
+        },
+        [&](std::unique_ptr<WalkSummary> summary) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result.summary = std::move(summary);
+        });
+
+    result.startError = walker->Start(pool);
+    walker->WaitUntilFinished();
+    return result;
+}
+
+// root/
+//   a.txt (10)  b.tmp (20)  link -> a
+//   a/ c.txt (30)  b/ d.txt (40)  b/c/ e.txt (50)
+//   node_modules/ pkg/ index.js (60)
+//   wide/ f0..f2499 (1 byte each)
+std::string MakeFixture() {
+    char pattern[] = "/tmp/directory_walker_test.XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        std::exit(2);
+    }
+    std::string r(root);
+    WriteFile(r + "/a.txt", 10);
+    WriteFile(r + "/b.tmp", 20);
+    MakeDir(r + "/a");
+    WriteFile(r + "/a/c.txt", 30);
+    MakeDir(r + "/a/b");
+    WriteFile(r + "/a/b/d.txt", 40);
+    MakeDir(r + "/a/b/c");
+    WriteFile(r + "/a/b/c/e.txt", 50);
+    MakeDir(r + "/node_modules");
+    MakeDir(r + "/node_modules/pkg");
+    WriteFile(r + "/node_modules/pkg/index.js", 60);
+    MakeDir(r + "/wide");
+    for (int i = 0; i < 2500; i++) {
+        WriteFile(r + "/wide/f" + std::to_string(i), 1);
+    }
+    if (symlink("a", (r + "/link").c_str()) != 0) {
+        std::fprintf(stderr, "symlink failed\n");
+        std::exit(2);
+    }
+    return r;
+}
+
+void TestGlob() {
+    EXPECT(MatchGlob("node_modules", "node_modules"), "literal match");
+    EXPECT(!MatchGlob("node_modules", "node_module"), "literal mismatch");
+    EXPECT(MatchGlob("*.tmp", "b.tmp"), "suffix glob");
+    EXPECT(!MatchGlob("*.tmp", "b.tmpx"), "suffix glob must anchor");
+    EXPECT(MatchGlob("f?", "f1") && !MatchGlob("f?", "f12"), "single wildcard");
+    EXPECT(MatchGlob("*a*b*", "xxaxxbxx"), "multiple stars");
+    EXPECT(MatchGlob("*", ""), "star matches empty");
+}
+
+void TestFullWalk(WorkStealingPool& pool, const std::string& root) {
+    WalkResult result = Walk(pool, root, WalkOptions());
+    EXPECT(result.startError == 0, "start failed: %d", result.startError);
+    EXPECT(result.summary && !result.summary->cancelled, "walk did not complete");
+    EXPECT(result.duplicates == 0, "%zu duplicate entries", result.duplicates);
+
+    // root 6, a 2, a/b 2, a/b/c 1, node_modules 1, node_modules/pkg 1, wide 2500
+    size_t expected = 6 + 2 + 2 + 1 + 1 + 1 + 2500;
+    EXPECT(result.entries.size() == expected, "expected %zu entries, got %zu", expected, result.entries.size());
+    EXPECT(result.summary && result.summary->entries == expected, "summary entry count mismatch");
+    EXPECT(result.summary && result.summary->directoriesRead == 7, "expected 7 directories read");
+
+    auto& e = result.entries;
+    EXPECT(e.count("a/b/c/e.txt") && e["a/b/c/e.txt"].size == 50 && e["a/b/c/e.txt"].depth == 4,
+           "deep file size/depth");
+    EXPECT(e.count("a") && e["a"].type == EntryType::Directory && e["a"].depth == 1, "directory entry");
+    EXPECT(e.count("link") && e["link"].type == EntryType::Symlink, "symlink reported as symlink");
+    EXPECT(!e.count("link/c.txt"), "symlink must not be followed");
+}
+
+void TestDepthAndIgnore(WorkStealingPool& pool, const std::string& root) {
+    WalkOptions options;
+    options.maxDepth = 2;
+    options.ignorePatterns = {"node_modules", "*.tmp", "wide"};
+    WalkResult result = Walk(pool, root, options);
+
+    EXPECT(!result.entries.count("node_modules"), "ignored directory reported");
+    EXPECT(!result.entries.count("b.tmp"), "ignored file reported");
+    EXPECT(result.entries.count("a/b"), "depth 2 directory missing");
+    EXPECT(!result.entries.count("a/b/d.txt"), "entry beyond maxDepth reported");
+    EXPECT(result.entries.size() == 5, "expected 5 entries, got %zu", result.entries.size());
+}
+
+void TestBatching(WorkStealingPool& pool, const std::string& root) {
+    WalkOptions options;
+    options.batchSize = 100;
+    WalkResult result = Walk(pool, root, options);
+
+    EXPECT(result.largestBatch <= 100, "batch of %zu exceeds batchSize", result.largestBatch);
+    EXPECT(result.batches >= 25, "expected the wide directory to be split, got %zu batches", result.batches);
+    EXPECT(result.duplicates == 0, "%zu duplicate entries", result.duplicates);
+}
+
+void TestNoStat(WorkStealingPool& pool, const std::string& root) {
+    WalkOptions options;
+    options.statEntries = false;
+    WalkResult result = Walk(pool, root, options);
+
+    EXPECT(result.entries.count("a.txt") && result.entries["a.txt"].size == 0, "size filled without stat");
+    EXPECT(result.entries.count("a") && result.entries["a"].type == EntryType::Directory,
+           "type missing without stat");
+}
+
+void TestMissingRoot(WorkStealingPool& pool, const std::string& root) {
+    WalkResult result = Walk(pool, root + "/does-not-exist", WalkOptions());
+    EXPECT(result.startError == ENOENT, "expected ENOENT, got %d", result.startError);
+    EXPECT(!result.summary && result.batches == 0, "sinks called for a failed start");
+}
+
+void TestCancel(WorkStealingPool& pool, const std::string& root) {
+    WalkOptions options;
+    options.batchSize = 10;
+    auto start = std::chrono::steady_clock::now();
+    WalkResult result = Walk(pool, root, options, 1);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT(result.summary && result.summary->cancelled, "summary not marked cancelled");
+    EXPECT(result.entries.size() < 2500, "cancelled walk still read %zu entries", result.entries.size());
+    std::printf("cancel: %zu entries before stop, %.2fms\n", result.entries.size(), ms);
+}
+
+} // namespace
+
+int main() {
+    std::string root = MakeFixture();
+    WorkStealingPool pool(4);
+
+    TestGlob();
+    TestFullWalk(pool, root);
+    TestDepthAndIgnore(pool, root);
+    TestBatching(pool, root);
+    TestNoStat(pool, root);
+    TestMissingRoot(pool, root);
+    TestCancel(pool, root);
+
+    std::string cleanup = "rm -rf '" + root + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", root.c_str());
+    }
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file drag_session_alloc_test.cc
+ * @brief Allocation-count regression test for per-drag session arenas
+ *
+ * Replays long synthetic drags through DragSession the same way the drag
+ * monitor does (trajectory pushes on every move, an analysis snapshot every
+ * 10 moves, a batch of dragged paths, delayed release of the path session)
+ * and counts heap allocations. After warm-up a drag must cost the same small
+ * constant number of allocations no matter how long it is, and no arena
+ * chunk may come from malloc.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "input_replay.h"
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Allocations a drag may cost once the chunk cache is warm: make_shared of
+// the session (object and control block share one allocation)
+constexpr uint64_t kMaxAllocationsPerDrag = 1;
+constexpr int kWarmupDrags = 8;
+constexpr int kMeasuredDrags = 32;
+constexpr size_t kPathsPerDrag = 64;
+
+bool MeasureDrags(DragReplay& replay, int moves, uint64_t& perDrag, uint64_t& chunkMallocs) {
+    uint64_t chunksBefore = replay.cache().ChunksAllocated();
+    uint64_t before = g_allocations.load();
+    for (int i = 0; i < kMeasuredDrags; i++) {
+        replay.RunDrag(moves);
+    }
+    uint64_t total = g_allocations.load() - before;
+    chunkMallocs = replay.cache().ChunksAllocated() - chunksBefore;
+    perDrag = total / kMeasuredDrags;
+    return total % kMeasuredDrags == 0;
+}
+
+} // namespace
+
+int main() {
+    DragReplay replay(kPathsPerDrag);
+    for (int i = 0; i < kWarmupDrags; i++) {
+        replay.RunDrag(10000);
+    }
+
+    bool ok = true;
+    const int dragLengths[] = { 100, 10000, 200000 };
+    for (int moves : dragLengths) {
+        uint64_t perDrag = 0;
+        uint64_t chunkMallocs = 0;
+        bool constant = MeasureDrags(replay, moves, perDrag, chunkMallocs);
+
+        std::printf("moves=%-7d allocations/drag=%llu chunk mallocs=%llu\n",
+                    moves,
+                    static_cast<unsigned long long>(perDrag),
+                    static_cast<unsigned long long>(chunkMallocs));
+
+        if (!constant || perDrag > kMaxAllocationsPerDrag || chunkMallocs != 0) {
+            std::fprintf(stderr, "FAIL: drag of %d moves allocated %llu times per drag (max %llu), %llu chunk mallocs\n",
+                         moves,
+                         static_cast<unsigned long long>(perDrag),
+                         static_cast<unsigned long long>(kMaxAllocationsPerDrag),
+                         static_cast<unsigned long long>(chunkMallocs));
+            ok = false;
+        }
+    }
+
+    std::printf(ok ? "PASS\n" : "FAIL\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,679 @@
+/**
+ * @file energy_bench.cc
+ * @brief Energy-impact benchmark for the input modules' idle and active cost
+ *
+ * Runs the parts of the mouse tracker and drag monitor that build on Linux
+ * in real time, paced like real input, and measures per scenario:
+ * - package energy from the RAPL counters under /sys/class/powercap, above
+ *   the machine's draw with the bench doing nothing
+ * - CPU time of the process (user + system)
+ * - wakeups: voluntary context switches, i.e. a thread of the process
+ *   blocking and later being woken, and involuntary ones (preemptions)
+ * - JS calls: drains the stand-in JS thread ran (napi_test_shim.h)
+ * - hardware counters from perf_counters.h (cycles, instructions, L1d and
+ *   LLC misses, branch misses, context switches) per mouse event, or per
+ *   second for idle, in a second table; n/a where the machine has none
+ *
+ * Input comes from a thread that wakes once per mouse event, as the event
+ * tap thread does in the app, so its wakeups are part of the motion cost.
+ *
+ * Scenarios:
+ *   idle    dispatcher, JS thread and analysis thread started, no input
+ *   motion  steady mouse motion at ENERGY_BENCH_HZ through a
+ *           BatchedDispatcher with its default 16ms latency
+ *   drags   a drag every 1.5s: a second of motion that also feeds a
+ *           DragSession, snapshots every 10 moves analysed on the analysis
+ *           thread, paths added once per drag
+ *
+ * Each scenario runs ENERGY_BENCH_RUNS times and the median is reported.
+ * RAPL counts the whole package, so close other programs and compare runs
+ * on the same machine; CPU time and wakeups are per process and stable
+ * enough to compare across commits on any machine.
+ *
+ * To compare commits, save a run and pass it as the baseline of the next:
+ *   ENERGY_BENCH_SAVE=before.tsv npm run bench:energy
+ *   (check out the other commit)
+ *   ENERGY_BENCH_BASELINE=before.tsv npm run bench:energy
+ * With a baseline, the bench fails if a scenario's CPU time or wakeups per
+ * second grew by more than ENERGY_BENCH_TOLERANCE percent (and more than a
+ * small absolute floor, so an idle scenario near zero does not flap).
+ * Both runs must use the same ENERGY_BENCH_SECONDS and ENERGY_BENCH_HZ.
+ * Energy is printed next to the baseline's but not gated, as it depends on
+ * everything else the package is doing. Hardware counters are not saved.
+ *
+ * Environment (defaults in brackets):
+ *   ENERGY_BENCH_SECONDS    seconds per scenario run [10]
+ *   ENERGY_BENCH_RUNS       runs per scenario [3]
+ *   ENERGY_BENCH_HZ         mouse events per second while moving [120]
+ *   ENERGY_BENCH_POWERCAP   powercap root [/sys/class/powercap]
+ *   ENERGY_BENCH_SAVE       write results to this file
+ *   ENERGY_BENCH_BASELINE   compare with results saved earlier
+ *   ENERGY_BENCH_TOLERANCE  allowed growth in percent [20]
+ *
+ * energy_uj is readable by root only on most kernels; without it the energy
+ * column shows n/a and everything else still runs.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run bench:energy
+ */
+
+#include <dirent.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "drag_session.h"
+#include "napi_smart_ptr.h"
+#include "napi_test_shim.h"
+#include "perf_counters.h"
+
+using FileCataloger::ArenaChunkCache;
+using FileCataloger::DragSession;
+using FileCataloger::TrajectorySnapshot;
+using PerfCounters::Event;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t EnvOr(const char* name, uint64_t fallback) {
+    const char* value = std::getenv(name);
+    return value && *value ? std::strtoull(value, nullptr, 10) : fallback;
+}
+
+std::string EnvOr(const char* name, const char* fallback) {
+    const char* value = std::getenv(name);
+    return value && *value ? value : fallback;
+}
+
+// --- RAPL -------------------------------------------------------------------
+
+bool ReadCounter(const std::string& path, uint64_t& value) {
+    std::ifstream in(path);
+    return static_cast<bool>(in >> value);
+}
+
+// Package domains (intel-rapl:N, or amd-rapl on some kernels); subzones such
+// as core and dram are parts of a package and would double count
+class Rapl {
+public:
+    explicit Rapl(const std::string& root) {
+        DIR* dir = opendir(root.c_str());
+        if (!dir) {
+            return;
+        }
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.find("-rapl:") == std::string::npos ||
+                std::count(name.begin(), name.end(), ':') != 1) {
+                continue;
+            }
+            Zone zone;
+            zone.path = root + "/" + name;
+            uint64_t energy = 0;
+            if (!ReadCounter(zone.path + "/energy_uj", energy)) {
+                unreadable_ = true;
+                continue;
+            }
+            if (!ReadCounter(zone.path + "/max_energy_range_uj", zone.range)) {
+                zone.range = 0;
+            }
+            std::ifstream label(zone.path + "/name");
+            std::getline(label, zone.name);
+            zones_.push_back(zone);
+        }
+        closedir(dir);
+        std::sort(zones_.begin(), zones_.end(), [](const Zone& a, const Zone& b) { return a.path < b.path; });
+    }
+
+    bool Available() const { return !zones_.empty(); }
+    bool Unreadable() const { return unreadable_; }
+
+    std::string Describe() const {
+        std::string names;
+        for (const Zone& zone : zones_) {
+            names += (names.empty() ? "" : ", ") + zone.name;
+        }
+        return names;
+    }
+
+    std::vector<uint64_t> Read() const {
+        std::vector<uint64_t> values;
+        for (const Zone& zone : zones_) {
+            uint64_t value = 0;
+            ReadCounter(zone.path + "/energy_uj", value);
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    // Microjoules between two reads, across counter wraparound
+    uint64_t Delta(const std::vector<uint64_t>& before, const std::vector<uint64_t>& after) const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < zones_.size(); i++) {
+            total += after[i] >= before[i] ? after[i] - before[i] : zones_[i].range - before[i] + after[i];
+        }
+        return total;
+    }
+
+private:
+    struct Zone {
+        std::string path;
+        std::string name;
+        uint64_t range = 0;
+    };
+
+    std::vector<Zone> zones_;
+    bool unreadable_ = false;
+};
+
+// --- Process counters -------------------------------------------------------
+
+struct Counters {
+    Clock::time_point at;
+    double cpuMs = 0;
+    uint64_t voluntary = 0;
+    uint64_t involuntary = 0;
+    uint64_t jsCalls = 0;
+    uint64_t mouseEvents = 0;
+    std::vector<uint64_t> energy;
+    PerfCounters::Reading perf;
+};
+
+std::atomic<uint64_t> g_jsCalls{0};
+std::atomic<uint64_t> g_mouseEvents{0};
+
+Counters Sample(const Rapl& rapl, const PerfCounters::Group& perf) {
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    Counters counters;
+    counters.at = Clock::now();
+    counters.cpuMs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+                     (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+    counters.voluntary = static_cast<uint64_t>(usage.ru_nvcsw);
+    counters.involuntary = static_cast<uint64_t>(usage.ru_nivcsw);
+    counters.jsCalls = g_jsCalls.load(std::memory_order_relaxed);
+    counters.mouseEvents = g_mouseEvents.load(std::memory_order_relaxed);
+    counters.energy = rapl.Read();
+    counters.perf = perf.Read();
+    return counters;
+}
+
+// Rates per second of one scenario run
+struct Result {
+    double cpuMsPerSec = 0;
+    double wakeupsPerSec = 0;
+    double preemptionsPerSec = 0;
+    double jsCallsPerSec = 0;
+    double milliwatts = -1;  // package power; negative when RAPL is unavailable
+    // Per mouse event, or per second without events; negative when unavailable
+    double perEvent[PerfCounters::kEventCount] = {};
+};
+
+Result Rates(const Rapl& rapl, const Counters& before, const Counters& after) {
+    double seconds = std::chrono::duration<double>(after.at - before.at).count();
+    Result result;
+    result.cpuMsPerSec = (after.cpuMs - before.cpuMs) / seconds;
+    result.wakeupsPerSec = (after.voluntary - before.voluntary) / seconds;
+    result.preemptionsPerSec = (after.involuntary - before.involuntary) / seconds;
+    result.jsCallsPerSec = (after.jsCalls - before.jsCalls) / seconds;
+    if (rapl.Available()) {
+        result.milliwatts = rapl.Delta(before.energy, after.energy) / 1000.0 / seconds;
+    }
+    PerfCounters::Counts counts = PerfCounters::Delta(before.perf, after.perf);
+    uint64_t events = after.mouseEvents - before.mouseEvents;
+    for (size_t i = 0; i < PerfCounters::kEventCount; i++) {
+        result.perEvent[i] = !counts.valid[i] ? -1 : events ? counts.value[i] / events : counts.value[i] / seconds;
+    }
+    return result;
+}
+
+// --- Modules under test -----------------------------------------------------
+
+struct MoveData {
+    double x;
+    double y;
+    uint64_t timestamp;
+};
+
+using MoveDispatcher = FileCataloger::BatchedDispatcher<MoveData>;
+
+// Drag monitor side: sessions, chunk cache and the analysis thread
+class DragMonitorModel {
+public:
+    DragMonitorModel() : analysis_([this] { RunAnalysis(); }) {
+        for (size_t i = 0; i < 32; i++) {
+            paths_.push_back("/Users/test/Desktop/Screenshots/Screenshot " + std::to_string(i) + ".png");
+        }
+    }
+
+    ~DragMonitorModel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        analysis_.join();
+    }
+
+    void BeginDrag() {
+        session_ = std::make_shared<DragSession>(&cache_);
+        moves_ = 0;
+    }
+
+    void Move(double x, double y) {
+        session_->trajectory().Push({x, y});
+        moves_++;
+        if (moves_ % 10 == 0) {
+            if (TrajectorySnapshot* snapshot = session_->TakeSnapshot()) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    queue_.push_back({snapshot, session_});
+                }
+                cv_.notify_one();
+            }
+        }
+        if (moves_ == 20) {
+            session_->ReserveFilePaths(paths_.size());
+            for (const auto& path : paths_) {
+                session_->AddFilePath(path.c_str(), path.size());
+            }
+        }
+    }
+
+    // The path session stays until the next drag
+    void EndDrag() { pathSession_ = std::move(session_); }
+
+private:
+    struct Task {
+        TrajectorySnapshot* snapshot;
+        std::shared_ptr<DragSession> owner;
+    };
+
+    void RunAnalysis() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            Task task = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+
+            // Direction changes along x, as the shake detector counts them
+            int changes = 0;
+            for (size_t i = 2; i < task.snapshot->count; i++) {
+                double a = task.snapshot->points[i - 1].x - task.snapshot->points[i - 2].x;
+                double b = task.snapshot->points[i].x - task.snapshot->points[i - 1].x;
+                changes += (a > 0) != (b > 0);
+            }
+            shakes_ += changes >= 6;
+            DragSession::ReleaseSnapshot(task.snapshot);
+            task.owner.reset();
+
+            lock.lock();
+        }
+    }
+
+    ArenaChunkCache cache_;
+    std::shared_ptr<DragSession> session_;
+    std::shared_ptr<DragSession> pathSession_;
+    std::vector<std::string> paths_;
+    int moves_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> queue_;
+    bool stopping_ = false;
+    uint64_t shakes_ = 0;
+    std::thread analysis_;
+};
+
+// Both modules, started the way the app starts them
+class Modules {
+public:
+    Modules()
+        : dispatcher_([](napi_env, napi_value, std::vector<MoveData>&, std::vector<MoveData>& moves) {
+              // DeliverBatch hands JS the latest move
+              g_jsCalls.fetch_add(1, std::memory_order_relaxed);
+              volatile double x = moves.empty() ? 0 : moves.back().x;
+              (void)x;
+          }) {
+        started_ = dispatcher_.Start(NapiTestShim::Env(), nullptr, "EnergyBenchMoves") == napi_ok;
+    }
+
+    ~Modules() { dispatcher_.Stop(); }
+
+    bool Started() const { return started_; }
+    MoveDispatcher& dispatcher() { return dispatcher_; }
+    DragMonitorModel& drags() { return drags_; }
+
+private:
+    MoveDispatcher dispatcher_;
+    DragMonitorModel drags_;
+    bool started_ = false;
+};
+
+// --- Scenarios --------------------------------------------------------------
+
+using Scenario = std::function<void(Modules&, Clock::time_point end, uint64_t hz)>;
+
+void Idle(Modules&, Clock::time_point end, uint64_t) {
+    std::this_thread::sleep_until(end);
+}
+
+void Motion(Modules& modules, Clock::time_point end, uint64_t hz) {
+    const auto period = std::chrono::nanoseconds(1000000000 / hz);
+    auto next = Clock::now();
+    uint64_t i = 0;
+    while (next < end) {
+        modules.dispatcher().Push({400.0 + (i % 300), 300.0 + (i % 200), i});
+        g_mouseEvents.fetch_add(1, std::memory_order_relaxed);
+        i++;
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void Drags(Modules& modules, Clock::time_point end, uint64_t hz) {
+    const auto period = std::chrono::nanoseconds(1000000000 / hz);
+    uint64_t i = 0;
+    while (Clock::now() < end) {
+        auto dragEnd = std::min(end, Clock::now() + std::chrono::seconds(1));
+        modules.drags().BeginDrag();
+        auto next = Clock::now();
+        while (next < dragEnd) {
+            // Side to side, fast enough to read as a shake now and then
+            double x = 400.0 + ((i / 8) % 2 ? 1 : -1) * static_cast<double>(i % 8) * 6;
+            double y = 300.0 + (i % 50);
+            modules.dispatcher().Push({x, y, i});
+            modules.drags().Move(x, y);
+            g_mouseEvents.fetch_add(1, std::memory_order_relaxed);
+            i++;
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+        modules.drags().EndDrag();
+        std::this_thread::sleep_until(std::min(end, Clock::now() + std::chrono::milliseconds(500)));
+    }
+}
+
+template<typename Get>
+double Median(std::vector<Result> results, Get get) {
+    std::sort(results.begin(), results.end(), [&](const Result& a, const Result& b) { return get(a) < get(b); });
+    return get(results[results.size() / 2]);
+}
+
+Result MedianOf(const std::vector<Result>& runs) {
+    Result median;
+    median.cpuMsPerSec = Median(runs, [](const Result& r) { return r.cpuMsPerSec; });
+    median.wakeupsPerSec = Median(runs, [](const Result& r) { return r.wakeupsPerSec; });
+    median.preemptionsPerSec = Median(runs, [](const Result& r) { return r.preemptionsPerSec; });
+    median.jsCallsPerSec = Median(runs, [](const Result& r) { return r.jsCallsPerSec; });
+    median.milliwatts = Median(runs, [](const Result& r) { return r.milliwatts; });
+    for (size_t i = 0; i < PerfCounters::kEventCount; i++) {
+        median.perEvent[i] = Median(runs, [i](const Result& r) { return r.perEvent[i]; });
+    }
+    return median;
+}
+
+// --- Saved results ----------------------------------------------------------
+
+struct Saved {
+    std::string scenario;
+    Result result;
+};
+
+// Scenarios are only comparable at the same length and input rate
+struct Settings {
+    uint64_t seconds = 0;
+    uint64_t hz = 0;
+};
+
+bool Save(const std::string& path, const Settings& settings, const std::vector<Saved>& rows) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "# seconds=%llu hz=%llu\n", static_cast<unsigned long long>(settings.seconds),
+                 static_cast<unsigned long long>(settings.hz));
+    std::fprintf(file, "scenario\tcpu_ms_per_s\twakeups_per_s\tpreemptions_per_s\tjs_calls_per_s\tmw\n");
+    for (const Saved& row : rows) {
+        std::fprintf(file, "%s\t%.4f\t%.3f\t%.3f\t%.3f\t%.1f\n", row.scenario.c_str(), row.result.cpuMsPerSec,
+                     row.result.wakeupsPerSec, row.result.preemptionsPerSec, row.result.jsCallsPerSec,
+                     row.result.milliwatts);
+    }
+    return std::fclose(file) == 0;
+}
+
+std::vector<Saved> Load(const std::string& path, Settings& settings) {
+    std::vector<Saved> rows;
+    std::ifstream in(path);
+    std::string line;
+    unsigned long long seconds = 0;
+    unsigned long long hz = 0;
+    if (!std::getline(in, line) || std::sscanf(line.c_str(), "# seconds=%llu hz=%llu", &seconds, &hz) != 2) {
+        return rows;
+    }
+    settings.seconds = seconds;
+    settings.hz = hz;
+    std::getline(in, line);  // column names
+    while (std::getline(in, line)) {
+        char scenario[32];
+        Saved row;
+        if (std::sscanf(line.c_str(), "%31s %lf %lf %lf %lf %lf", scenario, &row.result.cpuMsPerSec,
+                        &row.result.wakeupsPerSec, &row.result.preemptionsPerSec, &row.result.jsCallsPerSec,
+                        &row.result.milliwatts) == 6) {
+            row.scenario = scenario;
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+// Growth beyond tolerance and beyond the absolute floor
+bool Regressed(double before, double after, double tolerance, double floor) {
+    return after - before > floor && after > before * (1 + tolerance / 100);
+}
+
+void PrintEnergy(double milliwatts) {
+    if (milliwatts < 0) {
+        std::printf(" %9s", "n/a");
+    } else {
+        std::printf(" %9.1f", milliwatts);
+    }
+}
+
+void PrintCount(double value, int width, int precision) {
+    if (value < 0) {
+        std::printf(" %*s", width, "n/a");
+    } else {
+        std::printf(" %*.*f", width, precision, value);
+    }
+}
+
+void PrintPerfRow(const Saved& row) {
+    const Result& result = row.result;
+    double cycles = result.perEvent[static_cast<size_t>(Event::Cycles)];
+    double instructions = result.perEvent[static_cast<size_t>(Event::Instructions)];
+    std::printf("%-8s", row.scenario.c_str());
+    PrintCount(cycles, 10, 0);
+    PrintCount(instructions, 10, 0);
+    PrintCount(cycles > 0 && instructions >= 0 ? instructions / cycles : -1, 6, 2);
+    PrintCount(result.perEvent[static_cast<size_t>(Event::L1dMisses)], 9, 1);
+    PrintCount(result.perEvent[static_cast<size_t>(Event::LlcMisses)], 9, 2);
+    PrintCount(result.perEvent[static_cast<size_t>(Event::BranchMisses)], 9, 1);
+    PrintCount(result.perEvent[static_cast<size_t>(Event::ContextSwitches)], 8, 3);
+    std::printf("\n");
+}
+
+} // namespace
+
+int main() {
+    // Before any thread starts, so inherit covers all of them
+    PerfCounters::Group perf;
+
+    const uint64_t seconds = std::max<uint64_t>(EnvOr("ENERGY_BENCH_SECONDS", 10), 1);
+    const uint64_t runs = std::max<uint64_t>(EnvOr("ENERGY_BENCH_RUNS", 3), 1);
+    const uint64_t hz = std::max<uint64_t>(EnvOr("ENERGY_BENCH_HZ", 120), 1);
+    const double tolerance = static_cast<double>(EnvOr("ENERGY_BENCH_TOLERANCE", 20));
+    const std::string savePath = EnvOr("ENERGY_BENCH_SAVE", "");
+    const std::string baselinePath = EnvOr("ENERGY_BENCH_BASELINE", "");
+
+    Rapl rapl(EnvOr("ENERGY_BENCH_POWERCAP", "/sys/class/powercap"));
+    if (rapl.Available()) {
+        std::printf("RAPL domains: %s\n", rapl.Describe().c_str());
+    } else if (rapl.Unreadable()) {
+        std::printf("RAPL energy_uj is not readable (run as root for energy); measuring CPU and wakeups only\n");
+    } else {
+        std::printf("No RAPL counters found; measuring CPU and wakeups only\n");
+    }
+    std::string unavailable = perf.Describe();
+    if (!unavailable.empty()) {
+        std::printf("Unavailable performance counters:\n%s", unavailable.c_str());
+    }
+    std::printf("%llu runs of %llus per scenario, %llu mouse events/s while moving\n\n",
+                static_cast<unsigned long long>(runs), static_cast<unsigned long long>(seconds),
+                static_cast<unsigned long long>(hz));
+
+    const Settings settings = {seconds, hz};
+    std::vector<Saved> baseline;
+    if (!baselinePath.empty()) {
+        Settings saved;
+        baseline = Load(baselinePath, saved);
+        if (baseline.empty()) {
+            std::fprintf(stderr, "FAIL: no results in %s\n", baselinePath.c_str());
+            return 1;
+        }
+        if (saved.seconds != settings.seconds || saved.hz != settings.hz) {
+            std::fprintf(stderr, "FAIL: %s ran %llus per scenario at %llu Hz; run with the same settings\n",
+                         baselinePath.c_str(), static_cast<unsigned long long>(saved.seconds),
+                         static_cast<unsigned long long>(saved.hz));
+            return 1;
+        }
+    }
+
+    // The machine's draw with the bench asleep; scenarios report power above it
+    double backgroundMw = -1;
+    if (rapl.Available()) {
+        std::vector<Result> idleMachine;
+        for (uint64_t run = 0; run < runs; run++) {
+            Counters before = Sample(rapl, perf);
+            std::this_thread::sleep_for(std::chrono::seconds(seconds));
+            idleMachine.push_back(Rates(rapl, before, Sample(rapl, perf)));
+        }
+        backgroundMw = MedianOf(idleMachine).milliwatts;
+        std::printf("Background package power: %.1f mW\n\n", backgroundMw);
+    }
+
+    std::thread jsThread(NapiTestShim::RunJsThread);
+
+    const struct {
+        const char* name;
+        Scenario run;
+    } scenarios[] = {
+        {"idle", Idle},
+        {"motion", Motion},
+        {"drags", Drags},
+    };
+
+    std::printf("%-8s %10s %9s %10s %11s %9s", "scenario", "cpu ms/s", "cpu %", "wakeups/s", "preempts/s",
+                "js calls/s");
+    std::printf(" %9s\n", "+mW");
+
+    std::vector<Saved> rows;
+    bool ok = true;
+    for (const auto& scenario : scenarios) {
+        std::vector<Result> results;
+        for (uint64_t run = 0; run < runs; run++) {
+            Modules modules;
+            if (!modules.Started()) {
+                std::fprintf(stderr, "FAIL: dispatcher did not start\n");
+                ok = false;
+                break;
+            }
+            // Let thread startup settle out of the measurement
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+            Counters before = Sample(rapl, perf);
+            scenario.run(modules, Clock::now() + std::chrono::seconds(seconds), hz);
+            Result result = Rates(rapl, before, Sample(rapl, perf));
+            if (result.milliwatts >= 0) {
+                result.milliwatts = std::max(0.0, result.milliwatts - backgroundMw);
+            }
+            results.push_back(result);
+        }
+        if (results.empty()) {
+            break;
+        }
+
+        Result median = MedianOf(results);
+        rows.push_back({scenario.name, median});
+        std::printf("%-8s %10.3f %9.3f %10.1f %11.1f %9.1f", scenario.name, median.cpuMsPerSec,
+                    median.cpuMsPerSec / 10, median.wakeupsPerSec, median.preemptionsPerSec, median.jsCallsPerSec);
+        PrintEnergy(median.milliwatts);
+        std::printf("\n");
+
+        for (const Saved& saved : baseline) {
+            if (saved.scenario != scenario.name) {
+                continue;
+            }
+            std::printf("%-8s %10.3f %9.3f %10.1f %11.1f %9.1f", "  before", saved.result.cpuMsPerSec,
+                        saved.result.cpuMsPerSec / 10, saved.result.wakeupsPerSec, saved.result.preemptionsPerSec,
+                        saved.result.jsCallsPerSec);
+            PrintEnergy(saved.result.milliwatts);
+            std::printf("\n");
+
+            // Floors: 0.5 ms of CPU and 5 wakeups per second
+            if (Regressed(saved.result.cpuMsPerSec, median.cpuMsPerSec, tolerance, 0.5)) {
+                std::fprintf(stderr, "FAIL: %s CPU time grew from %.3f to %.3f ms/s\n", scenario.name,
+                             saved.result.cpuMsPerSec, median.cpuMsPerSec);
+                ok = false;
+            }
+            if (Regressed(saved.result.wakeupsPerSec, median.wakeupsPerSec, tolerance, 5)) {
+                std::fprintf(stderr, "FAIL: %s wakeups grew from %.1f to %.1f per second\n", scenario.name,
+                             saved.result.wakeupsPerSec, median.wakeupsPerSec);
+                ok = false;
+            }
+        }
+    }
+
+    NapiTestShim::StopJsThread();
+    jsThread.join();
+
+    std::printf("\nCounters per mouse event (idle: per second)\n");
+    std::printf("%-8s %10s %10s %6s %9s %9s %9s %8s\n", "scenario", "cycles", "instrs", "IPC", "L1d miss",
+                "LLC miss", "br miss", "ctx sw");
+    for (const Saved& row : rows) {
+        PrintPerfRow(row);
+    }
+
+    if (!savePath.empty()) {
+        if (Save(savePath, settings, rows)) {
+            std::printf("\nSaved to %s\n", savePath.c_str());
+        } else {
+            std::fprintf(stderr, "FAIL: could not write %s\n", savePath.c_str());
+            ok = false;
+        }
+    }
+
+    if (!baseline.empty()) {
+        std::printf(ok ? "PASS\n" : "FAIL\n");
+    }
+    return ok ? 0 : 1;
+}
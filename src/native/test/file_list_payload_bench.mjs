@@ -0,0 +1,206 @@
+/**
+ * @fileoverview Benchmark: file-list payload vs arrays of objects
+ *
+ * Creates (once) ITEMS files under the temp directory and times the steps a
+ * file list takes from the main process to a renderer:
+ *   - building it: file-ops statFileList (stat + encode on the pool) vs
+ *     fs.promises.stat per path into DraggedItem-shaped objects
+ *   - the hop: posting it through a MessageChannel, the objects cloned vs
+ *     the payload's ArrayBuffer transferred
+ *   - reading it: every path, and the first VISIBLE rows plus every
+ *     isDirectory flag (what a list view needs first)
+ *
+ * The reader below mirrors FileListView in src/shared/fileListPayload.ts,
+ * which this plain .mjs cannot import.
+ *
+ * Usage (from src/native):
+ *   npm run bench:file-list
+ *   ITEMS=200000 RUNS=5 node test/file_list_payload_bench.mjs
+ */
+
+import { createRequire } from 'module';
+import { promises as fs, existsSync, mkdirSync, writeFileSync } from 'fs';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { MessageChannel, receiveMessageOnPort } from 'worker_threads';
+
+const require = createRequire(import.meta.url);
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const ITEMS = Number(process.env.ITEMS || 50000);
+const RUNS = Number(process.env.RUNS || 5);
+const VISIBLE = 50;
+
+const native = require(
+  path.join(__dirname, '..', 'file-ops', 'build', 'Release', `file_ops_${process.platform}.node`)
+);
+
+function makeFiles(root) {
+  const paths = [];
+  const extensions = ['jpg', 'HEIC', 'pdf', 'docx', 'mov', ''];
+  for (let i = 0; i < ITEMS; i++) {
+    const dir = path.join(root, `folder ${Math.floor(i / 1000)}`);
+    const extension = extensions[i % extensions.length];
+    paths.push(path.join(dir, `Holiday photo ${i}${extension ? '.' + extension : ''}`));
+  }
+  const marker = path.join(root, '.complete');
+  if (!existsSync(marker)) {
+    console.log(`Creating ${ITEMS} files under ${root} ...`);
+    for (const filePath of paths) {
+      mkdirSync(path.dirname(filePath), { recursive: true });
+      writeFileSync(filePath, 'x'.repeat(filePath.length % 64));
+    }
+    writeFileSync(marker, '');
+  }
+  return paths;
+}
+
+// --- Reader (mirrors FileListView) ----------------------------------------
+
+const decoder = new TextDecoder();
+
+class FileListView {
+  constructor(buffer) {
+    const header = new DataView(buffer, 0, 16);
+    if (header.getUint32(0, true) !== 0x4c464346) throw new Error('Not a file list payload');
+    this.length = header.getUint32(8, true);
+    const stringsStart = 16 + this.length * 32;
+    this.words = new Uint32Array(buffer, 16, this.length * 8);
+    this.sizes = new Float64Array(buffer, 16, this.length * 4);
+    this.strings = new Uint8Array(buffer, stringsStart, header.getUint32(12, true));
+  }
+  decode(offset, length) {
+    return decoder.decode(this.strings.subarray(offset, offset + length));
+  }
+  path(i) {
+    return this.decode(this.words[i * 8], this.words[i * 8 + 1]);
+  }
+  name(i) {
+    return this.decode(this.words[i * 8 + 2], this.words[i * 8 + 3]);
+  }
+  size(i) {
+    const size = this.sizes[i * 4 + 3];
+    return Number.isNaN(size) ? undefined : size;
+  }
+  isDirectory(i) {
+    return (this.words[i * 8 + 5] >>> 16 & 1) !== 0;
+  }
+}
+
+// --- Builders ---------------------------------------------------------------
+
+function nativePayload(paths) {
+  return native.statFileList(paths);
+}
+
+async function jsObjects(paths) {
+  return Promise.all(
+    paths.map(async filePath => {
+      const name = path.basename(filePath);
+      const extension = path.extname(name).slice(1) || undefined;
+      try {
+        const stats = await fs.stat(filePath);
+        const isDirectory = stats.isDirectory();
+        return {
+          path: filePath,
+          name,
+          type: isDirectory ? 'folder' : 'file',
+          isDirectory,
+          isFile: !isDirectory,
+          exists: true,
+          extension,
+          size: isDirectory ? undefined : stats.size,
+        };
+      } catch {
+        return { path: filePath, name, type: 'file', isDirectory: false, isFile: true, exists: false, extension };
+      }
+    })
+  );
+}
+
+// --- Harness ----------------------------------------------------------------
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+async function bench(name, fn) {
+  await fn(); // warm-up: page cache, JIT
+  const times = [];
+  let result;
+  for (let i = 0; i < RUNS; i++) {
+    const start = process.hrtime.bigint();
+    result = await fn();
+    times.push(Number(process.hrtime.bigint() - start) / 1e6);
+  }
+  const ms = median(times);
+  console.log(`${name.padEnd(46)} ${ms.toFixed(2).padStart(9)} ms`);
+  return { ms, result };
+}
+
+// Post through a real port and take the message off the other end
+function hop(message, transfer) {
+  const { port1, port2 } = new MessageChannel();
+  port1.postMessage(message, transfer);
+  const received = receiveMessageOnPort(port2).message;
+  port1.close();
+  port2.close();
+  return received;
+}
+
+const root = path.join(os.tmpdir(), `file_list_payload_bench_${ITEMS}`);
+const paths = makeFiles(root);
+console.log(`\nNode ${process.version}, ${os.cpus().length} CPUs, ${ITEMS} items, median of ${RUNS} runs\n`);
+
+const built = await bench('build: native statFileList', () => nativePayload(paths));
+const objects = await bench('build: fs.promises.stat → objects', () => jsObjects(paths));
+const payloadBytes = built.result.byteLength;
+console.log(`  payload ${(payloadBytes / 1024).toFixed(0)} KiB (${(payloadBytes / ITEMS).toFixed(1)} B/item)\n`);
+
+const clonedHop = await bench('hop: objects, structured clone', () => hop(objects.result));
+const transferHop = await bench('hop: payload, transferred', () => {
+  const copy = built.result.slice(0); // the transfer detaches its buffer
+  return hop(copy, [copy]);
+});
+const copiedHop = await bench('hop: payload, cloned', () => hop(built.result));
+console.log();
+
+const readObjects = await bench('read all paths: objects', () => {
+  let total = 0;
+  for (const item of clonedHop.result) total += item.path.length;
+  return total;
+});
+const readView = await bench('read all paths: FileListView', () => {
+  const view = new FileListView(transferHop.result);
+  let total = 0;
+  for (let i = 0; i < view.length; i++) total += view.path(i).length;
+  return total;
+});
+const visible = await bench(`read ${VISIBLE} rows + all flags: FileListView`, () => {
+  const view = new FileListView(transferHop.result);
+  let folders = 0;
+  for (let i = 0; i < view.length; i++) if (view.isDirectory(i)) folders++;
+  const rows = [];
+  for (let i = 0; i < Math.min(VISIBLE, view.length); i++) {
+    rows.push({ name: view.name(i), size: view.size(i) });
+  }
+  return { folders, rows };
+});
+
+// Both encodings must describe the same files
+const view = new FileListView(built.result);
+let mismatches = 0;
+for (let i = 0; i < ITEMS; i++) {
+  const item = objects.result[i];
+  if (view.path(i) !== item.path || view.name(i) !== item.name || view.size(i) !== item.size) mismatches++;
+}
+console.log(mismatches === 0 ? '\npayload matches the objects' : `\nMISMATCH in ${mismatches} items`);
+
+const objectTotal = objects.ms + clonedHop.ms + readObjects.ms;
+const payloadTotal = built.ms + transferHop.ms + readView.ms;
+console.log(`build + hop + read all, objects:  ${objectTotal.toFixed(1)} ms`);
+console.log(`build + hop + read all, payload:  ${payloadTotal.toFixed(1)} ms`);
+console.log(`hop speedup (transfer vs clone):  ${(clonedHop.ms / transferHop.ms).toFixed(0)}x`);
+console.log(`first rows vs reading every path: ${(readView.ms / visible.ms).toFixed(1)}x faster`);
@@ -0,0 +1,279 @@
+/**
+ * @file file_list_payload_test.cc
+ * @brief Functional test for the compact file-list payload
+ *
+ * Encodes entries with FileListPayloadWriter and reads them back through a
+ * decoder that follows the documented layout byte by byte (as FileListView
+ * does in TypeScript): header fields, record offsets, names and extensions
+ * sharing their path's bytes, copies for those that do not, flags, NaN
+ * sizes and padding. Then stats a directory of files, folders, symlinks and
+ * missing paths with StatFileList, including a bulk batch whose records
+ * must come back in path order.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "file_list_payload.h"
+#include "file_list_stat.h"
+#include "test_support.h"
+
+using FileCataloger::FileListBatch;
+using FileCataloger::FileListEntry;
+using FileCataloger::FileListPayloadWriter;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+uint32_t Read32(const std::vector<uint8_t>& bytes, size_t offset) {
+    return bytes[offset] | (bytes[offset + 1] << 8) | (bytes[offset + 2] << 16) |
+           (static_cast<uint32_t>(bytes[offset + 3]) << 24);
+}
+
+uint16_t Read16(const std::vector<uint8_t>& bytes, size_t offset) {
+    return static_cast<uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+}
+
+struct Decoded {
+    std::string path;
+    std::string name;
+    std::string extension;
+    uint16_t flags;
+    double size;
+    uint32_t pathOffset;
+    uint32_t nameOffset;
+    uint32_t extensionOffset;
+};
+
+// Reads the payload as documented in file_list_payload.h
+std::vector<Decoded> Decode(const std::vector<uint8_t>& payload, uint32_t* stringBytes) {
+    std::vector<Decoded> entries;
+    EXPECT(payload.size() >= 16 && payload.size() % 8 == 0, "payload size %zu", payload.size());
+    EXPECT(Read32(payload, 0) == FileCataloger::FILE_LIST_PAYLOAD_MAGIC, "magic");
+    EXPECT(Read16(payload, 4) == 1, "version %u", Read16(payload, 4));
+    EXPECT(Read16(payload, 6) == 32, "record size %u", Read16(payload, 6));
+    uint32_t count = Read32(payload, 8);
+    *stringBytes = Read32(payload, 12);
+    size_t strings = 16 + size_t(count) * 32;
+    EXPECT(strings + *stringBytes <= payload.size(), "string table past the end");
+    if (strings + *stringBytes > payload.size()) {
+        return entries;
+    }
+
+    auto text = [&](uint32_t offset, uint32_t length) {
+        EXPECT(offset + length <= *stringBytes, "string %u+%u outside the table", offset, length);
+        return std::string(reinterpret_cast<const char*>(payload.data()) + strings + offset, length);
+    };
+    for (uint32_t i = 0; i < count; i++) {
+        size_t record = 16 + size_t(i) * 32;
+        Decoded entry;
+        entry.pathOffset = Read32(payload, record);
+        entry.path = text(entry.pathOffset, Read32(payload, record + 4));
+        entry.nameOffset = Read32(payload, record + 8);
+        entry.name = text(entry.nameOffset, Read32(payload, record + 12));
+        entry.extensionOffset = Read32(payload, record + 16);
+        entry.extension = text(entry.extensionOffset, Read16(payload, record + 20));
+        entry.flags = Read16(payload, record + 22);
+        uint64_t bits = Read32(payload, record + 24) | (uint64_t(Read32(payload, record + 28)) << 32);
+        std::memcpy(&entry.size, &bits, sizeof(entry.size));
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+void TestWriter() {
+    FileListPayloadWriter writer;
+    std::vector<uint8_t> empty = writer.Finish();
+    uint32_t stringBytes = 0;
+    EXPECT(empty.size() == 16, "empty payload is %zu bytes", empty.size());
+    EXPECT(Decode(empty, &stringBytes).empty(), "empty payload has records");
+
+    FileListEntry photo;
+    photo.path = "/Users/me/Pictures/IMG_0001.HEIC";
+    photo.name = "IMG_0001.HEIC";
+    photo.extension = "HEIC";
+    photo.flags = FileCataloger::FILE_LIST_IS_FILE | FileCataloger::FILE_LIST_EXISTS;
+    photo.size = 3145728;
+    writer.Add(photo);
+
+    FileListEntry folder;
+    folder.path = "/Users/me/Documents";
+    folder.name = "Documents";
+    folder.flags = FileCataloger::FILE_LIST_IS_DIRECTORY | FileCataloger::FILE_LIST_EXISTS;
+    writer.Add(folder);
+
+    // Name and extension that are not tails of the path get their own bytes
+    FileListEntry renamed;
+    renamed.path = "/tmp/r\xC3\xA9sum\xC3\xA9.pdf";
+    renamed.name = "CV";
+    renamed.extension = "pdf";
+    renamed.flags = FileCataloger::FILE_LIST_IS_FILE;
+    writer.Add(renamed);
+
+    std::vector<uint8_t> payload = writer.Finish();
+    EXPECT(payload.size() == writer.ByteLength(), "Finish wrote %zu of %zu bytes",
+           payload.size(), writer.ByteLength());
+    std::vector<Decoded> entries = Decode(payload, &stringBytes);
+    EXPECT(entries.size() == 3, "decoded %zu entries", entries.size());
+    if (entries.size() != 3) {
+        return;
+    }
+
+    EXPECT(entries[0].path == photo.path, "path %s", entries[0].path.c_str());
+    EXPECT(entries[0].name == "IMG_0001.HEIC", "name %s", entries[0].name.c_str());
+    EXPECT(entries[0].extension == "HEIC", "extension %s", entries[0].extension.c_str());
+    EXPECT(entries[0].nameOffset == entries[0].pathOffset + 19, "name not shared with the path");
+    EXPECT(entries[0].extensionOffset == entries[0].nameOffset + 9, "extension not shared");
+    EXPECT(entries[0].flags == (FileCataloger::FILE_LIST_IS_FILE | FileCataloger::FILE_LIST_EXISTS),
+           "flags %u", entries[0].flags);
+    EXPECT(entries[0].size == 3145728.0, "size %f", entries[0].size);
+
+    EXPECT(entries[1].name == "Documents" && entries[1].extension.empty(), "folder name");
+    EXPECT(entries[1].flags & FileCataloger::FILE_LIST_IS_DIRECTORY, "folder flags %u", entries[1].flags);
+    EXPECT(std::isnan(entries[1].size), "folder size %f", entries[1].size);
+
+    EXPECT(entries[2].path == renamed.path, "UTF-8 path %s", entries[2].path.c_str());
+    EXPECT(entries[2].name == "CV" && entries[2].extension == "pdf", "copied name %s.%s",
+           entries[2].name.c_str(), entries[2].extension.c_str());
+    EXPECT(!(entries[2].flags & FileCataloger::FILE_LIST_EXISTS), "missing file flags");
+
+    size_t pathBytes = photo.path.size() + folder.path.size() + renamed.path.size();
+    EXPECT(stringBytes == pathBytes + 2 + 3, "string table %u bytes, paths %zu", stringBytes, pathBytes);
+    for (size_t i = 16 + 3 * 32 + stringBytes; i < payload.size(); i++) {
+        EXPECT(payload[i] == 0, "padding byte %zu is %u", i, payload[i]);
+    }
+}
+
+void TestNames() {
+    using FileCataloger::FileListExtension;
+    using FileCataloger::FileListName;
+    EXPECT(FileListName("/a/b/c.txt") == "c.txt", "basename");
+    EXPECT(FileListName("/a/folder/") == "folder", "trailing slash");
+    EXPECT(FileListName("relative") == "relative", "no slash");
+    EXPECT(FileListName("/") == "", "root");
+    EXPECT(FileListExtension("archive.tar.gz") == "gz", "last dot");
+    EXPECT(FileListExtension(".bashrc").empty(), "leading dot");
+    EXPECT(FileListExtension("Makefile").empty(), "no dot");
+    EXPECT(FileListExtension("trailing.").empty(), "trailing dot");
+}
+
+std::shared_ptr<FileListBatch> Stat(WorkStealingPool& pool, std::shared_ptr<FileListBatch> batch,
+                                    int* calls) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::shared_ptr<FileListBatch> result;
+    FileCataloger::StatFileList(pool, std::move(batch), [&](std::shared_ptr<FileListBatch> done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = std::move(done);
+        (*calls)++;
+        cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return result != nullptr; });
+    return result;
+}
+
+void TestStat(const std::string& root) {
+    WriteFile(root + "/notes.txt", 1234);
+    mkdir((root + "/Photos.album").c_str(), 0755);
+    EXPECT(symlink((root + "/notes.txt").c_str(), (root + "/link").c_str()) == 0, "symlink");
+
+    auto batch = std::make_shared<FileListBatch>();
+    batch->paths = {root + "/notes.txt", root + "/Photos.album/", root + "/link", root + "/missing.doc"};
+
+    WorkStealingPool pool(4);
+    int calls = 0;
+    auto result = Stat(pool, batch, &calls);
+    uint32_t stringBytes = 0;
+    std::vector<Decoded> entries = Decode(result->payload, &stringBytes);
+    EXPECT(entries.size() == 4, "decoded %zu entries", entries.size());
+    if (entries.size() == 4) {
+        using namespace FileCataloger;
+        EXPECT(entries[0].name == "notes.txt" && entries[0].extension == "txt", "file name");
+        EXPECT(entries[0].flags == (FILE_LIST_IS_FILE | FILE_LIST_EXISTS), "file flags %u", entries[0].flags);
+        EXPECT(entries[0].size == 1234.0, "file size %f", entries[0].size);
+
+        EXPECT(entries[1].name == "Photos.album" && entries[1].extension == "album", "folder name %s",
+               entries[1].name.c_str());
+        EXPECT(entries[1].flags == (FILE_LIST_IS_DIRECTORY | FILE_LIST_EXISTS), "folder flags %u",
+               entries[1].flags);
+        EXPECT(std::isnan(entries[1].size), "folder size %f", entries[1].size);
+
+        EXPECT(entries[2].size == 1234.0, "symlink not followed: %f", entries[2].size);
+
+        EXPECT(entries[3].flags == FILE_LIST_IS_FILE, "missing flags %u", entries[3].flags);
+        EXPECT(std::isnan(entries[3].size), "missing size %f", entries[3].size);
+    }
+
+    calls = 0;
+    auto emptyResult = Stat(pool, std::make_shared<FileListBatch>(), &calls);
+    EXPECT(calls == 1 && emptyResult->payload.size() == 16, "empty batch");
+}
+
+void TestBulk(const std::string& root) {
+    const size_t count = 5000;
+    mkdir((root + "/bulk").c_str(), 0755);
+    auto batch = std::make_shared<FileListBatch>();
+    for (size_t i = 0; i < count; i++) {
+        std::string path = root + "/bulk/f" + std::to_string(i) + ".dat";
+        WriteFile(path, i % 97);
+        batch->paths.push_back(path);
+    }
+
+    WorkStealingPool pool(4);
+    int calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto result = Stat(pool, batch, &calls);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    uint32_t stringBytes = 0;
+    std::vector<Decoded> entries = Decode(result->payload, &stringBytes);
+    EXPECT(calls == 1, "done called %d times", calls);
+    EXPECT(entries.size() == count, "decoded %zu entries", entries.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].path != batch->paths[i] || entries[i].size != double(i % 97)) {
+            mismatches++;
+        }
+    }
+    EXPECT(mismatches == 0, "%zu entries out of order or wrong", mismatches);
+    std::printf("  %zu files stat'ed and encoded in %.1f ms, %zu bytes\n", count, ms,
+                result->payload.size());
+}
+
+} // namespace
+
+int main() {
+    char pattern[] = "/tmp/file_list_payload_test.XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        return 2;
+    }
+
+    TestWriter();
+    TestNames();
+    TestStat(root);
+    TestBulk(root);
+
+    std::string cleanup = std::string("rm -rf '") + root + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", root);
+    }
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
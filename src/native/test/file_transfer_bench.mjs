@@ -0,0 +1,219 @@
+/**
+ * @fileoverview Benchmark: native copy/move engine vs fs.promises.cp
+ *
+ * Builds a corpus of one LARGE_MB file and SMALL_FILES 16KB files in nested
+ * folders, then copies it with each method of the native engine and with
+ * fs.promises.cp, on every filesystem pair available:
+ *   - tmpfs -> tmpfs (/dev/shm)
+ *   - ext4 -> ext4 and tmpfs -> ext4 (a loopback image; needs root)
+ *   - btrfs -> btrfs and xfs -> xfs (reflink), when mkfs.btrfs / mkfs.xfs exist
+ * and finally times a move within one filesystem and across two.
+ *
+ * Source data stays in the page cache, so these are CPU/memory-bound
+ * copies: they show what each method costs per byte, not disk speed.
+ *
+ * Usage (from src/native, as root for the loopback filesystems):
+ *   npm run bench:file-transfer
+ *   LARGE_MB=64 SMALL_FILES=500 RUNS=3 node test/file_transfer_bench.mjs
+ */
+
+import { execFileSync } from 'child_process';
+import { createRequire } from 'module';
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const require = createRequire(import.meta.url);
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const LARGE_MB = Number(process.env.LARGE_MB || 256);
+const SMALL_FILES = Number(process.env.SMALL_FILES || 2000);
+const RUNS = Number(process.env.RUNS || 3);
+const IMAGE_MB = Math.max(256, LARGE_MB * 3 + Math.ceil((SMALL_FILES * 16) / 1024) * 4 + 128);
+
+const native = require(
+  path.join(__dirname, '..', 'file-ops', 'build', 'Release', `file_ops_${process.platform}.node`)
+);
+
+const mounts = [];
+
+function has(command) {
+  try {
+    execFileSync('sh', ['-c', `command -v ${command}`], { stdio: 'ignore' });
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+// Loopback filesystem in a sparse image; null when it cannot be mounted
+function mountImage(type, mkfsArgs) {
+  if (!has(`mkfs.${type}`)) return null;
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), `transfer-bench-${type}-`));
+  const image = `${dir}.img`;
+  try {
+    fs.closeSync(fs.openSync(image, 'w'));
+    fs.truncateSync(image, IMAGE_MB * 1024 * 1024);
+    execFileSync(`mkfs.${type}`, [...mkfsArgs, image], { stdio: 'ignore' });
+    execFileSync('mount', ['-o', 'loop', image, dir], { stdio: 'ignore' });
+  } catch {
+    fs.rmSync(image, { force: true });
+    fs.rmSync(dir, { recursive: true, force: true });
+    return null;
+  }
+  mounts.push({ dir, image });
+  return dir;
+}
+
+function cleanup() {
+  for (const { dir, image } of mounts) {
+    try {
+      execFileSync('umount', [dir], { stdio: 'ignore' });
+    } catch {
+      // Still busy or never mounted; leave it
+    }
+    fs.rmSync(image, { force: true });
+    fs.rmSync(dir, { recursive: true, force: true });
+  }
+}
+
+function makeCorpus(root) {
+  fs.mkdirSync(root, { recursive: true });
+  const chunk = Buffer.alloc(1 << 20);
+  for (let i = 0; i < chunk.length; i += 4) chunk.writeUInt32LE((i * 2654435761) >>> 0, i);
+  const fd = fs.openSync(path.join(root, 'large.bin'), 'w');
+  for (let i = 0; i < LARGE_MB; i++) fs.writeSync(fd, chunk);
+  fs.closeSync(fd);
+  const small = chunk.subarray(0, 16 * 1024);
+  for (let i = 0; i < SMALL_FILES; i++) {
+    const dir = path.join(root, 'small', String(i % 50));
+    if (i < 50) fs.mkdirSync(dir, { recursive: true });
+    fs.writeFileSync(path.join(dir, `${i}.dat`), small);
+  }
+}
+
+const TOTAL_BYTES = LARGE_MB * (1 << 20) + SMALL_FILES * 16 * 1024;
+
+function nativeTransfer(items, options) {
+  return new Promise((resolve, reject) => {
+    const transfer = new native.NativeFileTransfer();
+    transfer.start(items, options, (results, progress, summary) => {
+      if (!summary) return;
+      if (summary.failed) reject(new Error(`${summary.failed} item(s) failed`));
+      else resolve(summary);
+    });
+  });
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+async function bench(label, source, targetRoot, copy) {
+  const times = [];
+  let detail = '';
+  for (let i = 0; i < RUNS; i++) {
+    const destination = path.join(targetRoot, `copy-${i}`);
+    const start = process.hrtime.bigint();
+    const summary = await copy(source, destination);
+    times.push(Number(process.hrtime.bigint() - start) / 1e6);
+    fs.rmSync(destination, { recursive: true, force: true });
+    if (summary) {
+      detail = Object.entries(summary.methods)
+        .filter(([, count]) => count > 0)
+        .map(([method, count]) => `${method}:${count}`)
+        .join(' ');
+    }
+  }
+  const ms = median(times);
+  const mbps = TOTAL_BYTES / (1 << 20) / (ms / 1000);
+  console.log(`  ${label.padEnd(34)} ${ms.toFixed(1).padStart(9)} ms  ${mbps.toFixed(0).padStart(6)} MB/s  ${detail}`);
+}
+
+const VARIANTS = [
+  ['native, default chain', { methods: ['clone', 'copyFileRange', 'sendfile'] }],
+  ['native, copy_file_range only', { methods: ['copyFileRange'] }],
+  ['native, sendfile only', { methods: ['sendfile'] }],
+  ['native, read/write only', { methods: [] }],
+  ['native, read/write, 1 per device', { methods: [], perDeviceConcurrency: 1 }],
+];
+
+async function benchPair(label, sourceRoot, targetRoot) {
+  console.log(`\n${label}`);
+  for (const [name, options] of VARIANTS) {
+    await bench(name, sourceRoot, targetRoot, (source, destination) =>
+      nativeTransfer([{ source, destination }], { mode: 'copy', ...options })
+    );
+  }
+  await bench('fs.promises.cp', sourceRoot, targetRoot, async (source, destination) => {
+    await fs.promises.cp(source, destination, { recursive: true, preserveTimestamps: true });
+  });
+}
+
+async function benchMove(label, sourceRoot, targetRoot) {
+  // Move a private copy there and back, timing only the first leg
+  const scratch = path.join(path.dirname(sourceRoot), 'move-source');
+  fs.cpSync(sourceRoot, scratch, { recursive: true });
+  const destination = path.join(targetRoot, 'moved');
+  const start = process.hrtime.bigint();
+  const summary = await nativeTransfer([{ source: scratch, destination }], { mode: 'move' });
+  const ms = Number(process.hrtime.bigint() - start) / 1e6;
+  fs.rmSync(destination, { recursive: true, force: true });
+  fs.rmSync(scratch, { recursive: true, force: true });
+  const methods = Object.entries(summary.methods)
+    .filter(([, count]) => count > 0)
+    .map(([method, count]) => `${method}:${count}`)
+    .join(' ');
+  console.log(`  ${label.padEnd(34)} ${ms.toFixed(1).padStart(9)} ms  ${methods}`);
+}
+
+async function main() {
+  console.log(
+    `\nNode ${process.version}, ${os.cpus().length} CPUs, ${os.release()}, ` +
+      `${LARGE_MB}MB + ${SMALL_FILES} x 16KB, median of ${RUNS} runs`
+  );
+
+  const shm = fs.existsSync('/dev/shm') ? fs.mkdtempSync('/dev/shm/transfer-bench-') : null;
+  const ext4 = process.getuid?.() === 0 ? mountImage('ext4', ['-q', '-F']) : null;
+  const btrfs = process.getuid?.() === 0 ? mountImage('btrfs', ['-q', '-f']) : null;
+  const xfs = process.getuid?.() === 0 ? mountImage('xfs', ['-q', '-f', '-m', 'reflink=1']) : null;
+
+  try {
+    const filesystems = [
+      ['tmpfs', shm],
+      ['ext4', ext4],
+      ['btrfs', btrfs],
+      ['xfs', xfs],
+    ].filter(([, root]) => root);
+    for (const [, root] of filesystems) makeCorpus(path.join(root, 'corpus'));
+
+    for (const [name, root] of filesystems) {
+      await benchPair(`${name} -> ${name}`, path.join(root, 'corpus'), root);
+    }
+    if (shm && ext4) {
+      await benchPair('tmpfs -> ext4 (cross-device)', path.join(shm, 'corpus'), ext4);
+    }
+
+    console.log('\nmove');
+    for (const [name, root] of filesystems) {
+      await benchMove(`${name} -> ${name}`, path.join(root, 'corpus'), root);
+    }
+    if (shm && ext4) {
+      await benchMove('tmpfs -> ext4 (cross-device)', path.join(shm, 'corpus'), ext4);
+    }
+
+    const skipped = ['ext4', 'btrfs', 'xfs'].filter(name => !filesystems.some(([fs]) => fs === name));
+    if (skipped.length) console.log(`\nskipped (no mkfs or not root): ${skipped.join(', ')}`);
+  } finally {
+    cleanup();
+    if (shm) fs.rmSync(shm, { recursive: true, force: true });
+  }
+}
+
+main().catch(error => {
+  cleanup();
+  console.error(error);
+  process.exit(1);
+});
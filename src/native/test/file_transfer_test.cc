@@ -0,0 +1,394 @@
+/**
+ * @file file_transfer_test.cc
+ * @brief Functional test for the copy/move engine
+ *
+ * Copies files through each method of the fallback chain and checks the
+ * bytes, mode and mtime that arrive; then copies and moves a fixture tree
+ * (nested and read-only folders, a symlink, an empty file) with
+ * FileTransfer, with and without rename, and checks conflicts, overwrite,
+ * the per-device limit, cancellation, copies into the source's own
+ * subtree and that no ".fcpart" file is ever left behind.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "file_transfer.h"
+#include "test_support.h"
+
+using FileCataloger::ALL_TRANSFER_METHODS;
+using FileCataloger::CopyFileTo;
+using FileCataloger::FileTransfer;
+using FileCataloger::TransferItem;
+using FileCataloger::TransferMethod;
+using FileCataloger::TransferMethodBit;
+using FileCataloger::TransferMode;
+using FileCataloger::TransferOptions;
+using FileCataloger::TransferResult;
+using FileCataloger::TransferSummary;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+std::string g_root;
+
+std::string RandomBytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string data(size, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(rng());
+    }
+    return data;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::string data;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return "<missing>";
+    }
+    char buffer[65536];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return data;
+}
+
+bool Exists(const std::string& path) {
+    struct stat st;
+    return lstat(path.c_str(), &st) == 0;
+}
+
+// Old mtime, so a copy that does not preserve it is noticed
+void Backdate(const std::string& path) {
+    struct timespec times[2] = {{1000000000, 123456789}, {1000000000, 123456789}};
+    utimensat(AT_FDCWD, path.c_str(), times, AT_SYMLINK_NOFOLLOW);
+}
+
+// Relative path -> "type:mode:content" for every entry below root
+void Snapshot(const std::string& root, const std::string& relative, std::map<std::string, std::string>* out) {
+    DIR* dir = opendir((root + relative).c_str());
+    if (!dir) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+            continue;
+        }
+        std::string path = relative + "/" + entry->d_name;
+        struct stat st;
+        lstat((root + path).c_str(), &st);
+        char mode[32];
+        std::snprintf(mode, sizeof(mode), ":%o:%ld:", st.st_mode & 07777, static_cast<long>(st.st_mtim.tv_sec));
+        if (S_ISDIR(st.st_mode)) {
+            (*out)[path] = std::string("d") + mode;
+            Snapshot(root, path, out);
+        } else if (S_ISLNK(st.st_mode)) {
+            char target[256] = {};
+            readlink((root + path).c_str(), target, sizeof(target) - 1);
+            (*out)[path] = std::string("l:") + target;
+        } else {
+            (*out)[path] = std::string("f") + mode + ReadFile(root + path);
+        }
+    }
+    closedir(dir);
+}
+
+std::map<std::string, std::string> Snapshot(const std::string& root) {
+    std::map<std::string, std::string> out;
+    Snapshot(root, "", &out);
+    return out;
+}
+
+bool HasPartialFiles(const std::string& root) {
+    for (const auto& entry : Snapshot(root)) {
+        if (entry.first.find(".fcpart") != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// tree/ a.bin (3MB)  empty  link -> a.bin  sub/ b.txt (0600)  sub/deep/ c.txt  locked/ (0555) d.txt
+void MakeTree(const std::string& root) {
+    MakeDir(root);
+    WriteFile(root + "/a.bin", RandomBytes(3 << 20, 1));
+    WriteFile(root + "/empty", "");
+    symlink("a.bin", (root + "/link").c_str());
+    MakeDir(root + "/sub");
+    WriteFile(root + "/sub/b.txt", "bee", 0600);
+    MakeDir(root + "/sub/deep");
+    WriteFile(root + "/sub/deep/c.txt", RandomBytes(70000, 2));
+    MakeDir(root + "/locked");
+    WriteFile(root + "/locked/d.txt", "dee");
+    for (const char* path : {"/a.bin", "/empty", "/link", "/sub/b.txt", "/sub/deep/c.txt", "/locked/d.txt",
+                             "/sub/deep", "/sub", "/locked"}) {
+        Backdate(root + path);
+    }
+    chmod((root + "/locked").c_str(), 0555);
+    Backdate(root + "/locked");
+}
+
+void RemoveAll(const std::string& path) {
+    std::string command = "chmod -R u+w '" + path + "' 2>/dev/null; rm -rf '" + path + "'";
+    if (system(command.c_str()) != 0) {
+        std::fprintf(stderr, "cleanup of %s failed\n", path.c_str());
+    }
+}
+
+void TestCopyMethods() {
+    const std::string source = g_root + "/method-source";
+    const std::string data = RandomBytes((5 << 20) + 17, 3);
+    WriteFile(source, data, 0640);
+    Backdate(source);
+
+    struct Case {
+        const char* name;
+        uint32_t methods;
+        TransferMethod expected;  // None: whatever the filesystem supports
+    };
+    const Case cases[] = {
+        {"default", ALL_TRANSFER_METHODS, TransferMethod::None},
+        {"copy_file_range", TransferMethodBit(TransferMethod::CopyFileRange), TransferMethod::CopyFileRange},
+        {"sendfile", TransferMethodBit(TransferMethod::Sendfile), TransferMethod::Sendfile},
+        {"readwrite", 0, TransferMethod::ReadWrite},
+    };
+    for (const Case& test : cases) {
+        const std::string destination = g_root + "/method-" + test.name;
+        TransferOptions options;
+        options.methods = test.methods;
+        options.sliceSize = 1 << 20;
+        options.bufferSize = 256 * 1024;
+        TransferMethod method;
+        uint64_t bytes = 0, reported = 0;
+        int error = CopyFileTo(source, destination, options, &method, &bytes, nullptr,
+                               [&](uint64_t n) { reported += n; });
+        EXPECT(error == 0, "%s: error %d", test.name, error);
+        EXPECT(test.expected == TransferMethod::None || method == test.expected, "%s: method %d", test.name,
+               static_cast<int>(method));
+        EXPECT(bytes == data.size() && reported == data.size(), "%s: %llu bytes, %llu reported", test.name,
+               static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(reported));
+        EXPECT(ReadFile(destination) == data, "%s: content", test.name);
+        struct stat st;
+        stat(destination.c_str(), &st);
+        EXPECT((st.st_mode & 07777) == 0640 && st.st_mtim.tv_sec == 1000000000 &&
+                   st.st_mtim.tv_nsec == 123456789,
+               "%s: mode %o, mtime %ld", test.name, st.st_mode & 07777, static_cast<long>(st.st_mtim.tv_sec));
+    }
+
+    // Conflicts, overwrite, and what is left behind
+    TransferMethod method;
+    uint64_t bytes;
+    TransferOptions options;
+    const std::string existing = g_root + "/method-default";
+    WriteFile(g_root + "/small", "small");
+    EXPECT(CopyFileTo(g_root + "/small", existing, options, &method, &bytes) == EEXIST, "no overwrite");
+    EXPECT(ReadFile(existing) == data, "existing file untouched");
+    options.overwrite = true;
+    EXPECT(CopyFileTo(g_root + "/small", existing, options, &method, &bytes) == 0 && ReadFile(existing) == "small",
+           "overwrite");
+    EXPECT(CopyFileTo(g_root + "/missing", g_root + "/x", options, &method, &bytes) == ENOENT, "missing source");
+    EXPECT(CopyFileTo(g_root, g_root + "/x", options, &method, &bytes) == ENOTSUP, "a folder is not a file");
+
+    // A file that already has the staging name is the user's, not ours
+    WriteFile(g_root + "/staged.fcpart", "mine");
+    EXPECT(CopyFileTo(g_root + "/small", g_root + "/staged", options, &method, &bytes) == 0 &&
+               ReadFile(g_root + "/staged") == "small",
+           "copy beside a taken staging name");
+    EXPECT(ReadFile(g_root + "/staged.fcpart") == "mine", "taken staging name untouched");
+    unlink((g_root + "/staged.fcpart").c_str());
+
+    std::atomic<bool> cancelled{false};
+    options.sliceSize = 64 * 1024;
+    options.bufferSize = 64 * 1024;
+    options.methods = 0;
+    int error = CopyFileTo(source, g_root + "/cancelled", options, &method, &bytes, &cancelled,
+                           [&](uint64_t) { cancelled = true; });
+    EXPECT(error == ECANCELED && !Exists(g_root + "/cancelled"), "cancelled copy leaves nothing");
+    EXPECT(!HasPartialFiles(g_root), "no partial files");
+}
+
+struct Run {
+    std::mutex mutex;
+    std::vector<TransferResult> results;
+    TransferSummary summary;
+    int progressCalls = 0;
+};
+
+void Transfer(WorkStealingPool& pool, std::vector<TransferItem> items, TransferOptions options, Run* run,
+              const std::function<void(FileTransfer&)>& onProgress = nullptr) {
+    std::shared_ptr<FileTransfer> transfer;
+    transfer = FileTransfer::Create(
+        std::move(items), options,
+        [run](const TransferResult& result) {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->results.push_back(result);
+        },
+        [&] {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->progressCalls++;
+            if (onProgress) {
+                onProgress(*transfer);
+            }
+        },
+        [run](const TransferSummary& summary) { run->summary = summary; });
+    transfer->Start(pool);
+    transfer->WaitUntilFinished();
+}
+
+const TransferResult* ResultFor(const Run& run, uint32_t index) {
+    for (const auto& result : run.results) {
+        if (result.index == index) {
+            return &result;
+        }
+    }
+    return nullptr;
+}
+
+void TestTransfers(WorkStealingPool& pool) {
+    const std::string tree = g_root + "/tree";
+    MakeTree(tree);
+    const auto expected = Snapshot(tree);
+    MakeDir(g_root + "/out");
+
+    // Copy a folder and a file; the file's destination already exists
+    WriteFile(g_root + "/out/taken", "taken");
+    WriteFile(g_root + "/single", "single");
+    Run copy;
+    TransferOptions options;
+    options.perDeviceConcurrency = 2;
+    Transfer(pool,
+             {{tree, g_root + "/out/tree"},
+              {g_root + "/single", g_root + "/out/single"},
+              {g_root + "/single", g_root + "/out/taken"},
+              {g_root + "/nope", g_root + "/out/nope"},
+              {g_root + "/single", g_root + "/no-such-folder/single"}},
+             options, &copy);
+    EXPECT(copy.results.size() == 5 && copy.summary.items == 5 && copy.summary.failed == 3, "copy results");
+    const TransferResult* result = ResultFor(copy, 0);
+    EXPECT(result && result->error == 0 && result->bytes == (3u << 20) + 70000 + 6, "folder copied: %d",
+           result ? result->error : -1);
+    EXPECT(Snapshot(g_root + "/out/tree") == expected, "copied tree matches, with modes and mtimes");
+    EXPECT(ReadFile(g_root + "/out/single") == "single" && ResultFor(copy, 1)->error == 0, "file copied");
+    EXPECT(ResultFor(copy, 2)->error == EEXIST && ReadFile(g_root + "/out/taken") == "taken", "conflict");
+    EXPECT(ResultFor(copy, 3)->error == ENOENT && ResultFor(copy, 4)->error == ENOENT, "missing paths");
+    EXPECT(copy.summary.files == 7, "7 files copied, %llu", static_cast<unsigned long long>(copy.summary.files));
+    EXPECT(Snapshot(tree) == expected, "copy leaves the source alone");
+
+    // Copying a folder onto itself again merges only with overwrite
+    Run again;
+    Transfer(pool, {{tree, g_root + "/out/tree"}}, options, &again);
+    EXPECT(again.results.size() == 1 && again.results[0].error == EEXIST, "folder conflict");
+    options.overwrite = true;
+    Run merged;
+    Transfer(pool, {{tree, g_root + "/out/tree"}}, options, &merged);
+    EXPECT(merged.results.size() == 1 && merged.results[0].error == 0, "merge: %d", merged.results[0].error);
+    EXPECT(Snapshot(g_root + "/out/tree") == expected, "merged tree matches");
+    options.overwrite = false;
+
+    // Move on one filesystem is a rename
+    Run moved;
+    options.mode = TransferMode::Move;
+    Transfer(pool, {{g_root + "/out/tree", g_root + "/moved"}}, options, &moved);
+    EXPECT(moved.results.size() == 1 && moved.results[0].error == 0 &&
+               moved.results[0].method == TransferMethod::Rename,
+           "rename move");
+    EXPECT(!Exists(g_root + "/out/tree") && Snapshot(g_root + "/moved") == expected, "renamed tree");
+
+    // Without rename (as across devices) a move copies, then removes the source
+    Run copied;
+    options.methods = ALL_TRANSFER_METHODS & ~TransferMethodBit(TransferMethod::Rename);
+    options.perDeviceConcurrency = 1;
+    Transfer(pool, {{g_root + "/moved", g_root + "/moved-again"}, {g_root + "/single", g_root + "/single-moved"}},
+             options, &copied);
+    EXPECT(copied.results.size() == 2 && copied.summary.failed == 0, "copy move");
+    EXPECT(!Exists(g_root + "/moved") && !Exists(g_root + "/single"), "sources removed");
+    EXPECT(Snapshot(g_root + "/moved-again") == expected && ReadFile(g_root + "/single-moved") == "single",
+           "moved data");
+    EXPECT(ResultFor(copied, 0)->method != TransferMethod::Rename, "folder was copied");
+
+    // Cancel from the first progress report: the move fails and keeps its source
+    Run cancelled;
+    options.sliceSize = 64 * 1024;
+    options.bufferSize = 64 * 1024;
+    options.progressInterval = std::chrono::milliseconds(0);
+    Transfer(pool, {{g_root + "/moved-again", g_root + "/cancelled"}}, options, &cancelled,
+             [](FileTransfer& transfer) { transfer.Cancel(); });
+    EXPECT(cancelled.summary.cancelled && cancelled.results.size() == 1 &&
+               cancelled.results[0].error == ECANCELED,
+           "cancelled: %d", cancelled.results.empty() ? -1 : cancelled.results[0].error);
+    EXPECT(Snapshot(g_root + "/moved-again") == expected, "cancelled move keeps its source");
+    EXPECT(cancelled.progressCalls >= 1, "progress reported");
+
+    Run empty;
+    Transfer(pool, {}, options, &empty);
+    EXPECT(empty.results.empty() && empty.summary.items == 0, "no items still finishes");
+
+    EXPECT(!HasPartialFiles(g_root), "no partial files");
+}
+
+void TestIntoItself(WorkStealingPool& pool) {
+    const std::string self = g_root + "/self";
+    MakeTree(self);
+    const auto expected = Snapshot(self);
+    symlink("self", (g_root + "/alias").c_str());
+
+    // Into its own subtree, directly or through a symlink, and onto itself
+    Run into;
+    TransferOptions options;
+    Transfer(pool,
+             {{self, self + "/sub/self"},
+              {self, g_root + "/alias/sub/deep/copy"},
+              {self + "/", self + "/./"},
+              {self, g_root + "/self-copy"}},
+             options, &into);
+    EXPECT(into.results.size() == 4 && ResultFor(into, 0)->error == EINVAL && ResultFor(into, 1)->error == EINVAL &&
+               ResultFor(into, 2)->error == EINVAL,
+           "copy into itself fails with EINVAL");
+    EXPECT(Snapshot(self) == expected, "nothing created inside the source");
+    EXPECT(ResultFor(into, 3) && ResultFor(into, 3)->error == 0 && Snapshot(g_root + "/self-copy") == expected,
+           "a sibling sharing the name prefix is not inside");
+
+    Run moved;
+    options.mode = TransferMode::Move;
+    Transfer(pool, {{self, self + "/sub/moved"}}, options, &moved);
+    EXPECT(moved.results.size() == 1 && moved.results[0].error == EINVAL && Snapshot(self) == expected,
+           "move into itself fails with EINVAL");
+}
+
+} // namespace
+
+int main() {
+    char pattern[] = "/tmp/file_transfer_test.XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        return 2;
+    }
+    g_root = root;
+
+    WorkStealingPool pool(4);
+    TestCopyMethods();
+    TestTransfers(pool);
+    TestIntoItself(pool);
+
+    RemoveAll(g_root);
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
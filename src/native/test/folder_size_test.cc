@@ -0,0 +1,217 @@
+/**
+ * @file folder_size_test.cc
+ * @brief Functional test for incremental folder sizes and their cache
+ *
+ * Measures a small fixture tree and checks the totals, that a second
+ * measurement through a freshly opened cache file lists nothing, that a
+ * change relists only the directory it happened in, that rescan catches
+ * files modified in place, and that corrupt cache files, cancellation and
+ * a missing root are handled.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "folder_size.h"
+#include "test_support.h"
+
+using FileCataloger::EstimateFolderSize;
+using FileCataloger::FolderSize;
+using FileCataloger::FolderSizeCache;
+using FileCataloger::FolderSizeOptions;
+using FileCataloger::FolderSizeResult;
+using FileCataloger::FolderSizeScanner;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+struct Measurement {
+    int startError = 0;
+    FolderSizeResult result;
+};
+
+Measurement Measure(WorkStealingPool& pool, std::shared_ptr<FolderSizeCache> cache,
+                    const std::string& root, FolderSizeOptions options = FolderSizeOptions()) {
+    Measurement measurement;
+    auto scanner = FolderSizeScanner::Create(root, std::move(cache), options,
+                                             [&](const FolderSizeResult& result) { measurement.result = result; });
+    measurement.startError = scanner->Start(pool);
+    scanner->WaitUntilFinished();
+    return measurement;
+}
+
+// Move a directory's mtime an hour back, out of the scanner's racy window
+void Backdate(const std::string& path) {
+    struct timespec times[2];
+    clock_gettime(CLOCK_REALTIME, &times[0]);
+    times[0].tv_sec -= 3600;
+    times[1] = times[0];
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+// root/ r (50)  a/ f1 (100) f2 (200)  a/b/ f3 (300)  c/ f4 (400)  link -> a
+std::string MakeFixture() {
+    char pattern[] = "/tmp/folder_size_test.XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        std::exit(2);
+    }
+    std::string r(root);
+    MakeDir(r + "/tree");
+    r += "/tree";
+    WriteFile(r + "/r", 50);
+    MakeDir(r + "/a");
+    WriteFile(r + "/a/f1", 100);
+    WriteFile(r + "/a/f2", 200);
+    MakeDir(r + "/a/b");
+    WriteFile(r + "/a/b/f3", 300);
+    MakeDir(r + "/c");
+    WriteFile(r + "/c/f4", 400);
+    if (symlink("a", (r + "/link").c_str()) != 0) {
+        std::fprintf(stderr, "symlink failed\n");
+        std::exit(2);
+    }
+    for (const char* dir : {"", "/a", "/a/b", "/c"}) {
+        Backdate(r + dir);
+    }
+    return r;
+}
+
+void ExpectSize(const FolderSize& size, uint64_t bytes, uint64_t files, uint64_t directories, const char* what) {
+    EXPECT(size.bytes == bytes && size.files == files && size.directories == directories,
+           "%s: expected %llu bytes/%llu files/%llu dirs, got %llu/%llu/%llu", what,
+           static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(files),
+           static_cast<unsigned long long>(directories), static_cast<unsigned long long>(size.bytes),
+           static_cast<unsigned long long>(size.files), static_cast<unsigned long long>(size.directories));
+}
+
+void TestIncremental(WorkStealingPool& pool, const std::string& root, const std::string& cachePath) {
+    {
+        auto cache = std::make_shared<FolderSizeCache>(cachePath);
+        FolderSize estimate;
+        EXPECT(EstimateFolderSize(*cache, root, &estimate) == ENOENT, "estimate before any measurement");
+
+        Measurement first = Measure(pool, cache, root);
+        EXPECT(first.startError == 0, "start failed: %d", first.startError);
+        ExpectSize(first.result.size, 1050, 5, 3, "first measurement");
+        EXPECT(first.result.directoriesListed == 4 && first.result.directoriesReused == 0,
+               "first measurement listed %llu", static_cast<unsigned long long>(first.result.directoriesListed));
+        EXPECT(cache->PendingRecordCount() == 0 && cache->MappedRecordCount() == 4, "cache not saved");
+    }
+
+    // A new cache object maps the saved file, as after an app restart
+    auto cache = std::make_shared<FolderSizeCache>(cachePath);
+    FolderSize estimate;
+    EXPECT(EstimateFolderSize(*cache, root, &estimate) == 0, "no estimate after restart");
+    ExpectSize(estimate, 1050, 5, 3, "estimate after restart");
+
+    Measurement unchanged = Measure(pool, cache, root);
+    ExpectSize(unchanged.result.size, 1050, 5, 3, "unchanged tree");
+    EXPECT(unchanged.result.directoriesListed == 0 && unchanged.result.directoriesReused == 4,
+           "unchanged tree listed %llu directories",
+           static_cast<unsigned long long>(unchanged.result.directoriesListed));
+
+    // Only a/b changes; every other directory is validated by mtime alone
+    WriteFile(root + "/a/b/new", 1000);
+    EXPECT(EstimateFolderSize(*cache, root, &estimate) == 0, "estimate before re-measuring");
+    ExpectSize(estimate, 1050, 5, 3, "stale estimate is the last measurement");
+
+    Measurement changed = Measure(pool, cache, root);
+    ExpectSize(changed.result.size, 2050, 6, 3, "after adding a file");
+    EXPECT(changed.result.directoriesListed == 1 && changed.result.directoriesReused == 3,
+           "change relisted %llu directories", static_cast<unsigned long long>(changed.result.directoriesListed));
+    EXPECT(EstimateFolderSize(*cache, root, &estimate) == 0, "estimate after change");
+    ExpectSize(estimate, 2050, 6, 3, "estimate after change");
+
+    FolderSize subtree;
+    EXPECT(EstimateFolderSize(*cache, root + "/a", &subtree) == 0, "subdirectory not cached");
+    ExpectSize(subtree, 1600, 4, 1, "subdirectory estimate");
+
+    // Appending in place leaves c's mtime alone; only a rescan sees it
+    WriteFile(root + "/c/f4", 100, O_APPEND);
+    Measurement stale = Measure(pool, cache, root);
+    ExpectSize(stale.result.size, 2050, 6, 3, "in-place append without rescan");
+
+    FolderSizeOptions rescan;
+    rescan.rescan = true;
+    Measurement rescanned = Measure(pool, cache, root, rescan);
+    ExpectSize(rescanned.result.size, 2150, 6, 3, "rescan");
+    EXPECT(rescanned.result.directoriesListed == 4, "rescan must list everything");
+}
+
+void TestCorruptCache(WorkStealingPool& pool, const std::string& root, const std::string& cachePath) {
+    WriteFile(cachePath, 100);
+    auto cache = std::make_shared<FolderSizeCache>(cachePath);
+    EXPECT(cache->MappedRecordCount() == 0, "corrupt cache file was mapped");
+
+    Measurement measurement = Measure(pool, cache, root);
+    EXPECT(measurement.result.directoriesListed == 4, "corrupt cache was used");
+    EXPECT(std::make_shared<FolderSizeCache>(cachePath)->MappedRecordCount() == 4, "corrupt cache not replaced");
+}
+
+void TestCancel(const std::string& root) {
+    // One worker, held busy, so the scan is cancelled before its first task runs
+    WorkStealingPool pool(1);
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool release = false;
+    pool.Submit([&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return release; });
+    });
+
+    auto cache = std::make_shared<FolderSizeCache>(std::string());
+    FolderSizeResult result;
+    auto scanner = FolderSizeScanner::Create(root, cache, FolderSizeOptions(),
+                                             [&](const FolderSizeResult& r) { result = r; });
+    EXPECT(scanner->Start(pool) == 0, "start failed");
+    scanner->Cancel();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    cv.notify_all();
+    scanner->WaitUntilFinished();
+
+    EXPECT(result.cancelled, "result not marked cancelled");
+    EXPECT(cache->PendingRecordCount() == 0, "cancelled measurement was cached");
+}
+
+void TestMissingRoot(WorkStealingPool& pool, const std::string& root) {
+    auto cache = std::make_shared<FolderSizeCache>(std::string());
+    Measurement measurement = Measure(pool, cache, root + "/does-not-exist");
+    EXPECT(measurement.startError == ENOENT, "expected ENOENT, got %d", measurement.startError);
+}
+
+} // namespace
+
+int main() {
+    std::string root = MakeFixture();
+    std::string base = root.substr(0, root.rfind('/'));
+    std::string cachePath = base + "/folder-sizes.cache";
+    WorkStealingPool pool(4);
+
+    TestIncremental(pool, root, cachePath);
+    TestCorruptCache(pool, root, cachePath);
+    TestCancel(root);
+    TestMissingRoot(pool, root);
+
+    std::string cleanup = "rm -rf '" + base + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", base.c_str());
+    }
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
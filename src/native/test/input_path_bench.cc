@@ -0,0 +1,395 @@
+/**
+ * @file input_path_bench.cc
+ * @brief Per-event cost of the input hot paths with hardware counters
+ *
+ * Drives the Linux-buildable halves of the input modules' hot paths as fast
+ * as they go and reports, per event, wall time and the perf_event_open
+ * counters from perf_counters.h: cycles, instructions (and IPC), L1d and
+ * LLC misses, branch misses and context switches. Counters cover the whole
+ * process, so each scenario only runs the threads it is about.
+ *
+ * Scenarios:
+ *   queue_mouse_event     what QueueMouseEvent does per event tap callback:
+ *                         fill a MouseData with a wall-clock timestamp and
+ *                         push it to a BatchedDispatcher, including the
+ *                         drains on the stand-in JS thread (napi_test_shim.h)
+ *   drag_event_callback   the kCGEventLeftMouseDragged branch of
+ *                         DragEventCallback: distance and velocity upkeep,
+ *                         trajectory push, a snapshot every 10 moves, a new
+ *                         DragSession every 300 moves; snapshots are
+ *                         released in place rather than handed to analysis
+ *   trajectory_analysis   AnalyzeTrajectory over a full 100-point snapshot:
+ *                         angles, distance, circular and zigzag checks; one
+ *                         event is one snapshot
+ *
+ * Each scenario runs INPUT_BENCH_RUNS times and the median of every column
+ * is reported. Counters this machine does not expose print n/a and the
+ * reason is listed at the top; wall time is always measured.
+ *
+ * Environment (defaults in brackets):
+ *   INPUT_BENCH_EVENTS   events per run [1000000]
+ *   INPUT_BENCH_RUNS     runs per scenario [5]
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run bench:input-path
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "drag_session.h"
+#include "napi_smart_ptr.h"
+#include "napi_test_shim.h"
+#include "perf_counters.h"
+
+using FileCataloger::ArenaChunkCache;
+using FileCataloger::DragSession;
+using FileCataloger::TrajectoryPoint;
+using FileCataloger::TrajectorySnapshot;
+using PerfCounters::Event;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t EnvOr(const char* name, uint64_t fallback) {
+    const char* value = std::getenv(name);
+    return value && *value ? std::strtoull(value, nullptr, 10) : fallback;
+}
+
+// --- QueueMouseEvent --------------------------------------------------------
+
+struct MouseData {
+    double x;
+    double y;
+    bool left_button;
+    bool right_button;
+    bool omit_button_state;
+    uint64_t timestamp;
+};
+
+using MouseEventDispatcher = FileCataloger::BatchedDispatcher<MouseData>;
+
+// The event tap runs ahead of JS by at most this many events
+constexpr uint64_t kMaxInFlight = 1024;
+
+class MouseTrackerModel {
+public:
+    MouseTrackerModel()
+        : dispatcher_([this](napi_env, napi_value, std::vector<MouseData>& buttons,
+                             std::vector<MouseData>& moves) {
+              // DeliverBatch hands JS the latest move
+              volatile double x = moves.empty() ? 0 : moves.back().x;
+              (void)x;
+              drained_.fetch_add(buttons.size() + moves.size(), std::memory_order_release);
+          }) {
+        started_ = dispatcher_.Start(NapiTestShim::Env(), nullptr, "InputPathBenchMoves") == napi_ok;
+    }
+
+    bool Started() const { return started_; }
+    void Stop() { dispatcher_.Stop(); }
+
+    void QueueMouseEvent(double x, double y, bool left_button, bool right_button, bool omit_button_state) {
+        while (pushed_ - drained_.load(std::memory_order_acquire) >= kMaxInFlight) {
+            std::this_thread::yield();
+        }
+        MouseData data;
+        data.x = x;
+        data.y = y;
+        data.left_button = left_button;
+        data.right_button = right_button;
+        data.omit_button_state = omit_button_state;
+        data.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+        if (dispatcher_.Push(data, MouseEventDispatcher::Priority::Low)) {
+            pushed_++;
+        }
+    }
+
+    void Settle() {
+        while (pushed_ != drained_.load(std::memory_order_acquire) || NapiTestShim::PendingCalls() > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    MouseEventDispatcher dispatcher_;
+    uint64_t pushed_ = 0;
+    std::atomic<uint64_t> drained_{0};
+    bool started_ = false;
+};
+
+void QueueMouseEvents(MouseTrackerModel& tracker, uint64_t events) {
+    for (uint64_t i = 0; i < events; i++) {
+        tracker.QueueMouseEvent(400.0 + (i % 300), 300.0 + (i % 200), false, false, true);
+    }
+    tracker.Settle();
+}
+
+// --- DragEventCallback ------------------------------------------------------
+
+constexpr uint64_t kMovesPerDrag = 300;
+
+struct DragState {
+    TrajectoryPoint startPoint;
+    TrajectoryPoint lastPoint;
+    Clock::time_point startTime;
+    Clock::time_point lastMoveTime;
+    double totalDistance = 0;
+    int moveCount = 0;
+    double maxVelocity = 0;
+    double avgVelocity = 0;
+};
+
+class DragMonitorModel {
+public:
+    void MouseDown(TrajectoryPoint location) {
+        activeSession_ = std::make_shared<DragSession>(&cache_);
+        activeSession_->trajectory().Push(location);
+        state_ = DragState();
+        state_.startPoint = location;
+        state_.lastPoint = location;
+        state_.startTime = Clock::now();
+        state_.lastMoveTime = state_.startTime;
+    }
+
+    void MouseDragged(TrajectoryPoint location) {
+        auto now = Clock::now();
+        double dx = location.x - state_.lastPoint.x;
+        double dy = location.y - state_.lastPoint.y;
+        double moveDistance = std::sqrt(dx * dx + dy * dy);
+
+        auto timeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(now - state_.lastMoveTime).count();
+        state_.totalDistance += moveDistance;
+        state_.lastPoint = location;
+        state_.moveCount++;
+        state_.lastMoveTime = now;
+
+        activeSession_->trajectory().Push(location);
+
+        if (timeDelta > 0) {
+            double velocity = moveDistance / timeDelta;
+            state_.maxVelocity = std::max(state_.maxVelocity, velocity);
+            state_.avgVelocity =
+                (state_.avgVelocity * (state_.moveCount - 1) + velocity) / state_.moveCount;
+        }
+
+        if (state_.moveCount % 10 == 0 && activeSession_->trajectory().size() > 3) {
+            if (TrajectorySnapshot* snapshot = activeSession_->TakeSnapshot()) {
+                DragSession::ReleaseSnapshot(snapshot);
+            }
+        }
+
+        double distanceFromStart = std::sqrt(std::pow(location.x - state_.startPoint.x, 2) +
+                                             std::pow(location.y - state_.startPoint.y, 2));
+        actualDrags_ += distanceFromStart >= 20.0 && state_.totalDistance >= 25.0;
+    }
+
+private:
+    ArenaChunkCache cache_;
+    std::shared_ptr<DragSession> activeSession_;
+    DragState state_;
+    uint64_t actualDrags_ = 0;
+};
+
+// Side to side with drift, like a shake on the way to a drop target
+TrajectoryPoint DragPoint(uint64_t i) {
+    return {400.0 + ((i / 8) % 2 ? 1 : -1) * static_cast<double>(i % 8) * 6 + (i % kMovesPerDrag),
+            300.0 + (i % 50)};
+}
+
+void DragEvents(DragMonitorModel& monitor, uint64_t events) {
+    for (uint64_t i = 0; i < events; i++) {
+        if (i % kMovesPerDrag == 0) {
+            monitor.MouseDown(DragPoint(i));
+        } else {
+            monitor.MouseDragged(DragPoint(i));
+        }
+    }
+}
+
+// --- AnalyzeTrajectory ------------------------------------------------------
+
+double CalculateAngle(TrajectoryPoint p1, TrajectoryPoint p2, TrajectoryPoint p3) {
+    double v1x = p2.x - p1.x;
+    double v1y = p2.y - p1.y;
+    double v2x = p3.x - p2.x;
+    double v2y = p3.y - p2.y;
+    return std::atan2(v1x * v2y - v1y * v2x, v1x * v2x + v1y * v2y);
+}
+
+uint64_t g_patterns = 0;
+
+void AnalyzeTrajectory(const TrajectorySnapshot& snapshot) {
+    if (snapshot.count < 3) return;
+
+    int directionChanges = 0;
+    for (size_t i = 2; i < snapshot.count; i++) {
+        if (CalculateAngle(snapshot.points[i - 2], snapshot.points[i - 1], snapshot.points[i]) > M_PI / 4) {
+            directionChanges++;
+        }
+    }
+
+    double totalDistance = 0;
+    for (size_t i = 1; i < snapshot.count; i++) {
+        double dx = snapshot.points[i].x - snapshot.points[i - 1].x;
+        double dy = snapshot.points[i].y - snapshot.points[i - 1].y;
+        totalDistance += std::sqrt(dx * dx + dy * dy);
+    }
+
+    TrajectoryPoint start = snapshot.points[0];
+    TrajectoryPoint current = snapshot.points[snapshot.count - 1];
+    double distance = std::sqrt(std::pow(current.x - start.x, 2) + std::pow(current.y - start.y, 2));
+    bool circular = snapshot.count >= 8 && totalDistance > 100 && distance < 50;
+    bool zigzag = directionChanges >= 3 && static_cast<double>(directionChanges) / snapshot.count > 0.3;
+    g_patterns += circular || zigzag;
+}
+
+void AnalyzeSnapshots(DragSession& session, uint64_t events) {
+    for (uint64_t i = 0; i < events; i++) {
+        TrajectorySnapshot* snapshot = session.TakeSnapshot();
+        AnalyzeTrajectory(*snapshot);
+        DragSession::ReleaseSnapshot(snapshot);
+    }
+}
+
+// --- Reporting --------------------------------------------------------------
+
+// Per event, or n/a (negative)
+struct Result {
+    double ns = 0;
+    double perEvent[PerfCounters::kEventCount] = {};
+};
+
+Result Measure(const PerfCounters::Group& counters, const std::function<void(uint64_t)>& run, uint64_t events) {
+    PerfCounters::Reading before = counters.Read();
+    auto start = Clock::now();
+    run(events);
+    auto end = Clock::now();
+    PerfCounters::Counts counts = PerfCounters::Delta(before, counters.Read());
+
+    Result result;
+    result.ns = std::chrono::duration<double, std::nano>(end - start).count() / events;
+    for (size_t i = 0; i < PerfCounters::kEventCount; i++) {
+        result.perEvent[i] = counts.valid[i] ? counts.value[i] / events : -1;
+    }
+    return result;
+}
+
+template<typename Get>
+double Median(std::vector<Result> results, Get get) {
+    std::sort(results.begin(), results.end(), [&](const Result& a, const Result& b) { return get(a) < get(b); });
+    return get(results[results.size() / 2]);
+}
+
+Result MedianOf(const std::vector<Result>& runs) {
+    Result median;
+    median.ns = Median(runs, [](const Result& r) { return r.ns; });
+    for (size_t i = 0; i < PerfCounters::kEventCount; i++) {
+        median.perEvent[i] = Median(runs, [i](const Result& r) { return r.perEvent[i]; });
+    }
+    return median;
+}
+
+double Of(const Result& result, Event event) {
+    return result.perEvent[static_cast<size_t>(event)];
+}
+
+void PrintValue(double value, int width, int precision) {
+    if (value < 0) {
+        std::printf(" %*s", width, "n/a");
+    } else {
+        std::printf(" %*.*f", width, precision, value);
+    }
+}
+
+} // namespace
+
+int main() {
+    // Before any thread starts, so inherit covers all of them
+    PerfCounters::Group counters;
+
+    const uint64_t events = std::max<uint64_t>(EnvOr("INPUT_BENCH_EVENTS", 1000000), 1);
+    const uint64_t runs = std::max<uint64_t>(EnvOr("INPUT_BENCH_RUNS", 5), 1);
+
+    std::string unavailable = counters.Describe();
+    if (!counters.AnyHardware()) {
+        std::printf("No hardware counters available; measuring wall time and context switches only\n%s", unavailable.c_str());
+    } else if (!unavailable.empty()) {
+        std::printf("Some performance counters are unavailable:\n%s", unavailable.c_str());
+    }
+    std::printf("%llu runs of %llu events per scenario; counts are per event\n\n",
+                static_cast<unsigned long long>(runs), static_cast<unsigned long long>(events));
+
+    std::thread jsThread(NapiTestShim::RunJsThread);
+
+    MouseTrackerModel tracker;
+    if (!tracker.Started()) {
+        std::fprintf(stderr, "FAIL: dispatcher did not start\n");
+        NapiTestShim::StopJsThread();
+        jsThread.join();
+        return 1;
+    }
+    DragMonitorModel monitor;
+    ArenaChunkCache cache;
+    DragSession analysed(&cache);
+    for (uint64_t i = 0; i < DragSession::MAX_TRAJECTORY_POINTS; i++) {
+        analysed.trajectory().Push(DragPoint(i));
+    }
+
+    const struct {
+        const char* name;
+        std::function<void(uint64_t)> run;
+        uint64_t events;
+    } scenarios[] = {
+        {"queue_mouse_event", [&](uint64_t n) { QueueMouseEvents(tracker, n); }, events},
+        {"drag_event_callback", [&](uint64_t n) { DragEvents(monitor, n); }, events},
+        // A snapshot is ~100 points of work; keep runs about as long as the others
+        {"trajectory_analysis", [&](uint64_t n) { AnalyzeSnapshots(analysed, n); },
+         std::max<uint64_t>(events / 50, 1)},
+    };
+
+    std::printf("%-20s %9s %9s %10s %6s %10s %10s %10s %12s\n", "scenario", "ns", "cycles", "instrs", "IPC",
+                "L1d miss", "LLC miss", "br miss", "ctx sw/1k");
+    for (const auto& scenario : scenarios) {
+        // Warm caches, arenas and the dispatcher's queue nodes
+        scenario.run(std::max<uint64_t>(scenario.events / 10, 1));
+
+        std::vector<Result> results;
+        for (uint64_t run = 0; run < runs; run++) {
+            results.push_back(Measure(counters, scenario.run, scenario.events));
+        }
+        Result median = MedianOf(results);
+
+        double cycles = Of(median, Event::Cycles);
+        double instructions = Of(median, Event::Instructions);
+        double switches = Of(median, Event::ContextSwitches);
+        std::printf("%-20s %9.1f", scenario.name, median.ns);
+        PrintValue(cycles, 9, 1);
+        PrintValue(instructions, 10, 1);
+        PrintValue(cycles > 0 && instructions >= 0 ? instructions / cycles : -1, 6, 2);
+        PrintValue(Of(median, Event::L1dMisses), 10, 3);
+        PrintValue(Of(median, Event::LlcMisses), 10, 4);
+        PrintValue(Of(median, Event::BranchMisses), 10, 3);
+        PrintValue(switches < 0 ? -1 : switches * 1000, 12, 2);
+        std::printf("\n");
+    }
+
+    tracker.Stop();
+    while (NapiTestShim::LiveFunctions() > 0) {
+        std::this_thread::yield();
+    }
+    NapiTestShim::StopJsThread();
+    jsThread.join();
+    return 0;
+}
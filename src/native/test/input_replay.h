@@ -0,0 +1,217 @@
+/**
+ * @file input_replay.h
+ * @brief Synthetic mouse and drag drivers shared by the input module tests
+ *
+ * MouseReplay pushes mouse events through a BatchedDispatcher<MouseData>
+ * the way QueueMouseEvent/QueueButtonEvent do, drained on the stand-in JS
+ * thread of napi_test_shim.h, and never gets more than MAX_IN_FLIGHT
+ * events ahead of it.
+ *
+ * DragReplay drives drags through DragSession and an ArenaChunkCache the
+ * way the drag monitor does: a trajectory push on every move, a snapshot
+ * every 10 moves, the dragged paths read once at move 20, and a file
+ * drag's session kept after mouse up until the next file drag. Snapshots
+ * go to OnSnapshot(); by default analysis lags one snapshot behind, like a
+ * busy analysis thread, and a subclass can queue them elsewhere instead.
+ *
+ * Header-only. Executables that use MouseReplay link napi_test_shim.cc.
+ */
+
+#ifndef NATIVE_TEST_INPUT_REPLAY_H
+#define NATIVE_TEST_INPUT_REPLAY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "drag_session.h"
+#include "napi_smart_ptr.h"
+#include "napi_test_shim.h"
+
+// Same fields as MouseData in mouse_tracker_mac.mm
+struct MouseData {
+    double x;
+    double y;
+    bool left_button;
+    bool right_button;
+    bool omit_button_state;
+    uint64_t timestamp;
+};
+
+using MouseEventDispatcher = FileCataloger::BatchedDispatcher<MouseData>;
+
+class MouseReplay {
+public:
+    // Pushes allowed ahead of the JS thread; real input never gets further
+    // ahead than a couple of batches
+    static constexpr uint64_t MAX_IN_FLIGHT = 256;
+
+    explicit MouseReplay(const char* name)
+        : name_(name),
+          dispatcher_([this](napi_env, napi_value, std::vector<MouseData>& buttons,
+                             std::vector<MouseData>& moves) {
+              // DeliverBatch: every button transition, then the latest move
+              buttonsDelivered_ += buttons.size();
+              if (!moves.empty()) {
+                  lastX_ = moves.back().x;
+                  movesDelivered_++;
+              }
+              drained_.fetch_add(buttons.size() + moves.size(), std::memory_order_release);
+          }) {}
+
+    bool Start() { return dispatcher_.Start(NapiTestShim::Env(), nullptr, name_) == napi_ok; }
+    void Stop() { dispatcher_.Stop(); }
+
+    void Move(double x, double y, bool left, uint64_t timestamp) {
+        Push({x, y, left, false, true, timestamp}, MouseEventDispatcher::Priority::Low);
+    }
+
+    void Button(bool left, bool right) {
+        MouseData data = {};
+        data.left_button = left;
+        data.right_button = right;
+        Push(data, MouseEventDispatcher::Priority::High);
+    }
+
+    uint64_t Pushed() const { return pushed_; }
+    // Items pushed but not yet drained
+    uint64_t Pending() const { return pushed_ - drained_.load(std::memory_order_acquire); }
+    uint64_t Dropped() const { return dispatcher_.GetItemsDropped(); }
+    uint64_t Batches() const { return dispatcher_.GetBatchesDelivered(); }
+
+    // Wait until the JS thread has drained everything and no call is queued
+    void Settle() {
+        while (Pending() > 0 || NapiTestShim::PendingCalls() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+private:
+    void Push(const MouseData& data, MouseEventDispatcher::Priority priority) {
+        while (Pending() >= MAX_IN_FLIGHT) {
+            std::this_thread::yield();
+        }
+        if (dispatcher_.Push(data, priority)) {
+            pushed_++;
+        }
+    }
+
+    const char* name_;
+    MouseEventDispatcher dispatcher_;
+    uint64_t pushed_ = 0;
+    std::atomic<uint64_t> drained_{0};
+    // JS thread only
+    uint64_t buttonsDelivered_ = 0;
+    uint64_t movesDelivered_ = 0;
+    double lastX_ = 0;
+};
+
+class DragReplay {
+public:
+    using ArenaChunkCache = FileCataloger::ArenaChunkCache;
+    using DragSession = FileCataloger::DragSession;
+    using TrajectorySnapshot = FileCataloger::TrajectorySnapshot;
+
+    explicit DragReplay(size_t pathCount) {
+        for (size_t i = 0; i < pathCount; i++) {
+            paths_.push_back("/Users/test/Pictures/Shelf Imports/2024-" + std::to_string(i % 12 + 1) +
+                             "/IMG_" + std::to_string(4000 + i * 37) + ".HEIC");
+        }
+    }
+
+    virtual ~DragReplay() { Reset(); }
+
+    void Begin() {
+        active_ = NewSession();
+        moves_ = 0;
+    }
+
+    // fileCount 0 is a drag without files (window, selection, ...)
+    void Move(double x, double y, size_t fileCount) {
+        active_->trajectory().Push({x, y});
+        moves_++;
+
+        if (moves_ % 10 == 0 && active_->trajectory().size() > 3) {
+            if (TrajectorySnapshot* snapshot = active_->TakeSnapshot()) {
+                OnSnapshot(active_, snapshot);
+            }
+        }
+
+        // The pasteboard is read once, early in the drag
+        if (moves_ == 20 && fileCount > 0) {
+            active_->ClearFilePaths();
+            active_->ReserveFilePaths(fileCount);
+            for (size_t i = 0; i < fileCount; i++) {
+                const std::string& path = paths_[(dragCount_ + i) % paths_.size()];
+                active_->AddFilePath(path.c_str(), path.size());
+            }
+        }
+    }
+
+    // Mouse up: a file drag's paths are kept until the next file drag
+    void End() {
+        if (!active_->filePaths().empty()) {
+            pathSession_ = active_;
+        }
+        active_.reset();
+        dragCount_++;
+        ReleasePending();
+    }
+
+    // A whole file drag of the given length, carrying every path
+    void RunDrag(int moves) {
+        Begin();
+        double x = 100;
+        double y = 100;
+        for (int i = 1; i <= moves; i++) {
+            x += (i % 7) - 3;
+            y += (i % 5) - 2;
+            Move(x, y, paths_.size());
+        }
+        End();
+    }
+
+    const ArenaChunkCache& cache() const { return cache_; }
+
+protected:
+    virtual std::shared_ptr<DragSession> NewSession() { return std::make_shared<DragSession>(&cache_); }
+
+    virtual void OnSnapshot(const std::shared_ptr<DragSession>& session, TrajectorySnapshot* snapshot) {
+        ReleasePending();
+        pending_ = snapshot;
+        pendingOwner_ = session;
+    }
+
+    // Drops the drag in progress, the path session and any pending snapshot
+    void Reset() {
+        ReleasePending();
+        active_.reset();
+        pathSession_.reset();
+    }
+
+    ArenaChunkCache cache_;
+
+private:
+    void ReleasePending() {
+        if (pending_) {
+            DragSession::ReleaseSnapshot(pending_);
+            pending_ = nullptr;
+            pendingOwner_.reset();
+        }
+    }
+
+    std::vector<std::string> paths_;
+    std::shared_ptr<DragSession> active_;
+    std::shared_ptr<DragSession> pathSession_;
+    TrajectorySnapshot* pending_ = nullptr;
+    std::shared_ptr<DragSession> pendingOwner_;
+    uint64_t moves_ = 0;
+    uint64_t dragCount_ = 0;
+};
+
+#endif // NATIVE_TEST_INPUT_REPLAY_H
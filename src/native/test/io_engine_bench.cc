@@ -0,0 +1,245 @@
+/**
+ * @file io_engine_bench.cc
+ * @brief Syscall vs io_uring IoEngine benchmark for bulk shelf operations
+ *
+ * Writes a synthetic shelf of small files (10000 and 100000 by default, in
+ * folders of 1000) and times, through each engine:
+ * - stat on one thread, in runs of 256 paths, to show the per-call cost
+ * - StatFileList, SniffFiles and RunPathOps rename and unlink on the pool,
+ *   what the shelf actually calls
+ *
+ * Each row is the best of IO_BENCH_RUNS runs with the page cache warm.
+ * Unlink removes hard links made for it outside the timed section, so the
+ * shelf itself survives every run. Without io_uring (an old kernel, a
+ * seccomp profile or kernel.io_uring_disabled) only the syscall column is
+ * filled.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run bench:io-engine
+ *   IO_BENCH_FILES=10000,100000,1000000 IO_BENCH_RUNS=3 ./test/build/Release/io_engine_bench
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "content_sniffer.h"
+#include "file_list_stat.h"
+#include "io_engine.h"
+#include "path_ops.h"
+
+using FileCataloger::FileListBatch;
+using FileCataloger::IoEngine;
+using FileCataloger::IoEngineName;
+using FileCataloger::IoStat;
+using FileCataloger::PathOp;
+using FileCataloger::PathOpBatch;
+using FileCataloger::SniffBatch;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t FILES_PER_FOLDER = 1000;
+constexpr size_t STAT_RUN = 256;
+
+double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<size_t> ParseSizes(const char* text) {
+    std::vector<size_t> sizes;
+    while (text && *text) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text) {
+            break;
+        }
+        sizes.push_back(static_cast<size_t>(value));
+        text = *end == ',' ? end + 1 : end;
+    }
+    return sizes;
+}
+
+void MakeShelf(const std::string& root, size_t count, std::vector<std::string>* paths) {
+    // A PNG signature, so the sniffer classifies rather than falls through to text
+    static const char kHeader[] = "\x89PNG\r\n\x1A\n\0\0\0\rIHDR\0\0\0\x10\0\0\0\x10\x08\x06\0\0\0";
+    for (size_t i = 0; i < count; i++) {
+        if (i % FILES_PER_FOLDER == 0) {
+            mkdir((root + "/d" + std::to_string(i / FILES_PER_FOLDER)).c_str(), 0755);
+        }
+        std::string path = root + "/d" + std::to_string(i / FILES_PER_FOLDER) + "/f" + std::to_string(i) + ".png";
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || write(fd, kHeader, sizeof(kHeader) - 1) < 0) {
+            std::fprintf(stderr, "cannot create %s\n", path.c_str());
+            std::exit(2);
+        }
+        close(fd);
+        paths->push_back(std::move(path));
+    }
+}
+
+template<typename Batch>
+void RunBatch(WorkStealingPool& pool, std::shared_ptr<Batch> batch,
+              void (*run)(WorkStealingPool&, std::shared_ptr<Batch>, std::function<void(std::shared_ptr<Batch>)>)) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    run(pool, std::move(batch), [&](std::shared_ptr<Batch>) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return done; });
+}
+
+double StatOneThread(IoEngine& engine, const std::vector<std::string>& paths) {
+    std::vector<IoStat> stats(STAT_RUN);
+    auto start = Clock::now();
+    for (size_t begin = 0; begin < paths.size(); begin += STAT_RUN) {
+        engine.Stat(paths.data() + begin, std::min(STAT_RUN, paths.size() - begin), stats.data());
+    }
+    return MsSince(start);
+}
+
+double StatList(WorkStealingPool& pool, IoEngine& engine, const std::vector<std::string>& paths) {
+    auto batch = std::make_shared<FileListBatch>();
+    batch->paths = paths;
+    batch->engine = &engine;
+    auto start = Clock::now();
+    RunBatch(pool, batch, &FileCataloger::StatFileList);
+    return MsSince(start);
+}
+
+double Sniff(WorkStealingPool& pool, IoEngine& engine, const std::vector<std::string>& paths) {
+    auto batch = std::make_shared<SniffBatch>();
+    batch->paths = paths;
+    batch->engine = &engine;
+    auto start = Clock::now();
+    RunBatch(pool, batch, &FileCataloger::SniffFiles);
+    return MsSince(start);
+}
+
+// Renames every file and back; the time of one direction
+double Rename(WorkStealingPool& pool, IoEngine& engine, const std::vector<std::string>& paths) {
+    std::vector<std::string> renamed;
+    renamed.reserve(paths.size());
+    for (const std::string& path : paths) {
+        renamed.push_back(path + ".renamed");
+    }
+    double ms = 0;
+    for (int direction = 0; direction < 2; direction++) {
+        auto batch = std::make_shared<PathOpBatch>();
+        batch->paths = direction == 0 ? paths : renamed;
+        batch->destinations = direction == 0 ? renamed : paths;
+        batch->engine = &engine;
+        auto start = Clock::now();
+        RunBatch(pool, batch, &FileCataloger::RunPathOps);
+        ms += MsSince(start);
+    }
+    return ms / 2;
+}
+
+double Unlink(WorkStealingPool& pool, IoEngine& engine, const std::vector<std::string>& paths) {
+    auto batch = std::make_shared<PathOpBatch>();
+    batch->op = PathOp::Unlink;
+    batch->engine = &engine;
+    for (const std::string& path : paths) {
+        batch->paths.push_back(path + ".link");
+        if (link(path.c_str(), batch->paths.back().c_str()) != 0) {
+            std::fprintf(stderr, "cannot link %s\n", path.c_str());
+            std::exit(2);
+        }
+    }
+    auto start = Clock::now();
+    RunBatch(pool, batch, &FileCataloger::RunPathOps);
+    return MsSince(start);
+}
+
+struct Operation {
+    const char* name;
+    std::function<double(WorkStealingPool&, IoEngine&, const std::vector<std::string>&)> run;
+};
+
+} // namespace
+
+int main() {
+    const char* sizesEnv = std::getenv("IO_BENCH_FILES");
+    const char* runsEnv = std::getenv("IO_BENCH_RUNS");
+    std::vector<size_t> sizes = ParseSizes(sizesEnv ? sizesEnv : "10000,100000");
+    const int runs = std::max(1, runsEnv ? std::atoi(runsEnv) : 3);
+
+    std::vector<IoEngine*> engines = {&FileCataloger::SyscallIoEngine()};
+    if (IoEngine* uring = FileCataloger::UringIoEngine()) {
+        engines.push_back(uring);
+    } else {
+        std::printf("io_uring unavailable here; syscall engine only\n");
+    }
+
+    WorkStealingPool pool;
+    std::printf("pool of %zu threads, best of %d runs, page cache warm\n\n", pool.ThreadCount(), runs);
+    std::printf("%9s  %-16s %12s %12s %9s\n", "files", "operation", "syscalls ms", "io_uring ms", "speedup");
+
+    const Operation operations[] = {
+        {"stat, 1 thread", [](WorkStealingPool&, IoEngine& engine, const std::vector<std::string>& paths) {
+             return StatOneThread(engine, paths);
+         }},
+        {"stat file list", StatList},
+        {"sniff", Sniff},
+        {"rename", Rename},
+        {"unlink", Unlink},
+    };
+
+    for (size_t count : sizes) {
+        char pattern[] = "/tmp/fc-io-bench-XXXXXX";
+        const char* root = mkdtemp(pattern);
+        if (!root) {
+            std::fprintf(stderr, "mkdtemp failed\n");
+            return 2;
+        }
+        std::vector<std::string> paths;
+        paths.reserve(count);
+        MakeShelf(root, count, &paths);
+
+        for (const Operation& operation : operations) {
+            double best[2] = {0, 0};
+            for (size_t e = 0; e < engines.size(); e++) {
+                for (int run = 0; run < runs; run++) {
+                    double ms = operation.run(pool, *engines[e], paths);
+                    best[e] = run == 0 ? ms : std::min(best[e], ms);
+                }
+            }
+            if (engines.size() > 1) {
+                std::printf("%9zu  %-16s %12.1f %12.1f %8.2fx\n", count, operation.name, best[0], best[1],
+                            best[0] / best[1]);
+            } else {
+                std::printf("%9zu  %-16s %12.1f %12s %9s\n", count, operation.name, best[0], "-", "-");
+            }
+            std::fflush(stdout);
+        }
+
+        std::string command = std::string("rm -rf '") + root + "'";
+        if (std::system(command.c_str()) != 0) {
+            std::fprintf(stderr, "cannot remove %s\n", root);
+        }
+    }
+    std::printf("\nengines: %s", IoEngineName(engines[0]->Kind()));
+    if (engines.size() > 1) {
+        std::printf(", %s", IoEngineName(engines[1]->Kind()));
+    }
+    std::printf("\n");
+    return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file media_metadata_bench.cc
+ * @brief Capture-date extraction benchmark over a synthetic photo library
+ *
+ * Writes a corpus of JPEGs (10000 by default) whose EXIF headers differ in
+ * date, camera and byte order, padded to a camera-like size with a sparse
+ * tail so the corpus costs little disk. Compares:
+ * - reading each whole file then parsing it, what a JS EXIF library fed by
+ *   fs.readFile pays
+ * - header-only extraction in one thread and on the pool, cache cold
+ * - the same batch again with the cache warm
+ *
+ * The page cache is warm for every row; on a cold disk the whole-file read
+ * gets much slower while header-only reads stay at a few pages per file.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run bench:media-metadata
+ *   MEDIA_BENCH_FILES=50000 MEDIA_BENCH_PHOTO_KB=6144 npm run bench:media-metadata
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "media_metadata.h"
+
+using FileCataloger::MediaMetadata;
+using FileCataloger::MediaMetadataBatch;
+using FileCataloger::MediaMetadataExtractor;
+using FileCataloger::ReadMediaMetadata;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Bytes = std::vector<uint8_t>;
+
+double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void Put(Bytes& out, uint32_t value, int bytes, bool little) {
+    for (int i = 0; i < bytes; i++) {
+        const int shift = little ? i * 8 : (bytes - 1 - i) * 8;
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+// SOI, APP1 with IFD0 (Make, Model, ExifIFD) and an EXIF IFD (DateTimeOriginal), SOF0, SOS
+Bytes PhotoHeader(size_t index) {
+    static const char* models[] = {"iPhone 15 Pro", "Pixel 8", "Canon EOS R6", "ILCE-7M4", "X-T5"};
+    const bool little = index % 2 == 0;
+    char date[20];
+    std::snprintf(date, sizeof(date), "20%02zu:%02zu:%02zu %02zu:%02zu:%02zu", 10 + index % 14, 1 + index % 12,
+                  1 + index % 28, index % 24, index % 60, (index / 60) % 60);
+    const std::string make = "Maker";
+    const std::string model = models[index % 5];
+
+    Bytes tiff;
+    tiff.push_back(little ? 'I' : 'M');
+    tiff.push_back(little ? 'I' : 'M');
+    Put(tiff, 42, 2, little);
+    Put(tiff, 8, 4, little);
+    const uint32_t ifd0Size = 2 + 3 * 12 + 4;
+    const uint32_t exifOffset = 8 + ifd0Size;
+    const uint32_t dataOffset = exifOffset + 2 + 12 + 4;
+    auto entry = [&](uint16_t tag, uint16_t type, uint32_t count, uint32_t value) {
+        Put(tiff, tag, 2, little);
+        Put(tiff, type, 2, little);
+        Put(tiff, count, 4, little);
+        Put(tiff, value, 4, little);
+    };
+    Put(tiff, 3, 2, little);
+    entry(0x010F, 2, static_cast<uint32_t>(make.size() + 1), dataOffset);
+    entry(0x0110, 2, static_cast<uint32_t>(model.size() + 1), dataOffset + static_cast<uint32_t>(make.size() + 1));
+    entry(0x8769, 4, 1, exifOffset);
+    Put(tiff, 0, 4, little);
+    Put(tiff, 1, 2, little);
+    entry(0x9003, 2, 20, dataOffset + static_cast<uint32_t>(make.size() + model.size() + 2));
+    Put(tiff, 0, 4, little);
+    for (const std::string& text : {make, model, std::string(date)}) {
+        tiff.insert(tiff.end(), text.begin(), text.end());
+        tiff.push_back(0);
+    }
+
+    Bytes out = {0xFF, 0xD8, 0xFF, 0xE1};
+    Put(out, static_cast<uint32_t>(tiff.size() + 8), 2, false);
+    const char exif[] = "Exif\0\0";
+    out.insert(out.end(), exif, exif + 6);
+    out.insert(out.end(), tiff.begin(), tiff.end());
+    // Quantization tables and a thumbnail-sized gap, as cameras write them
+    out.insert(out.end(), {0xFF, 0xDB, 0x00, 0x84});
+    out.resize(out.size() + 0x82, 1);
+    out.insert(out.end(), {0xFF, 0xC0, 0x00, 0x11, 0x08, 0x0F, 0xC0, 0x17, 0xA0});
+    out.resize(out.size() + 10, 0x11);
+    out.insert(out.end(), {0xFF, 0xDA, 0x00, 0x0C});
+    out.resize(out.size() + 10, 0);
+    return out;
+}
+
+std::vector<std::string> MakeCorpus(const std::string& dir, size_t files, size_t photoBytes) {
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < files; i++) {
+        const std::string path = dir + "/IMG_" + std::to_string(10000 + i) + ".jpg";
+        const Bytes header = PhotoHeader(i);
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || write(fd, header.data(), header.size()) != static_cast<ssize_t>(header.size()) ||
+            ftruncate(fd, static_cast<off_t>(std::max(photoBytes, header.size()))) != 0) {
+            std::fprintf(stderr, "cannot write corpus file %s\n", path.c_str());
+            std::exit(2);
+        }
+        close(fd);
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+void PrintRow(const char* name, double ms, size_t files, size_t found) {
+    std::printf("  %-36s %10.1f %12.0f %8zu\n", name, ms, files / (ms / 1000.0), found);
+}
+
+size_t Found(const std::vector<MediaMetadata>& results) {
+    return static_cast<size_t>(std::count_if(results.begin(), results.end(), [](const MediaMetadata& m) {
+        return (m.fields & FileCataloger::kMediaCaptureTime) != 0;
+    }));
+}
+
+void BenchWholeFile(const std::vector<std::string>& paths) {
+    std::vector<MediaMetadata> results(paths.size());
+    std::vector<char> buffer(1 << 20);
+    const auto start = Clock::now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        int fd = open(paths[i].c_str(), O_RDONLY);
+        while (fd >= 0 && read(fd, buffer.data(), buffer.size()) > 0) {
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        ReadMediaMetadata(paths[i], &results[i]);
+    }
+    PrintRow("whole-file read + parse, 1 thread", MsSince(start), paths.size(), Found(results));
+}
+
+void BenchHeaderOnly(const std::vector<std::string>& paths) {
+    std::vector<MediaMetadata> results(paths.size());
+    const auto start = Clock::now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        ReadMediaMetadata(paths[i], &results[i]);
+    }
+    PrintRow("header-only, 1 thread", MsSince(start), paths.size(), Found(results));
+}
+
+void BenchBatch(const char* name, MediaMetadataExtractor& extractor, WorkStealingPool& pool,
+                const std::vector<std::string>& paths) {
+    auto batch = std::make_shared<MediaMetadataBatch>();
+    batch->paths = paths;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::shared_ptr<MediaMetadataBatch> result;
+    const auto start = Clock::now();
+    extractor.ExtractFiles(pool, batch, [&](std::shared_ptr<MediaMetadataBatch> done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = std::move(done);
+        cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return result != nullptr; });
+    PrintRow(name, MsSince(start), paths.size(), Found(result->results));
+}
+
+} // namespace
+
+int main() {
+    const char* filesEnv = std::getenv("MEDIA_BENCH_FILES");
+    const char* sizeEnv = std::getenv("MEDIA_BENCH_PHOTO_KB");
+    const size_t files = std::max(100, filesEnv ? std::atoi(filesEnv) : 10000);
+    const size_t photoBytes = static_cast<size_t>(std::max(64, sizeEnv ? std::atoi(sizeEnv) : 3072)) * 1024;
+    char pattern[] = "/tmp/media_metadata_bench.XXXXXX";
+    const char* work = mkdtemp(pattern);
+    if (!work) {
+        std::fprintf(stderr, "cannot create work directory\n");
+        return 2;
+    }
+    const std::string dir = work;
+
+    const auto prepare = Clock::now();
+    const std::vector<std::string> paths = MakeCorpus(dir, files, photoBytes);
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("Corpus: %zu photos of %zu KB (prepared in %.0f ms), %zu hardware threads\n", files,
+                photoBytes / 1024, MsSince(prepare), cores);
+    std::printf("  %-36s %10s %12s %8s\n", "reader", "ms", "files/s", "dated");
+
+    BenchWholeFile(paths);
+    BenchHeaderOnly(paths);
+    {
+        WorkStealingPool pool(cores);
+        MediaMetadataExtractor extractor;
+        const std::string cold = "header-only, pool of " + std::to_string(cores) + ", cache cold";
+        BenchBatch(cold.c_str(), extractor, pool, paths);
+        BenchBatch("header-only, pool, cache warm", extractor, pool, paths);
+    }
+
+    const std::string command = "rm -rf '" + dir + "'";
+    if (system(command.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", work);
+    }
+    return 0;
+}
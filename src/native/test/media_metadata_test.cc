@@ -0,0 +1,698 @@
+/**
+ * @file media_metadata_test.cc
+ * @brief Functional test for header-only photo and video metadata
+ *
+ * Builds small files for each supported container: JPEG with little- and
+ * big-endian EXIF, a TIFF-based raw file, PNG with IHDR and a "Creation
+ * Time" text chunk, an MP4 whose moov follows a large sparse mdat, and a
+ * HEIC whose EXIF item is found through iinf/iloc. Checks capture time
+ * (with and without an EXIF offset, under a fixed TZ), camera, duration and
+ * dimensions, and that the video is parsed from a few mapped pages.
+ *
+ * Every fixture is then truncated at each length and mutated at random to
+ * check that malformed input only loses fields. Finally the extractor's
+ * cache (hit, invalidation on mtime change) and a bulk batch whose results
+ * must come back in path order.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "media_metadata.h"
+#include "test_support.h"
+
+using FileCataloger::MediaMetadata;
+using FileCataloger::MediaMetadataBatch;
+using FileCataloger::MediaMetadataExtractor;
+using FileCataloger::MediaMetadataReader;
+using FileCataloger::ParseMediaMetadata;
+using FileCataloger::ReadMediaMetadata;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+void Append(Bytes& out, const Bytes& bytes) {
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+void Append(Bytes& out, const std::string& text) {
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+void PutBe(Bytes& out, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+void PutLe(Bytes& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+int64_t UtcMs(int year, int month, int day, int hour, int minute, int second) {
+    struct tm fields {};
+    fields.tm_year = year - 1900;
+    fields.tm_mon = month - 1;
+    fields.tm_mday = day;
+    fields.tm_hour = hour;
+    fields.tm_min = minute;
+    fields.tm_sec = second;
+    return static_cast<int64_t>(timegm(&fields)) * 1000;
+}
+
+// ---------------------------------------------------------------------------
+// Fixture builders
+// ---------------------------------------------------------------------------
+
+struct TiffEntry {
+    uint16_t tag;
+    uint16_t type;          // 2 ASCII, 3 SHORT, 4 LONG
+    std::string text;
+    uint32_t number;
+};
+
+TiffEntry Ascii(uint16_t tag, const std::string& text) {
+    return TiffEntry{tag, 2, text, 0};
+}
+
+TiffEntry Short(uint16_t tag, uint32_t value) {
+    return TiffEntry{tag, 3, std::string(), value};
+}
+
+TiffEntry Long(uint16_t tag, uint32_t value) {
+    return TiffEntry{tag, 4, std::string(), value};
+}
+
+// TIFF header, IFD0, then the EXIF IFD (when exif is not empty), then out-of-line strings
+Bytes Tiff(bool little, std::vector<TiffEntry> ifd0, const std::vector<TiffEntry>& exif) {
+    auto put = [little](Bytes& out, uint64_t value, int bytes) {
+        little ? PutLe(out, value, bytes) : PutBe(out, value, bytes);
+    };
+    const uint32_t ifd0Size = 2 + 12 * static_cast<uint32_t>(ifd0.size() + (exif.empty() ? 0 : 1)) + 4;
+    const uint32_t exifOffset = 8 + ifd0Size;
+    if (!exif.empty()) {
+        ifd0.push_back(Long(0x8769, exifOffset));
+    }
+    const uint32_t exifSize = exif.empty() ? 0 : 2 + 12 * static_cast<uint32_t>(exif.size()) + 4;
+
+    Bytes out;
+    Append(out, std::string(little ? "II" : "MM"));
+    put(out, 42, 2);
+    put(out, 8, 4);
+    Bytes data;
+    uint32_t dataOffset = exifOffset + exifSize;
+    auto writeIfd = [&](const std::vector<TiffEntry>& entries) {
+        put(out, entries.size(), 2);
+        for (const auto& entry : entries) {
+            put(out, entry.tag, 2);
+            put(out, entry.type, 2);
+            if (entry.type == 2) {
+                const uint32_t count = static_cast<uint32_t>(entry.text.size() + 1);
+                put(out, count, 4);
+                if (count <= 4) {
+                    Bytes inline_(entry.text.begin(), entry.text.end());
+                    inline_.resize(4, 0);
+                    Append(out, inline_);
+                } else {
+                    put(out, dataOffset + data.size(), 4);
+                    Append(data, entry.text);
+                    data.push_back(0);
+                }
+            } else if (entry.type == 3) {
+                put(out, 1, 4);
+                put(out, entry.number, 2);
+                put(out, 0, 2);
+            } else {
+                put(out, 1, 4);
+                put(out, entry.number, 4);
+            }
+        }
+        put(out, 0, 4);
+    };
+    writeIfd(ifd0);
+    if (!exif.empty()) {
+        writeIfd(exif);
+    }
+    Append(out, data);
+    return out;
+}
+
+Bytes CameraTiff(bool little) {
+    return Tiff(little, {Ascii(0x010F, "Canon"), Ascii(0x0110, "Canon EOS R5"), Ascii(0x0132, "2020:01:01 00:00:00")},
+                {Ascii(0x9003, "2023:08:14 16:05:09"), Ascii(0x9011, "-04:00"), Ascii(0x9291, "25"),
+                 Short(0xA002, 8192), Short(0xA003, 5464)});
+}
+
+Bytes Segment(uint8_t marker, const Bytes& body) {
+    Bytes out = {0xFF, marker};
+    PutBe(out, body.size() + 2, 2);
+    Append(out, body);
+    return out;
+}
+
+Bytes Jpeg(const Bytes& tiff, uint16_t width, uint16_t height) {
+    Bytes out = {0xFF, 0xD8};
+    Bytes jfif;
+    Append(jfif, std::string("JFIF\0\x01\x01\0\0\x01\0\x01\0\0", 14));
+    Append(out, Segment(0xE0, jfif));
+    if (!tiff.empty()) {
+        Bytes app1;
+        Append(app1, std::string("Exif\0\0", 6));
+        Append(app1, tiff);
+        Append(out, Segment(0xE1, app1));
+    }
+    Append(out, Segment(0xDB, Bytes(65, 1)));
+    Bytes sof = {8};
+    PutBe(sof, height, 2);
+    PutBe(sof, width, 2);
+    Append(sof, Bytes{3, 1, 0x22, 0, 2, 0x11, 1, 3, 0x11, 1});
+    Append(out, Segment(0xC0, sof));
+    Append(out, Segment(0xDA, Bytes{3, 1, 0, 2, 0x11, 3, 0x11, 0, 0x3F, 0}));
+    Append(out, Bytes(512, 0x55));
+    Append(out, Bytes{0xFF, 0xD9});
+    return out;
+}
+
+Bytes PngChunk(const char* type, const Bytes& data) {
+    Bytes out;
+    PutBe(out, data.size(), 4);
+    Append(out, std::string(type, 4));
+    Append(out, data);
+    PutBe(out, 0, 4);       // CRC is not checked
+    return out;
+}
+
+Bytes Png(const std::string& creationTime, const Bytes& exif) {
+    Bytes out;
+    Append(out, std::string("\x89PNG\r\n\x1A\n", 8));
+    Bytes ihdr;
+    PutBe(ihdr, 1280, 4);
+    PutBe(ihdr, 720, 4);
+    Append(ihdr, Bytes{8, 6, 0, 0, 0});
+    Append(out, PngChunk("IHDR", ihdr));
+    Bytes text;
+    Append(text, std::string("Software\0test", 13));
+    Append(out, PngChunk("tEXt", text));
+    if (!creationTime.empty()) {
+        Bytes creation;
+        Append(creation, std::string("Creation Time\0", 14));
+        Append(creation, creationTime);
+        Append(out, PngChunk("tEXt", creation));
+    }
+    if (!exif.empty()) {
+        Append(out, PngChunk("eXIf", exif));
+    }
+    Append(out, PngChunk("IDAT", Bytes(64, 0)));
+    // Chunks after IDAT are ignored
+    Bytes late;
+    Append(late, std::string("Creation Time\0" "1999-01-01T00:00:00Z", 34));
+    Append(out, PngChunk("tEXt", late));
+    Append(out, PngChunk("IEND", Bytes()));
+    return out;
+}
+
+Bytes Box(const char* type, const Bytes& payload) {
+    Bytes out;
+    PutBe(out, payload.size() + 8, 4);
+    Append(out, std::string(type, 4));
+    Append(out, payload);
+    return out;
+}
+
+Bytes FullBox(const char* type, uint8_t version, const Bytes& payload) {
+    Bytes body = {version, 0, 0, 0};
+    Append(body, payload);
+    return Box(type, body);
+}
+
+Bytes Concat(std::initializer_list<Bytes> parts) {
+    Bytes out;
+    for (const auto& part : parts) {
+        Append(out, part);
+    }
+    return out;
+}
+
+Bytes Ftyp(const char* brand) {
+    Bytes payload;
+    Append(payload, std::string(brand, 4));
+    PutBe(payload, 0, 4);
+    Append(payload, std::string(brand, 4));
+    Append(payload, std::string("isom", 4));
+    return Box("ftyp", payload);
+}
+
+// QuickTime-style moov: mvhd, a video and an audio track, keys/ilst metadata
+Bytes Moov(uint64_t creation1904, uint32_t timescale, uint32_t duration, bool appleMetadata) {
+    Bytes mvhd;
+    PutBe(mvhd, creation1904, 4);
+    PutBe(mvhd, creation1904, 4);
+    PutBe(mvhd, timescale, 4);
+    PutBe(mvhd, duration, 4);
+    Append(mvhd, Bytes(80, 0));
+
+    auto track = [](uint32_t width, uint32_t height) {
+        Bytes tkhd;
+        PutBe(tkhd, 0, 4);      // creation
+        PutBe(tkhd, 0, 4);      // modification
+        PutBe(tkhd, 1, 4);      // track ID
+        PutBe(tkhd, 0, 4);
+        PutBe(tkhd, 0, 4);      // duration
+        Append(tkhd, Bytes(8 + 2 + 2 + 2 + 2 + 36, 0));
+        PutBe(tkhd, static_cast<uint64_t>(width) << 16, 4);
+        PutBe(tkhd, static_cast<uint64_t>(height) << 16, 4);
+        return Box("trak", FullBox("tkhd", 0, tkhd));
+    };
+
+    Bytes children = Concat({FullBox("mvhd", 0, mvhd), track(0, 0), track(1920, 1080)});
+    if (appleMetadata) {
+        const std::vector<std::string> keys = {"com.apple.quicktime.make", "com.apple.quicktime.model",
+                                               "com.apple.quicktime.creationdate"};
+        const std::vector<std::string> values = {"Apple", "iPhone 14 Pro", "2023-07-04T18:30:00+0200"};
+        Bytes keysPayload;
+        PutBe(keysPayload, 0, 4);
+        PutBe(keysPayload, keys.size(), 4);
+        for (const auto& key : keys) {
+            PutBe(keysPayload, key.size() + 8, 4);
+            Append(keysPayload, std::string("mdta"));
+            Append(keysPayload, key);
+        }
+        Bytes ilst;
+        for (size_t i = 0; i < values.size(); i++) {
+            Bytes data;
+            PutBe(data, 1, 4);      // UTF-8
+            PutBe(data, 0, 4);      // locale
+            Append(data, values[i]);
+            Bytes item = Box("data", data);
+            Bytes boxed;
+            PutBe(boxed, item.size() + 8, 4);
+            PutBe(boxed, i + 1, 4);
+            Append(boxed, item);
+            Append(ilst, boxed);
+        }
+        Bytes hdlr(25, 0);
+        Append(children, Box("meta", Concat({Box("hdlr", hdlr), Box("keys", keysPayload), Box("ilst", ilst)})));
+    } else {
+        // ©day in udta
+        Bytes day;
+        const std::string text = "2019-05-20T09:00:00Z";
+        PutBe(day, text.size(), 2);
+        PutBe(day, 0x55C4, 2);
+        Append(day, text);
+        Bytes udtaBox;
+        PutBe(udtaBox, day.size() + 8, 4);
+        Append(udtaBox, std::string("\xA9" "day", 4));
+        Append(udtaBox, day);
+        Append(children, Box("udta", udtaBox));
+    }
+    return Box("moov", children);
+}
+
+// HEIC: meta with two items (the image and its EXIF), ispe properties, then mdat
+Bytes Heic(const Bytes& tiff) {
+    Bytes exifItem;
+    PutBe(exifItem, 6, 4);
+    Append(exifItem, std::string("Exif\0\0", 6));
+    Append(exifItem, tiff);
+    const Bytes image(256, 0x42);
+
+    auto meta = [&](uint32_t mdatPayload) {
+        auto infe = [](uint16_t id, const char* type) {
+            Bytes payload;
+            PutBe(payload, id, 2);
+            PutBe(payload, 0, 2);
+            Append(payload, std::string(type, 4));
+            payload.push_back(0);   // item name
+            return FullBox("infe", 2, payload);
+        };
+        Bytes iinf;
+        PutBe(iinf, 2, 2);
+        Append(iinf, infe(1, "hvc1"));
+        Append(iinf, infe(2, "Exif"));
+
+        Bytes iloc = {0x44, 0x00};  // offset_size 4, length_size 4, base_offset_size 0
+        PutBe(iloc, 2, 2);
+        const uint32_t offsets[] = {mdatPayload, mdatPayload + static_cast<uint32_t>(image.size())};
+        const uint32_t lengths[] = {static_cast<uint32_t>(image.size()), static_cast<uint32_t>(exifItem.size())};
+        for (int i = 0; i < 2; i++) {
+            PutBe(iloc, i + 1, 2);
+            PutBe(iloc, 0, 2);      // data reference
+            PutBe(iloc, 1, 2);      // extent count
+            PutBe(iloc, offsets[i], 4);
+            PutBe(iloc, lengths[i], 4);
+        }
+
+        auto ispe = [](uint32_t width, uint32_t height) {
+            Bytes payload;
+            PutBe(payload, width, 4);
+            PutBe(payload, height, 4);
+            return FullBox("ispe", 0, payload);
+        };
+        Bytes pitm;
+        PutBe(pitm, 1, 2);
+        return FullBox("meta", 0,
+                       Concat({FullBox("hdlr", 0, Bytes(21, 0)), FullBox("pitm", 0, pitm), FullBox("iinf", 0, iinf),
+                               FullBox("iloc", 0, iloc),
+                               Box("iprp", Box("ipco", Concat({ispe(512, 512), ispe(4032, 3024)})))}));
+    };
+
+    const Bytes ftyp = Ftyp("heic");
+    const uint32_t mdatPayload = static_cast<uint32_t>(ftyp.size() + meta(0).size() + 8);
+    return Concat({ftyp, meta(mdatPayload), Box("mdat", Concat({image, exifItem}))});
+}
+
+// ftyp, a sparse mdat of mdatSize bytes, then moov
+void WriteSparseMovie(const std::string& path, uint64_t mdatSize, const Bytes& moov) {
+    Bytes head = Ftyp("mp42");
+    PutBe(head, 1, 4);
+    Append(head, std::string("mdat"));
+    PutBe(head, mdatSize, 8);
+    const uint64_t moovOffset = Ftyp("mp42").size() + mdatSize;
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || pwrite(fd, head.data(), head.size(), 0) != static_cast<ssize_t>(head.size()) ||
+        pwrite(fd, moov.data(), moov.size(), static_cast<off_t>(moovOffset)) != static_cast<ssize_t>(moov.size())) {
+        std::fprintf(stderr, "cannot write fixture %s\n", path.c_str());
+        std::exit(2);
+    }
+    close(fd);
+}
+
+MediaMetadata Read(const std::string& path) {
+    MediaMetadata metadata;
+    ReadMediaMetadata(path, &metadata);
+    return metadata;
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+// ---------------------------------------------------------------------------
+
+void TestJpeg(const std::string& root) {
+    for (bool little : {true, false}) {
+        const std::string path = root + (little ? "/le.jpg" : "/be.jpg");
+        WriteFile(path, Jpeg(CameraTiff(little), 640, 480));
+        const MediaMetadata m = Read(path);
+        const char* order = little ? "II" : "MM";
+        EXPECT(m.fields == (FileCataloger::kMediaCaptureTime | FileCataloger::kMediaCamera |
+                            FileCataloger::kMediaDimensions),
+               "%s jpeg fields %u", order, m.fields);
+        // 16:05:09.25 at UTC-4
+        EXPECT(m.captureTimeMs == UtcMs(2023, 8, 14, 20, 5, 9) + 250, "%s jpeg capture %lld", order,
+               static_cast<long long>(m.captureTimeMs));
+        EXPECT(m.cameraMake == "Canon" && m.cameraModel == "Canon EOS R5", "%s jpeg camera '%s' '%s'", order,
+               m.cameraMake.c_str(), m.cameraModel.c_str());
+        EXPECT(m.width == 8192 && m.height == 5464, "%s jpeg EXIF dimensions %ux%u", order, m.width, m.height);
+    }
+
+    // No offset tag: local time (TZ is UTC+9 for this test)
+    WriteFile(root + "/local.jpg",
+              Jpeg(Tiff(true, {Ascii(0x0110, "Pixel 7")}, {Ascii(0x9003, "2024:03:10 08:15:30")}), 4080, 3072));
+    MediaMetadata m = Read(root + "/local.jpg");
+    EXPECT(m.captureTimeMs == UtcMs(2024, 3, 9, 23, 15, 30), "local capture time %lld",
+           static_cast<long long>(m.captureTimeMs));
+    EXPECT(m.cameraMake.empty() && m.cameraModel == "Pixel 7", "model without make");
+    EXPECT(m.width == 4080 && m.height == 3072, "SOF dimensions %ux%u", m.width, m.height);
+
+    // Unset camera clock, falls back to DateTime; then no EXIF at all
+    WriteFile(root + "/unset.jpg", Jpeg(Tiff(false, {Ascii(0x0132, "2021:02:03 04:05:06")},
+                                             {Ascii(0x9003, "0000:00:00 00:00:00")}), 10, 10));
+    m = Read(root + "/unset.jpg");
+    EXPECT(m.captureTimeMs == UtcMs(2021, 2, 2, 19, 5, 6), "DateTime fallback");
+    WriteFile(root + "/plain.jpg", Jpeg(Bytes(), 800, 600));
+    m = Read(root + "/plain.jpg");
+    EXPECT(m.fields == FileCataloger::kMediaDimensions && m.width == 800, "jpeg without EXIF");
+}
+
+void TestTiff(const std::string& root) {
+    WriteFile(root + "/raw.cr2",
+              Tiff(true,
+                   {Long(0x0100, 6000), Long(0x0101, 4000), Ascii(0x010F, "NIKON CORPORATION   "),
+                    Ascii(0x0110, "NIKON Z 6")},
+                   {Ascii(0x9003, "2022:12:24 21:00:00"), Ascii(0x9011, "+09:00")}));
+    const MediaMetadata m = Read(root + "/raw.cr2");
+    EXPECT(m.captureTimeMs == UtcMs(2022, 12, 24, 12, 0, 0), "raw capture time");
+    EXPECT(m.cameraMake == "NIKON CORPORATION" && m.cameraModel == "NIKON Z 6", "raw camera '%s'",
+           m.cameraMake.c_str());
+    EXPECT(m.width == 6000 && m.height == 4000, "raw dimensions %ux%u", m.width, m.height);
+}
+
+void TestPng(const std::string& root) {
+    WriteFile(root + "/iso.png", Png("2020-06-01T10:20:30Z", Bytes()));
+    MediaMetadata m = Read(root + "/iso.png");
+    EXPECT(m.captureTimeMs == UtcMs(2020, 6, 1, 10, 20, 30), "png ISO creation time %lld",
+           static_cast<long long>(m.captureTimeMs));
+    EXPECT(m.width == 1280 && m.height == 720, "png IHDR dimensions");
+
+    WriteFile(root + "/rfc.png", Png("Mon, 01 Jun 2020 10:20:30 GMT", Bytes()));
+    m = Read(root + "/rfc.png");
+    EXPECT(m.captureTimeMs == UtcMs(2020, 6, 1, 10, 20, 30), "png RFC 1123 creation time");
+
+    // eXIf wins over the text chunk and brings the camera
+    WriteFile(root + "/exif.png", Png("2020-06-01T10:20:30Z", CameraTiff(false)));
+    m = Read(root + "/exif.png");
+    EXPECT(m.captureTimeMs == UtcMs(2023, 8, 14, 20, 5, 9) + 250, "png eXIf capture time");
+    EXPECT(m.cameraModel == "Canon EOS R5", "png eXIf camera");
+
+    WriteFile(root + "/none.png", Png("", Bytes()));
+    m = Read(root + "/none.png");
+    EXPECT(!(m.fields & FileCataloger::kMediaCaptureTime), "chunks after IDAT are ignored");
+}
+
+void TestMovie(const std::string& root) {
+    const uint64_t kMacEpoch = 2082844800ull;
+    const uint64_t created = kMacEpoch + static_cast<uint64_t>(UtcMs(2023, 7, 4, 16, 31, 0) / 1000);
+    const std::string path = root + "/clip.mov";
+    WriteSparseMovie(path, 512ull << 20, Moov(created, 600, 600 * 205, true));
+
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    fstat(fd, &st);
+    {
+        MediaMetadataReader reader(fd, static_cast<uint64_t>(st.st_size));
+        MediaMetadata m;
+        EXPECT(ParseMediaMetadata(reader, &m), "mov parsed");
+        EXPECT(m.fields == (FileCataloger::kMediaCaptureTime | FileCataloger::kMediaCamera |
+                            FileCataloger::kMediaDuration | FileCataloger::kMediaDimensions),
+               "mov fields %u", m.fields);
+        // creationdate carries the zone and wins over mvhd
+        EXPECT(m.captureTimeMs == UtcMs(2023, 7, 4, 16, 30, 0), "mov capture %lld",
+               static_cast<long long>(m.captureTimeMs));
+        EXPECT(m.durationMs == 205000.0, "mov duration %.1f", m.durationMs);
+        EXPECT(m.width == 1920 && m.height == 1080, "mov dimensions %ux%u", m.width, m.height);
+        EXPECT(m.cameraMake == "Apple" && m.cameraModel == "iPhone 14 Pro", "mov camera");
+        EXPECT(reader.MappedBytes() <= 3 * MediaMetadataReader::kWindowSize, "mapped %zu bytes of a %lld byte file",
+               reader.MappedBytes(), static_cast<long long>(st.st_size));
+    }
+    close(fd);
+
+    // udta ©day, then mvhd alone
+    WriteSparseMovie(root + "/day.mp4", 4096, Moov(created, 1000, 1500, false));
+    MediaMetadata m = Read(root + "/day.mp4");
+    EXPECT(m.captureTimeMs == UtcMs(2019, 5, 20, 9, 0, 0), "©day capture time");
+    EXPECT(m.durationMs == 1500.0, "mp4 duration %.1f", m.durationMs);
+    EXPECT(m.cameraMake.empty() && !(m.fields & FileCataloger::kMediaCamera), "mp4 without camera");
+
+    Bytes bare = Concat({Ftyp("isom"), Moov(created, 0, 100, true)});
+    WriteFile(root + "/zero-timescale.mp4", bare);
+    m = Read(root + "/zero-timescale.mp4");
+    EXPECT(!(m.fields & FileCataloger::kMediaDuration), "zero timescale has no duration");
+}
+
+void TestHeic(const std::string& root) {
+    WriteFile(root + "/photo.heic", Heic(CameraTiff(false)));
+    const MediaMetadata m = Read(root + "/photo.heic");
+    EXPECT(m.captureTimeMs == UtcMs(2023, 8, 14, 20, 5, 9) + 250, "heic capture %lld",
+           static_cast<long long>(m.captureTimeMs));
+    EXPECT(m.cameraModel == "Canon EOS R5", "heic camera '%s'", m.cameraModel.c_str());
+    // ispe of the full image, not a tile nor the EXIF pixel dimensions
+    EXPECT(m.width == 4032 && m.height == 3024, "heic dimensions %ux%u", m.width, m.height);
+}
+
+void TestUnknown(const std::string& root) {
+    WriteFile(root + "/notes.txt", Bytes(100, 'a'));
+    MediaMetadata m;
+    EXPECT(!ReadMediaMetadata(root + "/notes.txt", &m) && m.fields == 0, "text file");
+    EXPECT(!ReadMediaMetadata(root + "/missing.jpg", &m), "missing file");
+    mkdir((root + "/folder.jpg").c_str(), 0755);
+    EXPECT(!ReadMediaMetadata(root + "/folder.jpg", &m), "directory");
+    mkfifo((root + "/pipe.jpg").c_str(), 0644);
+    EXPECT(!ReadMediaMetadata(root + "/pipe.jpg", &m), "FIFO");
+    WriteFile(root + "/tiny.jpg", Bytes{0xFF, 0xD8, 0xFF});
+    EXPECT(!ReadMediaMetadata(root + "/tiny.jpg", &m), "three-byte jpeg");
+
+    // The mapping budget caps how much of a file one parse can touch
+    WriteFile(root + "/big.bin", Bytes(4 << 20, 0));
+    int fd = open((root + "/big.bin").c_str(), O_RDONLY);
+    MediaMetadataReader reader(fd, 4 << 20);
+    size_t mapped = 0;
+    for (uint64_t offset = 0; offset < (4u << 20); offset += 100000) {
+        mapped += reader.Map(offset, 16) ? 1 : 0;
+    }
+    EXPECT(reader.MappedBytes() <= MediaMetadataReader::kMaxMappedBytes, "mapped %zu bytes", reader.MappedBytes());
+    EXPECT(mapped > 0 && mapped < 42, "budget stops mapping (%zu windows)", mapped);
+    EXPECT(reader.Map((4u << 20) - 8, 16) == nullptr, "map past the end");
+    close(fd);
+}
+
+// Every prefix and random mutations of each fixture: no crash, no sanitizer report
+void TestMalformed(const std::string& root) {
+    const std::vector<Bytes> fixtures = {
+        Jpeg(CameraTiff(true), 640, 480),
+        Tiff(false, {Long(0x0100, 6000), Ascii(0x0110, "Model")}, {Ascii(0x9003, "2022:12:24 21:00:00")}),
+        Png("2020-06-01T10:20:30Z", CameraTiff(false)),
+        Concat({Ftyp("isom"), Moov(3000000000u, 600, 6000, true)}),
+        Heic(CameraTiff(true)),
+    };
+    const std::string path = root + "/malformed";
+    std::mt19937 rng(7);
+    size_t parses = 0;
+    for (const auto& fixture : fixtures) {
+        for (size_t length = 0; length <= fixture.size(); length++) {
+            WriteFile(path, Bytes(fixture.begin(), fixture.begin() + static_cast<long>(length)));
+            MediaMetadata m;
+            ReadMediaMetadata(path, &m);
+            parses++;
+        }
+        for (int round = 0; round < 400; round++) {
+            Bytes mutated = fixture;
+            const int flips = 1 + static_cast<int>(rng() % 4);
+            for (int i = 0; i < flips; i++) {
+                const size_t at = rng() % mutated.size();
+                mutated[at] = rng() % 3 == 0 ? 0xFF : static_cast<uint8_t>(rng());
+            }
+            WriteFile(path, mutated);
+            MediaMetadata m;
+            ReadMediaMetadata(path, &m);
+            parses++;
+        }
+    }
+    std::printf("  parsed %zu truncated or mutated files\n", parses);
+}
+
+void TestCache(const std::string& root) {
+    MediaMetadataExtractor extractor;
+    const std::string path = root + "/cached.jpg";
+    WriteFile(path, Jpeg(CameraTiff(true), 640, 480));
+
+    EXPECT(extractor.Extract(path).cameraModel == "Canon EOS R5", "first extract");
+    EXPECT(extractor.Extract(path).cameraModel == "Canon EOS R5", "cached extract");
+    EXPECT(extractor.CacheHits() == 1 && extractor.CacheMisses() == 1, "hits %llu misses %llu",
+           static_cast<unsigned long long>(extractor.CacheHits()),
+           static_cast<unsigned long long>(extractor.CacheMisses()));
+
+    // Rewritten in place with a new mtime: the cached entry no longer matches
+    WriteFile(path, Jpeg(Tiff(true, {Ascii(0x0110, "Other")}, {}), 640, 480));
+    struct timespec times[2] = {{0, UTIME_OMIT}, {time(nullptr) + 10, 0}};
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+    EXPECT(extractor.Extract(path).cameraModel == "Other", "rewritten file is re-read");
+    EXPECT(extractor.CacheMisses() == 2, "miss after mtime change");
+    EXPECT(extractor.Extract(root + "/missing.jpg").fields == 0, "missing file in extractor");
+    mkfifo((root + "/extract-pipe.jpg").c_str(), 0644);
+    EXPECT(extractor.Extract(root + "/extract-pipe.jpg").fields == 0, "FIFO in extractor");
+
+    // A tiny cache keeps working as generations rotate
+    MediaMetadataExtractor small(32);
+    for (int round = 0; round < 3; round++) {
+        EXPECT(small.Extract(path).cameraModel == "Other", "small cache round %d", round);
+    }
+}
+
+void TestBatch(const std::string& root) {
+    mkdir((root + "/bulk").c_str(), 0755);
+    const Bytes kinds[] = {Jpeg(CameraTiff(true), 640, 480), Png("2020-06-01T10:20:30Z", Bytes()),
+                           Heic(CameraTiff(false)), Bytes(64, 'x')};
+    const uint32_t widths[] = {8192, 1280, 4032, 0};
+
+    const size_t count = 1000;
+    auto batch = std::make_shared<MediaMetadataBatch>();
+    for (size_t i = 0; i < count; i++) {
+        const std::string path = root + "/bulk/f" + std::to_string(i);
+        WriteFile(path, kinds[i % 4]);
+        batch->paths.push_back(path);
+    }
+    batch->paths.push_back(root + "/bulk/missing");
+
+    MediaMetadataExtractor extractor;
+    WorkStealingPool pool(4);
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::shared_ptr<MediaMetadataBatch> result;
+    int calls = 0;
+    extractor.ExtractFiles(pool, batch, [&](std::shared_ptr<MediaMetadataBatch> done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        result = std::move(done);
+        calls++;
+        cv.notify_one();
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return result != nullptr; });
+    }
+
+    EXPECT(result->results.size() == count + 1, "batch size %zu", result->results.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count && i < result->results.size(); i++) {
+        mismatches += result->results[i].width != widths[i % 4] ? 1 : 0;
+    }
+    EXPECT(mismatches == 0, "%zu results out of order or wrong", mismatches);
+    EXPECT(result->results.back().fields == 0, "missing file in batch");
+
+    bool emptyDone = false;
+    extractor.ExtractFiles(pool, std::make_shared<MediaMetadataBatch>(),
+                           [&](std::shared_ptr<MediaMetadataBatch> done) { emptyDone = done->results.empty(); });
+    EXPECT(emptyDone, "empty batch");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT(calls == 1, "done called %d times", calls);
+}
+
+} // namespace
+
+int main() {
+    // A fixed zone, written without tzdata: EXIF dates without an offset are local
+    setenv("TZ", "<+09>-9", 1);
+    tzset();
+
+    char pattern[] = "/tmp/media_metadata_test.XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        return 2;
+    }
+
+    TestJpeg(root);
+    TestTiff(root);
+    TestPng(root);
+    TestMovie(root);
+    TestHeic(root);
+    TestUnknown(root);
+    TestMalformed(root);
+    TestCache(root);
+    TestBatch(root);
+
+    std::string cleanup = std::string("rm -rf '") + root + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", root);
+    }
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
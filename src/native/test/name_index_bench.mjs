@@ -0,0 +1,158 @@
+/**
+ * @fileoverview Benchmark: native fuzzy name search vs JavaScript matching
+ *
+ * Generates NAMES synthetic file names and times:
+ *   - native search with the SIMD mask filter and with the scalar one
+ *   - a typing sequence ("s", "sh", "shr", ...), which narrows each query
+ *   - name.toLowerCase().includes(query), the usual renderer filter
+ *   - a JavaScript subsequence match, as in the Windows fallback
+ *
+ * Usage (from src/native):
+ *   npm run bench:shelf-search
+ *   NAMES=1000000 RUNS=9 node test/name_index_bench.mjs
+ */
+
+import { createRequire } from 'module';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const require = createRequire(import.meta.url);
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const NAMES = Number(process.env.NAMES || 100000);
+const RUNS = Number(process.env.RUNS || 15);
+const QUERIES = ['report', 'img2041', 'shfinal', 'bdgq3', 'zzz'];
+const TYPING = 'shelfrpt';
+
+const native = require(
+  path.join(__dirname, '..', 'shelf-search', 'build', 'Release', `shelf_search_${process.platform}.node`)
+);
+
+function makeNames(count) {
+  const words = ['shelf', 'report', 'Final', 'draft', 'IMG', 'photo', 'invoice', 'Budget', 'notes', 'scan',
+    'summary', 'q3', 'v2', 'copy', 'export', 'backup', 'Screenshot', 'meeting', 'Café', 'plan'];
+  const separators = ['_', '-', ' ', '.'];
+  const extensions = ['.pdf', '.jpg', '.txt', '.xlsx', '.png', '.docx', '.HEIC', '.zip'];
+  let seed = 0x9e3779b9;
+  const random = n => {
+    // xorshift32: deterministic, so runs are comparable
+    seed ^= seed << 13;
+    seed ^= seed >>> 17;
+    seed ^= seed << 5;
+    return (seed >>> 0) % n;
+  };
+  const names = [];
+  for (let i = 0; i < count; i++) {
+    let name = words[random(words.length)];
+    for (let parts = random(4); parts > 0; parts--) {
+      name += separators[random(4)] + words[random(words.length)];
+    }
+    names.push(`${name}${random(10000)}${extensions[random(extensions.length)]}`);
+  }
+  return names;
+}
+
+function subsequence(names, query) {
+  const needle = query.toLowerCase();
+  let matches = 0;
+  for (const name of names) {
+    let position = -1;
+    let found = true;
+    for (const char of needle) {
+      position = name.indexOf(char, position + 1);
+      if (position < 0) {
+        found = false;
+        break;
+      }
+    }
+    if (found) matches++;
+  }
+  return matches;
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function bench(name, fn) {
+  fn();
+  const times = [];
+  let matches = 0;
+  for (let i = 0; i < RUNS; i++) {
+    const start = process.hrtime.bigint();
+    matches = fn();
+    times.push(Number(process.hrtime.bigint() - start) / 1e6);
+  }
+  const ms = median(times);
+  console.log(
+    `${name.padEnd(36)} ${String(matches).padStart(8)} matches  ${ms.toFixed(2).padStart(8)} ms  ` +
+      `${Math.round(NAMES / (ms / 1000)).toLocaleString()} names/s`
+  );
+  return ms;
+}
+
+const names = makeNames(NAMES);
+const lowered = names.map(name => name.toLowerCase());
+
+const simd = new native.NativeNameIndex();
+const scalar = new native.NativeNameIndex({ simd: false });
+let start = process.hrtime.bigint();
+simd.append(names);
+const appendMs = Number(process.hrtime.bigint() - start) / 1e6;
+scalar.append(names);
+
+const stats = simd.stats();
+console.log(
+  `\nNode ${process.version}, ${os.cpus().length} CPUs, ${NAMES} names, SIMD ${stats.simd ? 'on' : 'off'}, ` +
+    `median of ${RUNS} runs`
+);
+console.log(
+  `append: ${appendMs.toFixed(1)} ms, ${(stats.memoryBytes / 1048576).toFixed(1)} MB for the index\n`
+);
+
+let nativeTotal = 0;
+let scalarTotal = 0;
+let includesTotal = 0;
+let subsequenceTotal = 0;
+for (const query of QUERIES) {
+  console.log(`query "${query}"`);
+  // Alternate with the empty query so every search is a full scan
+  nativeTotal += bench('  native (SIMD mask filter), top 200', () => {
+    simd.search('', 1);
+    return simd.search(query, 200).total;
+  });
+  scalarTotal += bench('  native (scalar mask filter), top 200', () => {
+    scalar.search('', 1);
+    return scalar.search(query, 200).total;
+  });
+  includesTotal += bench('  JS toLowerCase().includes', () =>
+    names.reduce((count, name) => count + (name.toLowerCase().includes(query) ? 1 : 0), 0)
+  );
+  subsequenceTotal += bench('  JS subsequence (pre-lowered)', () => subsequence(lowered, query));
+}
+
+console.log(`\ntyping "${TYPING}", one search per keystroke`);
+const typing = [];
+for (let run = 0; run < RUNS; run++) {
+  simd.search('', 1);
+  const keystrokes = [];
+  for (let i = 1; i <= TYPING.length; i++) {
+    start = process.hrtime.bigint();
+    const result = simd.search(TYPING.slice(0, i), 200);
+    keystrokes.push({ ms: Number(process.hrtime.bigint() - start) / 1e6, scanned: result.scanned });
+  }
+  typing.push(keystrokes);
+}
+for (let i = 0; i < TYPING.length; i++) {
+  const ms = median(typing.map(keystrokes => keystrokes[i].ms));
+  console.log(
+    `  "${TYPING.slice(0, i + 1)}"`.padEnd(14) +
+      `scanned ${String(typing[0][i].scanned).padStart(8)}  ${ms.toFixed(2).padStart(7)} ms`
+  );
+}
+
+console.log(`\nSIMD vs scalar mask filter: ${(scalarTotal / nativeTotal).toFixed(2)}x`);
+console.log(`native vs includes:         ${(includesTotal / nativeTotal).toFixed(1)}x`);
+console.log(`native vs JS subsequence:    ${(subsequenceTotal / nativeTotal).toFixed(1)}x`);
@@ -0,0 +1,220 @@
+/**
+ * @file name_index_test.cc
+ * @brief Functional test for fuzzy name search
+ *
+ * Checks case folding, that the SIMD mask filter agrees with the scalar one
+ * and with a brute-force test, the ranking rules (word boundaries, runs,
+ * shorter names on ties), and that narrowing a previous query, with names
+ * appended in between, returns exactly what a fresh full scan returns.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fuzzy_match.h"
+#include "name_index.h"
+#include "test_support.h"
+
+using FileCataloger::CharMask;
+using FileCataloger::FilterByMask;
+using FileCataloger::FoldCase;
+using FileCataloger::MatchKernel;
+using FileCataloger::NameIndex;
+using FileCataloger::NameSearchResult;
+
+namespace {
+
+std::vector<std::string> Search(NameIndex& index, const std::vector<std::string>& names, const std::string& query,
+                                uint32_t limit = 0) {
+    NameSearchResult result;
+    index.Search(query, limit, &result);
+    std::vector<std::string> ranked;
+    for (uint32_t i : result.indices) {
+        ranked.push_back(names[i]);
+    }
+    return ranked;
+}
+
+void TestFolding() {
+    std::string folded = FoldCase("\xC3\x80\xC3\x89\xC3\x8E\xC3\x97\xC3\x9E Abc-Z", 16);
+    EXPECT(folded == "\xC3\xA0\xC3\xA9\xC3\xAE\xC3\x97\xC3\xBE abc-z", "latin-1 and ascii folding");
+    EXPECT(FoldCase("\xE2\x82\xAC", 3) == "\xE2\x82\xAC", "other UTF-8 is unchanged");
+    EXPECT(CharMask("abc", 3) == 7, "letter bits");
+    EXPECT((CharMask("a1.b", 4) & CharMask("ab", 2)) == CharMask("ab", 2), "mask subset");
+}
+
+void TestMaskFilter() {
+    std::mt19937_64 rng(42);
+    for (uint32_t count : {0u, 1u, 7u, 8u, 9u, 1003u}) {
+        std::vector<uint64_t> masks(count);
+        for (auto& mask : masks) {
+            mask = rng() & rng();
+        }
+        for (int trial = 0; trial < 20; trial++) {
+            uint64_t need = rng() & rng() & rng() & rng();
+            std::vector<uint32_t> simd, scalar, expected;
+            FilterByMask(masks.data(), count, need, &simd, MatchKernel::Auto);
+            FilterByMask(masks.data(), count, need, &scalar, MatchKernel::Scalar);
+            for (uint32_t i = 0; i < count; i++) {
+                if ((masks[i] & need) == need) {
+                    expected.push_back(i);
+                }
+            }
+            EXPECT(simd == expected && scalar == expected, "mask filter, %u masks", count);
+        }
+    }
+}
+
+void TestRanking() {
+    const std::vector<std::string> names = {
+        "washer parts.txt",   // 0
+        "Shelf Report.pdf",   // 1
+        "a_b_c.txt",          // 2
+        "abc.txt",            // 3
+        "prepare.doc",        // 4
+        "report.pdf",         // 5
+        "quarterlyReport.xlsx", // 6
+        "carpet.txt",         // 7
+        "IMG_2041.HEIC",      // 8
+        "Caf\xC3\xA9 Menu.pdf", // 9
+        "same-b",             // 10
+        "same-a",             // 11
+        "same",               // 12
+    };
+    NameIndex index;
+    for (const auto& name : names) {
+        index.Append(name);
+    }
+    EXPECT(index.Size() == names.size(), "size");
+
+    auto ranked = Search(index, names, "shrp");
+    EXPECT(ranked.size() == 2 && ranked[0] == "Shelf Report.pdf", "boundaries beat scattered letters");
+
+    ranked = Search(index, names, "abc");
+    EXPECT(ranked.size() == 2 && ranked[0] == "abc.txt", "a run beats separated boundaries");
+
+    ranked = Search(index, names, "rep");
+    EXPECT(ranked.size() >= 3 && ranked[0] == "report.pdf", "prefix first: %s", ranked.empty() ? "" : ranked[0].c_str());
+    EXPECT(ranked.back() == "prepare.doc", "match inside a word last");
+
+    ranked = Search(index, names, "rpt");
+    auto position = [&](const char* name) { return std::find(ranked.begin(), ranked.end(), name) - ranked.begin(); };
+    EXPECT(position("quarterlyReport.xlsx") < position("carpet.txt"), "camelCase hump beats mid-word");
+
+    ranked = Search(index, names, "img2041");
+    EXPECT(ranked.size() == 1 && ranked[0] == "IMG_2041.HEIC", "case-insensitive with digits");
+
+    ranked = Search(index, names, "CAF\xC3\x89");
+    EXPECT(ranked.size() == 1 && ranked[0] == "Caf\xC3\xA9 Menu.pdf", "latin-1 query folded");
+
+    ranked = Search(index, names, "same");
+    EXPECT(ranked.size() == 3 && ranked[0] == "same" && ranked[1] == "same-b" && ranked[2] == "same-a",
+           "ties: shorter first, then index order");
+
+    EXPECT(Search(index, names, "zzz").empty(), "no match");
+
+    NameSearchResult result;
+    index.Search("", 5, &result);
+    EXPECT(result.total == names.size() && result.indices.size() == 5 && result.indices[4] == 4,
+           "empty query lists names in order");
+    index.Search("t", 2, &result);
+    EXPECT(result.indices.size() == 2 && result.total > 2, "limit keeps the total");
+}
+
+std::string RandomName(std::mt19937& rng) {
+    static const char* words[] = {"shelf", "report", "Final", "draft", "IMG", "photo", "invoice", "Budget",
+                                  "notes", "scan", "summary", "q3", "v2", "copy", "export", "backup"};
+    static const char* extensions[] = {".pdf", ".jpg", ".txt", ".xlsx", ".png", ".docx"};
+    std::string name;
+    int parts = 1 + rng() % 4;
+    for (int i = 0; i < parts; i++) {
+        if (i > 0) name += "_- ."[rng() % 4];
+        name += words[rng() % 16];
+    }
+    name += std::to_string(rng() % 1000);
+    name += extensions[rng() % 6];
+    return name;
+}
+
+void ExpectSameAsFresh(NameIndex& index, const std::vector<std::string>& names, const std::string& query,
+                       bool expectNarrowed) {
+    NameSearchResult narrowed, fresh;
+    index.Search(query, 0, &narrowed);
+
+    NameIndex reference(MatchKernel::Scalar);
+    for (const auto& name : names) {
+        reference.Append(name);
+    }
+    reference.Search(query, 0, &fresh);
+
+    EXPECT(narrowed.narrowed == expectNarrowed, "'%s' narrowed=%d", query.c_str(), narrowed.narrowed);
+    EXPECT(narrowed.indices == fresh.indices && narrowed.scores == fresh.scores,
+           "'%s': %zu results vs %zu from a fresh scan", query.c_str(), narrowed.indices.size(),
+           fresh.indices.size());
+    if (expectNarrowed && names.size() > 1000) {
+        EXPECT(narrowed.scanned < names.size(), "'%s' scanned %u of %zu", query.c_str(), narrowed.scanned,
+               names.size());
+    }
+}
+
+void TestNarrowing() {
+    std::mt19937 rng(7);
+    std::vector<std::string> names;
+    NameIndex index;
+    for (int i = 0; i < 20000; i++) {
+        names.push_back(RandomName(rng));
+        index.Append(names.back());
+    }
+
+    ExpectSameAsFresh(index, names, "s", false);
+    ExpectSameAsFresh(index, names, "sh", true);
+    ExpectSameAsFresh(index, names, "shf", true);
+
+    // Names appended between keystrokes are scanned too
+    for (int i = 0; i < 500; i++) {
+        names.push_back(RandomName(rng));
+        index.Append(names.back());
+    }
+    names.push_back("SHELF final.pdf");
+    index.Append(names.back());
+    ExpectSameAsFresh(index, names, "shfi", true);
+
+    // Inserting a character keeps the old query a subsequence
+    ExpectSameAsFresh(index, names, "shefi", true);
+
+    // Backspace, or any query that does not contain the last one, rescans
+    ExpectSameAsFresh(index, names, "shef", false);
+    ExpectSameAsFresh(index, names, "rpt", false);
+
+    // An empty query forgets the previous one
+    NameSearchResult result;
+    index.Search("", 10, &result);
+    ExpectSameAsFresh(index, names, "rpt", false);
+
+    index.Clear();
+    names.clear();
+    index.Search("r", 0, &result);
+    EXPECT(index.Size() == 0 && result.total == 0 && !result.narrowed, "cleared");
+    names.push_back("report.pdf");
+    index.Append(names.back());
+    ExpectSameAsFresh(index, names, "rp", true);
+}
+
+} // namespace
+
+int main() {
+    TestFolding();
+    TestMaskFilter();
+    TestRanking();
+    TestNarrowing();
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file napi_test_shim.cc
+ * @brief Queue-backed threadsafe functions for Linux test executables
+ *
+ * See napi_test_shim.h.
+ */
+
+#include "napi_test_shim.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace {
+
+struct Function {
+    napi_threadsafe_function_call_js callJs;
+    void* context;
+    napi_finalize finalizeCb;
+    void* finalizeData;
+    size_t threads;
+    bool closing = false;
+};
+
+struct Call {
+    Function* function;
+    void* data;
+    bool finalize;
+};
+
+struct JsThread {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Call> queue;
+    uint64_t liveFunctions = 0;
+    bool stopping = false;
+};
+
+JsThread& Loop() {
+    static JsThread loop;
+    return loop;
+}
+
+int g_env;
+
+} // namespace
+
+namespace NapiTestShim {
+
+napi_env Env() {
+    return reinterpret_cast<napi_env>(&g_env);
+}
+
+void RunJsThread() {
+    JsThread& loop = Loop();
+    std::unique_lock<std::mutex> lock(loop.mutex);
+    for (;;) {
+        loop.cv.wait(lock, [&] { return !loop.queue.empty() || loop.stopping; });
+        if (loop.queue.empty()) {
+            return;
+        }
+        Call call = loop.queue.front();
+        loop.queue.pop_front();
+        lock.unlock();
+
+        if (call.finalize) {
+            if (call.function->finalizeCb) {
+                call.function->finalizeCb(Env(), call.function->finalizeData, call.function->context);
+            }
+            delete call.function;
+        } else {
+            call.function->callJs(Env(), nullptr, call.function->context, call.data);
+        }
+
+        lock.lock();
+        if (call.finalize) {
+            loop.liveFunctions--;
+        }
+    }
+}
+
+void StopJsThread() {
+    {
+        std::lock_guard<std::mutex> lock(Loop().mutex);
+        Loop().stopping = true;
+    }
+    Loop().cv.notify_all();
+}
+
+uint64_t PendingCalls() {
+    std::lock_guard<std::mutex> lock(Loop().mutex);
+    return Loop().queue.size();
+}
+
+uint64_t LiveFunctions() {
+    std::lock_guard<std::mutex> lock(Loop().mutex);
+    return Loop().liveFunctions;
+}
+
+} // namespace NapiTestShim
+
+napi_status napi_create_string_utf8(napi_env, const char*, size_t, napi_value* result) {
+    *result = nullptr;
+    return napi_ok;
+}
+
+napi_status napi_create_threadsafe_function(napi_env, napi_value, napi_value, napi_value, size_t,
+                                            size_t initial_thread_count, void* thread_finalize_data,
+                                            napi_finalize thread_finalize_cb, void* context,
+                                            napi_threadsafe_function_call_js call_js_cb,
+                                            napi_threadsafe_function* result) {
+    if (call_js_cb == nullptr || initial_thread_count == 0) {
+        return napi_invalid_arg;
+    }
+    auto* function = new Function{call_js_cb, context, thread_finalize_cb, thread_finalize_data,
+                                  initial_thread_count};
+    {
+        std::lock_guard<std::mutex> lock(Loop().mutex);
+        Loop().liveFunctions++;
+    }
+    *result = reinterpret_cast<napi_threadsafe_function>(function);
+    return napi_ok;
+}
+
+napi_status napi_call_threadsafe_function(napi_threadsafe_function func, void* data,
+                                          napi_threadsafe_function_call_mode) {
+    auto* function = reinterpret_cast<Function*>(func);
+    JsThread& loop = Loop();
+    {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (function->closing) {
+            return napi_closing;
+        }
+        loop.queue.push_back({function, data, false});
+    }
+    loop.cv.notify_one();
+    return napi_ok;
+}
+
+napi_status napi_release_threadsafe_function(napi_threadsafe_function func,
+                                             napi_threadsafe_function_release_mode mode) {
+    auto* function = reinterpret_cast<Function*>(func);
+    JsThread& loop = Loop();
+    {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (function->threads == 0) {
+            return napi_invalid_arg;
+        }
+        if (mode == napi_tsfn_abort) {
+            function->closing = true;
+        }
+        // Like Node, calls already queued run before the finalizer
+        if (--function->threads == 0) {
+            function->closing = true;
+            loop.queue.push_back({function, nullptr, true});
+        }
+    }
+    loop.cv.notify_one();
+    return napi_ok;
+}
+
+napi_status napi_ref_threadsafe_function(napi_env, napi_threadsafe_function) {
+    return napi_ok;
+}
+
+napi_status napi_unref_threadsafe_function(napi_env, napi_threadsafe_function) {
+    return napi_ok;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file napi_test_shim.h
+ * @brief Stand-in for Node's threadsafe functions in Linux test executables
+ *
+ * Test executables are not loaded by Node, so the napi_* symbols that
+ * common/napi_smart_ptr.h calls are not there to link against.
+ * napi_test_shim.cc defines the few a BatchedDispatcher needs
+ * (napi_create_threadsafe_function, napi_call_threadsafe_function, ...)
+ * on top of a queue. A thread of the test plays the JS thread by calling
+ * RunJsThread(), which invokes the call_js callbacks in order, the way
+ * libuv would. The env handed to them is a dummy, and js_callback is null,
+ * so drain handlers under test must not call into N-API themselves.
+ */
+
+#ifndef NATIVE_TEST_NAPI_TEST_SHIM_H
+#define NATIVE_TEST_NAPI_TEST_SHIM_H
+
+#include <cstdint>
+
+#include <node_api.h>
+
+namespace NapiTestShim {
+
+// Non-null env to pass to code under test
+napi_env Env();
+
+// Run queued calls until StopJsThread() and an empty queue
+void RunJsThread();
+void StopJsThread();
+
+// Calls queued but not yet run, and threadsafe functions not yet finalized
+uint64_t PendingCalls();
+uint64_t LiveFunctions();
+
+} // namespace NapiTestShim
+
+#endif // NATIVE_TEST_NAPI_TEST_SHIM_H
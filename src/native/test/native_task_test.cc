@@ -0,0 +1,235 @@
+/**
+ * @file native_task_test.cc
+ * @brief Functional test for the coroutine tasks in native_task.h
+ *
+ * Chains Task<T>s and checks that values and exceptions reach the awaiter,
+ * that ResumeOn moves the coroutine onto a pool worker, and that Completion
+ * works whether the callback runs inline or later on another thread. Then
+ * pulls an AsyncGenerator: values arrive in order, the producer never runs
+ * more than one co_yield ahead of the consumer, an exception ends the
+ * stream with its error, and destroying a generator that is suspended
+ * mid-stream runs the destructors of its locals.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "native_task.h"
+#include "test_support.h"
+
+using FileCataloger::AsyncGenerator;
+using FileCataloger::BlockOn;
+using FileCataloger::Completion;
+using FileCataloger::ResumeOn;
+using FileCataloger::Task;
+using FileCataloger::WorkStealingPool;
+
+namespace {
+
+Task<int> Square(int value) {
+    co_return value * value;
+}
+
+Task<int> SumOfSquares(int count) {
+    int sum = 0;
+    for (int i = 1; i <= count; i++) {
+        sum += co_await Square(i);
+    }
+    co_return sum;
+}
+
+Task<int> Fails() {
+    throw std::runtime_error("expected failure");
+    co_return 0;
+}
+
+Task<std::string> CatchesFailure() {
+    try {
+        co_await Fails();
+    } catch (const std::runtime_error& e) {
+        co_return std::string("caught ") + e.what();
+    }
+    co_return "not thrown";
+}
+
+void TestChaining(WorkStealingPool& pool) {
+    std::printf("chaining\n");
+    EXPECT(BlockOn(pool, SumOfSquares(10)) == 385, "sum of squares");
+    EXPECT(BlockOn(pool, CatchesFailure()) == "caught expected failure", "exception reaches the awaiter");
+
+    bool thrown = false;
+    try {
+        BlockOn(pool, Fails());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    EXPECT(thrown, "BlockOn rethrows");
+}
+
+void TestResumeOn(WorkStealingPool& pool) {
+    std::printf("resume on\n");
+    std::thread::id caller = std::this_thread::get_id();
+    auto where = [](WorkStealingPool& pool) -> Task<std::thread::id> {
+        co_await ResumeOn(pool);
+        co_return std::this_thread::get_id();
+    };
+    EXPECT(BlockOn(pool, where(pool)) != caller, "task ran on the calling thread");
+}
+
+void TestCompletion(WorkStealingPool& pool) {
+    std::printf("completion\n");
+    auto inline_completion = []() -> Task<int> {
+        int value = co_await Completion<int>([](Completion<int>::Complete complete) { complete(7); });
+        co_return value + 1;
+    };
+    EXPECT(BlockOn(pool, inline_completion()) == 8, "inline completion");
+
+    // Completed later from a thread the task knows nothing about
+    auto threaded = []() -> Task<std::thread::id> {
+        std::thread::id from = co_await Completion<std::thread::id>(
+            [](Completion<std::thread::id>::Complete complete) {
+                std::thread([complete] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    complete(std::this_thread::get_id());
+                }).detach();
+            });
+        EXPECT(from == std::this_thread::get_id(), "not resumed on the completing thread");
+        co_return from;
+    };
+    for (int i = 0; i < 50; i++) {
+        BlockOn(pool, threaded());
+    }
+
+    // Completed on a pool worker, racing the suspension
+    auto racing = [](WorkStealingPool& pool, int value) -> Task<int> {
+        int result = co_await Completion<int>([&pool, value](Completion<int>::Complete complete) {
+            pool.Submit([complete, value] { complete(value); });
+        });
+        co_return result;
+    };
+    int mismatches = 0;
+    for (int i = 0; i < 2000; i++) {
+        if (BlockOn(pool, racing(pool, i)) != i) {
+            mismatches++;
+        }
+    }
+    EXPECT(mismatches == 0, "%d racing completions returned the wrong value", mismatches);
+}
+
+// Pulls one value, blocking until the generator's callback has run
+class Puller {
+public:
+    explicit Puller(WorkStealingPool& pool) : pool_(pool) {}
+
+    template<typename T>
+    std::optional<T> Next(AsyncGenerator<T>& generator, std::exception_ptr* error = nullptr) {
+        std::optional<T> result;
+        bool ready = false;
+        generator.Next(pool_, [&](std::optional<T> value, std::exception_ptr failure) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result = std::move(value);
+            if (error) {
+                *error = failure;
+            }
+            ready = true;
+            cv_.notify_one();
+        });
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return ready; });
+        return result;
+    }
+
+private:
+    WorkStealingPool& pool_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+struct Guard {
+    std::atomic<int>* destroyed;
+    ~Guard() { destroyed->fetch_add(1); }
+};
+
+AsyncGenerator<int> Count(int limit, std::atomic<int>* produced, std::atomic<int>* destroyed) {
+    Guard guard{destroyed};
+    for (int i = 0; i < limit; i++) {
+        produced->fetch_add(1);
+        co_yield co_await Square(i);
+    }
+}
+
+AsyncGenerator<int> FailsAfter(int count) {
+    for (int i = 0; i < count; i++) {
+        co_yield i;
+    }
+    throw std::runtime_error("producer failed");
+}
+
+void TestGenerator(WorkStealingPool& pool) {
+    std::printf("async generator\n");
+    Puller puller(pool);
+    std::atomic<int> produced{0};
+    std::atomic<int> destroyed{0};
+
+    {
+        AsyncGenerator<int> squares = Count(5, &produced, &destroyed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        EXPECT(produced == 0, "generator started before the first Next()");
+
+        std::vector<int> values;
+        while (std::optional<int> value = puller.Next(squares)) {
+            values.push_back(*value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            EXPECT(produced == static_cast<int>(values.size()), "producer ran ahead: %d produced, %zu consumed",
+                   produced.load(), values.size());
+        }
+        EXPECT(values == (std::vector<int>{0, 1, 4, 9, 16}), "values out of order");
+        EXPECT(squares.Done(), "not done after the last value");
+        EXPECT(!puller.Next(squares), "value after the end");
+        EXPECT(destroyed == 1, "locals not destroyed at the end");
+    }
+
+    // Destroyed while suspended at a co_yield
+    produced = 0;
+    destroyed = 0;
+    {
+        AsyncGenerator<int> squares = Count(1000, &produced, &destroyed);
+        puller.Next(squares);
+        puller.Next(squares);
+        EXPECT(destroyed == 0, "locals destroyed too early");
+    }
+    EXPECT(produced == 2, "%d values produced for 2 pulls", produced.load());
+    EXPECT(destroyed == 1, "locals not destroyed with the generator");
+
+    AsyncGenerator<int> failing = FailsAfter(2);
+    std::exception_ptr error;
+    EXPECT(puller.Next(failing, &error) == 0 && !error, "first value");
+    EXPECT(puller.Next(failing, &error) == 1 && !error, "second value");
+    EXPECT(!puller.Next(failing, &error) && error, "error not reported");
+    EXPECT(failing.Done(), "not done after the error");
+}
+
+} // namespace
+
+int main() {
+    WorkStealingPool pool(4);
+
+    TestChaining(pool);
+    TestResumeOn(pool);
+    TestCompletion(pool);
+    TestGenerator(pool);
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
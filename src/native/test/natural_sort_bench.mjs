@@ -0,0 +1,139 @@
+/**
+ * @fileoverview Benchmark: native natural sort vs JavaScript comparators
+ *
+ * Generates NAMES synthetic file names (camera-style counters, dated
+ * reports, versioned drafts) and times sorting them in natural order with:
+ *   - the native module: collation keys + radix sort, including passing the
+ *     names in and the order back
+ *   - Array.prototype.sort with a comparator that parses digit runs on every
+ *     comparison (the same rules, in JavaScript)
+ *   - Array.prototype.sort with Intl.Collator({ numeric: true }).compare
+ *   - Array.prototype.sort with localeCompare(..., { numeric: true }), as
+ *     the renderer's file tree does (on at most LOCALE_NAMES names; it is slow)
+ *
+ * Usage (from src/native):
+ *   npm run bench:shelf-search
+ *   NAMES=100000 RUNS=5 node test/natural_sort_bench.mjs
+ */
+
+import { createRequire } from 'module';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const require = createRequire(import.meta.url);
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const NAMES = Number(process.env.NAMES || 1000000);
+const RUNS = Number(process.env.RUNS || 3);
+const LOCALE_NAMES = Math.min(NAMES, Number(process.env.LOCALE_NAMES || 100000));
+
+const native = require(
+  path.join(__dirname, '..', 'shelf-search', 'build', 'Release', `shelf_search_${process.platform}.node`)
+);
+
+function makeNames(count) {
+  let seed = 0x2545f491;
+  const random = n => {
+    seed ^= seed << 13;
+    seed ^= seed >>> 17;
+    seed ^= seed << 5;
+    return (seed >>> 0) % n;
+  };
+  const prefixes = ['IMG_', 'DSC', 'Screenshot ', 'scan-', 'Report ', 'draft v', 'Invoice #', 'photo'];
+  const extensions = ['.jpg', '.HEIC', '.png', '.pdf', '.docx'];
+  const names = [];
+  for (let i = 0; i < count; i++) {
+    const prefix = prefixes[random(prefixes.length)];
+    let name;
+    if (prefix === 'Report ') {
+      name = `${prefix}${2015 + random(11)}-${1 + random(12)}-${1 + random(28)}`;
+    } else if (prefix === 'draft v') {
+      name = `${prefix}${random(20)}.${random(12)} final`;
+    } else {
+      name = `${prefix}${random(100000)}`;
+    }
+    names.push(name + extensions[random(extensions.length)]);
+  }
+  return names;
+}
+
+const isDigit = code => code >= 48 && code <= 57;
+
+// Parses digit runs on every comparison; same rules as the native keys
+function compareNatural(a, b) {
+  a = a.toLowerCase();
+  b = b.toLowerCase();
+  let i = 0;
+  let j = 0;
+  while (i < a.length && j < b.length) {
+    const x = a.charCodeAt(i);
+    const y = b.charCodeAt(j);
+    if (isDigit(x) && isDigit(y)) {
+      while (a.charCodeAt(i) === 48) i++;
+      while (b.charCodeAt(j) === 48) j++;
+      const xStart = i;
+      const yStart = j;
+      while (i < a.length && isDigit(a.charCodeAt(i))) i++;
+      while (j < b.length && isDigit(b.charCodeAt(j))) j++;
+      if (i - xStart !== j - yStart) return i - xStart - (j - yStart);
+      const xDigits = a.slice(xStart, i);
+      const yDigits = b.slice(yStart, j);
+      if (xDigits !== yDigits) return xDigits < yDigits ? -1 : 1;
+      continue;
+    }
+    const xByte = isDigit(x) ? 48 : x;
+    const yByte = isDigit(y) ? 48 : y;
+    if (xByte !== yByte) return xByte - yByte;
+    i++;
+    j++;
+  }
+  return a.length - i - (b.length - j);
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function bench(name, count, fn) {
+  const times = [];
+  let result;
+  for (let i = 0; i < RUNS; i++) {
+    const start = process.hrtime.bigint();
+    result = fn();
+    times.push(Number(process.hrtime.bigint() - start) / 1e6);
+  }
+  const ms = median(times);
+  console.log(
+    `${name.padEnd(40)} ${String(count).padStart(8)} names  ${ms.toFixed(1).padStart(9)} ms  ` +
+      `${Math.round(count / (ms / 1000)).toLocaleString()} names/s`
+  );
+  return { ms, result };
+}
+
+const names = makeNames(NAMES);
+console.log(`\nNode ${process.version}, ${os.cpus().length} CPUs, median of ${RUNS} runs\n`);
+
+const nativeRun = bench('native keys + radix sort', NAMES, () => native.naturalSort(names));
+const parsing = bench('JS sort, parsing comparator', NAMES, () => {
+  const order = Array.from(names, (_, index) => index);
+  return order.sort((a, b) => compareNatural(names[a], names[b]) || a - b);
+});
+const collator = new Intl.Collator(undefined, { numeric: true, sensitivity: 'base' });
+const intl = bench('JS sort, Intl.Collator numeric', NAMES, () => [...names].sort(collator.compare));
+
+const subset = names.slice(0, LOCALE_NAMES);
+const nativeSubset = bench('native keys + radix sort', LOCALE_NAMES, () => native.naturalSort(subset));
+const locale = bench('JS sort, localeCompare numeric', LOCALE_NAMES, () =>
+  [...subset].sort((a, b) => a.localeCompare(b, undefined, { numeric: true }))
+);
+
+// Same rules, so the native order must equal the stable JS sort
+const nativeOrder = nativeRun.result;
+const mismatch = parsing.result.findIndex((index, position) => index !== nativeOrder[position]);
+console.log(mismatch < 0 ? '\nnative order matches the JS comparator' : `\nMISMATCH at position ${mismatch}`);
+
+console.log(`speedup vs parsing comparator: ${(parsing.ms / nativeRun.ms).toFixed(1)}x`);
+console.log(`speedup vs Intl.Collator:      ${(intl.ms / nativeRun.ms).toFixed(1)}x`);
+console.log(`speedup vs localeCompare:      ${(locale.ms / nativeSubset.ms).toFixed(1)}x (${LOCALE_NAMES} names)`);
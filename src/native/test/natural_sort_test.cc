@@ -0,0 +1,158 @@
+/**
+ * @file natural_sort_test.cc
+ * @brief Functional test for natural-order collation keys
+ *
+ * Checks a hand-written expected order (numbers by value, case folding,
+ * leading zeros, digits between punctuation and letters, very long digit
+ * runs), that comparing keys agrees with the parsing comparator, and that
+ * the radix sort matches std::stable_sort with that comparator on a large
+ * random corpus, including stability for equal keys.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "natural_sort.h"
+#include "test_support.h"
+
+using FileCataloger::CollationKeys;
+using FileCataloger::CompareNatural;
+
+namespace {
+
+int Sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+int Compare(const std::string& a, const std::string& b) {
+    return Sign(CompareNatural(a.data(), a.size(), b.data(), b.size()));
+}
+
+std::vector<std::string> Sorted(const std::vector<std::string>& names) {
+    CollationKeys keys;
+    for (const auto& name : names) {
+        keys.Append(name);
+    }
+    std::vector<uint32_t> order;
+    keys.Sort(&order);
+    std::vector<std::string> sorted;
+    for (uint32_t index : order) {
+        sorted.push_back(names[index]);
+    }
+    return sorted;
+}
+
+void TestExpectedOrder() {
+    const std::vector<std::string> expected = {
+        "",
+        "a.txt",
+        "a1.txt",
+        "a01.txt",  // equal to a1.txt, after it in the input
+        "a2.txt",
+        "a10.txt",
+        "a10b",
+        "a10b2",
+        "a10b10",
+        "a100.txt",
+        "A_1.txt",
+        "ab.txt",
+        "img 2",
+        "IMG2.jpg",
+        "img10.jpg",
+        "img0000000000000000000000000000011.jpg",  // beyond 64-bit values
+        "Report 2024-02-01.pdf",
+        "Report 2024-10-01.pdf",
+        "report 2025-01-15.pdf",
+        "\xC3\x89t\xC3\xA9 3",  // Été 3: folded, then byte order
+        "\xC3\xA9t\xC3\xA9 20",
+    };
+    std::vector<std::string> input = expected;
+    std::reverse(input.begin(), input.end());
+    // Equal keys keep input order, so put a1.txt ahead of a01.txt again
+    std::iter_swap(std::find(input.begin(), input.end(), "a1.txt"),
+                   std::find(input.begin(), input.end(), "a01.txt"));
+
+    std::vector<std::string> sorted = Sorted(input);
+    EXPECT(sorted == expected, "expected order");
+    for (size_t i = 0; i < sorted.size() && sorted != expected; i++) {
+        if (sorted[i] != expected[i]) {
+            std::fprintf(stderr, "  %zu: got '%s', expected '%s'\n", i, sorted[i].c_str(), expected[i].c_str());
+        }
+    }
+
+    EXPECT(Compare("img2", "img10") < 0, "img2 < img10");
+    EXPECT(Compare("IMG007", "img7") == 0, "case and leading zeros ignored");
+    EXPECT(Compare("x9", "x") > 0, "longer after prefix");
+}
+
+void TestLongRuns() {
+    std::string a = "n" + std::string(300, '9');
+    std::string b = "n1" + std::string(300, '0');
+    std::string c = "n" + std::string(254, '9');
+    EXPECT(Compare(c, a) < 0 && Compare(a, b) < 0, "runs of 255+ digits");
+    EXPECT((Sorted({b, a, c}) == std::vector<std::string>{c, a, b}), "runs of 255+ digits sorted");
+}
+
+std::string RandomName(std::mt19937& rng) {
+    static const char* words[] = {"img", "IMG", "report", "Scan", "a", "b", "v", "final", "copy", "_", " ", ".", "-"};
+    static const char* extensions[] = {"", ".jpg", ".pdf", ".txt", ".tar.gz"};
+    std::string name;
+    int parts = rng() % 5;
+    for (int i = 0; i < parts; i++) {
+        name += words[rng() % 13];
+        if (rng() % 2) {
+            int zeros = rng() % 8 == 0 ? rng() % 3 : 0;
+            name += std::string(zeros, '0') + std::to_string(rng() % (rng() % 2 ? 20 : 100000));
+        }
+    }
+    return name + extensions[rng() % 5];
+}
+
+void TestAgainstComparator() {
+    std::mt19937 rng(11);
+    // Sizes around the insertion sort threshold and a large corpus
+    for (int count : {0, 1, 2, 31, 32, 33, 500, 50000}) {
+        std::vector<std::string> names;
+        CollationKeys keys;
+        for (int i = 0; i < count; i++) {
+            names.push_back(RandomName(rng));
+            keys.Append(names.back());
+        }
+
+        std::vector<uint32_t> expected(count);
+        for (int i = 0; i < count; i++) {
+            expected[i] = i;
+        }
+        std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) {
+            return Compare(names[a], names[b]) < 0;
+        });
+        std::vector<uint32_t> order;
+        keys.Sort(&order);
+        EXPECT(order == expected, "radix sort matches stable_sort, %d names", count);
+
+        int mismatches = 0;
+        for (int i = 0; i + 1 < count && i < 2000; i++) {
+            if (Sign(keys.Compare(i, i + 1)) != Compare(names[i], names[i + 1])) {
+                mismatches++;
+            }
+        }
+        EXPECT(mismatches == 0, "key comparison agrees with the comparator, %d names", count);
+    }
+}
+
+} // namespace
+
+int main() {
+    TestExpectedOrder();
+    TestLongRuns();
+    TestAgainstComparator();
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file perf_counters.h
+ * @brief Hardware performance counters for the Linux benchmarks
+ *
+ * PerfCounters opens one perf_event_open counter per Event for the whole
+ * process: the calling thread and, through inherit, every thread it starts
+ * afterwards. Open it at the top of main(), before the JS thread and the
+ * modules' own threads exist, then Read() around each scenario and take
+ * the Delta().
+ *
+ * Hardware counters are user space only (exclude_kernel), which is all
+ * that perf_event_paranoid 2, the default on most distributions, allows,
+ * and what the code under test controls. Context switches happen in the
+ * kernel, so that software counter has to include it; where that is not
+ * permitted they are read from getrusage() instead (voluntary plus
+ * involuntary, all threads of the process).
+ *
+ * Any counter may be unavailable: virtual machines often expose no PMU
+ * (ENOENT), perf_event_paranoid 3 or a container's seccomp profile refuses
+ * the syscall (EACCES, EPERM, ENOSYS), and some CPUs lack an event.
+ * Unavailable hardware counters are reported by Describe() and read as
+ * invalid, so a bench prints n/a for them and measures everything else.
+ * When the PMU has fewer registers than counters the kernel multiplexes
+ * them; values are scaled by the time each counter actually ran, and a
+ * counter that never ran during a scenario is invalid for it.
+ */
+
+#ifndef NATIVE_TEST_PERF_COUNTERS_H
+#define NATIVE_TEST_PERF_COUNTERS_H
+
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace PerfCounters {
+
+enum class Event {
+    Cycles,
+    Instructions,
+    L1dMisses,        // L1 data cache read misses
+    LlcMisses,        // last level cache misses
+    BranchMisses,
+    ContextSwitches,
+    Count
+};
+
+constexpr size_t kEventCount = static_cast<size_t>(Event::Count);
+
+inline const char* EventName(Event event) {
+    switch (event) {
+        case Event::Cycles: return "cycles";
+        case Event::Instructions: return "instructions";
+        case Event::L1dMisses: return "L1d misses";
+        case Event::LlcMisses: return "LLC misses";
+        case Event::BranchMisses: return "branch misses";
+        case Event::ContextSwitches: return "context switches";
+        default: return "?";
+    }
+}
+
+// Raw counts with the kernel's enabled/running times, for scaling
+struct Reading {
+    uint64_t value[kEventCount] = {};
+    uint64_t enabled[kEventCount] = {};
+    uint64_t running[kEventCount] = {};
+    bool valid[kEventCount] = {};
+};
+
+// Counts between two readings, scaled for multiplexing
+struct Counts {
+    double value[kEventCount] = {};
+    bool valid[kEventCount] = {};
+
+    bool Has(Event event) const { return valid[static_cast<size_t>(event)]; }
+    double Of(Event event) const { return value[static_cast<size_t>(event)]; }
+};
+
+class Group {
+public:
+    Group() {
+        for (size_t i = 0; i < kEventCount; i++) {
+            fds_[i] = Open(static_cast<Event>(i), errors_[i]);
+        }
+        rusageSwitches_ = fds_[kSwitches] < 0;
+    }
+
+    ~Group() {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    Group(const Group&) = delete;
+    Group& operator=(const Group&) = delete;
+
+    bool Available(Event event) const {
+        size_t i = static_cast<size_t>(event);
+        return fds_[i] >= 0 || (i == kSwitches && rusageSwitches_);
+    }
+
+    // Hardware counters; context switches are always available
+    bool AnyHardware() const {
+        for (size_t i = 0; i < kEventCount; i++) {
+            if (i != kSwitches && fds_[i] >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // One line per unavailable counter with the reason; empty when all opened
+    std::string Describe() const {
+        std::string text;
+        for (size_t i = 0; i < kEventCount; i++) {
+            if (fds_[i] < 0) {
+                text += std::string("  ") + EventName(static_cast<Event>(i)) + ": " + Reason(errors_[i]) +
+                        (i == kSwitches ? "; counted with getrusage()" : "") + "\n";
+            }
+        }
+        return text;
+    }
+
+    Reading Read() const {
+        Reading reading;
+        for (size_t i = 0; i < kEventCount; i++) {
+            if (fds_[i] < 0) {
+                continue;
+            }
+            uint64_t data[3] = {};
+            if (read(fds_[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data))) {
+                reading.value[i] = data[0];
+                reading.enabled[i] = data[1];
+                reading.running[i] = data[2];
+                reading.valid[i] = true;
+            }
+        }
+        if (rusageSwitches_) {
+            rusage usage = {};
+            getrusage(RUSAGE_SELF, &usage);
+            uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+            reading.value[kSwitches] = static_cast<uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw);
+            reading.enabled[kSwitches] = now;
+            reading.running[kSwitches] = now;
+            reading.valid[kSwitches] = true;
+        }
+        return reading;
+    }
+
+private:
+    static constexpr size_t kSwitches = static_cast<size_t>(Event::ContextSwitches);
+
+    static int Open(Event event, int& error) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (event) {
+            case Event::Cycles:
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case Event::Instructions:
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case Event::L1dMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case Event::LlcMisses:
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case Event::BranchMisses:
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case Event::ContextSwitches:
+                attr.type = PERF_TYPE_SOFTWARE;
+                attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+                break;
+            default:
+                error = EINVAL;
+                return -1;
+        }
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit = 1;
+        attr.exclude_kernel = event != Event::ContextSwitches;
+        attr.exclude_hv = 1;
+
+        // This process, any CPU, no group
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        error = fd < 0 ? errno : 0;
+        return fd;
+    }
+
+    static std::string Reason(int error) {
+        switch (error) {
+            case ENOENT:
+            case EOPNOTSUPP:
+                return "not supported by this CPU or virtual machine";
+            case EACCES:
+            case EPERM: {
+                std::string reason = "not permitted";
+                std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+                int level = 0;
+                if (paranoid >> level) {
+                    reason += " (perf_event_paranoid is " + std::to_string(level) + ", needs 2 or lower)";
+                }
+                return reason;
+            }
+            case ENOSYS:
+                return "perf_event_open is blocked (seccomp or kernel without perf events)";
+            default:
+                return std::strerror(error);
+        }
+    }
+
+    int fds_[kEventCount];
+    int errors_[kEventCount] = {};
+    bool rusageSwitches_ = false;
+};
+
+inline Counts Delta(const Reading& before, const Reading& after) {
+    Counts counts;
+    for (size_t i = 0; i < kEventCount; i++) {
+        if (!before.valid[i] || !after.valid[i]) {
+            continue;
+        }
+        uint64_t running = after.running[i] - before.running[i];
+        if (running == 0) {
+            continue;
+        }
+        uint64_t enabled = after.enabled[i] - before.enabled[i];
+        counts.value[i] = static_cast<double>(after.value[i] - before.value[i]) *
+                          (static_cast<double>(enabled) / static_cast<double>(running));
+        counts.valid[i] = true;
+    }
+    return counts;
+}
+
+} // namespace PerfCounters
+
+#endif // NATIVE_TEST_PERF_COUNTERS_H
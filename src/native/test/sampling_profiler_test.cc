@@ -0,0 +1,318 @@
+/**
+ * @file sampling_profiler_test.cc
+ * @brief Tests for the native sampling profiler on Linux
+ *
+ * Registered threads burn CPU in known functions while another sleeps; a
+ * profile must attribute samples to the burning threads' functions, leave
+ * the sleeping thread out (timers run on each thread's CPU clock), pick up
+ * a thread registered mid-profile, stop early on request, and leave no
+ * timers behind. Before the first profile nothing may be installed.
+ *
+ * Built with frame pointers and -rdynamic so stacks walk through and the
+ * test's own functions symbolize.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sampling_profiler.h"
+#include "test_support.h"
+
+using FileCataloger::ProfileOptions;
+using FileCataloger::ProfileResult;
+using FileCataloger::ProfiledThread;
+using FileCataloger::SamplingProfiler;
+
+static std::atomic<bool> g_stop{false};
+static std::atomic<double> g_sink{0};
+
+// External linkage so dladdr finds them in the dynamic symbol table
+__attribute__((noinline)) double BurnInner(double x) {
+    for (int i = 0; i < 2000; i++) {
+        x = x * 1.0000001 + 0.5;
+    }
+    return x;
+}
+
+__attribute__((noinline)) void BurnAlpha() {
+    double x = 1;
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        x = BurnInner(x);
+    }
+    g_sink = x;
+}
+
+__attribute__((noinline)) void BurnBeta() {
+    double x = 2;
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        x = BurnInner(x) + 1;
+    }
+    g_sink = x;
+}
+
+namespace {
+
+struct Folded {
+    std::map<std::string, uint64_t> byThread;   // samples per thread name
+    std::map<std::string, uint64_t> byFrame;    // samples containing a frame, per "thread:frame"
+    uint64_t total = 0;
+    bool wellFormed = true;
+};
+
+Folded ReadFolded(const std::string& path) {
+    Folded folded;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t space = line.rfind(' ');
+        if (space == std::string::npos) {
+            folded.wellFormed = false;
+            continue;
+        }
+        uint64_t count = std::stoull(line.substr(space + 1));
+        std::string stack = line.substr(0, space);
+        std::string thread = stack.substr(0, stack.find(';'));
+        folded.byThread[thread] += count;
+        folded.total += count;
+
+        size_t start = 0;
+        while (start <= stack.size()) {
+            size_t end = stack.find(';', start);
+            std::string frame = stack.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if (frame.find("BurnAlpha") != std::string::npos) folded.byFrame[thread + ":BurnAlpha"] += count;
+            if (frame.find("BurnBeta") != std::string::npos) folded.byFrame[thread + ":BurnBeta"] += count;
+            if (frame.find("BurnInner") != std::string::npos) folded.byFrame[thread + ":BurnInner"] += count;
+            if (end == std::string::npos) break;
+            start = end + 1;
+        }
+    }
+    return folded;
+}
+
+// Profile synchronously and return the result
+ProfileResult Profile(const ProfileOptions& options, bool* started, std::string* error) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    ProfileResult result;
+    *started = SamplingProfiler::Start(
+        options,
+        [&](const ProfileResult& r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result = r;
+            done = true;
+            cv.notify_one();
+        },
+        error);
+    if (*started) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return done; });
+    }
+    SamplingProfiler::Join();
+    return result;
+}
+
+size_t CountPosixTimers() {
+    std::ifstream in("/proc/self/timers");
+    std::string line;
+    size_t count = 0;
+    while (std::getline(in, line)) {
+        count += line.compare(0, 3, "ID:") == 0;
+    }
+    return count;
+}
+
+void TestNothingInstalledWhileDisabled() {
+    struct sigaction current = {};
+    sigaction(SIGPROF, nullptr, &current);
+    EXPECT(current.sa_handler == SIG_DFL, "no SIGPROF handler before the first profile");
+    EXPECT(!SamplingProfiler::IsRunning(), "not running before Start");
+    EXPECT(CountPosixTimers() == 0, "no timers before the first profile");
+}
+
+void TestInvalidOptions() {
+    std::string error;
+    ProfileOptions options;
+    EXPECT(!SamplingProfiler::Start(options, nullptr, &error), "outputPath is required");
+    options.outputPath = "/tmp/unused.folded";
+    options.hz = 0;
+    EXPECT(!SamplingProfiler::Start(options, nullptr, &error), "hz 0 is rejected");
+    options.hz = 499;
+    options.duration = std::chrono::minutes(5);
+    EXPECT(!SamplingProfiler::Start(options, nullptr, &error), "duration over 60s is rejected");
+}
+
+void TestAttributesSamples(const std::string& dir) {
+    g_stop = false;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    bool wake = false;
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([] {
+        ProfiledThread profiled("alpha");
+        BurnAlpha();
+    });
+    threads.emplace_back([] {
+        ProfiledThread profiled("beta");
+        BurnBeta();
+    });
+    threads.emplace_back([&] {
+        ProfiledThread profiled("sleeper");
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCv.wait(lock, [&] { return wake; });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    ProfileOptions options;
+    options.duration = std::chrono::milliseconds(600);
+    options.hz = 997;
+    options.outputPath = dir + "/profile.folded";
+
+    // A thread that registers while the profile runs is sampled too
+    std::thread late([] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ProfiledThread profiled("late");
+        BurnAlpha();
+    });
+
+    bool started = false;
+    std::string error;
+    auto begin = std::chrono::steady_clock::now();
+    ProfileResult result = Profile(options, &started, &error);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    g_stop = true;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake = true;
+    }
+    sleepCv.notify_all();
+    late.join();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT(started, "profile starts: %s", error.c_str());
+    EXPECT(result.ok, "profile written: %s", result.error.c_str());
+    EXPECT(ms >= 550, "profile runs for its duration (%.0f ms)", ms);
+    EXPECT(result.threads == 4, "four registered threads, got %zu", result.threads);
+
+    Folded folded = ReadFolded(options.outputPath);
+    std::printf("samples=%llu dropped=%llu stacks=%zu alpha=%llu beta=%llu late=%llu sleeper=%llu (%.0f ms)\n",
+                static_cast<unsigned long long>(result.samples), static_cast<unsigned long long>(result.dropped),
+                result.stacks, static_cast<unsigned long long>(folded.byThread["alpha"]),
+                static_cast<unsigned long long>(folded.byThread["beta"]),
+                static_cast<unsigned long long>(folded.byThread["late"]),
+                static_cast<unsigned long long>(folded.byThread["sleeper"]), ms);
+
+    EXPECT(folded.wellFormed, "every line is 'stack count'");
+    EXPECT(folded.total == result.samples, "file holds every sample (%llu vs %llu)",
+           static_cast<unsigned long long>(folded.total), static_cast<unsigned long long>(result.samples));
+    // Three burning threads share however many cores there are
+    EXPECT(folded.byThread["alpha"] >= 20, "alpha sampled");
+    EXPECT(folded.byThread["beta"] >= 20, "beta sampled");
+    EXPECT(folded.byThread["late"] >= 10, "thread registered mid-profile sampled");
+    EXPECT(folded.byThread["sleeper"] == 0, "blocked thread not sampled");
+    EXPECT(folded.byFrame["alpha:BurnAlpha"] * 10 >= folded.byThread["alpha"] * 9,
+           "alpha's stacks walk up to BurnAlpha");
+    EXPECT(folded.byFrame["beta:BurnBeta"] * 10 >= folded.byThread["beta"] * 9,
+           "beta's stacks walk up to BurnBeta");
+    EXPECT(folded.byFrame["alpha:BurnBeta"] == 0 && folded.byFrame["beta:BurnAlpha"] == 0,
+           "samples are attributed to the right thread");
+    EXPECT(folded.byFrame["alpha:BurnInner"] > 0, "leaf function appears");
+    EXPECT(CountPosixTimers() == 0, "timers deleted after the profile");
+}
+
+void TestStopEarlyAndBusy(const std::string& dir) {
+    g_stop = false;
+    std::thread burner([] {
+        ProfiledThread profiled("alpha");
+        BurnAlpha();
+    });
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    ProfileResult result;
+    ProfileOptions options;
+    options.duration = std::chrono::seconds(30);
+    options.outputPath = dir + "/early.folded";
+    std::string error;
+    auto begin = std::chrono::steady_clock::now();
+    bool started = SamplingProfiler::Start(
+        options,
+        [&](const ProfileResult& r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result = r;
+            done = true;
+            cv.notify_one();
+        },
+        &error);
+    EXPECT(started, "long profile starts: %s", error.c_str());
+
+    std::string busy;
+    EXPECT(!SamplingProfiler::Start(options, nullptr, &busy), "second profile is refused");
+    EXPECT(busy == "a profile is already running", "busy error: %s", busy.c_str());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    SamplingProfiler::Stop();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return done; });
+    }
+    SamplingProfiler::Join();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    g_stop = true;
+    burner.join();
+
+    EXPECT(result.ok && result.samples > 0, "stopped profile is still written");
+    EXPECT(ms < 2000, "Stop() ends the profile early (%.0f ms)", ms);
+    EXPECT(!SamplingProfiler::IsRunning(), "not running after Stop");
+    EXPECT(CountPosixTimers() == 0, "timers deleted after Stop");
+}
+
+void TestUnwritablePath() {
+    ProfileOptions options;
+    options.duration = std::chrono::milliseconds(20);
+    options.outputPath = "/nonexistent-dir/profile.folded";
+    bool started = false;
+    std::string error;
+    ProfileResult result = Profile(options, &started, &error);
+    EXPECT(started && !result.ok && !result.error.empty(), "unwritable output reports an error");
+}
+
+} // namespace
+
+int main() {
+    char dirTemplate[] = "/tmp/sampling_profiler_test_XXXXXX";
+    std::string dir = mkdtemp(dirTemplate);
+
+    TestNothingInstalledWhileDisabled();
+    TestInvalidOptions();
+    TestAttributesSamples(dir);
+    TestStopEarlyAndBusy(dir);
+    TestUnwritablePath();
+
+    if (g_failures == 0) std::remove((dir + "/profile.folded").c_str());
+    std::remove((dir + "/early.folded").c_str());
+    rmdir(dir.c_str());
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
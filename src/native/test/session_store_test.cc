@@ -0,0 +1,291 @@
+/**
+ * @file session_store_test.cc
+ * @brief Functional test for the binary session snapshot and delta log
+ *
+ * Checks put, get, delete and key listing across namespaces, that a reopen
+ * replays the log over the snapshot, that a torn log tail and a corrupt
+ * value are contained, that an invalid snapshot is ignored, that puts made
+ * while Compact runs survive it, and that a crash between the snapshot and
+ * log renames loses nothing.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "session_store.h"
+#include "test_support.h"
+
+using FileCataloger::SessionStore;
+using FileCataloger::SessionStoreStats;
+
+namespace {
+
+constexpr uint16_t kRecent = 1;
+constexpr uint16_t kWindows = 2;
+
+std::string Value(const SessionStore& store, uint16_t space, const std::string& key) {
+    std::string value;
+    return store.Get(space, key, &value) ? value : "<missing>";
+}
+
+off_t FileSize(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+std::string ReadAll(const std::string& path) {
+    std::string data;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    char buffer[4096];
+    size_t n;
+    while (file && (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, n);
+    }
+    if (file) {
+        std::fclose(file);
+    }
+    return data;
+}
+
+void WriteAll(const std::string& path, const std::string& data) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file || std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+        std::fprintf(stderr, "cannot write fixture %s\n", path.c_str());
+        std::exit(2);
+    }
+    std::fclose(file);
+}
+
+void Remove(const std::string& path) {
+    unlink(path.c_str());
+    unlink((path + ".log").c_str());
+}
+
+void TestBasics(const std::string& path) {
+    SessionStore store(path);
+    EXPECT(store.Open() == 0, "open a new store");
+    EXPECT(store.Put(kRecent, "/tmp/b.txt", "2") == 0, "put");
+    EXPECT(store.Put(kRecent, "/tmp/a.txt", "1") == 0, "put");
+    EXPECT(store.Put(kWindows, "shelf-1", "bounds") == 0, "put");
+    EXPECT(store.Put(kRecent, "/tmp/b.txt", "3") == 0, "overwrite");
+    EXPECT(Value(store, kRecent, "/tmp/b.txt") == "3", "latest value wins");
+    EXPECT(Value(store, kWindows, "/tmp/a.txt") == "<missing>", "namespaces are separate");
+
+    std::vector<std::string> keys = store.Keys(kRecent);
+    EXPECT(keys.size() == 2 && keys[0] == "/tmp/a.txt" && keys[1] == "/tmp/b.txt", "keys sorted, got %zu",
+           keys.size());
+    EXPECT(store.Delete(kRecent, "/tmp/a.txt") == 0, "delete");
+    EXPECT(Value(store, kRecent, "/tmp/a.txt") == "<missing>", "deleted key gone");
+    EXPECT(store.Keys(kRecent).size() == 1, "deleted key not listed");
+    EXPECT(store.Put(kRecent, std::string(SessionStore::MAX_KEY_BYTES + 1, 'k'), "x") == EINVAL,
+           "oversized key rejected");
+
+    // Merge into a snapshot, then change it through the log
+    EXPECT(store.Compact() == 0, "compact");
+    SessionStoreStats stats = store.Stats();
+    EXPECT(stats.generation == 1 && stats.snapshotRecords == 2 && stats.logRecords == 0,
+           "compacted: generation %llu, %llu records, %llu logged", (unsigned long long)stats.generation,
+           (unsigned long long)stats.snapshotRecords, (unsigned long long)stats.logRecords);
+    EXPECT(store.Put(kRecent, "/tmp/c.txt", "4") == 0, "put after compact");
+    EXPECT(store.Delete(kWindows, "shelf-1") == 0, "delete a snapshot key");
+    keys = store.Keys(kRecent);
+    EXPECT(keys.size() == 2 && keys[1] == "/tmp/c.txt", "keys merge snapshot and log");
+    EXPECT(store.Keys(kWindows).empty(), "snapshot key deleted through the log");
+}
+
+void TestReopen(const std::string& path) {
+    SessionStore store(path);
+    EXPECT(store.Open() == 0, "reopen");
+    EXPECT(Value(store, kRecent, "/tmp/b.txt") == "3", "snapshot value");
+    EXPECT(Value(store, kRecent, "/tmp/c.txt") == "4", "log value replayed");
+    EXPECT(Value(store, kWindows, "shelf-1") == "<missing>", "log delete replayed");
+    EXPECT(store.Stats().logRecords == 2, "two records replayed, got %llu",
+           (unsigned long long)store.Stats().logRecords);
+}
+
+void TestTornLog(const std::string& path) {
+    const std::string logPath = path + ".log";
+    off_t before;
+    {
+        SessionStore store(path);
+        EXPECT(store.Open() == 0, "open");
+        before = FileSize(logPath);
+        EXPECT(store.Put(kRecent, "/tmp/torn.txt", std::string(100, 't')) == 0, "put");
+    }
+    // Crash halfway through the last write
+    EXPECT(truncate(logPath.c_str(), before + 40) == 0, "tear the log");
+
+    SessionStore store(path);
+    EXPECT(store.Open() == 0, "open with a torn tail");
+    EXPECT(Value(store, kRecent, "/tmp/torn.txt") == "<missing>", "torn record dropped");
+    EXPECT(Value(store, kRecent, "/tmp/c.txt") == "4", "records before it kept");
+    EXPECT(FileSize(logPath) == before, "torn tail cut off");
+    EXPECT(store.Put(kRecent, "/tmp/after.txt", "5") == 0, "append after the cut");
+
+    SessionStore again(path);
+    EXPECT(again.Open() == 0, "reopen");
+    EXPECT(Value(again, kRecent, "/tmp/after.txt") == "5", "record after the cut replays");
+}
+
+void TestCorruptValue(const std::string& path) {
+    {
+        SessionStore store(path);
+        EXPECT(store.Open() == 0, "open");
+        EXPECT(store.Put(kWindows, "shelf-2", "ZZZZZZZZ") == 0, "put");
+        EXPECT(store.Compact() == 0, "compact");
+    }
+    std::string data = ReadAll(path);
+    size_t at = data.find("ZZZZZZZZ");
+    EXPECT(at != std::string::npos, "value stored verbatim");
+    if (at == std::string::npos) {
+        return;
+    }
+    data[at] = 'Y';
+    WriteAll(path, data);
+
+    SessionStore store(path);
+    EXPECT(store.Open() == 0, "open");
+    EXPECT(Value(store, kWindows, "shelf-2") == "<missing>", "corrupt value not returned");
+    EXPECT(Value(store, kRecent, "/tmp/b.txt") == "3", "other values still read");
+    EXPECT(store.Stats().corruptValues == 1, "corruption counted");
+    EXPECT(store.Keys(kWindows).size() == 1, "key still listed");
+}
+
+void TestInvalidSnapshot(const std::string& path) {
+    Remove(path);
+    WriteAll(path, std::string(200, 'x'));
+    SessionStore store(path);
+    EXPECT(store.Open() == 0, "open over garbage");
+    EXPECT(store.Stats().snapshotRecords == 0, "garbage ignored");
+    EXPECT(store.Put(kRecent, "/tmp/a.txt", "1") == 0, "put");
+    EXPECT(store.Compact() == 0, "compact replaces it");
+
+    SessionStore again(path);
+    EXPECT(again.Open() == 0, "reopen");
+    EXPECT(Value(again, kRecent, "/tmp/a.txt") == "1", "replacement snapshot read");
+
+    // A snapshot whose index was damaged is ignored as a whole
+    std::string data = ReadAll(path);
+    data[data.find("/tmp/a.txt")] = '!';
+    WriteAll(path, data);
+    SessionStore damaged(path);
+    EXPECT(damaged.Open() == 0, "open");
+    EXPECT(damaged.Stats().snapshotRecords == 0, "damaged index ignored");
+}
+
+void TestCompactWhilePutting(const std::string& path) {
+    Remove(path);
+    SessionStore store(path);
+    EXPECT(store.Open() == 0, "open");
+    const int kWriters = 4;
+    const int kPuts = 2000;
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; w++) {
+        writers.emplace_back([&store, w] {
+            for (int i = 0; i < kPuts; i++) {
+                const std::string key = "w" + std::to_string(w) + "/" + std::to_string(i);
+                if (store.Put(kRecent, key, std::to_string(i)) != 0) {
+                    std::fprintf(stderr, "put %s failed\n", key.c_str());
+                    std::exit(2);
+                }
+                if (i % 3 == 0) {
+                    store.Delete(kRecent, key);
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20; i++) {
+        EXPECT(store.Compact() == 0, "compact");
+        std::string value;
+        store.Get(kRecent, "w0/1", &value);
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+
+    const size_t expected = static_cast<size_t>(kWriters) * (kPuts - (kPuts + 2) / 3);
+    EXPECT(store.Keys(kRecent).size() == expected, "all live keys, got %zu want %zu",
+           store.Keys(kRecent).size(), expected);
+
+    SessionStore again(path);
+    EXPECT(again.Open() == 0, "reopen");
+    EXPECT(again.Keys(kRecent).size() == expected, "all live keys after reopen, got %zu",
+           again.Keys(kRecent).size());
+    EXPECT(Value(again, kRecent, "w3/1999") == "1999", "last put");
+    EXPECT(Value(again, kRecent, "w2/3") == "<missing>", "deleted key");
+    EXPECT(again.Compact() == 0 && again.Keys(kRecent).size() == expected, "final compaction");
+}
+
+void TestCrashBetweenRenames(const std::string& path) {
+    Remove(path);
+    const std::string logPath = path + ".log";
+    std::string oldLog;
+    {
+        SessionStore store(path);
+        EXPECT(store.Open() == 0, "open");
+        EXPECT(store.Put(kRecent, "/tmp/a.txt", "1") == 0, "put");
+        EXPECT(store.Put(kRecent, "/tmp/b.txt", "2") == 0, "put");
+        EXPECT(store.Delete(kRecent, "/tmp/a.txt") == 0, "delete");
+        oldLog = ReadAll(logPath);
+        EXPECT(store.Compact() == 0, "compact");
+    }
+    // As if the new snapshot was renamed into place but the log was not
+    WriteAll(logPath, oldLog);
+    {
+        SessionStore store(path);
+        EXPECT(store.Open() == 0, "open new snapshot with old log");
+        EXPECT(Value(store, kRecent, "/tmp/b.txt") == "2", "value kept");
+        EXPECT(Value(store, kRecent, "/tmp/a.txt") == "<missing>", "delete kept");
+        EXPECT(store.Put(kRecent, "/tmp/c.txt", "3") == 0, "put");
+    }
+    SessionStore store(path);
+    EXPECT(store.Open() == 0, "reopen");
+    EXPECT(Value(store, kRecent, "/tmp/b.txt") == "2" && Value(store, kRecent, "/tmp/c.txt") == "3",
+           "records written after recovery replay");
+
+    // A log two generations behind belongs to neither snapshot and is dropped
+    EXPECT(store.Compact() == 0, "compact");
+    WriteAll(logPath, oldLog);
+    SessionStore stale(path);
+    EXPECT(stale.Open() == 0, "open with a stale log");
+    EXPECT(stale.Stats().logRecords == 0, "stale log ignored");
+    EXPECT(Value(stale, kRecent, "/tmp/c.txt") == "3", "snapshot intact");
+}
+
+} // namespace
+
+int main() {
+    char pattern[] = "/tmp/session_store_test.XXXXXX";
+    const char* work = mkdtemp(pattern);
+    if (!work) {
+        std::fprintf(stderr, "cannot create work directory\n");
+        return 2;
+    }
+    const std::string dir = work;
+    const std::string path = dir + "/session.fcs";
+
+    TestBasics(path);
+    TestReopen(path);
+    TestTornLog(path);
+    TestCorruptValue(path);
+    TestInvalidSnapshot(path);
+    TestCompactWhilePutting(path);
+    TestCrashBetweenRenames(path);
+
+    std::string cleanup = "rm -rf '" + dir + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", dir.c_str());
+    }
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+/**
+ * @fileoverview Benchmark: native shelf item store vs ShelfItem arrays
+ *
+ * Fills one shelf with ITEMS dropped files (a file-list payload, as a drag
+ * delivers them) and times what ShelfManager does with its items:
+ *   - insert the drop: NativeShelfStore.insertFileList vs a ShelfItem
+ *     object (with a UUID) pushed per file
+ *   - dedupe: the same DEDUPE paths dropped again, an array scan per path
+ *     vs the store's path index
+ *   - find DEDUPE paths, and remove REMOVALS items one by one by id
+ *     (findIndex + splice vs the free list)
+ *   - save and restore: serialize() and the constructor vs structured
+ *     clone (the IPC hop of 'shelf:config') and JSON (the session store)
+ * A Map keyed by id plus one keyed by path, the best plain-JS layout, is
+ * timed alongside. Retained heap is measured after a forced GC.
+ *
+ * Usage (from src/native):
+ *   npm run bench:shelf-store
+ *   ITEMS=1000000 RUNS=3 node --expose-gc test/shelf_store_bench.mjs
+ */
+
+import { createRequire } from 'module';
+import { randomUUID } from 'crypto';
+import os from 'os';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const require = createRequire(import.meta.url);
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+const ITEMS = Number(process.env.ITEMS || 100000);
+const RUNS = Number(process.env.RUNS || 5);
+const DEDUPE = Math.min(ITEMS, 1000);
+const REMOVALS = Math.min(ITEMS, 1000);
+
+const native = require(
+  path.join(__dirname, '..', 'file-ops', 'build', 'Release', `file_ops_${process.platform}.node`)
+);
+
+// --- Drop payload (the layout of common/file_list_payload.h) ---------------
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+function makePaths() {
+  const extensions = ['jpg', 'HEIC', 'pdf', 'docx', 'mov'];
+  const paths = [];
+  for (let i = 0; i < ITEMS; i++) {
+    paths.push(
+      `/Users/alex/Pictures/Library ${Math.floor(i / 1000)}/Holiday photo ${i}.${extensions[i % extensions.length]}`
+    );
+  }
+  return paths;
+}
+
+// Paths only; names and extensions point into them, sizes are known
+function encodeFileList(paths) {
+  const bytes = paths.map(p => encoder.encode(p));
+  const stringBytes = bytes.reduce((total, b) => total + b.length, 0);
+  const buffer = new ArrayBuffer((16 + paths.length * 32 + stringBytes + 7) & ~7);
+  const header = new DataView(buffer, 0, 16);
+  header.setUint32(0, 0x4c464346, true);
+  header.setUint16(4, 1, true);
+  header.setUint16(6, 32, true);
+  header.setUint32(8, paths.length, true);
+  header.setUint32(12, stringBytes, true);
+  const words = new Uint32Array(buffer, 16, paths.length * 8);
+  const sizes = new Float64Array(buffer, 16, paths.length * 4);
+  const strings = new Uint8Array(buffer, 16 + paths.length * 32, stringBytes);
+  let offset = 0;
+  paths.forEach((p, i) => {
+    const name = p.slice(p.lastIndexOf('/') + 1);
+    const nameBytes = encoder.encode(name).length;
+    const extensionBytes = name.length - name.lastIndexOf('.') - 1;
+    words.set([offset, bytes[i].length, offset + bytes[i].length - nameBytes, nameBytes,
+      offset + bytes[i].length - extensionBytes, extensionBytes | ((2 | 4) << 16)], i * 8);
+    sizes[i * 4 + 3] = 1000 + i;
+    strings.set(bytes[i], offset);
+    offset += bytes[i].length;
+  });
+  return buffer;
+}
+
+// The FileListView reads a drop handler does to build ShelfItems
+function readFileList(buffer) {
+  const count = new DataView(buffer).getUint32(8, true);
+  const words = new Uint32Array(buffer, 16, count * 8);
+  const sizes = new Float64Array(buffer, 16, count * 4);
+  const strings = new Uint8Array(buffer, 16 + count * 32);
+  const decode = (o, l) => decoder.decode(strings.subarray(o, o + l));
+  const files = [];
+  for (let i = 0; i < count; i++) {
+    files.push({
+      path: decode(words[i * 8], words[i * 8 + 1]),
+      name: decode(words[i * 8 + 2], words[i * 8 + 3]),
+      extension: decode(words[i * 8 + 4], words[i * 8 + 5] & 0xffff),
+      size: sizes[i * 4 + 3],
+    });
+  }
+  return files;
+}
+
+function shelfItem(file) {
+  return {
+    id: randomUUID(),
+    type: 'file',
+    name: file.name,
+    path: file.path,
+    size: file.size,
+    createdAt: Date.now(),
+    metadata: { extension: file.extension },
+  };
+}
+
+// --- JS baselines -----------------------------------------------------------
+
+class ArrayShelf {
+  constructor() {
+    this.items = [];
+  }
+  insert(files) {
+    for (const file of files) this.items.push(shelfItem(file));
+  }
+  insertUnique(files) {
+    for (const file of files) {
+      if (!this.items.some(item => item.path === file.path)) this.items.push(shelfItem(file));
+    }
+  }
+  find(filePath) {
+    return this.items.find(item => item.path === filePath)?.id ?? null;
+  }
+  remove(id) {
+    const index = this.items.findIndex(item => item.id === id);
+    if (index > -1) this.items.splice(index, 1);
+  }
+}
+
+class MapShelf {
+  constructor() {
+    this.items = new Map();
+    this.byPath = new Map();
+  }
+  insert(files) {
+    for (const file of files) {
+      if (this.byPath.has(file.path)) continue;
+      const item = shelfItem(file);
+      this.items.set(item.id, item);
+      this.byPath.set(item.path, item.id);
+    }
+  }
+  find(filePath) {
+    return this.byPath.get(filePath) ?? null;
+  }
+  remove(id) {
+    const item = this.items.get(id);
+    if (!item) return;
+    this.items.delete(id);
+    this.byPath.delete(item.path);
+  }
+}
+
+// --- Harness ----------------------------------------------------------------
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+// setup() runs untimed before every timed run(state)
+function bench(name, setup, run) {
+  run(setup()); // warm-up: JIT
+  const times = [];
+  let result;
+  for (let i = 0; i < RUNS; i++) {
+    const state = setup();
+    const start = process.hrtime.bigint();
+    result = run(state);
+    times.push(Number(process.hrtime.bigint() - start) / 1e6);
+  }
+  const ms = median(times);
+  console.log(`${name.padEnd(48)} ${ms.toFixed(2).padStart(9)} ms`);
+  return { ms, result };
+}
+
+function retainedBytes(build) {
+  if (!global.gc) return NaN;
+  global.gc();
+  const before = process.memoryUsage();
+  const kept = build();
+  global.gc();
+  const after = process.memoryUsage();
+  const bytes = after.heapUsed - before.heapUsed + after.external - before.external +
+    after.arrayBuffers - before.arrayBuffers;
+  return { bytes, kept };
+}
+
+const paths = makePaths();
+const drop = encodeFileList(paths);
+const files = readFileList(drop);
+const sample = Array.from({ length: DEDUPE }, (_, i) => Math.floor((i * ITEMS) / DEDUPE));
+console.log(`\nNode ${process.version}, ${os.cpus().length} CPUs, ${ITEMS} items, median of ${RUNS} runs\n`);
+
+const nativeFilled = () => {
+  const store = new native.NativeShelfStore();
+  store.insertFileList(drop);
+  return store;
+};
+const arrayFilled = () => {
+  const shelf = new ArrayShelf();
+  shelf.insert(files);
+  return shelf;
+};
+const mapFilled = () => {
+  const shelf = new MapShelf();
+  shelf.insert(files);
+  return shelf;
+};
+
+const insertNative = bench('insert drop: native insertFileList', () => null, () => nativeFilled());
+const insertArray = bench('insert drop: read payload + ShelfItem[] push', () => null, () => {
+  const shelf = new ArrayShelf();
+  shelf.insert(readFileList(drop));
+  return shelf;
+});
+const insertMap = bench('insert drop: read payload + Map', () => null, () => {
+  const shelf = new MapShelf();
+  shelf.insert(readFileList(drop));
+  return shelf;
+});
+console.log();
+
+const dedupeDrop = encodeFileList(sample.map(i => paths[i]));
+const dedupeFiles = readFileList(dedupeDrop);
+const dedupeNative = bench(`re-drop ${DEDUPE}: native`, nativeFilled, store => store.insertFileList(dedupeDrop));
+const dedupeArray = bench(`re-drop ${DEDUPE}: array scan per path`, arrayFilled, shelf =>
+  shelf.insertUnique(readFileList(dedupeDrop)));
+const dedupeMap = bench(`re-drop ${DEDUPE}: Map`, mapFilled, shelf => shelf.insert(readFileList(dedupeDrop)));
+console.log();
+
+const findNative = bench(`find ${DEDUPE} paths: native`, nativeFilled, store => {
+  let found = 0;
+  for (const file of dedupeFiles) found += store.find(file.path) !== null;
+  return found;
+});
+const findArray = bench(`find ${DEDUPE} paths: array`, arrayFilled, shelf => {
+  let found = 0;
+  for (const file of dedupeFiles) found += shelf.find(file.path) !== null;
+  return found;
+});
+console.log();
+
+const removeNative = bench(`remove ${REMOVALS} one by one: native`, () => {
+  const store = nativeFilled();
+  const ids = store.ids();
+  return { store, ids: sample.slice(0, REMOVALS).map(i => ids[i]) };
+}, ({ store, ids }) => {
+  for (const id of ids) store.remove([id]);
+  return store.count();
+});
+const removeArray = bench(`remove ${REMOVALS} one by one: findIndex + splice`, () => {
+  const shelf = arrayFilled();
+  return { shelf, ids: sample.slice(0, REMOVALS).map(i => shelf.items[i].id) };
+}, ({ shelf, ids }) => {
+  for (const id of ids) shelf.remove(id);
+  return shelf.items.length;
+});
+const removeMap = bench(`remove ${REMOVALS} one by one: Map`, () => {
+  const shelf = mapFilled();
+  const all = [...shelf.items.keys()];
+  return { shelf, ids: sample.slice(0, REMOVALS).map(i => all[i]) };
+}, ({ shelf, ids }) => {
+  for (const id of ids) shelf.remove(id);
+  return shelf.items.size;
+});
+console.log();
+
+const saveNative = bench('save: native serialize', nativeFilled, store => store.serialize());
+const saveClone = bench('save: structuredClone(ShelfItem[])', arrayFilled, shelf => structuredClone(shelf.items));
+const saveJson = bench('save: JSON.stringify(ShelfItem[])', arrayFilled, shelf => JSON.stringify(shelf.items));
+const restoreNative = bench('restore: new NativeShelfStore(payload)', () => saveNative.result, payload =>
+  new native.NativeShelfStore(payload));
+const restoreJson = bench('restore: JSON.parse', () => saveJson.result, json => JSON.parse(json));
+console.log(`  payload ${(saveNative.result.byteLength / 1024).toFixed(0)} KiB ` +
+  `(${(saveNative.result.byteLength / ITEMS).toFixed(1)} B/item), ` +
+  `JSON ${(saveJson.result.length / 1024).toFixed(0)} KiB\n`);
+
+// Every store must hold the same paths, in order
+const check = restoreNative.result;
+const checkIds = check.ids();
+let mismatches = checkIds.length === ITEMS ? 0 : 1;
+for (let i = 0; i < checkIds.length; i += 997) {
+  if (check.get(checkIds[i]).path !== paths[i] || check.find(paths[i]) !== checkIds[i]) mismatches++;
+}
+console.log(mismatches === 0 ? 'restored store matches the drop' : `MISMATCH in ${mismatches} items`);
+
+const heapNative = retainedBytes(nativeFilled);
+const heapArray = retainedBytes(arrayFilled);
+const heapMap = retainedBytes(mapFilled);
+if (Number.isNaN(heapNative)) {
+  console.log('retained memory: run with node --expose-gc');
+} else {
+  const mib = bytes => `${(bytes / 1024 / 1024).toFixed(1)} MiB (${(bytes / ITEMS).toFixed(0)} B/item)`;
+  console.log(`retained, native store:   ${mib(heapNative.kept.stats().memoryBytes)} native, ` +
+    `${mib(heapNative.bytes)} JS heap`);
+  console.log(`retained, ShelfItem[]:    ${mib(heapArray.bytes)}`);
+  console.log(`retained, Map + path Map: ${mib(heapMap.bytes)}`);
+}
+
+console.log(`\ninsert speedup vs array:  ${(insertArray.ms / insertNative.ms).toFixed(1)}x, vs Map ${(insertMap.ms / insertNative.ms).toFixed(1)}x`);
+console.log(`re-drop speedup vs array: ${(dedupeArray.ms / dedupeNative.ms).toFixed(0)}x, vs Map ${(dedupeMap.ms / dedupeNative.ms).toFixed(1)}x`);
+console.log(`find speedup vs array:    ${(findArray.ms / findNative.ms).toFixed(0)}x`);
+console.log(`remove speedup vs array:  ${(removeArray.ms / removeNative.ms).toFixed(0)}x, vs Map ${(removeMap.ms / removeNative.ms).toFixed(1)}x`);
+console.log(`save speedup vs clone:    ${(saveClone.ms / saveNative.ms).toFixed(1)}x, vs JSON ${(saveJson.ms / saveNative.ms).toFixed(1)}x`);
+console.log(`restore speedup vs JSON:  ${(restoreJson.ms / restoreNative.ms).toFixed(1)}x`);
@@ -0,0 +1,322 @@
+/**
+ * @file shelf_store_test.cc
+ * @brief Functional test for the columnar shelf item store
+ *
+ * Checks that inserts keep shelf order and return the existing id for a
+ * path already on the shelf, that removal reuses slots without reviving
+ * stale ids, that the path index stays correct through many removals and
+ * reinserts, that a file-list payload inserts in one call, and that
+ * Serialize/Load round-trips ids, order and fields while malformed
+ * payloads are rejected.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "file_list_payload.h"
+#include "shelf_store.h"
+#include "test_support.h"
+
+using FileCataloger::FileListEntry;
+using FileCataloger::FileListPayloadWriter;
+using FileCataloger::FILE_LIST_EXISTS;
+using FileCataloger::FILE_LIST_IS_DIRECTORY;
+using FileCataloger::FILE_LIST_IS_FILE;
+using FileCataloger::ShelfItem;
+using FileCataloger::ShelfItemId;
+using FileCataloger::ShelfItemKind;
+using FileCataloger::ShelfItemRecord;
+using FileCataloger::ShelfStore;
+using FileCataloger::ShelfStoreStats;
+
+namespace {
+
+ShelfItemRecord FileRecord(const std::string& path, double size = NAN) {
+    ShelfItemRecord record;
+    record.path = path;
+    record.size = size;
+    return record;
+}
+
+ShelfItemId InsertOne(ShelfStore& store, const ShelfItemRecord& record) {
+    ShelfItemId id = 0;
+    store.Insert(&record, 1, &id);
+    return id;
+}
+
+bool SameNumber(double a, double b) {
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+std::string PathOf(const ShelfStore& store, ShelfItemId id) {
+    ShelfItem item;
+    return store.Get(id, &item) ? item.path : "<missing>";
+}
+
+void TestInsertAndDedupe() {
+    ShelfStore store;
+    const std::vector<std::string> paths = {"/Users/a/Desktop/one.txt", "/Users/a/Desktop/two.txt",
+                                            "/Users/a/Desktop/one.txt", "/Users/a/Pictures/one.txt", "relative"};
+    std::vector<ShelfItemRecord> records;
+    for (size_t i = 0; i < paths.size(); i++) {
+        records.push_back(FileRecord(paths[i], static_cast<double>(i)));
+    }
+    ShelfItemRecord text;
+    text.kind = ShelfItemKind::Text;
+    text.name = "a note";
+    records.push_back(text);
+
+    std::vector<ShelfItemId> ids(records.size());
+    size_t added = store.Insert(records.data(), records.size(), ids.data());
+    EXPECT(added == 5, "added %zu of 6 (one duplicate)", added);
+    EXPECT(store.Size() == 5, "size %zu", store.Size());
+    EXPECT(ids[2] == ids[0], "duplicate path returns the existing id");
+    EXPECT(ids[3] != ids[0], "same name in another folder is a different item");
+    for (ShelfItemId id : ids) {
+        EXPECT(id != 0 && id < (1ull << 53), "id %llu fits a JS number", static_cast<unsigned long long>(id));
+    }
+
+    std::vector<ShelfItemId> order = store.Ids();
+    std::vector<ShelfItemId> expected = {ids[0], ids[1], ids[3], ids[4], ids[5]};
+    EXPECT(order == expected, "shelf order is insertion order");
+
+    EXPECT(store.Find("/Users/a/Desktop/two.txt") == ids[1], "find two.txt");
+    EXPECT(store.Find("/Users/a/Pictures/one.txt") == ids[3], "find in another folder");
+    EXPECT(store.Find("relative") == ids[4], "find a path without a directory");
+    EXPECT(store.Find("/Users/a/Desktop/three.txt") == 0, "unknown name");
+    EXPECT(store.Find("/Users/b/Desktop/one.txt") == 0, "unknown directory");
+    EXPECT(store.Find("a note") == 0, "text items are not indexed by name");
+
+    ShelfItem item;
+    EXPECT(store.Get(ids[0], &item), "get one.txt");
+    EXPECT(item.path == paths[0] && item.name == "one.txt", "path '%s' name '%s'", item.path.c_str(),
+           item.name.c_str());
+    EXPECT(item.size == 0 && std::isnan(item.mtimeMs), "size and unknown mtime");
+    EXPECT(store.Get(ids[5], &item) && item.path.empty() && item.name == "a note" &&
+           item.kind == ShelfItemKind::Text, "text item");
+
+    ShelfStoreStats stats = store.Stats();
+    EXPECT(stats.directories == 3, "directories interned once each: %zu", stats.directories);
+}
+
+void TestRemoveAndReuse() {
+    ShelfStore store;
+    ShelfItemId a = InsertOne(store, FileRecord("/d/a"));
+    ShelfItemId b = InsertOne(store, FileRecord("/d/b"));
+    ShelfItemId c = InsertOne(store, FileRecord("/d/c"));
+
+    EXPECT(store.Remove(b), "remove b");
+    EXPECT(!store.Remove(b), "remove b twice");
+    EXPECT(!store.Contains(b) && store.Find("/d/b") == 0, "b is gone");
+    EXPECT((store.Ids() == std::vector<ShelfItemId>{a, c}), "order after removing the middle");
+
+    ShelfItemId d = InsertOne(store, FileRecord("/e/d"));
+    EXPECT((d & 0xFFFFFFFF) == (b & 0xFFFFFFFF), "freed slot reused");
+    EXPECT(d != b, "reused slot gets a new generation");
+    EXPECT(!store.Contains(b) && PathOf(store, b) == "<missing>", "stale id does not reach the new item");
+    EXPECT(PathOf(store, d) == "/e/d", "new item");
+    EXPECT(store.Stats().slots == 3, "no slot added: %zu", store.Stats().slots);
+    EXPECT((store.Ids() == std::vector<ShelfItemId>{a, c, d}), "reused slot goes to the end of the shelf");
+
+    EXPECT(store.Remove(a) && store.Remove(c) && store.Remove(d), "remove the rest");
+    EXPECT(store.Size() == 0 && store.Ids().empty(), "empty");
+    EXPECT(store.Stats().directories == 0, "directories released");
+    EXPECT(store.Stats().nameBytes == 0, "name arena compacted");
+
+    ShelfItemId again = InsertOne(store, FileRecord("/d/a"));
+    EXPECT(again != 0 && again != a && PathOf(store, again) == "/d/a", "path can be added again");
+
+    store.Clear();
+    EXPECT(store.Size() == 0 && !store.Contains(again), "clear stales ids");
+    EXPECT(store.Find("/d/a") == 0, "clear empties the index");
+}
+
+// Tombstones from removals must not hide paths further along a probe chain
+void TestIndexChurn() {
+    ShelfStore store;
+    constexpr int kCount = 20000;
+    std::vector<ShelfItemId> ids(kCount);
+    for (int i = 0; i < kCount; i++) {
+        ids[i] = InsertOne(store, FileRecord("/churn/" + std::to_string(i % 7) + "/file" + std::to_string(i)));
+    }
+    for (int i = 0; i < kCount; i += 2) {
+        store.Remove(ids[i]);
+    }
+    int misses = 0;
+    for (int i = 0; i < kCount; i++) {
+        ShelfItemId found = store.Find("/churn/" + std::to_string(i % 7) + "/file" + std::to_string(i));
+        misses += found != (i % 2 ? ids[i] : 0);
+    }
+    EXPECT(misses == 0, "%d lookups wrong after removing half", misses);
+
+    for (int i = 0; i < kCount; i += 2) {
+        ids[i] = InsertOne(store, FileRecord("/churn/" + std::to_string(i % 7) + "/file" + std::to_string(i)));
+    }
+    misses = 0;
+    for (int i = 0; i < kCount; i++) {
+        misses += store.Find("/churn/" + std::to_string(i % 7) + "/file" + std::to_string(i)) != ids[i];
+    }
+    EXPECT(misses == 0, "%d lookups wrong after reinserting", misses);
+    EXPECT(store.Size() == kCount && store.Stats().slots == kCount, "slots reused: %zu",
+           store.Stats().slots);
+}
+
+void TestInsertFileList() {
+    FileListPayloadWriter writer;
+    FileListEntry folder;
+    folder.path = "/drop/photos";
+    folder.name = "photos";
+    folder.flags = FILE_LIST_IS_DIRECTORY | FILE_LIST_EXISTS;
+    writer.Add(folder);
+    FileListEntry file;
+    file.path = "/drop/notes.md";
+    file.name = "notes.md";
+    file.extension = "md";
+    file.flags = FILE_LIST_IS_FILE | FILE_LIST_EXISTS;
+    file.size = 42;
+    writer.Add(file);
+    std::vector<uint8_t> payload = writer.Finish();
+
+    ShelfStore store;
+    std::vector<ShelfItemId> ids;
+    size_t added = 0;
+    EXPECT(store.InsertFileList(payload.data(), payload.size(), &ids, &added), "insert file list");
+    EXPECT(added == 2 && ids.size() == 2, "added %zu", added);
+
+    ShelfItem item;
+    EXPECT(store.Get(ids[0], &item) && item.kind == ShelfItemKind::Folder && item.path == "/drop/photos",
+           "folder from the directory flag");
+    EXPECT(store.Get(ids[1], &item) && item.kind == ShelfItemKind::File && item.size == 42 &&
+           item.flags == (FILE_LIST_IS_FILE | FILE_LIST_EXISTS), "file with size and flags");
+
+    // The same drop again adds nothing
+    std::vector<ShelfItemId> again;
+    EXPECT(store.InsertFileList(payload.data(), payload.size(), &again, &added) && added == 0 && again == ids,
+           "second drop deduplicated");
+
+    std::vector<uint8_t> bad = payload;
+    bad[16 + 4] = 0xFF;   // first record's path length past the string table
+    EXPECT(!store.InsertFileList(bad.data(), bad.size(), &again, &added), "out-of-bounds record rejected");
+    EXPECT(!store.InsertFileList(payload.data(), 12, &again, &added), "truncated header rejected");
+    EXPECT(store.Size() == 2, "rejected payloads add nothing");
+}
+
+void TestSerializeRoundTrip() {
+    ShelfStore store;
+    std::vector<ShelfItemId> ids;
+    for (int i = 0; i < 100; i++) {
+        const std::string path = "/round/" + std::to_string(i % 5) + "/item" + std::to_string(i);
+        ShelfItemRecord record = FileRecord(path, i);
+        record.mtimeMs = 1700000000000.0 + i;
+        record.flags = static_cast<uint16_t>(i);
+        ids.push_back(InsertOne(store, record));
+    }
+    ShelfItemRecord url;
+    url.kind = ShelfItemKind::Url;
+    url.name = "https://example.com/";
+    ids.push_back(InsertOne(store, url));
+    for (int i = 0; i < 100; i += 3) {
+        store.Remove(ids[i]);
+    }
+
+    std::vector<uint8_t> payload = store.Serialize();
+    EXPECT(payload.size() == store.SerializedLength() && payload.size() % 8 == 0, "length %zu", payload.size());
+
+    ShelfStore loaded;
+    EXPECT(loaded.Load(payload.data(), payload.size()), "load");
+    EXPECT(loaded.Ids() == store.Ids(), "same ids in the same order");
+    int mismatches = 0;
+    for (ShelfItemId id : store.Ids()) {
+        ShelfItem a, b;
+        store.Get(id, &a);
+        if (!loaded.Get(id, &b) || a.path != b.path || a.name != b.name || a.kind != b.kind ||
+            a.flags != b.flags || !SameNumber(a.size, b.size) || !SameNumber(a.mtimeMs, b.mtimeMs)) {
+            mismatches++;
+        }
+        if (!a.path.empty() && loaded.Find(a.path) != id) {
+            mismatches++;
+        }
+    }
+    EXPECT(mismatches == 0, "%d items differ after loading", mismatches);
+    EXPECT(!loaded.Contains(ids[0]), "removed ids stay removed");
+
+    // Gaps are free slots again, and a reused one never revives a saved id
+    ShelfItemId fresh = InsertOne(loaded, FileRecord("/round/new"));
+    EXPECT(loaded.Stats().slots == store.Stats().slots, "gap reused: %zu slots", loaded.Stats().slots);
+    EXPECT(std::find(ids.begin(), ids.end(), fresh) == ids.end(), "fresh id is none of the saved or removed ids");
+    EXPECT(loaded.Serialize() != payload, "payload changes with the shelf");
+
+    ShelfStore empty;
+    std::vector<uint8_t> nothing = empty.Serialize();
+    EXPECT(nothing.size() == FileCataloger::SHELF_ITEMS_HEADER_BYTES, "empty payload is a header");
+    EXPECT(loaded.Load(nothing.data(), nothing.size()) && loaded.Size() == 0, "load empty");
+}
+
+void TestMalformedPayloads() {
+    ShelfStore store;
+    InsertOne(store, FileRecord("/m/a"));
+    InsertOne(store, FileRecord("/m/b"));
+    const std::vector<uint8_t> good = store.Serialize();
+    const size_t n = 2;
+    const size_t directoryColumn = FileCataloger::SHELF_ITEMS_HEADER_BYTES + n * 24;
+    const size_t kindColumn = directoryColumn + n * 12 + 8 + n * 2;
+
+    auto rejects = [](std::vector<uint8_t> bytes, const char* what) {
+        ShelfStore target;
+        InsertOne(target, FileRecord("/x/y"));
+        EXPECT(!target.Load(bytes.data(), bytes.size()), "%s accepted", what);
+        EXPECT(target.Size() == 0, "%s left items behind", what);
+    };
+
+    std::vector<uint8_t> bytes = good;
+    bytes[0] ^= 1;
+    rejects(bytes, "bad magic");
+
+    rejects(std::vector<uint8_t>(good.begin(), good.end() - 8), "truncated strings");
+
+    bytes = good;
+    std::memcpy(bytes.data() + 24 + 8, bytes.data() + 24, 8);   // second id equals the first
+    rejects(bytes, "duplicate id");
+
+    bytes = good;
+    double zero = 0;
+    std::memcpy(bytes.data() + 24, &zero, 8);
+    rejects(bytes, "id 0");
+
+    bytes = good;
+    bytes[kindColumn] = 9;
+    rejects(bytes, "unknown kind");
+
+    bytes = good;
+    bytes[directoryColumn] = 7;   // directory index past the table
+    rejects(bytes, "directory out of range");
+
+    bytes = good;
+    // Second item's name points at the first's: the same path twice
+    std::memcpy(bytes.data() + directoryColumn + n * 4 + 4, bytes.data() + directoryColumn + n * 4, 4);
+    rejects(bytes, "duplicate path");
+
+    ShelfStore target;
+    EXPECT(target.Load(good.data(), good.size()) && target.Size() == 2, "the unmodified payload loads");
+}
+
+} // namespace
+
+int main() {
+    TestInsertAndDedupe();
+    TestRemoveAndReuse();
+    TestIndexChurn();
+    TestInsertFileList();
+    TestSerializeRoundTrip();
+    TestMalformedPayloads();
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
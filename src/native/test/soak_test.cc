@@ -0,0 +1,417 @@
+/**
+ * @file soak_test.cc
+ * @brief Accelerated soak test for memory growth in the input modules
+ *
+ * Replays days of synthetic mouse and drag activity through the parts of
+ * the mouse tracker and drag monitor that run on Linux, on a simulated
+ * clock, as fast as the machine allows:
+ *   - mouse events through a BatchedDispatcher<MouseData>, as
+ *     QueueMouseEvent/QueueButtonEvent push them, drained on a stand-in JS
+ *     thread (napi_test_shim.h)
+ *   - drags through DragSession and an ArenaChunkCache, with trajectory
+ *     snapshots every 10 moves analysed on a second thread through the
+ *     monitor's fixed ring of 8 tasks, dragged paths added once per file
+ *     drag and kept until the next one
+ *
+ * Every simulated hour it samples resident size and malloc's statistics
+ * (process_memory.h) with the live objects of each subsystem. After the
+ * first simulated day, a least-squares slope of heap in use and of
+ * resident size over time must stay under a threshold, and the live
+ * object counts must come back to their idle values.
+ *
+ * Environment (defaults in brackets):
+ *   SOAK_DAYS                   simulated days [60]
+ *   SOAK_MOVES_PER_DAY          mouse moves per day [1000000, ~4.5h at 60Hz]
+ *   SOAK_DRAGS_PER_DAY          drags per day [1000]
+ *   SOAK_MAX_HEAP_KB_PER_DAY    heap in use slope limit [32]
+ *   SOAK_MAX_RSS_KB_PER_DAY     resident size slope limit [256]
+ *   SOAK_CSV                    write every sample to this file
+ *   SOAK_LEAK_BYTES_PER_DRAG    leak this much per drag, to see the test fail [0]
+ *
+ * Batches fill to maxBatchSize instead of waiting out the 16ms latency, and
+ * idle time is skipped, so a simulated day takes well under a second.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run soak:linux
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "input_replay.h"
+#include "napi_test_shim.h"
+#include "process_memory.h"
+
+using FileCataloger::ArenaChunkCache;
+using FileCataloger::DragSession;
+using FileCataloger::ProcessMemorySample;
+using FileCataloger::TrajectorySnapshot;
+
+namespace {
+
+uint64_t EnvOr(const char* name, uint64_t fallback) {
+    const char* value = std::getenv(name);
+    return value && *value ? std::strtoull(value, nullptr, 10) : fallback;
+}
+
+// --- Drag monitor -----------------------------------------------------------
+
+std::atomic<int64_t> g_liveSessions{0};
+
+struct CountedSession : DragSession {
+    explicit CountedSession(ArenaChunkCache* cache) : DragSession(cache) { g_liveSessions++; }
+    ~CountedSession() { g_liveSessions--; }
+};
+
+// Queues snapshots to an analysis thread through the monitor's fixed ring
+class MonitorDragReplay : public DragReplay {
+public:
+    static constexpr size_t ANALYSIS_QUEUE_CAPACITY = 8;
+
+    MonitorDragReplay() : DragReplay(64) {
+        analysisRunning_ = true;
+        analysisThread_ = std::thread([this] { AnalysisLoop(); });
+    }
+
+    ~MonitorDragReplay() override { Stop(); }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(analysisQueueMutex_);
+            if (!analysisRunning_.exchange(false)) {
+                return;
+            }
+        }
+        analysisCV_.notify_all();
+        analysisThread_.join();
+        ClearAnalysisQueue();
+        Reset();
+    }
+
+    // Wait until the analysis thread is idle
+    void Settle() {
+        std::unique_lock<std::mutex> lock(analysisQueueMutex_);
+        idleCV_.wait(lock, [this] { return analysisQueueSize_ == 0 && !analysing_; });
+    }
+
+    size_t QueuedAnalysis() {
+        std::lock_guard<std::mutex> lock(analysisQueueMutex_);
+        return analysisQueueSize_;
+    }
+
+    uint64_t Analysed() const { return analysed_.load(); }
+    uint64_t AnalysisDropped() const { return analysisDropped_.load(); }
+
+protected:
+    std::shared_ptr<DragSession> NewSession() override { return std::make_shared<CountedSession>(&cache_); }
+
+    void OnSnapshot(const std::shared_ptr<DragSession>& session, TrajectorySnapshot* snapshot) override {
+        EnqueueAnalysis(session, snapshot);
+    }
+
+private:
+    struct AnalysisTask {
+        std::shared_ptr<DragSession> session;
+        TrajectorySnapshot* snapshot;
+    };
+
+    // EnqueueAnalysis in drag_monitor_mac.mm: the oldest task is dropped when full
+    void EnqueueAnalysis(const std::shared_ptr<DragSession>& session, TrajectorySnapshot* snapshot) {
+        {
+            std::lock_guard<std::mutex> lock(analysisQueueMutex_);
+            if (analysisQueueSize_ == ANALYSIS_QUEUE_CAPACITY) {
+                AnalysisTask& oldest = analysisQueue_[analysisQueueHead_];
+                DragSession::ReleaseSnapshot(oldest.snapshot);
+                oldest.session.reset();
+                analysisQueueHead_ = (analysisQueueHead_ + 1) % ANALYSIS_QUEUE_CAPACITY;
+                analysisQueueSize_--;
+                analysisDropped_++;
+            }
+            AnalysisTask& task = analysisQueue_[(analysisQueueHead_ + analysisQueueSize_) % ANALYSIS_QUEUE_CAPACITY];
+            task.session = session;
+            task.snapshot = snapshot;
+            analysisQueueSize_++;
+        }
+        analysisCV_.notify_one();
+    }
+
+    void ClearAnalysisQueue() {
+        std::lock_guard<std::mutex> lock(analysisQueueMutex_);
+        while (analysisQueueSize_ > 0) {
+            AnalysisTask& task = analysisQueue_[analysisQueueHead_];
+            DragSession::ReleaseSnapshot(task.snapshot);
+            task.session.reset();
+            analysisQueueHead_ = (analysisQueueHead_ + 1) % ANALYSIS_QUEUE_CAPACITY;
+            analysisQueueSize_--;
+        }
+    }
+
+    void AnalysisLoop() {
+        std::unique_lock<std::mutex> lock(analysisQueueMutex_);
+        while (analysisRunning_) {
+            analysisCV_.wait(lock, [this] { return analysisQueueSize_ > 0 || !analysisRunning_; });
+            while (analysisQueueSize_ > 0) {
+                AnalysisTask task = std::move(analysisQueue_[analysisQueueHead_]);
+                analysisQueueHead_ = (analysisQueueHead_ + 1) % ANALYSIS_QUEUE_CAPACITY;
+                analysisQueueSize_--;
+                analysing_ = true;
+                lock.unlock();
+
+                Analyse(*task.snapshot);
+                DragSession::ReleaseSnapshot(task.snapshot);
+                task.session.reset();
+
+                lock.lock();
+                analysing_ = false;
+            }
+            idleCV_.notify_all();
+        }
+    }
+
+    // Stands in for AnalyzeTrajectory: one pass over the points
+    void Analyse(const TrajectorySnapshot& snapshot) {
+        double distance = 0;
+        for (size_t i = 1; i < snapshot.count; i++) {
+            distance += std::hypot(snapshot.points[i].x - snapshot.points[i - 1].x,
+                                   snapshot.points[i].y - snapshot.points[i - 1].y);
+        }
+        distance_ += distance;
+        analysed_++;
+    }
+
+    std::thread analysisThread_;
+    std::atomic<bool> analysisRunning_{false};
+    std::mutex analysisQueueMutex_;
+    std::condition_variable analysisCV_;
+    std::condition_variable idleCV_;
+    AnalysisTask analysisQueue_[ANALYSIS_QUEUE_CAPACITY];
+    size_t analysisQueueHead_ = 0;
+    size_t analysisQueueSize_ = 0;
+    bool analysing_ = false;
+    std::atomic<uint64_t> analysed_{0};
+    std::atomic<uint64_t> analysisDropped_{0};
+    double distance_ = 0;  // analysis thread only
+};
+
+// --- Sampling ---------------------------------------------------------------
+
+struct Sample {
+    double day;
+    ProcessMemorySample memory;
+    int64_t liveSessions;
+    uint64_t chunksAllocated;
+    uint64_t cachedArenaBytes;
+    uint64_t dispatcherPending;
+    uint64_t napiPendingCalls;
+    size_t analysisQueued;
+};
+
+// Least-squares slope of value(sample) over simulated days
+template <typename Value>
+double SlopePerDay(const std::vector<Sample>& samples, double fromDay, Value value) {
+    double n = 0, sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+    for (const Sample& sample : samples) {
+        if (sample.day < fromDay) {
+            continue;
+        }
+        double x = sample.day;
+        double y = static_cast<double>(value(sample));
+        n++;
+        sumX += x;
+        sumY += y;
+        sumXY += x * y;
+        sumXX += x * x;
+    }
+    double denominator = n * sumXX - sumX * sumX;
+    return n < 2 || denominator == 0 ? 0 : (n * sumXY - sumX * sumY) / denominator;
+}
+
+double Kb(uint64_t bytes) {
+    return static_cast<double>(bytes) / 1024;
+}
+
+} // namespace
+
+int main() {
+    const uint64_t days = std::max<uint64_t>(EnvOr("SOAK_DAYS", 60), 2);
+    const uint64_t movesPerHour = EnvOr("SOAK_MOVES_PER_DAY", 1000000) / 24;
+    const uint64_t dragsPerHour = std::max<uint64_t>(EnvOr("SOAK_DRAGS_PER_DAY", 1000) / 24, 1);
+    const double maxHeapKbPerDay = static_cast<double>(EnvOr("SOAK_MAX_HEAP_KB_PER_DAY", 32));
+    const double maxRssKbPerDay = static_cast<double>(EnvOr("SOAK_MAX_RSS_KB_PER_DAY", 256));
+    const uint64_t leakBytesPerDrag = EnvOr("SOAK_LEAK_BYTES_PER_DRAG", 0);
+    const double warmupDays = 1;
+
+    std::thread jsThread(NapiTestShim::RunJsThread);
+
+    MouseReplay mouse("SoakMouseEvents");
+    if (!mouse.Start()) {
+        std::fprintf(stderr, "FAIL: dispatcher did not start\n");
+        NapiTestShim::StopJsThread();
+        jsThread.join();
+        return 1;
+    }
+    MonitorDragReplay drags;
+
+    std::printf("Soak: %llu days, %llu moves and %llu drags per simulated hour\n\n",
+                static_cast<unsigned long long>(days),
+                static_cast<unsigned long long>(movesPerHour),
+                static_cast<unsigned long long>(dragsPerHour));
+    std::printf("%5s %10s %10s %9s %8s %8s %10s %8s\n",
+                "day", "rss KB", "heap KB", "sessions", "chunks", "arena KB", "batches", "wall s");
+
+    // Reserved up front so the harness does not grow the heap it measures
+    std::vector<Sample> samples;
+    samples.reserve(days * 24);
+    std::vector<std::unique_ptr<char[]>> leaked;
+    auto started = std::chrono::steady_clock::now();
+    uint64_t timestamp = 0;
+    double x = 400;
+    double y = 300;
+
+    for (uint64_t hour = 0; hour < days * 24; hour++) {
+        // Drags take about a third of the hour's moves
+        const uint64_t movesPerDrag = std::max<uint64_t>(movesPerHour / 3 / dragsPerHour, 30);
+        const uint64_t freeMoves = movesPerHour / dragsPerHour - std::min(movesPerHour / dragsPerHour, movesPerDrag);
+
+        for (uint64_t drag = 0; drag < dragsPerHour; drag++) {
+            const uint64_t dragIndex = hour * dragsPerHour + drag;
+
+            for (uint64_t i = 0; i < freeMoves; i++) {
+                x += static_cast<double>((i * 7) % 11) - 5;
+                y += static_cast<double>((i * 5) % 9) - 4;
+                mouse.Move(x, y, false, timestamp += 16);
+            }
+
+            // One drag in four carries no files; file drags carry 1..64 paths
+            const size_t fileCount = dragIndex % 4 == 3 ? 0 : 1 + (dragIndex * 13) % 64;
+            mouse.Button(true, false);
+            drags.Begin();
+            for (uint64_t i = 1; i <= movesPerDrag; i++) {
+                // Shake-like zigzag every other drag
+                x += (dragIndex % 2 == 0) ? ((i / 4) % 2 == 0 ? 9 : -9) : 3;
+                y += static_cast<double>((i * 3) % 5) - 2;
+                mouse.Move(x, y, true, timestamp += 16);
+                drags.Move(x, y, fileCount);
+            }
+            drags.End();
+            mouse.Button(false, false);
+
+            if (leakBytesPerDrag > 0) {
+                leaked.emplace_back(new char[leakBytesPerDrag]);
+                std::memset(leaked.back().get(), 1, leakBytesPerDrag);
+            }
+        }
+
+        mouse.Settle();
+        drags.Settle();
+
+        Sample sample;
+        sample.day = static_cast<double>(hour + 1) / 24;
+        sample.memory = FileCataloger::SampleProcessMemory();
+        sample.liveSessions = g_liveSessions.load();
+        sample.chunksAllocated = drags.cache().ChunksAllocated();
+        sample.cachedArenaBytes = drags.cache().CachedBytes();
+        sample.dispatcherPending = mouse.Pending();
+        sample.napiPendingCalls = NapiTestShim::PendingCalls();
+        sample.analysisQueued = drags.QueuedAnalysis();
+        samples.push_back(sample);
+
+        if ((hour + 1) % 24 == 0) {
+            std::printf("%5.0f %10.0f %10.0f %9lld %8llu %8.0f %10llu %8.1f\n",
+                        sample.day, Kb(sample.memory.residentBytes), Kb(sample.memory.heapInUseBytes),
+                        static_cast<long long>(sample.liveSessions),
+                        static_cast<unsigned long long>(sample.chunksAllocated),
+                        Kb(sample.cachedArenaBytes),
+                        static_cast<unsigned long long>(mouse.Batches()),
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+            std::fflush(stdout);
+        }
+    }
+
+    const uint64_t dropped = mouse.Dropped();
+    const uint64_t analysed = drags.Analysed();
+    const uint64_t analysisDropped = drags.AnalysisDropped();
+    mouse.Stop();
+    drags.Stop();
+    NapiTestShim::StopJsThread();
+    jsThread.join();
+
+    if (const char* csvPath = std::getenv("SOAK_CSV")) {
+        if (FILE* csv = std::fopen(csvPath, "w")) {
+            std::fprintf(csv, "day,rss_bytes,peak_bytes,heap_in_use_bytes,heap_mapped_bytes,live_sessions,"
+                              "arena_chunks_allocated,arena_cached_bytes,dispatcher_pending,napi_pending_calls,"
+                              "analysis_queued\n");
+            for (const Sample& s : samples) {
+                std::fprintf(csv, "%.4f,%llu,%llu,%llu,%llu,%lld,%llu,%llu,%llu,%llu,%zu\n", s.day,
+                             static_cast<unsigned long long>(s.memory.residentBytes),
+                             static_cast<unsigned long long>(s.memory.peakBytes),
+                             static_cast<unsigned long long>(s.memory.heapInUseBytes),
+                             static_cast<unsigned long long>(s.memory.heapMappedBytes),
+                             static_cast<long long>(s.liveSessions),
+                             static_cast<unsigned long long>(s.chunksAllocated),
+                             static_cast<unsigned long long>(s.cachedArenaBytes),
+                             static_cast<unsigned long long>(s.dispatcherPending),
+                             static_cast<unsigned long long>(s.napiPendingCalls), s.analysisQueued);
+            }
+            std::fclose(csv);
+        }
+    }
+
+    const double heapSlope = SlopePerDay(samples, warmupDays, [](const Sample& s) { return s.memory.heapInUseBytes; }) / 1024;
+    const double rssSlope = SlopePerDay(samples, warmupDays, [](const Sample& s) { return s.memory.residentBytes; }) / 1024;
+    const double chunkSlope = SlopePerDay(samples, warmupDays, [](const Sample& s) { return s.chunksAllocated; });
+    int64_t maxSessions = 0;
+    uint64_t maxPending = 0;
+    for (const Sample& s : samples) {
+        maxSessions = std::max(maxSessions, s.liveSessions);
+        maxPending = std::max(maxPending, s.dispatcherPending + s.analysisQueued);
+    }
+
+    std::printf("\nslope after day %.0f: heap %+.1f KB/day (max %.0f), rss %+.1f KB/day (max %.0f), "
+                "arena chunks %+.2f/day\n",
+                warmupDays, heapSlope, maxHeapKbPerDay, rssSlope, maxRssKbPerDay, chunkSlope);
+    std::printf("analysed %llu snapshots (%llu dropped), %llu mouse events dropped\n",
+                static_cast<unsigned long long>(analysed),
+                static_cast<unsigned long long>(analysisDropped),
+                static_cast<unsigned long long>(dropped));
+
+    bool ok = true;
+    if (heapSlope > maxHeapKbPerDay) {
+        std::fprintf(stderr, "FAIL: heap in use grows %.1f KB/day\n", heapSlope);
+        ok = false;
+    }
+    if (rssSlope > maxRssKbPerDay) {
+        std::fprintf(stderr, "FAIL: resident size grows %.1f KB/day\n", rssSlope);
+        ok = false;
+    }
+    if (chunkSlope > 1) {
+        std::fprintf(stderr, "FAIL: arena chunks keep coming from malloc (%.2f/day)\n", chunkSlope);
+        ok = false;
+    }
+    // Between hours only the last file drag's path session is alive
+    if (maxSessions > 1 || g_liveSessions.load() != 0) {
+        std::fprintf(stderr, "FAIL: %lld drag sessions alive at an idle point, %lld after stop\n",
+                     static_cast<long long>(maxSessions), static_cast<long long>(g_liveSessions.load()));
+        ok = false;
+    }
+    if (maxPending != 0 || NapiTestShim::LiveFunctions() != 0) {
+        std::fprintf(stderr, "FAIL: %llu queued items at an idle point, %llu threadsafe functions alive\n",
+                     static_cast<unsigned long long>(maxPending),
+                     static_cast<unsigned long long>(NapiTestShim::LiveFunctions()));
+        ok = false;
+    }
+
+    std::printf(ok ? "PASS\n" : "FAIL\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file test_support.h
+ * @brief Assertions and fixture helpers shared by the Linux test executables
+ *
+ * EXPECT(condition, format, ...) reports a failed condition with its file
+ * and line and counts it in g_failures; a test's main() prints PASS or
+ * FAIL from that count and returns it as the exit status. The fixture
+ * helpers end the test with exit status 2 when a fixture cannot be
+ * created, so a broken environment is not reported as a failed check.
+ *
+ * Header-only, included once per executable.
+ */
+
+#ifndef NATIVE_TEST_TEST_SUPPORT_H
+#define NATIVE_TEST_TEST_SUPPORT_H
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+inline int g_failures = 0;
+
+#define EXPECT(condition, ...)                                   \
+    do {                                                         \
+        if (!(condition)) {                                      \
+            std::fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            std::fprintf(stderr, __VA_ARGS__);                   \
+            std::fprintf(stderr, "\n");                          \
+            g_failures++;                                        \
+        }                                                        \
+    } while (0)
+
+// flags is O_TRUNC or O_APPEND; mode is applied whatever the umask
+inline void WriteFixture(const std::string& path, const void* data, size_t size, mode_t mode, int flags) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | flags, mode);
+    if (fd < 0 || write(fd, data, size) != static_cast<ssize_t>(size)) {
+        std::fprintf(stderr, "cannot write fixture %s\n", path.c_str());
+        std::exit(2);
+    }
+    close(fd);
+    chmod(path.c_str(), mode);
+}
+
+inline void WriteFile(const std::string& path, const std::string& data, mode_t mode = 0644) {
+    WriteFixture(path, data.data(), data.size(), mode, O_TRUNC);
+}
+
+inline void WriteFile(const std::string& path, const std::vector<uint8_t>& data) {
+    WriteFixture(path, data.data(), data.size(), 0644, O_TRUNC);
+}
+
+// size bytes of 'x'
+inline void WriteFile(const std::string& path, size_t size, int flags = O_TRUNC) {
+    const std::string data(size, 'x');
+    WriteFixture(path, data.data(), data.size(), 0644, flags);
+}
+
+inline void MakeDir(const std::string& path, mode_t mode = 0755) {
+    if (mkdir(path.c_str(), mode) != 0) {
+        std::fprintf(stderr, "cannot create fixture %s\n", path.c_str());
+        std::exit(2);
+    }
+}
+
+#endif // NATIVE_TEST_TEST_SUPPORT_H
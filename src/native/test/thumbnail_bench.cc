@@ -0,0 +1,288 @@
+/**
+ * @file thumbnail_bench.cc
+ * @brief Thumbnail pipeline benchmark over a photo corpus
+ *
+ * Compares, per image:
+ * - full-resolution decode + scalar resize (what a naive pipeline does)
+ * - full-resolution decode + SIMD resize
+ * - DCT-reduced decode + SIMD resize (the shipped pipeline)
+ * and the resize kernels alone, then runs the corpus through
+ * ThumbnailService with an empty and a warm disk cache.
+ *
+ * The corpus is every .jpg/.jpeg/.png in THUMB_BENCH_DIR, or a synthetic
+ * set of THUMB_BENCH_COUNT (default 12) 12MP JPEGs with photo-like noise.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run bench:thumbnails
+ *   THUMB_BENCH_DIR=~/Pictures npm run bench:thumbnails
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <jpeglib.h>
+
+#include "image_resize.h"
+#include "thumbnail_cache.h"
+#include "thumbnail_decoder.h"
+#include "thumbnail_service.h"
+
+using FileCataloger::DecodeOptions;
+using FileCataloger::DecodeThumbnail;
+using FileCataloger::ResizeKernel;
+using FileCataloger::RgbaDownscaler;
+using FileCataloger::Thumbnail;
+using FileCataloger::ThumbnailCache;
+using FileCataloger::ThumbnailPriority;
+using FileCataloger::ThumbnailResult;
+using FileCataloger::ThumbnailService;
+using FileCataloger::ThumbnailServiceOptions;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::vector<uint8_t> ReadFile(const std::string& path) {
+    std::vector<uint8_t> bytes;
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0) {
+        bytes.resize(static_cast<size_t>(st.st_size));
+        if (read(fd, bytes.data(), bytes.size()) != static_cast<ssize_t>(bytes.size())) {
+            bytes.clear();
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return bytes;
+}
+
+// Smooth shapes plus sensor-like noise, so files compress like photos (~3-5MB at 12MP)
+std::vector<uint8_t> SyntheticPhoto(uint32_t width, uint32_t height, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 6.0f);
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    const float fx = 6.2831853f / width * (1 + seed % 3);
+    const float fy = 6.2831853f / height * (2 + seed % 2);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t* p = &rgb[(static_cast<size_t>(y) * width + x) * 3];
+            float base = 128 + 60 * std::sin(x * fx) * std::cos(y * fy);
+            float values[3] = {base + 40.0f * x / width, base, base - 40.0f * y / height};
+            for (int c = 0; c < 3; c++) {
+                p[c] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, values[c] + noise(rng))));
+            }
+        }
+    }
+
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 92, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < height) {
+        JSAMPROW row = &rgb[static_cast<size_t>(cinfo.next_scanline) * width * 3];
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+
+    std::vector<uint8_t> out(buffer, buffer + size);
+    free(buffer);
+    return out;
+}
+
+std::vector<std::string> BuildCorpus(const std::string& work) {
+    std::vector<std::string> paths;
+    if (const char* dir = getenv("THUMB_BENCH_DIR")) {
+        if (DIR* handle = opendir(dir)) {
+            while (struct dirent* entry = readdir(handle)) {
+                std::string name = entry->d_name;
+                std::string lower = name;
+                for (auto& c : lower) c = static_cast<char>(tolower(c));
+                size_t dot = lower.rfind('.');
+                std::string ext = dot == std::string::npos ? "" : lower.substr(dot);
+                if (ext == ".jpg" || ext == ".jpeg" || ext == ".png") {
+                    paths.push_back(std::string(dir) + "/" + name);
+                }
+            }
+            closedir(handle);
+        }
+        return paths;
+    }
+
+    int count = getenv("THUMB_BENCH_COUNT") ? atoi(getenv("THUMB_BENCH_COUNT")) : 12;
+    for (int i = 0; i < count; i++) {
+        auto jpeg = SyntheticPhoto(4000, 3000, static_cast<uint32_t>(i));
+        std::string path = work + "/photo" + std::to_string(i) + ".jpg";
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || write(fd, jpeg.data(), jpeg.size()) != static_cast<ssize_t>(jpeg.size())) {
+            std::fprintf(stderr, "cannot write corpus file %s\n", path.c_str());
+            std::exit(2);
+        }
+        close(fd);
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+struct DecodeRun {
+    const char* name;
+    bool reduced;
+    ResizeKernel kernel;
+};
+
+void BenchDecode(const std::vector<std::vector<uint8_t>>& files) {
+    const DecodeRun runs[] = {
+        {"full decode + scalar resize", false, ResizeKernel::Scalar},
+        {"full decode + SIMD resize", false, ResizeKernel::Auto},
+        {"DCT-reduced decode + SIMD resize", true, ResizeKernel::Auto},
+    };
+
+    std::printf("\nDecode + resize to 256px, %zu images, one thread\n", files.size());
+    std::printf("  %-34s %10s %10s\n", "pipeline", "ms/image", "images/s");
+    for (const auto& run : runs) {
+        DecodeOptions options;
+        options.reducedDecode = run.reduced;
+        options.kernel = run.kernel;
+        auto start = Clock::now();
+        for (const auto& file : files) {
+            Thumbnail thumbnail;
+            std::string error;
+            if (!DecodeThumbnail(file.data(), file.size(), options, &thumbnail, &error)) {
+                std::fprintf(stderr, "decode failed: %s\n", error.c_str());
+            }
+        }
+        double ms = MsSince(start) / files.size();
+        std::printf("  %-34s %10.1f %10.1f\n", run.name, ms, 1000.0 / ms);
+    }
+}
+
+void BenchResize() {
+    const uint32_t width = 4000;
+    const uint32_t height = 3000;
+    std::vector<uint8_t> rgba(static_cast<size_t>(width) * 4);
+    std::mt19937 rng(7);
+    for (auto& value : rgba) {
+        value = static_cast<uint8_t>(rng());
+    }
+    std::vector<uint8_t> out(256 * 192 * 4);
+
+    std::printf("\nResize only, %ux%u -> 256x192\n", width, height);
+    std::printf("  %-34s %10s %10s\n", "kernel", "ms", "Mpixel/s");
+    for (ResizeKernel kernel : {ResizeKernel::Scalar, ResizeKernel::Auto}) {
+        const int iterations = 5;
+        auto start = Clock::now();
+        for (int i = 0; i < iterations; i++) {
+            RgbaDownscaler scaler(width, height, 256, 192, false, kernel);
+            for (uint32_t y = 0; y < height; y++) {
+                scaler.PushRow(rgba.data());
+            }
+            scaler.Finish(out.data());
+        }
+        double ms = MsSince(start) / iterations;
+        std::printf("  %-34s %10.1f %10.1f\n", kernel == ResizeKernel::Scalar ? "scalar" : "SIMD", ms,
+                    width * static_cast<double>(height) / ms / 1000.0);
+    }
+}
+
+double RunService(const std::vector<std::string>& paths, const std::string& cacheDir, size_t* cached) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t done = 0;
+    *cached = 0;
+
+    auto cache = std::make_shared<ThumbnailCache>(cacheDir);
+    ThumbnailServiceOptions options;
+    ThumbnailService service(cache, options, [&](ThumbnailResult&& result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done++;
+        *cached += result.cached ? 1 : 0;
+        cv.notify_one();
+    });
+
+    auto start = Clock::now();
+    for (const auto& path : paths) {
+        service.Request(path, ThumbnailPriority::Visible);
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return done == paths.size(); });
+    return MsSince(start);
+}
+
+void BenchService(const std::vector<std::string>& paths, const std::string& work) {
+    std::printf("\nThumbnailService, %zu images, %zu workers\n", paths.size(),
+                ThumbnailService(std::make_shared<ThumbnailCache>(std::string()), ThumbnailServiceOptions(),
+                                 [](ThumbnailResult&&) {}).WorkerCount());
+    std::printf("  %-34s %10s %10s %8s\n", "cache", "total ms", "ms/image", "hits");
+    const std::string cacheDir = work + "/cache";
+    size_t cached = 0;
+    double cold = RunService(paths, cacheDir, &cached);
+    std::printf("  %-34s %10.1f %10.2f %8zu\n", "empty", cold, cold / paths.size(), cached);
+    // A new cache object: content keys are rehashed, entries come from disk
+    double warm = RunService(paths, cacheDir, &cached);
+    std::printf("  %-34s %10.1f %10.2f %8zu\n", "warm (after restart)", warm, warm / paths.size(), cached);
+}
+
+} // namespace
+
+int main() {
+    char work[] = "/tmp/thumbnail_bench_XXXXXX";
+    if (!mkdtemp(work)) {
+        std::fprintf(stderr, "cannot create work directory\n");
+        return 2;
+    }
+
+    auto start = Clock::now();
+    std::vector<std::string> paths = BuildCorpus(work);
+    if (paths.empty()) {
+        std::fprintf(stderr, "empty corpus\n");
+        return 2;
+    }
+    std::vector<std::vector<uint8_t>> files;
+    uint64_t bytes = 0;
+    for (const auto& path : paths) {
+        files.push_back(ReadFile(path));
+        bytes += files.back().size();
+    }
+    std::printf("Corpus: %zu images, %.1f MB (prepared in %.0f ms), SIMD kernels: %s\n", files.size(),
+                bytes / 1048576.0, MsSince(start), RgbaDownscaler::HasSimd() ? "yes" : "no");
+
+    BenchDecode(files);
+    BenchResize();
+    BenchService(paths, work);
+
+    std::string cleanup = std::string("rm -rf '") + work + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", work);
+    }
+    return 0;
+}
@@ -0,0 +1,670 @@
+/**
+ * @file thumbnail_test.cc
+ * @brief Functional test for the thumbnail pipeline
+ *
+ * Checks that the SIMD and scalar resize kernels agree bit for bit, that
+ * the box filter keeps flat areas flat and weights color by alpha, EXIF
+ * orientation, JPEG (reduced and full decode, orientation tag) and PNG
+ * (plain and interlaced) decoding, the content hash and its cancellation
+ * between chunks, that the disk cache hits for a copy of a file under
+ * another name, and the service's priorities, bounded queue and error
+ * reporting. The indexed heap behind
+ * the queue is checked against a sorted reference through random pushes,
+ * re-ranks, erases and bulk re-ranks; the service coalesces requests for
+ * one path and follows viewport updates.
+ *
+ * Fixture images are encoded with libjpeg and libpng at run time.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <jpeglib.h>
+#include <png.h>
+
+#include "image_resize.h"
+#include "indexed_heap.h"
+#include "test_support.h"
+#include "thumbnail_cache.h"
+#include "thumbnail_decoder.h"
+#include "thumbnail_service.h"
+
+using FileCataloger::ApplyExifOrientation;
+using FileCataloger::CancellationSource;
+using FileCataloger::CancellationToken;
+using FileCataloger::DecodeOptions;
+using FileCataloger::DecodeThumbnail;
+using FileCataloger::HashContent;
+using FileCataloger::IndexedHeap;
+using FileCataloger::MakeRank;
+using FileCataloger::ResizeKernel;
+using FileCataloger::RgbaDownscaler;
+using FileCataloger::Thumbnail;
+using FileCataloger::ThumbnailCache;
+using FileCataloger::ThumbnailPriority;
+using FileCataloger::ThumbnailResult;
+using FileCataloger::ThumbnailService;
+using FileCataloger::ThumbnailServiceOptions;
+
+namespace {
+
+// ---- fixtures ----
+
+std::vector<uint8_t> Gradient(uint32_t width, uint32_t height) {
+    std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t* p = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+            p[0] = static_cast<uint8_t>(x * 255 / (width - 1));
+            p[1] = static_cast<uint8_t>(y * 255 / (height - 1));
+            p[2] = 128;
+            p[3] = 255;
+        }
+    }
+    return rgba;
+}
+
+std::vector<uint8_t> EncodeJpeg(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height,
+                                int orientation = 0) {
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    jpeg_mem_dest(&cinfo, &buffer, &size);
+    cinfo.image_width = width;
+    cinfo.image_height = height;
+    cinfo.input_components = 4;
+    cinfo.in_color_space = JCS_EXT_RGBA;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 90, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    if (orientation) {
+        // Little-endian TIFF header with a single IFD0 entry: Orientation (SHORT)
+        const uint8_t exif[] = {
+            'E', 'x', 'i', 'f', 0, 0,
+            'I', 'I', 42, 0, 8, 0, 0, 0,
+            1, 0,
+            0x12, 0x01, 3, 0, 1, 0, 0, 0, static_cast<uint8_t>(orientation), 0, 0, 0,
+            0, 0, 0, 0
+        };
+        jpeg_write_marker(&cinfo, JPEG_APP0 + 1, exif, sizeof(exif));
+    }
+
+    while (cinfo.next_scanline < height) {
+        JSAMPROW row = const_cast<uint8_t*>(&rgba[static_cast<size_t>(cinfo.next_scanline) * width * 4]);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+
+    std::vector<uint8_t> out(buffer, buffer + size);
+    free(buffer);
+    return out;
+}
+
+void AppendPng(png_structp png, png_bytep data, png_size_t length) {
+    auto* out = static_cast<std::vector<uint8_t>*>(png_get_io_ptr(png));
+    out->insert(out->end(), data, data + length);
+}
+
+std::vector<uint8_t> EncodePng(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, bool interlaced) {
+    std::vector<uint8_t> out;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    png_set_write_fn(png, &out, AppendPng, nullptr);
+    png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGBA,
+                 interlaced ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    std::vector<png_bytep> rows(height);
+    for (uint32_t y = 0; y < height; y++) {
+        rows[y] = const_cast<uint8_t*>(&rgba[static_cast<size_t>(y) * width * 4]);
+    }
+    png_set_rows(png, info, rows.data());
+    png_write_png(png, info, PNG_TRANSFORM_IDENTITY, nullptr);
+    png_destroy_write_struct(&png, &info);
+    return out;
+}
+
+void WriteBytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, bytes.data(), bytes.size()) != static_cast<ssize_t>(bytes.size())) {
+        std::fprintf(stderr, "cannot write fixture %s\n", path.c_str());
+        std::exit(2);
+    }
+    close(fd);
+}
+
+std::vector<uint8_t> Resize(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height,
+                            uint32_t dstWidth, uint32_t dstHeight, bool premultiply, ResizeKernel kernel) {
+    RgbaDownscaler scaler(width, height, dstWidth, dstHeight, premultiply, kernel);
+    for (uint32_t y = 0; y < height; y++) {
+        scaler.PushRow(&rgba[static_cast<size_t>(y) * width * 4]);
+    }
+    std::vector<uint8_t> out(static_cast<size_t>(dstWidth) * dstHeight * 4);
+    scaler.Finish(out.data());
+    return out;
+}
+
+double MeanAbsDifference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    double sum = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        sum += std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i]));
+    }
+    return a.empty() ? 0 : sum / a.size();
+}
+
+// ---- resize ----
+
+void TestKernelsAgree() {
+    std::mt19937 rng(42);
+    const uint32_t sizes[][4] = {
+        {997, 613, 256, 157}, {300, 300, 7, 3}, {64, 48, 64, 48}, {1000, 3, 17, 1}, {5, 900, 2, 255}
+    };
+    for (const auto& size : sizes) {
+        std::vector<uint8_t> rgba(static_cast<size_t>(size[0]) * size[1] * 4);
+        for (auto& value : rgba) {
+            value = static_cast<uint8_t>(rng());
+        }
+        for (bool premultiply : {false, true}) {
+            auto simd = Resize(rgba, size[0], size[1], size[2], size[3], premultiply, ResizeKernel::Auto);
+            auto scalar = Resize(rgba, size[0], size[1], size[2], size[3], premultiply, ResizeKernel::Scalar);
+            EXPECT(simd == scalar, "kernels differ for %ux%u -> %ux%u", size[0], size[1], size[2], size[3]);
+        }
+    }
+    EXPECT(RgbaDownscaler::HasSimd(), "no SIMD kernel on this target");
+}
+
+void TestBoxFilter() {
+    // Flat color stays exactly flat at a non-integer ratio
+    std::vector<uint8_t> flat(333 * 211 * 4);
+    for (size_t i = 0; i < flat.size(); i += 4) {
+        flat[i] = 200; flat[i + 1] = 17; flat[i + 2] = 99; flat[i + 3] = 255;
+    }
+    auto out = Resize(flat, 333, 211, 50, 31, false, ResizeKernel::Auto);
+    bool same = true;
+    for (size_t i = 0; i < out.size(); i += 4) {
+        same = same && out[i] == 200 && out[i + 1] == 17 && out[i + 2] == 99 && out[i + 3] == 255;
+    }
+    EXPECT(same, "flat image changed");
+
+    // 4x4 -> 2x2 averages each 2x2 block
+    std::vector<uint8_t> blocks(4 * 4 * 4, 255);
+    for (uint32_t y = 0; y < 4; y++) {
+        for (uint32_t x = 0; x < 4; x++) {
+            blocks[(y * 4 + x) * 4] = static_cast<uint8_t>(x * 10 + y * 40);
+        }
+    }
+    out = Resize(blocks, 4, 4, 2, 2, false, ResizeKernel::Auto);
+    EXPECT(out[0] == 25 && out[4] == 45 && out[8] == 105 && out[12] == 125,
+           "block averages %u %u %u %u", out[0], out[4], out[8], out[12]);
+
+    // A transparent pixel contributes no color
+    std::vector<uint8_t> edge = {255, 0, 0, 0, 0, 255, 0, 255};
+    out = Resize(edge, 2, 1, 1, 1, true, ResizeKernel::Auto);
+    EXPECT(out[0] == 0 && out[1] == 255 && out[2] == 0 && out[3] == 128,
+           "premultiplied edge %u %u %u %u", out[0], out[1], out[2], out[3]);
+}
+
+void TestOrientation() {
+    // 2x3 image whose red channel is the pixel index
+    std::vector<uint8_t> rgba(2 * 3 * 4, 255);
+    for (int i = 0; i < 6; i++) {
+        rgba[i * 4] = static_cast<uint8_t>(i);
+    }
+    const int expected[9][6] = {
+        {}, {0, 1, 2, 3, 4, 5}, {1, 0, 3, 2, 5, 4}, {5, 4, 3, 2, 1, 0}, {4, 5, 2, 3, 0, 1},
+        {0, 2, 4, 1, 3, 5}, {4, 2, 0, 5, 3, 1}, {5, 3, 1, 4, 2, 0}, {1, 3, 5, 0, 2, 4}
+    };
+    for (int orientation = 1; orientation <= 8; orientation++) {
+        auto image = rgba;
+        uint32_t width = 2;
+        uint32_t height = 3;
+        ApplyExifOrientation(&image, &width, &height, orientation);
+        bool match = orientation >= 5 ? (width == 3 && height == 2) : (width == 2 && height == 3);
+        for (int i = 0; i < 6; i++) {
+            match = match && image[i * 4] == expected[orientation][i];
+        }
+        EXPECT(match, "orientation %d", orientation);
+    }
+}
+
+// ---- decode ----
+
+void TestJpeg() {
+    auto source = Gradient(1600, 1200);
+    auto jpeg = EncodeJpeg(source, 1600, 1200);
+
+    DecodeOptions options;
+    Thumbnail reduced, full;
+    std::string error;
+    EXPECT(DecodeThumbnail(jpeg.data(), jpeg.size(), options, &reduced, &error), "reduced decode: %s", error.c_str());
+    options.reducedDecode = false;
+    EXPECT(DecodeThumbnail(jpeg.data(), jpeg.size(), options, &full, &error), "full decode: %s", error.c_str());
+
+    EXPECT(reduced.width == 256 && reduced.height == 192, "thumbnail %ux%u", reduced.width, reduced.height);
+    EXPECT(reduced.sourceWidth == 1600 && reduced.sourceHeight == 1200, "source %ux%u",
+           reduced.sourceWidth, reduced.sourceHeight);
+    EXPECT(full.width == reduced.width && full.height == reduced.height, "full decode size differs");
+
+    auto expected = Resize(source, 1600, 1200, 256, 192, false, ResizeKernel::Auto);
+    EXPECT(MeanAbsDifference(reduced.rgba, expected) < 3.0, "reduced decode differs by %.2f",
+           MeanAbsDifference(reduced.rgba, expected));
+    EXPECT(MeanAbsDifference(full.rgba, expected) < 3.0, "full decode differs by %.2f",
+           MeanAbsDifference(full.rgba, expected));
+
+    // Orientation 6: stored landscape, displayed portrait with the left edge on top
+    auto rotated = EncodeJpeg(source, 1600, 1200, 6);
+    Thumbnail portrait;
+    options.reducedDecode = true;
+    EXPECT(DecodeThumbnail(rotated.data(), rotated.size(), options, &portrait, &error), "rotated: %s", error.c_str());
+    EXPECT(portrait.width == 192 && portrait.height == 256, "rotated thumbnail %ux%u", portrait.width, portrait.height);
+    EXPECT(portrait.sourceWidth == 1200 && portrait.sourceHeight == 1600, "rotated source %ux%u",
+           portrait.sourceWidth, portrait.sourceHeight);
+    // Top-right of the rotated thumbnail is the stored top-left: red and green near 0
+    const uint8_t* corner = &portrait.rgba[(191) * 4];
+    EXPECT(corner[0] < 16 && corner[1] < 16, "rotated corner %u %u", corner[0], corner[1]);
+
+    // Small images are never upscaled
+    auto small = EncodeJpeg(Gradient(40, 30), 40, 30);
+    Thumbnail tiny;
+    EXPECT(DecodeThumbnail(small.data(), small.size(), options, &tiny, &error) && tiny.width == 40 && tiny.height == 30,
+           "small image %ux%u", tiny.width, tiny.height);
+}
+
+void TestPng() {
+    const uint32_t width = 500;
+    const uint32_t height = 300;
+    auto rgba = Gradient(width, height);
+    for (size_t i = 3; i < rgba.size(); i += 4) {
+        rgba[i] = static_cast<uint8_t>((i / 4) % width * 255 / (width - 1));
+    }
+
+    Thumbnail plain, interlaced;
+    std::string error;
+    DecodeOptions options;
+    options.maxSize = 100;
+    auto png = EncodePng(rgba, width, height, false);
+    auto adam7 = EncodePng(rgba, width, height, true);
+    EXPECT(DecodeThumbnail(png.data(), png.size(), options, &plain, &error), "png: %s", error.c_str());
+    EXPECT(DecodeThumbnail(adam7.data(), adam7.size(), options, &interlaced, &error), "interlaced: %s", error.c_str());
+    EXPECT(plain.width == 100 && plain.height == 60, "png thumbnail %ux%u", plain.width, plain.height);
+    EXPECT(plain.rgba == interlaced.rgba, "interlaced png decodes differently");
+    EXPECT(plain.rgba == Resize(rgba, width, height, 100, 60, true, ResizeKernel::Auto), "png pixels differ");
+}
+
+void TestCorrupt() {
+    Thumbnail thumbnail;
+    std::string error;
+    DecodeOptions options;
+
+    std::vector<uint8_t> text = {'h', 'e', 'l', 'l', 'o'};
+    EXPECT(!DecodeThumbnail(text.data(), text.size(), options, &thumbnail, &error), "text decoded");
+
+    auto jpeg = EncodeJpeg(Gradient(64, 64), 64, 64);
+    for (size_t i = 20; i < jpeg.size(); i++) {
+        jpeg[i] = static_cast<uint8_t>(i * 7);
+    }
+    error.clear();
+    bool decoded = DecodeThumbnail(jpeg.data(), jpeg.size(), options, &thumbnail, &error);
+    EXPECT(!decoded && !error.empty(), "garbage JPEG decoded");
+
+    auto png = EncodePng(Gradient(64, 64), 64, 64, false);
+    png.resize(png.size() / 2);
+    error.clear();
+    EXPECT(!DecodeThumbnail(png.data(), png.size(), options, &thumbnail, &error) && !error.empty(),
+           "truncated PNG decoded");
+}
+
+void TestHash() {
+    EXPECT(HashContent(nullptr, 0) == 0xEF46DB3751D8E999ull, "XXH64 of empty input");
+    const char* abc = "abc";
+    EXPECT(HashContent(reinterpret_cast<const uint8_t*>(abc), 3) == 0x44BC2CF5AD770999ull, "XXH64 of abc");
+
+    // The chunked form polls its token between chunks and agrees with the one-shot hash
+    std::vector<uint8_t> large(3 * FileCataloger::HASH_CHUNK_BYTES + 100);
+    for (size_t i = 0; i < large.size(); i++) {
+        large[i] = static_cast<uint8_t>(i * 131 + (i >> 12));
+    }
+    uint64_t hash = 0;
+    EXPECT(HashContent(large.data(), large.size(), CancellationToken(), &hash) &&
+               hash == HashContent(large.data(), large.size()),
+           "chunked hash matches");
+    CancellationSource source;
+    source.Cancel();
+    EXPECT(!HashContent(large.data(), large.size(), source.Token(), &hash), "cancelled hash stops");
+    EXPECT(HashContent(reinterpret_cast<const uint8_t*>(abc), 3, source.Token(), &hash) &&
+               hash == 0x44BC2CF5AD770999ull,
+           "input under one chunk is hashed before the token is polled");
+}
+
+// ---- service ----
+
+class Collector {
+public:
+    void Add(ThumbnailResult&& result) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.push_back(std::move(result));
+        cv_.notify_all();
+    }
+
+    std::vector<ThumbnailResult> WaitFor(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return results_.size() >= count; });
+        std::vector<ThumbnailResult> results = std::move(results_);
+        results_.clear();
+        return results;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<ThumbnailResult> results_;
+};
+
+void TestServiceCache(const std::string& base) {
+    auto jpeg = EncodeJpeg(Gradient(800, 600), 800, 600);
+    WriteBytes(base + "/photo.jpg", jpeg);
+    WriteBytes(base + "/copy.jpg", jpeg);
+
+    auto cache = std::make_shared<ThumbnailCache>(base + "/cache");
+    Collector collector;
+    ThumbnailServiceOptions options;
+    options.workers = 2;
+    ThumbnailService service(cache, options, [&](ThumbnailResult&& result) { collector.Add(std::move(result)); });
+
+    uint64_t first = service.Request(base + "/photo.jpg", ThumbnailPriority::Visible);
+    auto results = collector.WaitFor(1);
+    EXPECT(results[0].id == first && results[0].error.empty() && !results[0].cached, "first request: %s",
+           results[0].error.c_str());
+    EXPECT(results[0].thumbnail.width == 256 && results[0].thumbnail.height == 192, "service thumbnail size");
+
+    // Same bytes under another name hit the content-keyed cache
+    service.Request(base + "/copy.jpg", ThumbnailPriority::Visible);
+    auto copy = collector.WaitFor(1);
+    EXPECT(copy[0].cached, "copy was not served from the cache");
+    EXPECT(copy[0].thumbnail.rgba == results[0].thumbnail.rgba, "cached pixels differ");
+    EXPECT(cache->Hits() == 1, "hits %llu", static_cast<unsigned long long>(cache->Hits()));
+
+    // A changed file is a new key, even at the same path
+    WriteBytes(base + "/photo.jpg", EncodeJpeg(Gradient(640, 640), 640, 640));
+    service.Request(base + "/photo.jpg", ThumbnailPriority::Visible);
+    auto changed = collector.WaitFor(1);
+    EXPECT(!changed[0].cached && changed[0].thumbnail.height == 256, "changed file served stale thumbnail");
+
+    service.Request(base + "/missing.jpg", ThumbnailPriority::Visible);
+    auto missing = collector.WaitFor(1);
+    EXPECT(missing[0].errorCode == ENOENT, "missing file errno %d", missing[0].errorCode);
+
+    WriteBytes(base + "/notes.txt", {'n', 'o', 't', 'e', 's'});
+    service.Request(base + "/notes.txt", ThumbnailPriority::Visible);
+    auto unsupported = collector.WaitFor(1);
+    EXPECT(unsupported[0].errorCode == 0 && !unsupported[0].error.empty(), "text file produced a thumbnail");
+
+    // A FIFO is refused without waiting for a writer
+    mkfifo((base + "/pipe.jpg").c_str(), 0644);
+    service.Request(base + "/pipe.jpg", ThumbnailPriority::Visible);
+    auto fifo = collector.WaitFor(1);
+    EXPECT(fifo[0].errorCode == EISDIR, "FIFO errno %d", fifo[0].errorCode);
+
+    // A cancelled token stops a new file's content hash; nothing is remembered
+    std::vector<uint8_t> large = EncodeJpeg(Gradient(1600, 1200), 1600, 1200);
+    large.resize(2 * FileCataloger::HASH_CHUNK_BYTES, 0);
+    WriteBytes(base + "/large.jpg", large);
+    CancellationSource source;
+    source.Cancel();
+    ThumbnailResult stopped = service.Generate(base + "/large.jpg", source.Token());
+    EXPECT(stopped.cancelled && stopped.error.empty() && stopped.thumbnail.width == 0, "cancelled generate");
+    EXPECT(!service.Generate(base + "/large.jpg").cancelled, "generate after a cancelled one");
+
+    // A fresh cache object finds the entries on disk
+    auto reopened = std::make_shared<ThumbnailCache>(base + "/cache");
+    ThumbnailService again(reopened, options, [&](ThumbnailResult&& result) { collector.Add(std::move(result)); });
+    again.Request(base + "/copy.jpg", ThumbnailPriority::Visible);
+    EXPECT(collector.WaitFor(1)[0].cached, "disk cache not reused after reopen");
+}
+
+void TestServiceQueue(const std::string& base) {
+    auto jpeg = EncodeJpeg(Gradient(1200, 900), 1200, 900);
+    for (int i = 0; i < 12; i++) {
+        // Distinct content so nothing is served from the cache
+        auto bytes = jpeg;
+        bytes.push_back(static_cast<uint8_t>(i));
+        WriteBytes(base + "/queue" + std::to_string(i) + ".jpg", bytes);
+    }
+
+    auto cache = std::make_shared<ThumbnailCache>(std::string());
+    Collector collector;
+    ThumbnailServiceOptions options;
+    options.workers = 1;
+    options.maxQueued = 8;
+    ThumbnailService service(cache, options, [&](ThumbnailResult&& result) { collector.Add(std::move(result)); });
+
+    std::vector<uint64_t> background;
+    for (int i = 0; i < 10; i++) {
+        background.push_back(service.Request(base + "/queue" + std::to_string(i) + ".jpg",
+                                             ThumbnailPriority::Background));
+    }
+    uint64_t visible = service.Request(base + "/queue10.jpg", ThumbnailPriority::Visible);
+    uint64_t promoted = background.back();
+    service.SetPriority(promoted, ThumbnailPriority::Visible);
+    uint64_t cancelled = background[background.size() - 2];
+    EXPECT(service.Cancel(cancelled), "cancel of a queued request failed");
+
+    auto results = collector.WaitFor(11);
+    EXPECT(results.size() == 11, "%zu results for 11 requests", results.size());
+
+    size_t visibleAt = results.size(), promotedAt = results.size(), firstBackgroundDone = results.size();
+    size_t dropped = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        if (result.id == visible) visibleAt = i;
+        if (result.id == promoted) promotedAt = i;
+        if (result.cancelled && result.id != cancelled) dropped++;
+        if (!result.cancelled && result.id != visible && result.id != promoted && firstBackgroundDone == results.size()) {
+            firstBackgroundDone = i;
+        }
+        EXPECT(result.cancelled || result.error.empty(), "request %llu failed: %s",
+               static_cast<unsigned long long>(result.id), result.error.c_str());
+    }
+    // The worker may have started one background request before the others arrived
+    EXPECT(dropped >= 1, "bounded queue dropped nothing");
+    EXPECT(visibleAt < promotedAt, "visible request not served first");
+    EXPECT(promotedAt < results.size(), "promoted request missing");
+    EXPECT(service.Cancel(cancelled) == false, "finished request cancelled twice");
+}
+
+void TestIndexedHeap() {
+    IndexedHeap<uint32_t, uint32_t> heap;
+    std::map<uint32_t, uint64_t> reference;   // key -> rank
+    std::mt19937 random(7);
+    uint64_t sequence = 0;
+
+    auto popMatches = [&] {
+        auto best = reference.begin();
+        for (auto it = reference.begin(); it != reference.end(); ++it) {
+            if (it->second < best->second) best = it;
+        }
+        auto entry = heap.Pop();
+        bool ok = entry.key == best->first && entry.rank == best->second && entry.value == entry.key * 3;
+        reference.erase(best);
+        return ok;
+    };
+
+    int mismatches = 0;
+    for (int step = 0; step < 20000; step++) {
+        uint32_t key = random() % 500;
+        uint64_t rank = MakeRank(random() % 4, sequence++);
+        switch (random() % 6) {
+        case 0:
+        case 1:
+            if (heap.Push(key, key * 3, rank) != (reference.count(key) == 0)) mismatches++;
+            reference.emplace(key, rank);
+            break;
+        case 2:
+            if (heap.Update(key, rank) != (reference.count(key) != 0)) mismatches++;
+            if (reference.count(key)) reference[key] = rank;
+            break;
+        case 3:
+            if (heap.Erase(key) != (reference.erase(key) != 0)) mismatches++;
+            break;
+        case 4:
+            if (!reference.empty() && !popMatches()) mismatches++;
+            break;
+        default:
+            if (step % 50 == 0) {
+                // Bulk: every odd key moves to band 0, in key order
+                heap.RerankAll([&](const uint32_t& k, uint32_t&, uint64_t& r) {
+                    if (k % 2) r = MakeRank(0, (1ull << 39) + k);
+                });
+                for (auto& [k, r] : reference) {
+                    if (k % 2) r = MakeRank(0, (1ull << 39) + k);
+                }
+            }
+        }
+        if (heap.Size() != reference.size()) {
+            mismatches++;
+        }
+    }
+    while (!reference.empty()) {
+        if (!popMatches()) mismatches++;
+    }
+    EXPECT(mismatches == 0, "indexed heap disagreed with the reference %d times", mismatches);
+    EXPECT(heap.Empty(), "heap not empty after draining");
+
+    heap.Push(1, 0, MakeRank(3, 10));
+    heap.Push(2, 0, MakeRank(3, 5));
+    heap.Push(3, 0, MakeRank(1, 1));
+    EXPECT(heap.OldestOfLastBand()->key == 2, "victim is not the oldest of the last band");
+}
+
+void TestServiceCoalesce(const std::string& base) {
+    auto jpeg = EncodeJpeg(Gradient(1200, 900), 1200, 900);
+    WriteBytes(base + "/blocker.jpg", jpeg);
+    jpeg.push_back(1);
+    WriteBytes(base + "/shared.jpg", jpeg);
+
+    auto cache = std::make_shared<ThumbnailCache>(base + "/coalesce-cache");
+    Collector collector;
+    ThumbnailServiceOptions options;
+    options.workers = 1;
+    ThumbnailService service(cache, options, [&](ThumbnailResult&& result) { collector.Add(std::move(result)); });
+
+    service.Request(base + "/blocker.jpg", ThumbnailPriority::Visible);
+    uint64_t first = service.Request(base + "/shared.jpg", ThumbnailPriority::Background);
+    uint64_t second = service.Request(base + "/shared.jpg", ThumbnailPriority::Visible);
+    uint64_t third = service.Request(base + "/shared.jpg", ThumbnailPriority::Visible);
+    EXPECT(service.QueuedCount() <= 2, "%zu jobs queued for two paths", service.QueuedCount());
+    EXPECT(service.Cancel(third), "cancel of a coalesced request failed");
+
+    auto results = collector.WaitFor(4);
+    size_t served = 0;
+    for (const auto& result : results) {
+        if (result.id == third) {
+            EXPECT(result.cancelled, "cancelled coalesced request got a thumbnail");
+        } else if (result.id == first || result.id == second) {
+            EXPECT(!result.cancelled && result.thumbnail.width == 256, "coalesced request %llu not served",
+                   static_cast<unsigned long long>(result.id));
+            served++;
+        }
+    }
+    EXPECT(served == 2, "%zu of 2 coalesced requests served", served);
+    // One decode each for the blocker and the shared path
+    EXPECT(cache->Misses() == 2 && cache->Hits() == 0, "misses %llu hits %llu",
+           static_cast<unsigned long long>(cache->Misses()), static_cast<unsigned long long>(cache->Hits()));
+}
+
+void TestServiceViewport(const std::string& base) {
+    auto jpeg = EncodeJpeg(Gradient(1600, 1200), 1600, 1200);
+    for (int i = 0; i < 7; i++) {
+        auto bytes = jpeg;
+        bytes.push_back(static_cast<uint8_t>(100 + i));
+        WriteBytes(base + "/row" + std::to_string(i) + ".jpg", bytes);
+    }
+
+    auto cache = std::make_shared<ThumbnailCache>(std::string());
+    Collector collector;
+    ThumbnailServiceOptions options;
+    options.workers = 1;
+    ThumbnailService service(cache, options, [&](ThumbnailResult&& result) { collector.Add(std::move(result)); });
+
+    // row0 occupies the worker while the rest are queued and reordered
+    uint64_t blocker = service.Request(base + "/row0.jpg", ThumbnailPriority::Visible);
+    while (service.QueuedCount() != 0) {
+        std::this_thread::yield();
+    }
+    std::vector<uint64_t> ids(7);
+    ids[0] = blocker;
+    for (int i = 1; i < 7; i++) {
+        ids[i] = service.Request(base + "/row" + std::to_string(i) + ".jpg",
+                                 i == 6 ? ThumbnailPriority::Visible : ThumbnailPriority::Background);
+    }
+    // Scrolled: row6 is gone from view, rows 4 and 2 are visible, row5 is hovered
+    size_t queued = service.Prioritize({{base + "/row4.jpg", ThumbnailPriority::Visible},
+                                        {base + "/row2.jpg", ThumbnailPriority::Visible},
+                                        {base + "/row5.jpg", ThumbnailPriority::Hovered},
+                                        {base + "/missing.jpg", ThumbnailPriority::Visible}});
+    EXPECT(queued == 3, "prioritize matched %zu queued paths", queued);
+
+    auto results = collector.WaitFor(7);
+    std::vector<uint64_t> order;
+    for (const auto& result : results) {
+        order.push_back(result.id);
+    }
+    // Hovered, visible in the order given, then background in request order
+    std::vector<uint64_t> expected = {ids[0], ids[5], ids[4], ids[2], ids[1], ids[3], ids[6]};
+    EXPECT(order == expected, "viewport order not followed");
+}
+
+std::string MakeBase() {
+    char base[] = "/tmp/thumbnail_test_XXXXXX";
+    if (!mkdtemp(base)) {
+        std::fprintf(stderr, "cannot create fixture directory\n");
+        std::exit(2);
+    }
+    return base;
+}
+
+} // namespace
+
+int main() {
+    std::string base = MakeBase();
+
+    TestKernelsAgree();
+    TestBoxFilter();
+    TestOrientation();
+    TestJpeg();
+    TestPng();
+    TestCorrupt();
+    TestHash();
+    TestIndexedHeap();
+    TestServiceCache(base);
+    TestServiceQueue(base);
+    TestServiceCoalesce(base);
+    TestServiceViewport(base);
+
+    std::string cleanup = "rm -rf '" + base + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", base.c_str());
+    }
+
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,719 @@
+/**
+ * @file xinput_latency_bench.cc
+ * @brief End-to-end input latency under Xvfb with XTest-injected events
+ *
+ * Measures "input event -> JS callback" for the parts of the mouse tracker
+ * and drag monitor that build on Linux, with the OS input path in front of
+ * them instead of synthetic pushes:
+ *
+ *   injector --XTest--> Xvfb --XInput2--> tap thread --> BatchedDispatcher
+ *     --> stand-in JS thread (napi_test_shim.h)
+ *                                     \--> DragSession --> analysis thread
+ *
+ * The tap thread plays the event tap: it reads XI2 motion and button events
+ * from the root window and does what QueueMouseEvent, QueueButtonEvent and
+ * the drag branch of DragEventCallback do. Every injected motion goes to a
+ * distinct pixel, so whoever sees it can tell which injection it was and
+ * take the latency from the injector's timestamp. Button events cannot be
+ * merged by anyone and are matched in order.
+ *
+ * Recorded per batching configuration and injection rate:
+ *   move      injection -> drain that hands the move to JS (DeliverBatch
+ *             hands JS the newest move of a batch; older ones are coalesced)
+ *   button    injection -> drain, high priority lane
+ *   analysis  injection of a drag's 10th move -> its snapshot analysed
+ *   seen / dropped / coalesced   motions that reached the tap, that never
+ *             did, and that reached it but were not handed to JS
+ * Latencies are reported as p50, p99, max and standard deviation (jitter)
+ * in microseconds; XINPUT_BENCH_SAVE keeps every sample for plotting.
+ *
+ * Motion is injected at each rate in XINPUT_BENCH_RATES with a drag every
+ * 200 events: press, 100 moves, release. Each configuration gets a fresh
+ * dispatcher with its maxLatency and maxBatchSize:
+ *   immediate  0ms, 1    drain per event
+ *   4ms        4ms, 16
+ *   default    16ms, 64  what the tracker ships with
+ *
+ * Environment (defaults in brackets):
+ *   XINPUT_BENCH_EVENTS    motion events per configuration and rate [5000]
+ *   XINPUT_BENCH_RATES     comma-separated events per second [125,500,1000]
+ *   XINPUT_BENCH_DISPLAY   use this X display instead of starting Xvfb
+ *   XINPUT_BENCH_SAVE      write every latency sample to this TSV
+ *
+ * Needs Xvfb and the X11, XInput2 and XTest development packages
+ * (libx11-dev, libxi-dev, libxtst-dev); the target is skipped without them.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run bench:xinput
+ */
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <X11/Xlib.h>
+#include <X11/extensions/XInput2.h>
+#include <X11/extensions/XTest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "drag_session.h"
+#include "napi_smart_ptr.h"
+#include "napi_test_shim.h"
+
+using FileCataloger::ArenaChunkCache;
+using FileCataloger::DragSession;
+using FileCataloger::TrajectoryPoint;
+using FileCataloger::TrajectorySnapshot;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t EnvOr(const char* name, uint64_t fallback) {
+    const char* value = std::getenv(name);
+    return value && *value ? std::strtoull(value, nullptr, 10) : fallback;
+}
+
+std::string EnvOr(const char* name, const char* fallback) {
+    const char* value = std::getenv(name);
+    return value && *value ? value : fallback;
+}
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// --- Xvfb -------------------------------------------------------------------
+
+constexpr int kScreenWidth = 1920;
+constexpr int kScreenHeight = 1080;
+
+class Xvfb {
+public:
+    ~Xvfb() { Stop(); }
+
+    // Starts a server on a free display and returns its name, or "" on failure
+    std::string Start(std::string* error) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            *error = "pipe failed";
+            return "";
+        }
+        pid_ = fork();
+        if (pid_ == 0) {
+            close(fds[0]);
+            std::string fd = std::to_string(fds[1]);
+            std::string screen = std::to_string(kScreenWidth) + "x" + std::to_string(kScreenHeight) + "x24";
+            execlp("Xvfb", "Xvfb", "-displayfd", fd.c_str(), "-screen", "0", screen.c_str(), "-nolisten", "tcp",
+                   static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        close(fds[1]);
+        if (pid_ < 0) {
+            close(fds[0]);
+            *error = "fork failed";
+            return "";
+        }
+
+        // Xvfb writes the display number once it accepts connections
+        std::string number;
+        pollfd readable = {fds[0], POLLIN, 0};
+        auto deadline = Clock::now() + std::chrono::seconds(10);
+        while (Clock::now() < deadline && number.find('\n') == std::string::npos) {
+            if (poll(&readable, 1, 100) <= 0) {
+                continue;
+            }
+            char buffer[16];
+            ssize_t n = read(fds[0], buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            number.append(buffer, static_cast<size_t>(n));
+        }
+        close(fds[0]);
+        if (number.find('\n') == std::string::npos) {
+            *error = "Xvfb did not start (is it installed and on PATH?)";
+            Stop();
+            return "";
+        }
+        return ":" + number.substr(0, number.find('\n'));
+    }
+
+    void Stop() {
+        if (pid_ > 0) {
+            kill(pid_, SIGTERM);
+            waitpid(pid_, nullptr, 0);
+            pid_ = -1;
+        }
+    }
+
+private:
+    pid_t pid_ = -1;
+};
+
+XIDeviceEvent* AsDeviceEvent(XGenericEventCookie* cookie) {
+    return static_cast<XIDeviceEvent*>(cookie->data);
+}
+
+// Every motion of a run goes to its own pixel, inside a 16px margin
+int XOf(uint64_t sequence) {
+    return 16 + static_cast<int>(sequence % (kScreenWidth - 32));
+}
+
+int YOf(uint64_t sequence) {
+    return 16 + static_cast<int>((sequence / (kScreenWidth - 32)) % (kScreenHeight - 32));
+}
+
+uint64_t SequenceOf(double x, double y) {
+    return static_cast<uint64_t>(std::lround(y) - 16) * (kScreenWidth - 32) +
+           static_cast<uint64_t>(std::lround(x) - 16);
+}
+
+// --- Latency samples --------------------------------------------------------
+
+enum class Kind { Move, Button, Analysis, Count };
+
+const char* KindName(Kind kind) {
+    switch (kind) {
+        case Kind::Move: return "move";
+        case Kind::Button: return "button";
+        case Kind::Analysis: return "analysis";
+        default: return "?";
+    }
+}
+
+struct Distribution {
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+    double stddev = 0;
+    size_t count = 0;
+};
+
+Distribution Summarize(std::vector<double> samples) {
+    Distribution distribution;
+    distribution.count = samples.size();
+    if (samples.empty()) {
+        return distribution;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) { return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))]; };
+    distribution.p50 = at(0.50);
+    distribution.p99 = at(0.99);
+    distribution.max = samples.back();
+    double mean = 0;
+    for (double sample : samples) {
+        mean += sample;
+    }
+    mean /= samples.size();
+    double variance = 0;
+    for (double sample : samples) {
+        variance += (sample - mean) * (sample - mean);
+    }
+    distribution.stddev = std::sqrt(variance / samples.size());
+    return distribution;
+}
+
+// Injection times, written by the injector before each event is sent
+struct Injections {
+    explicit Injections(uint64_t events)
+        : size(events), moves(new std::atomic<int64_t>[events]), buttons(new std::atomic<int64_t>[events / 50 + 2]) {}
+
+    // Motion the injector did not send, such as the server's initial pointer
+    bool Sent(uint64_t sequence) const { return sequence < size; }
+
+    uint64_t size;
+    std::unique_ptr<std::atomic<int64_t>[]> moves;
+    std::unique_ptr<std::atomic<int64_t>[]> buttons;
+};
+
+// --- Modules under test -----------------------------------------------------
+
+struct MouseData {
+    uint64_t sequence;  // motion sequence, or button index
+    bool button;
+    bool pressed;
+};
+
+using MouseEventDispatcher = FileCataloger::BatchedDispatcher<MouseData>;
+
+// Drag monitor side: one session per drag, snapshots analysed on a thread
+class DragMonitorModel {
+public:
+    explicit DragMonitorModel(const Injections& injections)
+        : injections_(injections), analysis_([this] { RunAnalysis(); }) {}
+
+    ~DragMonitorModel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        analysis_.join();
+    }
+
+    // Tap thread
+    void MouseDown(double x, double y) {
+        session_ = std::make_shared<DragSession>(&cache_);
+        session_->trajectory().Push({x, y});
+        moves_ = 0;
+    }
+
+    void MouseDragged(double x, double y) {
+        if (!session_) {
+            return;
+        }
+        session_->trajectory().Push({x, y});
+        if (++moves_ % 10 == 0) {
+            if (TrajectorySnapshot* snapshot = session_->TakeSnapshot()) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    queue_.push_back({snapshot, session_});
+                }
+                cv_.notify_one();
+            }
+        }
+    }
+
+    void MouseUp() { session_.reset(); }
+
+    // After the analysis queue is empty
+    std::vector<double> TakeLatencies() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return queue_.empty() && !busy_; });
+        return std::move(latencies_);
+    }
+
+private:
+    struct Task {
+        TrajectorySnapshot* snapshot;
+        std::shared_ptr<DragSession> owner;
+    };
+
+    void RunAnalysis() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            Task task = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+            lock.unlock();
+
+            const TrajectorySnapshot& snapshot = *task.snapshot;
+            int changes = 0;
+            for (size_t i = 2; i < snapshot.count; i++) {
+                double a = snapshot.points[i - 1].x - snapshot.points[i - 2].x;
+                double b = snapshot.points[i].x - snapshot.points[i - 1].x;
+                changes += (a > 0) != (b > 0);
+            }
+            shakes_ += changes >= 6;
+            const TrajectoryPoint& last = snapshot.points[snapshot.count - 1];
+            uint64_t sequence = SequenceOf(last.x, last.y);
+            double latency = injections_.Sent(sequence)
+                ? (NowNs() - injections_.moves[sequence].load(std::memory_order_acquire)) / 1000.0
+                : -1;
+            DragSession::ReleaseSnapshot(task.snapshot);
+            task.owner.reset();
+
+            lock.lock();
+            if (latency >= 0) {
+                latencies_.push_back(latency);
+            }
+            busy_ = false;
+            idle_.notify_all();
+        }
+    }
+
+    const Injections& injections_;
+    ArenaChunkCache cache_;
+    std::shared_ptr<DragSession> session_;
+    int moves_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_;
+    std::deque<Task> queue_;
+    std::vector<double> latencies_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    uint64_t shakes_ = 0;
+    std::thread analysis_;
+};
+
+// The tracker's dispatcher and drain, recording latency on the JS thread
+class MouseTrackerModel {
+public:
+    MouseTrackerModel(const Injections& injections, MouseEventDispatcher::Options options)
+        : injections_(injections),
+          dispatcher_([this](napi_env, napi_value, std::vector<MouseData>& buttons,
+                             std::vector<MouseData>& moves) { DeliverBatch(buttons, moves); },
+                      options) {
+        started_ = dispatcher_.Start(NapiTestShim::Env(), nullptr, "XInputLatencyBench") == napi_ok;
+    }
+
+    bool Started() const { return started_; }
+    void Stop() { dispatcher_.Stop(); }
+
+    // Tap thread
+    void QueueMouseEvent(uint64_t sequence) {
+        dispatcher_.Push({sequence, false, false}, MouseEventDispatcher::Priority::Low);
+    }
+
+    void QueueButtonEvent(uint64_t index, bool pressed) {
+        dispatcher_.Push({index, true, pressed}, MouseEventDispatcher::Priority::High);
+    }
+
+    uint64_t Handled() const { return handled_.load(std::memory_order_acquire); }
+
+    // After Handled() caught up with what the tap pushed
+    std::vector<double> TakeLatencies(Kind kind) { return std::move(latencies_[static_cast<int>(kind)]); }
+    uint64_t Delivered() const { return delivered_; }
+
+private:
+    // Stand-in JS thread
+    void DeliverBatch(std::vector<MouseData>& buttons, std::vector<MouseData>& moves) {
+        int64_t now = NowNs();
+        for (const MouseData& button : buttons) {
+            int64_t injected = injections_.buttons[button.sequence].load(std::memory_order_acquire);
+            latencies_[static_cast<int>(Kind::Button)].push_back((now - injected) / 1000.0);
+        }
+        if (!moves.empty()) {
+            int64_t injected = injections_.moves[moves.back().sequence].load(std::memory_order_acquire);
+            latencies_[static_cast<int>(Kind::Move)].push_back((now - injected) / 1000.0);
+            delivered_++;
+        }
+        handled_.fetch_add(buttons.size() + moves.size(), std::memory_order_release);
+    }
+
+    const Injections& injections_;
+    MouseEventDispatcher dispatcher_;
+    std::vector<double> latencies_[static_cast<int>(Kind::Count)];
+    uint64_t delivered_ = 0;
+    std::atomic<uint64_t> handled_{0};
+    bool started_ = false;
+};
+
+// --- Event tap ----------------------------------------------------------------
+
+// Reads XI2 events from the root window on its own connection
+class EventTap {
+public:
+    EventTap(const std::string& display, const Injections& injections, MouseTrackerModel& tracker,
+             DragMonitorModel& drags)
+        : injections_(injections), tracker_(tracker), drags_(drags) {
+        display_ = XOpenDisplay(display.c_str());
+        if (!display_) {
+            return;
+        }
+        int event, error;
+        int major = 2;
+        int minor = 0;
+        if (!XQueryExtension(display_, "XInputExtension", &opcode_, &event, &error) ||
+            XIQueryVersion(display_, &major, &minor) != Success) {
+            XCloseDisplay(display_);
+            display_ = nullptr;
+            return;
+        }
+
+        unsigned char bits[XIMaskLen(XI_LASTEVENT)] = {};
+        XISetMask(bits, XI_Motion);
+        XISetMask(bits, XI_ButtonPress);
+        XISetMask(bits, XI_ButtonRelease);
+        XIEventMask mask = {XIAllMasterDevices, sizeof(bits), bits};
+        XISelectEvents(display_, DefaultRootWindow(display_), &mask, 1);
+        XSync(display_, False);
+        thread_ = std::thread([this] { Run(); });
+    }
+
+    ~EventTap() {
+        stopping_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (display_) {
+            XCloseDisplay(display_);
+        }
+    }
+
+    bool Started() const { return display_ != nullptr; }
+    uint64_t Moves() const { return moves_.load(std::memory_order_acquire); }
+    uint64_t Buttons() const { return buttons_.load(std::memory_order_acquire); }
+
+private:
+    void Run() {
+        pollfd readable = {ConnectionNumber(display_), POLLIN, 0};
+        while (!stopping_) {
+            if (XPending(display_) == 0) {
+                poll(&readable, 1, 20);
+                continue;
+            }
+            XEvent event;
+            XNextEvent(display_, &event);
+            XGenericEventCookie* cookie = &event.xcookie;
+            if (cookie->type != GenericEvent || cookie->extension != opcode_ || !XGetEventData(display_, cookie)) {
+                continue;
+            }
+            const XIDeviceEvent* device = AsDeviceEvent(cookie);
+            switch (cookie->evtype) {
+                case XI_Motion: {
+                    uint64_t sequence = SequenceOf(device->root_x, device->root_y);
+                    if (injections_.Sent(sequence)) {
+                        tracker_.QueueMouseEvent(sequence);
+                        drags_.MouseDragged(device->root_x, device->root_y);
+                        moves_.fetch_add(1, std::memory_order_release);
+                    }
+                    break;
+                }
+                case XI_ButtonPress:
+                case XI_ButtonRelease: {
+                    bool pressed = cookie->evtype == XI_ButtonPress;
+                    tracker_.QueueButtonEvent(buttons_.load(std::memory_order_relaxed), pressed);
+                    if (pressed) {
+                        drags_.MouseDown(device->root_x, device->root_y);
+                    } else {
+                        drags_.MouseUp();
+                    }
+                    buttons_.fetch_add(1, std::memory_order_release);
+                    break;
+                }
+                default:
+                    break;
+            }
+            XFreeEventData(display_, cookie);
+        }
+    }
+
+    const Injections& injections_;
+    MouseTrackerModel& tracker_;
+    DragMonitorModel& drags_;
+    Display* display_ = nullptr;
+    int opcode_ = 0;
+    std::atomic<uint64_t> moves_{0};
+    std::atomic<uint64_t> buttons_{0};
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
+
+// --- Injection --------------------------------------------------------------
+
+constexpr uint64_t kDragEvery = 200;
+constexpr uint64_t kMovesPerDrag = 100;
+
+// Paced motion with a drag every kDragEvery events; returns buttons sent
+uint64_t Inject(Display* display, Injections& injections, uint64_t events, uint64_t hz) {
+    const auto period = std::chrono::nanoseconds(1000000000 / hz);
+    auto next = Clock::now();
+    uint64_t buttons = 0;
+    for (uint64_t sequence = 0; sequence < events; sequence++) {
+        uint64_t phase = sequence % kDragEvery;
+        if (phase == 0 || phase == kMovesPerDrag) {
+            injections.buttons[buttons++].store(NowNs(), std::memory_order_release);
+            XTestFakeButtonEvent(display, 1, phase == 0 ? True : False, CurrentTime);
+        }
+        injections.moves[sequence].store(NowNs(), std::memory_order_release);
+        XTestFakeMotionEvent(display, -1, XOf(sequence), YOf(sequence), CurrentTime);
+        XFlush(display);
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+    if (buttons % 2) {
+        injections.buttons[buttons++].store(NowNs(), std::memory_order_release);
+        XTestFakeButtonEvent(display, 1, False, CurrentTime);
+    }
+    XSync(display, False);
+    return buttons;
+}
+
+struct Config {
+    const char* name;
+    MouseEventDispatcher::Options options;
+};
+
+struct Row {
+    std::string config;
+    uint64_t hz = 0;
+    Distribution latency[static_cast<int>(Kind::Count)];
+    uint64_t injected = 0;
+    uint64_t seen = 0;
+    uint64_t delivered = 0;
+};
+
+std::vector<uint64_t> ParseRates(const std::string& text) {
+    std::vector<uint64_t> rates;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        uint64_t rate = std::strtoull(text.substr(start, end - start).c_str(), nullptr, 10);
+        if (rate > 0) {
+            rates.push_back(rate);
+        }
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    return rates;
+}
+
+void PrintLatency(const Distribution& distribution) {
+    if (distribution.count == 0) {
+        std::printf(" %7s %7s %7s %7s", "-", "-", "-", "-");
+    } else {
+        std::printf(" %7.0f %7.0f %7.0f %7.0f", distribution.p50, distribution.p99, distribution.max,
+                    distribution.stddev);
+    }
+}
+
+} // namespace
+
+int main() {
+    const uint64_t events = std::max<uint64_t>(EnvOr("XINPUT_BENCH_EVENTS", 5000), kDragEvery);
+    const std::vector<uint64_t> rates = ParseRates(EnvOr("XINPUT_BENCH_RATES", "125,500,1000"));
+    const std::string savePath = EnvOr("XINPUT_BENCH_SAVE", "");
+    if (rates.empty()) {
+        std::fprintf(stderr, "FAIL: XINPUT_BENCH_RATES has no rates\n");
+        return 1;
+    }
+
+    XInitThreads();
+    Xvfb xvfb;
+    std::string display = EnvOr("XINPUT_BENCH_DISPLAY", "");
+    if (display.empty()) {
+        std::string error;
+        display = xvfb.Start(&error);
+        if (display.empty()) {
+            std::fprintf(stderr, "FAIL: %s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    Display* injector = XOpenDisplay(display.c_str());
+    int event, error, major, minor;
+    if (!injector || !XTestQueryExtension(injector, &event, &error, &major, &minor)) {
+        std::fprintf(stderr, "FAIL: no XTest on display %s\n", display.c_str());
+        return 1;
+    }
+    std::printf("Display %s, %llu motion events per run, a drag every %llu events\n\n", display.c_str(),
+                static_cast<unsigned long long>(events), static_cast<unsigned long long>(kDragEvery));
+
+    std::thread jsThread(NapiTestShim::RunJsThread);
+
+    const Config configs[] = {
+        {"immediate", {std::chrono::milliseconds(0), 1}},
+        {"4ms", {std::chrono::milliseconds(4), 16}},
+        {"default", {std::chrono::milliseconds(16), 64}},
+    };
+
+    std::printf("%-10s %6s | %-31s | %-31s | %-31s |\n", "", "", " move us", " button us", " analysis us");
+    std::printf("%-10s %6s |", "config", "hz");
+    for (int kind = 0; kind < static_cast<int>(Kind::Count); kind++) {
+        std::printf(" %7s %7s %7s %7s |", "p50", "p99", "max", "sd");
+    }
+    std::printf(" %7s %7s %9s\n", "seen", "dropped", "coalesced");
+
+    FILE* save = savePath.empty() ? nullptr : std::fopen(savePath.c_str(), "w");
+    if (save) {
+        std::fprintf(save, "config\thz\tkind\tlatency_us\n");
+    }
+
+    bool ok = true;
+    for (const Config& config : configs) {
+        for (uint64_t hz : rates) {
+            Injections injections(events);
+            Row row;
+            row.config = config.name;
+            row.hz = hz;
+            row.injected = events;
+            std::vector<double> samples[static_cast<int>(Kind::Count)];
+            {
+                MouseTrackerModel tracker(injections, config.options);
+                DragMonitorModel drags(injections);
+                EventTap tap(display, injections, tracker, drags);
+                if (!tracker.Started() || !tap.Started()) {
+                    std::fprintf(stderr, "FAIL: %s\n", tap.Started() ? "dispatcher did not start"
+                                                                      : "no XInput 2 on the display");
+                    ok = false;
+                    break;
+                }
+
+                uint64_t buttons = Inject(injector, injections, events, hz);
+
+                // Settle: the tap has gone quiet and the JS thread has drained
+                uint64_t lastSeen = ~0ull;
+                while (tap.Moves() + tap.Buttons() != lastSeen) {
+                    lastSeen = tap.Moves() + tap.Buttons();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                }
+                while (tracker.Handled() < lastSeen || NapiTestShim::PendingCalls() > 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+                if (tap.Buttons() != buttons) {
+                    std::fprintf(stderr, "FAIL: %llu button events injected, %llu seen\n",
+                                 static_cast<unsigned long long>(buttons),
+                                 static_cast<unsigned long long>(tap.Buttons()));
+                    ok = false;
+                }
+
+                row.seen = tap.Moves();
+                row.delivered = tracker.Delivered();
+                samples[static_cast<int>(Kind::Move)] = tracker.TakeLatencies(Kind::Move);
+                samples[static_cast<int>(Kind::Button)] = tracker.TakeLatencies(Kind::Button);
+                samples[static_cast<int>(Kind::Analysis)] = drags.TakeLatencies();
+                tracker.Stop();
+            }
+            while (NapiTestShim::LiveFunctions() > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            for (int kind = 0; kind < static_cast<int>(Kind::Count); kind++) {
+                row.latency[kind] = Summarize(samples[kind]);
+                if (save) {
+                    for (double sample : samples[kind]) {
+                        std::fprintf(save, "%s\t%llu\t%s\t%.1f\n", config.name, static_cast<unsigned long long>(hz),
+                                     KindName(static_cast<Kind>(kind)), sample);
+                    }
+                }
+            }
+
+            std::printf("%-10s %6llu |", row.config.c_str(), static_cast<unsigned long long>(hz));
+            PrintLatency(row.latency[static_cast<int>(Kind::Move)]);
+            std::printf(" |");
+            PrintLatency(row.latency[static_cast<int>(Kind::Button)]);
+            std::printf(" |");
+            PrintLatency(row.latency[static_cast<int>(Kind::Analysis)]);
+            std::printf(" | %7llu %7llu %9llu\n", static_cast<unsigned long long>(row.seen),
+                        static_cast<unsigned long long>(row.injected - std::min(row.injected, row.seen)),
+                        static_cast<unsigned long long>(row.seen - std::min(row.seen, row.delivered)));
+        }
+        if (!ok) {
+            break;
+        }
+    }
+
+    NapiTestShim::StopJsThread();
+    jsThread.join();
+    XCloseDisplay(injector);
+
+    if (save) {
+        ok = std::fclose(save) == 0 && ok;
+        std::printf("\nSamples saved to %s\n", savePath.c_str());
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file zip_writer_bench.cc
+ * @brief ZIP export benchmark: chunked parallel deflate vs single-stream zlib
+ *
+ * Builds a shelf-like corpus (a large log-like text file, a file of random
+ * bytes, and many small JPEGs) and compares:
+ * - zlib compress2 over each file in one thread, the single-stream baseline
+ *   for time and compressed size
+ * - ZipWriter with pools of 1, 2 and all hardware threads
+ * - ZipWriter at level 1 and with compressed-content detection off
+ *
+ * Throughput scales with cores only on a multi-core machine; on one CPU
+ * the pool rows show the chunking overhead instead.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run bench:zip
+ *   ZIP_BENCH_MB=256 npm run bench:zip
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "zip_writer.h"
+
+using FileCataloger::WorkStealingPool;
+using FileCataloger::ZipOptions;
+using FileCataloger::ZipSource;
+using FileCataloger::ZipSummary;
+using FileCataloger::ZipWriter;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void WriteFile(const std::string& path, const std::string& data) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, data.data(), data.size()) != static_cast<ssize_t>(data.size())) {
+        std::fprintf(stderr, "cannot write corpus file %s\n", path.c_str());
+        std::exit(2);
+    }
+    close(fd);
+}
+
+std::string ReadFile(const std::string& path) {
+    std::string data;
+    int fd = open(path.c_str(), O_RDONLY);
+    char buffer[1 << 16];
+    ssize_t n;
+    while (fd >= 0 && (n = read(fd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, static_cast<size_t>(n));
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return data;
+}
+
+struct Corpus {
+    std::vector<std::string> files;
+    uint64_t bytes = 0;
+};
+
+Corpus MakeCorpus(const std::string& dir, size_t megabytes) {
+    static const char* words[] = {"INFO ", "shelf ", "item ", "added ", "path=/Users/me/Documents/ ",
+                                  "WARN ", "drag ", "session ", "took ", "ms\n"};
+    std::mt19937 rng(42);
+    Corpus corpus;
+
+    std::string text;
+    while (text.size() < megabytes * (1 << 20) / 2) {
+        text += words[rng() % 10];
+        if (rng() % 5 == 0) {
+            text += std::to_string(rng() % 100000);
+        }
+    }
+    std::string random(megabytes * (1 << 20) / 4, '\0');
+    for (auto& c : random) {
+        c = static_cast<char>(rng());
+    }
+    corpus.files = {dir + "/app.log", dir + "/random.bin"};
+    WriteFile(corpus.files[0], text);
+    WriteFile(corpus.files[1], random);
+    corpus.bytes = text.size() + random.size();
+
+    mkdir((dir + "/photos").c_str(), 0755);
+    const size_t photos = megabytes * (1 << 20) / 4 / (256 * 1024);
+    for (size_t i = 0; i < photos; i++) {
+        std::string jpeg = "\xFF\xD8\xFF\xE0" + random.substr((i * 4099) % (random.size() / 2), 256 * 1024 - 4);
+        WriteFile(dir + "/photos/" + std::to_string(i) + ".jpg", jpeg);
+        corpus.bytes += jpeg.size();
+    }
+    corpus.files.push_back(dir + "/photos");
+    return corpus;
+}
+
+void PrintRow(const char* name, double ms, uint64_t in, uint64_t out) {
+    std::printf("  %-34s %10.1f %10.1f %9.2f%%\n", name, ms, in / (1024.0 * 1024.0) / (ms / 1000.0),
+                100.0 * out / in);
+}
+
+void BenchZlib(const Corpus& corpus, const std::string& dir) {
+    std::vector<std::string> paths = {corpus.files[0], corpus.files[1]};
+    for (size_t i = 0;; i++) {
+        std::string path = dir + "/photos/" + std::to_string(i) + ".jpg";
+        if (access(path.c_str(), F_OK) != 0) {
+            break;
+        }
+        paths.push_back(path);
+    }
+    const auto start = Clock::now();
+    uint64_t in = 0;
+    uint64_t out = 0;
+    for (const auto& path : paths) {
+        const std::string data = ReadFile(path);
+        uLongf size = compressBound(data.size());
+        std::vector<Bytef> buffer(size);
+        compress2(buffer.data(), &size, reinterpret_cast<const Bytef*>(data.data()), data.size(), 6);
+        in += data.size();
+        out += size;
+    }
+    PrintRow("zlib compress2, 1 thread", MsSince(start), in, out);
+}
+
+void BenchWriter(const char* name, const Corpus& corpus, const std::string& output, size_t threads,
+                 ZipOptions options) {
+    WorkStealingPool pool(threads);
+    std::vector<ZipSource> sources;
+    for (const auto& file : corpus.files) {
+        sources.push_back({file, ""});
+    }
+    ZipSummary result;
+    const auto start = Clock::now();
+    auto writer = ZipWriter::Create(std::move(sources), output, options, [] {},
+                                    [&](const ZipSummary& summary) { result = summary; });
+    writer->Start(pool);
+    writer->WaitUntilFinished();
+    const double ms = MsSince(start);
+    if (result.error != 0) {
+        std::fprintf(stderr, "%s: archive failed, errno %d\n", name, result.error);
+        std::exit(1);
+    }
+    PrintRow(name, ms, result.bytesIn, result.bytesOut);
+    unlink(output.c_str());
+}
+
+} // namespace
+
+int main() {
+    const char* mbEnv = std::getenv("ZIP_BENCH_MB");
+    const size_t megabytes = std::max(4, mbEnv ? std::atoi(mbEnv) : 96);
+    char pattern[] = "/tmp/zip_writer_bench.XXXXXX";
+    const char* work = mkdtemp(pattern);
+    if (!work) {
+        std::fprintf(stderr, "cannot create work directory\n");
+        return 2;
+    }
+    const std::string dir = work;
+
+    const auto prepare = Clock::now();
+    const Corpus corpus = MakeCorpus(dir, megabytes);
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("Corpus: %.1f MB (prepared in %.0f ms), %zu hardware threads\n",
+                corpus.bytes / (1024.0 * 1024.0), MsSince(prepare), cores);
+    std::printf("  %-34s %10s %10s %10s\n", "writer", "ms", "MB/s", "size");
+
+    BenchZlib(corpus, dir);
+    const std::string output = dir + "/out.zip";
+    ZipOptions options;
+    BenchWriter("ZipWriter, 1 thread", corpus, output, 1, options);
+    BenchWriter("ZipWriter, 2 threads", corpus, output, 2, options);
+    if (cores > 2) {
+        const std::string name = "ZipWriter, " + std::to_string(cores) + " threads";
+        BenchWriter(name.c_str(), corpus, output, cores, options);
+    }
+    ZipOptions fast = options;
+    fast.level = 1;
+    BenchWriter("ZipWriter, level 1", corpus, output, cores, fast);
+    ZipOptions deflateAll = options;
+    deflateAll.storeCompressedContent = false;
+    BenchWriter("ZipWriter, deflate JPEGs too", corpus, output, cores, deflateAll);
+
+    const std::string command = "rm -rf '" + dir + "'";
+    if (system(command.c_str()) != 0) {
+        std::fprintf(stderr, "warning: could not remove %s\n", work);
+    }
+    return 0;
+}
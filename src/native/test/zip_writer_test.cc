@@ -0,0 +1,451 @@
+/**
+ * @file zip_writer_test.cc
+ * @brief Functional test for the streaming ZIP64 writer
+ *
+ * Writes archives from a fixture tree (compressible text split over many
+ * chunks, random data and a JPEG that must be stored, empty files and folders,
+ * a symlink, missing and unsafe sources) and reads them back with a small
+ * reader built on zlib's inflate: names, methods, CRCs, content, mtimes and
+ * the central directory must all agree. Also checks that the chunked
+ * deflate stays within 1% of single-stream zlib, that files which shrink
+ * after listing still give valid entries, that more than 65535 entries
+ * switch to the ZIP64 end records, cancellation, and a window of one chunk.
+ *
+ * Linux only. Build and run from src/native:
+ *   npm run test:linux
+ */
+
+#include <zlib.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "test_support.h"
+#include "zip_writer.h"
+
+using FileCataloger::WorkStealingPool;
+using FileCataloger::ZipOptions;
+using FileCataloger::ZipSource;
+using FileCataloger::ZipSummary;
+using FileCataloger::ZipWriter;
+
+namespace {
+
+std::string g_root;
+
+std::string ReadFile(const std::string& path) {
+    std::string data;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return data;
+    }
+    char buffer[65536];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return data;
+}
+
+bool Exists(const std::string& path) {
+    struct stat st;
+    return lstat(path.c_str(), &st) == 0;
+}
+
+// Compressible: words from a small vocabulary, like logs or source code
+std::string Text(size_t size, uint32_t seed) {
+    static const char* words[] = {"shelf ", "item ", "rename ", "folder ", "thumbnail ", "drag ",
+                                  "pattern ", "native ", "module ", "cache\n"};
+    std::mt19937 rng(seed);
+    std::string text;
+    while (text.size() < size) {
+        text += words[rng() % 10];
+        if (rng() % 7 == 0) {
+            text += std::to_string(rng() % 10000);
+        }
+    }
+    text.resize(size);
+    return text;
+}
+
+std::string RandomBytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string data(size, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(rng());
+    }
+    return data;
+}
+
+uint32_t Get16(const std::string& data, size_t offset) {
+    return static_cast<uint8_t>(data[offset]) | (static_cast<uint8_t>(data[offset + 1]) << 8);
+}
+
+uint32_t Get32(const std::string& data, size_t offset) {
+    return Get16(data, offset) | (Get16(data, offset + 2) << 16);
+}
+
+uint64_t Get64(const std::string& data, size_t offset) {
+    return Get32(data, offset) | (static_cast<uint64_t>(Get32(data, offset + 4)) << 32);
+}
+
+struct ReadEntry {
+    std::string name;
+    uint32_t method = 0;
+    uint32_t crc = 0;
+    uint64_t compressedSize = 0;
+    uint64_t size = 0;
+    uint32_t mode = 0;
+    int64_t mtime = -1;
+    std::string content;
+    bool valid = false;
+};
+
+// Reads every entry through the central directory; returns false if the
+// archive is malformed anywhere
+bool ReadZip(const std::string& path, std::vector<ReadEntry>* entries, bool* zip64) {
+    const std::string zip = ReadFile(path);
+    if (zip.size() < 22 || Get32(zip, zip.size() - 22) != 0x06054b50) {
+        return false;
+    }
+    size_t end = zip.size() - 22;
+    uint64_t count = Get16(zip, end + 10);
+    uint64_t directoryOffset = Get32(zip, end + 16);
+    *zip64 = false;
+    if (end >= 20 && Get32(zip, end - 20) == 0x07064b50) {
+        const uint64_t record = Get64(zip, end - 12);
+        if (Get32(zip, record) != 0x06064b50) {
+            return false;
+        }
+        count = Get64(zip, record + 32);
+        directoryOffset = Get64(zip, record + 48);
+        *zip64 = true;
+    }
+
+    size_t offset = directoryOffset;
+    for (uint64_t i = 0; i < count; i++) {
+        if (Get32(zip, offset) != 0x02014b50) {
+            return false;
+        }
+        ReadEntry entry;
+        entry.method = Get16(zip, offset + 10);
+        entry.crc = Get32(zip, offset + 16);
+        entry.compressedSize = Get32(zip, offset + 20);
+        entry.size = Get32(zip, offset + 24);
+        const size_t nameLength = Get16(zip, offset + 28);
+        const size_t extraLength = Get16(zip, offset + 30);
+        const size_t commentLength = Get16(zip, offset + 32);
+        entry.mode = Get32(zip, offset + 38) >> 16;
+        uint64_t localOffset = Get32(zip, offset + 42);
+        entry.name = zip.substr(offset + 46, nameLength);
+        for (size_t extra = offset + 46 + nameLength; extra < offset + 46 + nameLength + extraLength;) {
+            const uint32_t id = Get16(zip, extra);
+            const uint32_t size = Get16(zip, extra + 2);
+            size_t field = extra + 4;
+            if (id == 0x0001) {
+                if (entry.size == 0xFFFFFFFF) { entry.size = Get64(zip, field); field += 8; }
+                if (entry.compressedSize == 0xFFFFFFFF) { entry.compressedSize = Get64(zip, field); field += 8; }
+                if (localOffset == 0xFFFFFFFF) { localOffset = Get64(zip, field); }
+            } else if (id == 0x5455 && (zip[field] & 1)) {
+                entry.mtime = Get32(zip, field + 1);
+            }
+            extra += 4 + size;
+        }
+        offset += 46 + nameLength + extraLength + commentLength;
+
+        // The local header must agree with the central directory
+        if (Get32(zip, localOffset) != 0x04034b50 || Get16(zip, localOffset + 8) != entry.method ||
+            Get32(zip, localOffset + 14) != entry.crc || Get16(zip, localOffset + 26) != nameLength ||
+            zip.compare(localOffset + 30, nameLength, entry.name) != 0) {
+            return false;
+        }
+        const size_t dataOffset = localOffset + 30 + nameLength + Get16(zip, localOffset + 28);
+        if (dataOffset + entry.compressedSize > directoryOffset) {
+            return false;
+        }
+        if (entry.method == 0) {
+            entry.content = zip.substr(dataOffset, entry.compressedSize);
+        } else if (entry.method == 8) {
+            entry.content.resize(entry.size);
+            z_stream stream{};
+            inflateInit2(&stream, -MAX_WBITS);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(zip.data() + dataOffset));
+            stream.avail_in = static_cast<uInt>(entry.compressedSize);
+            stream.next_out = reinterpret_cast<Bytef*>(&entry.content[0]);
+            stream.avail_out = static_cast<uInt>(entry.size);
+            const int status = inflate(&stream, Z_FINISH);
+            const bool complete = status == Z_STREAM_END && stream.avail_in == 0 && stream.total_out == entry.size;
+            inflateEnd(&stream);
+            if (!complete) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        entry.valid = entry.content.size() == entry.size &&
+                      crc32(0, reinterpret_cast<const Bytef*>(entry.content.data()), entry.content.size()) == entry.crc;
+        entries->push_back(std::move(entry));
+    }
+    return offset == zip.size() - 22 - (*zip64 ? 76 : 0);
+}
+
+ZipSummary Zip(WorkStealingPool& pool, std::vector<ZipSource> sources, const std::string& output, ZipOptions options,
+               const std::function<void(ZipWriter&)>& onProgress = nullptr) {
+    ZipSummary result;
+    std::shared_ptr<ZipWriter> writer;
+    writer = ZipWriter::Create(
+        std::move(sources), output, options,
+        [&] {
+            if (onProgress) {
+                onProgress(*writer);
+            }
+        },
+        [&](const ZipSummary& summary) { result = summary; });
+    writer->Start(pool);
+    writer->WaitUntilFinished();
+    return result;
+}
+
+const ReadEntry* Find(const std::vector<ReadEntry>& entries, const std::string& name) {
+    for (const auto& entry : entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void TestArchive(WorkStealingPool& pool) {
+    const std::string text = Text(3 << 20, 1);
+    const std::string random = RandomBytes(300000, 2);
+    std::string jpeg = "\xFF\xD8\xFF\xE0" + RandomBytes(100000, 3);
+
+    const std::string folder = g_root + "/Folder";
+    MakeDir(folder);
+    MakeDir(folder + "/empty-sub");
+    MakeDir(folder + "/sub");
+    WriteFile(folder + "/sub/notes.txt", "notes");
+    WriteFile(folder + "/a.txt", "alpha");
+    symlink("a.txt", (folder + "/link.txt").c_str());
+    WriteFile(g_root + "/report.txt", text);
+    WriteFile(g_root + "/noise.bin", random);
+    WriteFile(g_root + "/photo.jpg", jpeg);
+    WriteFile(g_root + "/empty", "");
+    struct timespec times[2] = {{1600000000, 0}, {1600000000, 0}};
+    utimensat(AT_FDCWD, (g_root + "/report.txt").c_str(), times, 0);
+
+    ZipOptions options;
+    options.chunkSize = 64 * 1024;
+    const std::string output = g_root + "/out.zip";
+    ZipSummary summary = Zip(pool,
+                             {{g_root + "/report.txt", ""},
+                              {g_root + "/noise.bin", "data/noise.bin"},
+                              {g_root + "/photo.jpg", "./photo.jpg"},
+                              {g_root + "/empty", ""},
+                              {folder, ""},
+                              {g_root + "/missing", ""},
+                              {g_root + "/report.txt", "../escape.txt"}},
+                             output, options);
+    EXPECT(summary.error == 0 && !summary.cancelled, "error %d", summary.error);
+    EXPECT(summary.entries == 10, "10 entries, got %llu", static_cast<unsigned long long>(summary.entries));
+    // The JPEG, the random data and the three five-byte files deflate would grow
+    EXPECT(summary.storedEntries == 5, "stored %llu", static_cast<unsigned long long>(summary.storedEntries));
+    EXPECT(summary.skipped.size() == 2 && summary.skipped[0].code == ENOENT && summary.skipped[1].code == EINVAL,
+           "missing and unsafe sources skipped");
+    EXPECT(summary.bytesIn == text.size() + random.size() + jpeg.size() + 15, "bytes in %llu",
+           static_cast<unsigned long long>(summary.bytesIn));
+    EXPECT(!Exists(output + ".fcpart"), "no partial archive");
+
+    std::vector<ReadEntry> entries;
+    bool zip64 = true;
+    EXPECT(ReadZip(output, &entries, &zip64), "archive reads back");
+    EXPECT(!zip64 && !summary.zip64, "no ZIP64 needed");
+    EXPECT(summary.bytesOut == ReadFile(output).size(), "bytes out");
+    for (const auto& entry : entries) {
+        EXPECT(entry.valid, "%s: CRC and size", entry.name.c_str());
+    }
+
+    const char* expected[] = {"report.txt", "data/noise.bin", "photo.jpg", "empty", "Folder/",
+                              "Folder/a.txt", "Folder/empty-sub/", "Folder/link.txt", "Folder/sub/",
+                              "Folder/sub/notes.txt"};
+    for (size_t i = 0; i < 10 && i < entries.size(); i++) {
+        EXPECT(entries[i].name == expected[i], "entry %zu: %s", i, entries[i].name.c_str());
+    }
+
+    const ReadEntry* report = Find(entries, "report.txt");
+    EXPECT(report && report->method == 8 && report->content == text && report->mtime == 1600000000,
+           "chunked text deflated");
+    if (report) {
+        // Single-stream zlib at the same level, for the ratio comparison
+        uLongf single = compressBound(text.size());
+        std::vector<Bytef> buffer(single);
+        compress2(buffer.data(), &single, reinterpret_cast<const Bytef*>(text.data()), text.size(), 6);
+        const double ratio = static_cast<double>(report->compressedSize) / (single - 6);
+        EXPECT(ratio < 1.01, "chunked deflate within 1%% of zlib: %llu vs %lu",
+               static_cast<unsigned long long>(report->compressedSize), single - 6);
+    }
+    const ReadEntry* noise = Find(entries, "data/noise.bin");
+    EXPECT(noise && noise->method == 0 && noise->content == random, "random data over chunks stored");
+    const ReadEntry* photo = Find(entries, "photo.jpg");
+    EXPECT(photo && photo->method == 0 && photo->content == jpeg, "JPEG stored");
+    const ReadEntry* empty = Find(entries, "empty");
+    EXPECT(empty && empty->method == 0 && empty->size == 0, "empty file");
+    const ReadEntry* dir = Find(entries, "Folder/empty-sub/");
+    EXPECT(dir && S_ISDIR(dir->mode) && dir->size == 0, "empty folder kept");
+    const ReadEntry* link = Find(entries, "Folder/link.txt");
+    EXPECT(link && link->content == "alpha", "symlink archived as its target");
+
+    // Store everything, and a window of one chunk
+    options.level = 0;
+    options.maxChunksInFlight = 1;
+    summary = Zip(pool, {{g_root + "/report.txt", ""}, {folder, ""}}, output, options);
+    entries.clear();
+    EXPECT(summary.error == 0 && ReadZip(output, &entries, &zip64), "stored archive");
+    EXPECT(entries.size() == 7 && entries[0].method == 0 && entries[0].content == text, "level 0 stores");
+}
+
+void TestIncompressible(WorkStealingPool& pool) {
+    const std::string small = RandomBytes(500000, 4);
+    const std::string large = RandomBytes(3 << 20, 5);
+    const std::string text = Text(500000, 6);
+    WriteFile(g_root + "/small.bin", small);
+    WriteFile(g_root + "/large.bin", large);
+    WriteFile(g_root + "/text.dat", text);
+
+    // Default 1MB chunks: one chunk for small.bin and text.dat, three for large.bin
+    const std::string output = g_root + "/random.zip";
+    ZipSummary summary =
+        Zip(pool, {{g_root + "/small.bin", ""}, {g_root + "/large.bin", ""}, {g_root + "/text.dat", ""}}, output,
+            ZipOptions());
+    std::vector<ReadEntry> entries;
+    bool zip64 = true;
+    EXPECT(summary.error == 0 && ReadZip(output, &entries, &zip64), "random archive");
+    EXPECT(summary.storedEntries == 2, "random files stored, got %llu",
+           static_cast<unsigned long long>(summary.storedEntries));
+    const ReadEntry* one = Find(entries, "small.bin");
+    EXPECT(one && one->valid && one->method == 0 && one->compressedSize == small.size() && one->content == small,
+           "single-chunk random data stored");
+    const ReadEntry* three = Find(entries, "large.bin");
+    EXPECT(three && three->valid && three->method == 0 && three->compressedSize == large.size() &&
+               three->content == large,
+           "multi-chunk random data stored");
+    const ReadEntry* deflated = Find(entries, "text.dat");
+    EXPECT(deflated && deflated->valid && deflated->method == 8 && deflated->compressedSize < text.size() / 2 &&
+               deflated->content == text,
+           "unknown text still deflated");
+    EXPECT(summary.bytesOut < small.size() + large.size() + text.size() / 2, "the archive does not grow: %llu",
+           static_cast<unsigned long long>(summary.bytesOut));
+}
+
+void TestShrunkAfterListing(WorkStealingPool& pool) {
+    const std::string text = Text(3 << 20, 7);
+    const std::string tail = Text(100000, 8);
+    WriteFile(g_root + "/long.txt", text);
+    WriteFile(g_root + "/gone.txt", tail);
+    WriteFile(g_root + "/cut.txt", tail);
+
+    // A window of one chunk keeps the reader inside long.txt until well
+    // after the first progress report, so the later files shrink between
+    // listing and reading: gone.txt's only chunk and cut.txt's second chunk
+    // read nothing
+    ZipOptions options;
+    options.chunkSize = 64 * 1024;
+    options.maxChunksInFlight = 1;
+    options.progressInterval = std::chrono::milliseconds(0);
+    bool truncated = false;
+    const std::string output = g_root + "/shrunk.zip";
+    ZipSummary summary =
+        Zip(pool, {{g_root + "/long.txt", ""}, {g_root + "/gone.txt", ""}, {g_root + "/cut.txt", ""}}, output,
+            options, [&](ZipWriter&) {
+                if (!truncated) {
+                    truncated = truncate((g_root + "/gone.txt").c_str(), 0) == 0 &&
+                                truncate((g_root + "/cut.txt").c_str(), 64 * 1024) == 0;
+                }
+            });
+    std::vector<ReadEntry> entries;
+    bool zip64 = true;
+    EXPECT(truncated && summary.error == 0 && ReadZip(output, &entries, &zip64), "archive of shrunk files");
+    const ReadEntry* gone = Find(entries, "gone.txt");
+    EXPECT(gone && gone->valid && gone->size == 0, "file emptied after listing");
+    const ReadEntry* cut = Find(entries, "cut.txt");
+    EXPECT(cut && cut->valid && cut->method == 8 && cut->content == tail.substr(0, 64 * 1024),
+           "deflate stream of a file cut after listing is terminated");
+}
+
+void TestZip64EndRecords(WorkStealingPool& pool) {
+    WriteFile(g_root + "/tiny", "x");
+    std::vector<ZipSource> sources;
+    for (int i = 0; i < 70000; i++) {
+        sources.push_back({g_root + "/tiny", "many/" + std::to_string(i)});
+    }
+    ZipOptions options;
+    const std::string output = g_root + "/many.zip";
+    ZipSummary summary = Zip(pool, std::move(sources), output, options);
+    std::vector<ReadEntry> entries;
+    bool zip64 = false;
+    EXPECT(summary.error == 0 && summary.entries == 70000 && summary.zip64, "70000 entries");
+    EXPECT(ReadZip(output, &entries, &zip64) && zip64 && entries.size() == 70000, "ZIP64 end records read back");
+    EXPECT(!entries.empty() && entries.back().name == "many/69999" && entries.back().content == "x", "last entry");
+}
+
+void TestFailures(WorkStealingPool& pool) {
+    ZipOptions options;
+    options.chunkSize = 64 * 1024;
+    options.progressInterval = std::chrono::milliseconds(0);
+
+    const std::string output = g_root + "/cancelled.zip";
+    ZipSummary summary = Zip(pool, {{g_root + "/report.txt", ""}}, output, options,
+                             [](ZipWriter& writer) { writer.Cancel(); });
+    EXPECT(summary.cancelled && summary.error == 0, "cancelled");
+    EXPECT(!Exists(output) && !Exists(output + ".fcpart"), "cancelled archive removed");
+
+    summary = Zip(pool, {{g_root + "/report.txt", ""}}, g_root + "/no-such-folder/out.zip", options);
+    EXPECT(summary.error == ENOENT, "unwritable output: %d", summary.error);
+
+    summary = Zip(pool, {}, g_root + "/empty.zip", options);
+    std::vector<ReadEntry> entries;
+    bool zip64 = false;
+    EXPECT(summary.error == 0 && ReadZip(g_root + "/empty.zip", &entries, &zip64) && entries.empty(),
+           "empty archive");
+}
+
+} // namespace
+
+int main() {
+    char pattern[] = "/tmp/zip_writer_test.XXXXXX";
+    const char* root = mkdtemp(pattern);
+    if (!root) {
+        std::fprintf(stderr, "mkdtemp failed\n");
+        return 2;
+    }
+    g_root = root;
+
+    EXPECT(FileCataloger::DosDateTime(0) == ((1u << 21) | (1u << 16)), "dates before 1980 clamp");
+    EXPECT(FileCataloger::IsCompressedContent(FileCataloger::ContentType::Heic) &&
+               !FileCataloger::IsCompressedContent(FileCataloger::ContentType::Text),
+           "compressed content");
+
+    WorkStealingPool pool(4);
+    TestArchive(pool);
+    TestIncompressible(pool);
+    TestShrunkAfterListing(pool);
+    TestZip64EndRecords(pool);
+    TestFailures(pool);
+
+    std::string command = "rm -rf '" + g_root + "'";
+    if (system(command.c_str()) != 0) {
+        std::fprintf(stderr, "cleanup of %s failed\n", g_root.c_str());
+    }
+    std::printf(g_failures == 0 ? "PASS\n" : "FAIL\n");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+# binding.gyp - Build configuration for the native thumbnail module
+#
+# This file configures the compilation of the thumbnails module, which
+# generates bounded RGBA thumbnails for image shelf items on a small
+# prioritized worker set, backed by a content-keyed disk cache.
+#
+# Build command: node-gyp rebuild
+# Output:
+#   macOS: build/Release/thumbnails_darwin.node
+#   Linux: build/Release/thumbnails_linux.node (tests and benchmarks)
+#
+# Requirements:
+# - macOS: Xcode Command Line Tools
+# - Linux: g++ with C++17 support, libjpeg-turbo, libpng and zlib headers
+# - Python 3.x
+# - node-gyp installed globally
+#
+# APIs used:
+# - macOS: ImageIO (CGImageSourceCreateThumbnailAtIndex), CoreGraphics
+# - Linux: libjpeg-turbo DCT-domain scaling, libpng
+# - SSE2 / NEON resize kernels (src/internal/image_resize.cc)
+# - zlib for cache entries
+# - Plain N-API (node_api.h), no node-addon-api dependency
+#
+# Windows is not built yet; the TypeScript wrapper reports thumbnails as
+# unavailable and callers keep their file-type icons.
+
+{
+  "targets": [
+    {
+      "target_name": "thumbnails_<(OS)",
+      "include_dirs": [
+        "src",
+        "src/internal",
+        "../common"
+      ],
+      "sources": [
+        "src/native/thumbnails.cc",
+        "src/internal/image_resize.cc",
+        "src/internal/thumbnail_cache.cc",
+        "src/internal/thumbnail_service.cc"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        ["OS=='mac'", {
+          "target_name": "thumbnails_darwin",
+          "sources": [
+            "src/native/mac/thumbnail_decoder_mac.mm"
+          ],
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "10.15",
+            "GCC_OPTIMIZATION_LEVEL": "3",
+            "LLVM_LTO": "YES",
+            "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+            "OTHER_CFLAGS": [
+              "-fobjc-arc"
+            ],
+            "OTHER_LDFLAGS": [
+              "-framework", "CoreFoundation",
+              "-framework", "CoreGraphics",
+              "-framework", "ImageIO",
+              "-lz"
+            ]
+          }
+        }],
+        ["OS=='linux'", {
+          "target_name": "thumbnails_linux",
+          "sources": [
+            "src/native/linux/thumbnail_decoder_linux.cc"
+          ],
+          "cflags_cc": [ "-O3", "-std=c++17" ],
+          "libraries": [ "-ljpeg", "-lpng", "-lz", "-lpthread" ]
+        }],
+        ["OS=='win'", {
+          "type": "none",
+          "sources!": [
+            "src/native/thumbnails.cc",
+            "src/internal/image_resize.cc",
+            "src/internal/thumbnail_cache.cc",
+            "src/internal/thumbnail_service.cc"
+          ]
+        }]
+      ]
+    }
+  ]
+}
@@ -0,0 +1,17 @@
+/**
+ * @fileoverview Thumbnails module entry point
+ *
+ * This file re-exports the thumbnail functionality from the src directory.
+ * It allows for cleaner imports: `from '@native/thumbnails'` instead of `from '@native/thumbnails/src'`
+ *
+ * @module thumbnails
+ */
+
+export {
+  configureThumbnails,
+  requestThumbnail,
+  prioritizeThumbnails,
+  shutdownThumbnails,
+  isNativeThumbnailsAvailable,
+} from './src/index';
+export type { ThumbnailOptions, ThumbnailImage, ThumbnailRequest, ThumbnailViewport } from './src/index';
@@ -0,0 +1,19 @@
+/**
+ * @fileoverview Native thumbnails for FileCataloger
+ *
+ * Supported platforms:
+ * - macOS (darwin) with ImageIO
+ * - Linux with libjpeg-turbo and libpng (development, tests and benchmarks)
+ * - Everything else resolves requests to null
+ *
+ * @module thumbnails
+ */
+
+export {
+  configureThumbnails,
+  requestThumbnail,
+  prioritizeThumbnails,
+  shutdownThumbnails,
+  isNativeThumbnailsAvailable,
+} from './thumbnailService';
+export type { ThumbnailOptions, ThumbnailImage, ThumbnailRequest, ThumbnailViewport } from './thumbnailService';
@@ -0,0 +1,328 @@
+/**
+ * @file image_resize.cc
+ * @brief Box-filter downscaling kernels (scalar, SSE2, NEON)
+ */
+
+#include "image_resize.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define THUMBNAILS_RESIZE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define THUMBNAILS_RESIZE_NEON 1
+#endif
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr int kWeightBits = 14;
+constexpr int32_t kWeightOne = 1 << kWeightBits;
+constexpr int32_t kWeightRound = 1 << (kWeightBits - 1);
+
+inline uint8_t Normalize(int32_t sum) {
+    int32_t value = (sum + kWeightRound) >> kWeightBits;
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+void HorizontalScalar(const uint8_t* src, uint8_t* dst, const uint32_t* starts, const int16_t* weights,
+                      uint32_t stride, uint32_t dstWidth) {
+    for (uint32_t x = 0; x < dstWidth; x++) {
+        const uint8_t* p = src + static_cast<size_t>(starts[x]) * 4;
+        const int16_t* w = weights + static_cast<size_t>(x) * stride;
+        int32_t sum[4] = {0, 0, 0, 0};
+        for (uint32_t k = 0; k < stride; k++) {
+            for (int c = 0; c < 4; c++) {
+                sum[c] += w[k] * p[k * 4 + c];
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            dst[x * 4 + c] = Normalize(sum[c]);
+        }
+    }
+}
+
+void VerticalScalar(const uint8_t* const* rows, const int16_t* weights, uint32_t stride,
+                    uint8_t* dst, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        int32_t sum = 0;
+        for (uint32_t k = 0; k < stride; k++) {
+            sum += weights[k] * rows[k][i];
+        }
+        dst[i] = Normalize(sum);
+    }
+}
+
+#if defined(THUMBNAILS_RESIZE_SSE2)
+
+inline __m128i PairWeights(const int16_t* w) {
+    return _mm_set1_epi32(static_cast<int32_t>(static_cast<uint16_t>(w[0]) |
+                                               (static_cast<uint32_t>(static_cast<uint16_t>(w[1])) << 16)));
+}
+
+void HorizontalSimd(const uint8_t* src, uint8_t* dst, const uint32_t* starts, const int16_t* weights,
+                    uint32_t stride, uint32_t dstWidth) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(kWeightRound);
+    for (uint32_t x = 0; x < dstWidth; x++) {
+        const uint8_t* p = src + static_cast<size_t>(starts[x]) * 4;
+        const int16_t* w = weights + static_cast<size_t>(x) * stride;
+        __m128i acc = zero;
+        for (uint32_t k = 0; k < stride; k += 2) {
+            // Two pixels r0g0b0a0 r1g1b1a1 -> r0r1 g0g1 b0b1 a0a1 as 16-bit pairs
+            __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + k * 4));
+            __m128i pairs = _mm_unpacklo_epi8(_mm_unpacklo_epi8(pixels, _mm_srli_si128(pixels, 4)), zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(pairs, PairWeights(w + k)));
+        }
+        acc = _mm_srai_epi32(_mm_add_epi32(acc, round), kWeightBits);
+        acc = _mm_packus_epi16(_mm_packs_epi32(acc, acc), zero);
+        int32_t packed = _mm_cvtsi128_si32(acc);
+        std::memcpy(dst + x * 4, &packed, 4);
+    }
+}
+
+void VerticalSimd(const uint8_t* const* rows, const int16_t* weights, uint32_t stride,
+                  uint8_t* dst, size_t bytes) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(kWeightRound);
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        __m128i accLow = zero;
+        __m128i accHigh = zero;
+        for (uint32_t k = 0; k < stride; k += 2) {
+            __m128i a = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k] + i));
+            __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k + 1] + i));
+            __m128i interleaved = _mm_unpacklo_epi8(a, b);
+            __m128i weight = PairWeights(weights + k);
+            accLow = _mm_add_epi32(accLow, _mm_madd_epi16(_mm_unpacklo_epi8(interleaved, zero), weight));
+            accHigh = _mm_add_epi32(accHigh, _mm_madd_epi16(_mm_unpackhi_epi8(interleaved, zero), weight));
+        }
+        accLow = _mm_srai_epi32(_mm_add_epi32(accLow, round), kWeightBits);
+        accHigh = _mm_srai_epi32(_mm_add_epi32(accHigh, round), kWeightBits);
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(accLow, accHigh), zero);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+    VerticalScalar(rows, weights, stride, dst, i, bytes);
+}
+
+#elif defined(THUMBNAILS_RESIZE_NEON)
+
+void HorizontalSimd(const uint8_t* src, uint8_t* dst, const uint32_t* starts, const int16_t* weights,
+                    uint32_t stride, uint32_t dstWidth) {
+    for (uint32_t x = 0; x < dstWidth; x++) {
+        const uint8_t* p = src + static_cast<size_t>(starts[x]) * 4;
+        const int16_t* w = weights + static_cast<size_t>(x) * stride;
+        uint32x4_t acc = vdupq_n_u32(0);
+        for (uint32_t k = 0; k < stride; k += 2) {
+            uint16x8_t pixels = vmovl_u8(vld1_u8(p + k * 4));
+            acc = vmlal_n_u16(acc, vget_low_u16(pixels), static_cast<uint16_t>(w[k]));
+            acc = vmlal_n_u16(acc, vget_high_u16(pixels), static_cast<uint16_t>(w[k + 1]));
+        }
+        uint16x4_t narrowed = vqrshrn_n_u32(acc, kWeightBits);
+        uint8x8_t packed = vqmovn_u16(vcombine_u16(narrowed, narrowed));
+        vst1_lane_u32(reinterpret_cast<uint32_t*>(dst + x * 4), vreinterpret_u32_u8(packed), 0);
+    }
+}
+
+void VerticalSimd(const uint8_t* const* rows, const int16_t* weights, uint32_t stride,
+                  uint8_t* dst, size_t bytes) {
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint32x4_t accLow = vdupq_n_u32(0);
+        uint32x4_t accHigh = vdupq_n_u32(0);
+        for (uint32_t k = 0; k < stride; k++) {
+            uint16x8_t values = vmovl_u8(vld1_u8(rows[k] + i));
+            uint16_t weight = static_cast<uint16_t>(weights[k]);
+            accLow = vmlal_n_u16(accLow, vget_low_u16(values), weight);
+            accHigh = vmlal_n_u16(accHigh, vget_high_u16(values), weight);
+        }
+        uint16x8_t narrowed = vcombine_u16(vqrshrn_n_u32(accLow, kWeightBits), vqrshrn_n_u32(accHigh, kWeightBits));
+        vst1_u8(dst + i, vqmovn_u16(narrowed));
+    }
+    VerticalScalar(rows, weights, stride, dst, i, bytes);
+}
+
+#endif
+
+} // namespace
+
+void FitWithin(uint32_t width, uint32_t height, uint32_t maxSize, uint32_t* fitWidth, uint32_t* fitHeight) {
+    uint32_t longEdge = std::max(width, height);
+    if (longEdge <= maxSize || longEdge == 0) {
+        *fitWidth = std::max<uint32_t>(width, 1);
+        *fitHeight = std::max<uint32_t>(height, 1);
+        return;
+    }
+    auto scaled = [&](uint32_t edge) {
+        uint64_t value = (static_cast<uint64_t>(edge) * maxSize + longEdge / 2) / longEdge;
+        return static_cast<uint32_t>(std::max<uint64_t>(value, 1));
+    };
+    *fitWidth = width >= height ? maxSize : scaled(width);
+    *fitHeight = height >= width ? maxSize : scaled(height);
+}
+
+bool RgbaDownscaler::HasSimd() {
+#if defined(THUMBNAILS_RESIZE_SSE2) || defined(THUMBNAILS_RESIZE_NEON)
+    return true;
+#else
+    return false;
+#endif
+}
+
+RgbaDownscaler::Taps RgbaDownscaler::BuildTaps(uint32_t srcSize, uint32_t dstSize) {
+    Taps taps;
+    // Output o covers [o * src, (o + 1) * src) and source pixel i covers
+    // [i * dst, (i + 1) * dst) in units of 1 / (src * dst) pixels
+    uint32_t maxTaps = (srcSize + dstSize - 1) / dstSize + 1;
+    taps.stride = (maxTaps + 1) & ~1u;
+    taps.start.resize(dstSize);
+    taps.weights.assign(static_cast<size_t>(dstSize) * taps.stride, 0);
+
+    for (uint32_t o = 0; o < dstSize; o++) {
+        uint64_t begin = static_cast<uint64_t>(o) * srcSize;
+        uint64_t end = begin + srcSize;
+        uint32_t first = static_cast<uint32_t>(begin / dstSize);
+        taps.start[o] = first;
+
+        int16_t* w = &taps.weights[static_cast<size_t>(o) * taps.stride];
+        int32_t total = 0;
+        uint32_t largest = 0;
+        for (uint32_t k = 0; k < taps.stride; k++) {
+            uint64_t pixelBegin = static_cast<uint64_t>(first + k) * dstSize;
+            uint64_t pixelEnd = pixelBegin + dstSize;
+            if (first + k >= srcSize || pixelBegin >= end) {
+                break;
+            }
+            uint64_t overlap = std::min(end, pixelEnd) - std::max(begin, pixelBegin);
+            w[k] = static_cast<int16_t>((overlap * kWeightOne + srcSize / 2) / srcSize);
+            total += w[k];
+            if (w[k] > w[largest]) {
+                largest = k;
+            }
+        }
+        // Rounding can leave the sum a little off; flat areas must stay flat
+        w[largest] = static_cast<int16_t>(w[largest] + (kWeightOne - total));
+    }
+    return taps;
+}
+
+RgbaDownscaler::RgbaDownscaler(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight,
+                               bool premultiply, ResizeKernel kernel)
+    : srcWidth_(srcWidth),
+      srcHeight_(srcHeight),
+      dstWidth_(dstWidth),
+      dstHeight_(dstHeight),
+      premultiply_(premultiply),
+      simd_(kernel == ResizeKernel::Auto && HasSimd()),
+      horizontal_(BuildTaps(srcWidth, dstWidth)),
+      vertical_(BuildTaps(srcHeight, dstHeight)) {
+    // Padding lets every output read a full, even number of taps; the
+    // extra taps have zero weight
+    row_.assign((static_cast<size_t>(srcWidth_) + horizontal_.stride) * 4, 0);
+    intermediate_.assign((static_cast<size_t>(srcHeight_) + vertical_.stride) * dstWidth_ * 4, 0);
+}
+
+void RgbaDownscaler::PushRow(const uint8_t* rgba) {
+    if (rowsPushed_ >= srcHeight_) {
+        return;
+    }
+
+    size_t bytes = static_cast<size_t>(srcWidth_) * 4;
+    if (premultiply_) {
+        for (size_t i = 0; i < bytes; i += 4) {
+            uint32_t alpha = rgba[i + 3];
+            row_[i] = static_cast<uint8_t>((rgba[i] * alpha + 127) / 255);
+            row_[i + 1] = static_cast<uint8_t>((rgba[i + 1] * alpha + 127) / 255);
+            row_[i + 2] = static_cast<uint8_t>((rgba[i + 2] * alpha + 127) / 255);
+            row_[i + 3] = static_cast<uint8_t>(alpha);
+        }
+    } else {
+        std::memcpy(row_.data(), rgba, bytes);
+    }
+
+    uint8_t* dst = &intermediate_[static_cast<size_t>(rowsPushed_) * dstWidth_ * 4];
+    if (simd_) {
+#if defined(THUMBNAILS_RESIZE_SSE2) || defined(THUMBNAILS_RESIZE_NEON)
+        HorizontalSimd(row_.data(), dst, horizontal_.start.data(), horizontal_.weights.data(),
+                       horizontal_.stride, dstWidth_);
+#endif
+    } else {
+        HorizontalScalar(row_.data(), dst, horizontal_.start.data(), horizontal_.weights.data(),
+                         horizontal_.stride, dstWidth_);
+    }
+    rowsPushed_++;
+}
+
+void RgbaDownscaler::Finish(uint8_t* out) {
+    const size_t rowBytes = static_cast<size_t>(dstWidth_) * 4;
+    std::vector<const uint8_t*> rows(vertical_.stride);
+
+    for (uint32_t y = 0; y < dstHeight_; y++) {
+        const uint32_t start = vertical_.start[y];
+        for (uint32_t k = 0; k < vertical_.stride; k++) {
+            rows[k] = &intermediate_[(static_cast<size_t>(start) + k) * rowBytes];
+        }
+        const int16_t* weights = &vertical_.weights[static_cast<size_t>(y) * vertical_.stride];
+        uint8_t* dst = out + static_cast<size_t>(y) * rowBytes;
+        if (simd_) {
+#if defined(THUMBNAILS_RESIZE_SSE2) || defined(THUMBNAILS_RESIZE_NEON)
+            VerticalSimd(rows.data(), weights, vertical_.stride, dst, rowBytes);
+#endif
+        } else {
+            VerticalScalar(rows.data(), weights, vertical_.stride, dst, 0, rowBytes);
+        }
+    }
+
+    if (premultiply_) {
+        size_t bytes = rowBytes * dstHeight_;
+        for (size_t i = 0; i < bytes; i += 4) {
+            uint32_t alpha = out[i + 3];
+            for (int c = 0; c < 3; c++) {
+                out[i + c] = alpha == 0 ? 0 : static_cast<uint8_t>(std::min<uint32_t>(255, (out[i + c] * 255 + alpha / 2) / alpha));
+            }
+        }
+    }
+}
+
+void ApplyExifOrientation(std::vector<uint8_t>* rgba, uint32_t* width, uint32_t* height, int orientation) {
+    if (orientation < 2 || orientation > 8) {
+        return;
+    }
+
+    const uint32_t w = *width;
+    const uint32_t h = *height;
+    const bool swap = orientation >= 5;
+    const uint32_t outWidth = swap ? h : w;
+    const uint32_t outHeight = swap ? w : h;
+
+    const auto* src = reinterpret_cast<const uint32_t*>(rgba->data());
+    std::vector<uint8_t> rotated(rgba->size());
+    auto* dst = reinterpret_cast<uint32_t*>(rotated.data());
+
+    for (uint32_t y = 0; y < outHeight; y++) {
+        for (uint32_t x = 0; x < outWidth; x++) {
+            uint32_t sx = x;
+            uint32_t sy = y;
+            switch (orientation) {
+                case 2: sx = w - 1 - x; sy = y; break;              // mirror horizontal
+                case 3: sx = w - 1 - x; sy = h - 1 - y; break;      // rotate 180
+                case 4: sx = x; sy = h - 1 - y; break;              // mirror vertical
+                case 5: sx = y; sy = x; break;                      // transpose
+                case 6: sx = y; sy = h - 1 - x; break;              // rotate 90 clockwise
+                case 7: sx = w - 1 - y; sy = h - 1 - x; break;      // transverse
+                case 8: sx = w - 1 - y; sy = x; break;              // rotate 90 counter-clockwise
+            }
+            dst[static_cast<size_t>(y) * outWidth + x] = src[static_cast<size_t>(sy) * w + sx];
+        }
+    }
+
+    rgba->swap(rotated);
+    *width = outWidth;
+    *height = outHeight;
+}
+
+} // namespace FileCataloger
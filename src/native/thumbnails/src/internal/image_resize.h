@@ -0,0 +1,80 @@
+/**
+ * @file image_resize.h
+ * @brief Streaming RGBA area-average downscaler and orientation helpers
+ *
+ * RgbaDownscaler takes source rows one at a time, as a decoder produces
+ * them, and resizes each row horizontally straight away. Only the
+ * horizontally reduced image (dstWidth x srcHeight) is kept, so a 24MP
+ * photo never needs a full-size RGBA buffer. The vertical pass runs in
+ * Finish().
+ *
+ * Both passes are a box (area-average) filter with 14-bit fixed-point
+ * weights. Pairs of taps are accumulated with SSE2 madd on x86-64 and
+ * NEON widening multiply-accumulate on ARM64. The scalar kernel performs
+ * the same integer arithmetic, so all kernels produce identical output.
+ */
+
+#ifndef THUMBNAILS_IMAGE_RESIZE_H
+#define THUMBNAILS_IMAGE_RESIZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FileCataloger {
+
+enum class ResizeKernel {
+    Auto,    // SIMD when the target supports it
+    Scalar
+};
+
+// Largest size with the source aspect ratio whose long edge is at most
+// maxSize. Never upscales; both dimensions are at least 1.
+void FitWithin(uint32_t width, uint32_t height, uint32_t maxSize, uint32_t* fitWidth, uint32_t* fitHeight);
+
+class RgbaDownscaler {
+public:
+    // With premultiply, color is weighted by alpha while filtering, which
+    // keeps transparent pixels from darkening edges. Output is straight alpha.
+    RgbaDownscaler(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight,
+                   bool premultiply, ResizeKernel kernel = ResizeKernel::Auto);
+
+    // srcWidth * 4 bytes of RGBA; rows must arrive top to bottom
+    void PushRow(const uint8_t* rgba);
+    uint32_t RowsPushed() const { return rowsPushed_; }
+
+    // Requires every source row; writes dstWidth * dstHeight * 4 bytes
+    void Finish(uint8_t* out);
+
+    static bool HasSimd();
+
+private:
+    struct Taps {
+        std::vector<uint32_t> start;   // first source index per output index
+        std::vector<int16_t> weights;  // stride entries per output index, zero padded
+        uint32_t stride = 0;           // taps per output, always even
+    };
+
+    static Taps BuildTaps(uint32_t srcSize, uint32_t dstSize);
+
+    uint32_t srcWidth_;
+    uint32_t srcHeight_;
+    uint32_t dstWidth_;
+    uint32_t dstHeight_;
+    bool premultiply_;
+    bool simd_;
+    uint32_t rowsPushed_ = 0;
+
+    Taps horizontal_;
+    Taps vertical_;
+    std::vector<uint8_t> row_;           // one padded source row
+    std::vector<uint8_t> intermediate_;  // dstWidth x (srcHeight + padding) rows
+};
+
+// Rotate/flip a packed RGBA image in place per EXIF orientation 1-8,
+// updating width and height. Other values leave the image untouched.
+void ApplyExifOrientation(std::vector<uint8_t>* rgba, uint32_t* width, uint32_t* height, int orientation);
+
+} // namespace FileCataloger
+
+#endif // THUMBNAILS_IMAGE_RESIZE_H
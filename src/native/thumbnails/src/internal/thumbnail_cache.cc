@@ -0,0 +1,350 @@
+/**
+ * @file thumbnail_cache.cc
+ * @brief Content-keyed on-disk thumbnail cache
+ */
+
+#include "thumbnail_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+namespace FileCataloger {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'C', 'T', 'H', 'U', 'M', 'B', '1'};
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kMaxRememberedKeys = 1 << 16;
+
+constexpr uint64_t kPrime1 = 11400714785074694791ull;
+constexpr uint64_t kPrime2 = 14029467366897019727ull;
+constexpr uint64_t kPrime3 = 1609587929392839161ull;
+constexpr uint64_t kPrime4 = 9650029242287828579ull;
+constexpr uint64_t kPrime5 = 2870177450012600261ull;
+
+inline uint64_t Rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t Read64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, 8);
+    return value;  // little-endian targets only (x86-64, arm64)
+}
+
+inline uint32_t Read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+inline uint64_t Round(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    return Rotl(acc, 31) * kPrime1;
+}
+
+inline uint64_t MergeRound(uint64_t acc, uint64_t value) {
+    acc ^= Round(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+void PutU32(uint8_t* p, uint32_t value) {
+    memcpy(p, &value, 4);
+}
+
+int64_t MtimeNs(const struct stat& st) {
+#if defined(__APPLE__)
+    const struct timespec& ts = st.st_mtimespec;
+#else
+    const struct timespec& ts = st.st_mtim;
+#endif
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+bool ReadWholeFile(int fd, std::vector<uint8_t>* out) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kHeaderSize)) {
+        return false;
+    }
+    out->resize(static_cast<size_t>(st.st_size));
+    size_t done = 0;
+    while (done < out->size()) {
+        ssize_t n = pread(fd, out->data() + done, out->size() - done, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool WriteAll(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t HashContent(const uint8_t* data, size_t size) {
+    uint64_t hash = 0;
+    HashContent(data, size, CancellationToken(), &hash);
+    return hash;
+}
+
+bool HashContent(const uint8_t* data, size_t size, const CancellationToken& token, uint64_t* out) {
+    static_assert((HASH_CHUNK_BYTES & (HASH_CHUNK_BYTES - 1)) == 0, "a power of two, checked with a mask");
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint64_t hash;
+
+    if (size >= 32) {
+        uint64_t v1 = kPrime1 + kPrime2;
+        uint64_t v2 = kPrime2;
+        uint64_t v3 = 0;
+        uint64_t v4 = 0 - kPrime1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+            p += 32;
+            if ((static_cast<size_t>(p - data) & (HASH_CHUNK_BYTES - 1)) == 0 && token.IsCancelled()) {
+                return false;
+            }
+        } while (p <= limit);
+        hash = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+        hash = MergeRound(hash, v1);
+        hash = MergeRound(hash, v2);
+        hash = MergeRound(hash, v3);
+        hash = MergeRound(hash, v4);
+    } else {
+        hash = kPrime5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+    for (; p + 8 <= end; p += 8) {
+        hash ^= Round(0, Read64(p));
+        hash = Rotl(hash, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        hash ^= static_cast<uint64_t>(Read32(p)) * kPrime1;
+        hash = Rotl(hash, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= *p * kPrime5;
+        hash = Rotl(hash, 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    *out = hash;
+    return true;
+}
+
+ThumbnailCache::ThumbnailCache(std::string directory, uint64_t maxBytes)
+    : directory_(std::move(directory)), maxBytes_(maxBytes) {
+    if (!directory_.empty()) {
+        mkdir(directory_.c_str(), 0755);
+    }
+}
+
+ThumbnailCache::FileIdentity ThumbnailCache::IdentityOf(const struct stat& st) {
+    return FileIdentity{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino),
+                        static_cast<uint64_t>(st.st_size), MtimeNs(st)};
+}
+
+bool ThumbnailCache::LookupKey(const struct stat& st, ContentKey* key) const {
+    std::lock_guard<std::mutex> lock(keysMutex_);
+    auto it = keys_.find(IdentityOf(st));
+    if (it == keys_.end()) {
+        return false;
+    }
+    *key = it->second;
+    return true;
+}
+
+void ThumbnailCache::RememberKey(const struct stat& st, const ContentKey& key) {
+    std::lock_guard<std::mutex> lock(keysMutex_);
+    if (keys_.size() >= kMaxRememberedKeys) {
+        keys_.clear();
+    }
+    keys_[IdentityOf(st)] = key;
+}
+
+std::string ThumbnailCache::EntryPath(const ContentKey& key, uint32_t maxSize) const {
+    char name[80];
+    snprintf(name, sizeof(name), "/%02x/%016" PRIx64 "-%" PRIu64 "-%u.thumb",
+             static_cast<unsigned>(key.hash >> 56), key.hash, key.size, maxSize);
+    return directory_ + name;
+}
+
+bool ThumbnailCache::Load(const ContentKey& key, uint32_t maxSize, Thumbnail* thumbnail) {
+    if (directory_.empty()) {
+        return false;
+    }
+
+    int fd = open(EntryPath(key, maxSize).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::vector<uint8_t> file;
+    bool ok = ReadWholeFile(fd, &file) && memcmp(file.data(), kMagic, sizeof(kMagic)) == 0;
+    if (ok) {
+        uint32_t header[6];
+        memcpy(header, file.data() + 8, sizeof(header));
+        const uint32_t width = header[0];
+        const uint32_t height = header[1];
+        const uint32_t rawLength = header[4];
+        const uint32_t compressedLength = header[5];
+        ok = rawLength == static_cast<uint64_t>(width) * height * 4 &&
+             compressedLength == file.size() - kHeaderSize;
+        if (ok) {
+            thumbnail->rgba.resize(rawLength);
+            uLongf length = rawLength;
+            ok = uncompress(thumbnail->rgba.data(), &length, file.data() + kHeaderSize, compressedLength) == Z_OK &&
+                 length == rawLength;
+        }
+        if (ok) {
+            thumbnail->width = width;
+            thumbnail->height = height;
+            thumbnail->sourceWidth = header[2];
+            thumbnail->sourceHeight = header[3];
+            // Recently used entries survive Prune()
+            futimens(fd, nullptr);
+        }
+    }
+    close(fd);
+
+    (ok ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return ok;
+}
+
+int ThumbnailCache::Store(const ContentKey& key, uint32_t maxSize, const Thumbnail& thumbnail) {
+    if (directory_.empty()) {
+        return 0;
+    }
+
+    std::vector<uint8_t> file(kHeaderSize + compressBound(thumbnail.rgba.size()));
+    uLongf compressedLength = file.size() - kHeaderSize;
+    if (compress2(file.data() + kHeaderSize, &compressedLength, thumbnail.rgba.data(),
+                  thumbnail.rgba.size(), Z_BEST_SPEED) != Z_OK) {
+        return ENOMEM;
+    }
+    file.resize(kHeaderSize + compressedLength);
+    memcpy(file.data(), kMagic, sizeof(kMagic));
+    PutU32(&file[8], thumbnail.width);
+    PutU32(&file[12], thumbnail.height);
+    PutU32(&file[16], thumbnail.sourceWidth);
+    PutU32(&file[20], thumbnail.sourceHeight);
+    PutU32(&file[24], static_cast<uint32_t>(thumbnail.rgba.size()));
+    PutU32(&file[28], static_cast<uint32_t>(compressedLength));
+
+    const std::string path = EntryPath(key, maxSize);
+    mkdir(path.substr(0, directory_.size() + 3).c_str(), 0755);
+
+    static std::atomic<uint64_t> tempCounter{0};
+    const std::string tempPath = path + "." + std::to_string(getpid()) + "." +
+                                 std::to_string(tempCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return errno;
+    }
+    int error = WriteAll(fd, file.data(), file.size()) ? 0 : (errno ? errno : EIO);
+    close(fd);
+    if (error == 0 && rename(tempPath.c_str(), path.c_str()) != 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        unlink(tempPath.c_str());
+        return error;
+    }
+
+    if (storesSincePrune_.fetch_add(1, std::memory_order_relaxed) + 1 >= PRUNE_INTERVAL) {
+        storesSincePrune_.store(0, std::memory_order_relaxed);
+        Prune();
+    }
+    return 0;
+}
+
+void ThumbnailCache::Prune() {
+    if (directory_.empty()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(pruneMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;  // another worker is already pruning
+    }
+
+    // (mtime, size, path) for every entry
+    std::vector<std::tuple<int64_t, uint64_t, std::string>> entries;
+    uint64_t total = 0;
+    for (unsigned bucket = 0; bucket < 256; bucket++) {
+        char suffix[8];
+        snprintf(suffix, sizeof(suffix), "/%02x", bucket);
+        const std::string bucketPath = directory_ + suffix;
+        DIR* dir = opendir(bucketPath.c_str());
+        if (!dir) {
+            continue;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+            std::string path = bucketPath + "/" + entry->d_name;
+            struct stat st;
+            if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+                total += static_cast<uint64_t>(st.st_size);
+                entries.emplace_back(MtimeNs(st), static_cast<uint64_t>(st.st_size), std::move(path));
+            }
+        }
+        closedir(dir);
+    }
+
+    if (total <= maxBytes_) {
+        return;
+    }
+
+    // Trim to 90% so the next few stores do not trigger another scan
+    const uint64_t target = maxBytes_ / 10 * 9;
+    std::sort(entries.begin(), entries.end());
+    for (const auto& entry : entries) {
+        if (total <= target) {
+            break;
+        }
+        if (unlink(std::get<2>(entry).c_str()) == 0) {
+            total -= std::get<1>(entry);
+        }
+    }
+}
+
+} // namespace FileCataloger
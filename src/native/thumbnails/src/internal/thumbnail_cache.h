@@ -0,0 +1,112 @@
+/**
+ * @file thumbnail_cache.h
+ * @brief Content-keyed on-disk thumbnail cache
+ *
+ * Thumbnails are keyed by a 64-bit hash of the file's bytes plus its size,
+ * so a copied, moved or re-downloaded photo hits the same entry, and an
+ * edited one never serves a stale thumbnail. Hashing reads the whole file,
+ * so the key is remembered per (device, inode, size, mtime) for the life of
+ * the process; the hash is only recomputed when that identity changes.
+ *
+ * Layout: <directory>/<first two hex digits>/<hash>-<size>-<maxSize>.thumb,
+ * each holding a small header and the zlib-compressed RGBA pixels. Entries
+ * are written to a temporary name and renamed into place, so readers never
+ * see a partial file. A hit touches the entry's mtime and Prune() deletes
+ * the least recently used entries once the directory exceeds its budget.
+ *
+ * All methods are thread-safe.
+ */
+
+#ifndef THUMBNAILS_THUMBNAIL_CACHE_H
+#define THUMBNAILS_THUMBNAIL_CACHE_H
+
+#include <sys/stat.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "cancellation_token.h"
+#include "thumbnail_decoder.h"
+
+namespace FileCataloger {
+
+struct ContentKey {
+    uint64_t hash = 0;
+    uint64_t size = 0;
+};
+
+// XXH64 with seed 0
+uint64_t HashContent(const uint8_t* data, size_t size);
+
+// The same, polling token after every HASH_CHUNK_BYTES; false, with no
+// hash, when it was cancelled first
+constexpr size_t HASH_CHUNK_BYTES = 1 << 20;
+bool HashContent(const uint8_t* data, size_t size, const CancellationToken& token, uint64_t* hash);
+
+class ThumbnailCache {
+public:
+    static constexpr uint64_t DEFAULT_MAX_BYTES = 256ull << 20;
+
+    // An empty directory disables the disk cache; content keys are still memoized
+    explicit ThumbnailCache(std::string directory, uint64_t maxBytes = DEFAULT_MAX_BYTES);
+
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    // Content key remembered for this file identity, if any
+    bool LookupKey(const struct stat& st, ContentKey* key) const;
+    void RememberKey(const struct stat& st, const ContentKey& key);
+
+    bool Load(const ContentKey& key, uint32_t maxSize, Thumbnail* thumbnail);
+
+    // Returns 0 or errno; prunes every PRUNE_INTERVAL stores
+    int Store(const ContentKey& key, uint32_t maxSize, const Thumbnail& thumbnail);
+
+    // Delete least recently used entries until the cache fits maxBytes
+    void Prune();
+
+    uint64_t Hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t Misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t PRUNE_INTERVAL = 64;
+
+    struct FileIdentity {
+        uint64_t dev;
+        uint64_t ino;
+        uint64_t size;
+        int64_t mtimeNs;
+        bool operator==(const FileIdentity& other) const {
+            return dev == other.dev && ino == other.ino && size == other.size && mtimeNs == other.mtimeNs;
+        }
+    };
+
+    struct FileIdentityHash {
+        size_t operator()(const FileIdentity& identity) const {
+            return std::hash<uint64_t>()(identity.ino * 0x9E3779B97F4A7C15ull ^ identity.dev ^
+                                         static_cast<uint64_t>(identity.mtimeNs));
+        }
+    };
+
+    static FileIdentity IdentityOf(const struct stat& st);
+    std::string EntryPath(const ContentKey& key, uint32_t maxSize) const;
+
+    std::string directory_;
+    uint64_t maxBytes_;
+
+    mutable std::mutex keysMutex_;
+    std::unordered_map<FileIdentity, ContentKey, FileIdentityHash> keys_;
+
+    std::mutex pruneMutex_;
+    std::atomic<uint32_t> storesSincePrune_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace FileCataloger
+
+#endif // THUMBNAILS_THUMBNAIL_CACHE_H
@@ -0,0 +1,66 @@
+/**
+ * @file thumbnail_decoder.h
+ * @brief Decode an encoded image straight to a bounded RGBA thumbnail
+ *
+ * Implemented per platform:
+ * - Linux: libjpeg-turbo and libpng (src/native/linux/thumbnail_decoder_linux.cc).
+ *   JPEGs are reduced in the DCT domain (scale_denom 2/4/8) to the smallest
+ *   size that is still at least the target, and every decoded scanline goes
+ *   straight into RgbaDownscaler, so no full-resolution buffer is allocated.
+ * - macOS: ImageIO's CGImageSourceCreateThumbnailAtIndex, which uses the same
+ *   reduced decoding internally (src/native/mac/thumbnail_decoder_mac.mm).
+ *
+ * Decoding is reentrant; the thumbnail service calls it from several workers.
+ */
+
+#ifndef THUMBNAILS_THUMBNAIL_DECODER_H
+#define THUMBNAILS_THUMBNAIL_DECODER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "image_resize.h"
+
+namespace FileCataloger {
+
+enum class ImageFormat {
+    Unknown,
+    Jpeg,
+    Png
+};
+
+struct DecodeOptions {
+    uint32_t maxSize = 256;        // long edge of the thumbnail
+    bool reducedDecode = true;     // JPEG DCT-domain scaling; off only for benchmarks
+    ResizeKernel kernel = ResizeKernel::Auto;
+};
+
+struct Thumbnail {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t sourceWidth = 0;      // after EXIF orientation
+    uint32_t sourceHeight = 0;
+    std::vector<uint8_t> rgba;     // width * height * 4, straight alpha
+};
+
+inline ImageFormat DetectImageFormat(const uint8_t* data, size_t size) {
+    static const uint8_t kPngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF) {
+        return ImageFormat::Jpeg;
+    }
+    if (size >= 8 && std::equal(kPngSignature, kPngSignature + 8, data)) {
+        return ImageFormat::Png;
+    }
+    return ImageFormat::Unknown;
+}
+
+// Returns false and sets error for unsupported or corrupt data
+bool DecodeThumbnail(const uint8_t* data, size_t size, const DecodeOptions& options,
+                     Thumbnail* thumbnail, std::string* error);
+
+} // namespace FileCataloger
+
+#endif // THUMBNAILS_THUMBNAIL_DECODER_H
@@ -0,0 +1,383 @@
+/**
+ * @file thumbnail_service.cc
+ * @brief Bounded, prioritized thumbnail generation
+ */
+
+#include "thumbnail_service.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <string_view>
+
+namespace FileCataloger {
+
+namespace {
+
+// Read-only mapping of a file, released on scope exit
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() {
+        if (data_) {
+            munmap(data_, size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    int Map(int fd, size_t size) {
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            return errno;
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+        data_ = data;
+        size_ = size;
+        return 0;
+    }
+
+    const uint8_t* data() const { return static_cast<const uint8_t*>(data_); }
+    size_t size() const { return size_; }
+    bool mapped() const { return data_ != nullptr; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace
+
+ThumbnailService::ThumbnailService(std::shared_ptr<ThumbnailCache> cache, ThumbnailServiceOptions options,
+                                   ResultSink sink)
+    : cache_(std::move(cache)), options_(options), sink_(std::move(sink)) {
+    size_t count = options_.workers;
+    if (count == 0) {
+        count = std::min<size_t>(4, std::max<unsigned>(1, std::thread::hardware_concurrency()));
+    }
+    workers_.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        workers_.emplace_back([this] { RunWorker(); });
+    }
+}
+
+ThumbnailService::~ThumbnailService() {
+    Shutdown();
+}
+
+uint64_t ThumbnailService::Request(std::string path, ThumbnailPriority priority) {
+    std::vector<uint64_t> dropped;
+    uint64_t id;
+    bool added = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+        paths_.emplace(id, path);
+
+        auto running = running_.find(path);
+        uint64_t rank;
+        if (running != running_.end()) {
+            running->second.ids.push_back(id);
+        } else if (Job* job = queue_.Find(path)) {
+            job->ids.push_back(id);
+            if (queue_.RankOf(path, &rank) && static_cast<uint32_t>(priority) < RankBand(rank)) {
+                queue_.Update(path, RankFor(priority));
+            }
+        } else {
+            queue_.Push(std::move(path), Job{{id}}, RankFor(priority));
+            added = true;
+        }
+
+        while (queue_.Size() > options_.maxQueued) {
+            const auto* victim = queue_.OldestOfLastBand();
+            std::string victimPath = victim->key;
+            IndexedHeap<std::string, Job>::Entry removed;
+            queue_.Erase(victimPath, &removed);
+            for (uint64_t victimId : removed.value.ids) {
+                paths_.erase(victimId);
+                dropped.push_back(victimId);
+            }
+        }
+    }
+    if (added) {
+        cv_.notify_one();
+    }
+    DeliverCancelled(dropped);
+    return id;
+}
+
+bool ThumbnailService::SetPriority(uint64_t id, ThumbnailPriority priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = paths_.find(id);
+    uint64_t rank;
+    if (it == paths_.end() || !queue_.RankOf(it->second, &rank)) {
+        return false;
+    }
+    if (RankBand(rank) != static_cast<uint32_t>(priority)) {
+        queue_.Update(it->second, RankFor(priority));
+    }
+    return true;
+}
+
+size_t ThumbnailService::Prioritize(const std::vector<std::pair<std::string, ThumbnailPriority>>& items) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Fresh ranks in items order; a path listed twice keeps the more urgent one
+    std::unordered_map<std::string_view, uint64_t> ranks;
+    ranks.reserve(items.size());
+    for (const auto& [path, priority] : items) {
+        if (!queue_.Contains(path)) {
+            continue;
+        }
+        uint64_t rank = RankFor(priority);
+        auto [it, inserted] = ranks.emplace(path, rank);
+        if (!inserted && rank < it->second) {
+            it->second = rank;
+        }
+    }
+
+    const uint32_t background = static_cast<uint32_t>(ThumbnailPriority::Background);
+    queue_.RerankAll([&](const std::string& path, Job&, uint64_t& rank) {
+        auto it = ranks.find(path);
+        if (it != ranks.end()) {
+            rank = it->second;
+        } else if (RankBand(rank) < background) {
+            // Keeps its sequence, so demoted jobs stay in their old order
+            rank = MakeRank(background, rank);
+        }
+    });
+    return ranks.size();
+}
+
+bool ThumbnailService::Cancel(uint64_t id) {
+    std::vector<uint64_t> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = paths_.find(id);
+        if (it == paths_.end()) {
+            return false;
+        }
+        auto running = running_.find(it->second);
+        if (running != running_.end()) {
+            cancelledRunning_.insert(id);
+            // Stop the job itself only when nobody is left waiting on it
+            const std::vector<uint64_t>& ids = running->second.ids;
+            if (std::all_of(ids.begin(), ids.end(),
+                            [this](uint64_t other) { return cancelledRunning_.count(other) > 0; })) {
+                running->second.cancel->Cancel();
+            }
+            return true;
+        }
+        Job* job = queue_.Find(it->second);
+        job->ids.erase(std::find(job->ids.begin(), job->ids.end(), id));
+        if (job->ids.empty()) {
+            queue_.Erase(it->second);
+        }
+        paths_.erase(it);
+        cancelled.push_back(id);
+    }
+    DeliverCancelled(cancelled);
+    return true;
+}
+
+void ThumbnailService::CancelAll() {
+    std::vector<uint64_t> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.ForEach([&](const std::string&, const Job& job, uint64_t) {
+            for (uint64_t id : job.ids) {
+                paths_.erase(id);
+                cancelled.push_back(id);
+            }
+        });
+        queue_.Clear();
+        for (auto& [path, job] : running_) {
+            cancelledRunning_.insert(job.ids.begin(), job.ids.end());
+            job.cancel->Cancel();
+        }
+    }
+    DeliverCancelled(cancelled);
+}
+
+void ThumbnailService::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+        queue_.Clear();
+        for (auto& [path, job] : running_) {
+            job.cancel->Cancel();
+        }
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+size_t ThumbnailService::QueuedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.Size();
+}
+
+void ThumbnailService::DeliverCancelled(std::vector<uint64_t>& ids) {
+    for (uint64_t id : ids) {
+        ThumbnailResult result;
+        result.id = id;
+        result.cancelled = true;
+        sink_(std::move(result));
+    }
+}
+
+void ThumbnailService::RunWorker() {
+    for (;;) {
+        std::string path;
+        CancellationToken token;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.Empty(); });
+            if (stopping_) {
+                return;
+            }
+            auto entry = queue_.Pop();
+            path = std::move(entry.key);
+            RunningJob job{std::move(entry.value.ids), std::make_unique<CancellationSource>()};
+            token = job.cancel->Token();
+            running_.emplace(path, std::move(job));
+        }
+
+        ThumbnailResult generated = Generate(path, token);
+
+        std::vector<ThumbnailResult> results;
+        bool requeued = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto running = running_.find(path);
+            std::vector<uint64_t> ids = std::move(running->second.ids);
+            running_.erase(running);
+            if (stopping_) {
+                return;
+            }
+            if (generated.cancelled) {
+                // Requests that joined after the job was stopped still want it
+                auto joined = std::stable_partition(ids.begin(), ids.end(),
+                                                    [this](uint64_t id) { return cancelledRunning_.count(id) > 0; });
+                if (joined != ids.end()) {
+                    Job again{std::vector<uint64_t>(joined, ids.end())};
+                    queue_.Push(path, std::move(again), RankFor(ThumbnailPriority::Visible));
+                    ids.erase(joined, ids.end());
+                    requeued = true;
+                }
+            }
+            // Requests that joined while it ran share the result
+            results.reserve(ids.size());
+            for (size_t i = 0; i < ids.size(); i++) {
+                uint64_t id = ids[i];
+                paths_.erase(id);
+                ThumbnailResult result;
+                if (cancelledRunning_.erase(id)) {
+                    result.cancelled = true;
+                } else if (i + 1 == ids.size()) {
+                    result = std::move(generated);
+                } else {
+                    result = generated;
+                }
+                result.id = id;
+                results.push_back(std::move(result));
+            }
+        }
+        if (requeued) {
+            cv_.notify_one();
+        }
+        for (ThumbnailResult& result : results) {
+            sink_(std::move(result));
+        }
+    }
+}
+
+ThumbnailResult ThumbnailService::Generate(const std::string& path, const CancellationToken& token) const {
+    ThumbnailResult result;
+
+    // O_NONBLOCK: opening a FIFO must not hold the worker until a writer
+    // appears; the fstat below then rejects it
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        result.errorCode = errno;
+        result.error = "Cannot open file";
+        return result;
+    }
+
+    struct stat st;
+    MappedFile file;
+    if (fstat(fd, &st) != 0) {
+        result.errorCode = errno;
+        result.error = "Cannot stat file";
+    } else if (!S_ISREG(st.st_mode)) {
+        result.errorCode = EISDIR;
+        result.error = "Not a regular file";
+    } else if (static_cast<uint64_t>(st.st_size) > options_.maxFileSize) {
+        result.errorCode = EFBIG;
+        result.error = "File too large for a thumbnail";
+    } else if (st.st_size == 0) {
+        result.error = "Unsupported image format";
+    }
+    if (!result.error.empty()) {
+        close(fd);
+        return result;
+    }
+
+    // The content key needs the bytes only the first time this file identity is seen
+    ContentKey key;
+    int error = 0;
+    if (!cache_->LookupKey(st, &key)) {
+        error = file.Map(fd, static_cast<size_t>(st.st_size));
+        if (error == 0) {
+            if (!HashContent(file.data(), file.size(), token, &key.hash)) {
+                result.cancelled = true;
+                close(fd);
+                return result;
+            }
+            key.size = file.size();
+            cache_->RememberKey(st, key);
+        }
+    }
+
+    if (error == 0 && cache_->Load(key, options_.maxSize, &result.thumbnail)) {
+        result.cached = true;
+        close(fd);
+        return result;
+    }
+
+    if (error == 0 && !file.mapped()) {
+        error = file.Map(fd, static_cast<size_t>(st.st_size));
+    }
+    close(fd);
+    if (error != 0) {
+        result.errorCode = error;
+        result.error = "Cannot map file";
+        return result;
+    }
+
+    DecodeOptions decodeOptions;
+    decodeOptions.maxSize = options_.maxSize;
+    decodeOptions.kernel = options_.kernel;
+    if (!DecodeThumbnail(file.data(), file.size(), decodeOptions, &result.thumbnail, &result.error)) {
+        result.thumbnail = Thumbnail();
+        return result;
+    }
+
+    // A failed store only costs a decode next time
+    cache_->Store(key, options_.maxSize, result.thumbnail);
+    return result;
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,149 @@
+/**
+ * @file thumbnail_service.h
+ * @brief Bounded, prioritized thumbnail generation
+ *
+ * A fixed set of workers takes jobs from an IndexedHeap (common/indexed_heap.h)
+ * keyed by path: hovered first, then the visible rows in on-screen order,
+ * then the selection, then background prefetch. Each job maps the file,
+ * resolves its content key, and either loads the cached thumbnail or
+ * decodes and stores a new one.
+ *
+ * Requests for a path that is already queued or being generated join that
+ * job instead of adding one, and each of their ids gets the result.
+ * Prioritize() takes the whole viewport at once (hovered item, visible
+ * range, selection) and re-ranks queued jobs in place; jobs it does not
+ * name drop back to background. Nothing is cancelled and resubmitted, so
+ * scrolling only reorders work.
+ *
+ * The queue is bounded. When it is full, the oldest job of the least urgent
+ * band is dropped and its requests are reported as cancelled, so scrolling
+ * through a huge shelf never builds an unbounded backlog. Every request gets
+ * exactly one result through the sink, which is called from a worker
+ * thread, or from the calling thread for requests cancelled or dropped
+ * before they started. A running job whose requests are all cancelled
+ * stops hashing within HASH_CHUNK_BYTES, and Shutdown() stops every one.
+ */
+
+#ifndef THUMBNAILS_THUMBNAIL_SERVICE_H
+#define THUMBNAILS_THUMBNAIL_SERVICE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "indexed_heap.h"
+#include "thumbnail_cache.h"
+#include "thumbnail_decoder.h"
+
+namespace FileCataloger {
+
+// Bands, most urgent first; jobs within a band run in the order they were ranked
+enum class ThumbnailPriority : uint8_t {
+    Hovered = 0,
+    Visible = 1,
+    Selected = 2,
+    Background = 3
+};
+
+struct ThumbnailResult {
+    uint64_t id = 0;
+    Thumbnail thumbnail;
+    bool cached = false;
+    bool cancelled = false;
+    int errorCode = 0;     // errno for I/O failures, 0 for decode failures
+    std::string error;     // empty on success
+};
+
+struct ThumbnailServiceOptions {
+    uint32_t maxSize = 256;
+    size_t workers = 0;                        // 0: hardware threads, 1 to 4
+    size_t maxQueued = 512;                    // distinct paths waiting
+    uint64_t maxFileSize = 256ull << 20;       // larger files are refused
+    ResizeKernel kernel = ResizeKernel::Auto;
+};
+
+class ThumbnailService {
+public:
+    using ResultSink = std::function<void(ThumbnailResult&&)>;
+
+    ThumbnailService(std::shared_ptr<ThumbnailCache> cache, ThumbnailServiceOptions options, ResultSink sink);
+    ~ThumbnailService();
+
+    ThumbnailService(const ThumbnailService&) = delete;
+    ThumbnailService& operator=(const ThumbnailService&) = delete;
+
+    // A path already queued or running is not generated twice; a queued
+    // job moves up to priority if that is more urgent
+    uint64_t Request(std::string path, ThumbnailPriority priority);
+
+    // Moves a queued request's job to the back of the priority band; false
+    // if it already started
+    bool SetPriority(uint64_t id, ThumbnailPriority priority);
+
+    // Viewport update: each queued path in items moves to its band, in
+    // items order; other queued jobs above Background drop to Background.
+    // One pass over the queue. Returns how many items were queued.
+    size_t Prioritize(const std::vector<std::pair<std::string, ThumbnailPriority>>& items);
+
+    // Queued requests are reported cancelled at once; a running one is
+    // reported cancelled when its job finishes, which is early once every
+    // request on the job is cancelled. False for unknown ids.
+    bool Cancel(uint64_t id);
+    void CancelAll();
+
+    // Cancels everything and joins the workers; no results follow
+    void Shutdown();
+
+    // Distinct paths waiting for a worker
+    size_t QueuedCount() const;
+    size_t WorkerCount() const { return workers_.size(); }
+
+    // Generate one thumbnail on the calling thread, bypassing the queue.
+    // The content hash polls token; when it fires the result is cancelled.
+    ThumbnailResult Generate(const std::string& path, const CancellationToken& token = CancellationToken()) const;
+
+private:
+    // Requests coalesced onto one path
+    struct Job {
+        std::vector<uint64_t> ids;
+    };
+
+    // A job a worker has taken, with the requests now waiting on it
+    struct RunningJob {
+        std::vector<uint64_t> ids;
+        std::unique_ptr<CancellationSource> cancel;
+    };
+
+    void RunWorker();
+    void DeliverCancelled(std::vector<uint64_t>& ids);
+    uint64_t RankFor(ThumbnailPriority priority) { return MakeRank(static_cast<uint32_t>(priority), nextRank_++); }
+
+    std::shared_ptr<ThumbnailCache> cache_;
+    ThumbnailServiceOptions options_;
+    ResultSink sink_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    IndexedHeap<std::string, Job> queue_;
+    std::unordered_map<std::string, RunningJob> running_;
+    std::unordered_map<uint64_t, std::string> paths_;                  // queued and running ids
+    std::unordered_set<uint64_t> cancelledRunning_;
+    uint64_t nextId_ = 1;
+    uint64_t nextRank_ = 0;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace FileCataloger
+
+#endif // THUMBNAILS_THUMBNAIL_SERVICE_H
@@ -0,0 +1,305 @@
+/**
+ * @file thumbnail_decoder_linux.cc
+ * @brief Thumbnail decoding with libjpeg-turbo and libpng
+ *
+ * Both decoders read from memory and stream rows into RgbaDownscaler:
+ * - JPEG: scale_denom 8/4/2 makes the IDCT emit an already reduced image
+ *   (a 6000x4000 photo decodes as 750x500 for a 256px thumbnail), so most
+ *   of the decode cost is never paid. EXIF orientation is read from APP1.
+ * - PNG: expanded to 8-bit RGBA with libpng transforms. Interlaced images
+ *   need every pass before a row is final and are decoded in full.
+ *
+ * libjpeg and libpng report fatal errors by longjmp. All state that must
+ * survive the jump lives in a heap context created before setjmp.
+ */
+
+#include "thumbnail_decoder.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include <jpeglib.h>
+#include <png.h>
+
+namespace FileCataloger {
+
+namespace {
+
+// Refuse images whose row or interlaced buffers would be unreasonable
+constexpr uint64_t kMaxPixels = 1ull << 28;
+
+// Orientation tag (0x0112) from the first IFD of an EXIF APP1 payload; 1 if absent
+int ReadExifOrientation(const uint8_t* data, size_t size) {
+    if (size < 14 || memcmp(data, "Exif\0\0", 6) != 0) {
+        return 1;
+    }
+    const uint8_t* tiff = data + 6;
+    size_t length = size - 6;
+    bool little = tiff[0] == 'I' && tiff[1] == 'I';
+    if (!little && !(tiff[0] == 'M' && tiff[1] == 'M')) {
+        return 1;
+    }
+
+    auto u16 = [&](size_t offset) -> uint32_t {
+        return little ? (tiff[offset] | (tiff[offset + 1] << 8)) : ((tiff[offset] << 8) | tiff[offset + 1]);
+    };
+    auto u32 = [&](size_t offset) -> uint32_t {
+        return little ? (u16(offset) | (u16(offset + 2) << 16)) : ((u16(offset) << 16) | u16(offset + 2));
+    };
+
+    uint32_t ifd = u32(4);
+    if (ifd + 2 > length) {
+        return 1;
+    }
+    uint32_t count = u16(ifd);
+    for (uint32_t i = 0; i < count; i++) {
+        size_t entry = ifd + 2 + static_cast<size_t>(i) * 12;
+        if (entry + 12 > length) {
+            break;
+        }
+        if (u16(entry) == 0x0112) {
+            uint32_t value = u16(entry + 8);
+            return value >= 1 && value <= 8 ? static_cast<int>(value) : 1;
+        }
+    }
+    return 1;
+}
+
+// ---- JPEG ----
+
+struct JpegContext {
+    jpeg_decompress_struct cinfo;
+    jpeg_error_mgr errorManager;
+    jmp_buf jump;
+    char message[JMSG_LENGTH_MAX] = "";
+    std::unique_ptr<RgbaDownscaler> scaler;
+    std::vector<uint8_t> rows;
+};
+
+void JpegErrorExit(j_common_ptr cinfo) {
+    auto* context = reinterpret_cast<JpegContext*>(cinfo->client_data);
+    (*cinfo->err->format_message)(cinfo, context->message);
+    longjmp(context->jump, 1);
+}
+
+void JpegOutputMessage(j_common_ptr) {
+    // Warnings (e.g. a truncated file) still yield an image; stay quiet
+}
+
+bool DecodeJpeg(const uint8_t* data, size_t size, const DecodeOptions& options,
+                Thumbnail* thumbnail, std::string* error) {
+    auto context = std::make_unique<JpegContext>();
+    jpeg_decompress_struct& cinfo = context->cinfo;
+    cinfo.err = jpeg_std_error(&context->errorManager);
+    context->errorManager.error_exit = JpegErrorExit;
+    context->errorManager.output_message = JpegOutputMessage;
+
+    if (setjmp(context->jump)) {
+        *error = std::string("JPEG: ") + context->message;
+        jpeg_destroy_decompress(&context->cinfo);
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    cinfo.client_data = context.get();
+    jpeg_mem_src(&cinfo, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+    jpeg_save_markers(&cinfo, JPEG_APP0 + 1, 0xFFFF);
+    jpeg_read_header(&cinfo, TRUE);
+
+    int orientation = 1;
+    for (jpeg_saved_marker_ptr marker = cinfo.marker_list; marker; marker = marker->next) {
+        if (marker->marker == JPEG_APP0 + 1) {
+            orientation = ReadExifOrientation(marker->data, marker->data_length);
+            break;
+        }
+    }
+
+    if (static_cast<uint64_t>(cinfo.image_width) * cinfo.image_height > kMaxPixels) {
+        *error = "JPEG: image too large";
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    // Target size in stored (pre-rotation) coordinates
+    const bool swap = orientation >= 5;
+    uint32_t fitWidth, fitHeight;
+    FitWithin(swap ? cinfo.image_height : cinfo.image_width, swap ? cinfo.image_width : cinfo.image_height,
+              options.maxSize, &fitWidth, &fitHeight);
+    uint32_t targetWidth = swap ? fitHeight : fitWidth;
+    uint32_t targetHeight = swap ? fitWidth : fitHeight;
+
+    unsigned int denom = 1;
+    if (options.reducedDecode) {
+        for (unsigned int candidate : {8u, 4u, 2u}) {
+            if ((cinfo.image_width + candidate - 1) / candidate >= targetWidth &&
+                (cinfo.image_height + candidate - 1) / candidate >= targetHeight) {
+                denom = candidate;
+                break;
+            }
+        }
+    }
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = denom;
+    cinfo.out_color_space = JCS_EXT_RGBA;
+    // The box filter averages far more than the chroma upsampler would smooth
+    cinfo.do_fancy_upsampling = denom > 1 ? FALSE : TRUE;
+
+    jpeg_start_decompress(&cinfo);
+
+    const uint32_t width = cinfo.output_width;
+    const uint32_t height = cinfo.output_height;
+    targetWidth = std::min(targetWidth, width);
+    targetHeight = std::min(targetHeight, height);
+    context->scaler = std::make_unique<RgbaDownscaler>(width, height, targetWidth, targetHeight, false, options.kernel);
+
+    const int batch = std::max(1, cinfo.rec_outbuf_height);
+    const size_t stride = static_cast<size_t>(width) * 4;
+    context->rows.resize(stride * batch);
+    JSAMPROW pointers[16];
+    for (int i = 0; i < batch && i < 16; i++) {
+        pointers[i] = context->rows.data() + stride * i;
+    }
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JDIMENSION read = jpeg_read_scanlines(&cinfo, pointers, std::min(batch, 16));
+        for (JDIMENSION i = 0; i < read; i++) {
+            context->scaler->PushRow(pointers[i]);
+        }
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    thumbnail->width = targetWidth;
+    thumbnail->height = targetHeight;
+    thumbnail->sourceWidth = swap ? cinfo.image_height : cinfo.image_width;
+    thumbnail->sourceHeight = swap ? cinfo.image_width : cinfo.image_height;
+    thumbnail->rgba.resize(static_cast<size_t>(targetWidth) * targetHeight * 4);
+    context->scaler->Finish(thumbnail->rgba.data());
+    ApplyExifOrientation(&thumbnail->rgba, &thumbnail->width, &thumbnail->height, orientation);
+    return true;
+}
+
+// ---- PNG ----
+
+struct PngContext {
+    png_structp png = nullptr;
+    png_infop info = nullptr;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    std::string message;
+    std::unique_ptr<RgbaDownscaler> scaler;
+    std::vector<uint8_t> pixels;
+
+    ~PngContext() {
+        png_destroy_read_struct(&png, info ? &info : nullptr, nullptr);
+    }
+};
+
+void PngRead(png_structp png, png_bytep out, png_size_t length) {
+    auto* context = static_cast<PngContext*>(png_get_io_ptr(png));
+    if (context->offset + length > context->size) {
+        png_error(png, "unexpected end of data");
+    }
+    memcpy(out, context->data + context->offset, length);
+    context->offset += length;
+}
+
+void PngError(png_structp png, png_const_charp message) {
+    static_cast<PngContext*>(png_get_error_ptr(png))->message = message;
+    png_longjmp(png, 1);
+}
+
+void PngWarning(png_structp, png_const_charp) {}
+
+bool DecodePng(const uint8_t* data, size_t size, const DecodeOptions& options,
+               Thumbnail* thumbnail, std::string* error) {
+    auto context = std::make_unique<PngContext>();
+    context->data = data;
+    context->size = size;
+    context->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, context.get(), PngError, PngWarning);
+    if (!context->png || !(context->info = png_create_info_struct(context->png))) {
+        *error = "PNG: out of memory";
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(context->png))) {
+        *error = "PNG: " + context->message;
+        return false;
+    }
+
+    png_structp png = context->png;
+    png_infop info = context->info;
+    png_set_read_fn(png, context.get(), PngRead);
+    png_read_info(png, info);
+
+    const uint32_t width = png_get_image_width(png, info);
+    const uint32_t height = png_get_image_height(png, info);
+    if (static_cast<uint64_t>(width) * height > kMaxPixels) {
+        *error = "PNG: image too large";
+        return false;
+    }
+
+    const int colorType = png_get_color_type(png, info);
+    png_set_expand(png);
+    png_set_strip_16(png);
+    if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA) {
+        png_set_gray_to_rgb(png);
+    }
+    if (!(colorType & PNG_COLOR_MASK_ALPHA) && !png_get_valid(png, info, PNG_INFO_tRNS)) {
+        png_set_add_alpha(png, 0xFF, PNG_FILLER_AFTER);
+    }
+    const int passes = png_set_interlace_handling(png);
+    png_read_update_info(png, info);
+
+    uint32_t targetWidth, targetHeight;
+    FitWithin(width, height, options.maxSize, &targetWidth, &targetHeight);
+    context->scaler = std::make_unique<RgbaDownscaler>(width, height, targetWidth, targetHeight, true, options.kernel);
+
+    const size_t stride = static_cast<size_t>(width) * 4;
+    if (passes > 1) {
+        context->pixels.resize(stride * height);
+        std::vector<png_bytep> rows(height);
+        for (uint32_t y = 0; y < height; y++) {
+            rows[y] = context->pixels.data() + stride * y;
+        }
+        png_read_image(png, rows.data());
+        for (uint32_t y = 0; y < height; y++) {
+            context->scaler->PushRow(rows[y]);
+        }
+    } else {
+        context->pixels.resize(stride);
+        for (uint32_t y = 0; y < height; y++) {
+            png_read_row(png, context->pixels.data(), nullptr);
+            context->scaler->PushRow(context->pixels.data());
+        }
+    }
+
+    thumbnail->width = targetWidth;
+    thumbnail->height = targetHeight;
+    thumbnail->sourceWidth = width;
+    thumbnail->sourceHeight = height;
+    thumbnail->rgba.resize(static_cast<size_t>(targetWidth) * targetHeight * 4);
+    context->scaler->Finish(thumbnail->rgba.data());
+    return true;
+}
+
+} // namespace
+
+bool DecodeThumbnail(const uint8_t* data, size_t size, const DecodeOptions& options,
+                     Thumbnail* thumbnail, std::string* error) {
+    switch (DetectImageFormat(data, size)) {
+        case ImageFormat::Jpeg:
+            return DecodeJpeg(data, size, options, thumbnail, error);
+        case ImageFormat::Png:
+            return DecodePng(data, size, options, thumbnail, error);
+        default:
+            *error = "Unsupported image format";
+            return false;
+    }
+}
+
+} // namespace FileCataloger
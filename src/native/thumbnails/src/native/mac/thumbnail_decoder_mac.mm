@@ -0,0 +1,121 @@
+/**
+ * @file thumbnail_decoder_mac.mm
+ * @brief Thumbnail decoding with ImageIO
+ *
+ * CGImageSourceCreateThumbnailAtIndex decodes at reduced resolution where
+ * the codec allows it (JPEG DCT scaling, HEIC tiles, embedded previews) and
+ * applies EXIF orientation. The result is drawn once into an sRGB RGBA
+ * bitmap. ImageIO also covers HEIC, TIFF, GIF and WebP, so the format is not
+ * restricted to what DetectImageFormat knows.
+ *
+ * DecodeOptions::reducedDecode and kernel only apply to the libjpeg/libpng
+ * decoder used on Linux.
+ */
+
+#include "thumbnail_decoder.h"
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreGraphics/CoreGraphics.h>
+#include <ImageIO/ImageIO.h>
+
+namespace FileCataloger {
+
+namespace {
+
+template<typename T>
+class CFHolder {
+public:
+    explicit CFHolder(T ref = nullptr) : ref_(ref) {}
+    ~CFHolder() { if (ref_) CFRelease(ref_); }
+    CFHolder(const CFHolder&) = delete;
+    CFHolder& operator=(const CFHolder&) = delete;
+    T get() const { return ref_; }
+    explicit operator bool() const { return ref_ != nullptr; }
+
+private:
+    T ref_;
+};
+
+uint32_t IntProperty(CFDictionaryRef properties, CFStringRef key) {
+    int value = 0;
+    CFNumberRef number = properties ? static_cast<CFNumberRef>(CFDictionaryGetValue(properties, key)) : nullptr;
+    if (number) {
+        CFNumberGetValue(number, kCFNumberIntType, &value);
+    }
+    return value > 0 ? static_cast<uint32_t>(value) : 0;
+}
+
+} // namespace
+
+bool DecodeThumbnail(const uint8_t* data, size_t size, const DecodeOptions& options,
+                     Thumbnail* thumbnail, std::string* error) {
+    @autoreleasepool {
+        CFHolder<CFDataRef> bytes(CFDataCreateWithBytesNoCopy(kCFAllocatorDefault, data,
+                                                              static_cast<CFIndex>(size), kCFAllocatorNull));
+        CFHolder<CGImageSourceRef> source(bytes ? CGImageSourceCreateWithData(bytes.get(), nullptr) : nullptr);
+        if (!source || CGImageSourceGetCount(source.get()) == 0) {
+            *error = "Unsupported image format";
+            return false;
+        }
+
+        CFHolder<CFDictionaryRef> properties(CGImageSourceCopyPropertiesAtIndex(source.get(), 0, nullptr));
+        uint32_t sourceWidth = IntProperty(properties.get(), kCGImagePropertyPixelWidth);
+        uint32_t sourceHeight = IntProperty(properties.get(), kCGImagePropertyPixelHeight);
+        if (IntProperty(properties.get(), kCGImagePropertyOrientation) >= 5) {
+            std::swap(sourceWidth, sourceHeight);
+        }
+
+        int maxSize = static_cast<int>(options.maxSize);
+        CFHolder<CFNumberRef> maxPixelSize(CFNumberCreate(kCFAllocatorDefault, kCFNumberIntType, &maxSize));
+        const void* keys[] = {
+            kCGImageSourceCreateThumbnailFromImageAlways,
+            kCGImageSourceCreateThumbnailWithTransform,
+            kCGImageSourceShouldCacheImmediately,
+            kCGImageSourceThumbnailMaxPixelSize
+        };
+        const void* values[] = { kCFBooleanTrue, kCFBooleanTrue, kCFBooleanTrue, maxPixelSize.get() };
+        CFHolder<CFDictionaryRef> thumbnailOptions(CFDictionaryCreate(
+            kCFAllocatorDefault, keys, values, 4,
+            &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks));
+
+        CFHolder<CGImageRef> image(CGImageSourceCreateThumbnailAtIndex(source.get(), 0, thumbnailOptions.get()));
+        if (!image) {
+            *error = "ImageIO could not decode the image";
+            return false;
+        }
+
+        const size_t width = CGImageGetWidth(image.get());
+        const size_t height = CGImageGetHeight(image.get());
+        thumbnail->rgba.assign(width * height * 4, 0);
+
+        CFHolder<CGColorSpaceRef> colorSpace(CGColorSpaceCreateWithName(kCGColorSpaceSRGB));
+        CFHolder<CGContextRef> context(CGBitmapContextCreate(
+            thumbnail->rgba.data(), width, height, 8, width * 4, colorSpace.get(),
+            kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big));
+        if (!context) {
+            *error = "Could not create bitmap context";
+            return false;
+        }
+        CGContextSetInterpolationQuality(context.get(), kCGInterpolationHigh);
+        CGContextDrawImage(context.get(), CGRectMake(0, 0, width, height), image.get());
+
+        // Bitmap contexts only support premultiplied alpha; hand out straight alpha
+        uint8_t* pixels = thumbnail->rgba.data();
+        for (size_t i = 0; i < thumbnail->rgba.size(); i += 4) {
+            uint32_t alpha = pixels[i + 3];
+            if (alpha != 0 && alpha != 255) {
+                for (int c = 0; c < 3; c++) {
+                    pixels[i + c] = static_cast<uint8_t>(std::min<uint32_t>(255, (pixels[i + c] * 255 + alpha / 2) / alpha));
+                }
+            }
+        }
+
+        thumbnail->width = static_cast<uint32_t>(width);
+        thumbnail->height = static_cast<uint32_t>(height);
+        thumbnail->sourceWidth = sourceWidth ? sourceWidth : thumbnail->width;
+        thumbnail->sourceHeight = sourceHeight ? sourceHeight : thumbnail->height;
+        return true;
+    }
+}
+
+} // namespace FileCataloger
@@ -0,0 +1,555 @@
+/**
+ * @file thumbnails.cc
+ * @brief N-API bindings for the native thumbnail pipeline
+ *
+ * Exposes NativeThumbnailService, which generates bounded RGBA thumbnails
+ * for image shelf items on a small set of worker threads
+ * (src/internal/thumbnail_service.h) backed by a content-keyed disk cache
+ * (src/internal/thumbnail_cache.h).
+ *
+ *   new NativeThumbnailService(cacheDir | null, options, callback)
+ *   request(path, visible) -> id
+ *   setPriority(id, visible) -> boolean
+ *   prioritize(paths, priorities: Uint8Array) -> number of queued paths
+ *   cancel(id?) -> boolean
+ *   stats() -> { queued, pending, workers, cacheHits, cacheMisses, simd }
+ *   close()
+ *
+ * JS callback contract:
+ *   callback(results: Result[])
+ * Every request gets exactly one result, unless close() runs first. Results
+ * are delivered in batches through a BatchedDispatcher, so a screen full of
+ * cached thumbnails costs one JS call instead of one per item.
+ *
+ * prioritize() is a viewport update: priorities[i] is a ThumbnailPriority
+ * (0 hovered, 1 visible, 2 selected, 3 background) for paths[i], listed in
+ * the order they should be generated. Queued paths it does not list drop to
+ * background. Requests for one path share a single job.
+ *
+ * Thread safety:
+ * - Workers only push into the dispatcher
+ * - All methods and JS conversions run on the JS thread
+ * - The service is shut down (workers joined) before the dispatcher stops
+ *
+ * Lifetime: while results are pending the JS object is referenced and the
+ * dispatcher keeps the event loop alive; once idle, both are released so the
+ * object can be collected and the process can exit.
+ *
+ * @author FileCataloger Team
+ * @date 2025
+ */
+
+#include <node_api.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "error_codes.h"
+#include "napi_smart_ptr.h"
+#include "thumbnail_cache.h"
+#include "thumbnail_service.h"
+
+using FileCataloger::RgbaDownscaler;
+using FileCataloger::ThumbnailCache;
+using FileCataloger::ThumbnailPriority;
+using FileCataloger::ThumbnailResult;
+using FileCataloger::ThumbnailService;
+using FileCataloger::ThumbnailServiceOptions;
+
+namespace {
+
+using ThumbnailDispatcher = FileCataloger::BatchedDispatcher<ThumbnailResult>;
+
+void SetNumber(napi_env env, napi_value object, const char* name, double value) {
+    napi_value number;
+    napi_create_double(env, value, &number);
+    napi_set_named_property(env, object, name, number);
+}
+
+void SetBoolean(napi_env env, napi_value object, const char* name, bool value) {
+    napi_value boolean;
+    napi_get_boolean(env, value, &boolean);
+    napi_set_named_property(env, object, name, boolean);
+}
+
+void ThrowThumbnailError(napi_env env, FileCataloger::ErrorCode code, const std::string& message) {
+    napi_value msg_val, error, code_val;
+    napi_create_string_utf8(env, message.c_str(), message.size(), &msg_val);
+    napi_create_error(env, nullptr, msg_val, &error);
+    napi_create_int32(env, static_cast<int>(code), &code_val);
+    napi_set_named_property(env, error, "code", code_val);
+    napi_throw(env, error);
+}
+
+bool ReadString(napi_env env, napi_value value, std::string* result) {
+    size_t size = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &size) != napi_ok) {
+        return false;
+    }
+    result->assign(size, '\0');
+    napi_get_value_string_utf8(env, value, &(*result)[0], size + 1, &size);
+    return true;
+}
+
+bool GetOptionalProperty(napi_env env, napi_value object, const char* name, napi_value* result) {
+    bool has = false;
+    if (napi_has_named_property(env, object, name, &has) != napi_ok || !has) {
+        return false;
+    }
+    napi_get_named_property(env, object, name, result);
+    napi_valuetype type;
+    napi_typeof(env, *result, &type);
+    return type != napi_undefined && type != napi_null;
+}
+
+bool ReadPositive(napi_env env, napi_value options, const char* name, double max, double* value) {
+    napi_value property;
+    if (!GetOptionalProperty(env, options, name, &property)) {
+        return true;
+    }
+    if (napi_get_value_double(env, property, value) != napi_ok || !(*value >= 1) || *value > max) {
+        napi_throw_range_error(env, nullptr, (std::string(name) + " must be a positive number").c_str());
+        return false;
+    }
+    return true;
+}
+
+napi_value ResultToJs(napi_env env, const ThumbnailResult& result) {
+    napi_value object;
+    napi_create_object(env, &object);
+    SetNumber(env, object, "id", static_cast<double>(result.id));
+
+    if (result.cancelled) {
+        SetBoolean(env, object, "cancelled", true);
+        return object;
+    }
+
+    if (!result.error.empty()) {
+        napi_value message;
+        napi_create_string_utf8(env, result.error.c_str(), result.error.size(), &message);
+        napi_set_named_property(env, object, "error", message);
+        if (result.errorCode != 0) {
+            SetNumber(env, object, "errno", result.errorCode);
+        }
+        return object;
+    }
+
+    const auto& thumbnail = result.thumbnail;
+    SetNumber(env, object, "width", thumbnail.width);
+    SetNumber(env, object, "height", thumbnail.height);
+    SetNumber(env, object, "sourceWidth", thumbnail.sourceWidth);
+    SetNumber(env, object, "sourceHeight", thumbnail.sourceHeight);
+    SetBoolean(env, object, "cached", result.cached);
+
+    // Electron does not allow external array buffers, so the pixels are copied
+    void* data = nullptr;
+    napi_value buffer;
+    napi_create_arraybuffer(env, thumbnail.rgba.size(), &data, &buffer);
+    if (!thumbnail.rgba.empty()) {
+        memcpy(data, thumbnail.rgba.data(), thumbnail.rgba.size());
+    }
+    napi_set_named_property(env, object, "data", buffer);
+    return object;
+}
+
+} // namespace
+
+/**
+ * A ThumbnailService and the dispatcher that carries its results to JS,
+ * owned by a JS NativeThumbnailService object.
+ */
+class ThumbnailServiceBinding {
+public:
+    ThumbnailServiceBinding(napi_env env, std::string cache_dir, ThumbnailServiceOptions options,
+                            uint64_t cache_max_bytes)
+        : env_(env),
+          options_(options),
+          cache_(std::make_shared<ThumbnailCache>(std::move(cache_dir), cache_max_bytes)),
+          dispatcher_([this](napi_env env, napi_value js_callback, std::vector<ThumbnailResult>& high,
+                             std::vector<ThumbnailResult>& low) { Deliver(env, js_callback, high, low); },
+                      DispatchOptions()) {}
+
+    ~ThumbnailServiceBinding() {
+        Close();
+        if (self_ref_) {
+            napi_delete_reference(env_, self_ref_);
+        }
+    }
+
+    // Returns false with a pending JS exception
+    bool Start(napi_env env, napi_value callback, napi_ref self_ref) {
+        self_ref_ = self_ref;
+        if (dispatcher_.Start(env, callback, "ThumbnailDispatch") != napi_ok) {
+            ThrowThumbnailError(env, FileCataloger::ErrorCode::THREADSAFE_FUNCTION_CREATE_FAILED,
+                                "Failed to create thumbnail callback");
+            return false;
+        }
+        dispatcher_.SetKeepsLoopAlive(env, false);
+
+        ThumbnailDispatcher* dispatcher = &dispatcher_;
+        service_ = std::make_unique<ThumbnailService>(
+            cache_, options_,
+            [dispatcher](ThumbnailResult&& result) { dispatcher->Push(std::move(result)); });
+
+        napi_add_env_cleanup_hook(env, CleanupHook, this);
+        cleanup_hook_added_ = true;
+        return true;
+    }
+
+    bool IsOpen() const { return service_ != nullptr; }
+
+    uint64_t Request(napi_env env, std::string path, bool visible) {
+        AddPending(env);
+        return service_->Request(std::move(path), visible ? ThumbnailPriority::Visible : ThumbnailPriority::Background);
+    }
+
+    bool SetPriority(uint64_t id, bool visible) {
+        return service_->SetPriority(id, visible ? ThumbnailPriority::Visible : ThumbnailPriority::Background);
+    }
+
+    size_t Prioritize(const std::vector<std::pair<std::string, ThumbnailPriority>>& items) {
+        return service_->Prioritize(items);
+    }
+
+    bool Cancel(uint64_t id) {
+        if (id == 0) {
+            service_->CancelAll();
+            return true;
+        }
+        return service_->Cancel(id);
+    }
+
+    napi_value Stats(napi_env env) {
+        napi_value stats;
+        napi_create_object(env, &stats);
+        SetNumber(env, stats, "queued", service_ ? static_cast<double>(service_->QueuedCount()) : 0);
+        SetNumber(env, stats, "pending", static_cast<double>(pending_));
+        SetNumber(env, stats, "workers", service_ ? static_cast<double>(service_->WorkerCount()) : 0);
+        SetNumber(env, stats, "cacheHits", static_cast<double>(cache_->Hits()));
+        SetNumber(env, stats, "cacheMisses", static_cast<double>(cache_->Misses()));
+        SetBoolean(env, stats, "simd", RgbaDownscaler::HasSimd());
+        return stats;
+    }
+
+    // Joins the workers; results not yet delivered are dropped. Safe to call repeatedly.
+    void Close() {
+        if (service_) {
+            service_->Shutdown();
+            service_.reset();
+        }
+        dispatcher_.Stop();
+        if (pending_ > 0) {
+            pending_ = 0;
+            napi_reference_unref(env_, self_ref_, nullptr);
+        }
+        if (cleanup_hook_added_) {
+            napi_remove_env_cleanup_hook(env_, CleanupHook, this);
+            cleanup_hook_added_ = false;
+        }
+    }
+
+private:
+    static ThumbnailDispatcher::Options DispatchOptions() {
+        ThumbnailDispatcher::Options options;
+        options.maxBatchSize = 32;
+        return options;
+    }
+
+    void AddPending(napi_env env) {
+        if (pending_++ == 0) {
+            // Pending results keep the JS object and the process alive
+            napi_reference_ref(env, self_ref_, nullptr);
+            dispatcher_.SetKeepsLoopAlive(env, true);
+        }
+    }
+
+    void Deliver(napi_env env, napi_value js_callback, std::vector<ThumbnailResult>& high,
+                 std::vector<ThumbnailResult>& low) {
+        napi_handle_scope scope;
+        napi_open_handle_scope(env, &scope);
+
+        napi_value results;
+        napi_create_array_with_length(env, high.size() + low.size(), &results);
+        uint32_t index = 0;
+        for (auto* lane : {&high, &low}) {
+            for (const auto& result : *lane) {
+                napi_set_element(env, results, index++, ResultToJs(env, result));
+            }
+        }
+
+        pending_ = pending_ > index ? pending_ - index : 0;
+        bool idle = pending_ == 0;
+        if (idle) {
+            dispatcher_.SetKeepsLoopAlive(env, false);
+        }
+
+        napi_value global, ignored;
+        napi_get_global(env, &global);
+        napi_call_function(env, global, js_callback, 1, &results, &ignored);
+        napi_close_handle_scope(env, scope);
+
+        // Last use of this when idle; the object may be collected from here on
+        if (idle) {
+            napi_reference_unref(env, self_ref_, nullptr);
+        }
+    }
+
+    static void CleanupHook(void* arg) {
+        auto* binding = static_cast<ThumbnailServiceBinding*>(arg);
+        binding->cleanup_hook_added_ = false;
+        binding->Close();
+    }
+
+    napi_env env_;
+    ThumbnailServiceOptions options_;
+    std::shared_ptr<ThumbnailCache> cache_;
+    ThumbnailDispatcher dispatcher_;
+    std::unique_ptr<ThumbnailService> service_;
+    napi_ref self_ref_ = nullptr;
+    uint32_t pending_ = 0;
+    bool cleanup_hook_added_ = false;
+};
+
+static ThumbnailServiceBinding* UnwrapOpenService(napi_env env, napi_value this_arg) {
+    ThumbnailServiceBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    if (!binding || !binding->IsOpen()) {
+        napi_throw_error(env, nullptr, "Thumbnail service is closed");
+        return nullptr;
+    }
+    return binding;
+}
+
+static napi_value CreateThumbnailService(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, nullptr, "NativeThumbnailService(cacheDir, options, callback) requires 3 arguments");
+        return nullptr;
+    }
+
+    // A null cache directory keeps thumbnails in memory for this process only
+    std::string cache_dir;
+    napi_valuetype type;
+    napi_typeof(env, args[0], &type);
+    if (type != napi_undefined && type != napi_null && !ReadString(env, args[0], &cache_dir)) {
+        napi_throw_type_error(env, nullptr, "cacheDir must be a string");
+        return nullptr;
+    }
+
+    ThumbnailServiceOptions options;
+    double max_size = options.maxSize;
+    double workers = 0;
+    double max_queued = static_cast<double>(options.maxQueued);
+    double cache_max_bytes = static_cast<double>(ThumbnailCache::DEFAULT_MAX_BYTES);
+    napi_typeof(env, args[1], &type);
+    if (type == napi_object &&
+        (!ReadPositive(env, args[1], "maxSize", 4096, &max_size) ||
+         !ReadPositive(env, args[1], "workers", 16, &workers) ||
+         !ReadPositive(env, args[1], "maxQueued", 1e6, &max_queued) ||
+         !ReadPositive(env, args[1], "cacheMaxBytes", 1e15, &cache_max_bytes))) {
+        return nullptr;
+    }
+    options.maxSize = static_cast<uint32_t>(max_size);
+    options.workers = static_cast<size_t>(workers);
+    options.maxQueued = static_cast<size_t>(max_queued);
+
+    napi_typeof(env, args[2], &type);
+    if (type != napi_function) {
+        napi_throw_type_error(env, nullptr, "callback must be a function");
+        return nullptr;
+    }
+
+    auto* binding = new ThumbnailServiceBinding(env, std::move(cache_dir), options,
+                                                static_cast<uint64_t>(cache_max_bytes));
+    napi_wrap(env, this_arg, binding,
+        [](napi_env env, void* data, void* hint) {
+            delete static_cast<ThumbnailServiceBinding*>(data);
+        }, nullptr, nullptr);
+
+    napi_ref self_ref;
+    napi_create_reference(env, this_arg, 0, &self_ref);
+    if (!binding->Start(env, args[2], self_ref)) {
+        return nullptr;
+    }
+    return this_arg;
+}
+
+static napi_value RequestThumbnail(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    std::string path;
+    if (argc < 1 || !ReadString(env, args[0], &path) || path.empty()) {
+        napi_throw_type_error(env, nullptr, "path must be a non-empty string");
+        return nullptr;
+    }
+    bool visible = true;
+    if (argc >= 2) {
+        napi_get_value_bool(env, args[1], &visible);
+    }
+
+    ThumbnailServiceBinding* binding = UnwrapOpenService(env, this_arg);
+    if (!binding) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_create_double(env, static_cast<double>(binding->Request(env, std::move(path), visible)), &result);
+    return result;
+}
+
+static napi_value SetThumbnailPriority(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    double id = 0;
+    bool visible = true;
+    if (argc < 2 || napi_get_value_double(env, args[0], &id) != napi_ok ||
+        napi_get_value_bool(env, args[1], &visible) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "setPriority(id, visible) requires a number and a boolean");
+        return nullptr;
+    }
+
+    ThumbnailServiceBinding* binding = UnwrapOpenService(env, this_arg);
+    if (!binding) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_get_boolean(env, binding->SetPriority(static_cast<uint64_t>(id), visible), &result);
+    return result;
+}
+
+static napi_value PrioritizeThumbnails(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    bool is_array = false;
+    bool is_typedarray = false;
+    if (argc >= 2) {
+        napi_is_array(env, args[0], &is_array);
+        napi_is_typedarray(env, args[1], &is_typedarray);
+    }
+    napi_typedarray_type type = napi_int8_array;
+    size_t length = 0;
+    void* data = nullptr;
+    if (is_typedarray) {
+        napi_get_typedarray_info(env, args[1], &type, &length, &data, nullptr, nullptr);
+    }
+    uint32_t count = 0;
+    if (is_array) {
+        napi_get_array_length(env, args[0], &count);
+    }
+    if (!is_array || !is_typedarray || type != napi_uint8_array || length != count) {
+        napi_throw_type_error(env, nullptr,
+                              "prioritize(paths: string[], priorities: Uint8Array) requires arrays of one length");
+        return nullptr;
+    }
+
+    const uint8_t* priorities = static_cast<const uint8_t*>(data);
+    std::vector<std::pair<std::string, ThumbnailPriority>> items(count);
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value element;
+        napi_get_element(env, args[0], i, &element);
+        if (!ReadString(env, element, &items[i].first)) {
+            napi_throw_type_error(env, nullptr, "paths must be strings");
+            return nullptr;
+        }
+        if (priorities[i] > static_cast<uint8_t>(ThumbnailPriority::Background)) {
+            napi_throw_range_error(env, nullptr, "priority must be 0 to 3");
+            return nullptr;
+        }
+        items[i].second = static_cast<ThumbnailPriority>(priorities[i]);
+    }
+
+    ThumbnailServiceBinding* binding = UnwrapOpenService(env, this_arg);
+    if (!binding) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_create_uint32(env, static_cast<uint32_t>(binding->Prioritize(items)), &result);
+    return result;
+}
+
+static napi_value CancelThumbnail(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value this_arg;
+    napi_get_cb_info(env, info, &argc, args, &this_arg, nullptr);
+
+    // cancel() without an id cancels every request
+    double id = 0;
+    if (argc >= 1) {
+        napi_get_value_double(env, args[0], &id);
+    }
+
+    ThumbnailServiceBinding* binding = UnwrapOpenService(env, this_arg);
+    if (!binding) {
+        return nullptr;
+    }
+
+    napi_value result;
+    napi_get_boolean(env, binding->Cancel(static_cast<uint64_t>(id)), &result);
+    return result;
+}
+
+static napi_value GetThumbnailStats(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    ThumbnailServiceBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    if (!binding) {
+        return nullptr;
+    }
+    return binding->Stats(env);
+}
+
+static napi_value CloseThumbnailService(napi_env env, napi_callback_info info) {
+    napi_value this_arg;
+    napi_get_cb_info(env, info, nullptr, nullptr, &this_arg, nullptr);
+
+    ThumbnailServiceBinding* binding = nullptr;
+    napi_unwrap(env, this_arg, reinterpret_cast<void**>(&binding));
+    if (binding) {
+        binding->Close();
+    }
+
+    napi_value result;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+// Module initialization
+static napi_value Init(napi_env env, napi_value exports) {
+    napi_value service_class;
+
+    napi_property_descriptor properties[] = {
+        { "request", nullptr, RequestThumbnail, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "setPriority", nullptr, SetThumbnailPriority, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "prioritize", nullptr, PrioritizeThumbnails, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "cancel", nullptr, CancelThumbnail, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "stats", nullptr, GetThumbnailStats, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "close", nullptr, CloseThumbnailService, nullptr, nullptr, nullptr, napi_default, nullptr }
+    };
+
+    napi_define_class(env, "NativeThumbnailService", NAPI_AUTO_LENGTH,
+                      CreateThumbnailService, nullptr, 6, properties, &service_class);
+    napi_set_named_property(env, exports, "NativeThumbnailService", service_class);
+
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
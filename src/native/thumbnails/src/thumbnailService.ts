@@ -0,0 +1,297 @@
+/**
+ * @fileoverview Native thumbnails for image shelf items
+ *
+ * Decoding multi-megapixel photos in the renderer blocks it and holds the
+ * full-size bitmap in memory. The native service decodes in the main
+ * process on a few worker threads, at reduced resolution where the codec
+ * allows it (JPEG DCT scaling), and hands back a small RGBA buffer.
+ * Thumbnails are cached on disk by file content, so a copied or re-dropped
+ * photo is instant.
+ *
+ * Usage:
+ * ```typescript
+ * configureThumbnails({ cacheDir: path.join(app.getPath('userData'), 'thumbnails') });
+ *
+ * const request = requestThumbnail(item.path);
+ * request.setVisible(false);             // scrolled out of view: background priority
+ * const image = await request.image;     // null if cancelled or unavailable
+ *
+ * // On scroll, hover or selection change: reorder everything still queued
+ * prioritizeThumbnails({ hovered, visible: visibleRowPaths, selected: selectedPaths });
+ * ```
+ *
+ * Requests for a path already queued or being decoded share one decode.
+ *
+ * Without the native module (e.g. Windows) every request resolves to null
+ * and callers keep showing file-type icons.
+ *
+ * @module thumbnails
+ */
+
+import * as os from 'os';
+import * as path from 'path';
+import { createLogger } from '@main/modules/utils/logger';
+import { NativeErrorCode } from '@shared/nativeErrorCodes';
+
+const logger = createLogger('Thumbnails');
+
+export interface ThumbnailOptions {
+  /** Directory for the disk cache; thumbnails are only kept in memory without it */
+  cacheDir?: string;
+  /** Long edge in pixels (default 256) */
+  maxSize?: number;
+  /** Decoder threads (default: CPU count, at most 4) */
+  workers?: number;
+  /** Queued requests before the oldest background ones are dropped (default 512) */
+  maxQueued?: number;
+  /** Disk cache budget in bytes (default 256MB) */
+  cacheMaxBytes?: number;
+}
+
+export interface ThumbnailImage {
+  width: number;
+  height: number;
+  /** Straight-alpha RGBA, width * height * 4 bytes; ready for new ImageData() */
+  data: Uint8ClampedArray;
+  /** Original image size after EXIF orientation */
+  sourceWidth: number;
+  sourceHeight: number;
+  /** Served from the disk cache */
+  cached: boolean;
+}
+
+export interface ThumbnailRequest {
+  /**
+   * Null when cancelled, dropped from a full queue, or when thumbnails are
+   * unavailable. Rejects with an ErrnoException for unreadable files, and
+   * with code THUMBNAIL_FAILED for unsupported or corrupt images.
+   */
+  image: Promise<ThumbnailImage | null>;
+  /** Visible requests are served before background ones */
+  setVisible(visible: boolean): void;
+  cancel(): void;
+}
+
+interface NativeThumbnailResult {
+  id: number;
+  cancelled?: boolean;
+  error?: string;
+  errno?: number;
+  width?: number;
+  height?: number;
+  sourceWidth?: number;
+  sourceHeight?: number;
+  cached?: boolean;
+  data?: ArrayBuffer;
+}
+
+export interface ThumbnailViewport {
+  /** Item under the pointer; generated first */
+  hovered?: string;
+  /** Visible rows, top to bottom; generated in this order */
+  visible?: string[];
+  /** Selected items outside the visible rows */
+  selected?: string[];
+}
+
+/** Native ThumbnailPriority bands */
+const enum Priority {
+  Hovered = 0,
+  Visible = 1,
+  Selected = 2,
+}
+
+interface NativeThumbnailService {
+  request(path: string, visible: boolean): number;
+  setPriority(id: number, visible: boolean): boolean;
+  prioritize(paths: string[], priorities: Uint8Array): number;
+  cancel(id?: number): boolean;
+  stats(): {
+    queued: number;
+    pending: number;
+    workers: number;
+    cacheHits: number;
+    cacheMisses: number;
+    simd: boolean;
+  };
+  close(): void;
+}
+
+interface NativeThumbnailsModule {
+  NativeThumbnailService: new (
+    cacheDir: string | null,
+    options: Omit<ThumbnailOptions, 'cacheDir'>,
+    callback: (results: NativeThumbnailResult[]) => void
+  ) => NativeThumbnailService;
+}
+
+interface PendingRequest {
+  path: string;
+  resolve: (image: ThumbnailImage | null) => void;
+  reject: (error: unknown) => void;
+}
+
+let nativeModule: NativeThumbnailsModule | null = null;
+let loadAttempted = false;
+let options: ThumbnailOptions = {};
+let service: NativeThumbnailService | null = null;
+const pending = new Map<number, PendingRequest>();
+
+function loadNativeModule(): NativeThumbnailsModule | null {
+  if (loadAttempted) {
+    return nativeModule;
+  }
+  loadAttempted = true;
+
+  if (process.platform !== 'darwin' && process.platform !== 'linux') {
+    return null;
+  }
+
+  const moduleName = `thumbnails_${process.platform}.node`;
+  try {
+    try {
+      // Development: from native module build directory
+      nativeModule = require(`../build/Release/${moduleName}`);
+    } catch {
+      // Production: from dist/main, unpacked from asar when packaged
+      let nativePath = path.join(__dirname, moduleName);
+      if (nativePath.includes('.asar')) {
+        nativePath = nativePath.replace(/\.asar([/\\])/i, '.asar.unpacked$1');
+      }
+      nativeModule = require(nativePath);
+    }
+    logger.info('Successfully loaded thumbnails native module');
+  } catch {
+    logger.info('Thumbnails native module not available - thumbnails disabled');
+  }
+  return nativeModule;
+}
+
+/**
+ * Set the cache directory and sizes; call once at startup, before the
+ * first request
+ */
+export function configureThumbnails(config: ThumbnailOptions): void {
+  if (service) {
+    logger.warn('Thumbnail service already running; new options apply after restart');
+    return;
+  }
+  options = { ...config };
+}
+
+export function isNativeThumbnailsAvailable(): boolean {
+  return loadNativeModule() !== null;
+}
+
+function getService(): NativeThumbnailService | null {
+  const native = loadNativeModule();
+  if (!service && native) {
+    const { cacheDir, ...serviceOptions } = options;
+    service = new native.NativeThumbnailService(cacheDir ?? null, serviceOptions, deliver);
+  }
+  return service;
+}
+
+function errnoCode(errno: number): string {
+  const match = Object.entries(os.constants.errno).find(([, value]) => value === errno);
+  return match ? match[0] : 'UNKNOWN';
+}
+
+function toError(result: NativeThumbnailResult, filePath: string): Error {
+  if (result.errno) {
+    const error = new Error(`${result.error}: ${filePath}`) as NodeJS.ErrnoException;
+    error.code = errnoCode(result.errno);
+    error.errno = result.errno;
+    error.path = filePath;
+    return error;
+  }
+  const error = new Error(`${result.error}: ${filePath}`) as Error & { code: number };
+  error.code = NativeErrorCode.THUMBNAIL_FAILED;
+  return error;
+}
+
+function deliver(results: NativeThumbnailResult[]): void {
+  for (const result of results) {
+    const request = pending.get(result.id);
+    if (!request) {
+      continue;
+    }
+    pending.delete(result.id);
+
+    if (result.cancelled) {
+      request.resolve(null);
+    } else if (result.error !== undefined) {
+      request.reject(toError(result, request.path));
+    } else {
+      request.resolve({
+        width: result.width!,
+        height: result.height!,
+        data: new Uint8ClampedArray(result.data!),
+        sourceWidth: result.sourceWidth!,
+        sourceHeight: result.sourceHeight!,
+        cached: result.cached!,
+      });
+    }
+  }
+}
+
+export function requestThumbnail(filePath: string, { visible = true }: { visible?: boolean } = {}): ThumbnailRequest {
+  const native = getService();
+  if (!native) {
+    return { image: Promise.resolve(null), setVisible: () => {}, cancel: () => {} };
+  }
+
+  let id = 0;
+  const image = new Promise<ThumbnailImage | null>((resolve, reject) => {
+    id = native.request(filePath, visible);
+    pending.set(id, { path: filePath, resolve, reject });
+  });
+
+  return {
+    image,
+    setVisible: (nowVisible: boolean) => {
+      if (pending.has(id)) native.setPriority(id, nowVisible);
+    },
+    cancel: () => {
+      if (pending.has(id)) native.cancel(id);
+    },
+  };
+}
+
+/**
+ * Reorder queued thumbnails to match what the user is looking at. Queued
+ * items not named here drop to background priority; nothing is cancelled.
+ * Call with the whole viewport on every scroll, hover or selection change;
+ * the native side re-ranks its queue in one pass. Returns how many of the
+ * named items were still queued.
+ */
+export function prioritizeThumbnails(viewport: ThumbnailViewport): number {
+  if (!service) {
+    return 0;
+  }
+  const paths: string[] = [];
+  const bands: number[] = [];
+  const add = (items: string[] | undefined, band: Priority) => {
+    for (const item of items ?? []) {
+      paths.push(item);
+      bands.push(band);
+    }
+  };
+  add(viewport.hovered === undefined ? undefined : [viewport.hovered], Priority.Hovered);
+  add(viewport.visible, Priority.Visible);
+  add(viewport.selected, Priority.Selected);
+  return service.prioritize(paths, Uint8Array.from(bands));
+}
+
+/** Stop the workers; pending requests resolve to null */
+export function shutdownThumbnails(): void {
+  if (!service) {
+    return;
+  }
+  service.close();
+  service = null;
+  for (const request of pending.values()) {
+    request.resolve(null);
+  }
+  pending.clear();
+}
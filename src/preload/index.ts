@@ -79,7 +79,12 @@ const validChannels = [
   'shelf:files-dropped',
   'shelf:add-item',
   'shelf:remove-item',
+  'shelf:search-items',
+  'shelf:sort-items-by-name',
   'shelf:update-config',
+  'shelf:export-zip',
+  'shelf:export-zip-progress',
+  'shelf:cancel-export-zip',
   'shelf:debug',
   'settings:get',
   'settings:set',
@@ -96,7 +101,11 @@ const validChannels = [
   'fs:rename-file',
   'fs:rename-files',
   'fs:test-rename',
+  'fs:transfer-files',
+  'fs:transfer-progress',
+  'fs:cancel-transfer',
   'drag:get-native-files',
+  'drag:get-native-files-payload',
   // Pattern channels
   'pattern:save',
   'pattern:load',
@@ -139,6 +148,9 @@ const validChannels = [
   // File metadata channels
   'file:get-metadata',
   'file:get-metadata-batch',
+  // Thumbnail channels
+  'thumbnail:get',
+  'thumbnail:prioritize',
 ] as const;
 
 // Export the type for use in other files
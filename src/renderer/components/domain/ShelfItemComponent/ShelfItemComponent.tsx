@@ -8,7 +8,8 @@
  * @props {function} onAction - Callback for item actions (open, copy, remove)
  *
  * @features
- * - Context-aware file type icons based on file extension
+ * - Context-aware file type icons based on file extension and sniffed content
+ * - Native thumbnails for image items, made in the main process
  * - Hover states with quick action buttons (copy, remove)
  * - Right-click context menu with full action list
  * - Compact and normal display modes with different layouts
@@ -31,10 +32,12 @@ import React, { useState, useCallback } from 'react';
 import { motion, AnimatePresence } from 'framer-motion';
 import { ShelfItem, ShelfItemType } from '@shared/types';
 import { useShelfItemAccessibility } from '@renderer/hooks/useAccessibility';
-import { getFileIcon, getTypeIcon } from '@renderer/utils/fileTypeIcons';
+import { getExtensionIcon, getTypeIcon } from '@renderer/utils/fileTypeIcons';
+import { getFileExtension, resolveContentExtension } from '@renderer/utils/fileProcessing';
 import { logger } from '@shared/logger';
 import { CustomTooltip } from '@renderer/components/primitives';
 import { buildFileMetadataTooltip, buildActionTooltip } from '@renderer/utils/tooltipUtils';
+import { useNativeThumbnail } from '@renderer/hooks/useNativeThumbnail';
 
 export interface ShelfItemComponentProps {
   item: ShelfItem;
@@ -56,6 +59,7 @@ const shelfItemPropsAreEqual = (
     prevProps.item.id === nextProps.item.id &&
     prevProps.item.name === nextProps.item.name &&
     prevProps.item.size === nextProps.item.size &&
+    prevProps.item.path === nextProps.item.path &&
     prevProps.isSelected === nextProps.isSelected &&
     prevProps.index === nextProps.index &&
     prevProps.totalCount === nextProps.totalCount &&
@@ -76,6 +80,9 @@ export const ShelfItemComponent = React.memo<ShelfItemComponentProps>(
     // Get ARIA attributes for accessibility
     const itemAccessibility = useShelfItemAccessibility(item, index, totalCount);
 
+    // Image items show their thumbnail once the main process has made it
+    const thumbnail = useNativeThumbnail(item);
+
     // Get item icon based on type
     const getItemIcon = useCallback((item: ShelfItem): string => {
       logger.debug('Getting icon for shelf item', {
@@ -98,8 +105,12 @@ export const ShelfItemComponent = React.memo<ShelfItemComponentProps>(
       if (item.type === ShelfItemType.FILE && item.path) {
         logger.debug('FILE type detected with path, using file extension icon', {
           path: item.path,
+          contentType: item.metadata?.contentType,
         });
-        return getFileIcon(item.path);
+        // The sniffed type wins over a missing or mislabelled extension
+        return getExtensionIcon(
+          resolveContentExtension(getFileExtension(item.name), item.metadata)
+        );
       }
       logger.debug('Using generic type icon', { type: item.type });
       const typeIcon = getTypeIcon(item.type);
@@ -206,13 +217,14 @@ export const ShelfItemComponent = React.memo<ShelfItemComponentProps>(
           }}
         >
           <img
-            src={getItemIcon(item)}
-            alt={`${item.type} icon`}
+            src={thumbnail ?? getItemIcon(item)}
+            alt={thumbnail ? `${item.name} thumbnail` : `${item.type} icon`}
             style={{
               width: '100%',
               height: '100%',
-              objectFit: 'contain',
-              filter: 'brightness(0.9)',
+              objectFit: thumbnail ? 'cover' : 'contain',
+              borderRadius: thumbnail ? '3px' : undefined,
+              filter: thumbnail ? undefined : 'brightness(0.9)',
             }}
           />
         </div>
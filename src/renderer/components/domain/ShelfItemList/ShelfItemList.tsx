@@ -13,6 +13,7 @@
  * - Staggered animations for item entrance/exit
  * - Compact and normal display mode support
  * - Scrollbar visibility indicators
+ * - Thumbnails made hovered row first, then visible rows, then the selection
  * - Item count display when scrolling is needed
  * - Memory-efficient rendering with proper cleanup
  *
@@ -26,9 +27,10 @@
  * ```
  */
 
-import React, { useMemo, useCallback } from 'react';
+import React, { useMemo, useCallback, useEffect, useState } from 'react';
 import { motion, AnimatePresence } from 'framer-motion';
-import { ShelfItem } from '@shared/types';
+import { ShelfItem, ShelfItemType } from '@shared/types';
+import { prioritizeThumbnails } from '@renderer/hooks/useNativeThumbnail';
 import { ShelfItemComponent } from '../ShelfItemComponent';
 import { VirtualizedList } from '../VirtualizedList';
 
@@ -40,6 +42,10 @@ export interface ShelfItemListProps {
 }
 export const ShelfItemList = React.memo<ShelfItemListProps>(
   ({ items, isCompact, onItemAction, selectedIndex = -1 }) => {
+    const [hoveredId, setHoveredId] = useState<string | null>(null);
+    // On-screen rows of the virtualized list; a regular list shows them all
+    const [visibleRows, setVisibleRows] = useState<[number, number] | null>(null);
+
     // Calculate item height based on display mode
     const itemHeight = useMemo(() => {
       return isCompact ? 32 : 60;
@@ -58,6 +64,33 @@ export const ShelfItemList = React.memo<ShelfItemListProps>(
     // Determine if scrollbar is needed
     const needsScrollbar = totalItemsHeight > maxHeight;
 
+    const isVirtualized = items.length > 50;
+
+    const handleVisibleRangeChange = useCallback((first: number, last: number) => {
+      setVisibleRows([first, last]);
+    }, []);
+
+    // Re-rank queued thumbnails whenever what the user sees changes
+    useEffect(() => {
+      const imagePath = (item: ShelfItem | undefined) =>
+        item?.type === ShelfItemType.IMAGE ? item.path : undefined;
+      if (!items.some(item => imagePath(item))) {
+        return;
+      }
+
+      const [first, last] = isVirtualized && visibleRows ? visibleRows : [0, items.length - 1];
+      const visible = items
+        .slice(first, last + 1)
+        .map(imagePath)
+        .filter((path): path is string => !!path);
+      const selected = imagePath(items[selectedIndex]);
+      prioritizeThumbnails({
+        hovered: imagePath(items.find(item => item.id === hoveredId)),
+        visible,
+        selected: selected ? [selected] : [],
+      });
+    }, [items, isVirtualized, visibleRows, hoveredId, selectedIndex]);
+
     // Render individual item
     const renderItem = useCallback(
       (item: ShelfItem, index: number) => {
@@ -69,6 +102,8 @@ export const ShelfItemList = React.memo<ShelfItemListProps>(
             animate={{ opacity: 1, x: 0 }}
             exit={{ opacity: 0, x: 20, scale: 0.9 }}
             transition={{ duration: 0.2, delay: index * 0.03 }}
+            onMouseEnter={() => setHoveredId(item.id)}
+            onMouseLeave={() => setHoveredId(current => (current === item.id ? null : current))}
             style={{
               height: itemHeight,
               marginBottom: index === items.length - 1 ? 0 : isCompact ? '1px' : '4px',
@@ -89,7 +124,7 @@ export const ShelfItemList = React.memo<ShelfItemListProps>(
     );
 
     // Use virtualization for large lists
-    if (items.length > 50) {
+    if (isVirtualized) {
       return (
         <div
           className="shelf-item-list virtualized"
@@ -104,6 +139,7 @@ export const ShelfItemList = React.memo<ShelfItemListProps>(
             containerHeight={containerHeight}
             renderItem={renderItem}
             overscan={5}
+            onVisibleRangeChange={handleVisibleRangeChange}
           />
         </div>
       );
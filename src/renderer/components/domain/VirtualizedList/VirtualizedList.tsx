@@ -8,6 +8,7 @@
  * @props {number} containerHeight - Height of the scrollable container
  * @props {function} renderItem - Function to render each item (item, index) => ReactNode
  * @props {number} overscan - Number of items to render outside visible area (default: 3)
+ * @props {function} onVisibleRangeChange - Called with the first and last on-screen index when they change
  *
  * @features
  * - Window-based virtualization for optimal performance
@@ -29,7 +30,7 @@
  * ```
  */
 
-import React, { useState, useMemo, useCallback } from 'react';
+import React, { useState, useMemo, useCallback, useEffect } from 'react';
 import { ShelfItem } from '@shared/types';
 
 export interface VirtualizedListProps {
@@ -38,9 +39,10 @@ export interface VirtualizedListProps {
   containerHeight: number;
   renderItem: (item: ShelfItem, index: number) => React.ReactNode;
   overscan?: number;
+  onVisibleRangeChange?: (first: number, last: number) => void;
 }
 export const VirtualizedList = React.memo<VirtualizedListProps>(
-  ({ items, itemHeight, containerHeight, renderItem, overscan = 3 }) => {
+  ({ items, itemHeight, containerHeight, renderItem, overscan = 3, onVisibleRangeChange }) => {
     const [scrollTop, setScrollTop] = useState(0);
 
     // Calculate visible range
@@ -54,9 +56,16 @@ export const VirtualizedList = React.memo<VirtualizedListProps>(
       return {
         start: Math.max(0, visibleStart - overscan),
         end: Math.min(items.length - 1, visibleEnd + overscan),
+        firstVisible: visibleStart,
+        lastVisible: visibleEnd,
       };
     }, [scrollTop, itemHeight, containerHeight, items.length, overscan]);
 
+    // Report the on-screen rows, without the overscan
+    useEffect(() => {
+      onVisibleRangeChange?.(visibleRange.firstVisible, visibleRange.lastVisible);
+    }, [onVisibleRangeChange, visibleRange.firstVisible, visibleRange.lastVisible]);
+
     // Get visible items
     const visibleItems = useMemo(() => {
       return items.slice(visibleRange.start, visibleRange.end + 1);
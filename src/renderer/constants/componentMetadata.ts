@@ -64,7 +64,7 @@ export const COMPONENT_TYPE_METADATA: Record<ComponentType, ComponentTypeMetadat
 export interface FileMetadataFieldOption {
   value: string;
   label: string;
-  category: 'basic' | 'dates';
+  category: 'basic' | 'dates' | 'images';
   description: string;
 }
 
@@ -119,6 +119,25 @@ export const FILE_METADATA_FIELD_OPTIONS: FileMetadataFieldOption[] = [
     category: 'dates',
     description: 'Last access date',
   },
+  // Photo and video metadata
+  {
+    value: 'captureDate',
+    label: 'Capture Date',
+    category: 'images',
+    description: 'When the photo or video was taken (EXIF); created date if unknown',
+  },
+  {
+    value: 'cameraModel',
+    label: 'Camera Model',
+    category: 'images',
+    description: 'Camera that took the photo or video (e.g., "iPhone 14 Pro")',
+  },
+  {
+    value: 'mediaDuration',
+    label: 'Duration',
+    category: 'images',
+    description: 'Length of a video or audio file (e.g., "03m25s")',
+  },
 ];
 
 // ============================================================================
@@ -2,7 +2,7 @@
  * InlineFileMetadataEditor.tsx
  *
  * Inline editor for selecting file metadata fields.
- * Shows grouped options: Basic, Dates, Images.
+ * Shows grouped options: Basic, Dates, Photo & Video.
  */
 
 import React, { useState, useRef, useEffect } from 'react';
@@ -150,13 +150,13 @@ export const InlineFileMetadataEditor: React.FC<InlineFileMetadataEditorProps> =
   const categoryLabels = {
     basic: 'Basic File Info',
     dates: 'Date Information',
-    images: 'Image Metadata',
+    images: 'Photo & Video',
   };
 
   const categoryEmojis = {
     basic: '📄',
     dates: '📅',
-    images: '🖼️',
+    images: '📷',
   };
 
   return (
@@ -4,3 +4,4 @@ export * from './useIPCInvoke';
 export * from './useShelfCalculations';
 export * from './usePatternManager';
 export * from './useKeyboardNavigation';
+export * from './useNativeThumbnail';
@@ -0,0 +1,133 @@
+/**
+ * @file useNativeThumbnail.ts
+ * @description React hook that loads a shelf image item's thumbnail from the
+ * native thumbnail service in the main process, instead of decoding the
+ * full-size photo in the renderer.
+ *
+ * Thumbnails arrive as small RGBA buffers and are turned into data URLs once
+ * per path; rows that scroll back into a virtualized list reuse them.
+ * Items without a thumbnail (no path, unsupported format, no native module)
+ * get undefined and keep their file-type icon.
+ *
+ * @usage
+ * ```typescript
+ * const thumbnail = useNativeThumbnail(item);
+ * <img src={thumbnail ?? getItemIcon(item)} />
+ *
+ * // From the list, whenever the viewport changes
+ * prioritizeThumbnails({ hovered, visible: visiblePaths, selected: selectedPaths });
+ * ```
+ */
+
+import { useEffect, useState } from 'react';
+import { ShelfItem, ShelfItemType } from '@shared/types';
+import { logger } from '@shared/logger';
+
+interface ThumbnailImage {
+  width: number;
+  height: number;
+  data: Uint8ClampedArray;
+}
+
+export interface ThumbnailViewport {
+  hovered?: string;
+  visible?: string[];
+  selected?: string[];
+}
+
+// Data URLs kept for paths seen this session; null means the path has none
+const MAX_CACHED_THUMBNAILS = 512;
+const thumbnailCache = new Map<string, string | null>();
+const inFlight = new Map<string, Promise<string | null>>();
+
+function toDataUrl(image: ThumbnailImage): string | null {
+  const canvas = document.createElement('canvas');
+  canvas.width = image.width;
+  canvas.height = image.height;
+  const context = canvas.getContext('2d');
+  if (!context) {
+    return null;
+  }
+  context.putImageData(new ImageData(image.data, image.width, image.height), 0, 0);
+  return canvas.toDataURL('image/png');
+}
+
+function remember(filePath: string, url: string | null): void {
+  if (thumbnailCache.size >= MAX_CACHED_THUMBNAILS) {
+    // Map iterates in insertion order: drop the oldest
+    const oldest = thumbnailCache.keys().next().value;
+    if (oldest !== undefined) {
+      thumbnailCache.delete(oldest);
+    }
+  }
+  thumbnailCache.set(filePath, url);
+}
+
+function loadThumbnail(filePath: string): Promise<string | null> {
+  const pending = inFlight.get(filePath);
+  if (pending) {
+    return pending;
+  }
+
+  const load = (async () => {
+    try {
+      const response = (await window.api.invoke('thumbnail:get', filePath)) as {
+        success: boolean;
+        data?: ThumbnailImage | null;
+        error?: string;
+      };
+      const url = response.success && response.data ? toDataUrl(response.data) : null;
+      remember(filePath, url);
+      return url;
+    } catch (error) {
+      logger.warn('Failed to load thumbnail:', error);
+      return null;
+    } finally {
+      inFlight.delete(filePath);
+    }
+  })();
+  inFlight.set(filePath, load);
+  return load;
+}
+
+/**
+ * Thumbnail data URL for an image item, or undefined until (or unless) one
+ * is available
+ */
+export function useNativeThumbnail(item: ShelfItem): string | undefined {
+  const filePath = item.type === ShelfItemType.IMAGE ? item.path : undefined;
+  const [thumbnail, setThumbnail] = useState<string | undefined>(() =>
+    filePath ? (thumbnailCache.get(filePath) ?? undefined) : undefined
+  );
+
+  useEffect(() => {
+    if (!filePath) {
+      setThumbnail(undefined);
+      return;
+    }
+    if (thumbnailCache.has(filePath)) {
+      setThumbnail(thumbnailCache.get(filePath) ?? undefined);
+      return;
+    }
+
+    let current = true;
+    loadThumbnail(filePath).then(url => {
+      if (current) {
+        setThumbnail(url ?? undefined);
+      }
+    });
+    return () => {
+      current = false;
+    };
+  }, [filePath]);
+
+  return thumbnail;
+}
+
+/**
+ * Tell the main process what the shelf list shows, so queued thumbnails are
+ * made hovered first, then visible rows top to bottom, then the selection
+ */
+export function prioritizeThumbnails(viewport: ThumbnailViewport): void {
+  window.api.send('thumbnail:prioritize', viewport);
+}
@@ -14,8 +14,11 @@ import {
   hasValidDropData,
   formatFileSize,
   getFileExtension,
+  resolveContentExtension,
+  applyContentType,
 } from '../fileProcessing';
 import { SHELF_CONSTANTS } from '../../constants/shelf';
+import { ShelfItem, ShelfItemType } from '@shared/types';
 
 describe('fileProcessing', () => {
   beforeEach(() => {
@@ -424,4 +427,80 @@ describe('fileProcessing', () => {
       expect(getFileExtension('file..txt')).toBe('txt');
     });
   });
+
+  describe('resolveContentExtension', () => {
+    const jpeg = { contentType: 'image/jpeg', detectedExtension: 'jpg' };
+
+    it('should fill in a missing extension from the content', () => {
+      expect(resolveContentExtension('', jpeg)).toBe('jpg');
+      const pdf = { contentType: 'application/pdf', detectedExtension: 'pdf' };
+      expect(resolveContentExtension('', pdf)).toBe('pdf');
+    });
+
+    it('should replace an extension that names another format', () => {
+      expect(resolveContentExtension('png', jpeg)).toBe('jpg');
+      expect(resolveContentExtension('PDF', jpeg)).toBe('jpg');
+      expect(
+        resolveContentExtension('docx', {
+          contentType: 'application/vnd.openxmlformats-officedocument.spreadsheetml.sheet',
+          detectedExtension: 'xlsx',
+        })
+      ).toBe('xlsx');
+    });
+
+    it('should keep an extension that agrees with the content', () => {
+      expect(resolveContentExtension('JPEG', jpeg)).toBe('JPEG');
+      const mp4 = { contentType: 'video/mp4', detectedExtension: 'mp4' };
+      expect(resolveContentExtension('m4v', mp4)).toBe('m4v');
+    });
+
+    it('should keep the name for text, containers and unknown content', () => {
+      const text = { contentType: 'text/plain', detectedExtension: 'txt' };
+      expect(resolveContentExtension('md', text)).toBe('md');
+      expect(resolveContentExtension('', text)).toBe('');
+      const zip = { contentType: 'application/zip', detectedExtension: 'zip' };
+      expect(resolveContentExtension('jar', zip)).toBe('jar');
+      expect(
+        resolveContentExtension('xlsx', {
+          contentType: 'application/vnd.openxmlformats-officedocument',
+          detectedExtension: 'docx',
+        })
+      ).toBe('xlsx');
+      expect(resolveContentExtension('bin', jpeg)).toBe('bin');
+      expect(resolveContentExtension('png', undefined)).toBe('png');
+    });
+  });
+
+  describe('applyContentType', () => {
+    const item = (type: ShelfItemType, contentType?: string): ShelfItem => ({
+      id: 'item',
+      type,
+      name: 'photo',
+      path: '/tmp/photo',
+      createdAt: 0,
+      metadata: contentType ? { contentType } : undefined,
+    });
+
+    it('should make image content an image item', () => {
+      const file = item(ShelfItemType.FILE, 'image/png');
+      applyContentType(file);
+      expect(file.type).toBe(ShelfItemType.IMAGE);
+    });
+
+    it('should make a mislabelled image a plain file', () => {
+      const image = item(ShelfItemType.IMAGE, 'application/pdf');
+      applyContentType(image);
+      expect(image.type).toBe(ShelfItemType.FILE);
+    });
+
+    it('should leave folders and unsniffed items alone', () => {
+      const folder = item(ShelfItemType.FOLDER, 'image/png');
+      applyContentType(folder);
+      expect(folder.type).toBe(ShelfItemType.FOLDER);
+
+      const image = item(ShelfItemType.IMAGE);
+      applyContentType(image);
+      expect(image.type).toBe(ShelfItemType.IMAGE);
+    });
+  });
 });
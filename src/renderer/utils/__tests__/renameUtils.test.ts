@@ -0,0 +1,90 @@
+/**
+ * @file renameUtils.test.ts
+ * @description Unit tests for rename preview generation
+ */
+
+import { describe, it, expect } from 'vitest';
+import {
+  generateRenamePreview,
+  generateRenamePreviewFromInstances,
+  getRenameExtension,
+} from '../renameUtils';
+import { RenameComponent, ShelfItem, ShelfItemType } from '@shared/types';
+import type { ComponentDefinition, ComponentInstance } from '@shared/types/componentDefinition';
+
+function fileItem(name: string, metadata?: ShelfItem['metadata']): ShelfItem {
+  return {
+    id: name,
+    type: ShelfItemType.FILE,
+    name,
+    path: `/Users/test/Desktop/${name}`,
+    createdAt: 0,
+    metadata,
+  };
+}
+
+const jpeg = { contentType: 'image/jpeg', detectedExtension: 'jpg' };
+const plainText = { contentType: 'text/plain', detectedExtension: 'txt' };
+const text: RenameComponent[] = [{ id: 'text', type: 'text', value: 'Trip' }];
+
+describe('renameUtils', () => {
+  describe('getRenameExtension', () => {
+    it('should keep the name extension when the content agrees or is unknown', () => {
+      expect(getRenameExtension(fileItem('photo.JPG', jpeg))).toBe('.JPG');
+      expect(getRenameExtension(fileItem('notes.md', plainText))).toBe('.md');
+      expect(getRenameExtension(fileItem('notes.md'))).toBe('.md');
+      expect(getRenameExtension(fileItem('README'))).toBe('');
+    });
+
+    it('should use the sniffed extension for extensionless and mislabelled files', () => {
+      expect(getRenameExtension(fileItem('IMG_0042', jpeg))).toBe('.jpg');
+      expect(getRenameExtension(fileItem('photo.png', jpeg))).toBe('.jpg');
+    });
+  });
+
+  describe('generateRenamePreview', () => {
+    it('should append the sniffed extension to extensionless and mislabelled files', () => {
+      const previews = generateRenamePreview(
+        [fileItem('IMG_0042', jpeg), fileItem('photo.png', jpeg), fileItem('scan.pdf')],
+        [...text, { id: 'counter', type: 'counter' }]
+      );
+      expect(previews.map(preview => preview.newName)).toEqual([
+        'Trip_001.jpg',
+        'Trip_002.jpg',
+        'Trip_003.pdf',
+      ]);
+    });
+
+    it('should not give folders an extension', () => {
+      const folder: ShelfItem = { ...fileItem('Album', jpeg), type: ShelfItemType.FOLDER };
+      expect(generateRenamePreview([folder], text)[0].newName).toBe('Trip');
+    });
+  });
+
+  describe('generateRenamePreviewFromInstances', () => {
+    const definition: ComponentDefinition = {
+      id: 'extension',
+      name: 'Extension',
+      type: 'fileMetadata',
+      icon: '',
+      scope: 'global',
+      config: { selectedField: 'fileExtension' },
+      metadata: { createdAt: 0, updatedAt: 0, usageCount: 0 },
+    };
+    const instance: ComponentInstance = {
+      id: 'instance',
+      definitionId: 'extension',
+      name: 'Extension',
+      type: 'fileMetadata',
+    };
+
+    it('should resolve the fileExtension field from the content', () => {
+      const previews = generateRenamePreviewFromInstances(
+        [fileItem('IMG_0042', jpeg), fileItem('photo.png', jpeg), fileItem('scan.pdf')],
+        [instance],
+        new Map([[definition.id, definition]])
+      );
+      expect(previews.map(preview => preview.newName)).toEqual(['.jpg', '.jpg', '.pdf']);
+    });
+  });
+});
@@ -23,6 +23,7 @@ import {
   isFileMetadataComponent,
 } from '../../shared/types/componentDefinition';
 import type { ShelfItem } from '../../shared/types';
+import { resolveContentExtension } from './fileProcessing';
 
 // ============================================================================
 // Resolution Context
@@ -221,8 +222,10 @@ function resolveFileMetadataValue(
     case 'fileNameWithExtension':
       return fileName || fallback;
 
-    case 'fileExtension':
-      return extensionWithDot || fallback;
+    case 'fileExtension': {
+      const extension = resolveContentExtension(extensionWithDot.slice(1), fileItem?.metadata);
+      return extension ? `.${extension}` : fallback;
+    }
 
     case 'fileSize':
       if (fileItem?.size !== undefined) {
@@ -270,11 +273,45 @@ function resolveFileMetadataValue(
       return formatDate(timestamp, config.dateFormat || 'YYYY-MM-DD');
     }
 
+    // Photo and video metadata
+    case 'captureDate': {
+      const metadata = fileItem?.metadata;
+      const timestamp = metadata?.captureTime ?? metadata?.birthtime ?? context.fileCreatedDate;
+      if (timestamp === undefined || isNaN(timestamp)) {
+        return fallback;
+      }
+      return formatDate(timestamp, config.dateFormat || 'YYYY-MM-DD');
+    }
+
+    case 'cameraModel': {
+      const camera = fileItem?.metadata?.cameraModel || fileItem?.metadata?.cameraMake;
+      // Some models contain characters that are not allowed in file names
+      return camera ? camera.replace(/[/\\:]/g, '-') : fallback;
+    }
+
+    case 'mediaDuration':
+      if (fileItem?.metadata?.duration !== undefined) {
+        return formatDuration(fileItem.metadata.duration);
+      }
+      return fallback;
+
     default:
       return fallback;
   }
 }
 
+/**
+ * Format a duration in ms as "03m25s", or "1h03m25s" from an hour up
+ */
+function formatDuration(ms: number): string {
+  const totalSeconds = Math.round(ms / 1000);
+  const hours = Math.floor(totalSeconds / 3600);
+  const minutes = Math.floor((totalSeconds % 3600) / 60);
+  const seconds = totalSeconds % 60;
+  const mmss = `${String(minutes).padStart(2, '0')}m${String(seconds).padStart(2, '0')}s`;
+  return hours > 0 ? `${hours}h${mmss}` : mmss;
+}
+
 /**
  * Format file size to human-readable format
  */
@@ -21,6 +21,7 @@
 import { ShelfItem, ShelfItemType } from '@shared/types';
 import { SHELF_CONSTANTS, isImageTypeSupported, isTextFileExtension } from '../constants/shelf';
 import { logger } from '@shared/logger';
+import { FileListView } from '@shared/fileListPayload';
 
 /**
  * Type guard for native file response from IPC
@@ -241,6 +242,116 @@ export function getFileExtension(filename: string): string {
   return lastDot > 0 ? filename.substring(lastDot + 1).toLowerCase() : '';
 }
 
+/**
+ * Extensions that name one file signature. Two extensions in different
+ * groups cannot both be right for the same bytes.
+ */
+const SIGNATURE_GROUPS: Record<string, string> = {
+  jpg: 'jpeg',
+  jpeg: 'jpeg',
+  jpe: 'jpeg',
+  jfif: 'jpeg',
+  png: 'png',
+  gif: 'gif',
+  webp: 'webp',
+  bmp: 'bmp',
+  tif: 'tiff',
+  tiff: 'tiff',
+  heic: 'heif',
+  heif: 'heif',
+  avif: 'avif',
+  ico: 'ico',
+  psd: 'psd',
+  pdf: 'pdf',
+  docx: 'docx',
+  xlsx: 'xlsx',
+  pptx: 'pptx',
+  epub: 'epub',
+  gz: 'gzip',
+  tgz: 'gzip',
+  bz2: 'bzip2',
+  xz: 'xz',
+  zst: 'zstd',
+  '7z': '7z',
+  rar: 'rar',
+  mp3: 'mp3',
+  aac: 'aac',
+  flac: 'flac',
+  wav: 'wav',
+  aif: 'aiff',
+  aiff: 'aiff',
+  mid: 'midi',
+  midi: 'midi',
+  ogg: 'ogg',
+  oga: 'ogg',
+  ogv: 'ogg',
+  opus: 'ogg',
+  mp4: 'isobmff',
+  m4v: 'isobmff',
+  m4a: 'isobmff',
+  mov: 'isobmff',
+  '3gp': 'isobmff',
+  avi: 'avi',
+  mkv: 'matroska',
+  mka: 'matroska',
+  webm: 'matroska',
+  wasm: 'wasm',
+  exe: 'pe',
+  dll: 'pe',
+  class: 'class',
+};
+
+/**
+ * Sniffed types whose usual extension is only a guess: text, markup and
+ * scripts, and containers shared by many formats (.jar and .sketch are ZIPs)
+ */
+const AMBIGUOUS_CONTENT_TYPES = new Set([
+  'text/plain',
+  'text/html',
+  'application/xml',
+  'text/x-script',
+  'application/zip',
+  'application/x-ole-storage',
+  'application/vnd.oasis.opendocument',
+  'application/vnd.openxmlformats-officedocument',
+]);
+
+/**
+ * Extension a file should carry, given its name's extension (without the
+ * dot) and the type sniffed from its content: the content's when the name
+ * has none or names a different signature (a JPEG saved as .png),
+ * otherwise the name's own, case kept.
+ */
+export function resolveContentExtension(
+  extension: string,
+  metadata?: ShelfItem['metadata']
+): string {
+  const detected = metadata?.detectedExtension;
+  if (!detected || !metadata?.contentType || AMBIGUOUS_CONTENT_TYPES.has(metadata.contentType)) {
+    return extension;
+  }
+  if (!extension) {
+    return detected;
+  }
+  const named = SIGNATURE_GROUPS[extension.toLowerCase()];
+  const sniffed = SIGNATURE_GROUPS[detected];
+  return named && sniffed && named !== sniffed ? detected : extension;
+}
+
+/**
+ * Retype a file item by its sniffed content: an image the renderer can
+ * show is an image item whatever its name, and a file named like an image
+ * that is not one is a plain file. Folders, text items and items without a
+ * sniffed type keep theirs.
+ */
+export function applyContentType(item: ShelfItem): void {
+  const contentType = item.metadata?.contentType;
+  if (!contentType || (item.type !== ShelfItemType.FILE && item.type !== ShelfItemType.IMAGE)) {
+    return;
+  }
+  item.type = isImageTypeSupported(contentType) ? ShelfItemType.IMAGE : ShelfItemType.FILE;
+}
+
 /**
  * Result of processing dropped/selected files with duplicate detection
  */
@@ -289,6 +400,25 @@ export interface ProcessFileListOptions {
 async function getNativeFilePaths(): Promise<Map<string, string>> {
   const pathMap = new Map<string, string>();
 
+  // One ArrayBuffer instead of an object per file; names are decoded only
+  // here, not cloned key by key through IPC
+  try {
+    const payload = await window.api.invoke('drag:get-native-files-payload');
+    if (payload instanceof ArrayBuffer) {
+      const files = new FileListView(payload);
+      for (let i = 0; i < files.length; i++) {
+        const filename = files.name(i);
+        if (filename) {
+          pathMap.set(filename, files.path(i));
+        }
+      }
+      logger.info(`📋 Retrieved ${files.length} file paths from native drag monitor`);
+      return pathMap;
+    }
+  } catch (error) {
+    logger.debug('File list payload unavailable, requesting objects:', error);
+  }
+
   try {
     const response = await window.api.invoke('drag:get-native-files');
 
@@ -457,6 +587,14 @@ export async function processFileList(
             birthtime?: number;
             mtime?: number;
             atime?: number;
+            contentType?: string;
+            detectedExtension?: string;
+            captureTime?: number;
+            cameraMake?: string;
+            cameraModel?: string;
+            duration?: number;
+            width?: number;
+            height?: number;
           }
         >;
         error?: string;
@@ -468,6 +606,7 @@ export async function processFileList(
           const metadata = metadataResponse.data[item.path];
           if (metadata && Object.keys(metadata).length > 0) {
             item.metadata = metadata;
+            applyContentType(item);
             logger.debug(`Applied metadata to ${item.name}:`, metadata);
           }
         }
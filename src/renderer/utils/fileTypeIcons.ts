@@ -33,6 +33,10 @@ const extensionIconMap: Record<string, string> = {
   webp: ImgIcon,
   svg: ImgIcon,
   ico: ImgIcon,
+  tif: ImgIcon,
+  tiff: ImgIcon,
+  heic: ImgIcon,
+  avif: ImgIcon,
   // Documents
   pdf: PdfIcon,
   doc: WordIcon,
@@ -81,11 +85,16 @@ const extensionIconMap: Record<string, string> = {
  * @returns The path to the icon SVG
  */
 export function getFileIcon(filename: string): string {
-  const extension = filename.split('.').pop()?.toLowerCase();
-  if (extension && extensionIconMap[extension]) {
-    return extensionIconMap[extension];
-  }
-  return FileIcon;
+  return getExtensionIcon(filename.split('.').pop() ?? '');
+}
+
+/**
+ * Get the appropriate icon for an extension
+ * @param extension - The extension, without the dot
+ * @returns The path to the icon SVG
+ */
+export function getExtensionIcon(extension: string): string {
+  return extensionIconMap[extension.toLowerCase()] ?? FileIcon;
 }
 
 /**
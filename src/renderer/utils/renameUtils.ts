@@ -9,6 +9,7 @@ import type { ComponentInstance, ComponentDefinition } from '@shared/types/compo
 import { FILE_OPERATIONS } from '@renderer/constants/ui';
 import { logger } from '@shared/logger';
 import { resolveComponentValue, ComponentResolutionContext } from './componentValueResolver';
+import { resolveContentExtension } from './fileProcessing';
 
 /**
  * Options for generating rename previews
@@ -71,7 +72,7 @@ export function generateRenamePreview(
     // Add file extension (not for folders)
     // But only if it's not already included in the generated name
     if (preserveExtension && file.type !== 'folder') {
-      const ext = getFileExtension(file.name);
+      const ext = getRenameExtension(file);
       if (ext && !newName.endsWith(ext)) {
         newName += ext;
       }
@@ -159,7 +160,7 @@ export function generateRenamePreviewFromInstances(
     // Add file extension (not for folders)
     // Only auto-append if no file metadata OR if explicitly using extension fields
     if (preserveExtension && file.type !== 'folder' && shouldAutoAppendExtension) {
-      const ext = getFileExtension(file.name);
+      const ext = getRenameExtension(file);
       if (ext && !newName.endsWith(ext)) {
         newName += ext;
       }
@@ -220,6 +221,19 @@ export function getFileExtension(filename: string): string {
   return match ? match[0] : '';
 }
 
+/**
+ * Gets the extension a renamed file gets, including the dot: its name's,
+ * or the one its sniffed content calls for when the name has none or
+ * names a different format (see resolveContentExtension).
+ *
+ * @param file - The ShelfItem being renamed
+ * @returns File extension with dot, or empty string if none
+ */
+export function getRenameExtension(file: ShelfItem): string {
+  const extension = resolveContentExtension(getFileExtension(file.name).slice(1), file.metadata);
+  return extension ? `.${extension}` : '';
+}
+
 /**
  * Result of a file rename operation
  */
@@ -97,7 +97,12 @@ export const IPC_CHANNELS = {
   SHELF_UNDOCK: 'shelf:undock',
   SHELF_ADD_ITEM: 'shelf:add-item',
   SHELF_REMOVE_ITEM: 'shelf:remove-item',
+  SHELF_SEARCH_ITEMS: 'shelf:search-items',
+  SHELF_SORT_ITEMS_BY_NAME: 'shelf:sort-items-by-name',
   SHELF_UPDATE_CONFIG: 'shelf:update-config',
+  SHELF_EXPORT_ZIP: 'shelf:export-zip',
+  SHELF_EXPORT_ZIP_PROGRESS: 'shelf:export-zip-progress',
+  SHELF_CANCEL_EXPORT_ZIP: 'shelf:cancel-export-zip',
 
   // Window events
   WINDOW_READY: 'window:ready',
@@ -108,6 +113,11 @@ export const IPC_CHANNELS = {
   WINDOW_RESIZED: 'window:resized',
   WINDOW_GET_BOUNDS: 'window:get-bounds',
 
+  // File system operations
+  FS_TRANSFER_FILES: 'fs:transfer-files',
+  FS_TRANSFER_PROGRESS: 'fs:transfer-progress',
+  FS_CANCEL_TRANSFER: 'fs:cancel-transfer',
+
   // Application events
   APP_ERROR: 'app:error',
   APP_LOG: 'app:log',
@@ -0,0 +1,230 @@
+/**
+ * @fileoverview Compact binary file lists for main → renderer transfer
+ *
+ * A file list sent over IPC as an array of objects repeats every key per
+ * entry and is structured-cloned at each hop. A file-list payload is one
+ * ArrayBuffer instead: a 16-byte header, one 32-byte record per file and a
+ * UTF-8 string table. The layout is specified in
+ * src/native/common/file_list_payload.h, which writes it natively;
+ * encodeFileList() writes the same layout where the native modules are
+ * missing.
+ *
+ * FileListView reads a payload in place: records are indexed through typed
+ * arrays over the buffer and a string is only decoded when asked for, so a
+ * renderer that shows the first rows of a 50k-entry drop decodes those rows
+ * only. The typed arrays use the platform byte order, which is little-endian
+ * on every platform the app ships for.
+ *
+ * Usage:
+ * ```typescript
+ * const files = new FileListView(payload);
+ * for (let i = 0; i < files.length; i++) {
+ *   if (files.isDirectory(i)) expand(files.path(i));
+ * }
+ * ```
+ */
+
+const MAGIC = 0x4c464346; // "FCFL"
+const VERSION = 1;
+const HEADER_BYTES = 16;
+const RECORD_BYTES = 32;
+const RECORD_WORDS = RECORD_BYTES / 4;
+
+/** Bits of a record's flags; mirrors FileListFlag in file_list_payload.h */
+enum FileListFlag {
+  IsDirectory = 1 << 0,
+  IsFile = 1 << 1,
+  Exists = 1 << 2,
+}
+
+/** One entry of a file list, shaped like the drag monitor's DraggedItem */
+export interface FileListItem {
+  path: string;
+  name: string;
+  type: 'file' | 'folder';
+  isDirectory: boolean;
+  isFile: boolean;
+  exists: boolean;
+  extension?: string;
+  size?: number;
+}
+
+const decoder = new TextDecoder();
+const encoder = new TextEncoder();
+
+/**
+ * Zero-parse reader over a file-list payload. Construction only checks the
+ * header; the buffer is not copied.
+ */
+export class FileListView {
+  readonly length: number;
+  private readonly words: Uint32Array;
+  private readonly sizes: Float64Array;
+  private readonly strings: Uint8Array;
+
+  constructor(readonly buffer: ArrayBuffer) {
+    if (buffer.byteLength < HEADER_BYTES) {
+      throw new Error('File list payload is truncated');
+    }
+    const header = new DataView(buffer, 0, HEADER_BYTES);
+    if (
+      header.getUint32(0, true) !== MAGIC ||
+      header.getUint16(4, true) !== VERSION ||
+      header.getUint16(6, true) !== RECORD_BYTES
+    ) {
+      throw new Error('Not a file list payload');
+    }
+    const count = header.getUint32(8, true);
+    const stringBytes = header.getUint32(12, true);
+    const stringsStart = HEADER_BYTES + count * RECORD_BYTES;
+    if (stringsStart + stringBytes > buffer.byteLength) {
+      throw new Error('File list payload is truncated');
+    }
+
+    this.length = count;
+    this.words = new Uint32Array(buffer, HEADER_BYTES, count * RECORD_WORDS);
+    this.sizes = new Float64Array(buffer, HEADER_BYTES, count * (RECORD_BYTES / 8));
+    this.strings = new Uint8Array(buffer, stringsStart, stringBytes);
+  }
+
+  path(index: number): string {
+    const base = index * RECORD_WORDS;
+    return this.decode(this.words[base], this.words[base + 1]);
+  }
+
+  name(index: number): string {
+    const base = index * RECORD_WORDS;
+    return this.decode(this.words[base + 2], this.words[base + 3]);
+  }
+
+  /** Without the dot; undefined if the name has none */
+  extension(index: number): string | undefined {
+    const base = index * RECORD_WORDS;
+    const length = this.words[base + 5] & 0xffff;
+    return length > 0 ? this.decode(this.words[base + 4], length) : undefined;
+  }
+
+  /** Bytes; undefined for folders and missing files */
+  size(index: number): number | undefined {
+    const size = this.sizes[index * (RECORD_BYTES / 8) + 3];
+    return Number.isNaN(size) ? undefined : size;
+  }
+
+  isDirectory(index: number): boolean {
+    return (this.flags(index) & FileListFlag.IsDirectory) !== 0;
+  }
+
+  isFile(index: number): boolean {
+    return (this.flags(index) & FileListFlag.IsFile) !== 0;
+  }
+
+  exists(index: number): boolean {
+    return (this.flags(index) & FileListFlag.Exists) !== 0;
+  }
+
+  /** Decode one entry into an object */
+  item(index: number): FileListItem {
+    const isDirectory = this.isDirectory(index);
+    return {
+      path: this.path(index),
+      name: this.name(index),
+      type: isDirectory ? 'folder' : 'file',
+      isDirectory,
+      isFile: this.isFile(index),
+      exists: this.exists(index),
+      extension: this.extension(index),
+      size: this.size(index),
+    };
+  }
+
+  /** Decode every entry, e.g. for code that still takes object arrays */
+  toArray(): FileListItem[] {
+    const items = new Array<FileListItem>(this.length);
+    for (let i = 0; i < this.length; i++) {
+      items[i] = this.item(i);
+    }
+    return items;
+  }
+
+  private flags(index: number): number {
+    return this.words[index * RECORD_WORDS + 5] >>> 16;
+  }
+
+  private decode(offset: number, length: number): string {
+    return decoder.decode(this.strings.subarray(offset, offset + length));
+  }
+}
+
+/**
+ * Encode items as a file-list payload where the native modules are missing.
+ * Names and extensions that end their path share its bytes; other strings
+ * follow all the paths.
+ */
+export function encodeFileList(
+  items: ReadonlyArray<Partial<FileListItem> & { path: string }>
+): ArrayBuffer {
+  const paths = items.map(item => encoder.encode(item.path));
+  const extras: Uint8Array[] = [];
+  let stringBytes = paths.reduce((total, bytes) => total + bytes.length, 0);
+  // Per item: the six u32 words before the size, then the size
+  const records = new Array<number[]>(items.length);
+
+  // Offset of part when it ends whole (stored at offset), else a new copy
+  const within = (whole: Uint8Array, offset: number, part: Uint8Array): number => {
+    const start = whole.length - part.length;
+    if (start >= 0 && part.every((byte, i) => whole[start + i] === byte)) {
+      return offset + start;
+    }
+    extras.push(part);
+    stringBytes += part.length;
+    return stringBytes - part.length;
+  };
+
+  let pathOffset = 0;
+  items.forEach((item, index) => {
+    const path = paths[index];
+    const name = encoder.encode(item.name ?? item.path.slice(item.path.lastIndexOf('/') + 1));
+    const extension = encoder.encode(item.extension ?? '').subarray(0, 0xffff);
+    const nameOffset = within(path, pathOffset, name);
+    const extensionOffset = within(name, nameOffset, extension);
+    const flags =
+      (item.isDirectory ? FileListFlag.IsDirectory : 0) |
+      (item.isFile ? FileListFlag.IsFile : 0) |
+      (item.exists ? FileListFlag.Exists : 0);
+    records[index] = [
+      pathOffset,
+      path.length,
+      nameOffset,
+      name.length,
+      extensionOffset,
+      extension.length | (flags << 16),
+      item.size ?? NaN,
+    ];
+    pathOffset += path.length;
+  });
+
+  const stringsStart = HEADER_BYTES + items.length * RECORD_BYTES;
+  const byteLength = (stringsStart + stringBytes + 7) & ~7;
+  const buffer = new ArrayBuffer(byteLength);
+  const header = new DataView(buffer, 0, HEADER_BYTES);
+  header.setUint32(0, MAGIC, true);
+  header.setUint16(4, VERSION, true);
+  header.setUint16(6, RECORD_BYTES, true);
+  header.setUint32(8, items.length, true);
+  header.setUint32(12, stringBytes, true);
+
+  const words = new Uint32Array(buffer, HEADER_BYTES, items.length * RECORD_WORDS);
+  const sizes = new Float64Array(buffer, HEADER_BYTES, items.length * (RECORD_BYTES / 8));
+  records.forEach((record, index) => {
+    words.set(record.slice(0, 6), index * RECORD_WORDS);
+    sizes[index * (RECORD_BYTES / 8) + 3] = record[6];
+  });
+
+  const strings = new Uint8Array(buffer, stringsStart, stringBytes);
+  let offset = 0;
+  for (const bytes of [...paths, ...extras]) {
+    strings.set(bytes, offset);
+    offset += bytes.length;
+  }
+  return buffer;
+}
@@ -32,6 +32,12 @@ export enum NativeErrorCode {
   MOUSE_TRACKER_STOP_FAILED = 301,
   DRAG_MONITOR_START_FAILED = 310,
   DRAG_MONITOR_STOP_FAILED = 311,
+  DIRECTORY_WALK_FAILED = 320,
+  FOLDER_SIZE_FAILED = 321,
+  TRANSFER_FAILED = 322,
+  ZIP_FAILED = 323,
+  SESSION_STORE_FAILED = 324,
+  THUMBNAIL_FAILED = 330,
 
   // Callback errors (400-499)
   CALLBACK_NOT_SET = 400,
@@ -83,6 +89,18 @@ export function getNativeErrorDescription(code: NativeErrorCode): string {
       return 'Failed to start drag monitor';
     case NativeErrorCode.DRAG_MONITOR_STOP_FAILED:
       return 'Failed to stop drag monitor';
+    case NativeErrorCode.DIRECTORY_WALK_FAILED:
+      return 'Failed to walk directory';
+    case NativeErrorCode.FOLDER_SIZE_FAILED:
+      return 'Failed to measure folder size';
+    case NativeErrorCode.TRANSFER_FAILED:
+      return 'Failed to copy or move files';
+    case NativeErrorCode.ZIP_FAILED:
+      return 'Failed to write ZIP archive';
+    case NativeErrorCode.SESSION_STORE_FAILED:
+      return 'Failed to open or write session store';
+    case NativeErrorCode.THUMBNAIL_FAILED:
+      return 'Failed to create thumbnail';
     case NativeErrorCode.CALLBACK_NOT_SET:
       return 'Callback function not set';
     case NativeErrorCode.CALLBACK_INVOKE_FAILED:
@@ -0,0 +1,268 @@
+/**
+ * @fileoverview Serialized shelves: one buffer of item columns
+ *
+ * The native shelf store (src/native/file-ops/src/internal/shelf_store.h)
+ * keeps a shelf's items as parallel columns and serializes them in that
+ * shape: a 24-byte header, then each column in turn (ids, sizes, mtimes,
+ * directory indices, name offsets and lengths, flags, kinds), a table of
+ * the distinct directories and one UTF-8 string section. A path is its
+ * directory followed by its name, so a drop of 100k files from one folder
+ * stores that folder once. The layout is specified in shelf_store.h;
+ * encodeShelfItems() writes the same layout where the native modules are
+ * missing.
+ *
+ * ShelfItemsView reads a payload in place like FileListView: columns are
+ * typed arrays over the buffer and strings are decoded on demand. The
+ * typed arrays use the platform byte order, which is little-endian on every
+ * platform the app ships for.
+ *
+ * Usage:
+ * ```typescript
+ * const shelf = new ShelfItemsView(store.serialize());
+ * for (let i = 0; i < shelf.length; i++) {
+ *   if (shelf.kind(i) === ShelfItemKind.Folder) expand(shelf.path(i)!);
+ * }
+ * ```
+ */
+
+const MAGIC = 0x49534346; // "FCSI"
+const VERSION = 1;
+const HEADER_BYTES = 24;
+const NO_DIRECTORY = 0xffffffff;
+
+/** Item kinds as stored; mirrors ShelfItemKind in shelf_store.h and ShelfItemType */
+export enum ShelfItemKind {
+  File = 0,
+  Folder = 1,
+  Text = 2,
+  Url = 3,
+  Image = 4,
+}
+
+/** One decoded item of a serialized shelf */
+export interface ShelfItemRecord {
+  id: number;
+  kind: ShelfItemKind;
+  /** Absent for text and URL items */
+  path?: string;
+  name: string;
+  flags: number;
+  size?: number;
+  mtimeMs?: number;
+}
+
+const decoder = new TextDecoder();
+const encoder = new TextEncoder();
+
+function columnBytes(items: number, directories: number): number {
+  return items * (3 * 8 + 3 * 4 + 2 + 1) + directories * 2 * 4;
+}
+
+/**
+ * Zero-parse reader over a serialized shelf. Construction only checks the
+ * header; the buffer is not copied.
+ */
+export class ShelfItemsView {
+  readonly length: number;
+  readonly ids: Float64Array;
+  private readonly sizes: Float64Array;
+  private readonly mtimes: Float64Array;
+  private readonly directories: Uint32Array;
+  private readonly nameOffsets: Uint32Array;
+  private readonly nameLengths: Uint32Array;
+  private readonly directoryOffsets: Uint32Array;
+  private readonly directoryLengths: Uint32Array;
+  private readonly flagColumn: Uint16Array;
+  private readonly kinds: Uint8Array;
+  private readonly strings: Uint8Array;
+  private readonly directoryCache: (string | undefined)[];
+
+  constructor(readonly buffer: ArrayBuffer) {
+    if (buffer.byteLength < HEADER_BYTES) {
+      throw new Error('Shelf items payload is truncated');
+    }
+    const header = new DataView(buffer, 0, HEADER_BYTES);
+    if (header.getUint32(0, true) !== MAGIC || header.getUint16(4, true) !== VERSION) {
+      throw new Error('Not a shelf items payload');
+    }
+    const n = header.getUint32(8, true);
+    const d = header.getUint32(12, true);
+    const s = header.getUint32(16, true);
+    const stringsStart = HEADER_BYTES + columnBytes(n, d);
+    if (stringsStart + s > buffer.byteLength) {
+      throw new Error('Shelf items payload is truncated');
+    }
+
+    let offset = HEADER_BYTES;
+    const take = <T>(make: (offset: number) => T, bytes: number): T => {
+      const column = make(offset);
+      offset += bytes;
+      return column;
+    };
+    this.length = n;
+    this.ids = take(at => new Float64Array(buffer, at, n), n * 8);
+    this.sizes = take(at => new Float64Array(buffer, at, n), n * 8);
+    this.mtimes = take(at => new Float64Array(buffer, at, n), n * 8);
+    this.directories = take(at => new Uint32Array(buffer, at, n), n * 4);
+    this.nameOffsets = take(at => new Uint32Array(buffer, at, n), n * 4);
+    this.nameLengths = take(at => new Uint32Array(buffer, at, n), n * 4);
+    this.directoryOffsets = take(at => new Uint32Array(buffer, at, d), d * 4);
+    this.directoryLengths = take(at => new Uint32Array(buffer, at, d), d * 4);
+    this.flagColumn = take(at => new Uint16Array(buffer, at, n), n * 2);
+    this.kinds = take(at => new Uint8Array(buffer, at, n), n);
+    this.strings = new Uint8Array(buffer, stringsStart, s);
+    this.directoryCache = new Array(d);
+  }
+
+  id(index: number): number {
+    return this.ids[index];
+  }
+
+  kind(index: number): ShelfItemKind {
+    return this.kinds[index];
+  }
+
+  name(index: number): string {
+    return this.decode(this.nameOffsets[index], this.nameLengths[index]);
+  }
+
+  /** Undefined for text and URL items */
+  path(index: number): string | undefined {
+    const directory = this.directories[index];
+    if (directory === NO_DIRECTORY) {
+      return undefined;
+    }
+    let prefix = this.directoryCache[directory];
+    if (prefix === undefined) {
+      prefix = this.decode(this.directoryOffsets[directory], this.directoryLengths[directory]);
+      this.directoryCache[directory] = prefix;
+    }
+    return prefix + this.name(index);
+  }
+
+  flags(index: number): number {
+    return this.flagColumn[index];
+  }
+
+  /** Bytes; undefined when unknown */
+  size(index: number): number | undefined {
+    const size = this.sizes[index];
+    return Number.isNaN(size) ? undefined : size;
+  }
+
+  /** Modification time in ms since the epoch; undefined when unknown */
+  mtimeMs(index: number): number | undefined {
+    const mtime = this.mtimes[index];
+    return Number.isNaN(mtime) ? undefined : mtime;
+  }
+
+  /** Decode one item into an object */
+  item(index: number): ShelfItemRecord {
+    return {
+      id: this.id(index),
+      kind: this.kind(index),
+      path: this.path(index),
+      name: this.name(index),
+      flags: this.flags(index),
+      size: this.size(index),
+      mtimeMs: this.mtimeMs(index),
+    };
+  }
+
+  toArray(): ShelfItemRecord[] {
+    const items = new Array<ShelfItemRecord>(this.length);
+    for (let i = 0; i < this.length; i++) {
+      items[i] = this.item(i);
+    }
+    return items;
+  }
+
+  private decode(offset: number, length: number): string {
+    return decoder.decode(this.strings.subarray(offset, offset + length));
+  }
+}
+
+/**
+ * Serialize items in the native store's layout where the native modules
+ * are missing. Items with a path are split after its last '/'; their name
+ * field is ignored, as natively.
+ */
+export function encodeShelfItems(items: ReadonlyArray<ShelfItemRecord>): ArrayBuffer {
+  const n = items.length;
+  const directoryIndex = new Map<string, number>();
+  const directoryBytes: Uint8Array[] = [];
+  const nameBytes = new Array<Uint8Array>(n);
+  const directoryOf = new Uint32Array(n);
+  let directoryTotal = 0;
+  let nameTotal = 0;
+
+  items.forEach((item, i) => {
+    let name = item.name;
+    directoryOf[i] = NO_DIRECTORY;
+    if (item.path) {
+      const split = item.path.lastIndexOf('/') + 1;
+      const directory = item.path.slice(0, split);
+      name = item.path.slice(split);
+      let index = directoryIndex.get(directory);
+      if (index === undefined) {
+        index = directoryBytes.length;
+        directoryIndex.set(directory, index);
+        directoryBytes.push(encoder.encode(directory));
+        directoryTotal += directoryBytes[index].length;
+      }
+      directoryOf[i] = index;
+    }
+    nameBytes[i] = encoder.encode(name);
+    nameTotal += nameBytes[i].length;
+  });
+
+  const d = directoryBytes.length;
+  const s = directoryTotal + nameTotal;
+  const stringsStart = HEADER_BYTES + columnBytes(n, d);
+  const buffer = new ArrayBuffer((stringsStart + s + 7) & ~7);
+  const header = new DataView(buffer, 0, HEADER_BYTES);
+  header.setUint32(0, MAGIC, true);
+  header.setUint16(4, VERSION, true);
+  header.setUint32(8, n, true);
+  header.setUint32(12, d, true);
+  header.setUint32(16, s, true);
+
+  let offset = HEADER_BYTES;
+  const column = <T>(make: (offset: number) => T, bytes: number): T => {
+    const view = make(offset);
+    offset += bytes;
+    return view;
+  };
+  const ids = column(at => new Float64Array(buffer, at, n), n * 8);
+  const sizes = column(at => new Float64Array(buffer, at, n), n * 8);
+  const mtimes = column(at => new Float64Array(buffer, at, n), n * 8);
+  const directories = column(at => new Uint32Array(buffer, at, n), n * 4);
+  const nameOffsets = column(at => new Uint32Array(buffer, at, n), n * 4);
+  const nameLengths = column(at => new Uint32Array(buffer, at, n), n * 4);
+  const directoryOffsets = column(at => new Uint32Array(buffer, at, d), d * 4);
+  const directoryLengths = column(at => new Uint32Array(buffer, at, d), d * 4);
+  const flags = column(at => new Uint16Array(buffer, at, n), n * 2);
+  const kinds = column(at => new Uint8Array(buffer, at, n), n);
+  const strings = new Uint8Array(buffer, stringsStart, s);
+
+  let cursor = 0;
+  directoryBytes.forEach((bytes, k) => {
+    directoryOffsets[k] = cursor;
+    directoryLengths[k] = bytes.length;
+    strings.set(bytes, cursor);
+    cursor += bytes.length;
+  });
+  items.forEach((item, i) => {
+    ids[i] = item.id;
+    sizes[i] = item.size ?? NaN;
+    mtimes[i] = item.mtimeMs ?? NaN;
+    directories[i] = directoryOf[i];
+    nameOffsets[i] = cursor;
+    nameLengths[i] = nameBytes[i].length;
+    strings.set(nameBytes[i], cursor);
+    cursor += nameBytes[i].length;
+    flags[i] = item.flags;
+    kinds[i] = item.kind;
+  });
+  return buffer;
+}
@@ -24,15 +24,81 @@ export interface MousePosition extends Vector2D {
 
 export interface MouseTracker {
   start(): void;
+  /** Start with permission probing and hook setup off the main thread */
+  startAsync?(): Promise<NativeStartupTimings>;
   stop(): void;
   getCurrentPosition(): MousePosition;
   isTracking(): boolean;
   getPerformanceMetrics?(): PerformanceMetrics | null;
+  /** Native bytes held by the event queue and batches in delivery */
+  getNativeAllocations?(): NativeAllocationStats | null;
+  /** Sample the native threads for a while and write folded stacks; macOS only */
+  startProfiling?(options: NativeProfileOptions): Promise<NativeProfileResult>;
   on(event: 'position', listener: (position: MousePosition) => void): void;
   on(event: 'error', listener: (error: Error) => void): void;
   removeAllListeners(event?: string): void;
 }
 
+/**
+ * Phases of a native input module's startAsync(), in ms. On failure the
+ * rejection carries `code` and the timings gathered up to the failure.
+ */
+export interface NativeStartupTimings {
+  /** How long startAsync() held the calling thread */
+  blockingMs: number;
+  /** From the call until the native event thread ran */
+  threadSpawnMs: number;
+  /** Accessibility probe, including any permission prompt */
+  permissionMs: number;
+  /** Event tap, run loop source and timers */
+  hookMs: number;
+  /** From the call until events can flow */
+  totalMs: number;
+}
+
+/**
+ * Subsystems native memory is charged to (common/alloc_accounting.h)
+ */
+export type NativeAllocationTag =
+  | 'eventQueue'
+  | 'trajectory'
+  | 'paths'
+  | 'analysis'
+  | 'napiPayload'
+  | 'arenaCache';
+
+export interface NativeAllocationTagStats {
+  liveBytes: number;
+  peakBytes: number;
+  /** Since the module loaded; rates come from two reads */
+  allocations: number;
+  bytesAllocated: number;
+}
+
+export type NativeAllocationStats = Record<NativeAllocationTag, NativeAllocationTagStats>;
+
+/**
+ * Options of a native module's startProfiling() (common/sampling_profiler.h)
+ */
+export interface NativeProfileOptions {
+  /** Fixed duration, at most 60000 [5000] */
+  durationMs?: number;
+  /** Samples per second of each thread's CPU time [499] */
+  hz?: number;
+  /** Folded stacks ("thread;outer;...;inner count") are written here */
+  outputPath: string;
+}
+
+export interface NativeProfileResult {
+  outputPath: string;
+  samples: number;
+  /** Samples lost to a full buffer */
+  dropped: number;
+  threads: number;
+  /** Distinct stacks written */
+  stacks: number;
+}
+
 export interface ShakeDetectionConfig {
   minDirectionChanges: number;
   timeWindow: number; // milliseconds
@@ -101,6 +167,14 @@ export interface ShelfItem {
     birthtime?: number; // File creation timestamp (Unix timestamp)
     mtime?: number; // Last modified timestamp (Unix timestamp)
     atime?: number; // Last accessed timestamp (Unix timestamp)
+    contentType?: string; // MIME type sniffed from the file's first bytes
+    detectedExtension?: string; // Usual extension for contentType; may differ from extension
+    captureTime?: number; // When a photo/video was taken, from EXIF or the movie header (Unix ms)
+    cameraMake?: string; // e.g. 'Apple'
+    cameraModel?: string; // e.g. 'iPhone 14 Pro'
+    duration?: number; // Video/audio length in ms
+    width?: number; // Pixel dimensions of a photo or video
+    height?: number;
   };
 }
 
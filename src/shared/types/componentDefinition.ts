@@ -25,7 +25,11 @@ export type FileMetadataField =
   // Date information
   | 'fileCreatedDate' // File creation date
   | 'fileModifiedDate' // Last modified date
-  | 'fileAccessedDate'; // Last access date
+  | 'fileAccessedDate' // Last access date
+  // Photo and video metadata, read from file headers
+  | 'captureDate' // When the photo/video was taken; falls back to the created date
+  | 'cameraModel' // Camera model (e.g. "iPhone 14 Pro")
+  | 'mediaDuration'; // Video/audio length (e.g. "03m25s")
 
 // ============================================================================
 // Select Component Types